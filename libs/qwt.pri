@@ -42,6 +42,7 @@ HEADERS += $$QWTSRCDIR/qwt.h \
            $$QWTSRCDIR/qwt_pixel_matrix.h \
            $$QWTSRCDIR/qwt_plot.h \
            $$QWTSRCDIR/qwt_plot_canvas.h \
+           $$QWTSRCDIR/qwt_plot_glcanvas.h \
            $$QWTSRCDIR/qwt_plot_curve.h \
            $$QWTSRCDIR/qwt_plot_dict.h \
            $$QWTSRCDIR/qwt_plot_grid.h \
@@ -111,6 +112,7 @@ SOURCES += $$QWTSRCDIR/qwt_abstract_legend.cpp \
            $$QWTSRCDIR/qwt_plot.cpp \
            $$QWTSRCDIR/qwt_plot_axis.cpp \
            $$QWTSRCDIR/qwt_plot_canvas.cpp \
+           $$QWTSRCDIR/qwt_plot_glcanvas.cpp \
            $$QWTSRCDIR/qwt_plot_curve.cpp \
            $$QWTSRCDIR/qwt_plot_dict.cpp \
            $$QWTSRCDIR/qwt_plot_grid.cpp \
@@ -408,11 +408,16 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory  { APMFirmwarePlugin {
         src/qgcunittest
 
     HEADERS += \
+        src/AnalyzeView/ExifParserTest.h \
         src/AnalyzeView/LogDownloadTest.h \
+        src/AnalyzeView/LogParserTest.h \
         src/FactSystem/FactSystemTestBase.h \
         src/FactSystem/FactSystemTestGeneric.h \
         src/FactSystem/FactSystemTestPX4.h \
         src/FactSystem/ParameterManagerTest.h \
+        src/FactSystem/ParameterMetaDataStoreTest.h \
+        src/FactSystem/FactTest.h \
+        src/FactSystem/FactGroupUpdateClockTest.h \
         src/MissionManager/CameraSectionTest.h \
         src/MissionManager/MissionCommandTreeTest.h \
         src/MissionManager/MissionControllerManagerTest.h \
@@ -432,22 +437,39 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory  { APMFirmwarePlugin {
         src/qgcunittest/FlightGearTest.h \
         src/qgcunittest/GeoTest.h \
         src/qgcunittest/LinkManagerTest.h \
+        src/qgcunittest/LogReplayLinkTest.h \
+        src/qgcunittest/MAVLinkInspectorStatsTest.h \
         src/qgcunittest/MainWindowTest.h \
         src/qgcunittest/MavlinkLogTest.h \
         src/qgcunittest/MessageBoxTest.h \
+        src/qgcunittest/MockLinkLoadBenchmark.h \
         src/qgcunittest/MultiSignalSpy.h \
         src/qgcunittest/RadioConfigTest.h \
         src/qgcunittest/TCPLinkTest.h \
         src/qgcunittest/TCPLoopBackServer.h \
+        src/qgcunittest/TelemetryStoreTest.h \
+        src/qgcunittest/TerrainTileTest.h \
+        src/qgcunittest/TimeSeriesDataTest.h \
+        src/qgcunittest/UASMessageHandlerTest.h \
         src/qgcunittest/UnitTest.h \
+        src/Vehicle/FleetModeTest.h \
         src/Vehicle/SendMavCommandTest.h \
+        src/Vehicle/TrajectoryStoreTest.h \
+        src/Vehicle/VehicleMessageDispatchTest.h \
+        src/VideoStreaming/VideoStreamManagerTest.h \
+        src/VideoStreaming/VideoSyncIndexTest.h \
 
     SOURCES += \
+        src/AnalyzeView/ExifParserTest.cc \
         src/AnalyzeView/LogDownloadTest.cc \
+        src/AnalyzeView/LogParserTest.cc \
         src/FactSystem/FactSystemTestBase.cc \
         src/FactSystem/FactSystemTestGeneric.cc \
         src/FactSystem/FactSystemTestPX4.cc \
         src/FactSystem/ParameterManagerTest.cc \
+        src/FactSystem/ParameterMetaDataStoreTest.cc \
+        src/FactSystem/FactTest.cc \
+        src/FactSystem/FactGroupUpdateClockTest.cc \
         src/MissionManager/CameraSectionTest.cc \
         src/MissionManager/MissionCommandTreeTest.cc \
         src/MissionManager/MissionControllerManagerTest.cc \
@@ -467,22 +489,36 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory  { APMFirmwarePlugin {
         src/qgcunittest/FlightGearTest.cc \
         src/qgcunittest/GeoTest.cc \
         src/qgcunittest/LinkManagerTest.cc \
+        src/qgcunittest/LogReplayLinkTest.cc \
+        src/qgcunittest/MAVLinkInspectorStatsTest.cc \
         src/qgcunittest/MainWindowTest.cc \
         src/qgcunittest/MavlinkLogTest.cc \
         src/qgcunittest/MessageBoxTest.cc \
+        src/qgcunittest/MockLinkLoadBenchmark.cc \
         src/qgcunittest/MultiSignalSpy.cc \
         src/qgcunittest/RadioConfigTest.cc \
         src/qgcunittest/TCPLinkTest.cc \
         src/qgcunittest/TCPLoopBackServer.cc \
+        src/qgcunittest/TelemetryStoreTest.cc \
+        src/qgcunittest/TerrainTileTest.cc \
+        src/qgcunittest/TimeSeriesDataTest.cc \
+        src/qgcunittest/UASMessageHandlerTest.cc \
         src/qgcunittest/UnitTest.cc \
         src/qgcunittest/UnitTestList.cc \
+        src/Vehicle/FleetModeTest.cc \
         src/Vehicle/SendMavCommandTest.cc \
+        src/Vehicle/TrajectoryStoreTest.cc \
+        src/Vehicle/VehicleMessageDispatchTest.cc \
+        src/VideoStreaming/VideoStreamManagerTest.cc \
+        src/VideoStreaming/VideoSyncIndexTest.cc \
 } } } } } }
 
 # Main QGC Headers and Source files
 
 HEADERS += \
     src/AnalyzeView/ExifParser.h \
+    src/AnalyzeView/GeoTagPipeline.h \
+    src/AnalyzeView/LogStreamReader.h \
     src/AnalyzeView/ULogParser.h \
     src/AnalyzeView/PX4LogParser.h \
     src/CmdLineOptParser.h \
@@ -563,6 +599,7 @@ HEADERS += \
     src/Settings/UnitsSettings.h \
     src/Settings/VideoSettings.h \
     src/Terrain.h \
+    src/TerrainTile.h \
     src/Vehicle/MAVLinkLogManager.h \
     src/VehicleSetup/JoystickConfigController.h \
     src/audio/QGCAudioWorker.h \
@@ -637,6 +674,8 @@ HEADERS += \
     src/uas/FileManager.h \
     src/ui/HILDockWidget.h \
     src/ui/MAVLinkDecoder.h \
+    src/ui/MAVLinkInspectorStats.h \
+    src/ui/TelemetryStore.h \
     src/ui/MainWindow.h \
     src/ui/MultiVehicleDockWidget.h \
     src/ui/QGCHilConfiguration.h \
@@ -671,6 +710,8 @@ AndroidBuild {
 
 SOURCES += \
     src/AnalyzeView/ExifParser.cc \
+    src/AnalyzeView/GeoTagPipeline.cc \
+    src/AnalyzeView/LogStreamReader.cc \
     src/AnalyzeView/ULogParser.cc \
     src/AnalyzeView/PX4LogParser.cc \
     src/CmdLineOptParser.cc \
@@ -746,6 +787,7 @@ SOURCES += \
     src/Settings/UnitsSettings.cc \
     src/Settings/VideoSettings.cc \
     src/Terrain.cc \
+    src/TerrainTile.cc \
     src/Vehicle/MAVLinkLogManager.cc \
     src/VehicleSetup/JoystickConfigController.cc \
     src/audio/QGCAudioWorker.cpp \
@@ -801,6 +843,8 @@ SOURCES += \
     src/uas/FileManager.cc \
     src/ui/HILDockWidget.cc \
     src/ui/MAVLinkDecoder.cc \
+    src/ui/MAVLinkInspectorStats.cc \
+    src/ui/TelemetryStore.cc \
     src/ui/MainWindow.cc \
     src/ui/MultiVehicleDockWidget.cc \
     src/ui/QGCHilConfiguration.cc \
@@ -853,6 +897,7 @@ HEADERS+= \
     src/Vehicle/ADSBVehicle.h \
     src/Vehicle/MultiVehicleManager.h \
     src/Vehicle/GPSRTKFactGroup.h \
+    src/Vehicle/TrajectoryStore.h \
     src/Vehicle/Vehicle.h \
     src/VehicleSetup/VehicleComponent.h \
 
@@ -879,6 +924,7 @@ SOURCES += \
     src/Vehicle/ADSBVehicle.cc \
     src/Vehicle/MultiVehicleManager.cc \
     src/Vehicle/GPSRTKFactGroup.cc \
+    src/Vehicle/TrajectoryStore.cc \
     src/Vehicle/Vehicle.cc \
     src/VehicleSetup/VehicleComponent.cc \
 
@@ -1020,20 +1066,24 @@ HEADERS += \
     src/FactSystem/Fact.h \
     src/FactSystem/FactControls/FactPanelController.h \
     src/FactSystem/FactGroup.h \
+    src/FactSystem/FactGroupUpdateClock.h \
     src/FactSystem/FactMetaData.h \
     src/FactSystem/FactSystem.h \
     src/FactSystem/FactValidator.h \
     src/FactSystem/ParameterManager.h \
+    src/FactSystem/ParameterMetaDataStore.h \
     src/FactSystem/SettingsFact.h \
 
 SOURCES += \
     src/FactSystem/Fact.cc \
     src/FactSystem/FactControls/FactPanelController.cc \
     src/FactSystem/FactGroup.cc \
+    src/FactSystem/FactGroupUpdateClock.cc \
     src/FactSystem/FactMetaData.cc \
     src/FactSystem/FactSystem.cc \
     src/FactSystem/FactValidator.cc \
     src/FactSystem/ParameterManager.cc \
+    src/FactSystem/ParameterMetaDataStore.cc \
     src/FactSystem/SettingsFact.cc \
 
 #-------------------------------------------------------------------------------------
@@ -1046,14 +1096,18 @@ HEADERS += \
     src/VideoStreaming/VideoItem.h \
     src/VideoStreaming/VideoReceiver.h \
     src/VideoStreaming/VideoStreaming.h \
+    src/VideoStreaming/VideoStreamManager.h \
     src/VideoStreaming/VideoSurface.h \
     src/VideoStreaming/VideoSurface_p.h \
+    src/VideoStreaming/VideoSyncIndex.h \
 
 SOURCES += \
     src/VideoStreaming/VideoItem.cc \
     src/VideoStreaming/VideoReceiver.cc \
     src/VideoStreaming/VideoStreaming.cc \
+    src/VideoStreaming/VideoStreamManager.cc \
     src/VideoStreaming/VideoSurface.cc \
+    src/VideoStreaming/VideoSyncIndex.cc \
 
 contains (CONFIG, DISABLE_VIDEOSTREAMING) {
     message("Skipping support for video streaming (manual override from command line)")
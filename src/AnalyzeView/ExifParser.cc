@@ -2,6 +2,7 @@
 #include <math.h>
 #include <QtEndian>
 #include <QDateTime>
+#include <QSaveFile>
 
 ExifParser::ExifParser()
 {
@@ -222,3 +223,91 @@ bool ExifParser::write(QByteArray& buf, GeoTagWorker::cameraFeedbackPacket& geot
     buf.replace(tiffHeaderInd + 8, 2, converter.c, 2);
     return true;
 }
+
+bool ExifParser::readHeader(QFile& file, QByteArray& header)
+{
+    header.clear();
+
+    // Start of image marker
+    header = file.read(2);
+    if (header.size() != 2 || (uchar)header[0] != 0xFF || (uchar)header[1] != 0xD8) {
+        return false;
+    }
+
+    // Walk the marker segments until we reach APP1. Image data starts at SOS so stop there.
+    while (true) {
+        QByteArray marker = file.read(4);
+        if (marker.size() != 4 || (uchar)marker[0] != 0xFF || (uchar)marker[1] == 0xDA) {
+            return false;
+        }
+        int segmentLength = ((uchar)marker[2] << 8) | (uchar)marker[3];
+        if (segmentLength < 2) {
+            return false;
+        }
+        QByteArray segment = file.read(segmentLength - 2);
+        if (segment.size() != segmentLength - 2) {
+            return false;
+        }
+        header.append(marker);
+        header.append(segment);
+        if ((uchar)marker[1] == 0xE1 && segment.startsWith(QByteArray("Exif\0\0", 6))) {
+            return true;
+        }
+    }
+}
+
+double ExifParser::readImageTime(const QString& imagePath)
+{
+    QFile file(imagePath);
+    QByteArray header;
+    if (!file.open(QIODevice::ReadOnly) || !readHeader(file, header)) {
+        qWarning() << "Could not read EXIF header" << imagePath;
+        return -1.0;
+    }
+    ExifParser parser;
+    return parser.readTime(header);
+}
+
+bool ExifParser::tagImage(const QString& sourcePath, const QString& destinationPath, GeoTagWorker::cameraFeedbackPacket geotag, QString& errorString)
+{
+    QFile source(sourcePath);
+    if (!source.open(QIODevice::ReadOnly)) {
+        errorString = source.errorString();
+        return false;
+    }
+    QByteArray header;
+    if (!readHeader(source, header)) {
+        errorString = QStringLiteral("No EXIF header");
+        return false;
+    }
+    qint64 bodyOffset = source.pos();
+    qint64 bodySize = source.size() - bodyOffset;
+
+    ExifParser parser;
+    if (!parser.write(header, geotag)) {
+        errorString = QStringLiteral("Could not write EXIF header");
+        return false;
+    }
+
+    QSaveFile destination(destinationPath);
+    if (!destination.open(QIODevice::WriteOnly)) {
+        errorString = destination.errorString();
+        return false;
+    }
+    destination.write(header);
+    if (bodySize > 0) {
+        uchar* body = source.map(bodyOffset, bodySize);
+        if (body) {
+            destination.write(reinterpret_cast<const char*>(body), bodySize);
+            source.unmap(body);
+        } else {
+            // Fall back to a plain read for files which can not be mapped
+            destination.write(source.readAll());
+        }
+    }
+    if (!destination.commit()) {
+        errorString = destination.errorString();
+        return false;
+    }
+    return true;
+}
@@ -3,6 +3,7 @@
 
 #include <QGeoCoordinate>
 #include <QDebug>
+#include <QFile>
 
 #include "GeoTagController.h"
 
@@ -13,6 +14,17 @@ public:
     ~ExifParser();
     double readTime(QByteArray& buf);
     bool write(QByteArray& buf, GeoTagWorker::cameraFeedbackPacket& geotag);
+
+    /// Reads the JPEG header from the start of the file up to and including the EXIF APP1 segment. The image data
+    /// following it is not read. On success the file is positioned at the first byte after the APP1 segment.
+    static bool readHeader(QFile& file, QByteArray& header);
+
+    /// @return Creation time of the image in seconds since epoch, -1 on failure. Only the header is read.
+    static double readImageTime(const QString& imagePath);
+
+    /// Writes a geotagged copy of an image. Only the header is parsed and rewritten, the remaining image data is
+    /// written straight from a memory map of the source file.
+    static bool tagImage(const QString& sourcePath, const QString& destinationPath, GeoTagWorker::cameraFeedbackPacket geotag, QString& errorString);
 };
 
 #endif // EXIFPARSER_H
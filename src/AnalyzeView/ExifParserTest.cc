@@ -0,0 +1,237 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ExifParserTest.h"
+#include "ExifParser.h"
+#include "GeoTagPipeline.h"
+
+#include <QtEndian>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QAtomicInt>
+
+ExifParserTest::ExifParserTest(void)
+    : _tempDir(NULL)
+{
+
+}
+
+void ExifParserTest::init(void)
+{
+    UnitTest::init();
+    _tempDir = new QTemporaryDir();
+    QVERIFY(_tempDir->isValid());
+}
+
+void ExifParserTest::cleanup(void)
+{
+    delete _tempDir;
+    _tempDir = NULL;
+    UnitTest::cleanup();
+}
+
+template <typename T>
+static void _appendLittleEndian(QByteArray& bytes, T value)
+{
+    char buffer[sizeof(T)];
+    qToLittleEndian<T>(value, reinterpret_cast<uchar*>(buffer));
+    bytes.append(buffer, sizeof(T));
+}
+
+/// Builds a minimal JPEG with the EXIF layout produced by the cameras ExifParser::write supports: IFD0 holding the
+/// creation date, 12 bytes of padding after the IFD and an empty IFD1.
+QByteArray ExifParserTest::_buildImage(int bodySize)
+{
+    QByteArray tiff("II*\0", 4);
+    _appendLittleEndian<quint32>(tiff, 8);
+    _appendLittleEndian<quint16>(tiff, 1);          // IFD0 entry count
+    _appendLittleEndian<quint16>(tiff, 0x9004);     // DateTimeDigitized
+    _appendLittleEndian<quint16>(tiff, 2);          // ASCII
+    _appendLittleEndian<quint32>(tiff, 20);
+    _appendLittleEndian<quint32>(tiff, 38);         // date string offset
+    _appendLittleEndian<quint32>(tiff, 58);         // IFD1 offset
+    tiff.append(QByteArray(12, ' '));
+    tiff.append("2017:05:01 12:00:00", 20);
+    _appendLittleEndian<quint16>(tiff, 0);          // IFD1 entry count
+    _appendLittleEndian<quint32>(tiff, 0);
+
+    QByteArray image("\xFF\xD8", 2);
+    image.append("\xFF\xE0\x00\x10JFIF\0\x01\x01\x00\x00\x01\x00\x01\x00\x00", 18);
+    QByteArray app1("\xFF\xE1", 2);
+    quint16 app1Length = 2 + 6 + tiff.size();
+    app1.append((char)(app1Length >> 8));
+    app1.append((char)(app1Length & 0xFF));
+    app1.append("Exif\0\0", 6);
+    app1.append(tiff);
+    image.append(app1);
+
+    QByteArray body("\xFF\xDA", 2);
+    for (int i=2; i<bodySize; i++) {
+        body.append((char)(qrand() & 0xFF));
+    }
+    image.append(body);
+    return image;
+}
+
+QString ExifParserTest::_writeImage(const QString& name, int bodySize)
+{
+    QString path = QDir(_tempDir->path()).filePath(name);
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(_buildImage(bodySize));
+    }
+    return path;
+}
+
+void ExifParserTest::_readHeader_test(void)
+{
+    QString path = _writeImage(QStringLiteral("header.jpg"), 4096);
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QByteArray header;
+    QVERIFY(ExifParser::readHeader(file, header));
+
+    // Header stops at the end of APP1 and the file is left at the start of the image data
+    QCOMPARE(file.pos(), (qint64)header.size());
+    QCOMPARE(file.read(2), QByteArray("\xFF\xDA", 2));
+    QVERIFY(header.size() < 200);
+
+    QDateTime expected(QDate(2017, 5, 1), QTime(12, 0, 0));
+    QCOMPARE(ExifParser::readImageTime(path), expected.toMSecsSinceEpoch() / 1000.0);
+
+    // Files without EXIF are rejected
+    QString noExifPath = QDir(_tempDir->path()).filePath(QStringLiteral("noexif.jpg"));
+    QFile noExif(noExifPath);
+    QVERIFY(noExif.open(QIODevice::WriteOnly));
+    noExif.write(QByteArray("\xFF\xD8\xFF\xDA\x00\x04\x00\x00", 8));
+    noExif.close();
+    QCOMPARE(ExifParser::readImageTime(noExifPath), -1.0);
+}
+
+void ExifParserTest::_tagImage_test(void)
+{
+    const int bodySize = 64 * 1024;
+    QString sourcePath = _writeImage(QStringLiteral("source.jpg"), bodySize);
+    QString destinationPath = QDir(_tempDir->path()).filePath(QStringLiteral("tagged.jpg"));
+
+    GeoTagWorker::cameraFeedbackPacket geotag;
+    memset(&geotag, 0, sizeof(geotag));
+    geotag.latitude = 47.5;
+    geotag.longitude = 8.25;
+    geotag.altitude = 500;
+
+    QString errorString;
+    QVERIFY(ExifParser::tagImage(sourcePath, destinationPath, geotag, errorString));
+
+    QFile source(sourcePath);
+    QFile destination(destinationPath);
+    QVERIFY(source.open(QIODevice::ReadOnly));
+    QVERIFY(destination.open(QIODevice::ReadOnly));
+    QByteArray sourceBytes = source.readAll();
+    QByteArray destinationBytes = destination.readAll();
+
+    // Only the header grows, the image data is copied untouched
+    QCOMPARE(destinationBytes.size(), sourceBytes.size() + 0xa5);
+    QCOMPARE(destinationBytes.right(bodySize), sourceBytes.right(bodySize));
+
+    // Result matches tagging the whole file in memory
+    ExifParser parser;
+    QVERIFY(parser.write(sourceBytes, geotag));
+    QCOMPARE(destinationBytes, sourceBytes);
+
+    QCOMPARE(ExifParser::readImageTime(destinationPath), ExifParser::readImageTime(sourcePath));
+}
+
+void ExifParserTest::_pipelineBounded_test(void)
+{
+    const int maxInFlight = 3;
+    QAtomicInt running(0);
+    QAtomicInt maxRunning(0);
+
+    GeoTagPipeline pipeline(maxInFlight);
+    GeoTagPipeline::Job job = [&running, &maxRunning](int index) {
+        int count = running.fetchAndAddOrdered(1) + 1;
+        int max = maxRunning.load();
+        while (count > max && !maxRunning.testAndSetOrdered(max, count)) {
+            max = maxRunning.load();
+        }
+        QThread::msleep(2);
+        running.fetchAndAddOrdered(-1);
+        return index != 40;
+    };
+
+    QVERIFY(pipeline.run(30, job));
+    QVERIFY(maxRunning.load() <= maxInFlight);
+
+    // A failing job stops submission and is reported
+    QVERIFY(!pipeline.run(100, job));
+    QCOMPARE(pipeline.failedIndex(), 40);
+    QVERIFY(!pipeline.cancelled());
+
+    // Cancel from the progress callback
+    int lastCompleted = 0;
+    QVERIFY(!pipeline.run(100, job, [&lastCompleted](int completed) { lastCompleted = completed; return completed < 10; }));
+    QVERIFY(pipeline.cancelled());
+    QVERIFY(lastCompleted < 10 + maxInFlight + 1);
+}
+
+/// Throughput over a synthetic corpus. Reported through qDebug so it can be compared between runs.
+void ExifParserTest::_pipelineThroughput_benchmark(void)
+{
+    UT_OPT_IN(optInBenchmarks);
+
+    const int imageCount = 200;
+    const int bodySize = 256 * 1024;
+
+    QByteArray image = _buildImage(bodySize);
+    QStringList sourcePaths;
+    QStringList destinationPaths;
+    QDir(_tempDir->path()).mkdir(QStringLiteral("TAGGED"));
+    for (int i=0; i<imageCount; i++) {
+        QString name = QString("IMG_%1.jpg").arg(i, 4, 10, QChar('0'));
+        QString path = QDir(_tempDir->path()).filePath(name);
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(image);
+        sourcePaths.append(path);
+        destinationPaths.append(QDir(_tempDir->path()).filePath(QStringLiteral("TAGGED/") + name));
+    }
+
+    GeoTagWorker::cameraFeedbackPacket geotag;
+    memset(&geotag, 0, sizeof(geotag));
+    geotag.latitude = 47.5;
+    geotag.longitude = 8.25;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<double> times(imageCount);
+    double* timesData = times.data();
+    GeoTagPipeline pipeline;
+    QVERIFY(pipeline.run(imageCount, [sourcePaths, timesData](int index) {
+        timesData[index] = ExifParser::readImageTime(sourcePaths[index]);
+        return timesData[index] > 0;
+    }));
+    qint64 readMsecs = timer.restart();
+
+    QVERIFY(pipeline.run(imageCount, [sourcePaths, destinationPaths, geotag](int index) {
+        QString errorString;
+        return ExifParser::tagImage(sourcePaths[index], destinationPaths[index], geotag, errorString);
+    }));
+    qint64 tagMsecs = timer.elapsed();
+
+    qDebug() << "EXIF pipeline:" << imageCount << "images" << pipeline.maxInFlight() << "in flight"
+             << "read" << readMsecs << "ms" << "tag" << tagMsecs << "ms"
+             << "throughput" << (imageCount * 1000.0) / qMax(readMsecs + tagMsecs, (qint64)1) << "images/s";
+
+    foreach (const QString& path, destinationPaths) {
+        QCOMPARE(QFileInfo(path).size(), (qint64)image.size() + 0xa5);
+    }
+}
@@ -0,0 +1,39 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QTemporaryDir>
+
+/// Unit test for ExifParser header handling and the GeoTagPipeline
+class ExifParserTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ExifParserTest(void);
+
+protected:
+    void init(void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _readHeader_test(void);
+    void _tagImage_test(void);
+    void _pipelineBounded_test(void);
+    void _pipelineThroughput_benchmark(void);
+
+private:
+    QByteArray  _buildImage(int bodySize);
+    QString     _writeImage(const QString& name, int bodySize);
+
+    QTemporaryDir* _tempDir;
+};
@@ -20,6 +20,7 @@
 #include "ExifParser.h"
 #include "ULogParser.h"
 #include "PX4LogParser.h"
+#include "GeoTagPipeline.h"
 
 GeoTagController::GeoTagController(void)
     : _progress(0)
@@ -174,51 +175,60 @@ void GeoTagWorker::run(void)
     }
     emit progressChanged((100/nSteps));
 
-    // Parse EXIF
-    ExifParser exifParser;
-    _imageTime.clear();
-    for (int i = 0; i < _imageList.size(); ++i) {
-        QFile file(_imageList.at(i).absoluteFilePath());
-        if (!file.open(QIODevice::ReadOnly)) {
+    // Parse EXIF. Only the image headers are read, in parallel.
+    QStringList imagePaths;
+    foreach (const QFileInfo& imageInfo, _imageList) {
+        imagePaths.append(imageInfo.absoluteFilePath());
+    }
+    QVector<double> imageTimes(imagePaths.count());
+    double* imageTimesData = imageTimes.data();
+    GeoTagPipeline::Job readTimeJob = [imagePaths, imageTimesData](int index) {
+        imageTimesData[index] = ExifParser::readImageTime(imagePaths[index]);
+        return imageTimesData[index] >= 0;
+    };
+    int imageCount = imagePaths.count();
+    GeoTagPipeline::ProgressCallback readTimeProgress = [this, nSteps, imageCount](int completed) {
+        emit progressChanged((100/nSteps) + ((100/nSteps) / imageCount)*completed);
+        return !_cancel;
+    };
+    GeoTagPipeline exifPipeline;
+    if (!exifPipeline.run(imageCount, readTimeJob, readTimeProgress)) {
+        if (!exifPipeline.cancelled()) {
             emit error(tr("Geotagging failed. Couldn't open an image."));
             return;
         }
-        QByteArray imageBuffer = file.readAll();
-        file.close();
-
-        _imageTime.append(exifParser.readTime(imageBuffer));
-
-        emit progressChanged((100/nSteps) + ((100/nSteps) / _imageList.size())*i);
-
-        if (_cancel) {
-            qCDebug(GeotaggingLog) << "Tagging cancelled";
-            emit error(tr("Tagging cancelled"));
-            return;
-        }
+        qCDebug(GeotaggingLog) << "Tagging cancelled";
+        emit error(tr("Tagging cancelled"));
+        return;
     }
+    _imageTime = imageTimes.toList();
 
-    // Load log
+    // Parse log. The parsers stream the file so memory use does not depend on the log size.
     bool isULog = _logFile.endsWith(".ulg", Qt::CaseSensitive);
     QFile file(_logFile);
     if (!file.open(QIODevice::ReadOnly)) {
         emit error(tr("Geotagging failed. Couldn't open log file."));
         return;
     }
-    QByteArray log = file.readAll();
-    file.close();
+
+    LogStreamReader::ProgressCallback progressCallback = [this, nSteps](double fraction) {
+        emit progressChanged(2*(100/nSteps) + (100/nSteps)*fraction);
+        return !_cancel;
+    };
 
     // Instantiate appropriate parser
     _triggerList.clear();
     bool parseComplete = false;
     if(isULog) {
         ULogParser parser;
-        parseComplete = parser.getTagsFromLog(log, _triggerList);
+        parseComplete = parser.getTagsFromLog(file, _triggerList, progressCallback);
 
     } else {
         PX4LogParser parser;
-        parseComplete = parser.getTagsFromLog(log, _triggerList);
+        parseComplete = parser.getTagsFromLog(file, _triggerList, progressCallback);
 
     }
+    file.close();
 
     if (!parseComplete) {
         if (_cancel) {
@@ -255,42 +265,41 @@ void GeoTagWorker::run(void)
         return;
     }
 
-    // Tag images
+    // Tag images. Headers are rewritten in parallel and the image data is copied unparsed.
     int maxIndex = std::min(_imageIndices.count(), _triggerIndices.count());
     maxIndex = std::min(maxIndex, _imageList.count());
-    for(int i = 0; i < maxIndex; i++) {
-        QFile fileRead(_imageList.at(_imageIndices[i]).absoluteFilePath());
-        if (!fileRead.open(QIODevice::ReadOnly)) {
-            emit error(tr("Geotagging failed. Couldn't open an image."));
-            return;
-        }
-        QByteArray imageBuffer = fileRead.readAll();
-        fileRead.close();
-
-        if (!exifParser.write(imageBuffer, _triggerList[_triggerIndices[i]])) {
-            emit error(tr("Geotagging failed. Couldn't write to image."));
-            return;
-        } else {
-            QFile fileWrite;
-            if(_saveDirectory == "") {
-                fileWrite.setFileName(_imageDirectory + "/TAGGED/" + _imageList.at(_imageIndices[i]).fileName());
-            } else {
-                fileWrite.setFileName(_saveDirectory + "/" + _imageList.at(_imageIndices[i]).fileName());
-            }
-            if (!fileWrite.open(QFile::WriteOnly)) {
-                emit error(tr("Geotagging failed. Couldn't write to an image."));
-                return;
-            }
-            fileWrite.write(imageBuffer);
-            fileWrite.close();
+    QString destinationDirectory = _saveDirectory == "" ? _imageDirectory + "/TAGGED" : _saveDirectory;
+    QStringList sourcePaths;
+    QStringList destinationPaths;
+    QList<cameraFeedbackPacket> geotags;
+    for (int i = 0; i < maxIndex; i++) {
+        if (_imageIndices[i] < 0 || _imageIndices[i] >= _imageList.count()) {
+            qCDebug(GeotaggingLog) << "Trigger sequence without image" << _imageIndices[i];
+            continue;
         }
-        emit progressChanged(4*(100/nSteps) + ((100/nSteps) / maxIndex)*i);
-
-        if (_cancel) {
-            qCDebug(GeotaggingLog) << "Tagging cancelled";
-            emit error(tr("Tagging cancelled"));
-            return;
+        const QFileInfo& imageInfo = _imageList.at(_imageIndices[i]);
+        sourcePaths.append(imageInfo.absoluteFilePath());
+        destinationPaths.append(destinationDirectory + "/" + imageInfo.fileName());
+        geotags.append(_triggerList[_triggerIndices[i]]);
+    }
+    int tagCount = sourcePaths.count();
+    GeoTagPipeline::Job tagJob = [sourcePaths, destinationPaths, geotags](int index) {
+        QString errorString;
+        if (!ExifParser::tagImage(sourcePaths[index], destinationPaths[index], geotags[index], errorString)) {
+            qCDebug(GeotaggingLog) << "Tagging failed" << sourcePaths[index] << errorString;
+            return false;
         }
+        return true;
+    };
+    GeoTagPipeline::ProgressCallback tagProgress = [this, nSteps, tagCount](int completed) {
+        emit progressChanged(4*(100/nSteps) + ((100/nSteps) / tagCount)*completed);
+        return !_cancel;
+    };
+    GeoTagPipeline tagPipeline;
+    bool tagComplete = tagPipeline.run(tagCount, tagJob, tagProgress);
+    if (!tagComplete && !tagPipeline.cancelled()) {
+        emit error(tr("Geotagging failed. Couldn't write to an image."));
+        return;
     }
 
     if (_cancel) {
@@ -0,0 +1,57 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "GeoTagPipeline.h"
+
+#include <QtConcurrent>
+#include <QQueue>
+
+GeoTagPipeline::GeoTagPipeline(int maxInFlight)
+    : _maxInFlight  (qMax(maxInFlight, 1))
+    , _cancelled    (false)
+    , _failedIndex  (-1)
+{
+
+}
+
+bool GeoTagPipeline::run(int count, Job job, ProgressCallback progressCallback)
+{
+    typedef QPair<int, QFuture<bool>> InFlightJob;
+
+    QQueue<InFlightJob> inFlight;
+    int completed = 0;
+    int next = 0;
+
+    _cancelled = false;
+    _failedIndex = -1;
+
+    while (next < count || !inFlight.isEmpty()) {
+        // Keep the queue full unless we are winding down after a failure or cancel
+        while (next < count && inFlight.count() < _maxInFlight && !_cancelled && _failedIndex == -1) {
+            inFlight.enqueue(InFlightJob(next, QtConcurrent::run([job, next]() { return job(next); })));
+            next++;
+        }
+        if (inFlight.isEmpty()) {
+            break;
+        }
+
+        // Jobs complete in roughly submission order so waiting on the oldest keeps all workers busy
+        InFlightJob oldest = inFlight.dequeue();
+        if (!oldest.second.result() && _failedIndex == -1) {
+            _failedIndex = oldest.first;
+        }
+        completed++;
+
+        if (progressCallback && !_cancelled && !progressCallback(completed)) {
+            _cancelled = true;
+        }
+    }
+
+    return !_cancelled && _failedIndex == -1;
+}
@@ -0,0 +1,41 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QThread>
+
+#include <functional>
+
+/// Runs per image jobs on the global thread pool with a bounded number of jobs in flight. Used by GeoTagWorker to
+/// read and write image headers in parallel without queuing thousands of jobs (and their buffers) at once.
+class GeoTagPipeline
+{
+public:
+    /// Job for a single image. Must be safe to run concurrently for different indices.
+    typedef std::function<bool(int index)> Job;
+
+    /// Called from the thread calling run with the number of completed jobs. Return false to cancel.
+    typedef std::function<bool(int completed)> ProgressCallback;
+
+    GeoTagPipeline(int maxInFlight = QThread::idealThreadCount() * 2);
+
+    /// Runs job for indices 0 to count-1. Blocks until all started jobs have finished.
+    /// @return true: all jobs succeeded, false: a job failed or the pipeline was cancelled
+    bool run(int count, Job job, ProgressCallback progressCallback = ProgressCallback());
+
+    int  maxInFlight    (void) const { return _maxInFlight; }
+    bool cancelled      (void) const { return _cancelled; }
+    int  failedIndex    (void) const { return _failedIndex; }   ///< Index of the first job which failed, -1 if none
+
+private:
+    int     _maxInFlight;
+    bool    _cancelled;
+    int     _failedIndex;
+};
@@ -26,67 +26,135 @@
 #include <QSettings>
 #include <QUrl>
 #include <QBitArray>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QSaveFile>
 #include <QtCore/qmath.h>
 
-#define kTimeOutMilliseconds 500
-#define kGUIRateMilliseconds 17
-#define kTableBins           512
-#define kChunkSize           (kTableBins * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)
+#define kTimeOutMilliseconds        500     // Log list timeout, and data timeout until the request latency is known
+#define kMinTimeOutMilliseconds     150
+#define kMaxTimeOutMilliseconds     3000
+#define kTickMilliseconds           50
+#define kThroughputMilliseconds     250
+#define kIndexSaveMilliseconds      1000
+#define kInitialWindowBins          512
+#define kMinWindowBins              16
+#define kMaxWindowBins              8192
+#define kIndexMagic                 0x51474C49
+#define kIndexVersion               1
 
 QGC_LOGGING_CATEGORY(LogDownloadLog, "LogDownloadLog")
 
 //-----------------------------------------------------------------------------
 struct LogDownloadData {
     LogDownloadData(QGCLogEntry* entry);
-    QBitArray     chunk_table;
-    uint32_t      current_chunk;
+    QBitArray     received;         ///< One bit per MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bytes of the log
+    uint32_t      receivedBins;     ///< Number of bits set in received
+    uint32_t      firstMissing;     ///< All bins before this one were received
     QFile         file;
     QString       filename;
     uint          ID;
     QGCLogEntry*  entry;
     uint          written;
-    size_t        rate_bytes;
-    qreal         rate_avg;
-    QElapsedTimer elapsed;
+    bool          indexDirty;       ///< received changed since the index was saved
+    QElapsedTimer indexElapsed;
 
-    void advanceChunk()
+    // The number of MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bins in the file
+    uint32_t binCount() const
     {
-           current_chunk++;
-           chunk_table = QBitArray(chunkBins(), false);
+        return qCeil(entry->size() / static_cast<qreal>(MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN));
     }
 
-    // The number of MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bins in the current chunk
-    uint32_t chunkBins() const
+    // True if all bins have been received
+    bool complete() const
     {
-        return qMin(qCeil((entry->size() - current_chunk*kChunkSize)/static_cast<qreal>(MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)),
-                    kTableBins);
+        return receivedBins == static_cast<uint32_t>(received.size());
     }
 
-    // The number of kChunkSize chunks in the file
-    uint32_t numChunks() const
+    void setReceived(const QBitArray& bins)
     {
-        return qCeil(entry->size() / static_cast<qreal>(kChunkSize));
+        received = bins;
+        receivedBins = bins.count(true);
+        firstMissing = 0;
+        advanceFirstMissing();
     }
 
-    // True if all bins in the chunk have been set to val
-    bool chunkEquals(const bool val) const
+    void advanceFirstMissing()
     {
-        return chunk_table == QBitArray(chunk_table.size(), val);
+        while (firstMissing < static_cast<uint32_t>(received.size()) && received.testBit(firstMissing)) {
+            firstMissing++;
+        }
     }
-
 };
 
 //----------------------------------------------------------------------------------------
 LogDownloadData::LogDownloadData(QGCLogEntry* entry_)
-    : ID(entry_->id())
+    : receivedBins(0)
+    , firstMissing(0)
+    , ID(entry_->id())
     , entry(entry_)
     , written(0)
-    , rate_bytes(0)
-    , rate_avg(0)
+    , indexDirty(false)
+{
+
+}
+
+//-----------------------------------------------------------------------------
+/// Log list and download state of one vehicle
+struct LogDownloadSession {
+    LogDownloadSession(Vehicle* vehicle);
+    ~LogDownloadSession();
+    Vehicle*          vehicle;
+    UASInterface*     uas;
+    QGCLogModel       model;
+    LogDownloadData*  downloadData;
+    QString           downloadPath;
+    bool              requestingList;
+    bool              downloadingLogs;
+    int               retries;
+    int               apmOneBased;
+    QElapsedTimer     activity;         ///< Restarted by each request sent and each message received
+    int               timeoutMSecs;     ///< 0 while nothing is expected from the vehicle
+    uint32_t          requestStart;     ///< First bin of the outstanding data request
+    uint32_t          requestEnd;       ///< Bin after the last one of the outstanding data request
+    uint32_t          requestPending;   ///< Bins of the outstanding request not received yet
+    uint32_t          windowBins;       ///< Maximum size of the next data request
+    QElapsedTimer     requestElapsed;
+    bool              latencyMeasured;  ///< First data of the outstanding request arrived
+    qreal             latencyMSecs;     ///< Smoothed time from a request to its first data, < 0 until measured
+    uint              rateBytes;        ///< Bytes received since the throughput was updated
+    qreal             throughput;       ///< Smoothed bytes per second
+};
+
+//----------------------------------------------------------------------------------------
+LogDownloadSession::LogDownloadSession(Vehicle* vehicle_)
+    : vehicle(vehicle_)
+    , uas(vehicle_->uas())
+    , downloadData(NULL)
+    , requestingList(false)
+    , downloadingLogs(false)
+    , retries(0)
+    , apmOneBased(0)
+    , timeoutMSecs(0)
+    , requestStart(0)
+    , requestEnd(0)
+    , requestPending(0)
+    , windowBins(kInitialWindowBins)
+    , latencyMeasured(false)
+    , latencyMSecs(-1)
+    , rateBytes(0)
+    , throughput(0)
 {
 
 }
 
+//----------------------------------------------------------------------------------------
+LogDownloadSession::~LogDownloadSession()
+{
+    delete downloadData;
+    model.clear();
+}
+
 //----------------------------------------------------------------------------------------
 QGCLogEntry::QGCLogEntry(uint logId, const QDateTime& dateTime, uint logSize, bool received)
     : _logID(logId)
@@ -107,47 +175,218 @@ QGCLogEntry::sizeStr() const
 
 //----------------------------------------------------------------------------------------
 LogDownloadController::LogDownloadController(void)
-    : _uas(NULL)
-    , _downloadData(NULL)
-    , _vehicle(NULL)
-    , _requestingLogEntries(false)
-    , _downloadingLogs(false)
-    , _retries(0)
-    , _apmOneBased(0)
+    : _activeSession(NULL)
+    , _throughput(0)
 {
     MultiVehicleManager *manager = qgcApp()->toolbox()->multiVehicleManager();
     connect(manager, &MultiVehicleManager::activeVehicleChanged, this, &LogDownloadController::_setActiveVehicle);
+    connect(manager, &MultiVehicleManager::vehicleRemoved,       this, &LogDownloadController::_vehicleRemoved);
     connect(&_timer, &QTimer::timeout, this, &LogDownloadController::_processDownload);
+    _timer.setInterval(kTickMilliseconds);
     _setActiveVehicle(manager->activeVehicle());
 }
 
+//----------------------------------------------------------------------------------------
+LogDownloadController::~LogDownloadController()
+{
+    //-- Unfinished downloads keep their index so they can be resumed
+    foreach(LogDownloadSession* session, _sessions) {
+        _closeLogDownload(session);
+        if(session->requestingList || session->downloadingLogs) {
+            session->vehicle->setConnectionLostEnabled(true);
+        }
+        delete session;
+    }
+}
+
+//----------------------------------------------------------------------------------------
+QGCLogModel*
+LogDownloadController::model()
+{
+    return _activeSession ? &_activeSession->model : &_emptyModel;
+}
+
+//----------------------------------------------------------------------------------------
+bool
+LogDownloadController::requestingList()
+{
+    return _activeSession && _activeSession->requestingList;
+}
+
+//----------------------------------------------------------------------------------------
+bool
+LogDownloadController::downloadingLogs()
+{
+    return _activeSession && _activeSession->downloadingLogs;
+}
+
+//----------------------------------------------------------------------------------------
+int
+LogDownloadController::downloadCount()
+{
+    int count = 0;
+    foreach(LogDownloadSession* session, _sessions) {
+        if(session->downloadingLogs) {
+            count++;
+        }
+    }
+    return count;
+}
+
+//----------------------------------------------------------------------------------------
+QString
+LogDownloadController::throughputStr()
+{
+    return QGCMapEngine::bigSizeToString(_throughput);
+}
+
 //----------------------------------------------------------------------------------------
 void
 LogDownloadController::_processDownload()
 {
-    if(_requestingLogEntries) {
-        _findMissingEntries();
-    } else if(_downloadingLogs) {
-        _findMissingData();
+    foreach(LogDownloadSession* session, _sessions) {
+        if(session->timeoutMSecs > 0 && session->activity.elapsed() >= session->timeoutMSecs) {
+            if(session->requestingList) {
+                _findMissingEntries(session);
+            } else if(session->downloadingLogs) {
+                _findMissingData(session);
+            }
+        }
     }
+    _updateThroughput();
+    _updateTimer();
+}
+
+//----------------------------------------------------------------------------------------
+void
+LogDownloadController::_setTimeout(LogDownloadSession* session, int msecs)
+{
+    session->timeoutMSecs = msecs;
+    session->activity.start();
+}
+
+//----------------------------------------------------------------------------------------
+/// The timer only runs while a vehicle is listing or downloading
+void
+LogDownloadController::_updateTimer(void)
+{
+    bool active = false;
+    foreach(LogDownloadSession* session, _sessions) {
+        if(session->requestingList || session->downloadingLogs) {
+            active = true;
+            break;
+        }
+    }
+    if(active && !_timer.isActive()) {
+        _throughputElapsed.start();
+        _timer.start();
+    } else if(!active && _timer.isActive()) {
+        _timer.stop();
+        if(_throughput != 0) {
+            _throughput = 0;
+            emit throughputChanged();
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------
+void
+LogDownloadController::_updateThroughput(void)
+{
+    qint64 elapsed = _throughputElapsed.elapsed();
+    if(elapsed < kThroughputMilliseconds) {
+        return;
+    }
+    _throughputElapsed.start();
+
+    double throughput = 0;
+    foreach(LogDownloadSession* session, _sessions) {
+        LogDownloadData* downloadData = session->downloadData;
+        if(!downloadData) {
+            session->rateBytes = 0;
+            session->throughput = 0;
+            continue;
+        }
+        //-- Update download rate
+        qreal rrate = session->rateBytes / (elapsed / 1000.0);
+        session->throughput = session->throughput * 0.8 + rrate * 0.2;
+        session->rateBytes = 0;
+        throughput += session->throughput;
+
+        //-- Update status
+        quint64 receivedBytes = qMin((quint64)downloadData->receivedBins * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN, (quint64)downloadData->entry->size());
+        const QString status = QString("%1 (%2/s)").arg(QGCMapEngine::bigSizeToString(receivedBytes),
+                                                        QGCMapEngine::bigSizeToString(session->throughput));
+        downloadData->entry->setStatus(status);
+
+        //-- Keep the index current, so little is downloaded again if QGC stops
+        if(downloadData->indexDirty && downloadData->indexElapsed.elapsed() >= kIndexSaveMilliseconds) {
+            _saveIndex(session);
+        }
+    }
+
+    if(throughput != _throughput) {
+        _throughput = throughput;
+        emit throughputChanged();
+    }
+}
+
+//----------------------------------------------------------------------------------------
+LogDownloadSession*
+LogDownloadController::_findSession(UASInterface* uas)
+{
+    foreach(LogDownloadSession* session, _sessions) {
+        if(session->uas == uas) {
+            return session;
+        }
+    }
+    return NULL;
 }
 
 //----------------------------------------------------------------------------------------
 void
 LogDownloadController::_setActiveVehicle(Vehicle* vehicle)
 {
-    if(_uas) {
-        _logEntriesModel.clear();
-        disconnect(_uas, &UASInterface::logEntry, this, &LogDownloadController::_logEntry);
-        disconnect(_uas, &UASInterface::logData,  this, &LogDownloadController::_logData);
-        _uas = NULL;
+    //-- Other vehicles keep their log list and download in the background
+    _activeSession = NULL;
+    if(vehicle) {
+        _activeSession = _sessions.value(vehicle, NULL);
+        if(!_activeSession) {
+            _activeSession = new LogDownloadSession(vehicle);
+            _sessions[vehicle] = _activeSession;
+            connect(_activeSession->uas, &UASInterface::logEntry, this, &LogDownloadController::_logEntry);
+            connect(_activeSession->uas, &UASInterface::logData,  this, &LogDownloadController::_logData);
+        }
+    }
+    emit modelChanged();
+    emit requestingListChanged();
+    emit downloadingLogsChanged();
+    emit selectionChanged();
+}
+
+//----------------------------------------------------------------------------------------
+void
+LogDownloadController::_vehicleRemoved(Vehicle* vehicle)
+{
+    LogDownloadSession* session = _sessions.take(vehicle);
+    if(!session) {
+        return;
     }
-    _vehicle = vehicle;
-    if(_vehicle) {
-        _uas = vehicle->uas();
-        connect(_uas, &UASInterface::logEntry, this, &LogDownloadController::_logEntry);
-        connect(_uas, &UASInterface::logData,  this, &LogDownloadController::_logData);
+    disconnect(session->uas, &UASInterface::logEntry, this, &LogDownloadController::_logEntry);
+    disconnect(session->uas, &UASInterface::logData,  this, &LogDownloadController::_logData);
+    //-- Keep what was received, the download resumes once the vehicle is back
+    _closeLogDownload(session);
+    if(session == _activeSession) {
+        _activeSession = NULL;
+        emit modelChanged();
+        emit requestingListChanged();
+        emit downloadingLogsChanged();
+    }
+    if(session->downloadingLogs) {
+        emit downloadCountChanged();
     }
+    delete session;
+    _updateTimer();
 }
 
 //----------------------------------------------------------------------------------------
@@ -155,28 +394,29 @@ void
 LogDownloadController::_logEntry(UASInterface* uas, uint32_t time_utc, uint32_t size, uint16_t id, uint16_t num_logs, uint16_t /*last_log_num*/)
 {
     //-- Do we care?
-    if(!_uas || uas != _uas || !_requestingLogEntries) {
+    LogDownloadSession* session = _findSession(uas);
+    if(!session || !session->requestingList) {
         return;
     }
     //-- If this is the first, pre-fill it
-    if(!_logEntriesModel.count() && num_logs > 0) {
+    if(!session->model.count() && num_logs > 0) {
         //-- Is this APM? They send a first entry with bogus ID and only the
         //   count is valid. From now on, all entries are 1-based.
-        if(_vehicle->firmwareType() == MAV_AUTOPILOT_ARDUPILOTMEGA) {
-            _apmOneBased = 1;
+        if(session->vehicle->firmwareType() == MAV_AUTOPILOT_ARDUPILOTMEGA) {
+            session->apmOneBased = 1;
         }
         for(int i = 0; i < num_logs; i++) {
             QGCLogEntry *entry = new QGCLogEntry(i);
-            _logEntriesModel.append(entry);
+            session->model.append(entry);
         }
     }
     //-- Update this log record
     if(num_logs > 0) {
         //-- Skip if empty (APM first packet)
-        if(size || _vehicle->firmwareType() != MAV_AUTOPILOT_ARDUPILOTMEGA) {
-            id -= _apmOneBased;
-            if(id < _logEntriesModel.count()) {
-                QGCLogEntry* entry = _logEntriesModel[id];
+        if(size || session->vehicle->firmwareType() != MAV_AUTOPILOT_ARDUPILOTMEGA) {
+            id -= session->apmOneBased;
+            if(id < session->model.count()) {
+                QGCLogEntry* entry = session->model[id];
                 entry->setSize(size);
                 entry->setTime(QDateTime::fromTime_t(time_utc));
                 entry->setReceived(true);
@@ -187,27 +427,27 @@ LogDownloadController::_logEntry(UASInterface* uas, uint32_t time_utc, uint32_t
         }
     } else {
         //-- No logs to list
-        _receivedAllEntries();
+        _receivedAllEntries(session);
     }
     //-- Reset retry count
-    _retries = 0;
+    session->retries = 0;
     //-- Do we have it all?
-    if(_entriesComplete()) {
-        _receivedAllEntries();
+    if(_entriesComplete(session)) {
+        _receivedAllEntries(session);
     } else {
         //-- Reset timer
-        _timer.start(kTimeOutMilliseconds);
+        _setTimeout(session, kTimeOutMilliseconds);
     }
 }
 
 //----------------------------------------------------------------------------------------
 bool
-LogDownloadController::_entriesComplete()
+LogDownloadController::_entriesComplete(LogDownloadSession* session)
 {
     //-- Iterate entries and look for a gap
-    int num_logs = _logEntriesModel.count();
+    int num_logs = session->model.count();
     for(int i = 0; i < num_logs; i++) {
-        QGCLogEntry* entry = _logEntriesModel[i];
+        QGCLogEntry* entry = session->model[i];
         if(entry) {
             if(!entry->received()) {
                return false;
@@ -219,11 +459,11 @@ LogDownloadController::_entriesComplete()
 
 //----------------------------------------------------------------------------------------
 void
-LogDownloadController::_resetSelection(bool canceled)
+LogDownloadController::_resetSelection(LogDownloadSession* session, bool canceled)
 {
-    int num_logs = _logEntriesModel.count();
+    int num_logs = session->model.count();
     for(int i = 0; i < num_logs; i++) {
-        QGCLogEntry* entry = _logEntriesModel[i];
+        QGCLogEntry* entry = session->model[i];
         if(entry) {
             if(entry->selected()) {
                 if(canceled) {
@@ -233,27 +473,29 @@ LogDownloadController::_resetSelection(bool canceled)
             }
         }
     }
-    emit selectionChanged();
+    if(session == _activeSession) {
+        emit selectionChanged();
+    }
 }
 
 //----------------------------------------------------------------------------------------
 void
-LogDownloadController::_receivedAllEntries()
+LogDownloadController::_receivedAllEntries(LogDownloadSession* session)
 {
-    _timer.stop();
-    _setListing(false);
+    _setTimeout(session, 0);
+    _setListing(session, false);
 }
 
 //----------------------------------------------------------------------------------------
 void
-LogDownloadController::_findMissingEntries()
+LogDownloadController::_findMissingEntries(LogDownloadSession* session)
 {
     int start = -1;
     int end   = -1;
-    int num_logs = _logEntriesModel.count();
+    int num_logs = session->model.count();
     //-- Iterate entries and look for a gap
     for(int i = 0; i < num_logs; i++) {
-        QGCLogEntry* entry = _logEntriesModel[i];
+        QGCLogEntry* entry = session->model[i];
         if(entry) {
             if(!entry->received()) {
                 if(start < 0)
@@ -270,15 +512,15 @@ LogDownloadController::_findMissingEntries()
     //-- Is there something missing?
     if(start >= 0) {
         //-- Have we tried too many times?
-        if(_retries++ > 2) {
+        if(session->retries++ > 2) {
             for(int i = 0; i < num_logs; i++) {
-                QGCLogEntry* entry = _logEntriesModel[i];
+                QGCLogEntry* entry = session->model[i];
                 if(entry && !entry->received()) {
                     entry->setStatus(QString(tr("Error")));
                 }
             }
             //-- Give up
-            _receivedAllEntries();
+            _receivedAllEntries(session);
             qWarning() << "Too many errors retreiving log list. Giving up.";
             return;
         }
@@ -287,12 +529,12 @@ LogDownloadController::_findMissingEntries()
             end = start;
         }
         //-- APM "Fix"
-        start += _apmOneBased;
-        end   += _apmOneBased;
+        start += session->apmOneBased;
+        end   += session->apmOneBased;
         //-- Request these entries again
-        _requestLogList((uint32_t)start, (uint32_t) end);
+        _requestLogList(session, (uint32_t)start, (uint32_t) end);
     } else {
-        _receivedAllEntries();
+        _receivedAllEntries(session);
     }
 }
 
@@ -300,12 +542,14 @@ LogDownloadController::_findMissingEntries()
 void
 LogDownloadController::_logData(UASInterface* uas, uint32_t ofs, uint16_t id, uint8_t count, const uint8_t* data)
 {
-    if(!_uas || uas != _uas || !_downloadData) {
+    LogDownloadSession* session = _findSession(uas);
+    if(!session || !session->downloadData) {
         return;
     }
+    LogDownloadData* downloadData = session->downloadData;
     //-- APM "Fix"
-    id -= _apmOneBased;
-    if(_downloadData->ID != id) {
+    id -= session->apmOneBased;
+    if(downloadData->ID != id) {
         qWarning() << "Received log data for wrong log";
         return;
     }
@@ -315,192 +559,205 @@ LogDownloadController::_logData(UASInterface* uas, uint32_t ofs, uint16_t id, ui
         return;
     }
 
-    bool result = false;
-    uint32_t timeout_time = kTimeOutMilliseconds;
-    if(ofs <= _downloadData->entry->size()) {
-        const uint32_t chunk = ofs / kChunkSize;
-        if (chunk != _downloadData->current_chunk) {
-            qWarning() << "Ignored packet for out of order chunk" << chunk;
-            return;
-        }
-        const uint16_t bin = (ofs - chunk*kChunkSize) / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-        if (bin >= _downloadData->chunk_table.size()) {
-            qWarning() << "Out of range bin received";
-        } else
-            _downloadData->chunk_table.setBit(bin);
-        if (_downloadData->file.pos() != ofs) {
+    //-- Vehicles answer a request past the end with an empty packet
+    if(count == 0) {
+        return;
+    }
+
+    const uint32_t bin = ofs / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+    if(bin >= static_cast<uint32_t>(downloadData->received.size())) {
+        qWarning() << "Received log offset greater than expected";
+        return;
+    }
+
+    //-- The vehicle is still sending, reset retries and timer
+    session->retries = 0;
+    session->activity.start();
+
+    const bool inRequest = bin >= session->requestStart && bin < session->requestEnd;
+    if(inRequest && !session->latencyMeasured) {
+        qreal latency = session->requestElapsed.elapsed();
+        session->latencyMeasured = true;
+        session->latencyMSecs = session->latencyMSecs < 0 ? latency : session->latencyMSecs * 0.875 + latency * 0.125;
+        session->timeoutMSecs = _dataTimeout(session);
+    }
+
+    //-- Bins received before, from a repeated request or a resumed download, are not written again
+    if(!downloadData->received.testBit(bin)) {
+        if (downloadData->file.pos() != ofs) {
             // Seek to correct position
-            if (!_downloadData->file.seek(ofs)) {
+            if (!downloadData->file.seek(ofs)) {
                 qWarning() << "Error while seeking log file offset";
+                downloadData->entry->setStatus(QString(tr("Error")));
                 return;
             }
         }
 
-        //-- Write chunk to file
-        if(_downloadData->file.write((const char*)data, count)) {
-            _downloadData->written += count;
-            _downloadData->rate_bytes += count;
-            if (_downloadData->elapsed.elapsed() >= kGUIRateMilliseconds) {
-                //-- Update download rate
-                qreal rrate = _downloadData->rate_bytes/(_downloadData->elapsed.elapsed()/1000.0);
-                _downloadData->rate_avg = _downloadData->rate_avg*0.95 + rrate*0.05;
-                _downloadData->rate_bytes = 0;
-
-                //-- Update status
-                const QString status = QString("%1 (%2/s)").arg(QGCMapEngine::bigSizeToString(_downloadData->written),
-                                                                QGCMapEngine::bigSizeToString(_downloadData->rate_avg));
-
-                _downloadData->entry->setStatus(status);
-                _downloadData->elapsed.start();
-            }
-            result = true;
-            //-- reset retries
-            _retries = 0;
-            //-- Reset timer
-            _timer.start(timeout_time);
-            //-- Do we have it all?
-            if(_logComplete()) {
-                _downloadData->entry->setStatus(QString(tr("Downloaded")));
-                //-- Check for more
-                _receivedAllData();
-            } else if (_chunkComplete()) {
-                _downloadData->advanceChunk();
-                _requestLogData(_downloadData->ID,
-                                _downloadData->current_chunk*kChunkSize,
-                                _downloadData->chunk_table.size()*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-            } else if (bin < _downloadData->chunk_table.size() - 1 && _downloadData->chunk_table.at(bin+1)) {
-                // Likely to be grabbing fragments and got to the end of a gap
-                _findMissingData();
-            }
-        } else {
+        //-- Write bin to file
+        if(downloadData->file.write((const char*)data, count) != count) {
             qWarning() << "Error while writing log file chunk";
+            downloadData->entry->setStatus(QString(tr("Error")));
+            return;
+        }
+        downloadData->received.setBit(bin);
+        downloadData->receivedBins++;
+        downloadData->indexDirty = true;
+        downloadData->written += count;
+        session->rateBytes += count;
+        if(inRequest) {
+            session->requestPending--;
         }
-    } else {
-        qWarning() << "Received log offset greater than expected";
     }
-    if(!result) {
-        _downloadData->entry->setStatus(QString(tr("Error")));
+
+    //-- The request is done once its last bin arrived, bins lost on the way are requested again
+    if(downloadData->complete() || session->requestPending == 0 || bin + 1 == session->requestEnd) {
+        _requestCompleted(session);
     }
 }
 
+//----------------------------------------------------------------------------------------
+/// Adapts the window to the loss of the completed request and sends the next request
+void
+LogDownloadController::_requestCompleted(LogDownloadSession* session)
+{
+    const uint32_t requested = session->requestEnd - session->requestStart;
+    //-- Scattered loss is just requested again, losing a large part of the request means the link
+    //   or the vehicle could not keep up with its size
+    if(session->requestPending <= requested / 8) {
+        session->windowBins = qMin(session->windowBins + requested, (uint32_t)kMaxWindowBins);
+    } else {
+        qCDebug(LogDownloadLog) << "Request lost" << session->requestPending << "of" << requested << "bins";
+        session->windowBins = qMax(session->windowBins / 2, (uint32_t)kMinWindowBins);
+    }
+    _requestNextData(session);
+}
 
 //----------------------------------------------------------------------------------------
-bool
-LogDownloadController::_chunkComplete() const
+/// Requests the first gap in the received data, up to the window size
+void
+LogDownloadController::_requestNextData(LogDownloadSession* session)
 {
-    return _downloadData->chunkEquals(true);
+    LogDownloadData* downloadData = session->downloadData;
+    downloadData->advanceFirstMissing();
+    if(downloadData->complete()) {
+        downloadData->entry->setStatus(QString(tr("Downloaded")));
+        //-- Check for more
+        _receivedAllData(session);
+        return;
+    }
+
+    const uint32_t binCount = downloadData->received.size();
+    const uint32_t start = downloadData->firstMissing;
+    uint32_t end = start;
+    while(end < binCount && end - start < session->windowBins && !downloadData->received.testBit(end)) {
+        end++;
+    }
+
+    session->requestStart   = start;
+    session->requestEnd     = end;
+    session->requestPending = end - start;
+    session->latencyMeasured = false;
+    session->requestElapsed.start();
+    _requestLogData(session, downloadData->ID, start * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN, (end - start) * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
+    _setTimeout(session, _dataTimeout(session));
 }
 
 //----------------------------------------------------------------------------------------
-bool
-LogDownloadController::_logComplete() const
+/// Nothing is received for a few request latencies before a request is taken as lost
+int
+LogDownloadController::_dataTimeout(LogDownloadSession* session) const
 {
-    return _chunkComplete() && (_downloadData->current_chunk+1) == _downloadData->numChunks();
+    if(session->latencyMSecs < 0) {
+        return kTimeOutMilliseconds;
+    }
+    return qBound(kMinTimeOutMilliseconds, qRound(session->latencyMSecs * 4), kMaxTimeOutMilliseconds);
 }
 
 //----------------------------------------------------------------------------------------
 void
-LogDownloadController::_receivedAllData()
+LogDownloadController::_receivedAllData(LogDownloadSession* session)
 {
-    _timer.stop();
+    _setTimeout(session, 0);
     //-- Anything queued up for download?
-    if(_prepareLogDownload()) {
+    if(_prepareLogDownload(session)) {
         //-- Request Log
-        _requestLogData(_downloadData->ID, 0, _downloadData->chunk_table.size()*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
+        _requestNextData(session);
     } else {
-        _resetSelection();
-        _setDownloading(false);
+        _resetSelection(session);
+        _setDownloading(session, false);
     }
 }
 
 //----------------------------------------------------------------------------------------
 void
-LogDownloadController::_findMissingData()
+LogDownloadController::_findMissingData(LogDownloadSession* session)
 {
-    if (_logComplete()) {
-         _receivedAllData();
-         return;
-    } else if (_chunkComplete()) {
-        _downloadData->advanceChunk();
-    }
-
-    if(_retries++ > 2) {
-        _downloadData->entry->setStatus(QString(tr("Timed Out")));
-        //-- Give up
+    if(session->retries++ > 2) {
+        session->downloadData->entry->setStatus(QString(tr("Timed Out")));
+        //-- Give up, what was received so far is kept for resuming
         qWarning() << "Too many errors retreiving log data. Giving up.";
-        _receivedAllData();
+        _receivedAllData(session);
         return;
     }
 
-    uint16_t start = 0, end = 0;
-    const int size = _downloadData->chunk_table.size();
-    for (; start < size; start++) {
-        if (!_downloadData->chunk_table.testBit(start)) {
-            break;
-        }
-    }
-
-    for (end = start; end < size; end++) {
-        if (_downloadData->chunk_table.testBit(end)) {
-            break;
-        }
+    //-- Nothing arrived in time, back off in both request size and timeout
+    session->windowBins = qMax(session->windowBins / 2, (uint32_t)kMinWindowBins);
+    if(session->latencyMSecs >= 0) {
+        session->latencyMSecs = qMin(session->latencyMSecs * 2, (qreal)kMaxTimeOutMilliseconds);
     }
-
-    const uint32_t pos = _downloadData->current_chunk*kChunkSize + start*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN,
-                   len = (end - start)*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-    _requestLogData(_downloadData->ID, pos, len);
+    _requestNextData(session);
 }
 
 //----------------------------------------------------------------------------------------
 void
-LogDownloadController::_requestLogData(uint8_t id, uint32_t offset, uint32_t count)
+LogDownloadController::_requestLogData(LogDownloadSession* session, uint8_t id, uint32_t offset, uint32_t count)
 {
-    if(_vehicle) {
-        //-- APM "Fix"
-        id += _apmOneBased;
-        qCDebug(LogDownloadLog) << "Request log data (id:" << id << "offset:" << offset << "size:" << count << ")";
-        mavlink_message_t msg;
-        mavlink_msg_log_request_data_pack_chan(
-                    qgcApp()->toolbox()->mavlinkProtocol()->getSystemId(),
-                    qgcApp()->toolbox()->mavlinkProtocol()->getComponentId(),
-                    _vehicle->priorityLink()->mavlinkChannel(),
-                    &msg,
-                    qgcApp()->toolbox()->multiVehicleManager()->activeVehicle()->id(), qgcApp()->toolbox()->multiVehicleManager()->activeVehicle()->defaultComponentId(),
-                    id, offset, count);
-        _vehicle->sendMessageOnLink(_vehicle->priorityLink(), msg);
-    }
+    Vehicle* vehicle = session->vehicle;
+    //-- APM "Fix"
+    id += session->apmOneBased;
+    qCDebug(LogDownloadLog) << "Request log data (id:" << id << "offset:" << offset << "size:" << count << ")";
+    mavlink_message_t msg;
+    mavlink_msg_log_request_data_pack_chan(
+                qgcApp()->toolbox()->mavlinkProtocol()->getSystemId(),
+                qgcApp()->toolbox()->mavlinkProtocol()->getComponentId(),
+                vehicle->priorityLink()->mavlinkChannel(),
+                &msg,
+                vehicle->id(), vehicle->defaultComponentId(),
+                id, offset, count);
+    vehicle->sendMessageOnLink(vehicle->priorityLink(), msg);
 }
 
 //----------------------------------------------------------------------------------------
 void
 LogDownloadController::refresh(void)
 {
-    _logEntriesModel.clear();
-    //-- Get first 50 entries
-    _requestLogList(0, 49);
+    if(_activeSession) {
+        _activeSession->model.clear();
+        //-- Get first 50 entries
+        _requestLogList(_activeSession, 0, 49);
+    }
 }
 
 //----------------------------------------------------------------------------------------
 void
-LogDownloadController::_requestLogList(uint32_t start, uint32_t end)
+LogDownloadController::_requestLogList(LogDownloadSession* session, uint32_t start, uint32_t end)
 {
-    if(_vehicle && _uas) {
-        qCDebug(LogDownloadLog) << "Request log entry list (" << start << "through" << end << ")";
-        _setListing(true);
-        mavlink_message_t msg;
-        mavlink_msg_log_request_list_pack_chan(
-                    qgcApp()->toolbox()->mavlinkProtocol()->getSystemId(),
-                    qgcApp()->toolbox()->mavlinkProtocol()->getComponentId(),
-                    _vehicle->priorityLink()->mavlinkChannel(),
-                    &msg,
-                    _vehicle->id(),
-                    _vehicle->defaultComponentId(),
-                    start,
-                    end);
-        _vehicle->sendMessageOnLink(_vehicle->priorityLink(), msg);
-        //-- Wait 5 seconds before bitching about not getting anything
-        _timer.start(5000);
-    }
+    Vehicle* vehicle = session->vehicle;
+    qCDebug(LogDownloadLog) << "Request log entry list (" << start << "through" << end << ")";
+    _setListing(session, true);
+    mavlink_message_t msg;
+    mavlink_msg_log_request_list_pack_chan(
+                qgcApp()->toolbox()->mavlinkProtocol()->getSystemId(),
+                qgcApp()->toolbox()->mavlinkProtocol()->getComponentId(),
+                vehicle->priorityLink()->mavlinkChannel(),
+                &msg,
+                vehicle->id(),
+                vehicle->defaultComponentId(),
+                start,
+                end);
+    vehicle->sendMessageOnLink(vehicle->priorityLink(), msg);
+    //-- Wait 5 seconds before bitching about not getting anything
+    _setTimeout(session, 5000);
 }
 
 //----------------------------------------------------------------------------------------
@@ -526,21 +783,22 @@ LogDownloadController::download(QString path)
 
 void LogDownloadController::downloadToDirectory(const QString& dir)
 {
+    LogDownloadSession* session = _activeSession;
+    if(!session) {
+        return;
+    }
     //-- Stop listing just in case
-    _receivedAllEntries();
+    _receivedAllEntries(session);
     //-- Reset downloads, again just in case
-    if(_downloadData) {
-        delete _downloadData;
-        _downloadData = 0;
-    }
-    _downloadPath = dir;
-    if(!_downloadPath.isEmpty()) {
-        if(!_downloadPath.endsWith(QDir::separator()))
-            _downloadPath += QDir::separator();
+    _closeLogDownload(session);
+    session->downloadPath = dir;
+    if(!session->downloadPath.isEmpty()) {
+        if(!session->downloadPath.endsWith(QDir::separator()))
+            session->downloadPath += QDir::separator();
         //-- Iterate selected entries and shown them as waiting
-        int num_logs = _logEntriesModel.count();
+        int num_logs = session->model.count();
         for(int i = 0; i < num_logs; i++) {
-            QGCLogEntry* entry = _logEntriesModel[i];
+            QGCLogEntry* entry = session->model[i];
             if(entry) {
                 if(entry->selected()) {
                    entry->setStatus(QString(tr("Waiting")));
@@ -548,20 +806,20 @@ void LogDownloadController::downloadToDirectory(const QString& dir)
             }
         }
         //-- Start download process
-        _setDownloading(true);
-        _receivedAllData();
+        _setDownloading(session, true);
+        _receivedAllData(session);
     }
 }
 
 
 //----------------------------------------------------------------------------------------
 QGCLogEntry*
-LogDownloadController::_getNextSelected()
+LogDownloadController::_getNextSelected(LogDownloadSession* session)
 {
     //-- Iterate entries and look for a selected file
-    int num_logs = _logEntriesModel.count();
+    int num_logs = session->model.count();
     for(int i = 0; i < num_logs; i++) {
-        QGCLogEntry* entry = _logEntriesModel[i];
+        QGCLogEntry* entry = session->model[i];
         if(entry) {
             if(entry->selected()) {
                return entry;
@@ -573,109 +831,215 @@ LogDownloadController::_getNextSelected()
 
 //----------------------------------------------------------------------------------------
 bool
-LogDownloadController::_prepareLogDownload()
+LogDownloadController::_prepareLogDownload(LogDownloadSession* session)
 {
-    if(_downloadData) {
-        delete _downloadData;
-        _downloadData = NULL;
-    }
-    QGCLogEntry* entry = _getNextSelected();
+    _closeLogDownload(session);
+    QGCLogEntry* entry = _getNextSelected(session);
     if(!entry) {
         return false;
     }
     //-- Deselect file
     entry->setSelected(false);
-    emit selectionChanged();
-    bool result = false;
+    if(session == _activeSession) {
+        emit selectionChanged();
+    }
     QString ftime;
     if(entry->time().date().year() < 2010) {
         ftime = "UnknownDate";
     } else {
         ftime = entry->time().toString("yyyy-M-d-hh-mm-ss");
     }
-    _downloadData = new LogDownloadData(entry);
-    _downloadData->filename = QString("log_") + QString::number(entry->id()) + "_" + ftime;
-    if (_vehicle->firmwareType() == MAV_AUTOPILOT_PX4) {
+    Vehicle* vehicle = session->vehicle;
+    session->downloadData = new LogDownloadData(entry);
+    session->downloadData->filename = QString("log_") + QString::number(entry->id()) + "_" + ftime;
+    if (vehicle->firmwareType() == MAV_AUTOPILOT_PX4) {
         QString loggerParam("SYS_LOGGER");
-        if (_vehicle->parameterManager()->parameterExists(FactSystem::defaultComponentId, loggerParam) &&
-                _vehicle->parameterManager()->getParameter(FactSystem::defaultComponentId, loggerParam)->rawValue().toInt() == 0) {
-            _downloadData->filename += ".px4log";
+        if (vehicle->parameterManager()->parameterExists(FactSystem::defaultComponentId, loggerParam) &&
+                vehicle->parameterManager()->getParameter(FactSystem::defaultComponentId, loggerParam)->rawValue().toInt() == 0) {
+            session->downloadData->filename += ".px4log";
         } else {
-            _downloadData->filename += ".ulg";
+            session->downloadData->filename += ".ulg";
         }
     } else {
-        _downloadData->filename += ".bin";
-    }
-    _downloadData->file.setFileName(_downloadPath + _downloadData->filename);
-    //-- Append a number to the end if the filename already exists
-    if (_downloadData->file.exists()){
-        uint num_dups = 0;
-        QStringList filename_spl = _downloadData->filename.split('.');
-        do {
-            num_dups +=1;
-            _downloadData->file.setFileName(filename_spl[0] + '_' + QString::number(num_dups) + '.' + filename_spl[1]);
-        } while( _downloadData->file.exists());
-    }
-    //-- Create file
-    if (!_downloadData->file.open(QIODevice::WriteOnly)) {
-        qWarning() << "Failed to create log file:" <<  _downloadData->filename;
-    } else {
-        //-- Preallocate file
-        if(!_downloadData->file.resize(entry->size())) {
-            qWarning() << "Failed to allocate space for log file:" <<  _downloadData->filename;
-        } else {
-            _downloadData->current_chunk = 0;
-            _downloadData->chunk_table = QBitArray(_downloadData->chunkBins(), false);
-            _downloadData->elapsed.start();
-            result = true;
+        session->downloadData->filename += ".bin";
+    }
+    if(!_openLogFile(session)) {
+        entry->setStatus(QString(tr("Error")));
+        delete session->downloadData;
+        session->downloadData = NULL;
+        return false;
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------------------
+/// Opens the partial file of an interrupted download of the same log, or creates a new file
+bool
+LogDownloadController::_openLogFile(LogDownloadSession* session)
+{
+    LogDownloadData* downloadData = session->downloadData;
+    QGCLogEntry* entry = downloadData->entry;
+    QBitArray received(downloadData->binCount(), false);
+    bool resume = false;
+
+    //-- Append a number to the end if the filename already exists and is not a partial download of this log
+    QFileInfo fileInfo(downloadData->filename);
+    QString path = session->downloadPath + downloadData->filename;
+    uint num_dups = 0;
+    while(QFile::exists(path)) {
+        if(readIndex(path, session->vehicle->id(), entry->id(), entry->size(), entry->time().toTime_t(), received)) {
+            resume = true;
+            break;
         }
+        num_dups += 1;
+        path = session->downloadPath + fileInfo.completeBaseName() + '_' + QString::number(num_dups) + '.' + fileInfo.suffix();
+    }
+    downloadData->file.setFileName(path);
+
+    //-- Create file, a partial file is opened without truncating it
+    if (!downloadData->file.open(resume ? QIODevice::ReadWrite : QIODevice::WriteOnly)) {
+        qWarning() << "Failed to create log file:" << path;
+        return false;
     }
-    if(!result) {
-        if (_downloadData->file.exists()) {
-            _downloadData->file.remove();
+    //-- Preallocate file
+    if(!downloadData->file.resize(entry->size())) {
+        qWarning() << "Failed to allocate space for log file:" << path;
+        downloadData->file.close();
+        if(!resume) {
+            downloadData->file.remove();
         }
-        _downloadData->entry->setStatus(QString(tr("Error")));
-        delete _downloadData;
-        _downloadData = NULL;
+        return false;
+    }
+    downloadData->setReceived(received);
+    if(resume) {
+        qCDebug(LogDownloadLog) << "Resuming log download" << path << "with" << downloadData->receivedBins << "of" << received.size() << "bins";
     }
-    return result;
+    //-- The index is there from the start, so the download can resume even if QGC stops before the next save
+    _saveIndex(session);
+    return true;
 }
 
 //----------------------------------------------------------------------------------------
+/// Closes the log being downloaded. An incomplete log keeps its index for resuming.
 void
-LogDownloadController::_setDownloading(bool active)
+LogDownloadController::_closeLogDownload(LogDownloadSession* session)
 {
-    if (_downloadingLogs != active) {
-        _downloadingLogs = active;
-        _vehicle->setConnectionLostEnabled(!active);
-        emit downloadingLogsChanged();
+    LogDownloadData* downloadData = session->downloadData;
+    if(!downloadData) {
+        return;
+    }
+    if(downloadData->complete()) {
+        downloadData->file.close();
+        QFile::remove(indexFilename(downloadData->file.fileName()));
+    } else {
+        _saveIndex(session);
+        downloadData->file.close();
     }
+    delete downloadData;
+    session->downloadData = NULL;
 }
 
 //----------------------------------------------------------------------------------------
 void
-LogDownloadController::_setListing(bool active)
+LogDownloadController::_saveIndex(LogDownloadSession* session)
 {
-    if (_requestingLogEntries != active) {
-        _requestingLogEntries = active;
-        _vehicle->setConnectionLostEnabled(!active);
-        emit requestingListChanged();
+    LogDownloadData* downloadData = session->downloadData;
+    QGCLogEntry* entry = downloadData->entry;
+    //-- The data must be written out before the index claims it was received
+    downloadData->file.flush();
+    if(!writeIndex(downloadData->file.fileName(), session->vehicle->id(), entry->id(), entry->size(), entry->time().toTime_t(), downloadData->received)) {
+        qWarning() << "Failed to write log download index:" << indexFilename(downloadData->file.fileName());
+    }
+    downloadData->indexDirty = false;
+    downloadData->indexElapsed.start();
+}
+
+//----------------------------------------------------------------------------------------
+bool
+LogDownloadController::writeIndex(const QString& logFilename, int sysid, uint logId, uint logSize, uint timeUTC, const QBitArray& received)
+{
+    //-- QSaveFile so that a crash while saving never leaves a truncated index behind
+    QSaveFile file(indexFilename(logFilename));
+    if(!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream << (quint32)kIndexMagic << (quint32)kIndexVersion << (qint32)sysid << (quint32)logId << (quint32)logSize << (quint32)timeUTC << received;
+    if(stream.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
     }
+    return file.commit();
+}
+
+//----------------------------------------------------------------------------------------
+bool
+LogDownloadController::readIndex(const QString& logFilename, int sysid, uint logId, uint logSize, uint timeUTC, QBitArray& received)
+{
+    QFile file(indexFilename(logFilename));
+    if(!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    quint32     magic, version, indexLogId, indexLogSize, indexTimeUTC;
+    qint32      indexSysid;
+    QBitArray   indexReceived;
+    stream >> magic >> version;
+    if(stream.status() != QDataStream::Ok || magic != kIndexMagic || version != kIndexVersion) {
+        return false;
+    }
+    stream >> indexSysid >> indexLogId >> indexLogSize >> indexTimeUTC >> indexReceived;
+    if(stream.status() != QDataStream::Ok || indexSysid != sysid || indexLogId != logId || indexLogSize != logSize || indexTimeUTC != timeUTC ||
+            indexReceived.size() != qCeil(logSize / static_cast<qreal>(MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN))) {
+        return false;
+    }
+    received = indexReceived;
+    return true;
+}
+
+//----------------------------------------------------------------------------------------
+void
+LogDownloadController::_setDownloading(LogDownloadSession* session, bool active)
+{
+    if (session->downloadingLogs != active) {
+        session->downloadingLogs = active;
+        session->vehicle->setConnectionLostEnabled(!active);
+        if(session == _activeSession) {
+            emit downloadingLogsChanged();
+        }
+        emit downloadCountChanged();
+    }
+    _updateTimer();
+}
+
+//----------------------------------------------------------------------------------------
+void
+LogDownloadController::_setListing(LogDownloadSession* session, bool active)
+{
+    if (session->requestingList != active) {
+        session->requestingList = active;
+        session->vehicle->setConnectionLostEnabled(!active);
+        if(session == _activeSession) {
+            emit requestingListChanged();
+        }
+    }
+    _updateTimer();
 }
 
 //----------------------------------------------------------------------------------------
 void
 LogDownloadController::eraseAll(void)
 {
-    if(_vehicle && _uas) {
+    if(_activeSession) {
+        Vehicle* vehicle = _activeSession->vehicle;
         mavlink_message_t msg;
         mavlink_msg_log_erase_pack_chan(
                     qgcApp()->toolbox()->mavlinkProtocol()->getSystemId(),
                     qgcApp()->toolbox()->mavlinkProtocol()->getComponentId(),
-                    _vehicle->priorityLink()->mavlinkChannel(),
+                    vehicle->priorityLink()->mavlinkChannel(),
                     &msg,
-                    qgcApp()->toolbox()->multiVehicleManager()->activeVehicle()->id(), qgcApp()->toolbox()->multiVehicleManager()->activeVehicle()->defaultComponentId());
-        _vehicle->sendMessageOnLink(_vehicle->priorityLink(), msg);
+                    vehicle->id(), vehicle->defaultComponentId());
+        vehicle->sendMessageOnLink(vehicle->priorityLink(), msg);
         refresh();
     }
 }
@@ -684,19 +1048,25 @@ LogDownloadController::eraseAll(void)
 void
 LogDownloadController::cancel(void)
 {
-    if(_uas){
-        _receivedAllEntries();
+    LogDownloadSession* session = _activeSession;
+    if(!session) {
+        return;
     }
-    if(_downloadData) {
-        _downloadData->entry->setStatus(QString(tr("Canceled")));
-        if (_downloadData->file.exists()) {
-            _downloadData->file.remove();
+    _receivedAllEntries(session);
+    if(session->downloadData) {
+        //-- A canceled download is not kept for resuming
+        LogDownloadData* downloadData = session->downloadData;
+        downloadData->entry->setStatus(QString(tr("Canceled")));
+        downloadData->file.close();
+        QFile::remove(indexFilename(downloadData->file.fileName()));
+        if (downloadData->file.exists()) {
+            downloadData->file.remove();
         }
-        delete _downloadData;
-        _downloadData = 0;
+        delete downloadData;
+        session->downloadData = NULL;
     }
-    _resetSelection(true);
-    _setDownloading(false);
+    _resetSelection(session, true);
+    _setDownloading(session, false);
 }
 
 //-----------------------------------------------------------------------------
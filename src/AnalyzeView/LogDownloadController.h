@@ -16,6 +16,8 @@
 #include <QAbstractListModel>
 #include <QLocale>
 #include <QElapsedTimer>
+#include <QBitArray>
+#include <QMap>
 
 #include <memory>
 
@@ -27,6 +29,7 @@ class  UASInterface;
 class  Vehicle;
 class  QGCLogEntry;
 struct LogDownloadData;
+struct LogDownloadSession;
 
 Q_DECLARE_LOGGING_CATEGORY(LogDownloadLog)
 
@@ -109,20 +112,31 @@ private:
 };
 
 //-----------------------------------------------------------------------------
+/// Lists and downloads onboard logs. Each vehicle has its own log list and download queue, downloads of several
+/// vehicles run in parallel while the page shows the active vehicle. Log data is requested in windows whose size
+/// adapts to the loss seen on the link. The received ranges of a log are kept in an index file next to the log
+/// until the download completes, so an interrupted download resumes where it stopped.
 class LogDownloadController : public QObject
 {
     Q_OBJECT
 
 public:
     LogDownloadController(void);
+    ~LogDownloadController();
 
     Q_PROPERTY(QGCLogModel* model           READ model              NOTIFY modelChanged)
     Q_PROPERTY(bool         requestingList  READ requestingList     NOTIFY requestingListChanged)
     Q_PROPERTY(bool         downloadingLogs READ downloadingLogs    NOTIFY downloadingLogsChanged)
+    Q_PROPERTY(int          downloadCount   READ downloadCount      NOTIFY downloadCountChanged)    ///< Vehicles with a download in progress
+    Q_PROPERTY(double       throughput      READ throughput         NOTIFY throughputChanged)       ///< Bytes per second over all vehicles
+    Q_PROPERTY(QString      throughputStr   READ throughputStr      NOTIFY throughputChanged)
 
-    QGCLogModel*    model                   () { return &_logEntriesModel; }
-    bool            requestingList          () { return _requestingLogEntries; }
-    bool            downloadingLogs         () { return _downloadingLogs; }
+    QGCLogModel*    model                   ();
+    bool            requestingList          ();
+    bool            downloadingLogs         ();
+    int             downloadCount           ();
+    double          throughput              () { return _throughput; }
+    QString         throughputStr           ();
 
     Q_INVOKABLE void refresh                ();
     Q_INVOKABLE void download               (QString path = QString());
@@ -131,46 +145,64 @@ public:
 
     void downloadToDirectory(const QString& dir);
 
+    /// @return Filename of the index kept next to a partially downloaded log
+    static QString indexFilename(const QString& logFilename) { return logFilename + ".index"; }
+
+    /// Writes the index of a partially downloaded log
+    ///     @param received One bit per MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bytes of the log
+    static bool writeIndex(const QString& logFilename, int sysid, uint logId, uint logSize, uint timeUTC, const QBitArray& received);
+
+    /// Reads the index of a partially downloaded log
+    /// @return false if there is no index or it belongs to a different log
+    static bool readIndex(const QString& logFilename, int sysid, uint logId, uint logSize, uint timeUTC, QBitArray& received);
+
 signals:
     void requestingListChanged  ();
     void downloadingLogsChanged ();
+    void downloadCountChanged   ();
+    void throughputChanged      ();
     void modelChanged           ();
     void selectionChanged       ();
 
 private slots:
     void _setActiveVehicle  (Vehicle* vehicle);
+    void _vehicleRemoved    (Vehicle* vehicle);
     void _logEntry          (UASInterface *uas, uint32_t time_utc, uint32_t size, uint16_t id, uint16_t num_logs, uint16_t last_log_num);
     void _logData           (UASInterface *uas, uint32_t ofs, uint16_t id, uint8_t count, const uint8_t *data);
     void _processDownload   ();
 
 private:
-
-    bool _entriesComplete   ();
-    bool _chunkComplete     () const;
-    bool _logComplete       () const;
-    void _findMissingEntries();
-    void _receivedAllEntries();
-    void _receivedAllData   ();
-    void _resetSelection    (bool canceled = false);
-    void _findMissingData   ();
-    void _requestLogList    (uint32_t start, uint32_t end);
-    void _requestLogData    (uint8_t id, uint32_t offset = 0, uint32_t count = 0xFFFFFFFF);
-    bool _prepareLogDownload();
-    void _setDownloading    (bool active);
-    void _setListing        (bool active);
-
-    QGCLogEntry* _getNextSelected();
-
-    UASInterface*       _uas;
-    LogDownloadData*    _downloadData;
+    LogDownloadSession* _findSession(UASInterface* uas);
+
+    bool _entriesComplete   (LogDownloadSession* session);
+    void _findMissingEntries(LogDownloadSession* session);
+    void _receivedAllEntries(LogDownloadSession* session);
+    void _receivedAllData   (LogDownloadSession* session);
+    void _resetSelection    (LogDownloadSession* session, bool canceled = false);
+    void _findMissingData   (LogDownloadSession* session);
+    void _requestCompleted  (LogDownloadSession* session);
+    void _requestNextData   (LogDownloadSession* session);
+    void _requestLogList    (LogDownloadSession* session, uint32_t start, uint32_t end);
+    void _requestLogData    (LogDownloadSession* session, uint8_t id, uint32_t offset = 0, uint32_t count = 0xFFFFFFFF);
+    bool _prepareLogDownload(LogDownloadSession* session);
+    bool _openLogFile       (LogDownloadSession* session);
+    void _closeLogDownload  (LogDownloadSession* session);
+    void _saveIndex         (LogDownloadSession* session);
+    void _setTimeout        (LogDownloadSession* session, int msecs);
+    int  _dataTimeout       (LogDownloadSession* session) const;
+    void _updateThroughput  (void);
+    void _updateTimer       (void);
+    void _setDownloading    (LogDownloadSession* session, bool active);
+    void _setListing        (LogDownloadSession* session, bool active);
+
+    QGCLogEntry* _getNextSelected(LogDownloadSession* session);
+
+    QMap<Vehicle*, LogDownloadSession*> _sessions;
+    LogDownloadSession* _activeSession;
+    QGCLogModel         _emptyModel;        ///< Shown while there is no active vehicle
     QTimer              _timer;
-    QGCLogModel         _logEntriesModel;
-    Vehicle*            _vehicle;
-    bool                _requestingLogEntries;
-    bool                _downloadingLogs;
-    int                 _retries;
-    int                 _apmOneBased;
-    QString             _downloadPath;
+    QElapsedTimer       _throughputElapsed;
+    double              _throughput;
 };
 
 #endif
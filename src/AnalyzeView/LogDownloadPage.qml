@@ -199,6 +199,15 @@ AnalyzePage {
                     enabled:    logController.requestingList || logController.downloadingLogs
                     onClicked:  logController.cancel()
                 }
+
+                QGCLabel {
+                    width:      _butttonWidth
+                    wrapMode:   Text.WordWrap
+                    visible:    logController.downloadCount > 0
+                    text:       logController.downloadCount > 1 ?
+                                    qsTr("%1 vehicles\n%2/s").arg(logController.downloadCount).arg(logController.throughputStr) :
+                                    qsTr("%1/s").arg(logController.throughputStr)
+                }
             } // Column - Buttons
         } // RowLayout
     } // Component
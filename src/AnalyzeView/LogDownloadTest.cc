@@ -10,8 +10,15 @@
 #include "LogDownloadTest.h"
 #include "LogDownloadController.h"
 #include "MockLink.h"
+#include "MultiVehicleManager.h"
+#include "LinkManager.h"
+#include "ParameterManager.h"
+#include "Vehicle.h"
+#include "QGCApplication.h"
 
 #include <QDir>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
 
 LogDownloadTest::LogDownloadTest(void)
 {
@@ -64,3 +71,162 @@ void LogDownloadTest::downloadTest(void)
 
     delete controller;
 }
+
+/// Refreshes the log list of the active vehicle and waits for it
+void LogDownloadTest::_refreshList(LogDownloadController* controller)
+{
+    controller->refresh();
+    QVERIFY(controller->requestingList());
+    QTRY_VERIFY_WITH_TIMEOUT(!controller->requestingList(), 10000);
+    QVERIFY(controller->model()->count() > 0);
+}
+
+/// Downloads the first log of the active vehicle and waits for the download to finish
+void LogDownloadTest::_download(LogDownloadController* controller, const QString& dir)
+{
+    (*controller->model())[0]->setSelected(true);
+    controller->downloadToDirectory(dir);
+    QTRY_VERIFY_WITH_TIMEOUT(!controller->downloadingLogs(), 10000);
+}
+
+void LogDownloadTest::resumeTest(void)
+{
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _mockLink->setLogDownloadFileSize(_resumeLogSize);
+
+    LogDownloadController* controller = new LogDownloadController();
+    QTemporaryDir downloadDir;
+    QVERIFY(downloadDir.isValid());
+    QString downloadFile = QDir(downloadDir.path()).filePath("log_0_UnknownDate.px4log");
+
+    _refreshList(controller);
+    _download(controller, downloadDir.path());
+    QVERIFY(UnitTest::fileCompare(downloadFile, _mockLink->logDownloadFile()));
+    // Index is removed once the download completes
+    QVERIFY(!QFile::exists(LogDownloadController::indexFilename(downloadFile)));
+
+    // Make it look like the download was interrupted half way
+    const int binCount = (_resumeLogSize + MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN - 1) / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+    const int receivedBins = binCount / 2;
+    const uint32_t missingBytes = _resumeLogSize - (receivedBins * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
+    QBitArray received(binCount, false);
+    received.fill(true, 0, receivedBins);
+    QFile file(downloadFile);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.seek(receivedBins * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN));
+    QCOMPARE(file.write(QByteArray(missingBytes, 0)), (qint64)missingBytes);
+    file.close();
+    QVERIFY(!UnitTest::fileCompare(downloadFile, _mockLink->logDownloadFile()));
+    QVERIFY(LogDownloadController::writeIndex(downloadFile, _vehicle->id(), 0, _resumeLogSize, 0, received));
+
+    // An index for a different log must not be picked up
+    QBitArray readBack;
+    QVERIFY(!LogDownloadController::readIndex(downloadFile, _vehicle->id(), 1, _resumeLogSize, 0, readBack));
+    QVERIFY(!LogDownloadController::readIndex(downloadFile, _vehicle->id(), 0, _resumeLogSize + 1, 0, readBack));
+    QVERIFY(LogDownloadController::readIndex(downloadFile, _vehicle->id(), 0, _resumeLogSize, 0, readBack));
+    QCOMPARE(readBack, received);
+
+    // Downloading again resumes into the same file and only fetches the missing half
+    uint32_t bytesSent = _mockLink->logDownloadBytesSent();
+    _refreshList(controller);
+    _download(controller, downloadDir.path());
+    QVERIFY(UnitTest::fileCompare(downloadFile, _mockLink->logDownloadFile()));
+    QVERIFY(!QFile::exists(LogDownloadController::indexFilename(downloadFile)));
+    QVERIFY(!QFile::exists(QDir(downloadDir.path()).filePath("log_0_UnknownDate_1.px4log")));
+    uint32_t resumeBytesSent = _mockLink->logDownloadBytesSent() - bytesSent;
+    QVERIFY(resumeBytesSent >= missingBytes);
+    QVERIFY(resumeBytesSent < _resumeLogSize);
+
+    delete controller;
+}
+
+void LogDownloadTest::parallelDownloadTest(void)
+{
+    _parallelDownload(false /* reportThroughput */);
+}
+
+void LogDownloadTest::parallelDownloadBenchmark(void)
+{
+    UT_OPT_IN(optInBenchmarks);
+
+    _parallelDownload(true /* reportThroughput */);
+}
+
+/// Downloads logs from two vehicles at the same time over lossy links and checks the downloaded files
+///     @param reportThroughput true: report the download times through qDebug
+void LogDownloadTest::_parallelDownload(bool reportThroughput)
+{
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+
+    MultiVehicleManager*    vehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+    LinkManager*            linkMgr = qgcApp()->toolbox()->linkManager();
+
+    MockConfiguration* mockConfig = new MockConfiguration("Second PX4 MockLink");
+    mockConfig->setFirmwareType(MAV_AUTOPILOT_PX4);
+    mockConfig->setVehicleType(MAV_TYPE_QUADROTOR);
+    mockConfig->setDynamic(true);
+    MockLink* secondLink = qobject_cast<MockLink*>(linkMgr->createConnectedLink(linkMgr->addConfiguration(mockConfig)));
+    QVERIFY(secondLink);
+    QTRY_VERIFY_WITH_TIMEOUT(vehicleMgr->vehicles()->count() == 2, 10000);
+    Vehicle* secondVehicle = vehicleMgr->vehicles()->value<Vehicle*>(0);
+    if (secondVehicle == _vehicle) {
+        secondVehicle = vehicleMgr->vehicles()->value<Vehicle*>(1);
+    }
+    QTRY_VERIFY_WITH_TIMEOUT(secondVehicle->parameterManager()->parametersReady(), 10000);
+
+    MockLink*   links[2] =      { _mockLink, secondLink };
+    Vehicle*    vehicles[2] =   { _vehicle, secondVehicle };
+
+    LogDownloadController* controller = new LogDownloadController();
+    QTemporaryDir downloadDir;
+    QVERIFY(downloadDir.isValid());
+
+    double peakThroughput = 0;
+    connect(controller, &LogDownloadController::throughputChanged, [&peakThroughput, controller]() {
+        peakThroughput = qMax(peakThroughput, controller->throughput());
+    });
+
+    // Log lists are loaded over clean links, loss and jitter only apply to the log data
+    for (int i=0; i<2; i++) {
+        links[i]->setLogDownloadFileSize(_parallelLogSize);
+        vehicleMgr->setActiveVehicle(vehicles[i]);
+        QTRY_VERIFY_WITH_TIMEOUT(vehicleMgr->activeVehicle() == vehicles[i], 1000);
+        _refreshList(controller);
+        links[i]->setPacketLossPercent(_parallelLossPercent);
+        links[i]->setJitterMSecs(_parallelJitterMSecs);
+    }
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    for (int i=0; i<2; i++) {
+        vehicleMgr->setActiveVehicle(vehicles[i]);
+        QTRY_VERIFY_WITH_TIMEOUT(vehicleMgr->activeVehicle() == vehicles[i], 1000);
+        QVERIFY(QDir(downloadDir.path()).mkpath(QString::number(i)));
+        (*controller->model())[0]->setSelected(true);
+        controller->downloadToDirectory(QDir(downloadDir.path()).filePath(QString::number(i)));
+    }
+    QCOMPARE(controller->downloadCount(), 2);
+    QTRY_VERIFY_WITH_TIMEOUT(controller->downloadCount() == 0, 60000);
+    qint64 msecs = qMax(elapsed.elapsed(), (qint64)1);
+
+    if (reportThroughput) {
+        qDebug() << "Log download benchmark: 2 vehicles," << _parallelLogSize << "bytes each, loss" << _parallelLossPercent << "%, jitter" << _parallelJitterMSecs << "msecs";
+        qDebug() << "Log download benchmark: msecs" << msecs << "bytes/sec" << (2 * _parallelLogSize * 1000) / msecs << "peak" << qRound(peakThroughput);
+    }
+    for (int i=0; i<2; i++) {
+        links[i]->setPacketLossPercent(0);
+        links[i]->setJitterMSecs(0);
+        QString downloadFile = QDir(downloadDir.path()).filePath(QString::number(i) + "/log_0_UnknownDate.px4log");
+        QVERIFY(UnitTest::fileCompare(downloadFile, links[i]->logDownloadFile()));
+        if (reportThroughput) {
+            qDebug() << "Log download benchmark: vehicle" << vehicles[i]->id() << "bytes sent per log byte" << (double)links[i]->logDownloadBytesSent() / _parallelLogSize;
+        }
+    }
+
+    delete controller;
+
+    QSignalSpy linkSpy(linkMgr, SIGNAL(linkDeleted(LinkInterface*)));
+    linkMgr->disconnectLink(secondLink);
+    linkSpy.wait(1000);
+    QCOMPARE(linkSpy.count(), 1);
+}
@@ -13,6 +13,8 @@
 #include "UnitTest.h"
 #include "MultiSignalSpy.h"
 
+class LogDownloadController;
+
 class LogDownloadTest : public UnitTest
 {
     Q_OBJECT
@@ -25,8 +27,20 @@ private slots:
     //void cleanup(void) { _cleanup(); }
 
     void downloadTest(void);
+    void resumeTest(void);
+    void parallelDownloadTest(void);
+    void parallelDownloadBenchmark(void);
 
 private:
+    void _refreshList(LogDownloadController* controller);
+    void _download(LogDownloadController* controller, const QString& dir);
+    void _parallelDownload(bool reportThroughput);
+
+    static const uint32_t   _resumeLogSize = 9000;
+    static const uint32_t   _parallelLogSize = 45000;
+    static const int        _parallelLossPercent = 5;
+    static const int        _parallelJitterMSecs = 10;
+
     // LogDownloadController signals
 
     enum {
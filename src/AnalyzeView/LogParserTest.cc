@@ -0,0 +1,202 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogParserTest.h"
+#include "LogStreamReader.h"
+#include "ULogParser.h"
+#include "PX4LogParser.h"
+
+#include <QBuffer>
+#include <QtEndian>
+
+LogParserTest::LogParserTest(void)
+{
+
+}
+
+static void _appendULogMessage(QByteArray& log, char type, const QByteArray& body)
+{
+    char header[3];
+    qToLittleEndian<quint16>(body.size(), reinterpret_cast<uchar*>(header));
+    header[2] = type;
+    log.append(header, 3);
+    log.append(body);
+}
+
+template <typename T>
+static void _appendValue(QByteArray& bytes, T value)
+{
+    bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+QByteArray LogParserTest::_buildULog(void)
+{
+    QByteArray log;
+    const char magic[] = {'U', 'L', 'o', 'g', 0x01, 0x12, 0x35, 0x01};
+    log.append(magic, sizeof(magic));
+    _appendValue<quint64>(log, 0);
+
+    _appendULogMessage(log, 'F', QByteArray("vehicle_status:uint64_t timestamp;uint8_t arming_state;"));
+    _appendULogMessage(log, 'F', QByteArray("camera_capture:uint64_t timestamp;uint64_t timestamp_utc;uint32_t seq;double lat;double lon;float alt;float ground_distance;float[4] q;uint8_t result;uint8_t[7] _padding0;"));
+
+    QByteArray addLogged;
+    _appendValue<quint8>(addLogged, 0);
+    _appendValue<quint16>(addLogged, 0);
+    addLogged.append("vehicle_status");
+    _appendULogMessage(log, 'A', addLogged);
+
+    addLogged.clear();
+    _appendValue<quint8>(addLogged, 0);
+    _appendValue<quint16>(addLogged, 1);
+    addLogged.append("camera_capture");
+    _appendULogMessage(log, 'A', addLogged);
+
+    for (int i=0; i<3; i++) {
+        QByteArray status;
+        _appendValue<quint16>(status, 0);
+        _appendValue<quint64>(status, i * 1000000);
+        _appendValue<quint8>(status, 1);
+        _appendULogMessage(log, 'D', status);
+
+        QByteArray capture;
+        _appendValue<quint16>(capture, 1);
+        _appendValue<quint64>(capture, (i + 1) * 2000000);
+        _appendValue<quint64>(capture, 0);
+        _appendValue<quint32>(capture, i);
+        _appendValue<double>(capture, 47.0 + i);
+        _appendValue<double>(capture, 8.0 + i);
+        _appendValue<float>(capture, 500.0f + i);
+        _appendValue<float>(capture, 50.0f);
+        for (int j=0; j<4; j++) {
+            _appendValue<float>(capture, 0.0f);
+        }
+        _appendValue<quint8>(capture, 1);
+        capture.append(7, 0);
+        _appendULogMessage(log, 'D', capture);
+    }
+
+    return log;
+}
+
+static void _appendPX4Fmt(QByteArray& log, quint8 type, quint8 length)
+{
+    QByteArray fmt(89, 0);
+    fmt[0] = (char)0xA3;
+    fmt[1] = (char)0x95;
+    fmt[2] = (char)0x80;
+    fmt[3] = type;
+    fmt[4] = length;
+    log.append(fmt);
+}
+
+QByteArray LogParserTest::_buildPX4Log(void)
+{
+    QByteArray log;
+
+    // Leading garbage must be skipped while resyncing
+    log.append("junk");
+
+    _appendPX4Fmt(log, 0x10, 15);
+    _appendPX4Fmt(log, 0x37, 15);
+
+    for (int i=0; i<3; i++) {
+        log.append((char)0xA3);
+        log.append((char)0x95);
+        log.append((char)0x37);
+        _appendValue<quint64>(log, (i + 1) * 2000000);
+        _appendValue<quint32>(log, i);
+
+        log.append((char)0xA3);
+        log.append((char)0x95);
+        log.append((char)0x10);
+        _appendValue<qint32>(log, (47 + i) * 10000000);
+        _appendValue<qint32>(log, (8 + i) * 10000000);
+        _appendValue<float>(log, 500.0f + i);
+    }
+
+    return log;
+}
+
+void LogParserTest::_streamReader_test(void)
+{
+    QByteArray bytes;
+    for (int i=0; i<1000; i++) {
+        bytes.append((char)(i & 0xFF));
+    }
+    QBuffer buffer(&bytes);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    // Tiny chunks exercise messages straddling chunk boundaries
+    LogStreamReader reader(buffer, LogStreamReader::ProgressCallback(), 16);
+    QVERIFY(reader.ensure(10));
+    QCOMPARE((uchar)reader.data()[0], (uchar)0);
+    reader.skip(10);
+    QVERIFY(reader.ensure(40));
+    QVERIFY(reader.available() <= 40 + 16);
+    QCOMPARE((uchar)reader.data()[39], (uchar)49);
+    reader.skip(500);
+    QCOMPARE(reader.position(), (qint64)510);
+    QVERIFY(reader.ensure(1));
+    QCOMPARE((uchar)reader.data()[0], (uchar)(510 & 0xFF));
+    reader.skip(490);
+    QVERIFY(!reader.ensure(1));
+    QVERIFY(reader.atEnd());
+}
+
+void LogParserTest::_ulog_test(void)
+{
+    QByteArray log = _buildULog();
+    QBuffer buffer(&log);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    double lastProgress = 0;
+    QList<GeoTagWorker::cameraFeedbackPacket> feedback;
+    ULogParser parser;
+    QVERIFY(parser.getTagsFromLog(buffer, feedback, [&lastProgress](double progress) { lastProgress = progress; return true; }));
+    QCOMPARE(lastProgress, 1.0);
+    QCOMPARE(feedback.count(), 3);
+    for (int i=0; i<3; i++) {
+        QCOMPARE(feedback[i].imageSequence, (uint32_t)i);
+        QCOMPARE(feedback[i].timestamp, 2.0 * (i + 1));
+        QCOMPARE(feedback[i].latitude, 47.0 + i);
+        QCOMPARE(feedback[i].longitude, 8.0 + i);
+        QCOMPARE(feedback[i].altitude, 500.0f + i);
+        QCOMPARE(feedback[i].captureResult, (uint8_t)1);
+    }
+}
+
+void LogParserTest::_px4log_test(void)
+{
+    QByteArray log = _buildPX4Log();
+    QBuffer buffer(&log);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    QList<GeoTagWorker::cameraFeedbackPacket> feedback;
+    PX4LogParser parser;
+    QVERIFY(parser.getTagsFromLog(buffer, feedback));
+    QCOMPARE(feedback.count(), 3);
+    for (int i=0; i<3; i++) {
+        QCOMPARE(feedback[i].imageSequence, (uint32_t)i);
+        QCOMPARE(feedback[i].timestamp, 2.0 * (i + 1));
+        QCOMPARE(feedback[i].latitude, 47.0 + i);
+        QCOMPARE(feedback[i].longitude, 8.0 + i);
+        QCOMPARE(feedback[i].altitude, 500.0f + i);
+    }
+}
+
+void LogParserTest::_cancel_test(void)
+{
+    QByteArray log = _buildULog();
+    QBuffer buffer(&log);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    QList<GeoTagWorker::cameraFeedbackPacket> feedback;
+    ULogParser parser;
+    QVERIFY(!parser.getTagsFromLog(buffer, feedback, [](double) { return false; }));
+}
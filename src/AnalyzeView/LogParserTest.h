@@ -0,0 +1,31 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for the streaming geotag log parsers
+class LogParserTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    LogParserTest(void);
+
+private slots:
+    void _streamReader_test(void);
+    void _ulog_test(void);
+    void _px4log_test(void);
+    void _cancel_test(void);
+
+private:
+    QByteArray _buildULog(void);
+    QByteArray _buildPX4Log(void);
+};
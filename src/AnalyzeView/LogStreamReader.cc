@@ -0,0 +1,82 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogStreamReader.h"
+
+LogStreamReader::LogStreamReader(QIODevice& device, ProgressCallback progressCallback, int chunkSize)
+    : _device           (device)
+    , _progressCallback (progressCallback)
+    , _chunkSize        (chunkSize)
+    , _offset           (0)
+    , _devicePosition   (device.pos())
+    , _cancelled        (false)
+{
+
+}
+
+bool LogStreamReader::ensure(int count)
+{
+    if (available() >= count) {
+        return true;
+    }
+    if (_cancelled) {
+        return false;
+    }
+
+    // Drop consumed bytes so the buffer never grows beyond one chunk plus a partial message
+    _buffer.remove(0, _offset);
+    _offset = 0;
+
+    while (_buffer.size() < count) {
+        int toRead = qMax(_chunkSize, count - _buffer.size());
+        int oldSize = _buffer.size();
+        _buffer.resize(oldSize + toRead);
+        qint64 bytesRead = _device.read(_buffer.data() + oldSize, toRead);
+        _buffer.resize(oldSize + (int)qMax(bytesRead, (qint64)0));
+        if (bytesRead <= 0) {
+            return false;
+        }
+        _devicePosition += bytesRead;
+
+        if (_progressCallback) {
+            qint64 size = _device.size();
+            if (!_progressCallback(size > 0 ? (double)_devicePosition / size : 0.0)) {
+                _cancelled = true;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void LogStreamReader::skip(qint64 count)
+{
+    if (count <= available()) {
+        _offset += (int)count;
+        return;
+    }
+
+    count -= available();
+    _buffer.clear();
+    _offset = 0;
+    if (_device.isSequential()) {
+        while (count > 0) {
+            QByteArray discard = _device.read(qMin(count, (qint64)_chunkSize));
+            if (discard.isEmpty()) {
+                break;
+            }
+            count -= discard.size();
+            _devicePosition += discard.size();
+        }
+    } else {
+        _devicePosition = qMin(_devicePosition + count, _device.size());
+        _device.seek(_devicePosition);
+    }
+}
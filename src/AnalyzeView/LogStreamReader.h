@@ -0,0 +1,56 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QIODevice>
+#include <QByteArray>
+
+#include <functional>
+
+/// Sequential chunked reader used by the log parsers so that memory use is bounded by the chunk size plus the largest
+/// log message, independent of the size of the log file.
+class LogStreamReader
+{
+public:
+    /// Called after each chunk is read with the fraction of the device consumed so far (0-1). Return false to cancel.
+    typedef std::function<bool(double)> ProgressCallback;
+
+    LogStreamReader(QIODevice& device, ProgressCallback progressCallback = ProgressCallback(), int chunkSize = _defaultChunkSize);
+
+    /// Makes sure at least count bytes are buffered at the current position.
+    /// @return false: end of device reached before count bytes were available, or cancelled
+    bool ensure(int count);
+
+    /// @return Pointer to the current position in the buffer. Valid until the next call to ensure or skip.
+    const char* data(void) const { return _buffer.constData() + _offset; }
+
+    /// @return Number of bytes buffered at the current position
+    int available(void) const { return _buffer.size() - _offset; }
+
+    /// Advances the current position. Skipping past the buffered data seeks the device.
+    void skip(qint64 count);
+
+    /// @return Offset of the current position from the start of the device
+    qint64 position(void) const { return _devicePosition - available(); }
+
+    bool atEnd      (void) const { return available() == 0 && _device.atEnd(); }
+    bool cancelled  (void) const { return _cancelled; }
+
+private:
+    QIODevice&          _device;
+    ProgressCallback    _progressCallback;
+    int                 _chunkSize;
+    QByteArray          _buffer;
+    int                 _offset;            ///< Current position within _buffer
+    qint64              _devicePosition;    ///< Device offset of the end of _buffer
+    bool                _cancelled;
+
+    static const int _defaultChunkSize = 1024 * 1024;
+};
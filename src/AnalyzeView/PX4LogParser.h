@@ -5,16 +5,24 @@
 #include <QDebug>
 
 #include "GeoTagController.h"
+#include "LogStreamReader.h"
 
+/// Streaming sdlog2 (.px4log) parser which extracts camera trigger messages and pairs each with the following global
+/// position message. Message lengths are taken from the FMT messages so all other messages are skipped unread.
 class PX4LogParser
 {
 public:
     PX4LogParser();
     ~PX4LogParser();
-    bool getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback);
+    bool getTagsFromLog(QIODevice& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, LogStreamReader::ProgressCallback progressCallback = LogStreamReader::ProgressCallback());
 
 private:
-
+    static const uint8_t _headByte1     = 0xA3;
+    static const uint8_t _headByte2     = 0x95;
+    static const uint8_t _fmtMsgType    = 0x80;
+    static const uint8_t _gposMsgType   = 0x10;
+    static const uint8_t _triggerMsgType = 0x37;
+    static const int     _fmtMsgLength  = 89;   ///< header (3) + type (1) + length (1) + name (4) + format (16) + labels (64)
 };
 
 #endif // PX4LOGPARSER_H
@@ -86,36 +86,49 @@ bool ULogParser::parseFieldFormat(QString& fields)
     return false;
 }
 
-bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
+bool ULogParser::readField(const char* payload, int payloadSize, const char* fieldName, void* value, int valueSize)
 {
+    QMap<QString, int>::const_iterator it = _cameraCaptureOffsets.constFind(QString(fieldName));
+    if (it == _cameraCaptureOffsets.constEnd() || it.value() + valueSize > payloadSize) {
+        return false;
+    }
+    memcpy(value, payload + it.value(), valueSize);
+    return true;
+}
+
+bool ULogParser::getTagsFromLog(QIODevice& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, LogStreamReader::ProgressCallback progressCallback)
+{
+    LogStreamReader reader(log, progressCallback);
+
     //verify it's an ULog file
-    if(!log.contains(_ULogMagic)) {
+    if (!reader.ensure(ULOG_FILE_HEADER_LEN) || memcmp(reader.data(), _ULogMagic, strlen(_ULogMagic)) != 0) {
         qWarning() << "Could not detect ULog file header magic";
         return false;
     }
+    reader.skip(ULOG_FILE_HEADER_LEN);
 
-    int index = ULOG_FILE_HEADER_LEN;
-    bool geotagFound = false;
+    _cameraCaptureOffsets.clear();
+    _cameraCaptureMsgIDs.clear();
 
-    while(index < log.count() - 1) {
+    while (reader.ensure(ULOG_MSG_HEADER_LEN)) {
+        uint16_t msgSize;
+        memcpy(&msgSize, reader.data(), sizeof(msgSize));
+        uint8_t msgType = reader.data()[2];
 
-        ULogMessageHeader header;
-        memset(&header, 0, sizeof(header));
-        memcpy(&header, log.data() + index, ULOG_MSG_HEADER_LEN);
-
-        switch (header.msgType) {
+        switch (msgType) {
             case (int)ULogMessageType::FORMAT:
             {
-                ULogMessageFormat format_msg;
-                memset(&format_msg, 0, sizeof(format_msg));
-                memcpy(&format_msg, log.data() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
+                if (!reader.ensure(ULOG_MSG_HEADER_LEN + msgSize)) {
+                    break;
+                }
 
-                QString fmt(format_msg.format);
+                QString fmt = QString::fromLatin1(reader.data() + ULOG_MSG_HEADER_LEN, msgSize);
                 int posSeparator = fmt.indexOf(':');
                 QString messageName = fmt.left(posSeparator);
-                QString messageFields = fmt.mid(posSeparator + 1, header.msgSize - posSeparator - 1);
+                QString messageFields = fmt.mid(posSeparator + 1);
 
                 if(messageName == "camera_capture") {
+                    _cameraCaptureOffsets.clear();
                     parseFieldFormat(messageFields);
                 }
                 break;
@@ -123,15 +136,17 @@ bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedb
 
             case (int)ULogMessageType::ADD_LOGGED_MSG:
             {
-                ULogMessageAddLogged addLoggedMsg;
-                memset(&addLoggedMsg, 0, sizeof(addLoggedMsg));
-                memcpy(&addLoggedMsg, log.data() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
+                if (msgSize < ULOG_ADD_LOGGED_NAME_OFFSET || !reader.ensure(ULOG_MSG_HEADER_LEN + msgSize)) {
+                    break;
+                }
 
-                QString messageName(addLoggedMsg.msgName);
+                const char* body = reader.data() + ULOG_MSG_HEADER_LEN;
+                QString messageName = QString::fromLatin1(body + ULOG_ADD_LOGGED_NAME_OFFSET, msgSize - ULOG_ADD_LOGGED_NAME_OFFSET);
 
                 if(messageName.contains("camera_capture")) {
-                    _cameraCaptureMsgID = addLoggedMsg.msgID;
-                    geotagFound = true;
+                    uint16_t msgID;
+                    memcpy(&msgID, body + 1, sizeof(msgID));
+                    _cameraCaptureMsgIDs.insert(msgID);
                 }
 
                 break;
@@ -139,33 +154,37 @@ bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedb
 
             case (int)ULogMessageType::DATA:
             {
-                if (!geotagFound) {
-                    qWarning() << "Could not detect geotag packets in ULog";
-                    return false;
+                // Only pull in the full message for subscribed camera_capture ids, everything else is skipped unread
+                if (msgSize < ULOG_DATA_PAYLOAD_OFFSET || !reader.ensure(ULOG_MSG_HEADER_LEN + ULOG_DATA_PAYLOAD_OFFSET)) {
+                    break;
                 }
 
-                uint16_t msgID = -1;
-                memcpy(&msgID, log.data() + index + ULOG_MSG_HEADER_LEN, 2);
+                uint16_t msgID;
+                memcpy(&msgID, reader.data() + ULOG_MSG_HEADER_LEN, sizeof(msgID));
 
-                if(msgID == _cameraCaptureMsgID) {
+                if(_cameraCaptureMsgIDs.contains(msgID) && reader.ensure(ULOG_MSG_HEADER_LEN + msgSize)) {
+                    const char* payload = reader.data() + ULOG_MSG_HEADER_LEN + ULOG_DATA_PAYLOAD_OFFSET;
+                    int payloadSize = msgSize - ULOG_DATA_PAYLOAD_OFFSET;
 
                     // Completely dynamic parsing, so that changing/reordering the message format will not break the parser
                     GeoTagWorker::cameraFeedbackPacket feedback;
                     memset(&feedback, 0, sizeof(feedback));
-                    memcpy(&feedback.timestamp, log.data() + index + 5 + _cameraCaptureOffsets.value("timestamp"), 8);
-                    feedback.timestamp /= 1.0e6; // to seconds
-                    memcpy(&feedback.timestampUTC, log.data() + index + 5 + _cameraCaptureOffsets.value("timestamp_utc"), 8);
-                    feedback.timestampUTC /= 1.0e6; // to seconds
-                    memcpy(&feedback.imageSequence, log.data() + index + 5 + _cameraCaptureOffsets.value("seq"), 4);
-                    memcpy(&feedback.latitude, log.data() + index + 5 + _cameraCaptureOffsets.value("lat"), 8);
-                    memcpy(&feedback.longitude, log.data() + index + 5 + _cameraCaptureOffsets.value("lon"), 8);
+
+                    uint64_t timestamp = 0;
+                    readField(payload, payloadSize, "timestamp", &timestamp, sizeof(timestamp));
+                    feedback.timestamp = timestamp / 1.0e6; // to seconds
+                    uint64_t timestampUTC = 0;
+                    readField(payload, payloadSize, "timestamp_utc", &timestampUTC, sizeof(timestampUTC));
+                    feedback.timestampUTC = timestampUTC / 1.0e6; // to seconds
+                    readField(payload, payloadSize, "seq", &feedback.imageSequence, sizeof(feedback.imageSequence));
+                    readField(payload, payloadSize, "lat", &feedback.latitude, sizeof(feedback.latitude));
+                    readField(payload, payloadSize, "lon", &feedback.longitude, sizeof(feedback.longitude));
                     feedback.longitude = fmod(180.0 + feedback.longitude, 360.0) - 180.0;
-                    memcpy(&feedback.altitude, log.data() + index + 5 + _cameraCaptureOffsets.value("alt"), 4);
-                    memcpy(&feedback.groundDistance, log.data() + index + 5 + _cameraCaptureOffsets.value("ground_distance"), 4);
-                    memcpy(&feedback.captureResult, log.data() + index + 5 + _cameraCaptureOffsets.value("result"), 1);
+                    readField(payload, payloadSize, "alt", &feedback.altitude, sizeof(feedback.altitude));
+                    readField(payload, payloadSize, "ground_distance", &feedback.groundDistance, sizeof(feedback.groundDistance));
+                    readField(payload, payloadSize, "result", &feedback.captureResult, sizeof(feedback.captureResult));
 
                     cameraFeedback.append(feedback);
-
                 }
 
                 break;
@@ -175,8 +194,16 @@ bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedb
                 break;
         }
 
-        index += (3 + header.msgSize);
+        reader.skip(ULOG_MSG_HEADER_LEN + msgSize);
+    }
+
+    if (reader.cancelled()) {
+        return false;
+    }
 
+    if (_cameraCaptureMsgIDs.isEmpty()) {
+        qWarning() << "Could not detect geotag packets in ULog";
+        return false;
     }
 
     return true;
@@ -3,22 +3,26 @@
 
 #include <QGeoCoordinate>
 #include <QDebug>
+#include <QSet>
 
 #include "GeoTagController.h"
+#include "LogStreamReader.h"
 
 #define ULOG_FILE_HEADER_LEN 16
 
+/// Streaming ULog parser which extracts camera_capture messages. Only FORMAT and ADD_LOGGED messages are decoded
+/// besides the camera_capture DATA messages, all other messages are skipped based on their header.
 class ULogParser
 {
 public:
     ULogParser();
     ~ULogParser();
-    bool getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback);
+    bool getTagsFromLog(QIODevice& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, LogStreamReader::ProgressCallback progressCallback = LogStreamReader::ProgressCallback());
 
 private:
 
     QMap<QString, int> _cameraCaptureOffsets; // <fieldName, fieldOffset>
-    int _cameraCaptureMsgID;
+    QSet<uint16_t> _cameraCaptureMsgIDs;
 
     const char _ULogMagic[8] = {'U', 'L', 'o', 'g', 0x01, 0x12, 0x35};
 
@@ -27,6 +31,7 @@ private:
     QString extractArraySize(QString& typeNameFull, int& arraySize);
 
     bool parseFieldFormat(QString& fields);
+    bool readField(const char* payload, int payloadSize, const char* fieldName, void* value, int valueSize);
 
     enum class ULogMessageType : uint8_t {
         FORMAT = 'F',
@@ -41,27 +46,8 @@ private:
     };
 
     #define ULOG_MSG_HEADER_LEN 3
-    struct ULogMessageHeader {
-        uint16_t msgSize;
-        uint8_t msgType;
-    };
-
-    struct ULogMessageFormat {
-        uint16_t msgSize;
-        uint8_t msgType;
-
-        char format[2096];
-    };
-
-    struct ULogMessageAddLogged {
-	  uint16_t msgSize;
-      uint8_t msgType;
-
-	  uint8_t multiID;
-	  uint16_t msgID;
-	  char msgName[255];
-	};
-
+    #define ULOG_ADD_LOGGED_NAME_OFFSET 3   // multi_id (1) + msg_id (2)
+    #define ULOG_DATA_PAYLOAD_OFFSET 2      // msg_id (2)
 };
 
 #endif // ULOGPARSER_H
@@ -20,9 +20,10 @@
 Fact::Fact(QObject* parent)
     : QObject(parent)
     , _componentId(-1)
-    , _rawValue(0)
+    , _rawNumber(0)
     , _type(FactMetaData::valueTypeInt32)
     , _metaData(NULL)
+    , _cookedValueTranslator(NULL)
     , _sendValueChangedSignals(true)
     , _deferredValueChangeSignal(false)
 {    
@@ -37,9 +38,10 @@ Fact::Fact(int componentId, QString name, FactMetaData::ValueType_t type, QObjec
     : QObject(parent)
     , _name(name)
     , _componentId(componentId)
-    , _rawValue(0)
+    , _rawNumber(0)
     , _type(type)
     , _metaData(NULL)
+    , _cookedValueTranslator(NULL)
     , _sendValueChangedSignals(true)
     , _deferredValueChangeSignal(false)
 {
@@ -59,12 +61,14 @@ const Fact& Fact::operator=(const Fact& other)
 {
     _name                       = other._name;
     _componentId                = other._componentId;
-    _rawValue                   = other._rawValue;
+    _rawNumber                  = other._rawNumber;
+    _rawString                  = other._rawString;
     _type                       = other._type;
+    _cookedValueTranslator      = NULL;
     _sendValueChangedSignals    = other._sendValueChangedSignals;
     _deferredValueChangeSignal  = other._deferredValueChangeSignal;
 
-    if (_metaData && other._metaData) {
+    if (_resolveMetaData() && other._resolveMetaData()) {
         *_metaData = *other._metaData;
     } else {
         _metaData = NULL;
@@ -75,15 +79,15 @@ const Fact& Fact::operator=(const Fact& other)
 
 void Fact::forceSetRawValue(const QVariant& value)
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         QVariant    typedValue;
         QString     errorString;
         
         if (_metaData->convertAndValidateRaw(value, true /* convertOnly */, typedValue, errorString)) {
-            _rawValue.setValue(typedValue);
-            _sendValueChangedSignal(cookedValue());
+            _storeRawValue(typedValue);
+            _sendValueChangedSignal();
             emit _containerRawValueChanged(rawValue());
-            emit rawValueChanged(_rawValue);
+            emit rawValueChanged(rawValue());
         }
     } else {
         qWarning() << "Meta data pointer missing";
@@ -92,16 +96,22 @@ void Fact::forceSetRawValue(const QVariant& value)
 
 void Fact::setRawValue(const QVariant& value)
 {
-    if (_metaData) {
+    if (_typeIsNumeric() && _variantIsNumeric(value)) {
+        // Numeric to numeric conversion never fails, so there is no need to go through the meta data
+        setRawNumericValue(value.toDouble());
+        return;
+    }
+
+    if (_resolveMetaData()) {
         QVariant    typedValue;
         QString     errorString;
         
         if (_metaData->convertAndValidateRaw(value, true /* convertOnly */, typedValue, errorString)) {
-            if (typedValue != _rawValue) {
-                _rawValue.setValue(typedValue);
-                _sendValueChangedSignal(cookedValue());
+            if (typedValue != rawValue()) {
+                _storeRawValue(typedValue);
+                _sendValueChangedSignal();
                 emit _containerRawValueChanged(rawValue());
-                emit rawValueChanged(_rawValue);
+                emit rawValueChanged(rawValue());
             }
         }
     } else {
@@ -111,7 +121,7 @@ void Fact::setRawValue(const QVariant& value)
 
 void Fact::setCookedValue(const QVariant& value)
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         setRawValue(_metaData->cookedTranslator()(value));
     } else {
         qWarning() << "Meta data pointer missing";
@@ -120,7 +130,7 @@ void Fact::setCookedValue(const QVariant& value)
 
 void Fact::setEnumStringValue(const QString& value)
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         int index = _metaData->enumStrings().indexOf(value);
         if (index != -1) {
             setCookedValue(_metaData->enumValues()[index]);
@@ -132,19 +142,123 @@ void Fact::setEnumStringValue(const QString& value)
 
 void Fact::setEnumIndex(int index)
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         setCookedValue(_metaData->enumValues()[index]);
     } else {
         qWarning() << "Meta data pointer missing";
     }
 }
 
+void Fact::setRawNumericValue(double value)
+{
+    if (!_typeIsNumeric()) {
+        setRawValue(QVariant(value));
+        return;
+    }
+
+    double typedValue = _toTypedNumber(value);
+
+    // NaN is used for "not available" by telemetry, don't signal a change for each NaN update
+    if (typedValue != _rawNumber && !(qIsNaN(typedValue) && qIsNaN(_rawNumber))) {
+        _rawNumber = typedValue;
+        _cookedValueTranslator = NULL;
+        _sendValueChangedSignal();
+        emit _containerRawValueChanged(rawValue());
+        emit rawValueChanged(rawValue());
+    }
+}
+
 void Fact::_containerSetRawValue(const QVariant& value)
 {
-    _rawValue = value;
-    _sendValueChangedSignal(cookedValue());
-    emit vehicleUpdated(_rawValue);
-    emit rawValueChanged(_rawValue);
+    _storeRawValue(value);
+    _sendValueChangedSignal();
+    emit vehicleUpdated(rawValue());
+    emit rawValueChanged(rawValue());
+}
+
+QVariant Fact::rawValue(void) const
+{
+    switch (_type) {
+    case FactMetaData::valueTypeInt8:
+    case FactMetaData::valueTypeInt16:
+    case FactMetaData::valueTypeInt32:
+        return QVariant(static_cast<int>(_rawNumber));
+    case FactMetaData::valueTypeUint8:
+    case FactMetaData::valueTypeUint16:
+    case FactMetaData::valueTypeUint32:
+        return QVariant(static_cast<uint>(_rawNumber));
+    case FactMetaData::valueTypeFloat:
+        return QVariant(static_cast<float>(_rawNumber));
+    case FactMetaData::valueTypeString:
+        return QVariant(_rawString);
+    case FactMetaData::valueTypeBool:
+        return QVariant(_rawNumber != 0);
+    case FactMetaData::valueTypeDouble:
+    case FactMetaData::valueTypeElapsedTimeInSeconds:
+        break;
+    }
+
+    return QVariant(_rawNumber);
+}
+
+/// Stores an already typed value without signalling
+void Fact::_storeRawValue(const QVariant& value)
+{
+    if (_typeIsNumeric()) {
+        _rawNumber = _toTypedNumber(value.toDouble());
+    } else {
+        _rawString = value.toString();
+    }
+    _cookedValueTranslator = NULL;
+}
+
+/// Converts a double to the numeric Fact type using the same rules as QVariant conversion. The result is exactly
+/// representable as a double for all numeric types.
+double Fact::_toTypedNumber(double value) const
+{
+    switch (_type) {
+    case FactMetaData::valueTypeInt8:
+    case FactMetaData::valueTypeInt16:
+    case FactMetaData::valueTypeInt32:
+        return qIsFinite(value) ? static_cast<int>(qRound64(value)) : 0;
+    case FactMetaData::valueTypeUint8:
+    case FactMetaData::valueTypeUint16:
+    case FactMetaData::valueTypeUint32:
+        return qIsFinite(value) ? static_cast<uint>(qRound64(value)) : 0;
+    case FactMetaData::valueTypeFloat:
+        return static_cast<float>(value);
+    case FactMetaData::valueTypeBool:
+        return qIsFinite(value) && qRound64(value) != 0 ? 1 : 0;
+    case FactMetaData::valueTypeDouble:
+    case FactMetaData::valueTypeElapsedTimeInSeconds:
+    case FactMetaData::valueTypeString:
+        break;
+    }
+
+    return value;
+}
+
+bool Fact::_variantIsNumeric(const QVariant& variant)
+{
+    switch (static_cast<int>(variant.userType())) {
+    case QMetaType::Bool:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Double:
+    case QMetaType::Float:
+    case QMetaType::Long:
+    case QMetaType::ULong:
+    case QMetaType::Short:
+    case QMetaType::UShort:
+    case QMetaType::Char:
+    case QMetaType::SChar:
+    case QMetaType::UChar:
+        return true;
+    default:
+        return false;
+    }
 }
 
 QString Fact::name(void) const
@@ -159,17 +273,23 @@ int Fact::componentId(void) const
 
 QVariant Fact::cookedValue(void) const
 {
-    if (_metaData) {
-        return _metaData->rawTranslator()(_rawValue);
+    if (_resolveMetaData()) {
+        // The translated value is cached until the raw value or the translator changes
+        FactMetaData::Translator rawTranslator = _metaData->rawTranslator();
+        if (rawTranslator != _cookedValueTranslator) {
+            _cookedValue = rawTranslator(rawValue());
+            _cookedValueTranslator = rawTranslator;
+        }
+        return _cookedValue;
     } else {
         qWarning() << "Meta data pointer missing";
-        return _rawValue;
+        return rawValue();
     }
 }
 
 QString Fact::enumStringValue(void)
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         int enumIndex = this->enumIndex();
         if (enumIndex >= 0 && enumIndex < _metaData->enumStrings().count()) {
             return _metaData->enumStrings()[enumIndex];
@@ -183,7 +303,7 @@ QString Fact::enumStringValue(void)
 
 int Fact::enumIndex(void)
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         int index = 0;
 
         foreach (QVariant enumValue, _metaData->enumValues()) {
@@ -207,7 +327,7 @@ int Fact::enumIndex(void)
 
 QStringList Fact::enumStrings(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->enumStrings();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -217,7 +337,7 @@ QStringList Fact::enumStrings(void) const
 
 QVariantList Fact::enumValues(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->enumValues();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -227,7 +347,7 @@ QVariantList Fact::enumValues(void) const
 
 QStringList Fact::bitmaskStrings(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->bitmaskStrings();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -237,7 +357,7 @@ QStringList Fact::bitmaskStrings(void) const
 
 QVariantList Fact::bitmaskValues(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->bitmaskValues();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -308,7 +428,7 @@ QString Fact::cookedValueString(void) const
 
 QVariant Fact::rawDefaultValue(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         if (!_metaData->defaultValueAvailable()) {
             qDebug() << "Access to unavailable default value";
         }
@@ -321,7 +441,7 @@ QVariant Fact::rawDefaultValue(void) const
 
 QVariant Fact::cookedDefaultValue(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         if (!_metaData->defaultValueAvailable()) {
             qDebug() << "Access to unavailable default value";
         }
@@ -344,7 +464,7 @@ FactMetaData::ValueType_t Fact::type(void) const
 
 QString Fact::shortDescription(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->shortDescription();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -354,7 +474,7 @@ QString Fact::shortDescription(void) const
 
 QString Fact::longDescription(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->longDescription();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -364,7 +484,7 @@ QString Fact::longDescription(void) const
 
 QString Fact::rawUnits(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->rawUnits();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -374,7 +494,7 @@ QString Fact::rawUnits(void) const
 
 QString Fact::cookedUnits(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->cookedUnits();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -384,7 +504,7 @@ QString Fact::cookedUnits(void) const
 
 QVariant Fact::rawMin(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->rawMin();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -394,7 +514,7 @@ QVariant Fact::rawMin(void) const
 
 QVariant Fact::cookedMin(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->cookedMin();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -409,7 +529,7 @@ QString Fact::cookedMinString(void) const
 
 QVariant Fact::rawMax(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->rawMax();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -419,7 +539,7 @@ QVariant Fact::rawMax(void) const
 
 QVariant Fact::cookedMax(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->cookedMax();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -434,7 +554,7 @@ QString Fact::cookedMaxString(void) const
 
 bool Fact::minIsDefaultForType(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->minIsDefaultForType();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -444,7 +564,7 @@ bool Fact::minIsDefaultForType(void) const
 
 bool Fact::maxIsDefaultForType(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->maxIsDefaultForType();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -454,7 +574,7 @@ bool Fact::maxIsDefaultForType(void) const
 
 int Fact::decimalPlaces(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->decimalPlaces();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -464,7 +584,11 @@ int Fact::decimalPlaces(void) const
 
 QString Fact::group(void) const
 {
-    if (_metaData) {
+    if (_metaDataFactory && !_metaDataFactoryGroup.isEmpty()) {
+        // Grouping all parameters must not build the meta data of each one
+        return _metaDataFactoryGroup;
+    }
+    if (_resolveMetaData()) {
         return _metaData->group();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -474,13 +598,40 @@ QString Fact::group(void) const
 
 void Fact::setMetaData(FactMetaData* metaData)
 {
+    _metaDataFactory = MetaDataFactory();
+    _metaDataFactoryGroup.clear();
     _metaData = metaData;
+    _cookedValueTranslator = NULL;
     emit valueChanged(cookedValue());
 }
 
+void Fact::setMetaDataFactory(const MetaDataFactory& metaDataFactory, const QString& group)
+{
+    _metaDataFactory = metaDataFactory;
+    _metaDataFactoryGroup = group;
+}
+
+/// Meta data supplied through setMetaDataFactory is created here on first access. Since all meta data access goes
+/// through this method no value can have been translated with the placeholder meta data, so no signals are needed.
+FactMetaData* Fact::_resolveMetaData(void) const
+{
+    if (_metaDataFactory) {
+        Fact* fact = const_cast<Fact*>(this);
+        MetaDataFactory metaDataFactory = fact->_metaDataFactory;
+        fact->_metaDataFactory = MetaDataFactory();
+        fact->_metaDataFactoryGroup.clear();
+        FactMetaData* metaData = metaDataFactory(fact);
+        if (metaData) {
+            fact->_metaData = metaData;
+            fact->_cookedValueTranslator = NULL;
+        }
+    }
+    return _metaData;
+}
+
 bool Fact::valueEqualsDefault(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         if (_metaData->defaultValueAvailable()) {
             return _metaData->rawDefaultValue() == rawValue();
         } else {
@@ -494,7 +645,7 @@ bool Fact::valueEqualsDefault(void) const
 
 bool Fact::defaultValueAvailable(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->defaultValueAvailable();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -504,7 +655,7 @@ bool Fact::defaultValueAvailable(void) const
 
 QString Fact::validate(const QString& cookedValue, bool convertOnly)
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         QVariant    typedValue;
         QString     errorString;
         
@@ -519,7 +670,7 @@ QString Fact::validate(const QString& cookedValue, bool convertOnly)
 
 bool Fact::rebootRequired(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->rebootRequired();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -535,10 +686,14 @@ void Fact::setSendValueChangedSignals (bool sendValueChangedSignals)
     }
 }
 
-void Fact::_sendValueChangedSignal(QVariant value)
+/// The cooked value is only translated if the signal is actually sent, deferred signals translate once per update cycle
+void Fact::_sendValueChangedSignal(void)
 {
     if (_sendValueChangedSignals) {
-        emit valueChanged(value);
+        // Translating the value creates lazy meta data, which is not needed until something listens
+        if (valueChangedConnected()) {
+            emit valueChanged(cookedValue());
+        }
         _deferredValueChangeSignal = false;
     } else {
         _deferredValueChangeSignal = true;
@@ -549,13 +704,21 @@ void Fact::sendDeferredValueChangedSignal(void)
 {
     if (_deferredValueChangeSignal) {
         _deferredValueChangeSignal = false;
-        emit valueChanged(cookedValue());
+        if (valueChangedConnected()) {
+            emit valueChanged(cookedValue());
+        }
     }
 }
 
+bool Fact::valueChangedConnected(void) const
+{
+    static const QMetaMethod valueChangedSignal = QMetaMethod::fromSignal(&Fact::valueChanged);
+    return isSignalConnected(valueChangedSignal);
+}
+
 QString Fact::enumOrValueString(void)
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         if (_metaData->enumStrings().count()) {
             return enumStringValue();
         } else {
@@ -569,7 +732,7 @@ QString Fact::enumOrValueString(void)
 
 double Fact::increment(void) const
 {
-    if (_metaData) {
+    if (_resolveMetaData()) {
         return _metaData->increment();
     } else {
         qWarning() << "Meta data pointer missing";
@@ -21,6 +21,8 @@
 #include <QVariant>
 #include <QDebug>
 
+#include <functional>
+
 /// @brief A Fact is used to hold a single value within the system.
 class Fact : public QObject
 {
@@ -70,7 +72,7 @@ public:
     Q_INVOKABLE QString validate(const QString& cookedValue, bool convertOnly);
 
     QVariant        cookedValue             (void) const;   /// Value after translation
-    QVariant        rawValue                (void) const { return _rawValue; }  /// value prior to translation, careful
+    QVariant        rawValue                (void) const;   /// value prior to translation, careful
     int             componentId             (void) const;
     int             decimalPlaces           (void) const;
     QVariant        rawDefaultValue         (void) const;
@@ -124,13 +126,31 @@ public:
     void clearDeferredValueChangeSignal(void) { _deferredValueChangeSignal = false; }
     void sendDeferredValueChangedSignal(void);
 
+    /// @return true: something, typically a QML binding, is connected to valueChanged
+    bool valueChangedConnected(void) const;
+
     // C++ methods
 
+    /// Raw value of a numeric or bool Fact without going through QVariant. Returns 0 for string Facts.
+    double rawNumericValue(void) const { return _rawNumber; }
+
+    /// Sets the raw value of a numeric or bool Fact without going through QVariant or the meta data. The value is
+    /// converted to the Fact type the same way setRawValue would convert it. Used for high rate telemetry updates.
+    void setRawNumericValue(double value);
+
     /// Sets and sends new value to vehicle even if value is the same
     void forceSetRawValue(const QVariant& value);
     
     /// Sets the meta data associated with the Fact.
     void setMetaData(FactMetaData* metaData);
+
+    typedef std::function<FactMetaData*(Fact* fact)> MetaDataFactory;
+
+    /// Sets a factory which creates the meta data the first time it is needed. Used for parameters so that full meta
+    /// data is only built for parameters which are actually looked at.
+    ///     @param group Group of the meta data the factory creates, returned by group() without creating the meta
+    ///                  data. Empty if not known up front.
+    void setMetaDataFactory(const MetaDataFactory& metaDataFactory, const QString& group = QString());
     
     void _containerSetRawValue(const QVariant& value);
     
@@ -161,13 +181,24 @@ signals:
     
 protected:
     QString _variantToString(const QVariant& variant, int decimalPlaces) const;
-    void _sendValueChangedSignal(QVariant value);
+    void _sendValueChangedSignal(void);
+    FactMetaData* _resolveMetaData(void) const;
+    void _storeRawValue(const QVariant& value);
+    double _toTypedNumber(double value) const;
+    bool _typeIsNumeric(void) const { return _type != FactMetaData::valueTypeString; }
+
+    static bool _variantIsNumeric(const QVariant& variant);
 
     QString                     _name;
     int                         _componentId;
-    QVariant                    _rawValue;
+    double                      _rawNumber;             ///< Raw value for numeric and bool types, already converted to _type
+    QString                     _rawString;             ///< Raw value for string type
     FactMetaData::ValueType_t   _type;
     FactMetaData*               _metaData;
+    MetaDataFactory             _metaDataFactory;
+    QString                     _metaDataFactoryGroup;  ///< Group of the meta data _metaDataFactory will create
+    mutable QVariant                    _cookedValue;           ///< Cached result of translating the raw value
+    mutable FactMetaData::Translator    _cookedValueTranslator; ///< Translator used for _cookedValue, NULL if cache is invalid
     bool                        _sendValueChangedSignals;
     bool                        _deferredValueChangeSignal;
 };
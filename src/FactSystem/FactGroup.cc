@@ -9,6 +9,7 @@
 
 
 #include "FactGroup.h"
+#include "FactGroupUpdateClock.h"
 #include "JsonHelper.h"
 
 #include <QJsonDocument>
@@ -25,14 +26,21 @@ FactGroup::FactGroup(int updateRateMsecs, const QString& metaDataFile, QObject*
     , _updateRateMSecs(updateRateMsecs)
 {
     if (_updateRateMSecs > 0) {
-        connect(&_updateTimer, &QTimer::timeout, this, &FactGroup::_updateAllValues);
-        _updateTimer.setSingleShot(false);
-        _updateTimer.start(_updateRateMSecs);
+        FactGroupUpdateClock::instance()->addFactGroup(this, _updateRateMSecs);
     }
 
     _loadMetaData(metaDataFile);
 }
 
+FactGroup::~FactGroup()
+{
+    // FactGroups which outlive the application clock, such as static ones, have nothing to remove
+    FactGroupUpdateClock* updateClock = FactGroupUpdateClock::instance();
+    if (_updateRateMSecs > 0 && updateClock) {
+        updateClock->removeFactGroup(this);
+    }
+}
+
 Fact* FactGroup::getFact(const QString& name)
 {
     Fact* fact = NULL;
@@ -101,10 +109,13 @@ void FactGroup::_addFactGroup(FactGroup* factGroup, const QString& name)
     _nameToFactGroupMap[name] = factGroup;
 }
 
+/// Facts which nothing is bound to keep their pending change, it is sent on the first update after something binds
 void FactGroup::_updateAllValues(void)
 {
     foreach(Fact* fact, _nameToFactMap) {
-        fact->sendDeferredValueChangedSignal();
+        if (fact->deferredValueChangeSignal() && fact->valueChangedConnected()) {
+            fact->sendDeferredValueChangedSignal();
+        }
     }
 }
 
@@ -27,6 +27,7 @@ class FactGroup : public QObject
     
 public:
     FactGroup(int updateRateMsecs, const QString& metaDataFile, QObject* parent = NULL);
+    ~FactGroup();
 
     Q_PROPERTY(QStringList factNames        READ factNames      CONSTANT)
     Q_PROPERTY(QStringList factGroupNames   READ factGroupNames CONSTANT)
@@ -46,17 +47,17 @@ protected:
 
     int _updateRateMSecs;   ///< Update rate for Fact::valueChanged signals, 0: immediate update
 
-private slots:
+private:
+    /// Sends the deferred value changes, called by FactGroupUpdateClock
     void _updateAllValues(void);
 
-private:
     void _loadMetaData(const QString& filename);
 
     QMap<QString, Fact*>            _nameToFactMap;
     QMap<QString, FactGroup*>       _nameToFactGroupMap;
     QMap<QString, FactMetaData*>    _nameToFactMetaDataMap;
 
-    QTimer _updateTimer;
+    friend class FactGroupUpdateClock;
 };
 
 #endif
@@ -0,0 +1,91 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactGroupUpdateClock.h"
+#include "FactGroup.h"
+
+#include <climits>
+
+Q_GLOBAL_STATIC(FactGroupUpdateClock, _factGroupUpdateClock)
+
+FactGroupUpdateClock::FactGroupUpdateClock(QObject* parent)
+    : QObject(parent)
+{
+    _frameTimer.setSingleShot(false);
+    _frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&_frameTimer, &QTimer::timeout, this, &FactGroupUpdateClock::_frame);
+
+    _clock.start();
+}
+
+FactGroupUpdateClock* FactGroupUpdateClock::instance(void)
+{
+    return _factGroupUpdateClock;
+}
+
+void FactGroupUpdateClock::addFactGroup(FactGroup* factGroup, int updateRateMSecs)
+{
+    GroupSchedule schedule;
+
+    schedule.updateRateMSecs = updateRateMSecs;
+    schedule.nextUpdateMSecs = _clock.elapsed() + updateRateMSecs;
+    _groups[factGroup] = schedule;
+
+    _updateFrameInterval();
+}
+
+void FactGroupUpdateClock::removeFactGroup(FactGroup* factGroup)
+{
+    if (_groups.remove(factGroup)) {
+        _updateFrameInterval();
+    }
+}
+
+/// The clock ticks at the fastest requested rate. Slower groups line up with the same ticks so they never add wakeups.
+void FactGroupUpdateClock::_updateFrameInterval(void)
+{
+    if (_groups.isEmpty()) {
+        _frameTimer.stop();
+        return;
+    }
+
+    int frameIntervalMSecs = INT_MAX;
+    foreach (const GroupSchedule& schedule, _groups) {
+        frameIntervalMSecs = qMin(frameIntervalMSecs, schedule.updateRateMSecs);
+    }
+
+    if (!_frameTimer.isActive() || _frameTimer.interval() != frameIntervalMSecs) {
+        _frameTimer.start(frameIntervalMSecs);
+    }
+}
+
+void FactGroupUpdateClock::_frame(void)
+{
+    // Allow half a frame of timer jitter so a group due on this tick is not pushed out to the next one
+    qint64 frameTime = _clock.elapsed() + (_frameTimer.interval() / 2);
+
+    // The signals sent below run QML bindings, so collect the due groups first rather than updating while iterating
+    QList<FactGroup*> dueGroups;
+    for (QMap<FactGroup*, GroupSchedule>::iterator iter=_groups.begin(); iter!=_groups.end(); iter++) {
+        if (frameTime >= iter->nextUpdateMSecs) {
+            dueGroups.append(iter.key());
+            iter->nextUpdateMSecs += iter->updateRateMSecs;
+            if (iter->nextUpdateMSecs < frameTime) {
+                // Fell behind, for example while the event loop was blocked. Don't try to catch up with a burst.
+                iter->nextUpdateMSecs = frameTime + iter->updateRateMSecs;
+            }
+        }
+    }
+
+    foreach (FactGroup* factGroup, dueGroups) {
+        if (_groups.contains(factGroup)) {
+            factGroup->_updateAllValues();
+        }
+    }
+}
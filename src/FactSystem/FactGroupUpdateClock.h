@@ -0,0 +1,56 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QMap>
+
+class FactGroup;
+
+/// Single clock which drives the deferred value change signals of all FactGroups across all vehicles.
+///
+/// One timer ticks at the fastest update rate any FactGroup asked for. On each tick every FactGroup which is due is
+/// updated in the same pass, so QML sees the telemetry changes of all groups and vehicles at once instead of from
+/// many timers firing out of phase. The timer only runs while FactGroups with deferred updates exist.
+class FactGroupUpdateClock : public QObject
+{
+    Q_OBJECT
+
+public:
+    FactGroupUpdateClock(QObject* parent = NULL);
+
+    /// @return Shared application wide instance, NULL once it was destroyed at application exit
+    static FactGroupUpdateClock* instance(void);
+
+    /// Adds a FactGroup which is updated every updateRateMSecs
+    void addFactGroup(FactGroup* factGroup, int updateRateMSecs);
+
+    void removeFactGroup(FactGroup* factGroup);
+
+    /// @return Current tick interval, 0 if the clock is stopped
+    int frameIntervalMSecs(void) const { return _frameTimer.isActive() ? _frameTimer.interval() : 0; }
+
+private slots:
+    void _frame(void);
+
+private:
+    void _updateFrameInterval(void);
+
+    struct GroupSchedule {
+        int     updateRateMSecs;
+        qint64  nextUpdateMSecs;    ///< Clock time at which the group is next due
+    };
+
+    QTimer                              _frameTimer;
+    QElapsedTimer                       _clock;
+    QMap<FactGroup*, GroupSchedule>     _groups;
+};
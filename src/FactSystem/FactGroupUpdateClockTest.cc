@@ -0,0 +1,102 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactGroupUpdateClockTest.h"
+#include "FactGroupUpdateClock.h"
+#include "FactGroup.h"
+
+/// FactGroup with a single Fact which defers its value changes. It is not registered with the application clock,
+/// the tests add it to their own clock.
+class ClockTestFactGroup : public FactGroup
+{
+public:
+    ClockTestFactGroup(void)
+        : FactGroup(0, QStringLiteral(":/json/Vehicle/VehicleFact.json"))
+        , _valueFact(0, QStringLiteral("value"), FactMetaData::valueTypeDouble)
+    {
+        _addFact(&_valueFact, _valueFact.name());
+        _valueFact.setSendValueChangedSignals(false);
+    }
+
+    Fact* valueFact(void) { return &_valueFact; }
+
+private:
+    Fact _valueFact;
+};
+
+FactGroupUpdateClockTest::FactGroupUpdateClockTest(void)
+{
+
+}
+
+void FactGroupUpdateClockTest::_frameInterval_test(void)
+{
+    FactGroupUpdateClock clock;
+    ClockTestFactGroup fastGroup;
+    ClockTestFactGroup slowGroup;
+
+    QCOMPARE(clock.frameIntervalMSecs(), 0);
+
+    // The clock ticks at the fastest rate and stops once no groups are left
+    clock.addFactGroup(&slowGroup, 300);
+    QCOMPARE(clock.frameIntervalMSecs(), 300);
+    clock.addFactGroup(&fastGroup, 100);
+    QCOMPARE(clock.frameIntervalMSecs(), 100);
+    clock.removeFactGroup(&fastGroup);
+    QCOMPARE(clock.frameIntervalMSecs(), 300);
+    clock.removeFactGroup(&slowGroup);
+    QCOMPARE(clock.frameIntervalMSecs(), 0);
+}
+
+void FactGroupUpdateClockTest::_coalesce_test(void)
+{
+    FactGroupUpdateClock clock;
+    ClockTestFactGroup factGroup;
+    QSignalSpy spy(factGroup.valueFact(), SIGNAL(valueChanged(QVariant)));
+
+    clock.addFactGroup(&factGroup, 50);
+
+    // Several changes between two ticks are sent as one change with the last value
+    factGroup.valueFact()->setRawValue(1.0);
+    factGroup.valueFact()->setRawValue(2.0);
+    factGroup.valueFact()->setRawValue(3.0);
+    QCOMPARE(spy.count(), 0);
+    QTRY_COMPARE_WITH_TIMEOUT(spy.count(), 1, 1000);
+    QCOMPARE(spy.takeFirst().at(0).toDouble(), 3.0);
+
+    // Nothing is sent while the value does not change
+    QTest::qWait(200);
+    QCOMPARE(spy.count(), 0);
+
+    clock.removeFactGroup(&factGroup);
+}
+
+void FactGroupUpdateClockTest::_slowGroup_test(void)
+{
+    FactGroupUpdateClock clock;
+    ClockTestFactGroup fastGroup;
+    ClockTestFactGroup slowGroup;
+    QSignalSpy fastSpy(fastGroup.valueFact(), SIGNAL(valueChanged(QVariant)));
+    QSignalSpy slowSpy(slowGroup.valueFact(), SIGNAL(valueChanged(QVariant)));
+
+    clock.addFactGroup(&fastGroup, 50);
+    clock.addFactGroup(&slowGroup, 1000);
+
+    // The slow group is not updated on every tick of the faster clock
+    slowGroup.valueFact()->setRawValue(1.0);
+    fastGroup.valueFact()->setRawValue(1.0);
+    QTRY_COMPARE_WITH_TIMEOUT(fastSpy.count(), 1, 1000);
+    QCOMPARE(slowSpy.count(), 0);
+
+    // But it is updated once its own rate is due
+    QTRY_COMPARE_WITH_TIMEOUT(slowSpy.count(), 1, 2000);
+
+    clock.removeFactGroup(&fastGroup);
+    clock.removeFactGroup(&slowGroup);
+}
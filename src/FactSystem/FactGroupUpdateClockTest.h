@@ -0,0 +1,26 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for FactGroupUpdateClock scheduling
+class FactGroupUpdateClockTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    FactGroupUpdateClockTest(void);
+
+private slots:
+    void _frameInterval_test(void);
+    void _coalesce_test(void);
+    void _slowGroup_test(void);
+};
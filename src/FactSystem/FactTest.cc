@@ -0,0 +1,230 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactTest.h"
+#include "Fact.h"
+
+#include <QElapsedTimer>
+
+#include <cstdlib>
+#include <new>
+
+int FactTest::_translationCount = 0;
+
+// Counts heap allocations made through operator new by the thread running the benchmark. Replacing the global
+// operators affects the whole test binary, but outside of a count they only add a flag check.
+static thread_local bool    _countAllocations = false;
+static thread_local int     _allocationCount = 0;
+
+void* operator new(std::size_t size)
+{
+    if (_countAllocations) {
+        _allocationCount++;
+    }
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) Q_DECL_NOEXCEPT
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) Q_DECL_NOEXCEPT
+{
+    std::free(p);
+}
+
+FactTest::FactTest(void)
+{
+
+}
+
+QVariant FactTest::_countingTranslator(const QVariant& from)
+{
+    _translationCount++;
+    return QVariant(from.toDouble() * 2.0);
+}
+
+QVariant FactTest::_identityTranslator(const QVariant& from)
+{
+    return from;
+}
+
+void FactTest::_startAllocationCount(void)
+{
+    _allocationCount = 0;
+    _countAllocations = true;
+}
+
+int FactTest::_stopAllocationCount(void)
+{
+    _countAllocations = false;
+    return _allocationCount;
+}
+
+void FactTest::_typedStorage_test(void)
+{
+    static const double rgValues[] = { 0, 1, -1, 3.4, 3.5, -3.5, 255.7, 70000.2, 1e-7 };
+
+    static const FactMetaData::ValueType_t rgTypes[] = {
+        FactMetaData::valueTypeUint8, FactMetaData::valueTypeInt8, FactMetaData::valueTypeUint16, FactMetaData::valueTypeInt16,
+        FactMetaData::valueTypeUint32, FactMetaData::valueTypeInt32, FactMetaData::valueTypeFloat, FactMetaData::valueTypeDouble,
+        FactMetaData::valueTypeBool, FactMetaData::valueTypeElapsedTimeInSeconds,
+    };
+
+    // The numeric fast path must store exactly what the meta data conversion would store
+    for (size_t i=0; i<sizeof(rgTypes)/sizeof(rgTypes[0]); i++) {
+        FactMetaData metaData(rgTypes[i]);
+
+        for (size_t j=0; j<sizeof(rgValues)/sizeof(rgValues[0]); j++) {
+            QVariant    typedValue;
+            QString     errorString;
+            QVERIFY(metaData.convertAndValidateRaw(QVariant(rgValues[j]), true /* convertOnly */, typedValue, errorString));
+
+            Fact fact(0, QStringLiteral("fast"), rgTypes[i]);
+            fact.setRawNumericValue(rgValues[j]);
+
+            QCOMPARE(fact.rawValue().userType(), typedValue.userType());
+            QCOMPARE(fact.rawValue(), typedValue);
+            QCOMPARE(fact.rawNumericValue(), typedValue.toDouble());
+        }
+    }
+
+    Fact stringFact(0, QStringLiteral("string"), FactMetaData::valueTypeString);
+    stringFact.setRawValue(QStringLiteral("value"));
+    QCOMPARE(stringFact.rawValue(), QVariant(QStringLiteral("value")));
+    stringFact.setRawNumericValue(2.5);
+    QCOMPARE(stringFact.rawValue().toString(), QStringLiteral("2.5"));
+
+    // NaN updates only signal once
+    Fact nanFact(0, QStringLiteral("nan"), FactMetaData::valueTypeDouble);
+    QSignalSpy spy(&nanFact, &Fact::rawValueChanged);
+    nanFact.setRawNumericValue(qQNaN());
+    nanFact.setRawNumericValue(qQNaN());
+    nanFact.setRawValue(qQNaN());
+    QCOMPARE(spy.count(), 1);
+}
+
+void FactTest::_cookedValueCache_test(void)
+{
+    Fact fact(0, QStringLiteral("cooked"), FactMetaData::valueTypeDouble);
+    FactMetaData* metaData = new FactMetaData(FactMetaData::valueTypeDouble, &fact);
+    metaData->setTranslators(_countingTranslator, _countingTranslator);
+    fact.setMetaData(metaData);
+    fact.setSendValueChangedSignals(false);
+
+    // Telemetry updates with deferred signals do not translate
+    _translationCount = 0;
+    for (int i=0; i<100; i++) {
+        fact.setRawNumericValue(i);
+    }
+    QCOMPARE(_translationCount, 0);
+
+    // One translation per deferred signal, further reads use the cache
+    fact.sendDeferredValueChangedSignal();
+    QCOMPARE(_translationCount, 1);
+    QCOMPARE(fact.cookedValue().toDouble(), 198.0);
+    QCOMPARE(fact.cookedValueString(), QStringLiteral("198.0"));
+    QCOMPARE(_translationCount, 1);
+
+    // Writes invalidate the cache
+    fact.setRawNumericValue(1);
+    QCOMPARE(fact.cookedValue().toDouble(), 2.0);
+    QCOMPARE(_translationCount, 2);
+
+    // A new translator invalidates the cache
+    metaData->setTranslators(_identityTranslator, _identityTranslator);
+    QCOMPARE(fact.cookedValue().toDouble(), 1.0);
+}
+
+void FactTest::_valueChangedConnected_test(void)
+{
+    Fact fact(0, QStringLiteral("bound"), FactMetaData::valueTypeDouble);
+    fact.setSendValueChangedSignals(false);
+    fact.setRawNumericValue(1);
+
+    // FactGroups leave the pending change alone until something binds
+    QCOMPARE(fact.valueChangedConnected(), false);
+    QCOMPARE(fact.deferredValueChangeSignal(), true);
+
+    QSignalSpy spy(&fact, SIGNAL(valueChanged(QVariant)));
+    QCOMPARE(fact.valueChangedConnected(), true);
+    fact.sendDeferredValueChangedSignal();
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(fact.deferredValueChangeSignal(), false);
+}
+
+/// Compares the cost of a telemetry update followed by a read of the cooked value, as done for each message shown in
+/// the UI. The previous storage converted a QVariant through the meta data on each update and translated it again on
+/// each read, it is replayed here with the same meta data calls as a baseline.
+void FactTest::_numericUpdate_benchmark(void)
+{
+    UT_OPT_IN(optInBenchmarks);
+
+    const int cUpdates = 1000000;
+
+    FactMetaData metaData(FactMetaData::valueTypeDouble);
+    Fact fact(0, QStringLiteral("benchmark"), FactMetaData::valueTypeDouble);
+    fact.setSendValueChangedSignals(false);
+
+    QVariant storedValue;
+    QVariant cookedValue;
+    QString errorString;
+    QElapsedTimer timer;
+
+    _startAllocationCount();
+    timer.start();
+    for (int i=0; i<cUpdates; i++) {
+        QVariant typedValue;
+        if (metaData.convertAndValidateRaw(QVariant(static_cast<double>(i)), true /* convertOnly */, typedValue, errorString) && typedValue != storedValue) {
+            storedValue = typedValue;
+        }
+        cookedValue = metaData.cookedTranslator()(storedValue);
+    }
+    qint64 variantMSecs = timer.elapsed();
+    int variantAllocations = _stopAllocationCount();
+
+    _startAllocationCount();
+    timer.start();
+    for (int i=0; i<cUpdates; i++) {
+        fact.setRawValue(QVariant(static_cast<double>(i)));
+        cookedValue = fact.cookedValue();
+    }
+    qint64 setterMSecs = timer.elapsed();
+    int setterAllocations = _stopAllocationCount();
+
+    _startAllocationCount();
+    timer.start();
+    for (int i=0; i<cUpdates; i++) {
+        fact.setRawNumericValue(cUpdates + i);
+        cookedValue = fact.cookedValue();
+    }
+    qint64 numericMSecs = timer.elapsed();
+    int numericAllocations = _stopAllocationCount();
+
+    QCOMPARE(fact.rawNumericValue(), static_cast<double>((2 * cUpdates) - 1));
+    QCOMPARE(cookedValue.toDouble(), static_cast<double>((2 * cUpdates) - 1));
+
+    qDebug() << "Fact update and read," << cUpdates << "updates";
+    qDebug() << "  QVariant storage:       " << variantMSecs << "msecs" << (double)variantAllocations / cUpdates << "allocations per update";
+    qDebug() << "  setRawValue(QVariant):  " << setterMSecs << "msecs" << (double)setterAllocations / cUpdates << "allocations per update";
+    qDebug() << "  setRawNumericValue:     " << numericMSecs << "msecs" << (double)numericAllocations / cUpdates << "allocations per update";
+
+    QVERIFY(setterAllocations <= variantAllocations);
+    QVERIFY(numericAllocations <= setterAllocations);
+}
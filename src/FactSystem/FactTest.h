@@ -0,0 +1,35 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for Fact value storage
+class FactTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    FactTest(void);
+
+private slots:
+    void _typedStorage_test(void);
+    void _cookedValueCache_test(void);
+    void _valueChangedConnected_test(void);
+    void _numericUpdate_benchmark(void);
+
+private:
+    static QVariant _countingTranslator(const QVariant& from);
+    static QVariant _identityTranslator(const QVariant& from);
+    static void     _startAllocationCount(void);
+    static int      _stopAllocationCount(void);
+
+    static int _translationCount;
+};
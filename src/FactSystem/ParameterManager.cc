@@ -26,11 +26,6 @@
 #include <QVariantAnimation>
 #include <QJsonArray>
 
-/* types for local parameter cache */
-typedef QPair<int, QVariant> ParamTypeVal;
-typedef QPair<QString, ParamTypeVal> NamedParam;
-typedef QMap<int, NamedParam> MapID2NamedParam;
-
 QGC_LOGGING_CATEGORY(ParameterManagerVerbose1Log, "ParameterManagerVerbose1Log")
 QGC_LOGGING_CATEGORY(ParameterManagerVerbose2Log, "ParameterManagerVerbose2Log")
 
@@ -41,6 +36,8 @@ const char* ParameterManager::_jsonParametersKey =          "parameters";
 const char* ParameterManager::_jsonCompIdKey =              "compId";
 const char* ParameterManager::_jsonParamNameKey =           "name";
 const char* ParameterManager::_jsonParamValueKey =          "value";
+const char* ParameterManager::_rangeHashParamPrefix =       "_HR:";
+const char* ParameterManager::_rangeHashSupportParamName =  "_HR:SUPPORT";
 
 ParameterManager::ParameterManager(Vehicle* vehicle)
     : QObject(vehicle)
@@ -62,6 +59,10 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
     , _disableAllRetries(false)
     , _indexBatchQueueActive(false)
     , _totalParamCount(0)
+    , _cacheSyncSupported(false)
+    , _cacheSyncFailed(false)
+    , _cacheSyncComponentId(-1)
+    , _cacheSyncVehicleId(0)
 {
     _versionParam = vehicle->firmwarePlugin()->getVersionParam();
 
@@ -80,12 +81,19 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
     _waitingParamTimeoutTimer.setInterval(3000);
     connect(&_waitingParamTimeoutTimer, &QTimer::timeout, this, &ParameterManager::_waitingParamTimeout);
 
+    _cacheSyncTimeoutTimer.setSingleShot(true);
+    _cacheSyncTimeoutTimer.setInterval(1000);
+    connect(&_cacheSyncTimeoutTimer, &QTimer::timeout, this, &ParameterManager::_cacheSyncTimeout);
+
     connect(_vehicle->uas(), &UASInterface::parameterUpdate, this, &ParameterManager::_parameterUpdate);
 
     // Ensure the cache directory exists
     QFileInfo(QSettings().fileName()).dir().mkdir("ParamCache");
 
-    refreshAllParameters();
+    // Vehicles in the fleet profile request their parameters once they are selected
+    if (!_vehicle->fleetProfile()) {
+        refreshAllParameters();
+    }
 }
 
 ParameterManager::~ParameterManager()
@@ -110,6 +118,23 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
                                             "value:" << value <<
                                             ")";
 
+    // Range hash names are never parameters, including late answers to a sync which was already abandoned
+    if (parameterName.startsWith(_rangeHashParamPrefix)) {
+        if (parameterName == _rangeHashSupportParamName) {
+            // The full download after a failed sync is answered with the same advertisement, which must not start
+            // the failed sync all over again
+            if (!_logReplay && !_cacheSyncFailed) {
+                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Vehicle supports range hashes";
+                _cacheSyncSupported = true;
+            }
+        } else if (componentId == _cacheSyncComponentId) {
+            _cacheSyncRangeHash(componentId, parameterName, value.toUInt());
+        } else {
+            qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Disregarding range hash outside of cache sync" << parameterName;
+        }
+        return;
+    }
+
     // ArduPilot has this strange behavior of streaming parameters that we didn't ask for. This even happens before it responds to the
     // PARAM_REQUEST_LIST. We disregard any of this until the initial request is responded to.
     if (parameterId == 65535 && parameterName != "_HASH_CHECK" && _initialRequestTimeoutTimer.isActive()) {
@@ -139,7 +164,13 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
 
     if (_vehicle->px4Firmware() && parameterName == "_HASH_CHECK" && !_logReplay) {
         /* we received a cache hash, potentially load from cache */
-        _tryCacheHashLoad(vehicleId, componentId, value);
+        _tryCacheHashLoad(vehicleId, componentId, parameterCount, value);
+        return;
+    }
+
+    if (componentId == _cacheSyncComponentId) {
+        // Values which were streamed before the vehicle stopped are loaded from the cache or re-read once the sync completes
+        qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Disregarding param update during cache sync" << parameterName;
         return;
     }
 
@@ -148,82 +179,68 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
 
     _dataMutex.lock();
 
-    // Update our total parameter counts
-    if (!_paramCountMap.contains(componentId)) {
-        _paramCountMap[componentId] = parameterCount;
+    // If we've never seen this component id before, setup the wait lists.
+    bool newComponent = !_components.contains(componentId);
+    ComponentParameters& component = _components[componentId];
+    if (newComponent) {
+        component.paramCount = parameterCount;
         _totalParamCount += parameterCount;
-    }
-
-    _mapParameterId2Name[componentId][parameterId] = parameterName;
 
-    // If we've never seen this component id before, setup the wait lists.
-    if (!_waitingReadParamIndexMap.contains(componentId)) {
         // Add all indices to the wait list, parameter index is 0-based
-        for (int waitingIndex=0; waitingIndex<parameterCount; waitingIndex++) {
-            // This will add the new component id, as well as the the new waiting index and set the retry count for that index to 0
-            _waitingReadParamIndexMap[componentId][waitingIndex] = 0;
-        }
-
-        // The read and write waiting lists for this component are initialized the empty
-        _waitingReadParamNameMap[componentId] = QMap<QString, int>();
-        _waitingWriteParamNameMap[componentId] = QMap<QString, int>();
+        component.paramIndexToFactIndex.fill(-1, parameterCount);
+        component.setAllIndicesWaiting();
 
         qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Seeing component for first time - paramcount:" << parameterCount;
     }
 
     bool componentParamsComplete = false;
-    if (_waitingReadParamIndexMap[componentId].count() == 1) {
+    if (component.waitingReadIndexCount == 1) {
         // We need to know when we get the last param from a component in order to complete setup
         componentParamsComplete = true;
     }
 
-    if (!_waitingReadParamIndexMap[componentId].contains(parameterId) &&
-        !_waitingReadParamNameMap[componentId].contains(parameterName) &&
-        !_waitingWriteParamNameMap[componentId].contains(parameterName)) {
+    // Streamed and named updates may come with an index outside the range of the component
+    bool validParamIndex = parameterId >= 0 && parameterId < component.paramCount;
+    bool waitingForIndex = validParamIndex && component.waitingReadIndex.testBit(parameterId);
+
+    if (!waitingForIndex &&
+        !component.waitingReadName.contains(parameterName) &&
+        !component.waitingWriteName.contains(parameterName)) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix() << "Unrequested param update" << parameterName;
     }
 
     // Remove this parameter from the waiting lists
-    if (_waitingReadParamIndexMap[componentId].contains(parameterId)) {
-        _waitingReadParamIndexMap[componentId].remove(parameterId);
+    if (waitingForIndex) {
+        component.waitingReadIndex.clearBit(parameterId);
+        component.waitingReadIndexCount--;
         _indexBatchQueue.removeOne(parameterId);
         _fillIndexBatchQueue(false /* waitingParamTimeout */);
     }
-    _waitingReadParamNameMap[componentId].remove(parameterName);
-    _waitingWriteParamNameMap[componentId].remove(parameterName);
-    if (_waitingReadParamIndexMap[componentId].count()) {
-        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap:" << _waitingReadParamIndexMap[componentId];
+    component.waitingReadName.remove(parameterName);
+    component.waitingWriteName.remove(parameterName);
+    if (component.waitingReadIndexCount) {
+        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "waitingReadIndexCount:" << component.waitingReadIndexCount;
     }
-    if (_waitingReadParamNameMap[componentId].count()) {
-        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingReadParamNameMap" << _waitingReadParamNameMap[componentId];
+    if (component.waitingReadName.count()) {
+        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "waitingReadName" << component.waitingReadName;
     }
-    if (_waitingWriteParamNameMap[componentId].count()) {
-        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingWriteParamNameMap" << _waitingWriteParamNameMap[componentId];
+    if (component.waitingWriteName.count()) {
+        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "waitingWriteName" << component.waitingWriteName;
     }
 
     // Track how many parameters we are still waiting for
 
-    int waitingReadParamIndexCount = 0;
-    int waitingReadParamNameCount = 0;
-    int waitingWriteParamNameCount = 0;
+    int waitingReadParamIndexCount;
+    int waitingReadParamNameCount;
+    int waitingWriteParamNameCount;
 
-    foreach(int waitingComponentId, _waitingReadParamIndexMap.keys()) {
-        waitingReadParamIndexCount += _waitingReadParamIndexMap[waitingComponentId].count();
-    }
+    _waitingParamCounts(waitingReadParamIndexCount, waitingReadParamNameCount, waitingWriteParamNameCount);
     if (waitingReadParamIndexCount) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "waitingReadParamIndexCount:" << waitingReadParamIndexCount;
     }
-
-    foreach(int waitingComponentId, _waitingReadParamNameMap.keys()) {
-        waitingReadParamNameCount += _waitingReadParamNameMap[waitingComponentId].count();
-    }
     if (waitingReadParamNameCount) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "waitingReadParamNameCount:" << waitingReadParamNameCount;
     }
-
-    foreach(int waitingComponentId, _waitingWriteParamNameMap.keys()) {
-        waitingWriteParamNameCount += _waitingWriteParamNameMap[waitingComponentId].count();
-    }
     if (waitingWriteParamNameCount) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "waitingWriteParamNameCount:" << waitingWriteParamNameCount;
     }
@@ -235,7 +252,7 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
         _waitingParamTimeoutTimer.start();
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix() << "Restarting _waitingParamTimeoutTimer: totalWaitingParamCount:" << totalWaitingParamCount;
     } else {
-        if (!_mapParameterName2Variant.contains(_vehicle->defaultComponentId())) {
+        if (!_components.contains(_vehicle->defaultComponentId())) {
             // Still waiting for parameters from default component
             qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "Restarting _waitingParamTimeoutTimer (still waiting for default component params)";
             _waitingParamTimeoutTimer.start();
@@ -260,7 +277,8 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
         _parameterSetMajorVersion = value.toInt();
     }
 
-    if (!_mapParameterName2Variant.contains(componentId) || !_mapParameterName2Variant[componentId].contains(parameterName)) {
+    Fact* fact = component.fact(parameterName);
+    if (!fact) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Adding new fact" << parameterName;
 
         FactMetaData::ValueType_t factType;
@@ -295,25 +313,18 @@ void ParameterManager::_parameterUpdate(int vehicleId, int componentId, QString
                 break;
         }
 
-        Fact* fact = new Fact(componentId, parameterName, factType, this);
-
-        _mapParameterName2Variant[componentId][parameterName] = QVariant::fromValue(fact);
+        fact = new Fact(componentId, parameterName, factType, this);
+        component.addFact(fact, validParamIndex ? parameterId : -1);
 
         // We need to know when the fact changes from QML so that we can send the new value to the parameter manager
         connect(fact, &Fact::_containerRawValueChanged, this, &ParameterManager::_valueUpdated);
+    } else if (validParamIndex) {
+        component.paramIndexToFactIndex[parameterId] = component.nameToFactIndex[parameterName];
     }
 
     _dataMutex.unlock();
 
-    Fact* fact = NULL;
-    if (_mapParameterName2Variant[componentId].contains(parameterName)) {
-        fact = _mapParameterName2Variant[componentId][parameterName].value<Fact*>();
-    }
-    if (fact) {
-        fact->_containerSetRawValue(value);
-    } else {
-        qWarning() << "Internal error";
-    }
+    fact->_containerSetRawValue(value);
 
     if (componentParamsComplete) {
         if (componentId == _vehicle->defaultComponentId()) {
@@ -368,9 +379,8 @@ void ParameterManager::_valueUpdated(const QVariant& value)
 
     _dataMutex.lock();
 
-    if (_waitingWriteParamNameMap.contains(componentId)) {
-        _waitingWriteParamNameMap[componentId].remove(name);    // Remove any old entry
-        _waitingWriteParamNameMap[componentId][name] = 0;       // Add new entry and set retry count
+    if (_components.contains(componentId)) {
+        _components[componentId].waitingWriteName[name] = 0;    // Add new entry or reset retry count of old entry
         _waitingParamTimeoutTimer.start();
         _saveRequired = true;
     } else {
@@ -400,14 +410,11 @@ void ParameterManager::refreshAllParameters(uint8_t componentId)
     }
 
     // Reset index wait lists
-    foreach (int cid, _paramCountMap.keys()) {
+    foreach (int cid, _components.keys()) {
         // Add/Update all indices to the wait list, parameter index is 0-based
         if(componentId != MAV_COMP_ID_ALL && componentId != cid)
             continue;
-        for (int waitingIndex = 0; waitingIndex < _paramCountMap[cid]; waitingIndex++) {
-            // This will add a new waiting index if needed and set the retry count for that index to 0
-            _waitingReadParamIndexMap[cid][waitingIndex] = 0;
-        }
+        _components[cid].setAllIndicesWaiting();
     }
 
     _dataMutex.unlock();
@@ -447,11 +454,10 @@ void ParameterManager::refreshParameter(int componentId, const QString& name)
 
     _dataMutex.lock();
 
-    if (_waitingReadParamNameMap.contains(componentId)) {
+    if (_components.contains(componentId)) {
         QString mappedParamName = _remapParamNameToVersion(name);
 
-        _waitingReadParamNameMap[componentId].remove(mappedParamName);  // Remove old wait entry if there
-        _waitingReadParamNameMap[componentId][mappedParamName] = 0;     // Add new wait entry and update retry count
+        _components[componentId].waitingReadName[mappedParamName] = 0;  // Add new wait entry or reset retry count of old entry
         qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "restarting _waitingParamTimeout";
         _waitingParamTimeoutTimer.start();
     } else {
@@ -468,23 +474,26 @@ void ParameterManager::refreshParametersPrefix(int componentId, const QString& n
     componentId = _actualComponentId(componentId);
     qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "refreshParametersPrefix - name:" << namePrefix << ")";
 
-    foreach(const QString &name, _mapParameterName2Variant[componentId].keys()) {
+    foreach(const QString &name, parameterNames(componentId)) {
         if (name.startsWith(namePrefix)) {
             refreshParameter(componentId, name);
         }
     }
 }
 
-bool ParameterManager::parameterExists(int componentId, const QString&  name)
+/// @return Fact for already mapped parameter name, NULL if not found
+Fact* ParameterManager::_findParameter(int componentId, const QString& name) const
 {
-    bool ret = false;
-
-    componentId = _actualComponentId(componentId);
-    if (_mapParameterName2Variant.contains(componentId)) {
-        ret = _mapParameterName2Variant[componentId].contains(_remapParamNameToVersion(name));
+    QMap<int, ComponentParameters>::const_iterator iter = _components.constFind(componentId);
+    if (iter == _components.constEnd()) {
+        return NULL;
     }
+    return iter->fact(name);
+}
 
-    return ret;
+bool ParameterManager::parameterExists(int componentId, const QString&  name)
+{
+    return _findParameter(_actualComponentId(componentId), _remapParamNameToVersion(name)) != NULL;
 }
 
 Fact* ParameterManager::getParameter(int componentId, const QString& name)
@@ -492,20 +501,27 @@ Fact* ParameterManager::getParameter(int componentId, const QString& name)
     componentId = _actualComponentId(componentId);
 
     QString mappedParamName = _remapParamNameToVersion(name);
-    if (!_mapParameterName2Variant.contains(componentId) || !_mapParameterName2Variant[componentId].contains(mappedParamName)) {
+    Fact* fact = _findParameter(componentId, mappedParamName);
+    if (!fact) {
         qgcApp()->reportMissingParameter(componentId, mappedParamName);
         return &_defaultFact;
     }
 
-    return _mapParameterName2Variant[componentId][mappedParamName].value<Fact*>();
+    return fact;
 }
 
+/// @return Parameter names for the component in sorted order
 QStringList ParameterManager::parameterNames(int componentId)
 {
     QStringList names;
 
-    foreach(const QString &paramName, _mapParameterName2Variant[_actualComponentId(componentId)].keys()) {
-        names << paramName;
+    QMap<int, ComponentParameters>::const_iterator iter = _components.constFind(_actualComponentId(componentId));
+    if (iter != _components.constEnd()) {
+        names.reserve(iter->facts.count());
+        foreach(const Fact* fact, iter->facts) {
+            names << fact->name();
+        }
+        names.sort();
     }
 
     return names;
@@ -516,14 +532,45 @@ void ParameterManager::_setupGroupMap(void)
     // Must be able to handle being called multiple times
     _mapGroup2ParameterName.clear();
 
-    foreach (int componentId, _mapParameterName2Variant.keys()) {
-        foreach (const QString &name, _mapParameterName2Variant[componentId].keys()) {
-            Fact* fact = _mapParameterName2Variant[componentId][name].value<Fact*>();
-            _mapGroup2ParameterName[componentId][fact->group()] += name;
+    foreach (int componentId, _components.keys()) {
+        const ComponentParameters& component = _components[componentId];
+        foreach (const QString &name, parameterNames(componentId)) {
+            _mapGroup2ParameterName[componentId][component.fact(name)->group()] += name;
         }
     }
 }
 
+void ParameterManager::ComponentParameters::addFact(Fact* fact, int paramIndex)
+{
+    int factIndex = facts.count();
+
+    facts.append(fact);
+    nameToFactIndex[fact->name()] = factIndex;
+    if (paramIndex >= 0 && paramIndex < paramIndexToFactIndex.count()) {
+        paramIndexToFactIndex[paramIndex] = factIndex;
+    }
+}
+
+void ParameterManager::ComponentParameters::setAllIndicesWaiting(void)
+{
+    waitingReadIndex.fill(true, paramCount);
+    waitingReadIndexRetry.fill(0, paramCount);
+    waitingReadIndexCount = paramCount;
+}
+
+void ParameterManager::_waitingParamCounts(int& waitingReadParamIndexCount, int& waitingReadParamNameCount, int& waitingWriteParamNameCount) const
+{
+    waitingReadParamIndexCount = 0;
+    waitingReadParamNameCount = 0;
+    waitingWriteParamNameCount = 0;
+
+    for (QMap<int, ComponentParameters>::const_iterator iter=_components.constBegin(); iter!=_components.constEnd(); iter++) {
+        waitingReadParamIndexCount += iter->waitingReadIndexCount;
+        waitingReadParamNameCount += iter->waitingReadName.count();
+        waitingWriteParamNameCount += iter->waitingWriteName.count();
+    }
+}
+
 const QMap<int, QMap<QString, QStringList> >& ParameterManager::getGroupMap(void)
 {
     return _mapGroup2ParameterName;
@@ -548,13 +595,19 @@ bool ParameterManager::_fillIndexBatchQueue(bool waitingParamTimeout)
         qCDebug(ParameterManagerLog) << "Refilling index based batch queue due to received parameter";
     }
 
-    foreach(int componentId, _waitingReadParamIndexMap.keys()) {
-        if (_waitingReadParamIndexMap[componentId].count()) {
-            qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "_waitingReadParamIndexMap count" << _waitingReadParamIndexMap[componentId].count();
-            qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix() << "_waitingReadParamIndexMap" << _waitingReadParamIndexMap[componentId];
+    foreach(int componentId, _components.keys()) {
+        ComponentParameters& component = _components[componentId];
+
+        if (component.waitingReadIndexCount == 0) {
+            continue;
         }
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "waitingReadIndexCount" << component.waitingReadIndexCount;
+
+        for (int paramIndex=0; paramIndex<component.paramCount; paramIndex++) {
+            if (!component.waitingReadIndex.testBit(paramIndex)) {
+                continue;
+            }
 
-        foreach(int paramIndex, _waitingReadParamIndexMap[componentId].keys()) {
             if (_indexBatchQueue.contains(paramIndex)) {
                 // Don't add more than once
                 continue;
@@ -564,17 +617,18 @@ bool ParameterManager::_fillIndexBatchQueue(bool waitingParamTimeout)
                 break;
             }
 
-            _waitingReadParamIndexMap[componentId][paramIndex]++;   // Bump retry count
-            if (_disableAllRetries || _waitingReadParamIndexMap[componentId][paramIndex] > _maxInitialLoadRetrySingleParam) {
+            int retryCount = ++component.waitingReadIndexRetry[paramIndex];   // Bump retry count
+            if (_disableAllRetries || retryCount > _maxInitialLoadRetrySingleParam) {
                 // Give up on this index
-                _failedReadParamIndexMap[componentId] << paramIndex;
-                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Giving up on (paramIndex:" << paramIndex << "retryCount:" << _waitingReadParamIndexMap[componentId][paramIndex] << ")";
-                _waitingReadParamIndexMap[componentId].remove(paramIndex);
+                component.failedReadIndex << paramIndex;
+                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Giving up on (paramIndex:" << paramIndex << "retryCount:" << retryCount << ")";
+                component.waitingReadIndex.clearBit(paramIndex);
+                component.waitingReadIndexCount--;
             } else {
                 // Retry again
                 _indexBatchQueue.append(paramIndex);
                 _readParameterRaw(componentId, "", paramIndex);
-                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Read re-request for (paramIndex:" << paramIndex << "retryCount:" << _waitingReadParamIndexMap[componentId][paramIndex] << ")";
+                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Read re-request for (paramIndex:" << paramIndex << "retryCount:" << retryCount << ")";
             }
         }
     }
@@ -596,10 +650,10 @@ void ParameterManager::_waitingParamTimeout(void)
     // First check for any missing parameters from the initial index based load
     paramsRequested = _fillIndexBatchQueue(true /* waitingParamTimeout */);
 
-    if (!paramsRequested && !_waitingForDefaultComponent && !_mapParameterName2Variant.contains(_vehicle->defaultComponentId())) {
+    if (!paramsRequested && !_waitingForDefaultComponent && !_components.contains(_vehicle->defaultComponentId())) {
         // Initial load is complete but we still don't have any default component params. Wait one more cycle to see if the
         // any show up.
-        qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "Restarting _waitingParamTimeoutTimer - still don't have default component params" << _vehicle->defaultComponentId() << _mapParameterName2Variant.keys();
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix() << "Restarting _waitingParamTimeoutTimer - still don't have default component params" << _vehicle->defaultComponentId() << _components.keys();
         _waitingParamTimeoutTimer.start();
         _waitingForDefaultComponent = true;
         return;
@@ -609,19 +663,20 @@ void ParameterManager::_waitingParamTimeout(void)
     _checkInitialLoadComplete();
 
     if (!paramsRequested) {
-        foreach(int componentId, _waitingWriteParamNameMap.keys()) {
-            foreach(const QString &paramName, _waitingWriteParamNameMap[componentId].keys()) {
+        foreach(int componentId, _components.keys()) {
+            QHash<QString, int>& waitingWriteName = _components[componentId].waitingWriteName;
+            foreach(const QString &paramName, waitingWriteName.keys()) {
                 paramsRequested = true;
-                _waitingWriteParamNameMap[componentId][paramName]++;   // Bump retry count
-                if (_waitingWriteParamNameMap[componentId][paramName] <= _maxReadWriteRetry) {
+                int retryCount = ++waitingWriteName[paramName];   // Bump retry count
+                if (retryCount <= _maxReadWriteRetry) {
                     _writeParameterRaw(componentId, paramName, getParameter(componentId, paramName)->rawValue());
-                    qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Write resend for (paramName:" << paramName << "retryCount:" << _waitingWriteParamNameMap[componentId][paramName] << ")";
+                    qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Write resend for (paramName:" << paramName << "retryCount:" << retryCount << ")";
                     if (++batchCount > maxBatchSize) {
                         goto Out;
                     }
                 } else {
                     // Exceeded max retry count, notify user
-                    _waitingWriteParamNameMap[componentId].remove(paramName);
+                    waitingWriteName.remove(paramName);
                     QString errorMsg = tr("Parameter write failed: veh:%1 comp:%2 param:%3").arg(_vehicle->id()).arg(componentId).arg(paramName);
                     qCDebug(ParameterManagerLog) << errorMsg;
                     qgcApp()->showMessage(errorMsg);
@@ -631,19 +686,20 @@ void ParameterManager::_waitingParamTimeout(void)
     }
 
     if (!paramsRequested) {
-        foreach(int componentId, _waitingReadParamNameMap.keys()) {
-            foreach(const QString &paramName, _waitingReadParamNameMap[componentId].keys()) {
+        foreach(int componentId, _components.keys()) {
+            QHash<QString, int>& waitingReadName = _components[componentId].waitingReadName;
+            foreach(const QString &paramName, waitingReadName.keys()) {
                 paramsRequested = true;
-                _waitingReadParamNameMap[componentId][paramName]++;   // Bump retry count
-                if (_waitingReadParamNameMap[componentId][paramName] <= _maxReadWriteRetry) {
+                int retryCount = ++waitingReadName[paramName];   // Bump retry count
+                if (retryCount <= _maxReadWriteRetry) {
                     _readParameterRaw(componentId, paramName, -1);
-                    qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Read re-request for (paramName:" << paramName << "retryCount:" << _waitingReadParamNameMap[componentId][paramName] << ")";
+                    qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Read re-request for (paramName:" << paramName << "retryCount:" << retryCount << ")";
                     if (++batchCount > maxBatchSize) {
                         goto Out;
                     }
                 } else {
                     // Exceeded max retry count, notify user
-                    _waitingReadParamNameMap[componentId].remove(paramName);
+                    waitingReadName.remove(paramName);
                     QString errorMsg = tr("Parameter read failed: veh:%1 comp:%2 param:%3").arg(_vehicle->id()).arg(componentId).arg(paramName);
                     qCDebug(ParameterManagerLog) << errorMsg;
                     qgcApp()->showMessage(errorMsg);
@@ -739,10 +795,13 @@ void ParameterManager::_writeLocalParamCache(int vehicleId, int componentId)
 {
     MapID2NamedParam cache_map;
 
-    foreach(int id, _mapParameterId2Name[componentId].keys()) {
-        const QString name(_mapParameterId2Name[componentId][id]);
-        const Fact *fact = _mapParameterName2Variant[componentId][name].value<Fact*>();
-        cache_map[id] = NamedParam(name, ParamTypeVal(fact->type(), fact->rawValue()));
+    const ComponentParameters& component = _components[componentId];
+    for (int id=0; id<component.paramIndexToFactIndex.count(); id++) {
+        int factIndex = component.paramIndexToFactIndex[id];
+        if (factIndex != -1) {
+            const Fact *fact = component.facts[factIndex];
+            cache_map[id] = NamedParam(fact->name(), ParamTypeVal(fact->type(), fact->rawValue()));
+        }
     }
 
     QFile cache_file(parameterCacheFile(vehicleId, componentId));
@@ -763,9 +822,45 @@ QString ParameterManager::parameterCacheFile(int vehicleId, int componentId)
     return parameterCacheDir().filePath(QString("%1_%2").arg(vehicleId).arg(componentId));
 }
 
-void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVariant hash_value)
+/// Computes the _HASH_CHECK value of the cached parameters within an index range
+uint32_t ParameterManager::_cacheCrc32(const MapID2NamedParam& cacheMap, int startIndex, int count)
 {
     uint32_t crc32_value = 0;
+
+    for (MapID2NamedParam::const_iterator iter=cacheMap.lowerBound(startIndex); iter!=cacheMap.constEnd() && iter.key() - startIndex < count; iter++) {
+        const QString& name = iter->first;
+        const void *vdat = iter->second.second.constData();
+        const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(iter->second.first);
+        crc32_value = QGC::crc32((const uint8_t *)qPrintable(name), name.length(),  crc32_value);
+        crc32_value = QGC::crc32((const uint8_t *)vdat, FactMetaData::typeToSize(fact_type), crc32_value);
+    }
+
+    return crc32_value;
+}
+
+/// Sends the hash back to the vehicle, which stops the parameter stream if it matches the vehicle hash
+void ParameterManager::_sendHashCheck(int componentId, uint32_t hash)
+{
+    mavlink_param_set_t     p;
+    mavlink_param_union_t   union_value;
+    memset(&p, 0, sizeof(p));
+    p.param_type = MAV_PARAM_TYPE_UINT32;
+    strncpy(p.param_id, "_HASH_CHECK", sizeof(p.param_id));
+    union_value.param_uint32 = hash;
+    p.param_value = union_value.param_float;
+    p.target_system = (uint8_t)_vehicle->id();
+    p.target_component = (uint8_t)componentId;
+    mavlink_message_t msg;
+    mavlink_msg_param_set_encode_chan(_mavlink->getSystemId(),
+                                      _mavlink->getComponentId(),
+                                      _vehicle->priorityLink()->mavlinkChannel(),
+                                      &msg,
+                                      &p);
+    _vehicle->sendMessageOnLink(_vehicle->priorityLink(), msg);
+}
+
+void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, int parameterCount, QVariant hash_value)
+{
     /* The datastructure of the cache table */
     MapID2NamedParam cache_map;
     QFile cache_file(parameterCacheFile(vehicleId, componentId));
@@ -780,14 +875,7 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVarian
     ds >> cache_map;
 
     /* compute the crc of the local cache to check against the remote */
-
-    foreach(int id, cache_map.keys()) {
-        const QString name(cache_map[id].first);
-        const void *vdat = cache_map[id].second.second.constData();
-        const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(cache_map[id].second.first);
-        crc32_value = QGC::crc32((const uint8_t *)qPrintable(name), name.length(),  crc32_value);
-        crc32_value = QGC::crc32((const uint8_t *)vdat, FactMetaData::typeToSize(fact_type), crc32_value);
-    }
+    uint32_t crc32_value = _cacheCrc32(cache_map, 0, cache_map.count() ? cache_map.lastKey() + 1 : 0);
 
     if (crc32_value == hash_value.toUInt()) {
         qCInfo(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(QFileInfo(cache_file).absoluteFilePath());
@@ -801,22 +889,7 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVarian
             _parameterUpdate(vehicleId, componentId, name, count, id, mavType, value);
         }
         // Return the hash value to notify we don't want any more updates
-        mavlink_param_set_t     p;
-        mavlink_param_union_t   union_value;
-        memset(&p, 0, sizeof(p));
-        p.param_type = MAV_PARAM_TYPE_UINT32;
-        strncpy(p.param_id, "_HASH_CHECK", sizeof(p.param_id));
-        union_value.param_uint32 = crc32_value;
-        p.param_value = union_value.param_float;
-        p.target_system = (uint8_t)_vehicle->id();
-        p.target_component = (uint8_t)componentId;
-        mavlink_message_t msg;
-        mavlink_msg_param_set_encode_chan(_mavlink->getSystemId(),
-                                          _mavlink->getComponentId(),
-                                          _vehicle->priorityLink()->mavlinkChannel(),
-                                          &msg,
-                                          &p);
-        _vehicle->sendMessageOnLink(_vehicle->priorityLink(), msg);
+        _sendHashCheck(componentId, crc32_value);
 
         // Give the user some feedback things loaded properly
         QVariantAnimation *ani = new QVariantAnimation(this);
@@ -837,7 +910,129 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVarian
         });
 
         ani->start(QAbstractAnimation::DeleteWhenStopped);
+    } else if (_cacheSyncSupported && _cacheSyncComponentId == -1 && cache_map.count() == parameterCount && parameterCount > _cacheSyncLeafRangeSize) {
+        // Same parameter set layout with some changed values. Stop the stream and find the differences by bisecting
+        // the index range with range hashes, so only the changed parameters need to be read.
+        qCInfo(ParameterManagerLog) << "Parameter cache out of date, syncing changes" << qPrintable(QFileInfo(cache_file).absoluteFilePath());
+
+        _cacheSyncComponentId = componentId;
+        _cacheSyncVehicleId = vehicleId;
+        _cacheSyncMap = cache_map;
+        _cacheSyncPendingRanges.clear();
+        _cacheSyncDivergedIndices.clear();
+
+        _sendHashCheck(componentId, hash_value.toUInt());
+        _cacheSyncSplitRange(0, parameterCount);
+        _cacheSyncTimeoutTimer.start();
+    }
+}
+
+void ParameterManager::_cacheSyncRequestRange(int startIndex, int count)
+{
+    QString rangeName = QStringLiteral("%1%2:%3").arg(_rangeHashParamPrefix).arg(startIndex).arg(count);
+
+    _cacheSyncPendingRanges[rangeName] = 0;
+    _readParameterRaw(_cacheSyncComponentId, rangeName, -1);
+}
+
+/// Called for a range whose hash does not match the cache
+void ParameterManager::_cacheSyncSplitRange(int startIndex, int count)
+{
+    if (count <= _cacheSyncLeafRangeSize) {
+        for (int index=startIndex; index<startIndex + count; index++) {
+            _cacheSyncDivergedIndices.append(index);
+        }
+    } else {
+        int firstHalf = count / 2;
+        _cacheSyncRequestRange(startIndex, firstHalf);
+        _cacheSyncRequestRange(startIndex + firstHalf, count - firstHalf);
+    }
+}
+
+void ParameterManager::_cacheSyncRangeHash(int componentId, const QString& rangeName, uint32_t hash)
+{
+    if (!_cacheSyncPendingRanges.remove(rangeName)) {
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Unrequested range hash" << rangeName;
+        return;
+    }
+
+    QStringList range = rangeName.mid(strlen(_rangeHashParamPrefix)).split(':');
+    if (range.count() == 2) {
+        int startIndex = range[0].toInt();
+        int count = range[1].toInt();
+        if (_cacheCrc32(_cacheSyncMap, startIndex, count) != hash) {
+            qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Range hash mismatch" << rangeName;
+            _cacheSyncSplitRange(startIndex, count);
+        }
+    }
+
+    if (_cacheSyncPendingRanges.isEmpty()) {
+        _cacheSyncFinish();
+    } else {
+        _cacheSyncTimeoutTimer.start();
+    }
+}
+
+/// Loads the unchanged parameters from the cache and requests the changed ones from the vehicle. The normal index
+/// wait and retry logic takes over from here, and the cache is rewritten once all reads complete.
+void ParameterManager::_cacheSyncFinish(void)
+{
+    _cacheSyncTimeoutTimer.stop();
+
+    int componentId = _cacheSyncComponentId;
+    MapID2NamedParam cacheMap = _cacheSyncMap;
+    QList<int> divergedIndexList = _cacheSyncDivergedIndices;
+    QSet<int> divergedIndices = divergedIndexList.toSet();
+    _cacheSyncComponentId = -1;
+    _cacheSyncMap.clear();
+    _cacheSyncDivergedIndices.clear();
+
+    qCInfo(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Parameter cache synced, requesting" << divergedIndices.count() << "of" << cacheMap.count() << "parameters";
+
+    int count = cacheMap.count();
+    for (MapID2NamedParam::const_iterator iter=cacheMap.constBegin(); iter!=cacheMap.constEnd(); iter++) {
+        if (!divergedIndices.contains(iter.key())) {
+            const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(iter->second.first);
+            _parameterUpdate(_cacheSyncVehicleId, componentId, iter->first, count, iter.key(), _factTypeToMavType(fact_type), iter->second.second);
+        }
+    }
+
+    foreach (int index, divergedIndexList) {
+        _readParameterRaw(componentId, QString(), index);
+    }
+}
+
+/// Called when range hash requests were not answered. The unanswered requests are retried a few times before falling
+/// back to a full parameter download. Range hashes are not used again for this vehicle connection after that.
+void ParameterManager::_cacheSyncTimeout(void)
+{
+    bool retry = true;
+    foreach (int retryCount, _cacheSyncPendingRanges) {
+        if (retryCount >= _cacheSyncMaxRetry) {
+            retry = false;
+            break;
+        }
     }
+    if (retry) {
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(_cacheSyncComponentId) << "Retrying range hash requests" << _cacheSyncPendingRanges.keys();
+        for (QHash<QString, int>::iterator iter=_cacheSyncPendingRanges.begin(); iter!=_cacheSyncPendingRanges.end(); iter++) {
+            iter.value()++;
+            _readParameterRaw(_cacheSyncComponentId, iter.key(), -1);
+        }
+        _cacheSyncTimeoutTimer.start();
+        return;
+    }
+
+    qCWarning(ParameterManagerLog) << _logVehiclePrefix(_cacheSyncComponentId) << "Range hash requests not answered, falling back to full parameter download";
+
+    _cacheSyncSupported = false;
+    _cacheSyncFailed = true;
+    _cacheSyncComponentId = -1;
+    _cacheSyncMap.clear();
+    _cacheSyncPendingRanges.clear();
+    _cacheSyncDivergedIndices.clear();
+
+    refreshAllParameters();
 }
 
 void ParameterManager::_saveToEEPROM(void)
@@ -919,9 +1114,9 @@ void ParameterManager::writeParametersToStream(QTextStream &stream)
     stream << "#\n";
     stream << "# Vehicle-Id Component-Id Name Value Type\n";
 
-    foreach (int componentId, _mapParameterName2Variant.keys()) {
-        foreach (const QString &paramName, _mapParameterName2Variant[componentId].keys()) {
-            Fact* fact = _mapParameterName2Variant[componentId][paramName].value<Fact*>();
+    foreach (int componentId, _components.keys()) {
+        foreach (const QString &paramName, parameterNames(componentId)) {
+            Fact* fact = _findParameter(componentId, paramName);
             if (fact) {
                 stream << _vehicle->id() << "\t" << componentId << "\t" << paramName << "\t" << fact->rawValueStringFullPrecision() << "\t" << QString("%1").arg(_factTypeToMavType(fact->type())) << "\n";
             } else {
@@ -1009,9 +1204,10 @@ void ParameterManager::_addMetaDataToDefaultComponent(void)
      _parameterMetaData = _vehicle->firmwarePlugin()->loadParameterMetaData(metaDataFile);
 
     // Loop over all parameters in default component adding meta data
-    QVariantMap& factMap = _mapParameterName2Variant[_vehicle->defaultComponentId()];
-    foreach (const QString& key, factMap.keys()) {
-        _vehicle->firmwarePlugin()->addMetaDataToFact(_parameterMetaData, factMap[key].value<Fact*>(), _vehicle->vehicleType());
+    if (_components.contains(_vehicle->defaultComponentId())) {
+        foreach (Fact* fact, _components[_vehicle->defaultComponentId()].facts) {
+            _vehicle->firmwarePlugin()->addMetaDataToFact(_parameterMetaData, fact, _vehicle->vehicleType());
+        }
     }
 }
 
@@ -1022,14 +1218,14 @@ void ParameterManager::_checkInitialLoadComplete(void)
         return;
     }
 
-    foreach (int componentId, _waitingReadParamIndexMap.keys()) {
-        if (_waitingReadParamIndexMap[componentId].count()) {
-            // We are still waiting on some parameters, not done yet
-            return;
-        }
+    int waitingReadParamIndexCount, waitingReadParamNameCount, waitingWriteParamNameCount;
+    _waitingParamCounts(waitingReadParamIndexCount, waitingReadParamNameCount, waitingWriteParamNameCount);
+    if (waitingReadParamIndexCount) {
+        // We are still waiting on some parameters, not done yet
+        return;
     }
 
-    if (!_mapParameterName2Variant.contains(_vehicle->defaultComponentId())) {
+    if (!_components.contains(_vehicle->defaultComponentId())) {
         // No default component params yet, not done yet
         return;
     }
@@ -1042,8 +1238,8 @@ void ParameterManager::_checkInitialLoadComplete(void)
     // Check for index based load failures
     QString indexList;
     bool initialLoadFailures = false;
-    foreach (int componentId, _failedReadParamIndexMap.keys()) {
-        foreach (int paramIndex, _failedReadParamIndexMap[componentId]) {
+    foreach (int componentId, _components.keys()) {
+        foreach (int paramIndex, _components[componentId].failedReadIndex) {
             if (initialLoadFailures) {
                 indexList += ", ";
             }
@@ -1343,7 +1539,7 @@ void ParameterManager::_loadOfflineEditingParams(void)
         }
 
         Fact* fact = new Fact(defaultComponentId, paramName, _mavTypeToFactType(paramType), this);
-        _mapParameterName2Variant[defaultComponentId][paramName] = QVariant::fromValue(fact);
+        _components[defaultComponentId].addFact(fact, -1);
     }
 
     _addMetaDataToDefaultComponent();
@@ -1358,7 +1554,7 @@ void ParameterManager::saveToJson(int componentId, const QStringList& paramsToSa
     QStringList rgParamNames;
 
     if (componentId == MAV_COMP_ID_ALL) {
-        rgCompIds = _mapParameterName2Variant.keys();
+        rgCompIds = _components.keys();
     } else {
         rgCompIds.append(_actualComponentId(componentId));
     }
@@ -1369,7 +1565,7 @@ void ParameterManager::saveToJson(int componentId, const QStringList& paramsToSa
     for (int i=0; i<rgCompIds.count(); i++) {
         int compId = rgCompIds[i];
 
-        if (!_mapParameterName2Variant.contains(compId)) {
+        if (!_components.contains(compId)) {
             qCDebug(ParameterManagerLog) << "ParameterManager::saveToJson no params for compId" << compId;
             continue;
         }
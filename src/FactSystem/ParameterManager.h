@@ -13,6 +13,10 @@
 
 #include <QObject>
 #include <QMap>
+#include <QHash>
+#include <QVector>
+#include <QBitArray>
+#include <QSet>
 #include <QXmlStreamReader>
 #include <QLoggingCategory>
 #include <QMutex>
@@ -133,15 +137,27 @@ protected:
     void _waitingParamTimeout(void);
     void _tryCacheLookup(void);
     void _initialRequestTimeout(void);
+    void _cacheSyncTimeout(void);
 
 private:
+    /* types for local parameter cache */
+    typedef QPair<int, QVariant> ParamTypeVal;
+    typedef QPair<QString, ParamTypeVal> NamedParam;
+    typedef QMap<int, NamedParam> MapID2NamedParam;
+
     static QVariant _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool failOk = false);
     int _actualComponentId(int componentId);
     void _setupGroupMap(void);
     void _readParameterRaw(int componentId, const QString& paramName, int paramIndex);
     void _writeParameterRaw(int componentId, const QString& paramName, const QVariant& value);
     void _writeLocalParamCache(int vehicleId, int componentId);
-    void _tryCacheHashLoad(int vehicleId, int componentId, QVariant hash_value);
+    void _tryCacheHashLoad(int vehicleId, int componentId, int parameterCount, QVariant hash_value);
+    void _sendHashCheck(int componentId, uint32_t hash);
+    void _cacheSyncRequestRange(int startIndex, int count);
+    void _cacheSyncSplitRange(int startIndex, int count);
+    void _cacheSyncRangeHash(int componentId, const QString& rangeName, uint32_t hash);
+    void _cacheSyncFinish(void);
+    static uint32_t _cacheCrc32(const MapID2NamedParam& cacheMap, int startIndex, int count);
     void _addMetaDataToDefaultComponent(void);
     QString _remapParamNameToVersion(const QString& paramName);
     void _loadOfflineEditingParams(void);
@@ -153,13 +169,41 @@ private:
     FactMetaData::ValueType_t _mavTypeToFactType(MAV_PARAM_TYPE mavType);
     void _saveToEEPROM(void);
     void _checkInitialLoadComplete(void);
+    Fact* _findParameter(int componentId, const QString& name) const;
+    void _waitingParamCounts(int& waitingReadParamIndexCount, int& waitingReadParamNameCount, int& waitingWriteParamNameCount) const;
+
+    /// Parameters and load bookkeeping for a single component.
+    ///
+    /// Facts are held in a flat array in the order they were first seen. Parameter names and vehicle parameter
+    /// indices map into that array so name lookup and PARAM_VALUE handling are O(1). The name hash keys share their
+    /// string data with the Fact names, so each name is only stored once.
+    struct ComponentParameters {
+        ComponentParameters(void) : paramCount(0), waitingReadIndexCount(0) { }
+
+        /// @return Fact for the specified name, NULL if not found
+        Fact* fact(const QString& name) const { int factIndex = nameToFactIndex.value(name, -1); return factIndex == -1 ? NULL : facts[factIndex]; }
+
+        /// Adds a new Fact which was received as the specified vehicle parameter index (-1 if unknown)
+        void addFact(Fact* fact, int paramIndex);
+
+        /// Marks all parameter indices as waiting for the initial read
+        void setAllIndicesWaiting(void);
+
+        QVector<Fact*>          facts;
+        QHash<QString, int>     nameToFactIndex;        ///< Parameter name to index in facts
+        QVector<int>            paramIndexToFactIndex;  ///< Vehicle parameter index to index in facts, -1 if not received yet
+        int                     paramCount;             ///< Parameter count reported by the vehicle
+        QBitArray               waitingReadIndex;       ///< Set for each parameter index still waiting for the initial read
+        QVector<quint8>         waitingReadIndexRetry;  ///< Retry count for each parameter index
+        int                     waitingReadIndexCount;  ///< Number of bits set in waitingReadIndex
+        QHash<QString, int>     waitingReadName;        ///< Key: parameter name still waiting for, Value: retry count
+        QHash<QString, int>     waitingWriteName;       ///< Key: parameter name still waiting for, Value: retry count
+        QList<int>              failedReadIndex;        ///< Parameter indices which could not be loaded
+    };
+
+    /// Key: Component id. There are only ever a handful of components, ordered iteration keeps saved files stable.
+    QMap<int, ComponentParameters> _components;
 
-    /// First mapping is by component id
-    /// Second mapping is parameter name, to Fact* in QVariant
-    QMap<int, QVariantMap>            _mapParameterName2Variant;
-
-    QMap<int, QMap<int, QString> >    _mapParameterId2Name;
-    
     /// First mapping is by component id
     /// Second mapping is group name, to Fact
     QMap<int, QMap<QString, QStringList> > _mapGroup2ParameterName;
@@ -189,13 +233,21 @@ private:
     bool        _indexBatchQueueActive; ///< true: we are actively batching re-requests for missing index base params, false: index based re-request has not yet started
     QList<int>  _indexBatchQueue;       ///< The current queue of index re-requests
 
-    QMap<int, int>                  _paramCountMap;             ///< Key: Component id, Value: count of parameters in this component
-    QMap<int, QMap<int, int> >      _waitingReadParamIndexMap;  ///< Key: Component id, Value: Map { Key: parameter index still waiting for, Value: retry count }
-    QMap<int, QMap<QString, int> >  _waitingReadParamNameMap;   ///< Key: Component id, Value: Map { Key: parameter name still waiting for, Value: retry count }
-    QMap<int, QMap<QString, int> >  _waitingWriteParamNameMap;  ///< Key: Component id, Value: Map { Key: parameter name still waiting for, Value: retry count }
-    QMap<int, QList<int> >          _failedReadParamIndexMap;   ///< Key: Component id, Value: failed parameter index
-
     int _totalParamCount;   ///< Number of parameters across all components
+
+    // Incremental cache sync. When the vehicle hash does not match the cache, range hashes are bisected to find the
+    // parameters which changed and only those are requested from the vehicle.
+    bool                _cacheSyncSupported;        ///< true: vehicle advertised range hashes and has not failed to answer them
+    bool                _cacheSyncFailed;           ///< true: a sync failed on this connection, range hash support is no longer believed
+    int                 _cacheSyncComponentId;      ///< Component being synced, -1 for no sync in progress
+    int                 _cacheSyncVehicleId;
+    MapID2NamedParam    _cacheSyncMap;              ///< Cached parameters for the component being synced
+    QHash<QString, int> _cacheSyncPendingRanges;    ///< Range hash requests which have not been answered yet, with their retry count
+    QList<int>          _cacheSyncDivergedIndices;  ///< Parameter indices which must be read from the vehicle
+    QTimer              _cacheSyncTimeoutTimer;
+
+    static const int    _cacheSyncLeafRangeSize = 8;    ///< Ranges this small are read from the vehicle instead of split further
+    static const int    _cacheSyncMaxRetry = 2;         ///< Retries of a range hash request before falling back to a full download
     
     QTimer _initialRequestTimeoutTimer;
     QTimer _waitingParamTimeoutTimer;
@@ -209,6 +261,8 @@ private:
     static const char* _jsonCompIdKey;
     static const char* _jsonParamNameKey;
     static const char* _jsonParamValueKey;
+    static const char* _rangeHashParamPrefix;   ///< PARAM_REQUEST_READ of "_HR:<start>:<count>" returns the hash of that index range
+    static const char* _rangeHashSupportParamName;  ///< Sent by vehicles which answer range hash requests, ahead of _HASH_CHECK
 };
 
 #endif
@@ -13,6 +13,11 @@
 #include "QGCApplication.h"
 #include "ParameterManager.h"
 
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <climits>
+
 /// Test failure modes which should still lead to param load success
 void ParameterManagerTest::_noFailureWorker(MockConfiguration::FailureMode_t failureMode)
 {
@@ -138,3 +143,122 @@ void ParameterManagerTest::_requestListMissingParamFail(void)
     // User should have been notified
     checkExpectedMessageBox();
 }
+
+/// Times a full ArduPilot parameter download followed by the name lookups a setup page does
+void ParameterManagerTest::_downloadLookup_benchmark(void)
+{
+    UT_OPT_IN(optInBenchmarks);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    Q_ASSERT(!_mockLink);
+    _mockLink = MockLink::startAPMArduCopterMockLink(false);
+
+    MultiVehicleManager* vehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+    QVERIFY(vehicleMgr);
+
+    QSignalSpy spyParamsReady(vehicleMgr, SIGNAL(parameterReadyVehicleAvailableChanged(bool)));
+    QCOMPARE(spyParamsReady.wait(60000), true);
+    qint64 downloadMSecs = timer.elapsed();
+
+    ParameterManager* paramMgr = vehicleMgr->activeVehicle()->parameterManager();
+    QStringList names = paramMgr->parameterNames(FactSystem::defaultComponentId);
+    QVERIFY(names.count() > 100);
+
+    const int cPasses = 100;
+    int found = 0;
+    timer.start();
+    for (int i=0; i<cPasses; i++) {
+        foreach (const QString& name, names) {
+            if (paramMgr->parameterExists(FactSystem::defaultComponentId, name) && paramMgr->getParameter(FactSystem::defaultComponentId, name)->name() == name) {
+                found++;
+            }
+        }
+    }
+    qint64 lookupMSecs = timer.elapsed();
+    QCOMPARE(found, cPasses * names.count());
+
+    qDebug() << "Parameter download:" << names.count() << "params" << downloadMSecs << "msecs,"
+             << cPasses * names.count() << "lookups" << lookupMSecs << "msecs";
+}
+
+static const char*   _cacheSyncChangedParam = "MC_YAWRAUTO_MAX";
+static const float  _cacheSyncChangedValue = 60.0f;
+
+/// Connects once to write the parameter cache, then reconnects to a vehicle which has one changed parameter and waits
+/// for the parameters to be ready.
+void ParameterManagerTest::_cacheSyncWorker(bool rangeHashSupported, int rangeHashDropCount, int& paramCount)
+{
+    const int componentId = MAV_COMP_ID_AUTOPILOT1;
+
+    // Full download which writes the cache
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    int firstVehicleId = _mockLink->vehicleId();
+    paramCount = _vehicle->parameterManager()->parameterNames(componentId).count();
+    QVERIFY(paramCount > 100);
+    QVERIFY(_vehicle->parameterManager()->getParameter(componentId, _cacheSyncChangedParam)->rawValue().toFloat() != _cacheSyncChangedValue);
+    _disconnectMockLink();
+
+    MultiVehicleManager* vehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+    QSignalSpy spyParamsReady(vehicleMgr, SIGNAL(parameterReadyVehicleAvailableChanged(bool)));
+
+    // Every MockLink has a new vehicle id, so hand it the cache of the first one before the vehicle shows up
+    _mockLink = MockLink::startPX4MockLink(false);
+    _mockLink->setRangeHashSupported(rangeHashSupported);
+    _mockLink->setRangeHashDropCount(rangeHashDropCount);
+    QVERIFY(QFile::copy(ParameterManager::parameterCacheFile(firstVehicleId, componentId), ParameterManager::parameterCacheFile(_mockLink->vehicleId(), componentId)));
+    _mockLink->setParamValue(componentId, _cacheSyncChangedParam, _cacheSyncChangedValue);
+
+    QCOMPARE(spyParamsReady.wait(20000), true);
+
+    ParameterManager* paramMgr = vehicleMgr->activeVehicle()->parameterManager();
+    QCOMPARE(paramMgr->missingParameters(), false);
+    QCOMPARE(paramMgr->parameterNames(componentId).count(), paramCount);
+    QCOMPARE(paramMgr->getParameter(componentId, _cacheSyncChangedParam)->rawValue().toFloat(), _cacheSyncChangedValue);
+    foreach (const QString& name, paramMgr->parameterNames(componentId)) {
+        QVERIFY(!name.startsWith(QStringLiteral("_HR:")));
+    }
+}
+
+/// Reconnects to a vehicle which has one changed parameter. Only the changed range should be read from the vehicle,
+/// everything else comes from the cache written by the first connection.
+void ParameterManagerTest::_cacheSync(void)
+{
+    int paramCount;
+    _cacheSyncWorker(true, 0, paramCount);
+    QVERIFY(_mockLink->rangeHashRequestCount() > 0);
+    QVERIFY(_mockLink->paramValueSentCount() < paramCount / 4);
+}
+
+/// A vehicle which does not advertise range hashes, like stock PX4, gets a plain full download for an out of date
+/// cache without any range hash requests.
+void ParameterManagerTest::_cacheSyncNotAdvertised(void)
+{
+    int paramCount;
+    _cacheSyncWorker(false, 0, paramCount);
+    QCOMPARE(_mockLink->rangeHashRequestCount(), 0);
+}
+
+/// Lost range hash answers are requested again instead of giving up on the sync
+void ParameterManagerTest::_cacheSyncRetry(void)
+{
+    int paramCount;
+    _cacheSyncWorker(true, 1, paramCount);
+    QVERIFY(_mockLink->paramValueSentCount() < paramCount / 4);
+}
+
+/// A vehicle which advertises range hashes but never answers them gets a single full download. The advertisement
+/// sent with that download must not start another sync.
+void ParameterManagerTest::_cacheSyncNotAnswered(void)
+{
+    int paramCount;
+    _cacheSyncWorker(true, INT_MAX, paramCount);
+    QVERIFY(_mockLink->paramValueSentCount() >= paramCount);
+
+    int rangeHashRequestCount = _mockLink->rangeHashRequestCount();
+    int paramValueSentCount = _mockLink->paramValueSentCount();
+    QTest::qWait(5000);
+    QCOMPARE(_mockLink->rangeHashRequestCount(), rangeHashRequestCount);
+    QCOMPARE(_mockLink->paramValueSentCount(), paramValueSentCount);
+}
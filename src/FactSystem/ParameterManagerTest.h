@@ -25,9 +25,15 @@ private slots:
     void _requestListNoResponse(void);
     void _requestListMissingParamSuccess(void);
     void _requestListMissingParamFail(void);
+    void _downloadLookup_benchmark(void);
+    void _cacheSync(void);
+    void _cacheSyncNotAdvertised(void);
+    void _cacheSyncRetry(void);
+    void _cacheSyncNotAnswered(void);
 
 private:
     void _noFailureWorker(MockConfiguration::FailureMode_t failureMode);
+    void _cacheSyncWorker(bool rangeHashSupported, int rangeHashDropCount, int& paramCount);
 };
 
 #endif
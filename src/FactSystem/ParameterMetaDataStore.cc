@@ -0,0 +1,358 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterMetaDataStore.h"
+#include "QGCLoggingCategory.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QHash>
+#include <QMutex>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QWeakPointer>
+
+#include <algorithm>
+
+QGC_LOGGING_CATEGORY(ParameterMetaDataStoreLog, "ParameterMetaDataStoreLog")
+
+const char* ParameterMetaDataStore::compiledFileExtension = "qgcpmd";
+
+static QMutex                                               _storesMutex;
+static QHash<QString, QWeakPointer<ParameterMetaDataStore> > _stores;
+static QString                                              _cacheDirectory;
+static int                                                  _compileCount = 0;
+
+ParameterMetaDataStore::ParameterMetaDataStore(void)
+    : _data     (NULL)
+    , _header   (NULL)
+    , _records  (NULL)
+    , _pairs    (NULL)
+    , _strings  (NULL)
+{
+
+}
+
+ParameterMetaDataStore::~ParameterMetaDataStore()
+{
+    if (_data && _buffer.isEmpty()) {
+        _file.unmap(const_cast<uchar*>(_data));
+    }
+}
+
+void ParameterMetaDataStore::setCacheDirectory(const QString& cacheDirectory)
+{
+    QMutexLocker locker(&_storesMutex);
+    _cacheDirectory = cacheDirectory;
+}
+
+QString ParameterMetaDataStore::cacheDirectory(void)
+{
+    QMutexLocker locker(&_storesMutex);
+    if (_cacheDirectory.isEmpty()) {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/ParameterMetaData");
+    }
+    return _cacheDirectory;
+}
+
+int ParameterMetaDataStore::compileCount(void)
+{
+    QMutexLocker locker(&_storesMutex);
+    return _compileCount;
+}
+
+QSharedPointer<ParameterMetaDataStore> ParameterMetaDataStore::load(const QString& metaDataFile, const QString& formatTag, Parser parser)
+{
+    // The compiled file is keyed on the content of the meta data file, so updated meta data is picked up automatically
+    QFile file(metaDataFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(ParameterMetaDataStoreLog) << "Unable to open meta data file" << metaDataFile << file.errorString();
+        return QSharedPointer<ParameterMetaDataStore>();
+    }
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(&file);
+    file.close();
+
+    QString compiledFile = QDir(cacheDirectory()).filePath(QStringLiteral("%1-v%2-%3.%4").arg(formatTag).arg(_version).arg(QString(hash.result().toHex())).arg(compiledFileExtension));
+
+    QMutexLocker locker(&_storesMutex);
+
+    QSharedPointer<ParameterMetaDataStore> store = _stores.value(compiledFile).toStrongRef();
+    if (store) {
+        qCDebug(ParameterMetaDataStoreLog) << "Sharing loaded meta data" << compiledFile;
+        return store;
+    }
+
+    store = QSharedPointer<ParameterMetaDataStore>(new ParameterMetaDataStore());
+    if (!store->_open(compiledFile)) {
+        QList<ParameterMetaDataRecord> records;
+        if (!parser(metaDataFile, records)) {
+            return QSharedPointer<ParameterMetaDataStore>();
+        }
+        _compileCount++;
+
+        QString errorString;
+        QDir().mkpath(QFileInfo(compiledFile).absolutePath());
+        if (!compile(records, compiledFile, errorString) || !store->_open(compiledFile)) {
+            // Unable to use the cache, keep the compiled data in memory for this session
+            qCWarning(ParameterMetaDataStoreLog) << "Unable to write compiled meta data" << compiledFile << errorString;
+            store->_buffer = _build(records);
+            if (!store->_setData(reinterpret_cast<const uchar*>(store->_buffer.constData()), store->_buffer.size())) {
+                return QSharedPointer<ParameterMetaDataStore>();
+            }
+        }
+    }
+
+    qCDebug(ParameterMetaDataStoreLog) << "Loaded meta data" << metaDataFile << "records:" << store->count();
+    _stores[compiledFile] = store;
+    return store;
+}
+
+bool ParameterMetaDataStore::_open(const QString& compiledFile)
+{
+    _file.setFileName(compiledFile);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const uchar* data = _file.map(0, _file.size());
+    if (!data) {
+        _file.close();
+        return false;
+    }
+    if (!_setData(data, _file.size())) {
+        qCWarning(ParameterMetaDataStoreLog) << "Corrupt compiled meta data, recompiling" << compiledFile;
+        _file.unmap(const_cast<uchar*>(data));
+        _file.close();
+        return false;
+    }
+    return true;
+}
+
+bool ParameterMetaDataStore::_setData(const uchar* data, qint64 size)
+{
+    if (size < (qint64)sizeof(Header)) {
+        return false;
+    }
+    const Header* header = reinterpret_cast<const Header*>(data);
+    if (memcmp(header->magic, "QPMD", 4) != 0 || header->version != _version) {
+        return false;
+    }
+    qint64 expectedSize = sizeof(Header) + (qint64)header->recordCount * sizeof(PackedRecord) + (qint64)header->pairCount * sizeof(PackedPair) + header->stringTableSize;
+    if (size != expectedSize) {
+        return false;
+    }
+
+    _data = data;
+    _header = header;
+    _records = reinterpret_cast<const PackedRecord*>(data + sizeof(Header));
+    _pairs = reinterpret_cast<const PackedPair*>(_records + header->recordCount);
+    _strings = reinterpret_cast<const char*>(_pairs + header->pairCount);
+    return true;
+}
+
+QByteArray ParameterMetaDataStore::_build(const QList<ParameterMetaDataRecord>& inputRecords)
+{
+    // Sort by category and name so lookups can binary search
+    QList<ParameterMetaDataRecord> records = inputRecords;
+    std::stable_sort(records.begin(), records.end(), [](const ParameterMetaDataRecord& a, const ParameterMetaDataRecord& b) {
+        QByteArray categoryA = a.category.toUtf8();
+        QByteArray categoryB = b.category.toUtf8();
+        if (categoryA != categoryB) {
+            return categoryA < categoryB;
+        }
+        return a.name.toUtf8() < b.name.toUtf8();
+    });
+
+    QByteArray stringTable;
+    QHash<QString, quint32> stringOffsets;
+    auto addString = [&stringTable, &stringOffsets](const QString& string) -> quint32 {
+        QHash<QString, quint32>::const_iterator it = stringOffsets.constFind(string);
+        if (it != stringOffsets.constEnd()) {
+            return it.value();
+        }
+        QByteArray utf8 = string.toUtf8();
+        quint32 offset = stringTable.size();
+        quint32 length = utf8.size();
+        stringTable.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        stringTable.append(utf8);
+        stringOffsets[string] = offset;
+        return offset;
+    };
+    addString(QString());
+
+    QVector<PackedRecord> packedRecords;
+    QVector<PackedPair> packedPairs;
+    packedRecords.reserve(records.count());
+
+    foreach (const ParameterMetaDataRecord& record, records) {
+        PackedRecord packed;
+        memset(&packed, 0, sizeof(packed));
+        packed.strings[StringCategory] =            addString(record.category);
+        packed.strings[StringName] =                addString(record.name);
+        packed.strings[StringGroup] =               addString(record.group);
+        packed.strings[StringShortDescription] =    addString(record.shortDescription);
+        packed.strings[StringLongDescription] =     addString(record.longDescription);
+        packed.strings[StringUnits] =               addString(record.units);
+        packed.strings[StringMin] =                 addString(record.min);
+        packed.strings[StringMax] =                 addString(record.max);
+        packed.strings[StringIncrement] =           addString(record.increment);
+        packed.strings[StringDefaultValue] =        addString(record.defaultValue);
+        packed.type =           record.type;
+        packed.decimalPlaces =  qBound(-1, record.decimalPlaces, 127);
+        packed.flags =          (record.rebootRequired ? FlagRebootRequired : 0) | (record.boolean ? FlagBoolean : 0);
+
+        packed.valuesStart = packedPairs.count();
+        packed.valuesCount = qMin(record.values.count(), 0xFFFF);
+        for (int i=0; i<packed.valuesCount; i++) {
+            PackedPair pair;
+            pair.first = addString(record.values[i].first);
+            pair.second = addString(record.values[i].second);
+            packedPairs.append(pair);
+        }
+
+        packed.bitmaskStart = packedPairs.count();
+        packed.bitmaskCount = qMin(record.bitmask.count(), 0xFFFF);
+        for (int i=0; i<packed.bitmaskCount; i++) {
+            PackedPair pair;
+            pair.first = addString(record.bitmask[i].first);
+            pair.second = addString(record.bitmask[i].second);
+            packedPairs.append(pair);
+        }
+
+        packedRecords.append(packed);
+    }
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "QPMD", 4);
+    header.version =            _version;
+    header.recordCount =        packedRecords.count();
+    header.pairCount =          packedPairs.count();
+    header.stringTableSize =    stringTable.size();
+
+    QByteArray bytes;
+    bytes.reserve(sizeof(Header) + packedRecords.count() * sizeof(PackedRecord) + packedPairs.count() * sizeof(PackedPair) + stringTable.size());
+    bytes.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    bytes.append(reinterpret_cast<const char*>(packedRecords.constData()), packedRecords.count() * sizeof(PackedRecord));
+    bytes.append(reinterpret_cast<const char*>(packedPairs.constData()), packedPairs.count() * sizeof(PackedPair));
+    bytes.append(stringTable);
+    return bytes;
+}
+
+bool ParameterMetaDataStore::compile(const QList<ParameterMetaDataRecord>& records, const QString& compiledFile, QString& errorString)
+{
+    QSaveFile file(compiledFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        errorString = file.errorString();
+        return false;
+    }
+    file.write(_build(records));
+    if (!file.commit()) {
+        errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+QByteArray ParameterMetaDataStore::_rawString(quint32 offset) const
+{
+    if (offset + sizeof(quint32) > _header->stringTableSize) {
+        return QByteArray();
+    }
+    quint32 length;
+    memcpy(&length, _strings + offset, sizeof(length));
+    if (offset + sizeof(quint32) + length > _header->stringTableSize) {
+        return QByteArray();
+    }
+    // Raw data avoids a copy, the result is only used for comparison while the store is alive
+    return QByteArray::fromRawData(_strings + offset + sizeof(quint32), length);
+}
+
+QString ParameterMetaDataStore::_string(quint32 offset) const
+{
+    QByteArray utf8 = _rawString(offset);
+    return utf8.isEmpty() ? QString() : QString::fromUtf8(utf8);
+}
+
+int ParameterMetaDataStore::_compare(const PackedRecord& record, const QByteArray& category, const QByteArray& name) const
+{
+    QByteArray recordCategory = _rawString(record.strings[StringCategory]);
+    if (recordCategory != category) {
+        return recordCategory < category ? -1 : 1;
+    }
+    QByteArray recordName = _rawString(record.strings[StringName]);
+    if (recordName != name) {
+        return recordName < name ? -1 : 1;
+    }
+    return 0;
+}
+
+int ParameterMetaDataStore::find(const QString& category, const QString& name) const
+{
+    QByteArray utf8Category = category.toUtf8();
+    QByteArray utf8Name = name.toUtf8();
+
+    int low = 0;
+    int high = count() - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        int result = _compare(_records[mid], utf8Category, utf8Name);
+        if (result == 0) {
+            return mid;
+        } else if (result < 0) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return -1;
+}
+
+QString ParameterMetaDataStore::group(int index) const
+{
+    if (index < 0 || index >= count()) {
+        return QString();
+    }
+    return _string(_records[index].strings[StringGroup]);
+}
+
+ParameterMetaDataRecord ParameterMetaDataStore::record(int index) const
+{
+    ParameterMetaDataRecord record;
+    if (index < 0 || index >= count()) {
+        return record;
+    }
+
+    const PackedRecord& packed = _records[index];
+    record.category =           _string(packed.strings[StringCategory]);
+    record.name =               _string(packed.strings[StringName]);
+    record.group =              _string(packed.strings[StringGroup]);
+    record.shortDescription =   _string(packed.strings[StringShortDescription]);
+    record.longDescription =    _string(packed.strings[StringLongDescription]);
+    record.units =              _string(packed.strings[StringUnits]);
+    record.min =                _string(packed.strings[StringMin]);
+    record.max =                _string(packed.strings[StringMax]);
+    record.increment =          _string(packed.strings[StringIncrement]);
+    record.defaultValue =       _string(packed.strings[StringDefaultValue]);
+    record.type =               packed.type;
+    record.decimalPlaces =      packed.decimalPlaces;
+    record.rebootRequired =     packed.flags & FlagRebootRequired;
+    record.boolean =            packed.flags & FlagBoolean;
+
+    for (quint32 i=0; i<packed.valuesCount && packed.valuesStart + i < _header->pairCount; i++) {
+        const PackedPair& pair = _pairs[packed.valuesStart + i];
+        record.values.append(QPair<QString, QString>(_string(pair.first), _string(pair.second)));
+    }
+    for (quint32 i=0; i<packed.bitmaskCount && packed.bitmaskStart + i < _header->pairCount; i++) {
+        const PackedPair& pair = _pairs[packed.bitmaskStart + i];
+        record.bitmask.append(QPair<QString, QString>(_string(pair.first), _string(pair.second)));
+    }
+
+    return record;
+}
@@ -0,0 +1,164 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QList>
+#include <QPair>
+#include <QSharedPointer>
+#include <QString>
+#include <QLoggingCategory>
+
+#include <functional>
+
+Q_DECLARE_LOGGING_CATEGORY(ParameterMetaDataStoreLog)
+
+/// Parameter meta data in text form as read from a firmware meta data file. Firmware plugins build FactMetaData
+/// from this on demand.
+class ParameterMetaDataRecord
+{
+public:
+    ParameterMetaDataRecord(void)
+        : type          (-1)
+        , decimalPlaces (-1)
+        , rebootRequired(false)
+        , boolean       (false)
+    { }
+
+    QString category;           ///< Firmware specific grouping, for example the vehicle type for ArduPilot
+    QString name;
+    QString group;
+    QString shortDescription;
+    QString longDescription;
+    QString units;
+    QString min;
+    QString max;
+    QString increment;
+    QString defaultValue;
+    int     type;               ///< FactMetaData::ValueType_t from meta data, -1 if not specified
+    int     decimalPlaces;      ///< -1 if not specified
+    bool    rebootRequired;
+    bool    boolean;            ///< true: Enabled/Disabled enum values
+    QList<QPair<QString, QString> > values;     ///< value, description
+    QList<QPair<QString, QString> > bitmask;    ///< bit index, description
+};
+
+/// Compiled, memory mapped parameter meta data.
+///
+/// The first time a firmware meta data file is used it is parsed by the firmware plugin and compiled into a binary
+/// file in the cache directory: a packed record array sorted by category and name, followed by a value/description
+/// pair array and a deduplicated string table. Later loads map that file, so connecting a vehicle costs a hash of the
+/// meta data file and a binary search per parameter. Stores are shared between all vehicles using the same meta data.
+class ParameterMetaDataStore
+{
+public:
+    ~ParameterMetaDataStore();
+
+    /// Parses metaDataFile into records. Returns false on failure.
+    typedef std::function<bool(const QString& metaDataFile, QList<ParameterMetaDataRecord>& records)> Parser;
+
+    /// Returns the store for the specified meta data file, compiling it with parser if there is no up to date
+    /// compiled version in the cache.
+    ///     @param metaDataFile Firmware meta data file
+    ///     @param formatTag    Identifies the parser, part of the compiled file name
+    ///     @param parser       Used to parse metaDataFile if needed
+    /// @return NULL if the meta data could not be loaded
+    static QSharedPointer<ParameterMetaDataStore> load(const QString& metaDataFile, const QString& formatTag, Parser parser);
+
+    /// Writes a compiled meta data file
+    static bool compile(const QList<ParameterMetaDataRecord>& records, const QString& compiledFile, QString& errorString);
+
+    /// Sets the directory compiled files are written to. Default is a directory in the application cache location.
+    static void setCacheDirectory(const QString& cacheDirectory);
+    static QString cacheDirectory(void);
+
+    /// @return Number of times a meta data file was parsed and compiled. Used by unit tests.
+    static int compileCount(void);
+
+    int count(void) const { return _header ? _header->recordCount : 0; }
+
+    /// @return Index of the record, -1 if not found
+    int find(const QString& category, const QString& name) const;
+
+    /// Decodes a single record
+    ParameterMetaDataRecord record(int index) const;
+
+    /// Decodes only the group of a record
+    QString group(int index) const;
+
+    static const char* compiledFileExtension;
+
+private:
+    ParameterMetaDataStore(void);
+
+    bool _open      (const QString& compiledFile);
+    bool _setData   (const uchar* data, qint64 size);
+
+    static QByteArray _build(const QList<ParameterMetaDataRecord>& records);
+
+    struct Header {
+        char    magic[4];
+        quint32 version;
+        quint32 recordCount;
+        quint32 pairCount;
+        quint32 stringTableSize;
+        quint32 reserved;
+    };
+
+    enum {
+        StringCategory,
+        StringName,
+        StringGroup,
+        StringShortDescription,
+        StringLongDescription,
+        StringUnits,
+        StringMin,
+        StringMax,
+        StringIncrement,
+        StringDefaultValue,
+        StringCount
+    };
+
+    enum {
+        FlagRebootRequired =    1 << 0,
+        FlagBoolean =           1 << 1,
+    };
+
+    struct PackedRecord {
+        quint32 strings[StringCount];   ///< Offsets into the string table
+        qint8   type;
+        qint8   decimalPlaces;
+        quint8  flags;
+        quint8  reserved;
+        quint32 valuesStart;            ///< Index into the pair array
+        quint32 bitmaskStart;
+        quint16 valuesCount;
+        quint16 bitmaskCount;
+    };
+
+    struct PackedPair {
+        quint32 first;
+        quint32 second;
+    };
+
+    QString     _string         (quint32 offset) const;
+    QByteArray  _rawString      (quint32 offset) const;
+    int         _compare        (const PackedRecord& record, const QByteArray& category, const QByteArray& name) const;
+
+    QFile               _file;
+    QByteArray          _buffer;        ///< Holds the data when the compiled file can not be mapped
+    const uchar*        _data;
+    const Header*       _header;
+    const PackedRecord* _records;
+    const PackedPair*   _pairs;
+    const char*         _strings;
+
+    static const quint32 _version = 1;
+};
@@ -0,0 +1,217 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterMetaDataStoreTest.h"
+#include "Fact.h"
+#include "PX4ParameterMetaData.h"
+
+ParameterMetaDataStoreTest::ParameterMetaDataStoreTest(void)
+    : _tempDir(NULL)
+{
+
+}
+
+void ParameterMetaDataStoreTest::init(void)
+{
+    UnitTest::init();
+    _tempDir = new QTemporaryDir();
+    QVERIFY(_tempDir->isValid());
+    ParameterMetaDataStore::setCacheDirectory(QDir(_tempDir->path()).filePath(QStringLiteral("cache")));
+}
+
+void ParameterMetaDataStoreTest::cleanup(void)
+{
+    ParameterMetaDataStore::setCacheDirectory(QString());
+    delete _tempDir;
+    _tempDir = NULL;
+    UnitTest::cleanup();
+}
+
+QString ParameterMetaDataStoreTest::_writeMetaDataFile(const QByteArray& contents)
+{
+    QString path = QDir(_tempDir->path()).filePath(QStringLiteral("metadata.txt"));
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(contents);
+    }
+    return path;
+}
+
+/// Test parser: each line is category,name,shortDescription
+bool ParameterMetaDataStoreTest::_testParser(const QString& metaDataFile, QList<ParameterMetaDataRecord>& records)
+{
+    QFile file(metaDataFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    foreach (const QByteArray& line, file.readAll().split('\n')) {
+        QList<QByteArray> fields = line.split(',');
+        if (fields.count() == 3) {
+            ParameterMetaDataRecord record;
+            record.category = fields[0];
+            record.name = fields[1];
+            record.shortDescription = fields[2];
+            record.type = FactMetaData::valueTypeInt32;
+            records.append(record);
+        }
+    }
+    return true;
+}
+
+void ParameterMetaDataStoreTest::_compileFind_test(void)
+{
+    QList<ParameterMetaDataRecord> records;
+    for (int i=0; i<100; i++) {
+        ParameterMetaDataRecord record;
+        record.category = i % 2 ? QStringLiteral("ArduCopter") : QStringLiteral("libraries");
+        record.name = QString("PARAM_%1").arg(99 - i);
+        record.group = QString("GROUP_%1").arg(i % 5);
+        record.min = QStringLiteral("0");
+        record.max = QString::number(i);
+        record.type = FactMetaData::valueTypeUint8;
+        record.decimalPlaces = i % 4;
+        record.rebootRequired = i % 3 == 0;
+        record.values << QPair<QString, QString>(QStringLiteral("0"), QStringLiteral("Off"))
+                      << QPair<QString, QString>(QStringLiteral("1"), QStringLiteral("On"));
+        record.bitmask << QPair<QString, QString>(QStringLiteral("2"), QString::fromUtf8("\xE5\xB7\xA6"));
+        records.append(record);
+    }
+
+    QString metaDataFile = _writeMetaDataFile(QByteArray("unused"));
+    int parseCount = 0;
+    QSharedPointer<ParameterMetaDataStore> store = ParameterMetaDataStore::load(metaDataFile, QStringLiteral("Test"), [&records, &parseCount](const QString&, QList<ParameterMetaDataRecord>& parsedRecords) {
+        parseCount++;
+        parsedRecords = records;
+        return true;
+    });
+    QVERIFY(store);
+    QCOMPARE(parseCount, 1);
+    QCOMPARE(store->count(), 100);
+
+    for (int i=0; i<100; i++) {
+        const ParameterMetaDataRecord& expected = records[i];
+        int index = store->find(expected.category, expected.name);
+        QVERIFY(index != -1);
+        ParameterMetaDataRecord record = store->record(index);
+        QCOMPARE(record.name, expected.name);
+        QCOMPARE(record.category, expected.category);
+        QCOMPARE(record.group, expected.group);
+        QCOMPARE(store->group(index), expected.group);
+        QCOMPARE(record.max, expected.max);
+        QCOMPARE(record.type, expected.type);
+        QCOMPARE(record.decimalPlaces, expected.decimalPlaces);
+        QCOMPARE(record.rebootRequired, expected.rebootRequired);
+        QVERIFY(record.shortDescription.isEmpty());
+        QCOMPARE(record.values, expected.values);
+        QCOMPARE(record.bitmask, expected.bitmask);
+    }
+
+    QCOMPARE(store->find(QStringLiteral("ArduCopter"), QStringLiteral("PARAM_99")), -1);
+    QCOMPARE(store->find(QStringLiteral("ArduPlane"), QStringLiteral("PARAM_98")), -1);
+    QCOMPARE(store->find(QString(), QStringLiteral("PARAM_98")), -1);
+}
+
+void ParameterMetaDataStoreTest::_sharedLoad_test(void)
+{
+    QString metaDataFile = _writeMetaDataFile(QByteArray("cat,NAME_A,first\ncat,NAME_B,second\n"));
+    int compileCount = ParameterMetaDataStore::compileCount();
+
+    // Two vehicles share the same store
+    QSharedPointer<ParameterMetaDataStore> store1 = ParameterMetaDataStore::load(metaDataFile, QStringLiteral("Test"), _testParser);
+    QSharedPointer<ParameterMetaDataStore> store2 = ParameterMetaDataStore::load(metaDataFile, QStringLiteral("Test"), _testParser);
+    QVERIFY(store1);
+    QCOMPARE(store1.data(), store2.data());
+    QCOMPARE(ParameterMetaDataStore::compileCount(), compileCount + 1);
+    QCOMPARE(store1->record(store1->find(QStringLiteral("cat"), QStringLiteral("NAME_B"))).shortDescription, QStringLiteral("second"));
+
+    // Once released the next load maps the compiled file without parsing
+    store1.clear();
+    store2.clear();
+    QSharedPointer<ParameterMetaDataStore> store3 = ParameterMetaDataStore::load(metaDataFile, QStringLiteral("Test"), _testParser);
+    QVERIFY(store3);
+    QCOMPARE(ParameterMetaDataStore::compileCount(), compileCount + 1);
+    QCOMPARE(store3->count(), 2);
+    store3.clear();
+
+    // Changed meta data is recompiled
+    metaDataFile = _writeMetaDataFile(QByteArray("cat,NAME_A,changed\n"));
+    QSharedPointer<ParameterMetaDataStore> store4 = ParameterMetaDataStore::load(metaDataFile, QStringLiteral("Test"), _testParser);
+    QVERIFY(store4);
+    QCOMPARE(ParameterMetaDataStore::compileCount(), compileCount + 2);
+    QCOMPARE(store4->record(store4->find(QStringLiteral("cat"), QStringLiteral("NAME_A"))).shortDescription, QStringLiteral("changed"));
+}
+
+void ParameterMetaDataStoreTest::_lazyFactMetaData_test(void)
+{
+    Fact fact(1, QStringLiteral("TEST"), FactMetaData::valueTypeUint8);
+
+    int factoryCount = 0;
+    fact.setMetaDataFactory([&factoryCount](Fact* fact) {
+        factoryCount++;
+        FactMetaData* metaData = new FactMetaData(FactMetaData::valueTypeUint8, fact);
+        metaData->setShortDescription(QStringLiteral("lazy"));
+        metaData->setRawUnits(QStringLiteral("m"));
+        return metaData;
+    }, QStringLiteral("group"));
+
+    // Nothing is built until the meta data is needed. Value updates nobody listens to and grouping don't need it.
+    QCOMPARE(fact.name(), QStringLiteral("TEST"));
+    QCOMPARE(fact.group(), QStringLiteral("group"));
+    fact._containerSetRawValue(5);
+    QCOMPARE(fact.rawValue().toUInt(), 5u);
+    QCOMPARE(factoryCount, 0);
+
+    QCOMPARE(fact.shortDescription(), QStringLiteral("lazy"));
+    QCOMPARE(fact.rawUnits(), QStringLiteral("m"));
+    QCOMPARE(factoryCount, 1);
+}
+
+void ParameterMetaDataStoreTest::_px4MetaData_test(void)
+{
+    PX4ParameterMetaData metaData;
+    metaData.loadParameterFactMetaDataFile(QStringLiteral(":/FirmwarePlugin/PX4/PX4ParameterFactMetaData.xml"));
+
+    Fact fact(1, QStringLiteral("RC_MAP_THROTTLE"), FactMetaData::valueTypeInt32);
+    metaData.addMetaDataToFact(&fact, MAV_TYPE_QUADROTOR);
+    QVERIFY(!fact.shortDescription().isEmpty());
+    QCOMPARE(fact.group(), QStringLiteral("Radio Calibration"));
+
+    // A second vehicle uses the already compiled data
+    int compileCount = ParameterMetaDataStore::compileCount();
+    PX4ParameterMetaData metaData2;
+    metaData2.loadParameterFactMetaDataFile(QStringLiteral(":/FirmwarePlugin/PX4/PX4ParameterFactMetaData.xml"));
+    QCOMPARE(ParameterMetaDataStore::compileCount(), compileCount);
+
+    Fact fact2(1, QStringLiteral("RC_MAP_THROTTLE"), FactMetaData::valueTypeInt32);
+    metaData2.addMetaDataToFact(&fact2, MAV_TYPE_QUADROTOR);
+    QCOMPARE(fact2.shortDescription(), fact.shortDescription());
+}
+
+/// A meta data file which is cut off must not be compiled, or the partial result would be cached for good
+void ParameterMetaDataStoreTest::_px4TruncatedMetaData_test(void)
+{
+    QFile xmlFile(QStringLiteral(":/FirmwarePlugin/PX4/PX4ParameterFactMetaData.xml"));
+    QVERIFY(xmlFile.open(QIODevice::ReadOnly));
+    QByteArray xml = xmlFile.readAll();
+    QString truncatedFile = QDir(_tempDir->path()).filePath(QStringLiteral("truncated.xml"));
+    QFile file(truncatedFile);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(xml.left(xml.size() / 2));
+    file.close();
+
+    int compileCount = ParameterMetaDataStore::compileCount();
+    PX4ParameterMetaData metaData;
+    metaData.loadParameterFactMetaDataFile(truncatedFile);
+    QCOMPARE(ParameterMetaDataStore::compileCount(), compileCount);
+    QVERIFY(QDir(ParameterMetaDataStore::cacheDirectory()).entryList(QDir::Files).isEmpty());
+
+    Fact fact(1, QStringLiteral("RC_MAP_THROTTLE"), FactMetaData::valueTypeInt32);
+    metaData.addMetaDataToFact(&fact, MAV_TYPE_QUADROTOR);
+    QVERIFY(fact.shortDescription().isEmpty());
+}
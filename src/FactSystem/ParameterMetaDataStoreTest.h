@@ -0,0 +1,42 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "ParameterMetaDataStore.h"
+
+#include <QTemporaryDir>
+
+/// Unit test for ParameterMetaDataStore and lazy parameter meta data
+class ParameterMetaDataStoreTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ParameterMetaDataStoreTest(void);
+
+protected:
+    void init(void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _compileFind_test(void);
+    void _sharedLoad_test(void);
+    void _lazyFactMetaData_test(void);
+    void _px4MetaData_test(void);
+    void _px4TruncatedMetaData_test(void);
+
+private:
+    QString _writeMetaDataFile(const QByteArray& contents);
+
+    static bool _testParser(const QString& metaDataFile, QList<ParameterMetaDataRecord>& records);
+
+    QTemporaryDir* _tempDir;
+};
@@ -40,11 +40,11 @@ SettingsFact::SettingsFact(QString settingGroup, FactMetaData* metaData, QObject
         QVariant typedValue;
         QString errorString;
         metaData->convertAndValidateRaw(settings.value(_name, rawDefaultValue), true /* conertOnly */, typedValue, errorString);
-        _rawValue = typedValue;
+        _storeRawValue(typedValue);
     } else {
         // Setting is not visible, force to default value always
         settings.setValue(_name, rawDefaultValue);
-        _rawValue = rawDefaultValue;
+        _storeRawValue(rawDefaultValue);
     }
 
     connect(this, &Fact::rawValueChanged, this, &SettingsFact::_rawValueChanged);
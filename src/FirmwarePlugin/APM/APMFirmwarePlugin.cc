@@ -622,6 +622,22 @@ void APMFirmwarePlugin::initializeVehicle(Vehicle* vehicle)
         }
     } else {
         // Streams are not started automatically on APM stack
+        requestTelemetryStreams(vehicle);
+    }
+}
+
+void APMFirmwarePlugin::requestTelemetryStreams(Vehicle* vehicle)
+{
+    if (vehicle->fleetProfile()) {
+        // Enough for the map and the fleet overview, a rate of 0 stops the stream
+        vehicle->requestDataStream(MAV_DATA_STREAM_RAW_SENSORS,     0);
+        vehicle->requestDataStream(MAV_DATA_STREAM_EXTENDED_STATUS, 1);
+        vehicle->requestDataStream(MAV_DATA_STREAM_RC_CHANNELS,     0);
+        vehicle->requestDataStream(MAV_DATA_STREAM_POSITION,        2);
+        vehicle->requestDataStream(MAV_DATA_STREAM_EXTRA1,          2);
+        vehicle->requestDataStream(MAV_DATA_STREAM_EXTRA2,          2);
+        vehicle->requestDataStream(MAV_DATA_STREAM_EXTRA3,          1);
+    } else {
         vehicle->requestDataStream(MAV_DATA_STREAM_RAW_SENSORS,     2);
         vehicle->requestDataStream(MAV_DATA_STREAM_EXTENDED_STATUS, 2);
         vehicle->requestDataStream(MAV_DATA_STREAM_RC_CHANNELS,     2);
@@ -127,6 +127,30 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
     }
     _parameterMetaDataLoaded = true;
 
+    _store = ParameterMetaDataStore::load(metaDataFile, QStringLiteral("APM"), [this](const QString& file, QList<ParameterMetaDataRecord>& records) {
+        return _parseMetaDataFile(file, records);
+    });
+}
+
+/// Parses the xml meta data file into records for compiling into a ParameterMetaDataStore
+bool APMParameterMetaData::_parseMetaDataFile(const QString& metaDataFile, QList<ParameterMetaDataRecord>& records)
+{
+    _parseXml(metaDataFile);
+
+    foreach (const QString& category, _vehicleTypeToParametersMap.keys()) {
+        foreach (ParameterMetaDataRecord* rawMetaData, _vehicleTypeToParametersMap[category]) {
+            rawMetaData->category = category;
+            records.append(*rawMetaData);
+        }
+        qDeleteAll(_vehicleTypeToParametersMap[category]);
+    }
+    _vehicleTypeToParametersMap.clear();
+
+    return true;
+}
+
+void APMParameterMetaData::_parseXml(const QString& metaDataFile)
+{
     QRegExp parameterCategories = QRegExp("ArduCopter|ArduPlane|APMrover2|ArduSub|AntennaTracker");
     QString currentCategory;
 
@@ -149,7 +173,7 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
     QString             errorString;
     bool                badMetaData = true;
     QStack<int>         xmlState;
-    APMFactMetaDataRaw* rawMetaData = NULL;
+    ParameterMetaDataRecord* rawMetaData = NULL;
 
     xmlState.push(XmlStateNone);
 
@@ -242,7 +266,7 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                     qCDebug(APMParameterMetaDataLog) << "Duplicate parameter found:" << name;
                     rawMetaData = _vehicleTypeToParametersMap[currentCategory][name];
                 } else {
-                    rawMetaData = new APMFactMetaDataRaw();
+                    rawMetaData = new ParameterMetaDataRecord();
                     _vehicleTypeToParametersMap[currentCategory][name] = rawMetaData;
                     groupMembers[group] << name;
                 }
@@ -311,7 +335,7 @@ bool APMParameterMetaData::skipXMLBlock(QXmlStreamReader& xml, const QString& bl
     return !xml.isEndDocument();
 }
 
-bool APMParameterMetaData::parseParameterAttributes(QXmlStreamReader& xml, APMFactMetaDataRaw* rawMetaData)
+bool APMParameterMetaData::parseParameterAttributes(QXmlStreamReader& xml, ParameterMetaDataRecord* rawMetaData)
 {
     QString elementName = xml.name().toString();
     QList<QPair<QString,QString> > values;
@@ -355,7 +379,7 @@ bool APMParameterMetaData::parseParameterAttributes(QXmlStreamReader& xml, APMFa
             } else if (attributeName == "Increment") {
                 QString increment = xml.readElementText();
                 qCDebug(APMParameterMetaDataVerboseLog) << "read Increment: " << increment;
-                rawMetaData->incrementSize = increment;
+                rawMetaData->increment = increment;
             } else if (attributeName == "Units") {
                 QString units = xml.readElementText();
                 qCDebug(APMParameterMetaDataVerboseLog) << "read Units: " << units;
@@ -408,23 +432,35 @@ bool APMParameterMetaData::parseParameterAttributes(QXmlStreamReader& xml, APMFa
 
 void APMParameterMetaData::addMetaDataToFact(Fact* fact, MAV_TYPE vehicleType)
 {
-    const QString mavTypeString = mavTypeToString(vehicleType);
-    APMFactMetaDataRaw* rawMetaData = NULL;
+    QSharedPointer<ParameterMetaDataStore> store = _store;
+    int index = -1;
 
     // check if we have metadata for fact, use generic otherwise
-    if (_vehicleTypeToParametersMap[mavTypeString].contains(fact->name())) {
-        rawMetaData = _vehicleTypeToParametersMap[mavTypeString][fact->name()];
-    } else if (_vehicleTypeToParametersMap["libraries"].contains(fact->name())) {
-        rawMetaData = _vehicleTypeToParametersMap["libraries"][fact->name()];
+    if (store) {
+        index = store->find(mavTypeToString(vehicleType), fact->name());
+        if (index == -1) {
+            index = store->find(QStringLiteral("libraries"), fact->name());
+        }
     }
 
+    // The FactMetaData is only built once something looks at the fact
+    fact->setMetaDataFactory([store, index](Fact* fact) {
+        if (index == -1) {
+            return _createMetaData(fact, NULL);
+        }
+        ParameterMetaDataRecord rawMetaData = store->record(index);
+        return _createMetaData(fact, &rawMetaData);
+    }, index == -1 ? QString() : store->group(index));
+}
+
+FactMetaData* APMParameterMetaData::_createMetaData(Fact* fact, const ParameterMetaDataRecord* rawMetaData)
+{
     FactMetaData *metaData = new FactMetaData(fact->type(), fact);
 
     // we don't have data for this fact
     if (!rawMetaData) {
-        fact->setMetaData(metaData);
         qCDebug(APMParameterMetaDataLog) << "No metaData for " << fact->name() << "using generic metadata";
-        return;
+        return metaData;
     }
 
     metaData->setName(rawMetaData->name);
@@ -563,14 +599,14 @@ void APMParameterMetaData::addMetaDataToFact(Fact* fact, MAV_TYPE vehicleType)
         }
     }
 
-    if (!rawMetaData->incrementSize.isEmpty()) {
+    if (!rawMetaData->increment.isEmpty()) {
         double  increment;
         bool    ok;
-        increment = rawMetaData->incrementSize.toDouble(&ok);
+        increment = rawMetaData->increment.toDouble(&ok);
         if (ok) {
             metaData->setIncrement(increment);
         } else {
-            qCDebug(APMParameterMetaDataLog) << "Invalid value for increment, name:" << metaData->name() << " increment:" << rawMetaData->incrementSize;
+            qCDebug(APMParameterMetaDataLog) << "Invalid value for increment, name:" << metaData->name() << " increment:" << rawMetaData->increment;
         }
     }
 
@@ -583,7 +619,7 @@ void APMParameterMetaData::addMetaDataToFact(Fact* fact, MAV_TYPE vehicleType)
         metaData->setDecimalPlaces(6);
     }
 
-    fact->setMetaData(metaData);
+    return metaData;
 }
 
 void APMParameterMetaData::getParameterMetaDataVersionInfo(const QString& metaDataFile, int& majorVersion, int& minorVersion)
@@ -166,6 +166,11 @@ void FirmwarePlugin::adjustOutgoingMavlinkMessage(Vehicle* vehicle, LinkInterfac
     // Generic plugin does no message adjustment
 }
 
+void FirmwarePlugin::requestTelemetryStreams(Vehicle* vehicle)
+{
+    Q_UNUSED(vehicle);
+}
+
 void FirmwarePlugin::initializeVehicle(Vehicle* vehicle)
 {
     Q_UNUSED(vehicle);
@@ -69,6 +69,10 @@ public:
     /// Called when Vehicle is first created to perform any firmware specific setup.
     virtual void initializeVehicle(Vehicle* vehicle);
 
+    /// Requests the telemetry stream rates from the vehicle. Vehicles in the fleet profile should be asked for reduced
+    /// rates. Called whenever Vehicle::fleetProfile changes. Default implementation leaves the rates up to the vehicle.
+    virtual void requestTelemetryStreams(Vehicle* vehicle);
+
     /// @return true: Firmware supports all specified capabilites
     virtual bool isCapable(const Vehicle *vehicle, FirmwareCapabilities capabilities);
 
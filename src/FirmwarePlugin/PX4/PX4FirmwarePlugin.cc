@@ -233,6 +233,37 @@ bool PX4FirmwarePlugin::isCapable(const Vehicle *vehicle, FirmwareCapabilities c
 void PX4FirmwarePlugin::initializeVehicle(Vehicle* vehicle)
 {
     vehicle->setFirmwarePluginInstanceData(new PX4FirmwarePluginInstanceData);
+
+    // PX4 starts its streams on its own, only the fleet profile needs different rates
+    if (vehicle->fleetProfile()) {
+        requestTelemetryStreams(vehicle);
+    }
+}
+
+void PX4FirmwarePlugin::requestTelemetryStreams(Vehicle* vehicle)
+{
+    static const struct {
+        uint32_t    msgid;
+        float       fleetIntervalUSecs;     ///< -1 disables the message
+    } rgStreams[] = {
+        { MAVLINK_MSG_ID_ATTITUDE,                  500000 },
+        { MAVLINK_MSG_ID_ATTITUDE_QUATERNION,       -1 },
+        { MAVLINK_MSG_ID_ATTITUDE_TARGET,           -1 },
+        { MAVLINK_MSG_ID_HIGHRES_IMU,               -1 },
+        { MAVLINK_MSG_ID_LOCAL_POSITION_NED,        -1 },
+        { MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED, -1 },
+        { MAVLINK_MSG_ID_GLOBAL_POSITION_INT,       500000 },
+        { MAVLINK_MSG_ID_VFR_HUD,                   500000 },
+    };
+
+    for (size_t i=0; i<sizeof(rgStreams)/sizeof(rgStreams[0]); i++) {
+        // An interval of 0 goes back to the default rate
+        vehicle->sendMavCommand(vehicle->defaultComponentId(),
+                                MAV_CMD_SET_MESSAGE_INTERVAL,
+                                false,                                                      // No error shown if fails
+                                rgStreams[i].msgid,
+                                vehicle->fleetProfile() ? rgStreams[i].fleetIntervalUSecs : 0);
+    }
 }
 
 bool PX4FirmwarePlugin::sendHomePositionToVehicle(void)
@@ -19,6 +19,7 @@
 #include "FactSystem.h"
 #include "AutoPilotPlugin.h"
 #include "Vehicle.h"
+#include "ParameterMetaDataStore.h"
 
 /// @file
 ///     @author Don Gagne <don@thegagnes.com>
@@ -50,8 +51,11 @@ private:
 
     QVariant _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool* convertOk);
 
+    static bool             _parseMetaDataFile  (const QString& metaDataFile, QList<ParameterMetaDataRecord>& records);
+    static FactMetaData*    _createMetaData     (Fact* fact, const ParameterMetaDataRecord& rawMetaData);
+
     bool _parameterMetaDataLoaded;   ///< true: parameter meta data already loaded
-    QMap<QString, FactMetaData*> _mapParameterName2FactMetaData; ///< Maps from a parameter name to FactMetaData
+    QSharedPointer<ParameterMetaDataStore> _store;  ///< Compiled meta data, shared with other vehicles
 };
 
 #endif
@@ -163,19 +163,26 @@ FlightMap {
         property real leftToolWidth:    toolStrip.x + toolStrip.width
     }
 
-    // Add trajectory points to the map
-    MapItemView {
-        model: _mainIsMap ? _activeVehicle ? _activeVehicle.trajectoryPoints : 0 : 0
-
-        delegate: MapPolyline {
-            line.width: 3
-            line.color: "red"
-            z:          QGroundControl.zOrderTrajectoryLines
-            path: [
-                object.coordinate1,
-                object.coordinate2,
-            ]
-        }
+    // Add trajectory to the map
+    MapPolyline {
+        id:         trajectoryPolyline
+        line.width: 3
+        line.color: "red"
+        z:          QGroundControl.zOrderTrajectoryLines
+        path:       _mainIsMap && _activeVehicle ? _activeVehicle.trajectory.path : []
+    }
+
+    // New trajectory points are added to the polyline without fetching the whole path again
+    Connections {
+        target:                 _mainIsMap && _activeVehicle ? _activeVehicle.trajectory : null
+        onPathPointAppended:    trajectoryPolyline.addCoordinate(coordinate)
+    }
+
+    // Let the trajectory pick the level of detail which matches the map scale
+    Binding {
+        target:     _activeVehicle ? _activeVehicle.trajectory : null
+        property:   "displayMetersPerPixel"
+        value:      156543.03392 * Math.cos(flightMap.center.latitude * Math.PI / 180) / Math.pow(2, flightMap.zoomLevel)
     }
 
     // Add the vehicles to the map
@@ -25,7 +25,8 @@ Item {
     id: root
     property double _ar:            QGroundControl.settingsManager.videoSettings.aspectRatio.rawValue
     property bool   _showGrid:      QGroundControl.settingsManager.videoSettings.gridLines.rawValue > 0
-    property var    _videoReceiver: QGroundControl.videoManager.videoReceiver
+    property var    _streamManager: QGroundControl.videoManager.streamManager
+    property var    _videoReceiver: _streamManager && _streamManager.activeStream ? _streamManager.activeStream : QGroundControl.videoManager.videoReceiver
 
     Rectangle {
         id:             noVideo
@@ -92,4 +93,33 @@ Item {
             }
         }
     }
+    //-- Thumbnails of the other streams, clicking one makes it the main video
+    Row {
+        anchors.margins:    ScreenTools.defaultFontPixelWidth
+        anchors.left:       parent.left
+        anchors.top:        parent.top
+        spacing:            ScreenTools.defaultFontPixelWidth
+        visible:            !_mainIsMap && _streamManager && _streamManager.streams.count > 1
+        Repeater {
+            model:          _streamManager ? _streamManager.streams : 0
+            Rectangle {
+                width:          ScreenTools.defaultFontPixelWidth * 16
+                height:         width * 9 / 16
+                color:          "black"
+                border.color:   "white"
+                visible:        object !== _videoReceiver
+                QGCVideoBackground {
+                    anchors.fill:       parent
+                    anchors.margins:    1
+                    receiver:           object
+                    display:            object.videoSurface
+                    visible:            object.videoRunning
+                }
+                MouseArea {
+                    anchors.fill:   parent
+                    onClicked:      _streamManager.activeStream = object
+                }
+            }
+        }
+    }
 }
@@ -32,6 +32,7 @@ QGC_LOGGING_CATEGORY(VideoManagerLog, "VideoManagerLog")
 //-----------------------------------------------------------------------------
 VideoManager::VideoManager(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
+    , _streamManager(NULL)
     , _videoReceiver(NULL)
     , _videoSettings(NULL)
 {
@@ -40,8 +41,8 @@ VideoManager::VideoManager(QGCApplication* app, QGCToolbox* toolbox)
 //-----------------------------------------------------------------------------
 VideoManager::~VideoManager()
 {
-    if(_videoReceiver) {
-        delete _videoReceiver;
+    if(_streamManager) {
+        delete _streamManager;
     }
 }
 
@@ -54,12 +55,20 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
    qmlRegisterUncreatableType<VideoManager> ("QGroundControl.VideoManager", 1, 0, "VideoManager", "Reference only");
    qmlRegisterUncreatableType<VideoReceiver>("QGroundControl",              1, 0, "VideoReceiver","Reference only");
    qmlRegisterUncreatableType<VideoSurface> ("QGroundControl",              1, 0, "VideoSurface", "Reference only");
+   qmlRegisterUncreatableType<VideoStreamManager>("QGroundControl",         1, 0, "VideoStreamManager", "Reference only");
    _videoSettings = toolbox->settingsManager()->videoSettings();
    QString videoSource = _videoSettings->videoSource()->rawValue().toString();
    connect(_videoSettings->videoSource(),   &Fact::rawValueChanged, this, &VideoManager::_videoSourceChanged);
    connect(_videoSettings->udpPort(),       &Fact::rawValueChanged, this, &VideoManager::_udpPortChanged);
    connect(_videoSettings->rtspUrl(),       &Fact::rawValueChanged, this, &VideoManager::_rtspUrlChanged);
    connect(_videoSettings->tcpUrl(),        &Fact::rawValueChanged, this, &VideoManager::_tcpUrlChanged);
+   connect(_videoSettings->lowLatencyMode(),&Fact::rawValueChanged, this, &VideoManager::_lowLatencyModeChanged);
+   connect(_videoSettings->jitterBuffer(),  &Fact::rawValueChanged, this, &VideoManager::_lowLatencyModeChanged);
+   connect(_videoSettings->fleetStreams(),  &Fact::rawValueChanged, this, &VideoManager::_fleetStreamsChanged);
+   connect(_videoSettings->streamMemoryBudget(), &Fact::rawValueChanged, this, &VideoManager::_streamBudgetChanged);
+   connect(_videoSettings->streamCpuBudget(),    &Fact::rawValueChanged, this, &VideoManager::_streamBudgetChanged);
+   _streamManager = new VideoStreamManager(this);
+   _streamBudgetChanged();
 
 #if defined(QGC_GST_STREAMING)
 #ifndef QGC_DISABLE_UVC
@@ -77,13 +86,15 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
 
     emit isGStreamerChanged();
     qCDebug(VideoManagerLog) << "New Video Source:" << videoSource;
-    _videoReceiver = new VideoReceiver(this);
+    //-- The stream manager starts streams which have a URI, this one gets it from the settings below
+    _videoReceiver = _streamManager->addStream(QString());
     _updateSettings();
     if(isGStreamer()) {
         _videoReceiver->start();
     } else {
         _videoReceiver->stop();
     }
+    _fleetStreamsChanged();
 
 #endif
 }
@@ -118,6 +129,44 @@ VideoManager::_tcpUrlChanged()
     _restartVideo();
 }
 
+//-----------------------------------------------------------------------------
+void
+VideoManager::_lowLatencyModeChanged()
+{
+    //-- Queue, decoder and jitter buffer settings only take effect on a new pipeline
+    _restartVideo();
+}
+
+//-----------------------------------------------------------------------------
+// Streams are replaced as a whole, the URIs don't identify a stream across edits of the list
+void
+VideoManager::_fleetStreamsChanged()
+{
+#if defined(QGC_GST_STREAMING)
+    if(!_streamManager || !_videoReceiver)
+        return;
+    foreach(VideoReceiver* stream, _fleetStreams) {
+        _streamManager->removeStream(stream);
+    }
+    _fleetStreams.clear();
+    QStringList uris = _videoSettings->fleetStreams()->rawValue().toString().split(",", QString::SkipEmptyParts);
+    foreach(const QString& uri, uris) {
+        _fleetStreams.append(_streamManager->addStream(uri.trimmed()));
+    }
+#endif
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoManager::_streamBudgetChanged()
+{
+    if(!_streamManager)
+        return;
+    //-- Settings are stored using MB
+    _streamManager->setMemoryBudget(_videoSettings->streamMemoryBudget()->rawValue().toUInt() * 1024 * 1024);
+    _streamManager->setCpuBudget(_videoSettings->streamCpuBudget()->rawValue().toDouble());
+}
+
 //-----------------------------------------------------------------------------
 bool
 VideoManager::hasVideo()
@@ -17,6 +17,7 @@
 
 #include "QGCLoggingCategory.h"
 #include "VideoReceiver.h"
+#include "VideoStreamManager.h"
 #include "QGCToolbox.h"
 
 Q_DECLARE_LOGGING_CATEGORY(VideoManagerLog)
@@ -36,12 +37,14 @@ public:
     Q_PROPERTY(QString          videoSourceID       READ    videoSourceID                               NOTIFY videoSourceIDChanged)
     Q_PROPERTY(bool             uvcEnabled          READ    uvcEnabled                                  CONSTANT)
     Q_PROPERTY(VideoReceiver*   videoReceiver       READ    videoReceiver                               CONSTANT)
+    Q_PROPERTY(VideoStreamManager* streamManager    READ    streamManager                               CONSTANT)
 
     bool        hasVideo            ();
     bool        isGStreamer         ();
     QString     videoSourceID       () { return _videoSourceID; }
 
     VideoReceiver*  videoReceiver   () { return _videoReceiver; }
+    VideoStreamManager* streamManager() { return _streamManager; }
 
 #if defined(QGC_DISABLE_UVC)
     bool        uvcEnabled          () { return false; }
@@ -62,12 +65,17 @@ private slots:
     void _udpPortChanged            ();
     void _rtspUrlChanged            ();
     void _tcpUrlChanged             ();
+    void _lowLatencyModeChanged     ();
+    void _fleetStreamsChanged       ();
+    void _streamBudgetChanged       ();
 
 private:
     void _updateSettings            ();
     void _restartVideo              ();
 
-    VideoReceiver*  _videoReceiver;
+    VideoStreamManager* _streamManager;
+    VideoReceiver*  _videoReceiver;     ///< Stream of the video source setting, owned by _streamManager
+    QList<VideoReceiver*> _fleetStreams;
     VideoSettings*  _videoSettings;
     QString         _videoSourceID;
 };
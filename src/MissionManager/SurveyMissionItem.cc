@@ -16,6 +16,7 @@
 #include "QGCQGeoCoordinate.h"
 #include "SettingsManager.h"
 #include "AppSettings.h"
+#include "Terrain.h"
 
 #include <QPolygonF>
 
@@ -48,6 +49,8 @@ const char* SurveyMissionItem::_jsonManualGridKey =                 "manualGrid"
 const char* SurveyMissionItem::_jsonCameraOrientationLandscapeKey = "orientationLandscape";
 const char* SurveyMissionItem::_jsonFixedValueIsAltitudeKey =       "fixedValueIsAltitude";
 const char* SurveyMissionItem::_jsonRefly90DegreesKey =             "refly90Degrees";
+const char* SurveyMissionItem::_jsonTerrainFollowKey =              "terrainFollow";
+const char* SurveyMissionItem::_jsonTerrainFollowToleranceKey =     "terrainFollowTolerance";
 
 const char* SurveyMissionItem::settingsGroup =                  "Survey";
 const char* SurveyMissionItem::manualGridName =                 "ManualGrid";
@@ -72,6 +75,10 @@ const char* SurveyMissionItem::cameraTriggerName =              "CameraTrigger";
 const char* SurveyMissionItem::cameraOrientationLandscapeName = "CameraOrientationLandscape";
 const char* SurveyMissionItem::fixedValueIsAltitudeName =       "FixedValueIsAltitude";
 const char* SurveyMissionItem::cameraName =                     "Camera";
+const char* SurveyMissionItem::terrainFollowName =              "TerrainFollow";
+const char* SurveyMissionItem::terrainFollowToleranceName =     "TerrainFollowTolerance";
+
+const double SurveyMissionItem::_terrainSampleSpacingMeters =   10.0;
 
 SurveyMissionItem::SurveyMissionItem(Vehicle* vehicle, QObject* parent)
     : ComplexMissionItem(vehicle, parent)
@@ -88,6 +95,9 @@ SurveyMissionItem::SurveyMissionItem(Vehicle* vehicle, QObject* parent)
     , _cameraShots(0)
     , _coveredArea(0.0)
     , _timeBetweenShots(0.0)
+    , _terrainWaypointCount(0)
+    , _terrainDataReady(false)
+    , _terrainProvider(NULL)
     , _metaDataMap(FactMetaData::createMapFromJsonFile(QStringLiteral(":/json/Survey.SettingsGroup.json"), this))
     , _manualGridFact                   (settingsGroup, _metaDataMap[manualGridName])
     , _gridAltitudeFact                 (settingsGroup, _metaDataMap[gridAltitudeName])
@@ -110,6 +120,8 @@ SurveyMissionItem::SurveyMissionItem(Vehicle* vehicle, QObject* parent)
     , _cameraOrientationLandscapeFact   (settingsGroup, _metaDataMap[cameraOrientationLandscapeName])
     , _fixedValueIsAltitudeFact         (settingsGroup, _metaDataMap[fixedValueIsAltitudeName])
     , _cameraFact                       (settingsGroup, _metaDataMap[cameraName])
+    , _terrainFollowFact                (settingsGroup, _metaDataMap[terrainFollowName])
+    , _terrainFollowToleranceFact       (settingsGroup, _metaDataMap[terrainFollowToleranceName])
 
 
 
@@ -157,6 +169,13 @@ SurveyMissionItem::SurveyMissionItem(Vehicle* vehicle, QObject* parent)
 
     connect(&_mapPolygon, &QGCMapPolygon::dirtyChanged, this, &SurveyMissionItem::_polygonDirtyChanged);
     connect(&_mapPolygon, &QGCMapPolygon::pathChanged,  this, &SurveyMissionItem::_generateGrid);
+
+    // Terrain profile is only re-queried when the grid geometry changes. Tolerance changes just re-simplify the profile.
+    _terrainQueryTimer.setSingleShot(true);
+    _terrainQueryTimer.setInterval(250);
+    connect(&_terrainQueryTimer,            &QTimer::timeout,       this, &SurveyMissionItem::_queryTerrain);
+    connect(&_terrainFollowFact,            &Fact::valueChanged,    this, &SurveyMissionItem::_generateGrid);
+    connect(&_terrainFollowToleranceFact,   &Fact::valueChanged,    this, &SurveyMissionItem::_updateCoordinateAltitude);
 }
 
 void SurveyMissionItem::_setSurveyDistance(double surveyDistance)
@@ -192,6 +211,7 @@ void SurveyMissionItem::_clearInternal(void)
     emit gridPointsChanged();
     _simpleGridPoints.clear();
     _transectSegments.clear();
+    _clearTerrainData();
 
     _missionCommandCount = 0;
 
@@ -203,7 +223,7 @@ void SurveyMissionItem::_clearInternal(void)
 
 int SurveyMissionItem::lastSequenceNumber(void) const
 {
-    return _sequenceNumber + _missionCommandCount;
+    return _sequenceNumber + _missionCommandCount + (_terrainFollowActive() ? _terrainWaypointCount : 0);
 }
 
 void SurveyMissionItem::setCoordinate(const QGeoCoordinate& coordinate)
@@ -242,6 +262,8 @@ void SurveyMissionItem::save(QJsonArray&  missionItems)
     gridObject[_jsonGridSpacingKey] =           _gridSpacingFact.rawValue().toDouble();
     gridObject[_jsonGridEntryLocationKey] =     _gridEntryLocationFact.rawValue().toDouble();
     gridObject[_jsonTurnaroundDistKey] =        _turnaroundDistFact.rawValue().toDouble();
+    gridObject[_jsonTerrainFollowKey] =         _terrainFollowFact.rawValue().toBool();
+    gridObject[_jsonTerrainFollowToleranceKey] = _terrainFollowToleranceFact.rawValue().toDouble();
 
     saveObject[_jsonGridObjectKey] = gridObject;
 
@@ -346,6 +368,8 @@ bool SurveyMissionItem::load(const QJsonObject& complexObject, int sequenceNumbe
         { _jsonGridSpacingKey,                  QJsonValue::Double, true },
         { _jsonGridEntryLocationKey,            QJsonValue::Double, false },
         { _jsonTurnaroundDistKey,               QJsonValue::Double, true },
+        { _jsonTerrainFollowKey,                QJsonValue::Bool,   false },
+        { _jsonTerrainFollowToleranceKey,       QJsonValue::Double, false },
     };
     QJsonObject gridObject = v2Object[_jsonGridObjectKey].toObject();
     if (!JsonHelper::validateKeys(gridObject, gridKeyInfoList, errorString)) {
@@ -356,6 +380,12 @@ bool SurveyMissionItem::load(const QJsonObject& complexObject, int sequenceNumbe
     _gridSpacingFact.setRawValue            (gridObject[_jsonGridSpacingKey].toDouble());
     _turnaroundDistFact.setRawValue         (gridObject[_jsonTurnaroundDistKey].toDouble());
     _cameraTriggerDistanceFact.setRawValue  (v2Object[_jsonCameraTriggerDistanceKey].toDouble());
+    _terrainFollowFact.setRawValue          (gridObject[_jsonTerrainFollowKey].toBool(false));
+    if (gridObject.contains(_jsonTerrainFollowToleranceKey)) {
+        _terrainFollowToleranceFact.setRawValue(gridObject[_jsonTerrainFollowToleranceKey].toDouble());
+    } else {
+        _terrainFollowToleranceFact.setRawValue(_terrainFollowToleranceFact.rawDefaultValue());
+    }
     if (gridObject.contains(_jsonGridEntryLocationKey)) {
         _gridEntryLocationFact.setRawValue(gridObject[_jsonGridEntryLocationKey].toDouble());
     } else {
@@ -693,6 +723,7 @@ void SurveyMissionItem::_generateGrid(void)
     _simpleGridPoints.clear();
     _transectSegments.clear();
     _reflyTransectSegments.clear();
+    _clearTerrainData();
     _additionalFlightDelaySeconds = 0;
 
     QList<QPointF>          polygonPoints;
@@ -794,18 +825,263 @@ void SurveyMissionItem::_generateGrid(void)
         _setExitCoordinate(exitCoordinate);
     }
 
+    if (_terrainFollowFact.rawValue().toBool()) {
+        _terrainQueryTimer.start();
+    }
+
     setDirty(true);
 }
 
 void SurveyMissionItem::_updateCoordinateAltitude(void)
 {
-    _coordinate.setAltitude(_gridAltitudeFact.rawValue().toDouble());
-    _exitCoordinate.setAltitude(_gridAltitudeFact.rawValue().toDouble());
+    _buildTerrainWaypoints();
+
+    if (_terrainFollowActive() && _transectSegments.count()) {
+        _coordinate.setAltitude(_transectSegments.first().first().altitude());
+        const QList<QList<QGeoCoordinate>>& exitSegments = _refly90Degrees && _reflyTransectSegments.count() ? _reflyTransectSegments : _transectSegments;
+        _exitCoordinate.setAltitude(exitSegments.last().last().altitude());
+    } else {
+        _coordinate.setAltitude(_gridAltitudeFact.rawValue().toDouble());
+        _exitCoordinate.setAltitude(_gridAltitudeFact.rawValue().toDouble());
+    }
     emit coordinateChanged(_coordinate);
     emit exitCoordinateChanged(_exitCoordinate);
+    emit lastSequenceNumberChanged(lastSequenceNumber());
     setDirty(true);
 }
 
+bool SurveyMissionItem::_terrainFollowActive(void) const
+{
+    return _terrainFollowFact.rawValue().toBool() && _terrainDataReady;
+}
+
+void SurveyMissionItem::_setTerrainDataReady(bool terrainDataReady)
+{
+    if (_terrainDataReady != terrainDataReady) {
+        _terrainDataReady = terrainDataReady;
+        emit terrainDataReadyChanged(_terrainDataReady);
+    }
+}
+
+void SurveyMissionItem::_clearTerrainData(void)
+{
+    _terrainQueryTimer.stop();
+    if (_terrainProvider) {
+        // Results from an outdated grid are ignored
+        _terrainProvider->disconnect(this);
+        _terrainProvider->deleteLater();
+        _terrainProvider = NULL;
+    }
+    _terrainSamples.clear();
+    _terrainSampleAltitudes.clear();
+    _terrainLegPoints.clear();
+    _reflyTerrainLegPoints.clear();
+    _terrainWaypointCount = 0;
+    _setTerrainDataReady(false);
+}
+
+/// Number of terrain profile samples for a transect leg, including both end points
+static int _terrainLegSampleCount(const QGeoCoordinate& from, const QGeoCoordinate& to, double sampleSpacing)
+{
+    return qMax(2, (int)ceil(from.distanceTo(to) / sampleSpacing) + 1);
+}
+
+/// Collects the terrain profile samples for all transects, including refly, and sends them out as a single query.
+void SurveyMissionItem::_queryTerrain(void)
+{
+    if (!_terrainFollowFact.rawValue().toBool() || _transectSegments.isEmpty()) {
+        return;
+    }
+
+    _clearTerrainData();
+
+    for (int refly=0; refly<2; refly++) {
+        const QList<QList<QGeoCoordinate>>& transectSegments = refly ? _reflyTransectSegments : _transectSegments;
+        foreach (const QList<QGeoCoordinate>& segment, transectSegments) {
+            for (int i=0; i<segment.count() - 1; i++) {
+                const QGeoCoordinate& from = segment[i];
+                const QGeoCoordinate& to = segment[i + 1];
+                int sampleCount = _terrainLegSampleCount(from, to, _terrainSampleSpacingMeters);
+                double legLength = from.distanceTo(to);
+                double azimuth = from.azimuthTo(to);
+                for (int j=0; j<sampleCount; j++) {
+                    _terrainSamples.append(from.atDistanceAndAzimuth(legLength * j / (sampleCount - 1), azimuth));
+                }
+            }
+        }
+    }
+
+    qCDebug(SurveyMissionItemLog) << "Terrain follow query sample count" << _terrainSamples.count();
+
+    _terrainProvider = new ElevationProvider(this);
+    connect(_terrainProvider, &ElevationProvider::terrainData, this, &SurveyMissionItem::_terrainDataReceived);
+    if (!_terrainProvider->queryTerrainData(_terrainSamples)) {
+        qCWarning(SurveyMissionItemLog) << "Terrain follow query failed, using fixed grid altitude";
+        _terrainProvider->deleteLater();
+        _terrainProvider = NULL;
+    }
+}
+
+void SurveyMissionItem::_terrainDataReceived(bool success, QList<float> altitudes)
+{
+    if (sender() != _terrainProvider) {
+        return;
+    }
+    _terrainProvider->deleteLater();
+    _terrainProvider = NULL;
+
+    if (!success || altitudes.count() != _terrainSamples.count()) {
+        qCWarning(SurveyMissionItemLog) << "Terrain data not available, using fixed grid altitude" << success << altitudes.count() << _terrainSamples.count();
+        _setTerrainDataReady(false);
+        return;
+    }
+
+    _terrainSampleAltitudes = altitudes;
+    _setTerrainDataReady(true);
+    _updateCoordinateAltitude();
+}
+
+/// Builds the terrain follow waypoints from the terrain profile. Each transect leg is simplified separately so that
+/// transect points themselves are always kept.
+void SurveyMissionItem::_buildTerrainWaypoints(void)
+{
+    _terrainLegPoints.clear();
+    _reflyTerrainLegPoints.clear();
+    _terrainWaypointCount = 0;
+
+    if (!_terrainDataReady || _terrainSampleAltitudes.count() != _terrainSamples.count()) {
+        return;
+    }
+
+    double  heightAboveTerrain =    _gridAltitudeFact.rawValue().toDouble();
+    double  tolerance =             _terrainFollowToleranceFact.rawValue().toDouble();
+    int     sampleIndex =           0;
+
+    for (int refly=0; refly<2; refly++) {
+        QList<QList<QGeoCoordinate>>&   transectSegments =  refly ? _reflyTransectSegments : _transectSegments;
+        TerrainLegPoints&               terrainLegPoints =  refly ? _reflyTerrainLegPoints : _terrainLegPoints;
+
+        for (int segmentIndex=0; segmentIndex<transectSegments.count(); segmentIndex++) {
+            QList<QGeoCoordinate>&          segment = transectSegments[segmentIndex];
+            QList<QList<QGeoCoordinate>>    segmentLegPoints;
+
+            for (int i=0; i<segment.count() - 1; i++) {
+                QGeoCoordinate& from =  segment[i];
+                QGeoCoordinate& to =    segment[i + 1];
+                int     sampleCount =   _terrainLegSampleCount(from, to, _terrainSampleSpacingMeters);
+                double  legLength =     from.distanceTo(to);
+                double  azimuth =       from.azimuthTo(to);
+
+                if (sampleIndex + sampleCount > _terrainSampleAltitudes.count()) {
+                    qCWarning(SurveyMissionItemLog) << "Terrain profile does not match transects";
+                    _terrainLegPoints.clear();
+                    _reflyTerrainLegPoints.clear();
+                    _terrainWaypointCount = 0;
+                    return;
+                }
+
+                QList<double> distances;
+                QList<double> elevations;
+                for (int j=0; j<sampleCount; j++) {
+                    distances.append(legLength * j / (sampleCount - 1));
+                    elevations.append(_terrainSampleAltitudes[sampleIndex + j]);
+                }
+                sampleIndex += sampleCount;
+
+                from.setAltitude(elevations.first() + heightAboveTerrain);
+                to.setAltitude(elevations.last() + heightAboveTerrain);
+
+                QList<int> keptIndices = simplifyTerrainProfile(distances, elevations, tolerance);
+                QList<QGeoCoordinate> legPoints;
+                for (int k=1; k<keptIndices.count() - 1; k++) {
+                    int index = keptIndices[k];
+                    QGeoCoordinate coord = from.atDistanceAndAzimuth(distances[index], azimuth);
+                    coord.setAltitude(elevations[index] + heightAboveTerrain);
+                    legPoints.append(coord);
+                }
+                _terrainWaypointCount += legPoints.count();
+                segmentLegPoints.append(legPoints);
+            }
+
+            terrainLegPoints.append(segmentLegPoints);
+        }
+    }
+
+    qCDebug(SurveyMissionItemLog) << "Terrain follow waypoints added" << _terrainWaypointCount;
+}
+
+QList<int> SurveyMissionItem::simplifyTerrainProfile(const QList<double>& distances, const QList<double>& elevations, double tolerance)
+{
+    QList<int> keptIndices;
+    int count = qMin(distances.count(), elevations.count());
+
+    if (count == 0) {
+        return keptIndices;
+    } else if (count <= 2) {
+        for (int i=0; i<count; i++) {
+            keptIndices.append(i);
+        }
+        return keptIndices;
+    }
+
+    QVector<bool> rgKeep(count, false);
+    rgKeep[0] = rgKeep[count - 1] = true;
+
+    // Iterative to avoid deep recursion on long transects
+    QList<QPair<int, int>> stack;
+    stack.append(qMakePair(0, count - 1));
+    while (!stack.isEmpty()) {
+        QPair<int, int> range = stack.takeLast();
+        int     first =         range.first;
+        int     last =          range.second;
+        double  span =          distances[last] - distances[first];
+        double  maxDeviation =  0;
+        int     maxIndex =      -1;
+
+        for (int i=first + 1; i<last; i++) {
+            double fraction = span > 0 ? (distances[i] - distances[first]) / span : 0;
+            double interpolated = elevations[first] + fraction * (elevations[last] - elevations[first]);
+            double deviation = fabs(elevations[i] - interpolated);
+            if (deviation > maxDeviation) {
+                maxDeviation = deviation;
+                maxIndex = i;
+            }
+        }
+
+        if (maxIndex != -1 && maxDeviation > tolerance) {
+            rgKeep[maxIndex] = true;
+            stack.append(qMakePair(first, maxIndex));
+            stack.append(qMakePair(maxIndex, last));
+        }
+    }
+
+    for (int i=0; i<count; i++) {
+        if (rgKeep[i]) {
+            keptIndices.append(i);
+        }
+    }
+    return keptIndices;
+}
+
+const QList<QGeoCoordinate>& SurveyMissionItem::_terrainLegPoints(bool refly, int segmentIndex, int legIndex) const
+{
+    static const QList<QGeoCoordinate> emptyList;
+
+    const TerrainLegPoints& terrainLegPoints = refly ? _reflyTerrainLegPoints : _terrainLegPoints;
+    if (!_terrainFollowActive() || segmentIndex >= terrainLegPoints.count() || legIndex < 0 || legIndex >= terrainLegPoints[segmentIndex].count()) {
+        return emptyList;
+    }
+    return terrainLegPoints[segmentIndex][legIndex];
+}
+
+int SurveyMissionItem::_appendTerrainLegWaypoints(QList<MissionItem*>& items, int seqNum, const QList<QGeoCoordinate>& legPoints, QObject* missionItemParent)
+{
+    foreach (QGeoCoordinate coord, legPoints) {
+        seqNum = _appendWaypointToMission(items, seqNum, coord, CameraTriggerNone, missionItemParent);
+    }
+    return seqNum;
+}
+
 QPointF SurveyMissionItem::_rotatePoint(const QPointF& point, const QPointF& origin, double angle)
 {
     QPointF rotated;
@@ -1136,8 +1412,10 @@ int SurveyMissionItem::_appendWaypointToMission(QList<MissionItem*>& items, int
 
 )
 {
-    double  altitude =          _gridAltitudeFact.rawValue().toDouble();
-    bool    altitudeRelative =  _gridAltitudeRelativeFact.rawValue().toBool();
+    // With terrain follow the coordinate carries the AMSL altitude of the terrain profile plus grid altitude
+    bool    terrainFollow =     _terrainFollowActive();
+    double  altitude =          terrainFollow ? coord.altitude() : _gridAltitudeFact.rawValue().toDouble();
+    bool    altitudeRelative =  !terrainFollow && _gridAltitudeRelativeFact.rawValue().toBool();
 
     qCDebug(SurveyMissionItemLog) << "_appendWaypointToMission seq:trigger" << seqNum << (cameraTrigger != CameraTriggerNone);
     MissionItem* item = new MissionItem(seqNum++,
@@ -1262,6 +1540,7 @@ bool SurveyMissionItem::_appendMissionItemsWorker(QList<MissionItem*>& items, QO
 #endif			
 //            seqNum = _appendWaypointToMission(items, seqNum, coord, firstWaypointTrigger ? CameraTriggerOn : CameraTriggerNone, missionItemParent);
 			seqNum = _appendWaypointToMission(items, seqNum, coord, firstWaypointTrigger ? CameraTriggerOn : CameraTriggerNone, missionItemParent);
+            seqNum = _appendTerrainLegWaypoints(items, seqNum, _terrainLegPoints(buildRefly, segmentIndex, pointIndex - 1), missionItemParent);
             firstWaypointTrigger = false;
 #ifdef AgriTrigger_TOCamera
 					 trunline=false;
@@ -1279,6 +1558,7 @@ bool SurveyMissionItem::_appendMissionItemsWorker(QList<MissionItem*>& items, QO
             cameraTrigger = _imagesEverywhere() || !_triggerCamera() ? CameraTriggerNone : (_hoverAndCaptureEnabled() ? CameraTriggerHoverAndCapture : CameraTriggerOn);
         }
         seqNum = _appendWaypointToMission(items, seqNum, coord, cameraTrigger, missionItemParent);
+        seqNum = _appendTerrainLegWaypoints(items, seqNum, _terrainLegPoints(buildRefly, segmentIndex, pointIndex - 1), missionItemParent);
         firstWaypointTrigger = false;
 
         // Add internal hover and capture points
@@ -1290,6 +1570,7 @@ bool SurveyMissionItem::_appendMissionItemsWorker(QList<MissionItem*>& items, QO
                     return false;
                 }
                 seqNum = _appendWaypointToMission(items, seqNum, coord, CameraTriggerHoverAndCapture, missionItemParent);
+                seqNum = _appendTerrainLegWaypoints(items, seqNum, _terrainLegPoints(buildRefly, segmentIndex, pointIndex), missionItemParent);
             }
         }
 
@@ -1299,6 +1580,7 @@ bool SurveyMissionItem::_appendMissionItemsWorker(QList<MissionItem*>& items, QO
         }
         cameraTrigger = _imagesEverywhere() || !_triggerCamera() ? CameraTriggerNone : (_hoverAndCaptureEnabled() ? CameraTriggerNone : CameraTriggerOff);
         seqNum = _appendWaypointToMission(items, seqNum, coord, cameraTrigger, missionItemParent);
+        seqNum = _appendTerrainLegWaypoints(items, seqNum, _terrainLegPoints(buildRefly, segmentIndex, pointIndex - 1), missionItemParent);
 
         if (_hasTurnaround()) {
             // Add exit turnaround point
@@ -17,6 +17,8 @@
 #include "QGCLoggingCategory.h"
 #include "QGCMapPolygon.h"
 
+class ElevationProvider;
+
 Q_DECLARE_LOGGING_CATEGORY(SurveyMissionItemLog)
 
 class SurveyMissionItem : public ComplexMissionItem
@@ -47,6 +49,8 @@ public:
     Q_PROPERTY(Fact*                fixedValueIsAltitude        READ fixedValueIsAltitude           CONSTANT)
     Q_PROPERTY(Fact*                manualGrid                  READ manualGrid                     CONSTANT)
     Q_PROPERTY(Fact*                camera                      READ camera                         CONSTANT)
+    Q_PROPERTY(Fact*                terrainFollow               READ terrainFollow                  CONSTANT)
+    Q_PROPERTY(Fact*                terrainFollowTolerance      READ terrainFollowTolerance         CONSTANT)
 
     Q_PROPERTY(bool                 cameraOrientationFixed      MEMBER _cameraOrientationFixed      NOTIFY cameraOrientationFixedChanged)
     Q_PROPERTY(bool                 hoverAndCaptureAllowed      READ hoverAndCaptureAllowed         CONSTANT)
@@ -57,6 +61,7 @@ public:
     Q_PROPERTY(QVariantList         gridPoints                  READ gridPoints                     NOTIFY gridPointsChanged)
     Q_PROPERTY(int                  cameraShots                 READ cameraShots                    NOTIFY cameraShotsChanged)
     Q_PROPERTY(double               coveredArea                 READ coveredArea                    NOTIFY coveredAreaChanged)
+    Q_PROPERTY(bool                 terrainDataReady            READ terrainDataReady               NOTIFY terrainDataReadyChanged)
 
     Q_PROPERTY(QGCMapPolygon*       mapPolygon                  READ mapPolygon                     CONSTANT)
 
@@ -83,6 +88,8 @@ public:
     Fact* cameraOrientationLandscape(void) { return &_cameraOrientationLandscapeFact; }
     Fact* fixedValueIsAltitude      (void) { return &_fixedValueIsAltitudeFact; }
     Fact* camera                    (void) { return &_cameraFact; }
+    Fact* terrainFollow             (void) { return &_terrainFollowFact; }
+    Fact* terrainFollowTolerance    (void) { return &_terrainFollowToleranceFact; }
 
     int             cameraShots             (void) const;
     double          coveredArea             (void) const { return _coveredArea; }
@@ -90,9 +97,18 @@ public:
     bool            hoverAndCaptureAllowed  (void) const;
     bool            refly90Degrees          (void) const { return _refly90Degrees; }
     QGCMapPolygon*  mapPolygon              (void) { return &_mapPolygon; }
+    bool            terrainDataReady        (void) const { return _terrainDataReady; }
 
     void setRefly90Degrees(bool refly90Degrees);
 
+    /// Douglas-Peucker simplification of a terrain profile. Returns the indices of the profile samples which must be
+    /// kept so that linear interpolation between them stays within tolerance of every sample. First and last sample are
+    /// always kept.
+    ///     @param distances    Distance of each sample along the path, ascending
+    ///     @param elevations   Terrain elevation at each sample
+    ///     @param tolerance    Maximum allowed vertical deviation
+    static QList<int> simplifyTerrainProfile(const QList<double>& distances, const QList<double>& elevations, double tolerance);
+
     // Overrides from ComplexMissionItem
 
     double              complexDistance     (void) const final { return _surveyDistance; }
@@ -121,8 +137,8 @@ public:
     void            setMissionFlightStatus  (MissionController::MissionFlightStatus_t& missionFlightStatus) final;
     void            applyNewAltitude        (double newAltitude) final;
 
-    bool coordinateHasRelativeAltitude      (void) const final { return _gridAltitudeRelativeFact.rawValue().toBool(); }
-    bool exitCoordinateHasRelativeAltitude  (void) const final { return _gridAltitudeRelativeFact.rawValue().toBool(); }
+    bool coordinateHasRelativeAltitude      (void) const final { return !_terrainFollowActive() && _gridAltitudeRelativeFact.rawValue().toBool(); }
+    bool exitCoordinateHasRelativeAltitude  (void) const final { return !_terrainFollowActive() && _gridAltitudeRelativeFact.rawValue().toBool(); }
     bool exitCoordinateSameAsEntry          (void) const final { return false; }
 
     void setDirty           (bool dirty) final;
@@ -164,6 +180,8 @@ public:
     static const char* cameraOrientationLandscapeName;
     static const char* fixedValueIsAltitudeName;
     static const char* cameraName;
+    static const char* terrainFollowName;
+    static const char* terrainFollowToleranceName;
 
 signals:
     void gridPointsChanged                  (void);
@@ -175,11 +193,14 @@ signals:
     void cameraOrientationFixedChanged      (bool cameraOrientationFixed);
     void refly90DegreesChanged              (bool refly90Degrees);
     void cameraMinTriggerIntervalChanged    (double cameraMinTriggerInterval);
+    void terrainDataReadyChanged            (bool terrainDataReady);
 
 private slots:
     void _setDirty(void);
     void _polygonDirtyChanged(bool dirty);
     void _clearInternal(void);
+    void _queryTerrain(void);
+    void _terrainDataReceived(bool success, QList<float> altitudes);
 
 private:
     enum CameraTriggerCode {
@@ -232,6 +253,12 @@ private:
     void _adjustTransectsToEntryPointLocation(QList<QList<QGeoCoordinate>>& transects);
     bool _gridAngleIsNorthSouthTransects();
     double _clampGridAngle90(double gridAngle);
+    bool _terrainFollowActive(void) const;
+    void _setTerrainDataReady(bool terrainDataReady);
+    void _clearTerrainData(void);
+    void _buildTerrainWaypoints(void);
+    int _appendTerrainLegWaypoints(QList<MissionItem*>& items, int seqNum, const QList<QGeoCoordinate>& legPoints, QObject* missionItemParent);
+    const QList<QGeoCoordinate>& _terrainLegPoints(bool refly, int segmentIndex, int legIndex) const;
 
     int                             _sequenceNumber;
     bool                            _dirty;
@@ -239,6 +266,18 @@ private:
     QVariantList                    _simpleGridPoints;      ///< Grid points for drawing simple grid visuals
     QList<QList<QGeoCoordinate>>    _transectSegments;      ///< Internal transect segments including grid exit, turnaround and internal camera points
     QList<QList<QGeoCoordinate>>    _reflyTransectSegments; ///< Refly segments
+
+    /// Terrain follow waypoints to insert between transect points: [segment][leg from point i to i+1]. Altitudes are AMSL.
+    /// Transect point altitudes (AMSL) are stored in the altitude of the _transectSegments/_reflyTransectSegments coordinates.
+    typedef QList<QList<QList<QGeoCoordinate>>> TerrainLegPoints;
+    TerrainLegPoints                _terrainLegPoints;
+    TerrainLegPoints                _reflyTerrainLegPoints;
+    int                             _terrainWaypointCount;  ///< Number of inserted terrain follow waypoints
+    bool                            _terrainDataReady;
+    ElevationProvider*              _terrainProvider;       ///< Outstanding terrain query, NULL if none
+    QList<QGeoCoordinate>           _terrainSamples;        ///< Terrain profile sample coordinates for all transect legs
+    QList<float>                    _terrainSampleAltitudes;///< Terrain elevation (AMSL) for each _terrainSamples entry
+    QTimer                          _terrainQueryTimer;     ///< Collapses rapid grid changes into a single terrain query
     QGeoCoordinate                  _coordinate;
     QGeoCoordinate                  _exitCoordinate;
     bool                            _cameraOrientationFixed;
@@ -277,6 +316,8 @@ private:
     SettingsFact    _cameraOrientationLandscapeFact;
     SettingsFact    _fixedValueIsAltitudeFact;
     SettingsFact    _cameraFact;
+    SettingsFact    _terrainFollowFact;
+    SettingsFact    _terrainFollowToleranceFact;
 
     static const char* _jsonGridObjectKey;
     static const char* _jsonGridAltitudeKey;
@@ -303,8 +344,11 @@ private:
     static const char* _jsonCameraOrientationLandscapeKey;
     static const char* _jsonFixedValueIsAltitudeKey;
     static const char* _jsonRefly90DegreesKey;
+    static const char* _jsonTerrainFollowKey;
+    static const char* _jsonTerrainFollowToleranceKey;
 
-    static const int _hoverAndCaptureDelaySeconds = 1;
+    static const int    _hoverAndCaptureDelaySeconds = 1;
+    static const double _terrainSampleSpacingMeters;    ///< Spacing of terrain profile samples along transects
 };
 
 #endif
@@ -9,9 +9,16 @@
 
 #include "SurveyMissionItemTest.h"
 #include "QGCApplication.h"
+#include "SettingsManager.h"
+#include "Terrain.h"
+
+#include <QDir>
+#include <QFile>
+#include <QtEndian>
 
 SurveyMissionItemTest::SurveyMissionItemTest(void)
     : _offlineVehicle(NULL)
+    , _terrainDir(NULL)
 {
     _polyPoints << QGeoCoordinate(47.633550640000003, -122.08982199) << QGeoCoordinate(47.634129020000003, -122.08887249) <<
                    QGeoCoordinate(47.633619320000001, -122.08811074) << QGeoCoordinate(47.633189139999999, -122.08900124);
@@ -51,6 +58,14 @@ void SurveyMissionItemTest::cleanup(void)
     delete _surveyItem;
     delete _offlineVehicle;
     delete _multiSpy;
+
+    if (_terrainDir) {
+        qgcApp()->toolbox()->settingsManager()->appSettings()->savePath()->setRawValue(_savedSavePath);
+        qgcApp()->toolbox()->terrainQueryManager()->setOnlineLookupEnabled(true);
+        qgcApp()->toolbox()->terrainQueryManager()->clearCache();
+        delete _terrainDir;
+        _terrainDir = NULL;
+    }
 }
 
 void SurveyMissionItemTest::_testDirty(void)
@@ -75,7 +90,8 @@ void SurveyMissionItemTest::_testDirty(void)
     // These facts should set dirty when changed
     QList<Fact*> rgFacts;
     rgFacts << _surveyItem->gridAltitude() << _surveyItem->gridAngle() << _surveyItem->gridSpacing() << _surveyItem->turnaroundDist() << _surveyItem->cameraTriggerDistance() <<
-               _surveyItem->gridAltitudeRelative() << _surveyItem->cameraTriggerInTurnaround() << _surveyItem->hoverAndCapture();
+               _surveyItem->gridAltitudeRelative() << _surveyItem->cameraTriggerInTurnaround() << _surveyItem->hoverAndCapture() <<
+               _surveyItem->terrainFollow() << _surveyItem->terrainFollowTolerance();
     foreach(Fact* fact, rgFacts) {
         qDebug() << fact->name();
         QVERIFY(!_surveyItem->dirty());
@@ -251,3 +267,139 @@ void SurveyMissionItemTest::_testEntryLocation(void)
         rgSeenEntryCoords.clear();
     }
 }
+
+void SurveyMissionItemTest::_testTerrainProfileSimplify(void)
+{
+    QList<double> distances;
+    QList<double> elevations;
+
+    // Flat profile only needs the end points
+    for (int i=0; i<20; i++) {
+        distances << i * 10.0;
+        elevations << 100.0;
+    }
+    QList<int> keptIndices = SurveyMissionItem::simplifyTerrainProfile(distances, elevations, 1.0);
+    QCOMPARE(keptIndices.count(), 2);
+    QCOMPARE(keptIndices.first(), 0);
+    QCOMPARE(keptIndices.last(), 19);
+
+    // Single ridge in the middle
+    elevations[10] = 120.0;
+    keptIndices = SurveyMissionItem::simplifyTerrainProfile(distances, elevations, 1.0);
+    QVERIFY(keptIndices.contains(10));
+
+    // Arbitrary profile: interpolation between kept points must stay within tolerance everywhere
+    elevations.clear();
+    for (int i=0; i<distances.count(); i++) {
+        elevations << 100.0 + 15.0 * sin(i / 3.0) + (i % 4);
+    }
+    for (double tolerance=0.5; tolerance<=8.0; tolerance *= 2) {
+        keptIndices = SurveyMissionItem::simplifyTerrainProfile(distances, elevations, tolerance);
+        QCOMPARE(keptIndices.first(), 0);
+        QCOMPARE(keptIndices.last(), distances.count() - 1);
+        for (int k=1; k<keptIndices.count(); k++) {
+            int first = keptIndices[k - 1];
+            int last = keptIndices[k];
+            for (int i=first + 1; i<last; i++) {
+                double fraction = (distances[i] - distances[first]) / (distances[last] - distances[first]);
+                double interpolated = elevations[first] + fraction * (elevations[last] - elevations[first]);
+                QVERIFY(fabs(elevations[i] - interpolated) <= tolerance);
+            }
+        }
+    }
+
+    // Larger tolerance never needs more points
+    QVERIFY(SurveyMissionItem::simplifyTerrainProfile(distances, elevations, 8.0).count() <= SurveyMissionItem::simplifyTerrainProfile(distances, elevations, 0.5).count());
+}
+
+void SurveyMissionItemTest::_testTerrainFollow(void)
+{
+    // Mock terrain: a 3x3 post tile over N47E008 which is flat at 0m except for a 1000m peak at 47.5N 8.5E.
+    // It is placed in the terrain directory of a temporary save path so it is picked up by the toolbox TerrainQueryManager.
+    _terrainDir = new QTemporaryDir();
+    QVERIFY(_terrainDir->isValid());
+
+    AppSettings* appSettings = qgcApp()->toolbox()->settingsManager()->appSettings();
+    _savedSavePath = appSettings->savePath()->rawValue();
+    appSettings->savePath()->setRawValue(_terrainDir->path());
+    QVERIFY(QDir().mkpath(appSettings->terrainSavePath()));
+
+    QFile hgtFile(QDir(appSettings->terrainSavePath()).filePath(QStringLiteral("N47E008.hgt")));
+    QVERIFY(hgtFile.open(QIODevice::WriteOnly));
+    for (int i=0; i<9; i++) {
+        qint16 bigEndian = qToBigEndian((qint16)(i == 4 ? 1000 : 0));
+        hgtFile.write(reinterpret_cast<const char*>(&bigEndian), sizeof(bigEndian));
+    }
+    hgtFile.close();
+
+    TerrainQueryManager* terrainQueryManager = qgcApp()->toolbox()->terrainQueryManager();
+    terrainQueryManager->setOnlineLookupEnabled(false);
+    terrainQueryManager->clearCache();
+
+    // Independent lookup of the same terrain for the expected altitudes
+    TerrainTileManager tileManager;
+    tileManager.setDirectories(appSettings->terrainSavePath(), QDir(_terrainDir->path()).filePath(QStringLiteral("cache")));
+
+    // Grid over the peak so that transects cross the ridge lines and need terrain follow waypoints
+    const double gridAltitude = 50;
+    QGeoCoordinate peak(47.5, 8.5);
+    for (double azimuth=45; azimuth<360; azimuth+=90) {
+        _mapPolygon->appendVertex(peak.atDistanceAndAzimuth(200, azimuth));
+    }
+    _surveyItem->setSequenceNumber(1);
+    _surveyItem->gridAltitude()->setRawValue(gridAltitude);
+    _surveyItem->gridAltitudeRelative()->setRawValue(true);
+    _surveyItem->terrainFollowTolerance()->setRawValue(1.0);
+
+    // Fixed altitude grid for reference
+    QList<MissionItem*> items;
+    _surveyItem->appendMissionItems(items, this);
+    QVERIFY(items.count() > 0);
+    QCOMPARE(items.count(), _surveyItem->lastSequenceNumber() - _surveyItem->sequenceNumber() + 1);
+    int fixedItemCount = items.count();
+    int fixedWaypointCount = 0;
+    foreach (MissionItem* item, items) {
+        if (item->command() == MAV_CMD_NAV_WAYPOINT) {
+            QCOMPARE(item->frame(), MAV_FRAME_GLOBAL_RELATIVE_ALT);
+            QCOMPARE(item->param7(), gridAltitude);
+            fixedWaypointCount++;
+        }
+    }
+    qDeleteAll(items);
+    items.clear();
+
+    _surveyItem->terrainFollow()->setRawValue(true);
+    QTRY_VERIFY_WITH_TIMEOUT(_surveyItem->terrainDataReady(), 10000);
+    QVERIFY(!_surveyItem->coordinateHasRelativeAltitude());
+    QVERIFY(!_surveyItem->exitCoordinateHasRelativeAltitude());
+
+    _surveyItem->appendMissionItems(items, this);
+
+    // Terrain follow only inserts waypoints, sequence numbers stay contiguous and match lastSequenceNumber
+    QCOMPARE(items.count(), _surveyItem->lastSequenceNumber() - _surveyItem->sequenceNumber() + 1);
+    int waypointCount = 0;
+    QList<QGeoCoordinate> waypoints;
+    for (int i=0; i<items.count(); i++) {
+        MissionItem* item = items[i];
+        QCOMPARE(item->sequenceNumber(), _surveyItem->sequenceNumber() + i);
+        if (item->command() == MAV_CMD_NAV_WAYPOINT) {
+            // Altitudes are AMSL
+            QCOMPARE(item->frame(), MAV_FRAME_GLOBAL);
+            waypoints.append(QGeoCoordinate(item->param5(), item->param6(), item->param7()));
+            waypointCount++;
+        }
+    }
+    QVERIFY(waypointCount > fixedWaypointCount);
+    QCOMPARE(items.count() - fixedItemCount, waypointCount - fixedWaypointCount);
+
+    // Each waypoint flies at grid altitude above the terrain below it. Terrain lookups are cached at SRTM1 resolution
+    // which on this slope is worth less than a meter.
+    QList<float> elevations;
+    QVERIFY(tileManager.elevations(waypoints, elevations));
+    for (int i=0; i<waypoints.count(); i++) {
+        QVERIFY2(fabs(waypoints[i].altitude() - (elevations[i] + gridAltitude)) < 1.5, qPrintable(QStringLiteral("%1 %2").arg(waypoints[i].altitude()).arg(elevations[i])));
+    }
+    QCOMPARE(_surveyItem->coordinate().altitude(), waypoints.first().altitude());
+
+    qDeleteAll(items);
+}
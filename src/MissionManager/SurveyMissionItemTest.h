@@ -17,6 +17,7 @@
 #include "SurveyMissionItem.h"
 
 #include <QGeoCoordinate>
+#include <QTemporaryDir>
 
 /// Unit test for SurveyMissionItem
 class SurveyMissionItemTest : public UnitTest
@@ -36,6 +37,8 @@ private slots:
     void _testCameraTrigger(void);
     void _testGridAngle(void);
     void _testEntryLocation(void);
+    void _testTerrainProfileSimplify(void);
+    void _testTerrainFollow(void);
 
 private:
     double _clampGridAngle180(double gridAngle);
@@ -73,6 +76,8 @@ private:
     SurveyMissionItem*      _surveyItem;
     QGCMapPolygon*          _mapPolygon;
     QList<QGeoCoordinate>   _polyPoints;
+    QTemporaryDir*          _terrainDir;        ///< Mock terrain save path, NULL if not in use
+    QVariant                _savedSavePath;
 };
 
 #endif
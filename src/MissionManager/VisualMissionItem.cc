@@ -161,7 +161,7 @@ void VisualMissionItem::_updateTerrainAltitude(void)
 void VisualMissionItem::_reallyUpdateTerrainAltitude(void)
 {
     QGeoCoordinate coord = coordinate();
-    if (coord.isValid() && (qIsNaN(_terrainAltitude) || !qFuzzyCompare(_lastLatTerrainQuery, coord.latitude()) || qFuzzyCompare(_lastLonTerrainQuery, coord.longitude()))) {
+    if (coord.isValid() && (qIsNaN(_terrainAltitude) || !qFuzzyCompare(_lastLatTerrainQuery, coord.latitude()) || !qFuzzyCompare(_lastLonTerrainQuery, coord.longitude()))) {
         _lastLatTerrainQuery = coord.latitude();
         _lastLonTerrainQuery = coord.longitude();
         ElevationProvider* terrain = new ElevationProvider(this);
@@ -177,6 +177,6 @@ void VisualMissionItem::_terrainDataReceived(bool success, QList<float> altitude
     if (success) {
         _terrainAltitude = altitudes[0];
         emit terrainAltitudeChanged(_terrainAltitude);
-        sender()->deleteLater();
     }
+    sender()->deleteLater();
 }
@@ -954,6 +954,29 @@ Rectangle {
                 fact:               missionItem.gridAltitudeRelative
                 Layout.columnSpan:  2
             }
+
+            FactCheckBox {
+                id:                 terrainFollowCheckBox
+                text:               qsTr("仿地飞行")
+                fact:               missionItem.terrainFollow
+                Layout.columnSpan:  2
+            }
+
+            QGCLabel {
+                text:       qsTr("仿地容差")
+                visible:    terrainFollowCheckBox.checked
+            }
+            FactTextField {
+                fact:               missionItem.terrainFollowTolerance
+                visible:            terrainFollowCheckBox.checked
+                Layout.fillWidth:   true
+            }
+
+            QGCLabel {
+                text:               missionItem.terrainDataReady ? qsTr("地形数据已加载") : qsTr("无地形数据，使用固定高度")
+                visible:            terrainFollowCheckBox.checked
+                Layout.columnSpan:  2
+            }
         }
 
         SectionHeader {
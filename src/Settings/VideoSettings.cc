@@ -28,6 +28,12 @@ const char* VideoSettings::videoGridLinesName =     "VideoGridLines";
 const char* VideoSettings::showRecControlName =     "ShowRecControl";
 const char* VideoSettings::recordingFormatName =    "RecordingFormat";
 const char* VideoSettings::maxVideoSizeName =       "MaxVideoSize";
+const char* VideoSettings::segmentDurationName =    "VideoSegmentDuration";
+const char* VideoSettings::lowLatencyModeName =     "VideoLowLatencyMode";
+const char* VideoSettings::jitterBufferName =       "VideoJitterBuffer";
+const char* VideoSettings::fleetStreamsName =       "VideoFleetStreams";
+const char* VideoSettings::streamMemoryBudgetName = "VideoStreamMemoryBudget";
+const char* VideoSettings::streamCpuBudgetName =    "VideoStreamCpuBudget";
 
 const char* VideoSettings::videoSourceNoVideo =     "No Video Available";
 const char* VideoSettings::videoDisabled =          "Video Stream Disabled";
@@ -46,6 +52,12 @@ VideoSettings::VideoSettings(QObject* parent)
     , _showRecControlFact(NULL)
     , _recordingFormatFact(NULL)
     , _maxVideoSizeFact(NULL)
+    , _segmentDurationFact(NULL)
+    , _lowLatencyModeFact(NULL)
+    , _jitterBufferFact(NULL)
+    , _fleetStreamsFact(NULL)
+    , _streamMemoryBudgetFact(NULL)
+    , _streamCpuBudgetFact(NULL)
 {
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
     qmlRegisterUncreatableType<VideoSettings>("QGroundControl.SettingsManager", 1, 0, "VideoSettings", "Reference only");
@@ -166,3 +178,57 @@ Fact* VideoSettings::maxVideoSize(void)
 
     return _maxVideoSizeFact;
 }
+
+Fact* VideoSettings::segmentDuration(void)
+{
+    if (!_segmentDurationFact) {
+        _segmentDurationFact = _createSettingsFact(segmentDurationName);
+    }
+
+    return _segmentDurationFact;
+}
+
+Fact* VideoSettings::lowLatencyMode(void)
+{
+    if (!_lowLatencyModeFact) {
+        _lowLatencyModeFact = _createSettingsFact(lowLatencyModeName);
+    }
+
+    return _lowLatencyModeFact;
+}
+
+Fact* VideoSettings::jitterBuffer(void)
+{
+    if (!_jitterBufferFact) {
+        _jitterBufferFact = _createSettingsFact(jitterBufferName);
+    }
+
+    return _jitterBufferFact;
+}
+
+Fact* VideoSettings::fleetStreams(void)
+{
+    if (!_fleetStreamsFact) {
+        _fleetStreamsFact = _createSettingsFact(fleetStreamsName);
+    }
+
+    return _fleetStreamsFact;
+}
+
+Fact* VideoSettings::streamMemoryBudget(void)
+{
+    if (!_streamMemoryBudgetFact) {
+        _streamMemoryBudgetFact = _createSettingsFact(streamMemoryBudgetName);
+    }
+
+    return _streamMemoryBudgetFact;
+}
+
+Fact* VideoSettings::streamCpuBudget(void)
+{
+    if (!_streamCpuBudgetFact) {
+        _streamCpuBudgetFact = _createSettingsFact(streamCpuBudgetName);
+    }
+
+    return _streamCpuBudgetFact;
+}
@@ -28,6 +28,12 @@ public:
     Q_PROPERTY(Fact* showRecControl     READ showRecControl     CONSTANT)
     Q_PROPERTY(Fact* recordingFormat    READ recordingFormat    CONSTANT)
     Q_PROPERTY(Fact* maxVideoSize       READ maxVideoSize       CONSTANT)
+    Q_PROPERTY(Fact* segmentDuration    READ segmentDuration    CONSTANT)
+    Q_PROPERTY(Fact* lowLatencyMode     READ lowLatencyMode     CONSTANT)
+    Q_PROPERTY(Fact* jitterBuffer       READ jitterBuffer       CONSTANT)
+    Q_PROPERTY(Fact* fleetStreams       READ fleetStreams       CONSTANT)
+    Q_PROPERTY(Fact* streamMemoryBudget READ streamMemoryBudget CONSTANT)
+    Q_PROPERTY(Fact* streamCpuBudget    READ streamCpuBudget    CONSTANT)
 
     Fact* videoSource       (void);
     Fact* udpPort           (void);
@@ -38,6 +44,12 @@ public:
     Fact* showRecControl    (void);
     Fact* recordingFormat   (void);
     Fact* maxVideoSize      (void);
+    Fact* segmentDuration   (void);
+    Fact* lowLatencyMode    (void);
+    Fact* jitterBuffer      (void);
+    Fact* fleetStreams      (void);
+    Fact* streamMemoryBudget(void);
+    Fact* streamCpuBudget   (void);
 
     static const char* videoSettingsGroupName;
 
@@ -50,6 +62,12 @@ public:
     static const char* showRecControlName;
     static const char* recordingFormatName;
     static const char* maxVideoSizeName;
+    static const char* segmentDurationName;
+    static const char* lowLatencyModeName;
+    static const char* jitterBufferName;
+    static const char* fleetStreamsName;
+    static const char* streamMemoryBudgetName;
+    static const char* streamCpuBudgetName;
 
     static const char* videoSourceNoVideo;
     static const char* videoDisabled;
@@ -67,6 +85,12 @@ private:
     SettingsFact* _showRecControlFact;
     SettingsFact* _recordingFormatFact;
     SettingsFact* _maxVideoSizeFact;
+    SettingsFact* _segmentDurationFact;
+    SettingsFact* _lowLatencyModeFact;
+    SettingsFact* _jitterBufferFact;
+    SettingsFact* _fleetStreamsFact;
+    SettingsFact* _streamMemoryBudgetFact;
+    SettingsFact* _streamCpuBudgetFact;
 };
 
 #endif
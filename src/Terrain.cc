@@ -8,7 +8,19 @@
  ****************************************************************************/
 
 #include "Terrain.h"
+#include "TerrainTile.h"
+#include "QGCApplication.h"
+#include "SettingsManager.h"
 
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <QtMath>
 #include <QUrl>
 #include <QUrlQuery>
 #include <QNetworkRequest>
@@ -18,81 +30,594 @@
 #include <QJsonObject>
 #include <QJsonArray>
 
-ElevationProvider::ElevationProvider(QObject* parent)
-    : QObject(parent)
+TerrainTileManager::TerrainTileManager(QObject* parent)
+    : QObject           (parent)
+    , _scanned          (false)
+    , _maxMappedTiles   (_defaultMaxMappedTiles)
 {
 
 }
 
-bool ElevationProvider::queryTerrainData(const QList<QGeoCoordinate>& coordinates)
+TerrainTileManager::~TerrainTileManager()
 {
-    if (_state != State::Idle || coordinates.length() == 0) {
-        return false;
+
+}
+
+QString TerrainTileManager::defaultCacheDirectory(void)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/QGCTerrainCache");
+}
+
+void TerrainTileManager::setDirectories(const QString& sourceDirectory, const QString& cacheDirectory)
+{
+    QMutexLocker locker(&_mutex);
+
+    if (sourceDirectory != _sourceDirectory || cacheDirectory != _cacheDirectory) {
+        _sourceDirectory = sourceDirectory;
+        _cacheDirectory = cacheDirectory;
+        _scanned = false;
     }
+}
 
-    QUrlQuery query;
-    QString points = "";
-    for (const auto& coordinate : coordinates) {
-        points += QString::number(coordinate.latitude(), 'f', 10) + ","
-                + QString::number(coordinate.longitude(), 'f', 10) + ",";
+void TerrainTileManager::rescan(void)
+{
+    QMutexLocker locker(&_mutex);
+    _scanned = false;
+}
+
+void TerrainTileManager::setMaxMappedTiles(int maxMappedTiles)
+{
+    QMutexLocker locker(&_mutex);
+    _maxMappedTiles = qMax(1, maxMappedTiles);
+}
+
+int TerrainTileManager::coveredCellCount(void)
+{
+    QMutexLocker locker(&_mutex);
+    _scanIfNeeded();
+    return _cellToPaths.count();
+}
+
+quint32 TerrainTileManager::_cellKey(double latitude, double longitude)
+{
+    int lat = qFloor(latitude) + 90;
+    int lon = qFloor(longitude) + 180;
+    return (quint32)(lat * 361 + lon);
+}
+
+/// Must be called with _mutex held
+void TerrainTileManager::_indexTile(const TerrainTilePtr& tile)
+{
+    // Register the tile with every 1x1 degree cell it overlaps. Tiles sharing an edge will be registered with
+    // the neighbouring cell as well which is what we want since either one can answer queries on the edge.
+    for (int lat=qFloor(tile->southLat()); lat<=qFloor(tile->northLat()); lat++) {
+        for (int lon=qFloor(tile->westLon()); lon<=qFloor(tile->eastLon()); lon++) {
+            QStringList& paths = _cellToPaths[_cellKey(lat, lon)];
+            if (!paths.contains(tile->path())) {
+                paths.append(tile->path());
+            }
+        }
     }
-    points = points.mid(0, points.length() - 1); // remove the last ','
+}
 
-    query.addQueryItem(QStringLiteral("points"), points);
-    QUrl url(QStringLiteral("https://api.airmap.com/elevation/stage/srtm1/ele"));
-    url.setQuery(query);
+/// Must be called with _mutex held
+void TerrainTileManager::_scanIfNeeded(void)
+{
+    if (_scanned) {
+        return;
+    }
+    _scanned = true;
 
-    QNetworkRequest request(url);
+    _cellToPaths.clear();
+    _mappedTiles.clear();
+    _mappedTilesLRU.clear();
 
-    QNetworkProxy tProxy;
-    tProxy.setType(QNetworkProxy::DefaultProxy);
-    _networkManager.setProxy(tProxy);
+    if (_sourceDirectory.isEmpty() || !QDir(_sourceDirectory).exists()) {
+        return;
+    }
+    if (!_cacheDirectory.isEmpty()) {
+        QDir().mkpath(_cacheDirectory);
+    }
 
-    QNetworkReply* networkReply = _networkManager.get(request);
-    if (!networkReply) {
-        return false;
+    QStringList nameFilters;
+    nameFilters << QStringLiteral("*.%1").arg(TerrainTile::hgtFileExtension)
+                << QStringLiteral("*.%1").arg(TerrainTile::cacheFileExtension)
+                << QStringLiteral("*.tif") << QStringLiteral("*.tiff");
+
+    QDirIterator it(_sourceDirectory, nameFilters, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QString path = it.next();
+        QFileInfo fileInfo(path);
+        QString suffix = fileInfo.suffix().toLower();
+
+        if (suffix == QLatin1String("tif") || suffix == QLatin1String("tiff")) {
+            if (_cacheDirectory.isEmpty()) {
+                continue;
+            }
+
+            // Cache file name is keyed by source path, size and modification time so edited sources are reconverted
+            QByteArray key = QString("%1:%2:%3").arg(fileInfo.absoluteFilePath()).arg(fileInfo.size()).arg(fileInfo.lastModified().toMSecsSinceEpoch()).toUtf8();
+            QString hash = QCryptographicHash::hash(key, QCryptographicHash::Md5).toHex().left(12);
+            QString cachePath = QDir(_cacheDirectory).filePath(QStringLiteral("%1-%2.%3").arg(fileInfo.completeBaseName()).arg(hash).arg(TerrainTile::cacheFileExtension));
+
+            if (!QFile::exists(cachePath)) {
+                QString errorString;
+                if (!TerrainTile::importGeoTiff(path, cachePath, errorString)) {
+                    qCWarning(TerrainTileLog) << "Unable to import GeoTIFF" << path << errorString;
+                    continue;
+                }
+                qCDebug(TerrainTileLog) << "Imported GeoTIFF" << path << "to" << cachePath;
+            }
+            path = cachePath;
+        }
+
+        TerrainTilePtr tile = _tile(path);
+        if (tile) {
+            _indexTile(tile);
+        }
     }
 
-    connect(networkReply, &QNetworkReply::finished, this, &ElevationProvider::_requestFinished);
+    qCDebug(TerrainTileLog) << "Terrain tiles cover" << _cellToPaths.count() << "cells";
+}
 
-    _state = State::Downloading;
-    return true;
+/// Returns the mapped tile for the specified path, mapping it if needed. Must be called with _mutex held.
+TerrainTileManager::TerrainTilePtr TerrainTileManager::_tile(const QString& path)
+{
+    if (_mappedTiles.contains(path)) {
+        _mappedTilesLRU.removeOne(path);
+        _mappedTilesLRU.append(path);
+        return _mappedTiles[path];
+    }
+
+    TerrainTilePtr tile(new TerrainTile(path));
+    if (!tile->isValid()) {
+        return TerrainTilePtr();
+    }
+
+    // Evicted tiles stay mapped until the last in flight query using them releases its reference
+    while (_mappedTilesLRU.count() >= _maxMappedTiles) {
+        _mappedTiles.remove(_mappedTilesLRU.takeFirst());
+    }
+    _mappedTiles[path] = tile;
+    _mappedTilesLRU.append(path);
+
+    return tile;
 }
 
-void ElevationProvider::_requestFinished()
+bool TerrainTileManager::elevations(const QList<QGeoCoordinate>& coordinates, QList<float>& altitudes)
+{
+    const int count = coordinates.count();
+
+    // Group coordinates by the tile which covers them so each tile is interpolated as a single batch
+    QHash<TerrainTile*, QVector<int> >  tileToIndices;
+    QList<TerrainTilePtr>               tiles;
+    QVector<float>                      rgAltitudes(count, qQNaN());
+
+    {
+        QMutexLocker locker(&_mutex);
+        _scanIfNeeded();
+
+        for (int i=0; i<count; i++) {
+            const QGeoCoordinate& coord = coordinates[i];
+            if (!coord.isValid()) {
+                continue;
+            }
+
+            const QStringList paths = _cellToPaths.value(_cellKey(coord.latitude(), coord.longitude()));
+            foreach (const QString& path, paths) {
+                TerrainTilePtr tile = _tile(path);
+                if (tile && tile->contains(coord.latitude(), coord.longitude())) {
+                    if (!tileToIndices.contains(tile.data())) {
+                        tiles.append(tile);
+                    }
+                    tileToIndices[tile.data()].append(i);
+                    break;
+                }
+            }
+        }
+    }
+
+    foreach (const TerrainTilePtr& tile, tiles) {
+        const QVector<int>& indices = tileToIndices[tile.data()];
+        const int tileCount = indices.count();
+
+        QVector<double> rgLat(tileCount);
+        QVector<double> rgLon(tileCount);
+        QVector<float>  rgTileAltitudes(tileCount);
+        for (int i=0; i<tileCount; i++) {
+            rgLat[i] = coordinates[indices[i]].latitude();
+            rgLon[i] = coordinates[indices[i]].longitude();
+        }
+
+        tile->elevations(rgLat.constData(), rgLon.constData(), rgTileAltitudes.data(), tileCount);
+
+        for (int i=0; i<tileCount; i++) {
+            rgAltitudes[indices[i]] = rgTileAltitudes[i];
+        }
+    }
+
+    bool complete = count > 0;
+    altitudes.clear();
+    altitudes.reserve(count);
+    for (int i=0; i<count; i++) {
+        if (qIsNaN(rgAltitudes[i])) {
+            complete = false;
+        }
+        altitudes.append(rgAltitudes[i]);
+    }
+
+    return complete;
+}
+
+const double TerrainQueryManager::cacheResolutionDegrees = 1.0 / 3600.0;
+
+TerrainQueryManager::TerrainQueryManager(QGCApplication* app, QGCToolbox* toolbox)
+    : QGCTool               (app, toolbox)
+    , _tileManager          (new TerrainTileManager(this))
+    , _nextQueryId          (0)
+    , _maxCacheEntries      (_defaultMaxCacheEntries)
+    , _onlineLookupEnabled  (true)
+    , _cacheHits            (0)
+    , _cacheMisses          (0)
+    , _lookupCount          (0)
+{
+    _coalesceTimer.setSingleShot(true);
+    _coalesceTimer.setInterval(_defaultCoalesceMsecs);
+    connect(&_coalesceTimer, &QTimer::timeout, this, &TerrainQueryManager::_dispatchQueries);
+}
+
+TerrainQueryManager::TerrainQueryManager(TerrainTileManager* tileManager)
+    : QGCTool               (NULL, NULL)
+    , _tileManager          (tileManager)
+    , _nextQueryId          (0)
+    , _maxCacheEntries      (_defaultMaxCacheEntries)
+    , _onlineLookupEnabled  (true)
+    , _cacheHits            (0)
+    , _cacheMisses          (0)
+    , _lookupCount          (0)
+{
+    _coalesceTimer.setSingleShot(true);
+    _coalesceTimer.setInterval(_defaultCoalesceMsecs);
+    connect(&_coalesceTimer, &QTimer::timeout, this, &TerrainQueryManager::_dispatchQueries);
+}
+
+TerrainQueryManager::~TerrainQueryManager()
+{
+    // Local lookups reference the tile manager from the thread pool, they must be done before it goes away
+    foreach (QFutureWatcherBase* watcher, findChildren<QFutureWatcherBase*>()) {
+        watcher->waitForFinished();
+    }
+}
+
+void TerrainQueryManager::setToolbox(QGCToolbox* toolbox)
+{
+    QGCTool::setToolbox(toolbox);
+
+    connect(toolbox->settingsManager()->appSettings(), &AppSettings::savePathsChanged, this, &TerrainQueryManager::_updateDirectories);
+    _updateDirectories();
+}
+
+void TerrainQueryManager::_updateDirectories(void)
+{
+    _tileManager->setDirectories(_toolbox->settingsManager()->appSettings()->terrainSavePath(), TerrainTileManager::defaultCacheDirectory());
+}
+
+double TerrainQueryManager::cacheHitRate(void) const
+{
+    quint64 total = _cacheHits + _cacheMisses;
+    return total ? (double)_cacheHits / total : 0.0;
+}
+
+void TerrainQueryManager::resetStatistics(void)
+{
+    _cacheHits = 0;
+    _cacheMisses = 0;
+    _lookupCount = 0;
+}
+
+void TerrainQueryManager::clearCache(void)
+{
+    // Entries pinned by waiting queries are kept
+    QQueue<quint64> pinnedOrder;
+    foreach (quint64 key, _cacheOrder) {
+        if (_pinnedKeys.contains(key)) {
+            pinnedOrder.enqueue(key);
+        } else {
+            _cache.remove(key);
+        }
+    }
+    _cacheOrder = pinnedOrder;
+}
+
+quint64 TerrainQueryManager::_coordinateKey(const QGeoCoordinate& coordinate)
+{
+    quint64 lat = (quint64)qRound((coordinate.latitude() + 90.0) / cacheResolutionDegrees);
+    quint64 lon = (quint64)qRound((coordinate.longitude() + 180.0) / cacheResolutionDegrees);
+    return (lat << 32) | lon;
+}
+
+void TerrainQueryManager::addQuery(ElevationProvider* provider, const QList<QGeoCoordinate>& coordinates)
+{
+    QueuedQuery query;
+    query.provider = provider;
+    query.unresolvedKeys = 0;
+    query.failed = false;
+    query.keys.reserve(coordinates.count());
+    foreach (const QGeoCoordinate& coordinate, coordinates) {
+        query.keys.append(_coordinateKey(coordinate));
+    }
+    _pendingQueries.append(query);
+
+    // Keep the stored coordinate for each key so that we know what to look up once the window closes
+    for (int i=0; i<coordinates.count(); i++) {
+        _pendingCoordinates.insert(query.keys[i], coordinates[i]);
+    }
+
+    if (!_coalesceTimer.isActive()) {
+        _coalesceTimer.start();
+    }
+}
+
+void TerrainQueryManager::_dispatchQueries(void)
+{
+    QList<KeyedCoordinate> misses;
+
+    foreach (QueuedQuery query, _pendingQueries) {
+        int queryId = _nextQueryId++;
+
+        QSet<quint64> queryKeys;
+        foreach (quint64 key, query.keys) {
+            if (_cache.contains(key)) {
+                _cacheHits++;
+            } else {
+                _cacheMisses++;
+            }
+            if (queryKeys.contains(key)) {
+                continue;
+            }
+            queryKeys.insert(key);
+
+            // Pin the key so the result can't be evicted before this query completes
+            _pinnedKeys[key]++;
+
+            if (_cache.contains(key)) {
+                continue;
+            }
+            if (!_keyWaiters.contains(key)) {
+                // Not already being looked up for an earlier query
+                misses.append(qMakePair(key, _pendingCoordinates.value(key)));
+            }
+            _keyWaiters[key].append(queryId);
+            query.unresolvedKeys++;
+        }
+
+        _waitingQueries.insert(queryId, query);
+        if (query.unresolvedKeys == 0) {
+            // Fully served from cache
+            _completedQueryIds.append(queryId);
+        }
+    }
+
+    _pendingQueries.clear();
+    _pendingCoordinates.clear();
+
+    qCDebug(TerrainTileLog) << "Terrain queries dispatched: misses" << misses.count() << "hit rate" << cacheHitRate();
+
+    for (int i=0; i<misses.count(); i+=_maxLocalBatchSize) {
+        _queryLocal(misses.mid(i, _maxLocalBatchSize));
+    }
+
+    _completeQueries();
+}
+
+void TerrainQueryManager::_queryLocal(const QList<KeyedCoordinate>& batch)
+{
+    typedef QList<float> LocalResult;
+
+    _lookupCount++;
+
+    QList<QGeoCoordinate> coordinates;
+    foreach (const KeyedCoordinate& keyedCoordinate, batch) {
+        coordinates.append(keyedCoordinate.second);
+    }
+
+    TerrainTileManager* tileManager = _tileManager;
+    QFutureWatcher<LocalResult>* watcher = new QFutureWatcher<LocalResult>(this);
+    connect(watcher, &QFutureWatcher<LocalResult>::finished, this, [this, watcher, batch]() {
+        LocalResult altitudes = watcher->result();
+        watcher->deleteLater();
+        _localBatchFinished(batch, altitudes);
+    });
+    watcher->setFuture(QtConcurrent::run([tileManager, coordinates]() {
+        LocalResult altitudes;
+        tileManager->elevations(coordinates, altitudes);
+        return altitudes;
+    }));
+}
+
+void TerrainQueryManager::_localBatchFinished(const QList<KeyedCoordinate>& batch, const QList<float>& altitudes)
+{
+    QList<KeyedCoordinate> notCovered;
+
+    for (int i=0; i<batch.count(); i++) {
+        float altitude = i < altitudes.count() ? altitudes[i] : qQNaN();
+        if (qIsNaN(altitude)) {
+            notCovered.append(batch[i]);
+        } else {
+            _cacheElevation(batch[i].first, altitude);
+        }
+    }
+
+    if (notCovered.count()) {
+        if (_onlineLookupEnabled) {
+            for (int i=0; i<notCovered.count(); i+=_maxOnlineBatchSize) {
+                _onlineBatches.append(notCovered.mid(i, _maxOnlineBatchSize));
+            }
+            _sendOnlineBatches();
+        } else {
+            _lookupFailed(notCovered);
+        }
+    }
+
+    _completeQueries();
+}
+
+void TerrainQueryManager::_sendOnlineBatches(void)
+{
+    while (_onlineRequests.count() < _maxOnlineRequests && _onlineBatches.count()) {
+        QList<KeyedCoordinate> batch = _onlineBatches.takeFirst();
+
+        QUrlQuery query;
+        QString points = "";
+        foreach (const KeyedCoordinate& keyedCoordinate, batch) {
+            points += QString::number(keyedCoordinate.second.latitude(), 'f', 10) + ","
+                    + QString::number(keyedCoordinate.second.longitude(), 'f', 10) + ",";
+        }
+        points = points.mid(0, points.length() - 1); // remove the last ','
+
+        query.addQueryItem(QStringLiteral("points"), points);
+        QUrl url(QStringLiteral("https://api.airmap.com/elevation/stage/srtm1/ele"));
+        url.setQuery(query);
+
+        QNetworkRequest request(url);
+
+        QNetworkProxy tProxy;
+        tProxy.setType(QNetworkProxy::DefaultProxy);
+        _networkManager.setProxy(tProxy);
+
+        QNetworkReply* networkReply = _networkManager.get(request);
+        if (!networkReply) {
+            _lookupFailed(batch);
+            continue;
+        }
+
+        _lookupCount++;
+        _onlineRequests[networkReply] = batch;
+        connect(networkReply, &QNetworkReply::finished, this, &TerrainQueryManager::_onlineRequestFinished);
+    }
+}
+
+void TerrainQueryManager::_onlineRequestFinished(void)
 {
     QNetworkReply* reply = qobject_cast<QNetworkReply*>(QObject::sender());
-    QList<float> altitudes;
-    _state = State::Idle;
+    QList<KeyedCoordinate> batch = _onlineRequests.take(reply);
+    reply->deleteLater();
 
-    // When an error occurs we still end up here
-    if (reply->error() != QNetworkReply::NoError) {
-        QByteArray responseBytes = reply->readAll();
+    bool success = false;
+    QByteArray responseBytes = reply->readAll();
 
+    // When an error occurs we still end up here
+    if (reply->error() == QNetworkReply::NoError) {
         QJsonParseError parseError;
         QJsonDocument responseJson = QJsonDocument::fromJson(responseBytes, &parseError);
-        qDebug() << responseJson;
-        emit terrainData(false, altitudes);
-        return;
+        if (parseError.error == QJsonParseError::NoError) {
+            QJsonObject rootObject = responseJson.object();
+            QString status = rootObject["status"].toString();
+            const QJsonArray& dataArray = rootObject["data"].toArray();
+            if (status == "success" && dataArray.count() == batch.count()) {
+                for (int i = 0; i < dataArray.count(); i++) {
+                    _cacheElevation(batch[i].first, dataArray[i].toDouble());
+                }
+                success = true;
+            }
+        }
+    } else {
+        qCDebug(TerrainTileLog) << "Online terrain query failed" << reply->errorString();
     }
 
-    QByteArray responseBytes = reply->readAll();
+    if (!success) {
+        _lookupFailed(batch);
+    }
 
-    QJsonParseError parseError;
-    QJsonDocument responseJson = QJsonDocument::fromJson(responseBytes, &parseError);
-    if (parseError.error != QJsonParseError::NoError) {
-        emit terrainData(false, altitudes);
-        return;
+    _sendOnlineBatches();
+    _completeQueries();
+}
+
+void TerrainQueryManager::_lookupFailed(const QList<KeyedCoordinate>& batch)
+{
+    foreach (const KeyedCoordinate& keyedCoordinate, batch) {
+        _resolveKey(keyedCoordinate.first, false /* success */);
+    }
+}
+
+void TerrainQueryManager::_cacheElevation(quint64 key, float elevation)
+{
+    if (!_cache.contains(key)) {
+        // Evict oldest first, skipping entries pinned by waiting queries. If everything is pinned the cache is
+        // allowed to grow past its limit until those queries complete.
+        int unpinnedCandidates = _cacheOrder.count();
+        while (_cacheOrder.count() >= _maxCacheEntries && unpinnedCandidates-- > 0) {
+            quint64 oldestKey = _cacheOrder.dequeue();
+            if (_pinnedKeys.contains(oldestKey)) {
+                _cacheOrder.enqueue(oldestKey);
+            } else {
+                _cache.remove(oldestKey);
+            }
+        }
+        _cacheOrder.enqueue(key);
+    }
+    _cache[key] = elevation;
+
+    _resolveKey(key, true /* success */);
+}
+
+/// Updates the waiting queries which were waiting on the lookup of the specified key
+void TerrainQueryManager::_resolveKey(quint64 key, bool success)
+{
+    foreach (int queryId, _keyWaiters.take(key)) {
+        QueuedQuery& query = _waitingQueries[queryId];
+        if (!success) {
+            query.failed = true;
+        }
+        if (--query.unresolvedKeys == 0) {
+            _completedQueryIds.append(queryId);
+        }
     }
-    QJsonObject rootObject = responseJson.object();
-    QString status = rootObject["status"].toString();
-    if (status == "success") {
-        const QJsonArray& dataArray = rootObject["data"].toArray();
-        for (int i = 0; i < dataArray.count(); i++) {
-            altitudes.push_back(dataArray[i].toDouble());
+}
+
+/// Signals all waiting queries whose keys have all been resolved
+void TerrainQueryManager::_completeQueries(void)
+{
+    while (_completedQueryIds.count()) {
+        QueuedQuery completedQuery = _waitingQueries.take(_completedQueryIds.takeFirst());
+
+        QList<float> altitudes;
+        if (!completedQuery.failed) {
+            altitudes.reserve(completedQuery.keys.count());
+            foreach (quint64 key, completedQuery.keys) {
+                altitudes.append(_cache.value(key));
+            }
         }
 
-        emit terrainData(true, altitudes);
+        QSet<quint64> queryKeys;
+        foreach (quint64 key, completedQuery.keys) {
+            if (!queryKeys.contains(key)) {
+                queryKeys.insert(key);
+                if (--_pinnedKeys[key] == 0) {
+                    _pinnedKeys.remove(key);
+                }
+            }
+        }
+
+        if (completedQuery.provider) {
+            completedQuery.provider->_signalTerrainData(!completedQuery.failed, altitudes);
+        }
     }
-    emit terrainData(false, altitudes);
+}
+
+ElevationProvider::ElevationProvider(QObject* parent)
+    : QObject(parent)
+{
+
+}
+
+bool ElevationProvider::queryTerrainData(const QList<QGeoCoordinate>& coordinates)
+{
+    if (coordinates.length() == 0) {
+        return false;
+    }
+
+    qgcApp()->toolbox()->terrainQueryManager()->addQuery(this, coordinates);
+
+    return true;
 }
@@ -12,6 +12,19 @@
 #include <QObject>
 #include <QGeoCoordinate>
 #include <QNetworkAccessManager>
+#include <QMutex>
+#include <QHash>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QPointer>
+#include <QQueue>
+#include <QSet>
+#include <QTimer>
+
+#include "QGCToolbox.h"
+
+class TerrainTile;
+class QNetworkReply;
 
 /* usage example:
     ElevationProvider *p = new ElevationProvider();
@@ -23,6 +36,167 @@
     p->queryTerrainData(coordinates);
  */
 
+/// Offline terrain store built from local DEM files.
+///
+/// SRTM .hgt files and GeoTIFF DEMs are picked up from the source directory (AppSettings::terrainSavePath). GeoTIFF
+/// files are converted once into .qgcdem files in the cache directory. All tiles are accessed through memory maps and
+/// only a bounded number of them are kept mapped at any time.
+///
+/// All public methods are thread safe. Tiles are immutable and shared, so the interpolation itself runs outside of
+/// the lock and any number of queries can be served concurrently.
+class TerrainTileManager : public QObject
+{
+    Q_OBJECT
+public:
+    TerrainTileManager(QObject* parent = NULL);
+    ~TerrainTileManager();
+
+    /// Sets the directories to load tiles from. Changing directories causes a rescan on next query.
+    ///     @param sourceDirectory  User supplied .hgt/GeoTIFF files
+    ///     @param cacheDirectory   Location for converted .qgcdem files
+    void setDirectories(const QString& sourceDirectory, const QString& cacheDirectory);
+
+    /// Forces a rescan of the source directory on the next query
+    void rescan(void);
+
+    /// Maximum number of tiles kept mapped
+    void setMaxMappedTiles(int maxMappedTiles);
+
+    /// Synchronous batch elevation lookup.
+    ///     @param coordinates  Coordinates to look up
+    ///     @param altitudes    Filled with one elevation (meters AMSL) per coordinate, NaN where no local data is available
+    /// @return true: all coordinates were covered by local data
+    bool elevations(const QList<QGeoCoordinate>& coordinates, QList<float>& altitudes);
+
+    /// @return Number of 1x1 degree cells which have local terrain data
+    int coveredCellCount(void);
+
+    static QString defaultCacheDirectory(void);
+
+private:
+    typedef QSharedPointer<TerrainTile> TerrainTilePtr;
+
+    void            _scanIfNeeded   (void);
+    void            _indexTile      (const TerrainTilePtr& tile);
+    TerrainTilePtr  _tile           (const QString& path);
+
+    static quint32 _cellKey(double latitude, double longitude);
+
+    QMutex                          _mutex;
+    QString                         _sourceDirectory;
+    QString                         _cacheDirectory;
+    bool                            _scanned;
+    int                             _maxMappedTiles;
+    QHash<quint32, QStringList>     _cellToPaths;       ///< 1x1 degree cell -> tile files covering it
+    QHash<QString, TerrainTilePtr>  _mappedTiles;       ///< Currently mapped tiles keyed by path
+    QStringList                     _mappedTilesLRU;    ///< Most recently used at end
+
+    static const int _defaultMaxMappedTiles = 32;
+};
+
+
+class ElevationProvider;
+
+/// Central terrain query service.
+///
+/// Queries from all ElevationProviders are collected over a short coalescing window. Coordinates are deduplicated at DEM
+/// resolution and looked up in a result cache first. Remaining coordinates are looked up in the local TerrainTileManager
+/// in bounded batches on the thread pool, anything not covered locally is sent to the online service in bounded batches
+/// with a limited number of requests in flight. Results are fanned back out to each requesting ElevationProvider.
+///
+/// Cache entries needed by a dispatched query are pinned until the query completes, so eviction can never cause a
+/// query whose lookups all succeeded to report failure.
+class TerrainQueryManager : public QGCTool
+{
+    Q_OBJECT
+public:
+    TerrainQueryManager(QGCApplication* app, QGCToolbox* toolbox);
+
+    /// Creates a stand alone manager which is not part of the toolbox. Used by unit tests.
+    ///     @param tileManager Local terrain store to use
+    TerrainQueryManager(TerrainTileManager* tileManager);
+
+    ~TerrainQueryManager();
+
+    // Overrides from QGCTool
+    void setToolbox(QGCToolbox* toolbox) final;
+
+    /// Queues a query. The result is delivered through ElevationProvider::terrainData. If the provider is
+    /// destroyed before the query completes the result is dropped.
+    void addQuery(ElevationProvider* provider, const QList<QGeoCoordinate>& coordinates);
+
+    /// Sets the window over which queries are coalesced before being dispatched
+    void setCoalesceInterval(int msecs) { _coalesceTimer.setInterval(msecs); }
+
+    /// Disables the online fallback. Used by unit tests.
+    void setOnlineLookupEnabled(bool enabled) { _onlineLookupEnabled = enabled; }
+
+    /// Sets the maximum number of cached elevations. Used by unit tests.
+    void setMaxCacheEntries(int maxCacheEntries) { _maxCacheEntries = maxCacheEntries; }
+
+    quint64 cacheHits       (void) const { return _cacheHits; }
+    quint64 cacheMisses     (void) const { return _cacheMisses; }
+    double  cacheHitRate    (void) const;
+    quint64 lookupCount     (void) const { return _lookupCount; }   ///< Number of batches sent to local or online lookup
+    int     cacheCount      (void) const { return _cache.count(); }
+
+    void resetStatistics    (void);
+    void clearCache         (void);
+
+    static const double cacheResolutionDegrees;     ///< Coordinates closer than this share a cache entry (SRTM1 post spacing)
+
+private slots:
+    void _dispatchQueries       (void);
+    void _onlineRequestFinished (void);
+    void _updateDirectories     (void);
+
+private:
+    typedef QPair<quint64, QGeoCoordinate> KeyedCoordinate;
+
+    struct QueuedQuery {
+        QPointer<ElevationProvider> provider;
+        QVector<quint64>            keys;
+        int                         unresolvedKeys; ///< Number of distinct keys still being looked up
+        bool                        failed;         ///< true: at least one key could not be resolved
+    };
+
+    static quint64 _coordinateKey(const QGeoCoordinate& coordinate);
+
+    void _queryLocal            (const QList<KeyedCoordinate>& batch);
+    void _localBatchFinished    (const QList<KeyedCoordinate>& batch, const QList<float>& altitudes);
+    void _sendOnlineBatches     (void);
+    void _lookupFailed          (const QList<KeyedCoordinate>& batch);
+    void _cacheElevation        (quint64 key, float elevation);
+    void _resolveKey            (quint64 key, bool success);
+    void _completeQueries       (void);
+
+    TerrainTileManager*             _tileManager;
+    QTimer                          _coalesceTimer;
+    QList<QueuedQuery>              _pendingQueries;        ///< Queries waiting for the coalescing window to close
+    QHash<int, QueuedQuery>         _waitingQueries;        ///< Dispatched queries waiting for lookups to complete, keyed by query id
+    QList<int>                      _completedQueryIds;     ///< Waiting queries which have all keys resolved
+    int                             _nextQueryId;
+    QHash<quint64, QGeoCoordinate>  _pendingCoordinates;    ///< Coordinate to look up for each key of the pending queries
+    QHash<quint64, float>           _cache;
+    QQueue<quint64>                 _cacheOrder;            ///< Insertion order for eviction
+    int                             _maxCacheEntries;
+    QHash<quint64, int>             _pinnedKeys;            ///< Number of waiting queries referencing each key, pinned keys are never evicted
+    QHash<quint64, QList<int>>      _keyWaiters;            ///< Ids of the waiting queries for each key with an outstanding lookup
+    QList<QList<KeyedCoordinate>>   _onlineBatches;         ///< Batches waiting for an online request slot
+    QHash<QNetworkReply*, QList<KeyedCoordinate>> _onlineRequests;
+    QNetworkAccessManager           _networkManager;
+    bool                            _onlineLookupEnabled;
+
+    quint64                         _cacheHits;
+    quint64                         _cacheMisses;
+    quint64                         _lookupCount;
+
+    static const int _defaultCoalesceMsecs =    50;
+    static const int _maxLocalBatchSize =       1000;
+    static const int _maxOnlineBatchSize =      100;
+    static const int _maxOnlineRequests =       2;
+    static const int _defaultMaxCacheEntries =  200000;
+};
 
 class ElevationProvider : public QObject
 {
@@ -32,7 +206,8 @@ public:
 
     /**
      * Async elevation query for a list of lon,lat coordinates. When the query is done, the terrainData() signal
-     * is emitted.
+     * is emitted. Queries are routed through TerrainQueryManager so queries from many providers are coalesced
+     * and any number of queries may be outstanding at the same time.
      * @param coordinates
      * @return true on success
      */
@@ -41,15 +216,8 @@ public:
 signals:
     void terrainData(bool success, QList<float> altitudes);
 
-private slots:
-    void _requestFinished();
 private:
+    void _signalTerrainData(bool success, const QList<float>& altitudes) { emit terrainData(success, altitudes); }
 
-    enum class State {
-        Idle,
-        Downloading,
-    };
-
-    State                   _state = State::Idle;
-    QNetworkAccessManager   _networkManager;
+    friend class TerrainQueryManager;
 };
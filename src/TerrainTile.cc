@@ -0,0 +1,569 @@
+/****************************************************************************
+ *
+ *   (c) 2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTile.h"
+#include "QGCLoggingCategory.h"
+
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QVector>
+#include <QtEndian>
+#include <QtMath>
+
+#include <cmath>
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(TerrainTileLog, "TerrainTileLog")
+
+const char* TerrainTile::hgtFileExtension =     "hgt";
+const char* TerrainTile::cacheFileExtension =   "qgcdem";
+const float TerrainTile::noDataValue =          -32768.0f;
+
+namespace {
+
+/// Header of a .qgcdem cache file. Sample grid follows immediately and is 8 byte aligned.
+struct CacheHeader {
+    char    magic[4];
+    quint32 version;
+    double  southLat;
+    double  westLon;
+    double  latSpacing;
+    double  lonSpacing;
+    qint32  rows;
+    qint32  cols;
+};
+
+const char      _cacheMagic[4] =    { 'Q', 'D', 'E', 'M' };
+const quint32   _cacheVersion =     1;
+
+/// Minimal reader for the parts of a classic (non BigTIFF) TIFF file which DEM GeoTIFFs use
+class TiffReader
+{
+public:
+    TiffReader(const uchar* data, qint64 size)
+        : _data(data)
+        , _size(size)
+        , _bigEndian(false)
+    {
+    }
+
+    bool readHeader(quint32& ifdOffset)
+    {
+        if (_size < 8) {
+            return false;
+        }
+        if (_data[0] == 'I' && _data[1] == 'I') {
+            _bigEndian = false;
+        } else if (_data[0] == 'M' && _data[1] == 'M') {
+            _bigEndian = true;
+        } else {
+            return false;
+        }
+        if (u16(2) != 42) {
+            return false;
+        }
+        ifdOffset = u32(4);
+        return ifdOffset + 2 <= _size;
+    }
+
+    quint16 u16(qint64 offset) const { return _bigEndian ? qFromBigEndian<quint16>(_data + offset) : qFromLittleEndian<quint16>(_data + offset); }
+    quint32 u32(qint64 offset) const { return _bigEndian ? qFromBigEndian<quint32>(_data + offset) : qFromLittleEndian<quint32>(_data + offset); }
+
+    double f64(qint64 offset) const
+    {
+        quint64 bits = _bigEndian ? qFromBigEndian<quint64>(_data + offset) : qFromLittleEndian<quint64>(_data + offset);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    float f32(qint64 offset) const
+    {
+        quint32 bits = u32(offset);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    /// Reads all values of an IFD entry as doubles. SHORT, LONG and DOUBLE types are supported.
+    bool values(qint64 entryOffset, QVector<double>& rgValues) const
+    {
+        quint16 type =  u16(entryOffset + 2);
+        quint32 count = u32(entryOffset + 4);
+        int     typeSize;
+
+        switch (type) {
+        case 3:     typeSize = 2; break;    // SHORT
+        case 4:     typeSize = 4; break;    // LONG
+        case 12:    typeSize = 8; break;    // DOUBLE
+        default:
+            return false;
+        }
+
+        qint64 valueOffset = entryOffset + 8;
+        if (typeSize * count > 4) {
+            valueOffset = u32(entryOffset + 8);
+        }
+        if (valueOffset + (qint64)typeSize * count > _size) {
+            return false;
+        }
+
+        rgValues.resize(count);
+        for (quint32 i=0; i<count; i++) {
+            qint64 offset = valueOffset + (qint64)i * typeSize;
+            switch (type) {
+            case 3:     rgValues[i] = u16(offset); break;
+            case 4:     rgValues[i] = u32(offset); break;
+            default:    rgValues[i] = f64(offset); break;
+            }
+        }
+        return true;
+    }
+
+    QByteArray ascii(qint64 entryOffset) const
+    {
+        quint32 count = u32(entryOffset + 4);
+        qint64 valueOffset = count > 4 ? u32(entryOffset + 8) : entryOffset + 8;
+        if (valueOffset + count > _size) {
+            return QByteArray();
+        }
+        return QByteArray(reinterpret_cast<const char*>(_data + valueOffset), count).trimmed();
+    }
+
+    qint64 size(void) const { return _size; }
+
+private:
+    const uchar*    _data;
+    qint64          _size;
+    bool            _bigEndian;
+};
+
+}
+
+TerrainTile::TerrainTile(const QString& path)
+    : _file         (path)
+    , _data         (NULL)
+    , _format       (SampleInt16BigEndian)
+    , _southLat     (0)
+    , _westLon      (0)
+    , _latSpacing   (0)
+    , _lonSpacing   (0)
+    , _rows         (0)
+    , _cols         (0)
+{
+    QString suffix = QFileInfo(path).suffix().toLower();
+
+    if (!_file.open(QIODevice::ReadOnly)) {
+        qCWarning(TerrainTileLog) << "Unable to open terrain tile" << path << _file.errorString();
+        return;
+    }
+
+    bool loaded = false;
+    if (suffix == hgtFileExtension) {
+        loaded = _loadHgt();
+    } else if (suffix == cacheFileExtension) {
+        loaded = _loadCache();
+    }
+
+    if (!loaded) {
+        qCWarning(TerrainTileLog) << "Unsupported or corrupt terrain tile" << path;
+        _data = NULL;
+        _file.close();
+    } else {
+        qCDebug(TerrainTileLog) << "Loaded terrain tile" << path << _rows << _cols << _southLat << _westLon;
+    }
+}
+
+TerrainTile::~TerrainTile()
+{
+    // QFile unmaps all mapped regions on close
+    _file.close();
+}
+
+bool TerrainTile::_loadHgt(void)
+{
+    // Name encodes the south west corner: N47E008.hgt
+    static const QRegularExpression nameRegExp(QStringLiteral("^([NnSs])(\\d{2})([EeWw])(\\d{3})$"));
+
+    QRegularExpressionMatch match = nameRegExp.match(QFileInfo(_file.fileName()).completeBaseName());
+    if (!match.hasMatch()) {
+        return false;
+    }
+
+    qint64 size = _file.size();
+    int samples = qRound(qSqrt(size / 2));
+    if (samples < 2 || (qint64)samples * samples * 2 != size) {
+        return false;
+    }
+
+    _southLat = match.captured(2).toInt();
+    if (match.captured(1).toUpper() == QStringLiteral("S")) {
+        _southLat = -_southLat;
+    }
+    _westLon = match.captured(4).toInt();
+    if (match.captured(3).toUpper() == QStringLiteral("W")) {
+        _westLon = -_westLon;
+    }
+
+    _rows = _cols = samples;
+    _latSpacing = _lonSpacing = 1.0 / (samples - 1);
+    _format = SampleInt16BigEndian;
+    _data = _file.map(0, size);
+
+    return _data != NULL;
+}
+
+bool TerrainTile::_loadCache(void)
+{
+    qint64 size = _file.size();
+    if (size < (qint64)sizeof(CacheHeader)) {
+        return false;
+    }
+
+    const uchar* mapped = _file.map(0, size);
+    if (!mapped) {
+        return false;
+    }
+
+    CacheHeader header;
+    memcpy(&header, mapped, sizeof(header));
+    if (memcmp(header.magic, _cacheMagic, sizeof(_cacheMagic)) != 0 || header.version != _cacheVersion) {
+        return false;
+    }
+    if (header.rows < 2 || header.cols < 2 || header.latSpacing <= 0 || header.lonSpacing <= 0) {
+        return false;
+    }
+    if ((qint64)sizeof(CacheHeader) + (qint64)header.rows * header.cols * (qint64)sizeof(float) > size) {
+        return false;
+    }
+
+    _southLat =     header.southLat;
+    _westLon =      header.westLon;
+    _latSpacing =   header.latSpacing;
+    _lonSpacing =   header.lonSpacing;
+    _rows =         header.rows;
+    _cols =         header.cols;
+    _format =       SampleFloatNative;
+    _data =         mapped + sizeof(CacheHeader);
+
+    return true;
+}
+
+bool TerrainTile::contains(double latitude, double longitude) const
+{
+    return isValid() && latitude >= _southLat && latitude <= northLat() && longitude >= _westLon && longitude <= eastLon();
+}
+
+float TerrainTile::_sample(int row, int col) const
+{
+    qint64 index = (qint64)row * _cols + col;
+
+    if (_format == SampleInt16BigEndian) {
+        qint16 value = qFromBigEndian<qint16>(_data + index * sizeof(qint16));
+        return value == _srtmVoid ? noDataValue : value;
+    } else {
+        float value;
+        memcpy(&value, _data + index * sizeof(float), sizeof(value));
+        return value;
+    }
+}
+
+float TerrainTile::elevation(double latitude, double longitude) const
+{
+    float result;
+    elevations(&latitude, &longitude, &result, 1);
+    return result;
+}
+
+void TerrainTile::elevations(const double* latitudes, const double* longitudes, float* elevations, int count) const
+{
+    if (!isValid()) {
+        for (int i=0; i<count; i++) {
+            elevations[i] = qQNaN();
+        }
+        return;
+    }
+
+    const double north = northLat();
+    const double east = eastLon();
+
+    // First pass: grid cell and weights. No data dependent branches so this vectorizes.
+    QVector<int>    rgRow(count);
+    QVector<int>    rgCol(count);
+    QVector<float>  rgRowWeight(count);
+    QVector<float>  rgColWeight(count);
+    QVector<char>   rgInside(count);
+
+    for (int i=0; i<count; i++) {
+        double fRow = (north - latitudes[i]) / _latSpacing;
+        double fCol = (longitudes[i] - _westLon) / _lonSpacing;
+        rgInside[i] = latitudes[i] >= _southLat && latitudes[i] <= north && longitudes[i] >= _westLon && longitudes[i] <= east;
+        fRow = qBound(0.0, fRow, (double)(_rows - 1));
+        fCol = qBound(0.0, fCol, (double)(_cols - 1));
+        int row = qMin((int)fRow, _rows - 2);
+        int col = qMin((int)fCol, _cols - 2);
+        rgRow[i] = row;
+        rgCol[i] = col;
+        rgRowWeight[i] = fRow - row;
+        rgColWeight[i] = fCol - col;
+    }
+
+    // Second pass: gather the four corner samples and blend. Missing samples are dropped and the remaining
+    // weights renormalized so that a single void does not poison the whole cell.
+    for (int i=0; i<count; i++) {
+        if (!rgInside[i]) {
+            elevations[i] = qQNaN();
+            continue;
+        }
+
+        const int   row = rgRow[i];
+        const int   col = rgCol[i];
+        const float wr = rgRowWeight[i];
+        const float wc = rgColWeight[i];
+
+        const float samples[4] = {
+            _sample(row,     col),
+            _sample(row,     col + 1),
+            _sample(row + 1, col),
+            _sample(row + 1, col + 1),
+        };
+        const float weights[4] = {
+            (1.0f - wr) * (1.0f - wc),
+            (1.0f - wr) * wc,
+            wr * (1.0f - wc),
+            wr * wc,
+        };
+
+        float sum = 0;
+        float weightSum = 0;
+        for (int j=0; j<4; j++) {
+            if (samples[j] != noDataValue && !qIsNaN(samples[j])) {
+                sum += samples[j] * weights[j];
+                weightSum += weights[j];
+            }
+        }
+        elevations[i] = weightSum > 0 ? sum / weightSum : qQNaN();
+    }
+}
+
+bool TerrainTile::writeCacheFile(const QString& cachePath, double southLat, double westLon, double latSpacing, double lonSpacing, int rows, int cols, const float* data, QString& errorString)
+{
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, _cacheMagic, sizeof(_cacheMagic));
+    header.version =    _cacheVersion;
+    header.southLat =   southLat;
+    header.westLon =    westLon;
+    header.latSpacing = latSpacing;
+    header.lonSpacing = lonSpacing;
+    header.rows =       rows;
+    header.cols =       cols;
+
+    // QSaveFile so that a partially written cache file is never picked up by a reader
+    QSaveFile file(cachePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        errorString = file.errorString();
+        return false;
+    }
+    qint64 dataSize = (qint64)rows * cols * sizeof(float);
+    if (file.write(reinterpret_cast<const char*>(&header), sizeof(header)) != sizeof(header) ||
+            file.write(reinterpret_cast<const char*>(data), dataSize) != dataSize) {
+        errorString = file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+    if (!file.commit()) {
+        errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool TerrainTile::importGeoTiff(const QString& tiffPath, const QString& cachePath, QString& errorString)
+{
+    QFile file(tiffPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorString = file.errorString();
+        return false;
+    }
+
+    const uchar* mapped = file.map(0, file.size());
+    if (!mapped) {
+        errorString = QObject::tr("Unable to map file");
+        return false;
+    }
+
+    TiffReader reader(mapped, file.size());
+    quint32 ifdOffset;
+    if (!reader.readHeader(ifdOffset)) {
+        errorString = QObject::tr("Not a TIFF file or BigTIFF which is not supported");
+        return false;
+    }
+
+    int             width =             0;
+    int             height =            0;
+    int             bitsPerSample =     0;
+    int             compression =       1;
+    int             samplesPerPixel =   1;
+    int             sampleFormat =      1;
+    int             rowsPerStrip =      0;
+    int             tileWidth =         0;
+    int             tileHeight =        0;
+    bool            pixelIsPoint =      false;
+    float           tiffNoData =        qQNaN();
+    QVector<double> rgOffsets;
+    QVector<double> rgPixelScale;
+    QVector<double> rgTiepoint;
+
+    quint16 entryCount = reader.u16(ifdOffset);
+    if (ifdOffset + 2 + entryCount * 12 > reader.size()) {
+        errorString = QObject::tr("Corrupt TIFF directory");
+        return false;
+    }
+    for (int i=0; i<entryCount; i++) {
+        qint64 entry = ifdOffset + 2 + i * 12;
+        quint16 tag = reader.u16(entry);
+        QVector<double> rgValues;
+
+        switch (tag) {
+        case 256:   // ImageWidth
+        case 257:   // ImageLength
+        case 258:   // BitsPerSample
+        case 259:   // Compression
+        case 277:   // SamplesPerPixel
+        case 278:   // RowsPerStrip
+        case 322:   // TileWidth
+        case 323:   // TileLength
+        case 339:   // SampleFormat
+            if (reader.values(entry, rgValues) && rgValues.count()) {
+                int value = (int)rgValues[0];
+                switch (tag) {
+                case 256: width = value;            break;
+                case 257: height = value;           break;
+                case 258: bitsPerSample = value;    break;
+                case 259: compression = value;      break;
+                case 277: samplesPerPixel = value;  break;
+                case 278: rowsPerStrip = value;     break;
+                case 322: tileWidth = value;        break;
+                case 323: tileHeight = value;       break;
+                case 339: sampleFormat = value;     break;
+                }
+            }
+            break;
+        case 273:   // StripOffsets
+        case 324:   // TileOffsets
+            reader.values(entry, rgOffsets);
+            break;
+        case 33550: // ModelPixelScaleTag
+            reader.values(entry, rgPixelScale);
+            break;
+        case 33922: // ModelTiepointTag
+            reader.values(entry, rgTiepoint);
+            break;
+        case 34735: // GeoKeyDirectoryTag
+            if (reader.values(entry, rgValues) && rgValues.count() >= 4) {
+                for (int key=4; key + 3 < rgValues.count(); key += 4) {
+                    // GTRasterTypeGeoKey: 1 - PixelIsArea, 2 - PixelIsPoint
+                    if (rgValues[key] == 1025 && rgValues[key + 1] == 0) {
+                        pixelIsPoint = rgValues[key + 3] == 2;
+                    }
+                }
+            }
+            break;
+        case 42113: // GDAL_NODATA
+        {
+            bool ok;
+            float value = reader.ascii(entry).toFloat(&ok);
+            if (ok) {
+                tiffNoData = value;
+            }
+        }
+            break;
+        }
+    }
+
+    if (compression != 1 || samplesPerPixel != 1) {
+        errorString = QObject::tr("Only uncompressed single band GeoTIFF files are supported");
+        return false;
+    }
+    if (width < 2 || height < 2 || rgPixelScale.count() < 2 || rgTiepoint.count() < 6 || rgOffsets.isEmpty()) {
+        errorString = QObject::tr("GeoTIFF is missing size or georeferencing information");
+        return false;
+    }
+    if (!((bitsPerSample == 16 && sampleFormat != 3) || (bitsPerSample == 32 && (sampleFormat == 2 || sampleFormat == 3)))) {
+        errorString = QObject::tr("Unsupported sample type %1 bits format %2").arg(bitsPerSample).arg(sampleFormat);
+        return false;
+    }
+
+    const int bytesPerSample = bitsPerSample / 8;
+    const bool tiled = tileWidth > 0 && tileHeight > 0;
+    if (!tiled && rowsPerStrip <= 0) {
+        rowsPerStrip = height;
+    }
+
+    QVector<float> rgGrid(width * height);
+    for (int row=0; row<height; row++) {
+        for (int col=0; col<width; col++) {
+            qint64 offset;
+            if (tiled) {
+                int tilesAcross = (width + tileWidth - 1) / tileWidth;
+                int tileIndex = (row / tileHeight) * tilesAcross + (col / tileWidth);
+                if (tileIndex >= rgOffsets.count()) {
+                    errorString = QObject::tr("Corrupt GeoTIFF tile table");
+                    return false;
+                }
+                offset = (qint64)rgOffsets[tileIndex] + ((qint64)(row % tileHeight) * tileWidth + (col % tileWidth)) * bytesPerSample;
+            } else {
+                int stripIndex = row / rowsPerStrip;
+                if (stripIndex >= rgOffsets.count()) {
+                    errorString = QObject::tr("Corrupt GeoTIFF strip table");
+                    return false;
+                }
+                offset = (qint64)rgOffsets[stripIndex] + ((qint64)(row % rowsPerStrip) * width + col) * bytesPerSample;
+            }
+            if (offset + bytesPerSample > reader.size()) {
+                errorString = QObject::tr("GeoTIFF sample data truncated");
+                return false;
+            }
+
+            float value;
+            if (bitsPerSample == 16) {
+                quint16 raw = reader.u16(offset);
+                value = sampleFormat == 2 ? (float)(qint16)raw : (float)raw;
+            } else if (sampleFormat == 2) {
+                value = (float)(qint32)reader.u32(offset);
+            } else {
+                value = reader.f32(offset);
+            }
+            if (value == tiffNoData || (bitsPerSample == 16 && sampleFormat == 2 && value == _srtmVoid)) {
+                value = noDataValue;
+            }
+            rgGrid[row * width + col] = value;
+        }
+    }
+
+    // Tiepoint maps raster (I,J) to model (X=lon,Y=lat). Our grid origin is the center of the south west sample.
+    double lonSpacing = rgPixelScale[0];
+    double latSpacing = rgPixelScale[1];
+    double northLat = rgTiepoint[4] + rgTiepoint[1] * latSpacing;
+    double westLon = rgTiepoint[3] - rgTiepoint[0] * lonSpacing;
+    if (!pixelIsPoint) {
+        northLat -= latSpacing / 2.0;
+        westLon += lonSpacing / 2.0;
+    }
+    double southLat = northLat - (height - 1) * latSpacing;
+
+    if (qAbs(southLat) > 90 || qAbs(westLon) > 180 || latSpacing <= 0 || lonSpacing <= 0) {
+        errorString = QObject::tr("GeoTIFF is not in WGS84 degrees");
+        return false;
+    }
+
+    return writeCacheFile(cachePath, southLat, westLon, latSpacing, lonSpacing, height, width, rgGrid.constData(), errorString);
+}
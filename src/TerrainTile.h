@@ -0,0 +1,95 @@
+/****************************************************************************
+ *
+ *   (c) 2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(TerrainTileLog)
+
+/// A single memory mapped digital elevation model tile.
+///
+/// Two on disk formats are supported:
+///     - SRTM .hgt files (big endian int16, square grid covering exactly 1x1 degree, rows stored north to south).
+///       These are mapped as is. The file name encodes the south west corner, for example N47E008.hgt.
+///     - QGC terrain cache files (.qgcdem) which hold a small header followed by a native endian float grid.
+///       GeoTIFF files are converted to this format once by importGeoTiff so that all further access is
+///       a plain memory map.
+///
+/// A TerrainTile is immutable once loaded so concurrent reads from multiple threads are safe.
+class TerrainTile
+{
+public:
+    TerrainTile(const QString& path);
+    ~TerrainTile();
+
+    bool    isValid     (void) const { return _data != NULL; }
+    QString path        (void) const { return _file.fileName(); }
+
+    double  southLat    (void) const { return _southLat; }
+    double  westLon     (void) const { return _westLon; }
+    double  northLat    (void) const { return _southLat + (_rows - 1) * _latSpacing; }
+    double  eastLon     (void) const { return _westLon + (_cols - 1) * _lonSpacing; }
+    double  latSpacing  (void) const { return _latSpacing; }
+    double  lonSpacing  (void) const { return _lonSpacing; }
+
+    /// @return true if the coordinate lies within the area covered by the tile
+    bool contains(double latitude, double longitude) const;
+
+    /// @return Bilinear interpolated elevation in meters AMSL, NaN if the coordinate is outside the tile or no data
+    float elevation(double latitude, double longitude) const;
+
+    /// Batch bilinear interpolation. The loop is kept free of branches on the hot path so the compiler can
+    /// vectorize the weight calculation. Coordinates outside the tile are set to NaN.
+    ///     @param latitudes    Array of count latitudes
+    ///     @param longitudes   Array of count longitudes
+    ///     @param elevations   Filled with count elevations
+    void elevations(const double* latitudes, const double* longitudes, float* elevations, int count) const;
+
+    /// Converts a GeoTIFF DEM into a .qgcdem cache file. Only the subset of GeoTIFF which DEM exports use is
+    /// supported: uncompressed, single sample per pixel, int16/uint16/int32/float32 data in strips or tiles, with
+    /// ModelPixelScale and ModelTiepoint tags in WGS84 degrees.
+    ///     @param tiffPath     GeoTIFF to convert
+    ///     @param cachePath    Output .qgcdem file
+    ///     @param errorString  Set to reason for failure
+    /// @return true: success
+    static bool importGeoTiff(const QString& tiffPath, const QString& cachePath, QString& errorString);
+
+    /// Writes a .qgcdem cache file from an in memory grid. Rows are stored north to south.
+    static bool writeCacheFile(const QString& cachePath, double southLat, double westLon, double latSpacing, double lonSpacing, int rows, int cols, const float* data, QString& errorString);
+
+    static const char*  hgtFileExtension;
+    static const char*  cacheFileExtension;
+    static const float  noDataValue;
+
+private:
+    bool _loadHgt   (void);
+    bool _loadCache (void);
+
+    float _sample(int row, int col) const;
+
+    enum SampleFormat {
+        SampleInt16BigEndian,
+        SampleFloatNative,
+    };
+
+    QFile           _file;
+    const uchar*    _data;          ///< Start of the sample grid within the mapped file, NULL if not loaded
+    SampleFormat    _format;
+    double          _southLat;
+    double          _westLon;
+    double          _latSpacing;
+    double          _lonSpacing;
+    int             _rows;
+    int             _cols;
+
+    static const int    _srtmVoid = -32768;
+};
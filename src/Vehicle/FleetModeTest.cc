@@ -0,0 +1,122 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FleetModeTest.h"
+#include "MultiVehicleManager.h"
+#include "ParameterManager.h"
+#include "QGCApplication.h"
+#include "MockLink.h"
+
+#include <ctime>
+
+void FleetModeTest::cleanup(void)
+{
+    // Disconnect before leaving fleet mode, otherwise all fleet vehicles would start loading parameters
+    _disconnectMockLink();
+    qgcApp()->toolbox()->multiVehicleManager()->setFleetMode(false);
+
+    UnitTest::cleanup();
+}
+
+/// Starts a fleet MockLink and waits for all of its vehicles to show up
+///     @return false: vehicles did not show up
+bool FleetModeTest::_startFleet(int vehicleCount)
+{
+    MultiVehicleManager* vehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+
+    vehicleMgr->setFleetMode(true);
+    _mockLink = MockLink::startPX4FleetMockLink(vehicleCount - 1);
+
+    for (int i=0; i<100 && vehicleMgr->vehicles()->count() < vehicleCount; i++) {
+        QTest::qWait(100);
+    }
+
+    return vehicleMgr->vehicles()->count() == vehicleCount;
+}
+
+void FleetModeTest::_fleetProfile_test(void)
+{
+    MultiVehicleManager* vehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+
+    QSignalSpy spyParamsReady(vehicleMgr, SIGNAL(parameterReadyVehicleAvailableChanged(bool)));
+    QVERIFY(_startFleet(4));
+
+    // The main vehicle connects first and becomes the fully loaded active vehicle
+    if (!vehicleMgr->parameterReadyVehicleAvailable()) {
+        QCOMPARE(spyParamsReady.wait(10000), true);
+    }
+    Vehicle* mainVehicle = vehicleMgr->activeVehicle();
+    QVERIFY(mainVehicle);
+    QCOMPARE(mainVehicle->fleetProfile(), false);
+    QCOMPARE(mainVehicle->parameterManager()->parametersReady(), true);
+
+    // Fleet vehicles are telemetry only: no parameters and reduced stream rates
+    QList<int> fleetVehicleIds = _mockLink->fleetVehicleIds();
+    QCOMPARE(fleetVehicleIds.count(), 3);
+    foreach (int fleetVehicleId, fleetVehicleIds) {
+        Vehicle* fleetVehicle = vehicleMgr->getVehicleById(fleetVehicleId);
+        QVERIFY(fleetVehicle);
+        QCOMPARE(fleetVehicle->fleetProfile(), true);
+        QCOMPARE(fleetVehicle->parameterManager()->parametersReady(), false);
+        QCOMPARE(fleetVehicle->parameterManager()->loadProgress(), 0.0);
+
+        for (int i=0; i<50 && _mockLink->fleetVehicleMessageIntervalMSecs(fleetVehicleId, MAVLINK_MSG_ID_ATTITUDE) != 500; i++) {
+            QTest::qWait(100);
+        }
+        QCOMPARE(_mockLink->fleetVehicleMessageIntervalMSecs(fleetVehicleId, MAVLINK_MSG_ID_ATTITUDE), 500);
+        QCOMPARE(fleetVehicle->coordinate().isValid(), true);
+    }
+
+    // Selecting a fleet vehicle switches it to the full profile and the previous active vehicle to the fleet profile
+    Vehicle* selectedVehicle = vehicleMgr->getVehicleById(fleetVehicleIds[0]);
+    QSignalSpy spyActive(vehicleMgr, SIGNAL(activeVehicleChanged(Vehicle*)));
+    vehicleMgr->setActiveVehicle(selectedVehicle);
+    QCOMPARE(spyActive.wait(1000), true);
+    QCOMPARE(vehicleMgr->activeVehicle(), selectedVehicle);
+    QCOMPARE(selectedVehicle->fleetProfile(), false);
+    QCOMPARE(mainVehicle->fleetProfile(), true);
+
+    for (int i=0; i<50 && _mockLink->fleetVehicleMessageIntervalMSecs(fleetVehicleIds[0], MAVLINK_MSG_ID_ATTITUDE) != 100; i++) {
+        QTest::qWait(100);
+    }
+    QCOMPARE(_mockLink->fleetVehicleMessageIntervalMSecs(fleetVehicleIds[0], MAVLINK_MSG_ID_ATTITUDE), 100);
+}
+
+void FleetModeTest::_cpuPerVehicle_benchmark_data(void)
+{
+    QTest::addColumn<int>("vehicleCount");
+
+    QTest::newRow("10 vehicles")    << 10;
+    QTest::newRow("30 vehicles")    << 30;
+    QTest::newRow("100 vehicles")   << 100;
+}
+
+/// Measures process CPU time per vehicle while the fleet streams telemetry. The numbers include the MockLink thread
+/// which simulates the vehicles, so compare them between runs rather than reading them as absolute cost.
+void FleetModeTest::_cpuPerVehicle_benchmark(void)
+{
+    UT_OPT_IN(optInBenchmarks);
+
+    QFETCH(int, vehicleCount);
+
+    QVERIFY(_startFleet(vehicleCount));
+
+    // Let the connect time traffic settle before measuring
+    QTest::qWait(1000);
+
+    const int   cMeasureMSecs = 2000;
+    std::clock_t cpuStart = std::clock();
+    QTest::qWait(cMeasureMSecs);
+    double cpuMSecs = (double)(std::clock() - cpuStart) * 1000.0 / CLOCKS_PER_SEC;
+
+    double cpuPercentPerVehicle = (cpuMSecs / cMeasureMSecs) * 100.0 / vehicleCount;
+    qDebug() << "Fleet mode" << vehicleCount << "vehicles: cpu" << cpuMSecs << "msecs in" << cMeasureMSecs << "msecs," << cpuPercentPerVehicle << "% per vehicle";
+
+    QCOMPARE(qgcApp()->toolbox()->multiVehicleManager()->vehicles()->count(), vehicleCount);
+}
@@ -0,0 +1,29 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test and CPU benchmark for MultiVehicleManager fleet mode
+class FleetModeTest : public UnitTest
+{
+    Q_OBJECT
+
+protected slots:
+    void cleanup(void);
+
+private slots:
+    void _fleetProfile_test(void);
+    void _cpuPerVehicle_benchmark_data(void);
+    void _cpuPerVehicle_benchmark(void);
+
+private:
+    bool _startFleet(int vehicleCount);
+};
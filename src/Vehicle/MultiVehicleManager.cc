@@ -28,6 +28,7 @@
 QGC_LOGGING_CATEGORY(MultiVehicleManagerLog, "MultiVehicleManagerLog")
 
 const char* MultiVehicleManager::_gcsHeartbeatEnabledKey = "gcsHeartbeatEnabled";
+const char* MultiVehicleManager::_fleetModeKey = "fleetMode";
 
 MultiVehicleManager::MultiVehicleManager(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
@@ -39,10 +40,12 @@ MultiVehicleManager::MultiVehicleManager(QGCApplication* app, QGCToolbox* toolbo
     , _joystickManager(NULL)
     , _mavlinkProtocol(NULL)
     , _gcsHeartbeatEnabled(true)
+    , _fleetMode(false)
 {
     QSettings settings;
 
     _gcsHeartbeatEnabled = settings.value(_gcsHeartbeatEnabledKey, true).toBool();
+    _fleetMode = settings.value(_fleetModeKey, false).toBool();
 
     _gcsHeartbeatTimer.setInterval(_gcsHeartbeatRateMSecs);
     _gcsHeartbeatTimer.setSingleShot(false);
@@ -129,7 +132,10 @@ void MultiVehicleManager::_vehicleHeartbeatInfo(LinkInterface* link, int vehicle
 //        return;
 //    }
 
-    Vehicle* vehicle = new Vehicle(link, vehicleId, componentId, (MAV_AUTOPILOT)vehicleFirmwareType, (MAV_TYPE)vehicleType, _firmwarePluginManager, _joystickManager);
+    // In fleet mode only the first vehicle, which becomes the active vehicle below, starts out fully loaded
+    bool fleetProfile = _fleetMode && _vehicles.count() > 0;
+
+    Vehicle* vehicle = new Vehicle(link, vehicleId, componentId, (MAV_AUTOPILOT)vehicleFirmwareType, (MAV_TYPE)vehicleType, _firmwarePluginManager, _joystickManager, fleetProfile);
     connect(vehicle, &Vehicle::allLinksInactive, this, &MultiVehicleManager::_deleteVehiclePhase1);
     connect(vehicle, &Vehicle::requestProtocolVersion, this, &MultiVehicleManager::_requestProtocolVersion);
     connect(vehicle->parameterManager(), &ParameterManager::parametersReadyChanged, this, &MultiVehicleManager::_vehicleParametersReadyChanged);
@@ -144,7 +150,10 @@ void MultiVehicleManager::_vehicleHeartbeatInfo(LinkInterface* link, int vehicle
     emit vehicleAdded(vehicle);
 
     if (_vehicles.count() > 1) {
-        qgcApp()->showMessage(tr("Connected to Vehicle %1").arg(vehicleId));
+        // A fleet connects many vehicles at once, they show up in the vehicle list instead
+        if (!_fleetMode) {
+            qgcApp()->showMessage(tr("Connected to Vehicle %1").arg(vehicleId));
+        }
     } else {
         setActiveVehicle(vehicle);
     }
@@ -250,6 +259,7 @@ void MultiVehicleManager::_deleteVehiclePhase2(void)
     emit activeVehicleChanged(newActiveVehicle);
 
     if (_activeVehicle) {
+        _activeVehicle->setFleetProfile(false);
         _activeVehicle->setActive(true);
         emit activeVehicleAvailableChanged(true);
         if (_activeVehicle->parameterManager()->parametersReady()) {
@@ -268,6 +278,7 @@ void MultiVehicleManager::setActiveVehicle(Vehicle* vehicle)
     if (vehicle != _activeVehicle) {
         if (_activeVehicle) {
             _activeVehicle->setActive(false);
+            _activeVehicle->setFleetProfile(_fleetMode);
 
             // The sequence of signals is very important in order to not leave Qml elements connected
             // to a non-existent vehicle.
@@ -296,6 +307,7 @@ void MultiVehicleManager::_setActiveVehiclePhase2(void)
 
     // And finally vehicle availability
     if (_activeVehicle) {
+        _activeVehicle->setFleetProfile(false);
         _activeVehicle->setActive(true);
         _activeVehicleAvailable = true;
         emit activeVehicleAvailableChanged(true);
@@ -346,6 +358,22 @@ Vehicle* MultiVehicleManager::getVehicleById(int vehicleId)
     return NULL;
 }
 
+void MultiVehicleManager::setFleetMode(bool fleetMode)
+{
+    if (fleetMode != _fleetMode) {
+        _fleetMode = fleetMode;
+        emit fleetModeChanged(fleetMode);
+
+        QSettings settings;
+        settings.setValue(_fleetModeKey, fleetMode);
+
+        for (int i=0; i<_vehicles.count(); i++) {
+            Vehicle* vehicle = qobject_cast<Vehicle*>(_vehicles[i]);
+            vehicle->setFleetProfile(_fleetMode && vehicle != _activeVehicle);
+        }
+    }
+}
+
 void MultiVehicleManager::setGcsHeartbeatEnabled(bool gcsHeartBeatEnabled)
 {
     if (gcsHeartBeatEnabled != _gcsHeartbeatEnabled) {
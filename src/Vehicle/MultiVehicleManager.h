@@ -44,6 +44,9 @@ public:
     Q_PROPERTY(QmlObjectListModel*  vehicles                        READ vehicles                                                       CONSTANT)
     Q_PROPERTY(bool                 gcsHeartBeatEnabled             READ gcsHeartbeatEnabled            WRITE setGcsHeartbeatEnabled    NOTIFY gcsHeartBeatEnabledChanged)
 
+    /// true: Vehicles which are not the active vehicle run the telemetry only fleet profile, see Vehicle::fleetProfile
+    Q_PROPERTY(bool                 fleetMode                       READ fleetMode                      WRITE setFleetMode              NOTIFY fleetModeChanged)
+
     /// A disconnected vehicle used for offline editing. It will match the vehicle type specified in Settings.
     Q_PROPERTY(Vehicle*             offlineEditingVehicle           READ offlineEditingVehicle                                          CONSTANT)
 
@@ -67,6 +70,9 @@ public:
     bool gcsHeartbeatEnabled(void) const { return _gcsHeartbeatEnabled; }
     void setGcsHeartbeatEnabled(bool gcsHeartBeatEnabled);
 
+    bool fleetMode(void) const { return _fleetMode; }
+    void setFleetMode(bool fleetMode);
+
     Vehicle* offlineEditingVehicle(void) { return _offlineEditingVehicle; }
 
     /// Determines if the link is in use by a Vehicle
@@ -85,6 +91,7 @@ signals:
     void parameterReadyVehicleAvailableChanged(bool parameterReadyVehicleAvailable);
     void activeVehicleChanged(Vehicle* activeVehicle);
     void gcsHeartBeatEnabledChanged(bool gcsHeartBeatEnabled);
+    void fleetModeChanged(bool fleetMode);
 
     void _deleteVehiclePhase2Signal(void);
 
@@ -120,6 +127,9 @@ private:
     bool                _gcsHeartbeatEnabled;           ///< Enabled/disable heartbeat emission
     static const int    _gcsHeartbeatRateMSecs = 1000;  ///< Heartbeat rate
     static const char*  _gcsHeartbeatEnabledKey;
+
+    bool                _fleetMode;
+    static const char*  _fleetModeKey;
 };
 
 #endif
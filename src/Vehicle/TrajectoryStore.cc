@@ -0,0 +1,319 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TrajectoryStore.h"
+
+#include <QtMath>
+
+#include <algorithm>
+
+QGC_LOGGING_CATEGORY(TrajectoryStoreLog, "TrajectoryStoreLog")
+
+const double TrajectoryStore::levelTolerances[TrajectoryStore::levelCount] = { 0.0, 1.0, 5.0, 25.0, 125.0 };
+const double TrajectoryStore::minPointSpacing = 0.5;
+
+TrajectoryStore::TrajectoryStore(QObject* parent)
+    : QObject(parent)
+    , _tailIndex(0)
+#ifdef __mobile__
+    , _maxPointCount(10000)
+#else
+    , _maxPointCount(50000)
+#endif
+    , _displayMetersPerPixel(0)
+{
+
+}
+
+void TrajectoryStore::setDisplayMetersPerPixel(double displayMetersPerPixel)
+{
+    if (!qFuzzyCompare(_displayMetersPerPixel, displayMetersPerPixel)) {
+        int previousLevel = _displayLevel();
+        _displayMetersPerPixel = displayMetersPerPixel;
+        emit displayMetersPerPixelChanged(_displayMetersPerPixel);
+        if (_displayLevel() != previousLevel) {
+            emit pathChanged();
+        }
+    }
+}
+
+void TrajectoryStore::setMaxPointCount(int maxPointCount)
+{
+    _maxPointCount = qMax(maxPointCount, blockSize * 4);
+    if (count() > _maxPointCount) {
+        _compact();
+        emit countChanged(count());
+        emit pathChanged();
+    }
+}
+
+/// The coarsest level whose simplification error stays within a pixel at the current map scale
+int TrajectoryStore::_displayLevel(void) const
+{
+    int level = 0;
+
+    for (int i=1; i<levelCount; i++) {
+        if (levelTolerances[i] <= _displayMetersPerPixel) {
+            level = i;
+        }
+    }
+
+    return level;
+}
+
+QVariantList TrajectoryStore::path(void) const
+{
+    return levelPath(_displayLevel());
+}
+
+int TrajectoryStore::levelPointCount(int level) const
+{
+    if (level <= 0 || _latitudes.isEmpty()) {
+        return count();
+    }
+
+    return _levelIndices[level].count() + count() - _tailIndex;
+}
+
+QVariantList TrajectoryStore::levelPath(int level) const
+{
+    QVariantList path;
+
+    path.reserve(levelPointCount(level));
+    if (level <= 0) {
+        for (int i=0; i<count(); i++) {
+            path.append(QVariant::fromValue(QGeoCoordinate(_latitudes[i], _longitudes[i])));
+        }
+    } else {
+        foreach (int index, _levelIndices[level]) {
+            path.append(QVariant::fromValue(QGeoCoordinate(_latitudes[index], _longitudes[index])));
+        }
+        for (int i=_tailIndex; i<count(); i++) {
+            path.append(QVariant::fromValue(QGeoCoordinate(_latitudes[i], _longitudes[i])));
+        }
+    }
+
+    return path;
+}
+
+QGeoCoordinate TrajectoryStore::coordinate(int index) const
+{
+    return QGeoCoordinate(_latitudes[index], _longitudes[index], _altitudes[index]);
+}
+
+void TrajectoryStore::append(const QGeoCoordinate& coordinate, qint64 msecsSinceEpoch)
+{
+    if (!coordinate.isValid()) {
+        return;
+    }
+
+    if (!_latitudes.isEmpty() && this->coordinate(count() - 1).distanceTo(coordinate) < minPointSpacing) {
+        // Vehicle hasn't moved far enough to change the path
+        return;
+    }
+
+    int previousTailIndex = _tailIndex;
+    bool compacted = false;
+
+    _appendPoint(coordinate.latitude(), coordinate.longitude(), coordinate.altitude(), msecsSinceEpoch);
+    _simplifyBlocks();
+    if (count() > _maxPointCount) {
+        _compact();
+        compacted = true;
+    }
+
+    emit countChanged(count());
+
+    // A newly simplified block replaces full resolution points of the displayed path unless it is the full resolution one
+    if (compacted || (_displayLevel() > 0 && _tailIndex != previousTailIndex)) {
+        emit pathChanged();
+    } else {
+        emit pathPointAppended(QGeoCoordinate(_latitudes.last(), _longitudes.last()));
+    }
+}
+
+void TrajectoryStore::clear(void)
+{
+    _clearPoints();
+
+    emit countChanged(0);
+    emit pathChanged();
+}
+
+void TrajectoryStore::_clearPoints(void)
+{
+    _latitudes.clear();
+    _longitudes.clear();
+    _altitudes.clear();
+    _timestamps.clear();
+    for (int i=0; i<levelCount; i++) {
+        _levelIndices[i].clear();
+    }
+    _tailIndex = 0;
+}
+
+void TrajectoryStore::_appendPoint(double latitude, double longitude, float altitude, qint64 msecsSinceEpoch)
+{
+    _latitudes.append(latitude);
+    _longitudes.append(longitude);
+    _altitudes.append(altitude);
+    _timestamps.append(msecsSinceEpoch);
+}
+
+/// Simplifies each newly filled block at all levels. Blocks share their end points so the levels stay connected.
+void TrajectoryStore::_simplifyBlocks(void)
+{
+    while (count() > _tailIndex + blockSize) {
+        int firstIndex = _tailIndex;
+        int lastIndex = firstIndex + blockSize;
+
+        for (int level=1; level<levelCount; level++) {
+            QVector<int> indices;
+            _douglasPeucker(firstIndex, lastIndex, levelTolerances[level], indices);
+            indices.removeLast();
+            _levelIndices[level] += indices;
+        }
+
+        _tailIndex = lastIndex;
+    }
+}
+
+/// Replaces the simplified part of the trajectory with the finest level which frees at least half the store. The
+/// unsimplified tail is kept as is.
+///
+/// The kept points are not simplified again. They already are the chosen level, which makes them the finer levels as
+/// well. The coarser levels are subsets of the chosen one, since Douglas-Peucker with a larger tolerance stops earlier
+/// on the same splits, so their indices are carried over.
+void TrajectoryStore::_compact(void)
+{
+    int level = levelCount - 1;
+    for (int i=1; i<levelCount; i++) {
+        if (levelPointCount(i) <= _maxPointCount / 2) {
+            level = i;
+            break;
+        }
+    }
+
+    QVector<int> keepIndices = _levelIndices[level];
+    int simplifiedKeepCount = keepIndices.count();
+    for (int i=_tailIndex; i<count(); i++) {
+        keepIndices.append(i);
+    }
+
+    // A path which even the coarsest level can't reduce far enough loses its oldest points instead
+    int dropCount = qMax(0, keepIndices.count() - (_maxPointCount / 2));
+    keepIndices.remove(0, dropCount);
+    simplifiedKeepCount = qMax(0, simplifiedKeepCount - dropCount);
+
+    // New indices of the kept points of the coarser levels
+    QVector<int> coarserIndices[levelCount];
+    for (int i=level + 1; i<levelCount && simplifiedKeepCount > 0; i++) {
+        foreach (int index, _levelIndices[i]) {
+            QVector<int>::const_iterator keepIter = std::lower_bound(keepIndices.constBegin(), keepIndices.constBegin() + simplifiedKeepCount, index);
+            if (keepIter != keepIndices.constBegin() + simplifiedKeepCount && *keepIter == index) {
+                coarserIndices[i].append(keepIter - keepIndices.constBegin());
+            }
+        }
+    }
+
+    qCDebug(TrajectoryStoreLog) << "Compacting" << count() << "points to" << keepIndices.count() << "using level" << level << "dropped" << dropCount;
+
+    QVector<double> latitudes   = _latitudes;
+    QVector<double> longitudes  = _longitudes;
+    QVector<float>  altitudes   = _altitudes;
+    QVector<qint64> timestamps  = _timestamps;
+
+    _clearPoints();
+    _latitudes.reserve(keepIndices.count());
+    _longitudes.reserve(keepIndices.count());
+    _altitudes.reserve(keepIndices.count());
+    _timestamps.reserve(keepIndices.count());
+    foreach (int index, keepIndices) {
+        _appendPoint(latitudes[index], longitudes[index], altitudes[index], timestamps[index]);
+    }
+
+    for (int i=1; i<levelCount; i++) {
+        if (i <= level) {
+            for (int index=0; index<simplifiedKeepCount; index++) {
+                _levelIndices[i].append(index);
+            }
+        } else {
+            _levelIndices[i] = coarserIndices[i];
+        }
+    }
+    _tailIndex = simplifiedKeepCount;
+
+    // Only blocks of the tail which filled up since the last simplification are left to simplify
+    _simplifyBlocks();
+}
+
+/// Douglas-Peucker simplification of the points from firstIndex to lastIndex inclusive
+///     @param indices Returned indices of the kept points in ascending order, always includes firstIndex and lastIndex
+void TrajectoryStore::_douglasPeucker(int firstIndex, int lastIndex, double tolerance, QVector<int>& indices) const
+{
+    QVector<bool> keep(lastIndex - firstIndex + 1, false);
+    QVector<QPair<int, int>> segments;
+
+    keep[0] = true;
+    keep[lastIndex - firstIndex] = true;
+    segments.append(qMakePair(firstIndex, lastIndex));
+
+    while (!segments.isEmpty()) {
+        QPair<int, int> segment = segments.takeLast();
+
+        double  maxDistance = 0;
+        int     maxIndex = -1;
+        for (int i=segment.first + 1; i<segment.second; i++) {
+            double distance = _distanceToSegment(i, segment.first, segment.second);
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                maxIndex = i;
+            }
+        }
+
+        if (maxIndex != -1 && maxDistance > tolerance) {
+            keep[maxIndex - firstIndex] = true;
+            segments.append(qMakePair(segment.first, maxIndex));
+            segments.append(qMakePair(maxIndex, segment.second));
+        }
+    }
+
+    indices.clear();
+    for (int i=0; i<keep.count(); i++) {
+        if (keep[i]) {
+            indices.append(firstIndex + i);
+        }
+    }
+}
+
+/// Distance in meters from a point to the segment between two other points. Uses a flat earth projection around the
+/// segment start which is accurate enough for the short distances within a block.
+double TrajectoryStore::_distanceToSegment(int index, int firstIndex, int lastIndex) const
+{
+    static const double earthRadiusMeters = 6371000.0;
+
+    double metersPerDegreeLat = qDegreesToRadians(earthRadiusMeters);
+    double metersPerDegreeLon = metersPerDegreeLat * qCos(qDegreesToRadians(_latitudes[firstIndex]));
+
+    double pointX = (_longitudes[index] - _longitudes[firstIndex]) * metersPerDegreeLon;
+    double pointY = (_latitudes[index] - _latitudes[firstIndex]) * metersPerDegreeLat;
+    double segmentX = (_longitudes[lastIndex] - _longitudes[firstIndex]) * metersPerDegreeLon;
+    double segmentY = (_latitudes[lastIndex] - _latitudes[firstIndex]) * metersPerDegreeLat;
+
+    double segmentLengthSquared = (segmentX * segmentX) + (segmentY * segmentY);
+    double t = 0;
+    if (segmentLengthSquared > 0) {
+        t = qBound(0.0, ((pointX * segmentX) + (pointY * segmentY)) / segmentLengthSquared, 1.0);
+    }
+
+    double deltaX = pointX - (t * segmentX);
+    double deltaY = pointY - (t * segmentY);
+
+    return qSqrt((deltaX * deltaX) + (deltaY * deltaY));
+}
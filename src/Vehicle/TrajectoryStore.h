@@ -0,0 +1,113 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QVector>
+#include <QVariantList>
+#include <QGeoCoordinate>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(TrajectoryStoreLog)
+
+/// Compact store for the flown trajectory of a vehicle.
+///
+/// Points are held in packed latitude/longitude/altitude/time arrays. New points closer than minPointSpacing to the
+/// previous point are dropped. Finished blocks of points are simplified with Douglas-Peucker at
+/// several tolerances, giving a level of detail pyramid from which the map takes a single polyline path matching its
+/// current scale. When the store is full the older part of the flight is replaced by one of its simplified levels so
+/// the whole flight stays visible within a fixed amount of memory.
+///
+/// A new point which only extends the displayed path is announced with pathPointAppended, so the map can add it to its
+/// polyline. pathChanged, which requires the whole path to be fetched again, is only sent when points already on the
+/// displayed path change.
+class TrajectoryStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    TrajectoryStore(QObject* parent = NULL);
+
+    /// Path to display as a list of QGeoCoordinate, simplified to match displayMetersPerPixel
+    Q_PROPERTY(QVariantList path                    READ path                                                   NOTIFY pathChanged)
+
+    /// Current map scale, set by the map so path can use the matching level of detail
+    Q_PROPERTY(double       displayMetersPerPixel   READ displayMetersPerPixel  WRITE setDisplayMetersPerPixel  NOTIFY displayMetersPerPixelChanged)
+
+    Q_PROPERTY(int          count                   READ count                                                  NOTIFY countChanged)
+
+    QVariantList    path                    (void) const;
+    double          displayMetersPerPixel   (void) const { return _displayMetersPerPixel; }
+    int             count                   (void) const { return _latitudes.count(); }
+
+    void setDisplayMetersPerPixel(double displayMetersPerPixel);
+
+    /// Adds a new point to the end of the trajectory
+    ///     @param msecsSinceEpoch Time at which the vehicle was at coordinate
+    void append(const QGeoCoordinate& coordinate, qint64 msecsSinceEpoch);
+
+    void clear(void);
+
+    QGeoCoordinate  coordinate  (int index) const;
+    qint64          timestamp   (int index) const { return _timestamps[index]; }
+
+    /// Sets the maximum number of points held before the older points are compacted
+    void setMaxPointCount(int maxPointCount);
+
+    /// @return Number of points in the given level of detail, level 0 is the full resolution path
+    int levelPointCount(int level) const;
+
+    /// @return Path for the given level of detail
+    QVariantList levelPath(int level) const;
+
+    /// Number of levels including full resolution
+    static const int levelCount = 5;
+
+    /// Douglas-Peucker tolerance in meters for each level
+    static const double levelTolerances[levelCount];
+
+    /// Points closer than this to the previous point are not stored
+    static const double minPointSpacing;
+
+    /// Number of points simplified together, the tail of the trajectory which does not fill a block yet is shown at full resolution
+    static const int blockSize = 128;
+
+signals:
+    /// The displayed path changed other than by appending a point
+    void pathChanged                    (void);
+
+    /// A point was appended to the end of the displayed path
+    void pathPointAppended              (const QGeoCoordinate& coordinate);
+    void displayMetersPerPixelChanged   (double displayMetersPerPixel);
+    void countChanged                   (int count);
+
+private:
+    int     _displayLevel       (void) const;
+    void    _clearPoints        (void);
+    void    _appendPoint        (double latitude, double longitude, float altitude, qint64 msecsSinceEpoch);
+    void    _simplifyBlocks     (void);
+    void    _compact            (void);
+    void    _douglasPeucker     (int firstIndex, int lastIndex, double tolerance, QVector<int>& indices) const;
+    double  _distanceToSegment  (int index, int firstIndex, int lastIndex) const;
+
+    QVector<double> _latitudes;
+    QVector<double> _longitudes;
+    QVector<float>  _altitudes;
+    QVector<qint64> _timestamps;
+
+    /// For each level above 0, indices of the points kept from the simplified blocks. The last point of each block is
+    /// also the first point of the next block and is not included.
+    QVector<int>    _levelIndices[levelCount];
+    int             _tailIndex;         ///< Index of the first point which is not simplified yet, start of the next block
+
+    int     _maxPointCount;
+    double  _displayMetersPerPixel;
+};
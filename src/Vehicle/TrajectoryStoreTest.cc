@@ -0,0 +1,147 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TrajectoryStoreTest.h"
+#include "TrajectoryStore.h"
+
+void TrajectoryStoreTest::_decimation_test(void)
+{
+    TrajectoryStore store;
+    QGeoCoordinate coord(47.0, 8.0, 100.0);
+
+    store.append(coord, 1000);
+    QCOMPARE(store.count(), 1);
+
+    // Hovering in place doesn't add points
+    store.append(coord.atDistanceAndAzimuth(TrajectoryStore::minPointSpacing / 2.0, 90), 2000);
+    QCOMPARE(store.count(), 1);
+
+    QGeoCoordinate nextCoord = coord.atDistanceAndAzimuth(10, 90);
+    store.append(nextCoord, 3000);
+    QCOMPARE(store.count(), 2);
+    QCOMPARE(store.timestamp(1), (qint64)3000);
+    QVERIFY(store.coordinate(1).distanceTo(nextCoord) < 0.01);
+    QCOMPARE(store.coordinate(1).altitude(), 100.0);
+
+    store.clear();
+    QCOMPARE(store.count(), 0);
+    QCOMPARE(store.path().count(), 0);
+}
+
+void TrajectoryStoreTest::_levelOfDetail_test(void)
+{
+    TrajectoryStore store;
+    QGeoCoordinate coord(47.0, 8.0);
+
+    // Straight line with a single 50 meter side step half way
+    const int cPoints = TrajectoryStore::blockSize * 8 + 10;
+    for (int i=0; i<cPoints; i++) {
+        QGeoCoordinate point = coord.atDistanceAndAzimuth(i * 10.0, 0);
+        if (i == cPoints / 2) {
+            point = point.atDistanceAndAzimuth(50, 90);
+        }
+        store.append(point, i * 1000);
+    }
+    QCOMPARE(store.count(), cPoints);
+    QCOMPARE(store.levelPointCount(0), cPoints);
+
+    // Levels get coarser, but all levels keep the end points and the side step which is larger than every tolerance
+    for (int level=1; level<TrajectoryStore::levelCount; level++) {
+        QVariantList path = store.levelPath(level);
+        QCOMPARE(path.count(), store.levelPointCount(level));
+        QVERIFY(path.count() <= store.levelPointCount(level - 1));
+        QVERIFY(path.first().value<QGeoCoordinate>().distanceTo(store.coordinate(0)) < 0.01);
+        QVERIFY(path.last().value<QGeoCoordinate>().distanceTo(store.coordinate(cPoints - 1)) < 0.01);
+
+        bool foundSideStep = false;
+        foreach (const QVariant& varCoord, path) {
+            if (varCoord.value<QGeoCoordinate>().distanceTo(store.coordinate(cPoints / 2)) < 0.01) {
+                foundSideStep = true;
+            }
+        }
+        QVERIFY(foundSideStep);
+    }
+
+    // Simplified blocks of a straight line reduce to the block end points and the side step plus its neighbours
+    int tailCount = cPoints - (TrajectoryStore::blockSize * 8);
+    QVERIFY(store.levelPointCount(TrajectoryStore::levelCount - 1) <= 8 + 2 + tailCount);
+
+    // Map scale selects the level
+    QSignalSpy spyPath(&store, &TrajectoryStore::pathChanged);
+    store.setDisplayMetersPerPixel(TrajectoryStore::levelTolerances[TrajectoryStore::levelCount - 1]);
+    QCOMPARE(spyPath.count(), 1);
+    QCOMPARE(store.path().count(), store.levelPointCount(TrajectoryStore::levelCount - 1));
+    store.setDisplayMetersPerPixel(0.01);
+    QCOMPARE(spyPath.count(), 2);
+    QCOMPARE(store.path().count(), cPoints);
+}
+
+void TrajectoryStoreTest::_compact_test(void)
+{
+    TrajectoryStore store;
+    QGeoCoordinate coord(47.0, 8.0);
+
+    const int cMaxPoints = TrajectoryStore::blockSize * 8;
+    store.setMaxPointCount(cMaxPoints);
+
+    // Zig zag which can't be simplified much, so the store must also drop old points
+    const int cPoints = cMaxPoints * 4;
+    QGeoCoordinate lastPoint;
+    for (int i=0; i<cPoints; i++) {
+        lastPoint = coord.atDistanceAndAzimuth(i * 10.0, 0).atDistanceAndAzimuth((i % 2) * 200.0, 90);
+        store.append(lastPoint, i * 1000);
+        QVERIFY(store.count() <= cMaxPoints);
+    }
+
+    // Newest part of the flight is still there at full resolution, time stays in order
+    QCOMPARE(store.timestamp(store.count() - 1), (qint64)(cPoints - 1) * 1000);
+    QVERIFY(store.coordinate(store.count() - 1).distanceTo(lastPoint) < 0.01);
+    for (int i=1; i<store.count(); i++) {
+        QVERIFY(store.timestamp(i) > store.timestamp(i - 1));
+    }
+    QVERIFY(store.count() >= cMaxPoints / 2);
+
+    // Levels carried over through compaction stay consistent
+    for (int level=1; level<TrajectoryStore::levelCount; level++) {
+        QVariantList path = store.levelPath(level);
+        QCOMPARE(path.count(), store.levelPointCount(level));
+        QVERIFY(path.count() <= store.levelPointCount(level - 1));
+        QVERIFY(path.last().value<QGeoCoordinate>().distanceTo(lastPoint) < 0.01);
+    }
+}
+
+void TrajectoryStoreTest::_incrementalPath_test(void)
+{
+    qRegisterMetaType<QGeoCoordinate>();
+
+    TrajectoryStore store;
+    QGeoCoordinate coord(47.0, 8.0);
+    QSignalSpy spyPath(&store, &TrajectoryStore::pathChanged);
+    QSignalSpy spyAppended(&store, &TrajectoryStore::pathPointAppended);
+
+    // The full resolution path only ever grows at its end
+    const int cBlocks = 3;
+    int pointIndex = 0;
+    for (; pointIndex<TrajectoryStore::blockSize * cBlocks + 1; pointIndex++) {
+        store.append(coord.atDistanceAndAzimuth(pointIndex * 10.0, 0), pointIndex * 1000);
+    }
+    QCOMPARE(spyPath.count(), 0);
+    QCOMPARE(spyAppended.count(), store.count());
+    QVERIFY(spyAppended.last().at(0).value<QGeoCoordinate>().distanceTo(store.coordinate(store.count() - 1)) < 0.01);
+
+    // A simplified path is fetched again each time a block is simplified
+    store.setDisplayMetersPerPixel(TrajectoryStore::levelTolerances[TrajectoryStore::levelCount - 1]);
+    spyPath.clear();
+    spyAppended.clear();
+    for (int i=0; i<TrajectoryStore::blockSize * cBlocks; i++, pointIndex++) {
+        store.append(coord.atDistanceAndAzimuth(pointIndex * 10.0, 0), pointIndex * 1000);
+    }
+    QCOMPARE(spyPath.count(), cBlocks);
+    QCOMPARE(spyAppended.count(), (TrajectoryStore::blockSize * cBlocks) - cBlocks);
+}
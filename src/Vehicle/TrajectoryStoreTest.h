@@ -0,0 +1,24 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for TrajectoryStore
+class TrajectoryStoreTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _decimation_test(void);
+    void _levelOfDetail_test(void);
+    void _compact_test(void);
+    void _incrementalPath_test(void);
+};
@@ -20,7 +20,6 @@
 #include "PlanMasterController.h"
 #include "GeoFenceManager.h"
 #include "RallyPointManager.h"
-#include "CoordinateVector.h"
 #include "ParameterManager.h"
 #include "QGCApplication.h"
 #include "QGCImageProvider.h"
@@ -33,6 +32,9 @@
 #include "QGCCorePlugin.h"
 #include "ADSBVehicle.h"
 
+#include <QtMath>
+#include <QDateTime>
+
 QGC_LOGGING_CATEGORY(VehicleLog, "VehicleLog")
 
 #define UPDATE_TIMER 50
@@ -45,6 +47,8 @@ const char* Vehicle::_settingsGroup =               "Vehicle%1";        // %1 re
 const char* Vehicle::_joystickModeSettingsKey =     "JoystickMode";
 const char* Vehicle::_joystickEnabledSettingsKey =  "JoystickEnabled";
 
+bool Vehicle::_messageTimingEnabled = false;
+
 const char* Vehicle::_rollFactName =                "roll";
 const char* Vehicle::_pitchFactName =               "pitch";
 const char* Vehicle::_headingFactName =             "heading";
@@ -69,11 +73,14 @@ Vehicle::Vehicle(LinkInterface*             link,
                  MAV_AUTOPILOT              firmwareType,
                  MAV_TYPE                   vehicleType,
                  FirmwarePluginManager*     firmwarePluginManager,
-                 JoystickManager*           joystickManager)
+                 JoystickManager*           joystickManager,
+                 bool                       fleetProfile)
     : FactGroup(_vehicleUIUpdateRateMSecs, ":/json/Vehicle/VehicleFact.json")
     , _id(vehicleId)
     , _defaultComponentId(defaultComponentId)
     , _active(false)
+    , _fleetProfile(fleetProfile)
+    , _parameterLoadDeferred(fleetProfile)
     , _offlineEditingVehicle(false)
     , _firmwareType(firmwareType)
     , _vehicleType(vehicleType)
@@ -230,11 +237,12 @@ Vehicle::Vehicle(LinkInterface*             link,
                    false,                                   // No error shown if fails
                     1);                                     // Request firmware version
 
-    _firmwarePlugin->initializeVehicle(this);
-
-    _sendMultipleTimer.start(_sendMessageMultipleIntraMessageDelay);
+    // Only runs while there are messages to send, see sendMessageMultiple
+    _sendMultipleTimer.setInterval(_sendMessageMultipleIntraMessageDelay);
     connect(&_sendMultipleTimer, &QTimer::timeout, this, &Vehicle::_sendMessageMultipleNext);
 
+    _firmwarePlugin->initializeVehicle(this);
+
     _mapTrajectoryTimer.setInterval(_mapTrajectoryMsecsBetweenPoints);
     connect(&_mapTrajectoryTimer, &QTimer::timeout, this, &Vehicle::_addNewMapTrajectoryPoint);
 }
@@ -248,6 +256,8 @@ Vehicle::Vehicle(MAV_AUTOPILOT              firmwareType,
     , _id(0)
     , _defaultComponentId(MAV_COMP_ID_ALL)
     , _active(false)
+    , _fleetProfile(false)
+    , _parameterLoadDeferred(false)
     , _offlineEditingVehicle(true)
     , _firmwareType(firmwareType)
     , _vehicleType(vehicleType)
@@ -548,118 +558,123 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
         return;
     }
 
-    switch (message.msgid) {
-    case MAVLINK_MSG_ID_HOME_POSITION:
-        _handleHomePosition(message);
-        break;
-    case MAVLINK_MSG_ID_HEARTBEAT:
-        _handleHeartbeat(message);
-        break;
-    case MAVLINK_MSG_ID_RADIO_STATUS:
-        _handleRadioStatus(message);
-        break;
-    case MAVLINK_MSG_ID_RC_CHANNELS:
-        _handleRCChannels(message);
-        break;
-    case MAVLINK_MSG_ID_RC_CHANNELS_RAW:
-        _handleRCChannelsRaw(message);
-        break;
-    case MAVLINK_MSG_ID_BATTERY_STATUS:
-        _handleBatteryStatus(message);
-        break;
-    case MAVLINK_MSG_ID_SYS_STATUS:
-        _handleSysStatus(message);
-        break;
-    case MAVLINK_MSG_ID_RAW_IMU:
-        emit mavlinkRawImu(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_IMU:
-        emit mavlinkScaledImu1(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_IMU2:
-        emit mavlinkScaledImu2(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_IMU3:
-        emit mavlinkScaledImu3(message);
-        break;
-    case MAVLINK_MSG_ID_VIBRATION:
-        _handleVibration(message);
-        break;
-    case MAVLINK_MSG_ID_EXTENDED_SYS_STATE:
-        _handleExtendedSysState(message);
-        break;
-    case MAVLINK_MSG_ID_COMMAND_ACK:
-        _handleCommandAck(message);
-        break;
-    case MAVLINK_MSG_ID_COMMAND_LONG:
-        _handleCommandLong(message);
-        break;
-    case MAVLINK_MSG_ID_AUTOPILOT_VERSION:
-        _handleAutopilotVersion(link, message);
-        break;
-    case MAVLINK_MSG_ID_PROTOCOL_VERSION:
-        _handleProtocolVersion(link, message);
-        break;
-    case MAVLINK_MSG_ID_WIND_COV:
-        _handleWindCov(message);
-        break;
-    case MAVLINK_MSG_ID_HIL_ACTUATOR_CONTROLS:
-        _handleHilActuatorControls(message);
-        break;
-    case MAVLINK_MSG_ID_LOGGING_DATA:
-        _handleMavlinkLoggingData(message);
-        break;
-    case MAVLINK_MSG_ID_LOGGING_DATA_ACKED:
-        _handleMavlinkLoggingDataAcked(message);
-        break;
-    case MAVLINK_MSG_ID_GPS_RAW_INT:
-        _handleGpsRawInt(message);
-        break;
-    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
-        _handleGlobalPositionInt(message);
-        break;
-    case MAVLINK_MSG_ID_ALTITUDE:
-        _handleAltitude(message);
-        break;
-    case MAVLINK_MSG_ID_VFR_HUD:
-        _handleVfrHud(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_PRESSURE:
-        _handleScaledPressure(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_PRESSURE2:
-        _handleScaledPressure2(message);
-        break;
-    case MAVLINK_MSG_ID_SCALED_PRESSURE3:
-        _handleScaledPressure3(message);
-        break;        
-    case MAVLINK_MSG_ID_CAMERA_FEEDBACK:
-        _handleCameraFeedback(message);
-        break;
-    case MAVLINK_MSG_ID_CAMERA_IMAGE_CAPTURED:
-        _handleCameraImageCaptured(message);
-        break;
-    case MAVLINK_MSG_ID_ADSB_VEHICLE:
-        _handleADSBVehicle(message);
-        break;
+    QElapsedTimer timingTimer;
+    qint64 handlerNsecs = 0;
+    if (_messageTimingEnabled) {
+        timingTimer.start();
+    }
 
-    case MAVLINK_MSG_ID_SERIAL_CONTROL:
-    {
-        mavlink_serial_control_t ser;
-        mavlink_msg_serial_control_decode(&message, &ser);
-        emit mavlinkSerialControl(ser.device, ser.flags, ser.timeout, ser.baudrate, QByteArray(reinterpret_cast<const char*>(ser.data), ser.count));
+    MessageHandler handler = _messageHandlers().value(message.msgid, NULL);
+    if (handler) {
+        handler(this, link, message);
     }
-        break;
-    // Following are ArduPilot dialect messages
 
-    case MAVLINK_MSG_ID_WIND:
-        _handleWind(message);
-        break;
+    if (_messageTimingEnabled) {
+        handlerNsecs = timingTimer.nsecsElapsed();
     }
 
     emit mavlinkMessageReceived(message);
 
     _uas->receiveMessage(message);
+
+    if (_messageTimingEnabled) {
+        _recordMessageTiming(message.msgid, handlerNsecs, timingTimer.nsecsElapsed());
+    }
+}
+
+/// Receive dispatch table, built once from the handler list below
+const QHash<uint32_t, Vehicle::MessageHandler>& Vehicle::_messageHandlers(void)
+{
+    static QHash<uint32_t, MessageHandler> handlers;
+
+    if (handlers.isEmpty()) {
+#define VEHICLE_MESSAGE_HANDLER(MSGID, HANDLER_CALL) \
+        handlers[MSGID] = [](Vehicle* vehicle, LinkInterface* link, mavlink_message_t& message) { Q_UNUSED(link); vehicle->HANDLER_CALL; };
+
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_HOME_POSITION,           _handleHomePosition(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_HEARTBEAT,               _handleHeartbeat(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_RADIO_STATUS,            _handleRadioStatus(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_RC_CHANNELS,             _handleRCChannels(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_RC_CHANNELS_RAW,         _handleRCChannelsRaw(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_BATTERY_STATUS,          _handleBatteryStatus(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_SYS_STATUS,              _handleSysStatus(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_RAW_IMU,                 mavlinkRawImu(message))        // Signal
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_SCALED_IMU,              mavlinkScaledImu1(message))    // Signal
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_SCALED_IMU2,             mavlinkScaledImu2(message))    // Signal
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_SCALED_IMU3,             mavlinkScaledImu3(message))    // Signal
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_VIBRATION,               _handleVibration(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_EXTENDED_SYS_STATE,      _handleExtendedSysState(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_COMMAND_ACK,             _handleCommandAck(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_COMMAND_LONG,            _handleCommandLong(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_AUTOPILOT_VERSION,       _handleAutopilotVersion(link, message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_PROTOCOL_VERSION,        _handleProtocolVersion(link, message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_WIND_COV,                _handleWindCov(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_HIL_ACTUATOR_CONTROLS,   _handleHilActuatorControls(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_LOGGING_DATA,            _handleMavlinkLoggingData(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_LOGGING_DATA_ACKED,      _handleMavlinkLoggingDataAcked(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_GPS_RAW_INT,             _handleGpsRawInt(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_GLOBAL_POSITION_INT,     _handleGlobalPositionInt(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_ALTITUDE,                _handleAltitude(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_VFR_HUD,                 _handleVfrHud(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_SCALED_PRESSURE,         _handleScaledPressure(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_SCALED_PRESSURE2,        _handleScaledPressure2(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_SCALED_PRESSURE3,        _handleScaledPressure3(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_CAMERA_FEEDBACK,         _handleCameraFeedback(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_CAMERA_IMAGE_CAPTURED,   _handleCameraImageCaptured(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_ADSB_VEHICLE,            _handleADSBVehicle(message))
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_SERIAL_CONTROL,          _handleSerialControl(message))
+
+        // Following are ArduPilot dialect messages
+        VEHICLE_MESSAGE_HANDLER(MAVLINK_MSG_ID_WIND,                    _handleWind(message))
+
+#undef VEHICLE_MESSAGE_HANDLER
+    }
+
+    return handlers;
+}
+
+void Vehicle::_recordMessageTiming(uint32_t msgid, qint64 handlerNsecs, qint64 totalNsecs)
+{
+    MessageTiming& timing = _messageTimings[msgid];
+
+    timing.count++;
+    timing.handlerNsecs += handlerNsecs;
+    timing.totalNsecs += totalNsecs;
+    timing.maxNsecs = qMax(timing.maxNsecs, (quint64)totalNsecs);
+    timing.histogram[MessageTiming::histogramBucket(totalNsecs / 1000)]++;
+}
+
+int Vehicle::MessageTiming::histogramBucket(qint64 usecs)
+{
+    int bucket = 0;
+
+    for (; usecs > 0 && bucket < histogramBucketCount - 1; usecs >>= 1) {
+        bucket++;
+    }
+
+    return bucket;
+}
+
+int Vehicle::MessageTiming::percentileUSecs(double percentile) const
+{
+    quint64 threshold = (quint64)qCeil(count * percentile);
+    quint64 sum = 0;
+
+    for (int bucket=0; bucket<histogramBucketCount; bucket++) {
+        sum += histogram[bucket];
+        if (sum >= threshold) {
+            return 1 << bucket;
+        }
+    }
+
+    return 1 << (histogramBucketCount - 1);
+}
+
+void Vehicle::_handleSerialControl(mavlink_message_t& message)
+{
+    mavlink_serial_control_t ser;
+    mavlink_msg_serial_control_decode(&message, &ser);
+    emit mavlinkSerialControl(ser.device, ser.flags, ser.timeout, ser.baudrate, QByteArray(reinterpret_cast<const char*>(ser.data), ser.count));
 }
 
 
@@ -692,9 +707,9 @@ void Vehicle::_handleVfrHud(mavlink_message_t& message)
     mavlink_vfr_hud_t vfrHud;
     mavlink_msg_vfr_hud_decode(&message, &vfrHud);
 
-    _airSpeedFact.setRawValue(qIsNaN(vfrHud.airspeed) ? 0 : vfrHud.airspeed);
-    _groundSpeedFact.setRawValue(qIsNaN(vfrHud.groundspeed) ? 0 : vfrHud.groundspeed);
-    _climbRateFact.setRawValue(qIsNaN(vfrHud.climb) ? 0 : vfrHud.climb);
+    _airSpeedFact.setRawNumericValue(qIsNaN(vfrHud.airspeed) ? 0 : vfrHud.airspeed);
+    _groundSpeedFact.setRawNumericValue(qIsNaN(vfrHud.groundspeed) ? 0 : vfrHud.groundspeed);
+    _climbRateFact.setRawNumericValue(qIsNaN(vfrHud.climb) ? 0 : vfrHud.climb);
 }
 
 void Vehicle::_handleGpsRawInt(mavlink_message_t& message)
@@ -711,17 +726,17 @@ void Vehicle::_handleGpsRawInt(mavlink_message_t& message)
             _coordinate.setLongitude(gpsRawInt.lon / (double)1E7);
             _coordinate.setAltitude(gpsRawInt.alt  / 1000.0);
             emit coordinateChanged(_coordinate);
-            _altitudeAMSLFact.setRawValue(gpsRawInt.alt / 1000.0);
+            _altitudeAMSLFact.setRawNumericValue(gpsRawInt.alt / 1000.0);
         }
     }
 
-    _gpsFactGroup.lat()->setRawValue(gpsRawInt.lat * 1e-7);
-    _gpsFactGroup.lon()->setRawValue(gpsRawInt.lon * 1e-7);
-    _gpsFactGroup.count()->setRawValue(gpsRawInt.satellites_visible == 255 ? 0 : gpsRawInt.satellites_visible);
-    _gpsFactGroup.hdop()->setRawValue(gpsRawInt.eph == UINT16_MAX ? std::numeric_limits<double>::quiet_NaN() : gpsRawInt.eph / 100.0);
-    _gpsFactGroup.vdop()->setRawValue(gpsRawInt.epv == UINT16_MAX ? std::numeric_limits<double>::quiet_NaN() : gpsRawInt.epv / 100.0);
-    _gpsFactGroup.courseOverGround()->setRawValue(gpsRawInt.cog == UINT16_MAX ? std::numeric_limits<double>::quiet_NaN() : gpsRawInt.cog / 100.0);
-    _gpsFactGroup.lock()->setRawValue(gpsRawInt.fix_type);
+    _gpsFactGroup.lat()->setRawNumericValue(gpsRawInt.lat * 1e-7);
+    _gpsFactGroup.lon()->setRawNumericValue(gpsRawInt.lon * 1e-7);
+    _gpsFactGroup.count()->setRawNumericValue(gpsRawInt.satellites_visible == 255 ? 0 : gpsRawInt.satellites_visible);
+    _gpsFactGroup.hdop()->setRawNumericValue(gpsRawInt.eph == UINT16_MAX ? std::numeric_limits<double>::quiet_NaN() : gpsRawInt.eph / 100.0);
+    _gpsFactGroup.vdop()->setRawNumericValue(gpsRawInt.epv == UINT16_MAX ? std::numeric_limits<double>::quiet_NaN() : gpsRawInt.epv / 100.0);
+    _gpsFactGroup.courseOverGround()->setRawNumericValue(gpsRawInt.cog == UINT16_MAX ? std::numeric_limits<double>::quiet_NaN() : gpsRawInt.cog / 100.0);
+    _gpsFactGroup.lock()->setRawNumericValue(gpsRawInt.fix_type);
 }
 
 void Vehicle::_handleGlobalPositionInt(mavlink_message_t& message)
@@ -729,8 +744,8 @@ void Vehicle::_handleGlobalPositionInt(mavlink_message_t& message)
     mavlink_global_position_int_t globalPositionInt;
     mavlink_msg_global_position_int_decode(&message, &globalPositionInt);
 
-    _altitudeRelativeFact.setRawValue(globalPositionInt.relative_alt / 1000.0);
-    _altitudeAMSLFact.setRawValue(globalPositionInt.alt / 1000.0);
+    _altitudeRelativeFact.setRawNumericValue(globalPositionInt.relative_alt / 1000.0);
+    _altitudeAMSLFact.setRawNumericValue(globalPositionInt.alt / 1000.0);
 
     // ArduPilot sends bogus GLOBAL_POSITION_INT messages with lat/lat 0/0 even when it has no gps signal
     // Apparently, this is in order to transport relative altitude information.
@@ -753,9 +768,9 @@ void Vehicle::_handleAltitude(mavlink_message_t& message)
 
     // If data from GPS is available it takes precedence over ALTITUDE message
     if (!_globalPositionIntMessageAvailable) {
-        _altitudeRelativeFact.setRawValue(altitude.altitude_relative);
+        _altitudeRelativeFact.setRawNumericValue(altitude.altitude_relative);
         if (!_gpsRawIntMessageAvailable) {
-            _altitudeAMSLFact.setRawValue(altitude.altitude_amsl);
+            _altitudeAMSLFact.setRawNumericValue(altitude.altitude_amsl);
         }
     }
 }
@@ -984,12 +999,12 @@ void Vehicle::_handleVibration(mavlink_message_t& message)
     mavlink_vibration_t vibration;
     mavlink_msg_vibration_decode(&message, &vibration);
 
-    _vibrationFactGroup.xAxis()->setRawValue(vibration.vibration_x);
-    _vibrationFactGroup.yAxis()->setRawValue(vibration.vibration_y);
-    _vibrationFactGroup.zAxis()->setRawValue(vibration.vibration_z);
-    _vibrationFactGroup.clipCount1()->setRawValue(vibration.clipping_0);
-    _vibrationFactGroup.clipCount2()->setRawValue(vibration.clipping_1);
-    _vibrationFactGroup.clipCount3()->setRawValue(vibration.clipping_2);
+    _vibrationFactGroup.xAxis()->setRawNumericValue(vibration.vibration_x);
+    _vibrationFactGroup.yAxis()->setRawNumericValue(vibration.vibration_y);
+    _vibrationFactGroup.zAxis()->setRawNumericValue(vibration.vibration_z);
+    _vibrationFactGroup.clipCount1()->setRawNumericValue(vibration.clipping_0);
+    _vibrationFactGroup.clipCount2()->setRawNumericValue(vibration.clipping_1);
+    _vibrationFactGroup.clipCount3()->setRawNumericValue(vibration.clipping_2);
 }
 
 void Vehicle::_handleWindCov(mavlink_message_t& message)
@@ -1000,9 +1015,9 @@ void Vehicle::_handleWindCov(mavlink_message_t& message)
     float direction = qRadiansToDegrees(qAtan2(wind.wind_y, wind.wind_x));
     float speed = qSqrt(qPow(wind.wind_x, 2) + qPow(wind.wind_y, 2));
 
-    _windFactGroup.direction()->setRawValue(direction);
-    _windFactGroup.speed()->setRawValue(speed);
-    _windFactGroup.verticalSpeed()->setRawValue(0);
+    _windFactGroup.direction()->setRawNumericValue(direction);
+    _windFactGroup.speed()->setRawNumericValue(speed);
+    _windFactGroup.verticalSpeed()->setRawNumericValue(0);
 }
 
 void Vehicle::_handleWind(mavlink_message_t& message)
@@ -1010,9 +1025,9 @@ void Vehicle::_handleWind(mavlink_message_t& message)
     mavlink_wind_t wind;
     mavlink_msg_wind_decode(&message, &wind);
 
-    _windFactGroup.direction()->setRawValue(wind.direction);
-    _windFactGroup.speed()->setRawValue(wind.speed);
-    _windFactGroup.verticalSpeed()->setRawValue(wind.speed_z);
+    _windFactGroup.direction()->setRawNumericValue(wind.direction);
+    _windFactGroup.speed()->setRawNumericValue(wind.speed);
+    _windFactGroup.verticalSpeed()->setRawNumericValue(wind.speed_z);
 }
 
 void Vehicle::_handleSysStatus(mavlink_message_t& message)
@@ -1021,17 +1036,17 @@ void Vehicle::_handleSysStatus(mavlink_message_t& message)
     mavlink_msg_sys_status_decode(&message, &sysStatus);
 
     if (sysStatus.current_battery == -1) {
-        _batteryFactGroup.current()->setRawValue(VehicleBatteryFactGroup::_currentUnavailable);
+        _batteryFactGroup.current()->setRawNumericValue(VehicleBatteryFactGroup::_currentUnavailable);
     } else {
         // Current is in Amps, current_battery is 10 * milliamperes (1 = 10 milliampere)
-        _batteryFactGroup.current()->setRawValue((float)sysStatus.current_battery / 100.0f);
+        _batteryFactGroup.current()->setRawNumericValue((float)sysStatus.current_battery / 100.0f);
     }
     if (sysStatus.voltage_battery == UINT16_MAX) {
-        _batteryFactGroup.voltage()->setRawValue(VehicleBatteryFactGroup::_voltageUnavailable);
+        _batteryFactGroup.voltage()->setRawNumericValue(VehicleBatteryFactGroup::_voltageUnavailable);
     } else {
-        _batteryFactGroup.voltage()->setRawValue((double)sysStatus.voltage_battery / 1000.0);
+        _batteryFactGroup.voltage()->setRawNumericValue((double)sysStatus.voltage_battery / 1000.0);
     }
-    _batteryFactGroup.percentRemaining()->setRawValue(sysStatus.battery_remaining);
+    _batteryFactGroup.percentRemaining()->setRawNumericValue(sysStatus.battery_remaining);
 
     if (sysStatus.battery_remaining > 0 &&
             sysStatus.battery_remaining < _settingsManager->appSettings()->batteryPercentRemainingAnnounce()->rawValue().toInt() &&
@@ -1057,14 +1072,14 @@ void Vehicle::_handleBatteryStatus(mavlink_message_t& message)
     mavlink_msg_battery_status_decode(&message, &bat_status);
 
     if (bat_status.temperature == INT16_MAX) {
-        _batteryFactGroup.temperature()->setRawValue(VehicleBatteryFactGroup::_temperatureUnavailable);
+        _batteryFactGroup.temperature()->setRawNumericValue(VehicleBatteryFactGroup::_temperatureUnavailable);
     } else {
-        _batteryFactGroup.temperature()->setRawValue((double)bat_status.temperature / 100.0);
+        _batteryFactGroup.temperature()->setRawNumericValue((double)bat_status.temperature / 100.0);
     }
     if (bat_status.current_consumed == -1) {
-        _batteryFactGroup.mahConsumed()->setRawValue(VehicleBatteryFactGroup::_mahConsumedUnavailable);
+        _batteryFactGroup.mahConsumed()->setRawNumericValue(VehicleBatteryFactGroup::_mahConsumedUnavailable);
     } else {
-        _batteryFactGroup.mahConsumed()->setRawValue(bat_status.current_consumed);
+        _batteryFactGroup.mahConsumed()->setRawNumericValue(bat_status.current_consumed);
     }
 
     int cellCount = 0;
@@ -1077,7 +1092,7 @@ void Vehicle::_handleBatteryStatus(mavlink_message_t& message)
         cellCount = -1;
     }
 
-    _batteryFactGroup.cellCount()->setRawValue(cellCount);
+    _batteryFactGroup.cellCount()->setRawNumericValue(cellCount);
 }
 
 void Vehicle::_setHomePosition(QGeoCoordinate& homeCoord)
@@ -1290,19 +1305,19 @@ void Vehicle::_handleRCChannelsRaw(mavlink_message_t& message)
 void Vehicle::_handleScaledPressure(mavlink_message_t& message) {
     mavlink_scaled_pressure_t pressure;
     mavlink_msg_scaled_pressure_decode(&message, &pressure);
-    _temperatureFactGroup.temperature1()->setRawValue(pressure.temperature / 100.0);
+    _temperatureFactGroup.temperature1()->setRawNumericValue(pressure.temperature / 100.0);
 }
 
 void Vehicle::_handleScaledPressure2(mavlink_message_t& message) {
     mavlink_scaled_pressure2_t pressure;
     mavlink_msg_scaled_pressure2_decode(&message, &pressure);
-    _temperatureFactGroup.temperature2()->setRawValue(pressure.temperature / 100.0);
+    _temperatureFactGroup.temperature2()->setRawNumericValue(pressure.temperature / 100.0);
 }
 
 void Vehicle::_handleScaledPressure3(mavlink_message_t& message) {
     mavlink_scaled_pressure3_t pressure;
     mavlink_msg_scaled_pressure3_decode(&message, &pressure);
-    _temperatureFactGroup.temperature3()->setRawValue(pressure.temperature / 100.0);
+    _temperatureFactGroup.temperature3()->setRawNumericValue(pressure.temperature / 100.0);
 }
 
 bool Vehicle::_containsLink(LinkInterface* link)
@@ -1413,21 +1428,21 @@ void Vehicle::_updatePriorityLink(void)
 void Vehicle::_updateAttitude(UASInterface*, double roll, double pitch, double yaw, quint64)
 {
     if (qIsInf(roll)) {
-        _rollFact.setRawValue(0);
+        _rollFact.setRawNumericValue(0);
     } else {
-        _rollFact.setRawValue(roll * (180.0 / M_PI));
+        _rollFact.setRawNumericValue(roll * (180.0 / M_PI));
     }
     if (qIsInf(pitch)) {
-        _pitchFact.setRawValue(0);
+        _pitchFact.setRawNumericValue(0);
     } else {
-        _pitchFact.setRawValue(pitch * (180.0 / M_PI));
+        _pitchFact.setRawNumericValue(pitch * (180.0 / M_PI));
     }
     if (qIsInf(yaw)) {
-        _headingFact.setRawValue(0);
+        _headingFact.setRawNumericValue(0);
     } else {
         yaw = yaw * (180.0 / M_PI);
         if (yaw < 0) yaw += 360;
-        _headingFact.setRawValue(yaw);
+        _headingFact.setRawNumericValue(yaw);
     }
 }
 
@@ -1480,13 +1495,9 @@ QString Vehicle::getMavIconColor()
         return QString("black");
 }
 
-QString Vehicle::formatedMessages()
+QAbstractListModel* Vehicle::messageModel()
 {
-    QString messages;
-    foreach(UASMessage* message, _toolbox->uasMessageHandler()->messages()) {
-        messages += message->getFormatedText();
-    }
-    return messages;
+    return _toolbox->uasMessageHandler()->messageModel();
 }
 
 void Vehicle::clearMessages()
@@ -1699,6 +1710,26 @@ void Vehicle::setActive(bool active)
     _startJoystick(_active);
 }
 
+void Vehicle::setFleetProfile(bool fleetProfile)
+{
+    if (fleetProfile == _fleetProfile) {
+        return;
+    }
+
+    qCDebug(VehicleLog) << "setFleetProfile" << _id << fleetProfile;
+
+    _fleetProfile = fleetProfile;
+    emit fleetProfileChanged(_fleetProfile);
+
+    _firmwarePlugin->requestTelemetryStreams(this);
+
+    // Once loaded, parameters and plan stay loaded when the vehicle goes back to the fleet profile
+    if (!_fleetProfile && _parameterLoadDeferred) {
+        _parameterLoadDeferred = false;
+        _parameterManager->refreshAllParameters();
+    }
+}
+
 QGeoCoordinate Vehicle::homePosition(void)
 {
     return _homePosition;
@@ -1821,6 +1852,10 @@ void Vehicle::_sendMessageMultipleNext(void)
     if (_nextSendMessageMultipleIndex >= _sendMessageMultipleList.count()) {
         _nextSendMessageMultipleIndex = 0;
     }
+
+    if (_sendMessageMultipleList.isEmpty()) {
+        _sendMultipleTimer.stop();
+    }
 }
 
 void Vehicle::sendMessageMultiple(mavlink_message_t message)
@@ -1831,6 +1866,10 @@ void Vehicle::sendMessageMultiple(mavlink_message_t message)
     info.retryCount =   _sendMessageMultipleRetries;
 
     _sendMessageMultipleList.append(info);
+
+    if (!_sendMultipleTimer.isActive()) {
+        _sendMultipleTimer.start();
+    }
 }
 
 void Vehicle::_missionManagerError(int errorCode, const QString& errorMsg)
@@ -1853,24 +1892,18 @@ void Vehicle::_rallyPointManagerError(int errorCode, const QString& errorMsg)
 
 void Vehicle::_addNewMapTrajectoryPoint(void)
 {
+    _mapTrajectory.append(_coordinate, QDateTime::currentMSecsSinceEpoch());
     if (_mapTrajectoryHaveFirstCoordinate) {
-        // Keep three minutes of trajectory on mobile due to perf impact of lines
-#ifdef __mobile__
-        if (_mapTrajectoryList.count() * _mapTrajectoryMsecsBetweenPoints > 3 * 1000 * 60) {
-            _mapTrajectoryList.removeAt(0)->deleteLater();
-        }
-#endif
-        _mapTrajectoryList.append(new CoordinateVector(_mapTrajectoryLastCoordinate, _coordinate, this));
-        _flightDistanceFact.setRawValue(_flightDistanceFact.rawValue().toDouble() + _mapTrajectoryLastCoordinate.distanceTo(_coordinate));
+        _flightDistanceFact.setRawNumericValue(_flightDistanceFact.rawNumericValue() + _mapTrajectoryLastCoordinate.distanceTo(_coordinate));
     }
     _mapTrajectoryHaveFirstCoordinate = true;
     _mapTrajectoryLastCoordinate = _coordinate;
-    _flightTimeFact.setRawValue((double)_flightTimer.elapsed() / 1000.0);
+    _flightTimeFact.setRawNumericValue((double)_flightTimer.elapsed() / 1000.0);
 }
 
 void Vehicle::_clearTrajectoryPoints(void)
 {
-    _mapTrajectoryList.clearAndDeleteContents();
+    _mapTrajectory.clear();
 }
 
 void Vehicle::_clearCameraTriggerPoints(void)
@@ -2800,9 +2833,9 @@ void Vehicle::_handleADSBVehicle(const mavlink_message_t& message)
 void Vehicle::_updateDistanceToHome(void)
 {
     if (coordinate().isValid() && homePosition().isValid()) {
-        _distanceToHomeFact.setRawValue(coordinate().distanceTo(homePosition()));
+        _distanceToHomeFact.setRawNumericValue(coordinate().distanceTo(homePosition()));
     } else {
-        _distanceToHomeFact.setRawValue(qQNaN());
+        _distanceToHomeFact.setRawNumericValue(qQNaN());
     }
 }
 
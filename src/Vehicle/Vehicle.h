@@ -12,11 +12,14 @@
 #include <QObject>
 #include <QGeoCoordinate>
 #include <QElapsedTimer>
+#include <QHash>
+#include <QAbstractListModel>
 
 #include "FactGroup.h"
 #include "LinkInterface.h"
 #include "QGCMAVLink.h"
 #include "QmlObjectListModel.h"
+#include "TrajectoryStore.h"
 #include "MAVLinkProtocol.h"
 #include "UASMessageHandler.h"
 #include "SettingsFact.h"
@@ -229,7 +232,8 @@ public:
             MAV_AUTOPILOT           firmwareType,
             MAV_TYPE                vehicleType,
             FirmwarePluginManager*  firmwarePluginManager,
-            JoystickManager*        joystickManager);
+            JoystickManager*        joystickManager,
+            bool                    fleetProfile = false);
 
     // The following is used to create a disconnected Vehicle for use while offline editing.
     Vehicle(MAV_AUTOPILOT           firmwareType,
@@ -249,7 +253,7 @@ public:
     Q_PROPERTY(QStringList          flightModes             READ flightModes                                            CONSTANT)
     Q_PROPERTY(QString              flightMode              READ flightMode             WRITE setFlightMode             NOTIFY flightModeChanged)
     Q_PROPERTY(bool                 hilMode                 READ hilMode                WRITE setHilMode                NOTIFY hilModeChanged)
-    Q_PROPERTY(QmlObjectListModel*  trajectoryPoints        READ trajectoryPoints                                       CONSTANT)
+    Q_PROPERTY(TrajectoryStore*     trajectory              READ trajectory                                             CONSTANT)
     Q_PROPERTY(QmlObjectListModel*  cameraTriggerPoints     READ cameraTriggerPoints                                    CONSTANT)
     Q_PROPERTY(float                latitude                READ latitude                                               NOTIFY coordinateChanged)
     Q_PROPERTY(float                longitude               READ longitude                                              NOTIFY coordinateChanged)
@@ -259,13 +263,14 @@ public:
     Q_PROPERTY(bool                 messageTypeError        READ messageTypeError                                       NOTIFY messageTypeChanged)
     Q_PROPERTY(int                  newMessageCount         READ newMessageCount                                        NOTIFY newMessageCountChanged)
     Q_PROPERTY(int                  messageCount            READ messageCount                                           NOTIFY messageCountChanged)
-    Q_PROPERTY(QString              formatedMessages        READ formatedMessages                                       NOTIFY formatedMessagesChanged)
+    Q_PROPERTY(QAbstractListModel*  messageModel            READ messageModel                                           CONSTANT)
     Q_PROPERTY(QString              formatedMessage         READ formatedMessage                                        NOTIFY formatedMessageChanged)
     Q_PROPERTY(QString              latestError             READ latestError                                            NOTIFY latestErrorChanged)
     Q_PROPERTY(int                  joystickMode            READ joystickMode           WRITE setJoystickMode           NOTIFY joystickModeChanged)
     Q_PROPERTY(QStringList          joystickModes           READ joystickModes                                          CONSTANT)
     Q_PROPERTY(bool                 joystickEnabled         READ joystickEnabled        WRITE setJoystickEnabled        NOTIFY joystickEnabledChanged)
     Q_PROPERTY(bool                 active                  READ active                 WRITE setActive                 NOTIFY activeChanged)
+    Q_PROPERTY(bool                 fleetProfile            READ fleetProfile                                           NOTIFY fleetProfileChanged)
     Q_PROPERTY(int                  flowImageIndex          READ flowImageIndex                                         NOTIFY flowImageIndexChanged)
     Q_PROPERTY(int                  rcRSSI                  READ rcRSSI                                                 NOTIFY rcRSSIChanged)
     Q_PROPERTY(bool                 px4Firmware             READ px4Firmware                                            NOTIFY firmwareTypeChanged)
@@ -462,6 +467,12 @@ public:
     bool active(void);
     void setActive(bool active);
 
+    /// true: Vehicle runs the telemetry only profile used for vehicles which are not selected in fleet mode. Parameters
+    /// and plan are not loaded and telemetry is requested at reduced rates. Turning the profile off starts the
+    /// deferred loads and restores the normal rates.
+    bool fleetProfile(void) const { return _fleetProfile; }
+    void setFleetProfile(bool fleetProfile);
+
     // Property accesors
     int id(void) { return _id; }
     MAV_AUTOPILOT firmwareType(void) const { return _firmwareType; }
@@ -480,6 +491,34 @@ public:
     /// guarantee that it makes it to the vehicle.
     void sendMessageMultiple(mavlink_message_t message);
 
+    /// Receive path timing for a single message id. Bucket i of the histogram counts messages which took less
+    /// than 2^i microseconds (and at least 2^(i-1)), the last bucket also holds everything slower.
+    struct MessageTiming {
+        MessageTiming(void) : count(0), handlerNsecs(0), totalNsecs(0), maxNsecs(0) { memset(histogram, 0, sizeof(histogram)); }
+
+        /// @return Upper bound in microseconds of the histogram bucket which contains the percentile [0,1]
+        int percentileUSecs(double percentile) const;
+
+        /// @return Histogram bucket for a message which took the specified number of microseconds
+        static int histogramBucket(qint64 usecs);
+
+        static const int histogramBucketCount = 16;
+
+        quint64 count;
+        quint64 handlerNsecs;   ///< Time spent in the Vehicle handler for the message
+        quint64 totalNsecs;     ///< Time for the whole receive path: handler, mavlinkMessageReceived signal and UAS
+        quint64 maxNsecs;
+        quint32 histogram[histogramBucketCount];
+    };
+
+    /// Enables collection of receive path timing for all vehicles. Off by default since it adds two clock reads per message.
+    static void setMessageTimingEnabled(bool enabled) { _messageTimingEnabled = enabled; }
+    static bool messageTimingEnabled(void) { return _messageTimingEnabled; }
+
+    /// @return Receive path timing collected while timing was enabled, key is message id
+    const QMap<uint32_t, MessageTiming>& messageTimings(void) const { return _messageTimings; }
+    void clearMessageTimings(void) { _messageTimings.clear(); }
+
     /// Provides access to uas from vehicle. Temporary workaround until UAS is fully phased out.
     UAS* uas(void) { return _uas; }
 
@@ -525,7 +564,7 @@ public:
     QString prearmError(void) const { return _prearmError; }
     void setPrearmError(const QString& prearmError);
 
-    QmlObjectListModel* trajectoryPoints(void) { return &_mapTrajectoryList; }
+    TrajectoryStore* trajectory(void) { return &_mapTrajectory; }
     QmlObjectListModel* cameraTriggerPoints(void) { return &_cameraTriggerPoints; }
     QmlObjectListModel* adsbVehicles(void) { return &_adsbVehicles; }
 
@@ -554,7 +593,7 @@ public:
     bool            messageTypeError        () { return _currentMessageType == MessageError; }
     int             newMessageCount         () { return _currentMessageCount; }
     int             messageCount            () { return _messageCount; }
-    QString         formatedMessages        ();
+    QAbstractListModel* messageModel        ();
     QString         formatedMessage         () { return _formatedMessage; }
     QString         latestError             () { return _latestError; }
     float           latitude                () { return _coordinate.latitude(); }
@@ -705,6 +744,7 @@ signals:
     void joystickModeChanged(int mode);
     void joystickEnabledChanged(bool enabled);
     void activeChanged(bool active);
+    void fleetProfileChanged(bool fleetProfile);
     void mavlinkMessageReceived(const mavlink_message_t& message);
     void homePositionChanged(const QGeoCoordinate& homePosition);
     void armedChanged(bool armed);
@@ -739,7 +779,6 @@ signals:
     void messageTypeChanged         ();
     void newMessageCountChanged     ();
     void messageCountChanged        ();
-    void formatedMessagesChanged    ();
     void formatedMessageChanged     ();
     void latestErrorChanged         ();
     void longitudeChanged           ();
@@ -865,6 +904,7 @@ private:
     QString _vehicleIdSpeech(void);
     void _handleMavlinkLoggingData(mavlink_message_t& message);
     void _handleMavlinkLoggingDataAcked(mavlink_message_t& message);
+    void _handleSerialControl(mavlink_message_t& message);
     void _ackMavlinkLogData(uint16_t sequence);
     void _sendNextQueuedMavCommand(void);
     void _updatePriorityLink(void);
@@ -876,6 +916,8 @@ private:
     int     _id;                    ///< Mavlink system id
     int     _defaultComponentId;
     bool    _active;
+    bool    _fleetProfile;
+    bool    _parameterLoadDeferred; ///< true: Vehicle was created in the fleet profile and parameters have not been requested yet
     bool    _offlineEditingVehicle; ///< This Vehicle is a "disconnected" vehicle for ui use while offline editing
 
     MAV_AUTOPILOT       _firmwareType;
@@ -988,7 +1030,7 @@ private:
 
     QTime               _flightTimer;
     QTimer              _mapTrajectoryTimer;
-    QmlObjectListModel  _mapTrajectoryList;
+    TrajectoryStore     _mapTrajectory;
     QGeoCoordinate      _mapTrajectoryLastCoordinate;
     bool                _mapTrajectoryHaveFirstCoordinate;
     static const int    _mapTrajectoryMsecsBetweenPoints = 1000;
@@ -1067,6 +1109,14 @@ private:
 
     static const int _vehicleUIUpdateRateMSecs = 100;
 
+    /// Handler for a single message id in the receive dispatch table
+    typedef void (*MessageHandler)(Vehicle* vehicle, LinkInterface* link, mavlink_message_t& message);
+    static const QHash<uint32_t, MessageHandler>& _messageHandlers(void);
+    void _recordMessageTiming(uint32_t msgid, qint64 handlerNsecs, qint64 totalNsecs);
+
+    QMap<uint32_t, MessageTiming>   _messageTimings;
+    static bool                     _messageTimingEnabled;
+
     // Settings keys
     static const char* _settingsGroup;
     static const char* _joystickModeSettingsKey;
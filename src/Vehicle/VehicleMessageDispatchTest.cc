@@ -0,0 +1,173 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VehicleMessageDispatchTest.h"
+#include "MultiVehicleManager.h"
+#include "QGCApplication.h"
+#include "MockLink.h"
+
+void VehicleMessageDispatchTest::cleanup(void)
+{
+    Vehicle::setMessageTimingEnabled(false);
+
+    UnitTest::cleanup();
+}
+
+Vehicle* VehicleMessageDispatchTest::_connectVehicle(void)
+{
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+
+    return qgcApp()->toolbox()->multiVehicleManager()->activeVehicle();
+}
+
+/// Sends a WIND_COV message from the MockLink vehicle. MockLink never streams it on its own.
+void VehicleMessageDispatchTest::_sendWindCov(float windX, float windY)
+{
+    mavlink_message_t msg;
+
+    mavlink_msg_wind_cov_pack_chan(_mockLink->vehicleId(),
+                                   MAV_COMP_ID_AUTOPILOT1,
+                                   _mockLink->mavlinkChannel(),
+                                   &msg,
+                                   0,                           // time_usec
+                                   windX, windY, 0,             // wind_x, wind_y, wind_z
+                                   0, 0, 0, 0, 0);              // var_horiz, var_vert, wind_alt, horiz_accuracy, vert_accuracy
+    _mockLink->respondWithMavlinkMessage(msg);
+}
+
+void VehicleMessageDispatchTest::_dispatch_test(void)
+{
+    Vehicle* vehicle = _connectVehicle();
+    QVERIFY(vehicle);
+
+    Vehicle::setMessageTimingEnabled(true);
+    vehicle->clearMessageTimings();
+
+    mavlink_message_t msg;
+
+    // Handled: WIND_COV -> _handleWindCov
+    _sendWindCov(3, 4);
+
+    // Handled: SCALED_PRESSURE -> _handleScaledPressure
+    mavlink_msg_scaled_pressure_pack_chan(_mockLink->vehicleId(), MAV_COMP_ID_AUTOPILOT1, _mockLink->mavlinkChannel(), &msg,
+                                          0,        // time_boot_ms
+                                          1013.25f, // press_abs
+                                          0,        // press_diff
+                                          2150);    // temperature, centi-degrees
+    _mockLink->respondWithMavlinkMessage(msg);
+
+    // No Vehicle handler, must still go through the receive path
+    mavlink_msg_named_value_float_pack_chan(_mockLink->vehicleId(), MAV_COMP_ID_AUTOPILOT1, _mockLink->mavlinkChannel(), &msg,
+                                            0,          // time_boot_ms
+                                            "dispatch",
+                                            1.0f);
+    _mockLink->respondWithMavlinkMessage(msg);
+
+    VehicleWindFactGroup* wind = qobject_cast<VehicleWindFactGroup*>(vehicle->windFactGroup());
+    VehicleTemperatureFactGroup* temperature = qobject_cast<VehicleTemperatureFactGroup*>(vehicle->temperatureFactGroup());
+    QVERIFY(wind);
+    QVERIFY(temperature);
+
+    QTRY_VERIFY_WITH_TIMEOUT(qFuzzyCompare(wind->speed()->rawValue().toDouble(), 5.0), 5000);
+    QVERIFY(qAbs(wind->direction()->rawValue().toDouble() - 53.13) < 0.01);
+    QTRY_VERIFY_WITH_TIMEOUT(qFuzzyCompare(temperature->temperature1()->rawValue().toDouble(), 21.5), 5000);
+    QTRY_VERIFY_WITH_TIMEOUT(vehicle->messageTimings().contains(MAVLINK_MSG_ID_NAMED_VALUE_FLOAT), 5000);
+
+    // Every message which went through the receive path is timed, whether or not the Vehicle has a handler for it
+    QList<uint32_t> msgIds;
+    msgIds << MAVLINK_MSG_ID_WIND_COV << MAVLINK_MSG_ID_SCALED_PRESSURE << MAVLINK_MSG_ID_NAMED_VALUE_FLOAT << MAVLINK_MSG_ID_HEARTBEAT;
+    foreach (uint32_t msgId, msgIds) {
+        QVERIFY2(vehicle->messageTimings().contains(msgId), qPrintable(QString::number(msgId)));
+
+        const Vehicle::MessageTiming& timing = vehicle->messageTimings()[msgId];
+        quint64 histogramCount = 0;
+        for (int bucket=0; bucket<Vehicle::MessageTiming::histogramBucketCount; bucket++) {
+            histogramCount += timing.histogram[bucket];
+        }
+
+        QVERIFY(timing.count > 0);
+        QCOMPARE(histogramCount, timing.count);
+        QVERIFY(timing.handlerNsecs <= timing.totalNsecs);
+        QVERIFY(timing.maxNsecs <= timing.totalNsecs);
+    }
+    QCOMPARE(vehicle->messageTimings()[MAVLINK_MSG_ID_WIND_COV].count, (quint64)1);
+    QCOMPARE(vehicle->messageTimings()[MAVLINK_MSG_ID_SCALED_PRESSURE].count, (quint64)1);
+}
+
+void VehicleMessageDispatchTest::_timingDisabled_test(void)
+{
+    Vehicle* vehicle = _connectVehicle();
+    QVERIFY(vehicle);
+
+    Vehicle::setMessageTimingEnabled(false);
+    vehicle->clearMessageTimings();
+
+    // Messages are still dispatched, only timing is skipped
+    _sendWindCov(0, 2);
+
+    VehicleWindFactGroup* wind = qobject_cast<VehicleWindFactGroup*>(vehicle->windFactGroup());
+    QVERIFY(wind);
+    QTRY_VERIFY_WITH_TIMEOUT(qFuzzyCompare(wind->speed()->rawValue().toDouble(), 2.0), 5000);
+    QVERIFY(qAbs(wind->direction()->rawValue().toDouble() - 90.0) < 0.01);
+
+    QVERIFY(vehicle->messageTimings().isEmpty());
+}
+
+void VehicleMessageDispatchTest::_histogramBucket_test(void)
+{
+    static const struct {
+        qint64  usecs;
+        int     bucket;
+    } rgBuckets[] = {
+        { 0,            0 },
+        { 1,            1 },
+        { 2,            2 },
+        { 3,            2 },
+        { 4,            3 },
+        { 7,            3 },
+        { 8,            4 },
+        { 1000,         10 },
+        { 1023,         10 },
+        { 1024,         11 },
+        { 16383,        14 },
+        { 16384,        15 },
+        { 1000000000,   15 },
+    };
+
+    for (size_t i=0; i<sizeof(rgBuckets)/sizeof(rgBuckets[0]); i++) {
+        QVERIFY2(Vehicle::MessageTiming::histogramBucket(rgBuckets[i].usecs) == rgBuckets[i].bucket, qPrintable(QString::number(rgBuckets[i].usecs)));
+    }
+}
+
+void VehicleMessageDispatchTest::_percentile_test(void)
+{
+    Vehicle::MessageTiming timing;
+
+    // No samples: the first bucket already satisfies a zero threshold
+    QCOMPARE(timing.percentileUSecs(0.5), 1);
+
+    // 50 messages below 1us, 45 in [4,8)us, 5 in [512,1024)us
+    timing.count = 100;
+    timing.histogram[0] = 50;
+    timing.histogram[3] = 45;
+    timing.histogram[10] = 5;
+
+    QCOMPARE(timing.percentileUSecs(0),     1);
+    QCOMPARE(timing.percentileUSecs(0.5),   1);
+    QCOMPARE(timing.percentileUSecs(0.51),  8);
+    QCOMPARE(timing.percentileUSecs(0.95),  8);
+    QCOMPARE(timing.percentileUSecs(0.96),  1024);
+    QCOMPARE(timing.percentileUSecs(1.0),   1024);
+
+    // Everything in the overflow bucket
+    Vehicle::MessageTiming slowTiming;
+    slowTiming.count = 3;
+    slowTiming.histogram[Vehicle::MessageTiming::histogramBucketCount - 1] = 3;
+    QCOMPARE(slowTiming.percentileUSecs(0.5), 1 << (Vehicle::MessageTiming::histogramBucketCount - 1));
+}
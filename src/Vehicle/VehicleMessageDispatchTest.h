@@ -0,0 +1,33 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class Vehicle;
+
+/// Unit test for the Vehicle receive dispatch table and receive path timing
+class VehicleMessageDispatchTest : public UnitTest
+{
+    Q_OBJECT
+
+protected slots:
+    void cleanup(void);
+
+private slots:
+    void _dispatch_test(void);
+    void _timingDisabled_test(void);
+    void _histogramBucket_test(void);
+    void _percentile_test(void);
+
+private:
+    Vehicle* _connectVehicle(void);
+    void _sendWindCov(float windX, float windY);
+};
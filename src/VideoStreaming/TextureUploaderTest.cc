@@ -0,0 +1,170 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TextureUploaderTest.h"
+#include "glutils.h"
+
+// glGetTexImage is only available with the desktop OpenGL functions
+#if !defined(__mobile__) && !defined(__rasp_pi2__)
+#define TEXTURE_READBACK
+#endif
+
+Q_DECLARE_METATYPE(TextureUploader::Mode)
+
+TextureUploaderTest::TextureUploaderTest(void)
+    : _surface(NULL)
+    , _context(NULL)
+{
+    memset(_textureIds, 0, sizeof(_textureIds));
+}
+
+void TextureUploaderTest::init(void)
+{
+    UnitTest::init();
+
+    _surface = new QOffscreenSurface();
+    _surface->create();
+    _context = new QOpenGLContext();
+    if (!_context->create() || !_context->makeCurrent(_surface)) {
+        delete _context;
+        _context = NULL;
+    }
+}
+
+void TextureUploaderTest::cleanup(void)
+{
+    if (_context) {
+        _uploader.cleanup();
+        QOpenGLFunctionsDef* funcs = getQOpenGLFunctions();
+        if (funcs && _textureIds[0]) {
+            funcs->glDeleteTextures(3, _textureIds);
+        }
+        memset(_textureIds, 0, sizeof(_textureIds));
+        _context->doneCurrent();
+        delete _context;
+        _context = NULL;
+    }
+    delete _surface;
+    _surface = NULL;
+
+    UnitTest::cleanup();
+}
+
+void TextureUploaderTest::_addModeRows(void)
+{
+    QTest::addColumn<TextureUploader::Mode>("mode");
+
+    QTest::newRow("glTexImage2D")       << TextureUploader::TexImageMode;
+    QTest::newRow("glTexSubImage2D")    << TextureUploader::TexSubImageMode;
+    QTest::newRow("Pixel buffer")       << TextureUploader::PixelBufferMode;
+}
+
+/// Sets up the uploader for an I420 frame with the same plane layout as the video painters
+void TextureUploaderTest::_initI420(int width, int height, TextureUploader::Mode mode)
+{
+    int bytesPerLine = (width + 3) & ~3;
+    int bytesPerLine2 = (width / 2 + 3) & ~3;
+
+    _textureWidths[0] = bytesPerLine;
+    _textureHeights[0] = height;
+    _textureOffsets[0] = 0;
+    _textureWidths[1] = bytesPerLine2;
+    _textureHeights[1] = height / 2;
+    _textureOffsets[1] = bytesPerLine * height;
+    _textureWidths[2] = bytesPerLine2;
+    _textureHeights[2] = height / 2;
+    _textureOffsets[2] = bytesPerLine * height + bytesPerLine2 * height / 2;
+
+    getQOpenGLFunctions()->glGenTextures(3, _textureIds);
+    _uploader.init(3, _textureIds, _textureWidths, _textureHeights, _textureOffsets,
+                   GL_LUMINANCE, GL_LUMINANCE, GL_UNSIGNED_BYTE, mode);
+}
+
+void TextureUploaderTest::_fillI420Frame(QByteArray& frame, int seed)
+{
+    frame.resize(_uploader.frameBytes());
+    for (int i=0; i<frame.size(); i++) {
+        frame[i] = (char)((i * 7 + seed) & 0xFF);
+    }
+}
+
+void TextureUploaderTest::_upload_test_data(void)
+{
+    _addModeRows();
+}
+
+void TextureUploaderTest::_upload_test(void)
+{
+    QFETCH(TextureUploader::Mode, mode);
+
+    if (!_context || !getQOpenGLFunctions()) {
+        QSKIP("No OpenGL context available");
+    }
+    QOpenGLFunctionsDef* funcs = getQOpenGLFunctions();
+
+    _initI420(64, 48, mode);
+    if (_uploader.mode() != mode) {
+        QSKIP("Upload mode not supported by this OpenGL context");
+    }
+    QCOMPARE(_uploader.frameBytes(), 64 * 48 + 2 * 32 * 24);
+
+    // The second frame goes through the persistent storage path and the second pixel buffer
+    QByteArray frame;
+    for (int seed=0; seed<3; seed++) {
+        _fillI420Frame(frame, seed);
+        _uploader.upload((const quint8*)frame.constData());
+        QCOMPARE(funcs->glGetError(), (GLenum)GL_NO_ERROR);
+
+#ifdef TEXTURE_READBACK
+        for (int i=0; i<3; i++) {
+            QByteArray plane(_textureWidths[i] * _textureHeights[i], 0);
+            funcs->glBindTexture(GL_TEXTURE_2D, _textureIds[i]);
+            funcs->glGetTexImage(GL_TEXTURE_2D, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, plane.data());
+            QCOMPARE(plane, frame.mid(_textureOffsets[i], plane.size()));
+        }
+#endif
+    }
+}
+
+void TextureUploaderTest::_upload_benchmark_data(void)
+{
+    _addModeRows();
+}
+
+/// Uploads 1080p I420 frames, glFinish is included so the numbers cover the transfer into the texture and not only
+/// queueing the commands.
+void TextureUploaderTest::_upload_benchmark(void)
+{
+    UT_OPT_IN(optInBenchmarks);
+
+    QFETCH(TextureUploader::Mode, mode);
+
+    if (!_context || !getQOpenGLFunctions()) {
+        QSKIP("No OpenGL context available");
+    }
+    QOpenGLFunctionsDef* funcs = getQOpenGLFunctions();
+
+    _initI420(1920, 1080, mode);
+    if (_uploader.mode() != mode) {
+        QSKIP("Upload mode not supported by this OpenGL context");
+    }
+
+    QByteArray frames[2];
+    _fillI420Frame(frames[0], 0);
+    _fillI420Frame(frames[1], 1);
+
+    int frameIndex = 0;
+    QBENCHMARK {
+        _uploader.upload((const quint8*)frames[frameIndex].constData());
+        funcs->glFinish();
+        frameIndex = (frameIndex + 1) % 2;
+    }
+
+    QCOMPARE(funcs->glGetError(), (GLenum)GL_NO_ERROR);
+}
@@ -0,0 +1,48 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "textureuploader.h"
+
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+
+/// Unit test and frame upload micro benchmark for TextureUploader
+class TextureUploaderTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TextureUploaderTest(void);
+
+protected slots:
+    void init(void);
+    void cleanup(void);
+
+private slots:
+    void _upload_test_data(void);
+    void _upload_test(void);
+    void _upload_benchmark_data(void);
+    void _upload_benchmark(void);
+
+private:
+    void _addModeRows   (void);
+    void _initI420      (int width, int height, TextureUploader::Mode mode);
+    void _fillI420Frame (QByteArray& frame, int seed);
+
+    QOffscreenSurface*  _surface;
+    QOpenGLContext*     _context;
+    TextureUploader     _uploader;
+    GLuint              _textureIds[3];
+    int                 _textureWidths[3];
+    int                 _textureHeights[3];
+    int                 _textureOffsets[3];
+};
@@ -18,12 +18,24 @@
 #include "SettingsManager.h"
 #include "QGCApplication.h"
 #include "VideoManager.h"
+#include "MAVLinkProtocol.h"
+#include "VideoSyncIndex.h"
 
 #include <QDebug>
 #include <QUrl>
 #include <QDir>
 #include <QDateTime>
 #include <QSysInfo>
+#include <QThread>
+#include <QSet>
+
+#if defined(QGC_GST_STREAMING)
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#endif
 
 QGC_LOGGING_CATEGORY(VideoReceiverLog, "VideoReceiverLog")
 
@@ -45,6 +57,19 @@ static const char* kVideoMuxes[] =
 
 #define NUM_MUXES (sizeof(kVideoMuxes) / sizeof(char*))
 
+//-- The recording queue drops frames beyond these limits rather than blocking the live view. Recording resumes with
+//   the next key frame.
+static const guint          kRecordingQueueMaxBytes = 32 * 1024 * 1024;
+static const guint64        kRecordingQueueMaxTime  = 5 * GST_SECOND;
+
+//-- Longest time stop() waits for the pipeline to drain, including the recording being finalized
+static const GstClockTime   kStopTimeout            = 5 * GST_SECOND;
+
+//-- Seconds without a new frame before the stream is restarted. Streams decoding key frames only wait for a full
+//   key frame interval.
+static const time_t         kStallTimeout           = 2;
+static const time_t         kKeyframeStallTimeout   = 10;
+
 #endif
 
 
@@ -59,14 +84,27 @@ VideoReceiver::VideoReceiver(QObject* parent)
     , _sink(NULL)
     , _tee(NULL)
     , _pipeline(NULL)
-    , _pipelineStopRec(NULL)
     , _videoSink(NULL)
     , _socket(NULL)
     , _serverPresent(false)
+    , _sinkLatencyProbeId(0)
+    , _latencyUpdateUSecs(0)
+    , _frameRate(0)
+    , _decodeLoad(0)
+    , _decodeCpuUSecs(0)
+    , _decodeThread(NULL)
+    , _decodeThreadCpuUSecs(0)
+    , _deleteWhenStopped(false)
+    , _taskPool(NULL)
+    , _waitForKeyframe(0)
+    , _lastRenderedPts(GST_CLOCK_TIME_NONE)
 #endif
     , _videoSurface(NULL)
     , _videoRunning(false)
     , _showFullScreen(false)
+    , _decodeMode(DecodeFull)
+    , _decoderThreads(0)
+    , _memoryBudget(0)
 {
     _videoSurface  = new VideoSurface;
 #if defined(QGC_GST_STREAMING)
@@ -76,8 +114,15 @@ VideoReceiver::VideoReceiver(QObject* parent)
     connect(this, &VideoReceiver::msgErrorReceived, this, &VideoReceiver::_handleError);
     connect(this, &VideoReceiver::msgEOSReceived, this, &VideoReceiver::_handleEOS);
     connect(this, &VideoReceiver::msgStateChangedReceived, this, &VideoReceiver::_handleStateChanged);
+    connect(this, &VideoReceiver::msgRecordingFinalized, this, &VideoReceiver::_handleRecordingFinalized);
+    connect(this, &VideoReceiver::msgSegmentOpened, this, &VideoReceiver::_cleanupOldVideos);
     connect(&_frameTimer, &QTimer::timeout, this, &VideoReceiver::_updateTimer);
     _frameTimer.start(1000);
+    for (int i=0; i<LatencyStageCount; i++) {
+        _latencyProbes[i].receiver = this;
+        _latencyProbes[i].stage = i;
+    }
+    _resetLatency();
 #endif
 }
 
@@ -85,6 +130,19 @@ VideoReceiver::~VideoReceiver()
 {
 #if defined(QGC_GST_STREAMING)
     stop();
+    //-- Give stopped recordings a chance to complete their files
+    while(!_finalizingSinks.isEmpty()) {
+        Sink* sink = _finalizingSinks.takeFirst();
+        if(sink->pipelineStopRec && !g_atomic_int_get(&sink->finalized)) {
+            GstBus* bus = gst_pipeline_get_bus(GST_PIPELINE(sink->pipelineStopRec));
+            GstMessage* message = gst_bus_timed_pop_filtered(bus, kStopTimeout, (GstMessageType)(GST_MESSAGE_EOS|GST_MESSAGE_ERROR));
+            if(message) {
+                gst_message_unref(message);
+            }
+            gst_object_unref(bus);
+        }
+        _shutdownRecordingBranch(sink);
+    }
     if(_socket) {
         delete _socket;
     }
@@ -96,6 +154,63 @@ VideoReceiver::~VideoReceiver()
         delete _videoSurface;
 }
 
+//-----------------------------------------------------------------------------
+// The pipeline is stopped like stop() does, but the EOS is handled once it comes through on the bus instead of
+// blocking for it. Streams of a fleet are removed while the GUI is running.
+void
+VideoReceiver::deleteWhenStopped()
+{
+#if defined(QGC_GST_STREAMING)
+    _deleteWhenStopped = true;
+    _frameTimer.stop();
+    _timer.stop();
+    if(_socket) {
+        delete _socket;
+        _socket = NULL;
+    }
+    if(_streaming && _pipeline != NULL) {
+        if(!_stopping) {
+            qCDebug(VideoReceiverLog) << "Stopping _pipeline";
+            gst_element_send_event(_pipeline, gst_event_new_eos());
+            _stopping = true;
+        }
+        QTimer::singleShot(kStopTimeout / GST_MSECOND, this, &VideoReceiver::_stopTimeout);
+    } else {
+        _shutdownPipeline();
+    }
+    _deleteIfStopped();
+#else
+    deleteLater();
+#endif
+}
+
+//-----------------------------------------------------------------------------
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_stopTimeout()
+{
+    if(_pipeline != NULL) {
+        // A recording segment which could not be finalized in time is the only loss
+        _shutdownPipeline();
+        qCritical() << "Timeout stopping pipeline!";
+    }
+    // Recordings which are still finalizing are waited for by the destructor
+    deleteLater();
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Deletes a receiver passed to deleteWhenStopped() once there is nothing left to wait for
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_deleteIfStopped()
+{
+    if(_deleteWhenStopped && _pipeline == NULL && _finalizingSinks.isEmpty()) {
+        deleteLater();
+    }
+}
+#endif
+
 #if defined(QGC_GST_STREAMING)
 void
 VideoReceiver::_setVideoSink(GstElement* sink)
@@ -138,6 +253,20 @@ newPadCB(GstElement* element, GstPad* pad, gpointer data)
 }
 #endif
 
+//-----------------------------------------------------------------------------
+#if defined(QGC_GST_STREAMING)
+// Element properties differ between GStreamer versions, only set the ones which exist
+static void
+setPropertyIfExists(GstElement* element, const char* name, gint value)
+{
+    if (g_object_class_find_property(G_OBJECT_GET_CLASS(element), name)) {
+        g_object_set(G_OBJECT(element), name, value, NULL);
+    } else {
+        qCDebug(VideoReceiverLog) << "Property not available" << name;
+    }
+}
+#endif
+
 //-----------------------------------------------------------------------------
 #if defined(QGC_GST_STREAMING)
 void
@@ -193,13 +322,15 @@ VideoReceiver::_timeout()
 //-----------------------------------------------------------------------------
 // When we finish our pipeline will look like this:
 //
-//                                   +-->queue-->decoder-->_videosink
+//                                   +-->queue-->decoder-->queue-->_videosink
 //                                   |
 //    datasource-->demux-->parser-->tee
 //
 //                                   ^
 //                                   |
 //                                   +-Here we will later link elements for recording
+//
+// In low latency mode UDP streams also get a jitterbuffer between datasource and demux.
 void
 VideoReceiver::start()
 {
@@ -234,8 +365,13 @@ VideoReceiver::start()
     bool running = false;
     bool pipelineUp = false;
 
+    VideoSettings*  videoSettings   = qgcApp()->toolbox()->settingsManager()->videoSettings();
+    bool            lowLatency      = videoSettings->lowLatencyMode()->rawValue().toBool();
+    guint           jitterBuffer    = videoSettings->jitterBuffer()->rawValue().toUInt();
+
     GstElement*     dataSource  = NULL;
     GstCaps*        caps        = NULL;
+    GstElement*     jitterBufferElement = NULL;
     GstElement*     demux       = NULL;
     GstElement*     parser      = NULL;
     GstElement*     queue       = NULL;
@@ -271,7 +407,19 @@ VideoReceiver::start()
             QUrl url(_uri);
             g_object_set(G_OBJECT(dataSource), "host", qPrintable(url.host()), "port", url.port(), NULL );
         } else {
-            g_object_set(G_OBJECT(dataSource), "location", qPrintable(_uri), "latency", 17, "udp-reconnect", 1, "timeout", static_cast<guint64>(5000000), NULL);
+            g_object_set(G_OBJECT(dataSource), "location", qPrintable(_uri), "latency", jitterBuffer, "udp-reconnect", 1, "timeout", static_cast<guint64>(5000000), NULL);
+            if (lowLatency) {
+                setPropertyIfExists(dataSource, "drop-on-latency", TRUE);
+            }
+        }
+
+        if (isUdp && lowLatency) {
+            if ((jitterBufferElement = gst_element_factory_make("rtpjitterbuffer", NULL)) == NULL) {
+                qCritical() << "VideoReceiver::start() failed. Error with gst_element_factory_make('rtpjitterbuffer')";
+                break;
+            }
+            g_object_set(G_OBJECT(jitterBufferElement), "latency", jitterBuffer, NULL);
+            setPropertyIfExists(jitterBufferElement, "drop-on-latency", TRUE);
         }
 
         // Currently, we expect H264 when using anything except for TCP.  Long term we may want this to be settable
@@ -298,8 +446,6 @@ VideoReceiver::start()
         }
 
         if((queue = gst_element_factory_make("queue", NULL)) == NULL)  {
-            // TODO: We may want to add queue2 max-size-buffers=1 to get lower latency
-            //       We should compare gstreamer scripts to QGroundControl to determine the need
             qCritical() << "VideoReceiver::start() failed. Error with gst_element_factory_make('queue')";
             break;
         }
@@ -314,12 +460,32 @@ VideoReceiver::start()
             break;
         }
 
+        if (lowLatency) {
+            _configureLowLatency(queue, decoder, queue1);
+        } else {
+            setPropertyIfExists(_videoSink, "sync", TRUE);
+        }
+        _applyBudget(queue, decoder, queue1);
+
         gst_bin_add_many(GST_BIN(_pipeline), dataSource, demux, parser, _tee, queue, decoder, queue1, _videoSink, NULL);
         pipelineUp = true;
 
+        if (jitterBufferElement) {
+            gst_bin_add(GST_BIN(_pipeline), jitterBufferElement);
+        }
+
         if(isUdp) {
             // Link the pipeline in front of the tee
-            if(!gst_element_link_many(dataSource, demux, parser, _tee, queue, decoder, queue1, _videoSink, NULL)) {
+            if (jitterBufferElement) {
+                if(!gst_element_link_many(dataSource, jitterBufferElement, demux, NULL)) {
+                    qCritical() << "Unable to link UDP jitterbuffer.";
+                    break;
+                }
+            } else if(!gst_element_link(dataSource, demux)) {
+                qCritical() << "Unable to link UDP dataSource to Demux.";
+                break;
+            }
+            if(!gst_element_link_many(demux, parser, _tee, queue, decoder, queue1, _videoSink, NULL)) {
                 qCritical() << "Unable to link UDP elements.";
                 break;
             }
@@ -341,7 +507,14 @@ VideoReceiver::start()
             }
         }
 
-        dataSource = demux = parser = queue = decoder = queue1 = NULL;
+        _resetLatency();
+        _addLatencyProbe(parser,        "src",  LatencyStageParsed);
+        _addLatencyProbe(decoder,       "sink", LatencyStageDecoderIn);
+        _addLatencyProbe(decoder,       "src",  LatencyStageDecoderOut);
+        _addLatencyProbe(_videoSink,    "sink", LatencyStageSink);
+        _addDecodeModeProbes(queue, decoder);
+
+        dataSource = demux = parser = queue = decoder = queue1 = jitterBufferElement = NULL;
 
         GstBus* bus = NULL;
 
@@ -392,6 +565,11 @@ VideoReceiver::start()
                 dataSource = NULL;
             }
 
+            if (jitterBufferElement != NULL) {
+                gst_object_unref(jitterBufferElement);
+                jitterBufferElement = NULL;
+            }
+
             if (_tee != NULL) {
                 gst_object_unref(_tee);
                 dataSource = NULL;
@@ -425,15 +603,21 @@ VideoReceiver::stop()
         gst_element_send_event(_pipeline, gst_event_new_eos());
         _stopping = true;
         GstBus* bus = gst_pipeline_get_bus(GST_PIPELINE(_pipeline));
-        GstMessage* message = gst_bus_timed_pop_filtered(bus, GST_CLOCK_TIME_NONE, (GstMessageType)(GST_MESSAGE_EOS|GST_MESSAGE_ERROR));
+        GstMessage* message = gst_bus_timed_pop_filtered(bus, kStopTimeout, (GstMessageType)(GST_MESSAGE_EOS|GST_MESSAGE_ERROR));
         gst_object_unref(bus);
-        if(GST_MESSAGE_TYPE(message) == GST_MESSAGE_ERROR) {
+        if(message == NULL) {
+            // A recording segment which could not be finalized in time is the only loss
             _shutdownPipeline();
-            qCritical() << "Error stopping pipeline!";
-        } else if(GST_MESSAGE_TYPE(message) == GST_MESSAGE_EOS) {
-            _handleEOS();
+            qCritical() << "Timeout stopping pipeline!";
+        } else {
+            if(GST_MESSAGE_TYPE(message) == GST_MESSAGE_ERROR) {
+                _shutdownPipeline();
+                qCritical() << "Error stopping pipeline!";
+            } else if(GST_MESSAGE_TYPE(message) == GST_MESSAGE_EOS) {
+                _handleEOS();
+            }
+            gst_message_unref(message);
         }
-        gst_message_unref(message);
     }
 #endif
 }
@@ -445,6 +629,25 @@ VideoReceiver::setUri(const QString & uri)
     _uri = uri;
 }
 
+//-----------------------------------------------------------------------------
+// Takes effect with the next frame, the pipeline keeps running
+void
+VideoReceiver::setDecodeMode(DecodeMode_t decodeMode)
+{
+    DecodeMode_t previousMode = (DecodeMode_t)_decodeMode.fetchAndStoreOrdered(decodeMode);
+    if (previousMode == decodeMode) {
+        return;
+    }
+#if defined(QGC_GST_STREAMING)
+    // The frames following a key frame reference frames which were not decoded
+    if (previousMode == DecodeKeyframes) {
+        g_atomic_int_set(&_waitForKeyframe, 1);
+    }
+#endif
+    qCDebug(VideoReceiverLog) << "Decode mode" << _uri << decodeMode;
+    emit decodeModeChanged();
+}
+
 //-----------------------------------------------------------------------------
 #if defined(QGC_GST_STREAMING)
 void
@@ -460,17 +663,38 @@ VideoReceiver::_shutdownPipeline() {
         bus = NULL;
     }
     gst_element_set_state(_pipeline, GST_STATE_NULL);
+    if (_sinkLatencyProbeId) {
+        GstPad* sinkPad = gst_element_get_static_pad(_videoSink, "sink");
+        if (sinkPad) {
+            gst_pad_remove_probe(sinkPad, _sinkLatencyProbeId);
+            gst_object_unref(sinkPad);
+        }
+        _sinkLatencyProbeId = 0;
+    }
+    //-- Recording branches which are still linked to the tee go down with the pipeline
+    if (_sink) {
+        _finalizingSinks.append(_sink);
+        _sink = NULL;
+    }
+    for (int i = _finalizingSinks.count() - 1; i >= 0; i--) {
+        Sink* sink = _finalizingSinks[i];
+        if(g_atomic_int_compare_and_exchange(&sink->removing, FALSE, TRUE)) {
+            _finalizingSinks.removeAt(i);
+            gst_element_release_request_pad(_tee, sink->teepad);
+            gst_object_unref(sink->teepad);
+            _releaseRecordingBranch(sink);
+        }
+    }
     gst_bin_remove(GST_BIN(_pipeline), _videoSink);
     gst_object_unref(_pipeline);
     _pipeline = NULL;
-    delete _sink;
-    _sink = NULL;
     _serverPresent = false;
     _streaming = false;
     _recording = false;
     _stopping = false;
     _running = false;
     emit recordingChanged();
+    _resetLatency();
 }
 #endif
 
@@ -480,6 +704,7 @@ void
 VideoReceiver::_handleError() {
     qCDebug(VideoReceiverLog) << "Gstreamer error!";
     _shutdownPipeline();
+    _deleteIfStopped();
 }
 #endif
 
@@ -490,12 +715,11 @@ VideoReceiver::_handleEOS() {
     if(_stopping) {
         _shutdownPipeline();
         qCDebug(VideoReceiverLog) << "Stopped";
-    } else if(_recording && _sink->removing) {
-        _shutdownRecordingBranch();
     } else {
         qCritical() << "VideoReceiver: Unexpected EOS!";
         _shutdownPipeline();
     }
+    _deleteIfStopped();
 }
 #endif
 
@@ -536,6 +760,18 @@ VideoReceiver::_onBusMessage(GstBus* bus, GstMessage* msg, gpointer data)
     case(GST_MESSAGE_STATE_CHANGED):
         pThis->msgStateChangedReceived();
         break;
+    case(GST_MESSAGE_STREAM_STATUS):
+        // Posted from the thread creating the task, before the task is started
+        if(pThis->_taskPool) {
+            GstStreamStatusType type;
+            GstElement* owner;
+            gst_message_parse_stream_status(msg, &type, &owner);
+            const GValue* value = gst_message_get_stream_status_object(msg);
+            if(type == GST_STREAM_STATUS_TYPE_CREATE && value && G_VALUE_HOLDS_OBJECT(value) && GST_IS_TASK(g_value_get_object(value))) {
+                gst_task_set_pool(GST_TASK(g_value_get_object(value)), pThis->_taskPool);
+            }
+        }
+        break;
     default:
         break;
     }
@@ -558,6 +794,8 @@ VideoReceiver::_cleanupOldVideos()
     for(uint32_t i = 0; i < NUM_MUXES; i++) {
         nameFilters << QString("*.") + QString(kVideoExtensions[i]);
     }
+    //-- Sync indexes are removed along with their recordings
+    nameFilters << QString("*.") + VideoSyncIndex::fileExtension;
     videoDir.setNameFilters(nameFilters);
     //-- get the list of videos stored
     QFileInfoList vidList = videoDir.entryInfoList();
@@ -569,13 +807,31 @@ VideoReceiver::_cleanupOldVideos()
         for(int i = 0; i < vidList.size(); i++) {
             total += vidList[i].size();
         }
-        //-- Remove old movies until max size is satisfied.
-        while(total >= maxSize && !vidList.isEmpty()) {
-            total -= vidList.last().size();
-            qCDebug(VideoReceiverLog) << "Removing old video file:" << vidList.last().filePath();
-            QFile file (vidList.last().filePath());
+        //-- Remove old movies until max size is satisfied. Older segments of the recording in progress go as well, only
+        //   the segment being written and the sync index are kept. Recordings being finalized are kept entirely.
+        QSet<QString> keepFiles;
+        if(_sink) {
+            QMutexLocker locker(&_sink->syncMutex);
+            keepFiles << QFileInfo(_sink->segmentLocation).fileName();
+            keepFiles << QFileInfo(_sink->segmentBase + "." + VideoSyncIndex::fileExtension).fileName();
+        }
+        QStringList keepPrefixes;
+        foreach(Sink* sink, _finalizingSinks) {
+            keepPrefixes << QFileInfo(sink->segmentBase).fileName();
+        }
+        for(int i = vidList.size() - 1; i >= 0 && total >= maxSize; i--) {
+            QString fileName = vidList[i].fileName();
+            bool keep = keepFiles.contains(fileName);
+            foreach(const QString& prefix, keepPrefixes) {
+                keep |= fileName.startsWith(prefix);
+            }
+            if(keep) {
+                continue;
+            }
+            total -= vidList[i].size();
+            qCDebug(VideoReceiverLog) << "Removing old video file:" << vidList[i].filePath();
+            QFile file (vidList[i].filePath());
             file.remove();
-            vidList.removeLast();
         }
     }
 }
@@ -588,11 +844,18 @@ VideoReceiver::_cleanupOldVideos()
 //                                   |
 //    datasource-->demux-->parser-->tee
 //                                   |
-//                                   |    +--------------_sink-------------------+
-//                                   |    |                                      |
-//   we are adding these elements->  +->teepad-->queue-->matroskamux-->_filesink |
-//                                        |                                      |
-//                                        +--------------------------------------+
+//                                   |    +--------------_sink----------------------+
+//                                   |    |                                         |
+//   we are adding these elements->  +->teepad-->queue-->h264parse-->splitmuxsink   |
+//                                        |                                         |
+//                                        +-----------------------------------------+
+//
+// splitmuxsink writes the recording as a series of segments and finalizes each one when the next one starts, so an
+// interrupted recording only loses the segment being written. When segments are disabled, or splitmuxsink is not
+// available, the branch ends with the muxer and a filesink writing a single file.
+// The queue is bounded and leaky so a slow disk drops recorded frames instead of stalling the tee and the live view.
+// Delta frames whose reference frames were dropped can't be decoded, so once the queue leaks everything up to the next
+// key frame is dropped as well. The recording also starts with a key frame.
 void
 VideoReceiver::startRecording(void)
 {
@@ -611,48 +874,119 @@ VideoReceiver::startRecording(void)
         return;
     }
 
-    uint32_t muxIdx = qgcApp()->toolbox()->settingsManager()->videoSettings()->recordingFormat()->rawValue().toUInt();
+    VideoSettings* videoSettings = qgcApp()->toolbox()->settingsManager()->videoSettings();
+    uint32_t muxIdx = videoSettings->recordingFormat()->rawValue().toUInt();
     if(muxIdx >= NUM_MUXES) {
         qgcApp()->showMessage(tr("Invalid video format defined."));
         return;
     }
+    guint segmentDuration = videoSettings->segmentDuration()->rawValue().toUInt();
 
     //-- Disk usage maintenance
     _cleanupOldVideos();
 
-    _sink           = new Sink();
-    _sink->teepad   = gst_element_get_request_pad(_tee, "src_%u");
-    _sink->queue    = gst_element_factory_make("queue", NULL);
-    _sink->parse    = gst_element_factory_make("h264parse", NULL);
-    _sink->mux      = gst_element_factory_make(kVideoMuxes[muxIdx], NULL);
-    _sink->filesink = gst_element_factory_make("filesink", NULL);
-    _sink->removing = false;
+    _sink                   = new Sink();
+    _sink->receiver         = this;
+    _sink->teepad           = gst_element_get_request_pad(_tee, "src_%u");
+    _sink->queue            = gst_element_factory_make("queue", NULL);
+    _sink->pipelineStopRec  = NULL;
+    _sink->segmentBase      = savePath + "/" + QDateTime::currentDateTime().toString("yyyy-MM-dd_hh.mm.ss");
+    _sink->extension        = kVideoExtensions[muxIdx];
+    _sink->syncIndex        = NULL;
+    _sink->mavlink          = qgcApp()->toolbox()->mavlinkProtocol();
+    _sink->firstPts         = GST_CLOCK_TIME_NONE;
+    _sink->lastPts          = GST_CLOCK_TIME_NONE;
+    _sink->waitForKeyframe  = 1;
+    _sink->removing         = false;
+    _sink->finalized        = 0;
+
+    GstElement* parse       = gst_element_factory_make("h264parse", NULL);
+    GstElement* mux         = gst_element_factory_make(kVideoMuxes[muxIdx], NULL);
+    GstElement* splitmux    = NULL;
+    GstElement* filesink    = NULL;
+
+    if(segmentDuration > 0) {
+        splitmux = gst_element_factory_make("splitmuxsink", NULL);
+        if(!splitmux) {
+            qCDebug(VideoReceiverLog) << "splitmuxsink not available, recording to a single file";
+        }
+    }
+    if(!splitmux) {
+        filesink = gst_element_factory_make("filesink", NULL);
+    }
 
-    if(!_sink->teepad || !_sink->queue || !_sink->mux || !_sink->filesink || !_sink->parse) {
+    if(!_sink->teepad || !_sink->queue || !mux || !parse || (!splitmux && !filesink)) {
         qCritical() << "VideoReceiver::startRecording() failed to make _sink elements";
+        // None of the elements are in the pipeline yet, so ours are the only references
+        GstElement* elements[] = { _sink->queue, parse, mux, splitmux, filesink };
+        for(size_t i = 0; i < sizeof(elements) / sizeof(elements[0]); i++) {
+            if(elements[i]) {
+                gst_object_unref(elements[i]);
+            }
+        }
+        if(_sink->teepad) {
+            gst_element_release_request_pad(_tee, _sink->teepad);
+            gst_object_unref(_sink->teepad);
+        }
+        delete _sink;
+        _sink = NULL;
         return;
     }
 
-    QString videoFile;
-    videoFile = savePath + "/" + QDateTime::currentDateTime().toString("yyyy-MM-dd_hh.mm.ss") + "." + kVideoExtensions[muxIdx];
+    g_object_set(G_OBJECT(_sink->queue),
+                 "max-size-buffers",    0,
+                 "max-size-bytes",      kRecordingQueueMaxBytes,
+                 "max-size-time",       kRecordingQueueMaxTime,
+                 NULL);
+    setPropertyIfExists(_sink->queue, "leaky", 2 /* downstream */);
+    g_signal_connect(_sink->queue, "overrun", G_CALLBACK(_recordingQueueOverrun), _sink);
+
+    _sink->elements << _sink->queue << parse;
+    if(splitmux) {
+        // splitmuxsink takes over the muxer and names each segment through format-location
+        QString location = _sink->segmentBase + "_%03d." + _sink->extension;
+        g_object_set(G_OBJECT(splitmux),
+                     "muxer",           mux,
+                     "location",        qPrintable(location),
+                     "max-size-time",   static_cast<guint64>(segmentDuration) * GST_SECOND,
+                     NULL);
+        g_signal_connect(splitmux, "format-location", G_CALLBACK(_segmentLocationCallBack), _sink);
+        _sink->elements << splitmux;
+        qCDebug(VideoReceiverLog) << "New video segments:" << location;
+    } else {
+        QString videoFile = _sink->segmentBase + "." + _sink->extension;
+        g_object_set(G_OBJECT(filesink), "location", qPrintable(videoFile), NULL);
+        _sink->elements << mux << filesink;
+        _sink->segmentLocation = videoFile;
+        qCDebug(VideoReceiverLog) << "New video file:" << videoFile;
+    }
 
-    g_object_set(G_OBJECT(_sink->filesink), "location", qPrintable(videoFile), NULL);
-    qCDebug(VideoReceiverLog) << "New video file:" << videoFile;
+    foreach(GstElement* element, _sink->elements) {
+        gst_object_ref(element);
+    }
 
-    gst_object_ref(_sink->queue);
-    gst_object_ref(_sink->parse);
-    gst_object_ref(_sink->mux);
-    gst_object_ref(_sink->filesink);
+    _linkRecordingBranch(GST_BIN(_pipeline), _sink);
 
-    gst_bin_add_many(GST_BIN(_pipeline), _sink->queue, _sink->parse, _sink->mux, _sink->filesink, NULL);
-    gst_element_link_many(_sink->queue, _sink->parse, _sink->mux, _sink->filesink, NULL);
+    foreach(GstElement* element, _sink->elements) {
+        gst_element_sync_state_with_parent(element);
+    }
 
-    gst_element_sync_state_with_parent(_sink->queue);
-    gst_element_sync_state_with_parent(_sink->parse);
-    gst_element_sync_state_with_parent(_sink->mux);
-    gst_element_sync_state_with_parent(_sink->filesink);
+    //-- Sidecar index used to line the recording up with the telemetry log
+    _sink->syncIndex = new VideoSyncIndex();
+    if(!_sink->syncIndex->create(_sink->segmentBase + "." + VideoSyncIndex::fileExtension)) {
+        delete _sink->syncIndex;
+        _sink->syncIndex = NULL;
+    }
 
     GstPad* sinkpad = gst_element_get_static_pad(_sink->queue, "sink");
+    GstPad* srcpad = gst_element_get_static_pad(_sink->queue, "src");
+    if(_sink->syncIndex) {
+        // Frames are time stamped as they arrive but only indexed once they leave the queue. That keeps file writes on
+        // the recording thread and leaves out frames the queue drops.
+        gst_pad_add_probe(sinkpad, GST_PAD_PROBE_TYPE_BUFFER, _syncArrivalProbeCallBack, _sink, NULL);
+    }
+    gst_pad_add_probe(srcpad, GST_PAD_PROBE_TYPE_BUFFER, _recordingQueueProbeCallBack, _sink, NULL);
+    gst_object_unref(srcpad);
     gst_pad_link(_sink->teepad, sinkpad);
     gst_object_unref(sinkpad);
 
@@ -663,6 +997,7 @@ VideoReceiver::startRecording(void)
 }
 
 //-----------------------------------------------------------------------------
+// The recording branch is finalized in the background, a new recording can be started right away
 void
 VideoReceiver::stopRecording(void)
 {
@@ -673,46 +1008,87 @@ VideoReceiver::stopRecording(void)
         qCDebug(VideoReceiverLog) << "Not recording!";
         return;
     }
+    Sink* sink = _sink;
+    _sink = NULL;
+    _finalizingSinks.append(sink);
+    _recording = false;
+    emit recordingChanged();
     // Wait for data block before unlinking
-    gst_pad_add_probe(_sink->teepad, GST_PAD_PROBE_TYPE_IDLE, _unlinkCallBack, this, NULL);
+    gst_pad_add_probe(sink->teepad, GST_PAD_PROBE_TYPE_IDLE, _unlinkCallBack, sink, NULL);
+    qCDebug(VideoReceiverLog) << "Recording Stopped";
 #endif
 }
 
 //-----------------------------------------------------------------------------
-// This is only installed on the transient _pipelineStopRec in order
-// to finalize a video file. It is not used for the main _pipeline.
-// -EOS has appeared on the bus of the temporary pipeline
-// -At this point all of the recoring elements have been flushed, and the video file has been finalized
-// -Now we can remove the temporary pipeline and its elements
 #if defined(QGC_GST_STREAMING)
 void
-VideoReceiver::_shutdownRecordingBranch()
+VideoReceiver::_linkRecordingBranch(GstBin* bin, Sink* sink)
 {
-    gst_bin_remove(GST_BIN(_pipelineStopRec), _sink->queue);
-    gst_bin_remove(GST_BIN(_pipelineStopRec), _sink->parse);
-    gst_bin_remove(GST_BIN(_pipelineStopRec), _sink->mux);
-    gst_bin_remove(GST_BIN(_pipelineStopRec), _sink->filesink);
+    for(int i = 0; i < sink->elements.count(); i++) {
+        gst_bin_add(bin, sink->elements[i]);
+        if(i > 0) {
+            gst_element_link(sink->elements[i - 1], sink->elements[i]);
+        }
+    }
+}
+#endif
 
-    gst_element_set_state(_pipelineStopRec, GST_STATE_NULL);
-    gst_object_unref(_pipelineStopRec);
-    _pipelineStopRec = NULL;
+//-----------------------------------------------------------------------------
+// Called once EOS went through the temporary pipeline of a stopped recording
+// -At this point all of the recording elements have been flushed, and the video file has been finalized
+// -Now we can remove the temporary pipeline and its elements
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_handleRecordingFinalized()
+{
+    for(int i = _finalizingSinks.count() - 1; i >= 0; i--) {
+        Sink* sink = _finalizingSinks[i];
+        if(g_atomic_int_get(&sink->finalized)) {
+            _finalizingSinks.removeAt(i);
+            _shutdownRecordingBranch(sink);
+        }
+    }
+    _deleteIfStopped();
+}
+#endif
 
-    gst_element_set_state(_sink->filesink,  GST_STATE_NULL);
-    gst_element_set_state(_sink->parse,     GST_STATE_NULL);
-    gst_element_set_state(_sink->mux,       GST_STATE_NULL);
-    gst_element_set_state(_sink->queue,     GST_STATE_NULL);
+//-----------------------------------------------------------------------------
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_shutdownRecordingBranch(Sink* sink)
+{
+    if(sink->pipelineStopRec) {
+        GstBus* bus = gst_pipeline_get_bus(GST_PIPELINE(sink->pipelineStopRec));
+        gst_bus_disable_sync_message_emission(bus);
+        gst_object_unref(bus);
 
-    gst_object_unref(_sink->queue);
-    gst_object_unref(_sink->parse);
-    gst_object_unref(_sink->mux);
-    gst_object_unref(_sink->filesink);
+        foreach(GstElement* element, sink->elements) {
+            gst_bin_remove(GST_BIN(sink->pipelineStopRec), element);
+        }
+        gst_element_set_state(sink->pipelineStopRec, GST_STATE_NULL);
+        gst_object_unref(sink->pipelineStopRec);
+        sink->pipelineStopRec = NULL;
+    }
 
-    delete _sink;
-    _sink = NULL;
-    _recording = false;
+    _releaseRecordingBranch(sink);
+    qCDebug(VideoReceiverLog) << "Recording finalized";
+}
+#endif
 
-    emit recordingChanged();
-    qCDebug(VideoReceiverLog) << "Recording Stopped";
+//-----------------------------------------------------------------------------
+// Drops our references to the recording branch elements and deletes the sink
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_releaseRecordingBranch(Sink* sink)
+{
+    foreach(GstElement* element, sink->elements) {
+        gst_element_set_state(element, GST_STATE_NULL);
+    }
+    foreach(GstElement* element, sink->elements) {
+        gst_object_unref(element);
+    }
+    delete sink->syncIndex;
+    delete sink;
 }
 #endif
 
@@ -721,38 +1097,36 @@ VideoReceiver::_shutdownRecordingBranch()
 // -Create a second temporary pipeline, and place the recording branch elements into that pipeline
 // -Setup watch and handler for EOS event on the temporary pipeline's bus
 // -Send an EOS event at the beginning of that pipeline
+// Runs from the streaming thread through the idle probe on the tee pad.
 #if defined(QGC_GST_STREAMING)
 void
-VideoReceiver::_detachRecordingBranch(GstPadProbeInfo* info)
+VideoReceiver::_detachRecordingBranch(Sink* sink)
 {
-    Q_UNUSED(info)
-
     // Also unlinks and unrefs
-    gst_bin_remove_many(GST_BIN(_pipeline), _sink->queue, _sink->parse, _sink->mux, _sink->filesink, NULL);
+    foreach(GstElement* element, sink->elements) {
+        gst_bin_remove(GST_BIN(_pipeline), element);
+    }
 
     // Give tee its pad back
-    gst_element_release_request_pad(_tee, _sink->teepad);
-    gst_object_unref(_sink->teepad);
-
-    // Create temporary pipeline
-    _pipelineStopRec = gst_pipeline_new("pipeStopRec");
+    gst_element_release_request_pad(_tee, sink->teepad);
+    gst_object_unref(sink->teepad);
 
-    // Put our elements from the recording branch into the temporary pipeline
-    gst_bin_add_many(GST_BIN(_pipelineStopRec), _sink->queue, _sink->parse, _sink->mux, _sink->filesink, NULL);
-    gst_element_link_many(_sink->queue, _sink->parse, _sink->mux, _sink->filesink, NULL);
+    // Create temporary pipeline and put our elements from the recording branch into it
+    sink->pipelineStopRec = gst_pipeline_new(NULL);
+    _linkRecordingBranch(GST_BIN(sink->pipelineStopRec), sink);
 
     // Add handler for EOS event
-    GstBus* bus = gst_pipeline_get_bus(GST_PIPELINE(_pipelineStopRec));
+    GstBus* bus = gst_pipeline_get_bus(GST_PIPELINE(sink->pipelineStopRec));
     gst_bus_enable_sync_message_emission(bus);
-    g_signal_connect(bus, "sync-message", G_CALLBACK(_onBusMessage), this);
+    g_signal_connect(bus, "sync-message", G_CALLBACK(_onRecordingBusMessage), sink);
     gst_object_unref(bus);
 
-    if(gst_element_set_state(_pipelineStopRec, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
-        qCDebug(VideoReceiverLog) << "problem starting _pipelineStopRec";
+    if(gst_element_set_state(sink->pipelineStopRec, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+        qCDebug(VideoReceiverLog) << "problem starting pipelineStopRec";
     }
 
     // Send EOS at the beginning of the pipeline
-    GstPad* sinkpad = gst_element_get_static_pad(_sink->queue, "sink");
+    GstPad* sinkpad = gst_element_get_static_pad(sink->queue, "sink");
     gst_pad_send_event(sinkpad, gst_event_new_eos());
     gst_object_unref(sinkpad);
     qCDebug(VideoReceiverLog) << "Recording branch unlinked";
@@ -766,16 +1140,71 @@ VideoReceiver::_unlinkCallBack(GstPad* pad, GstPadProbeInfo* info, gpointer user
 {
     Q_UNUSED(pad);
     if(info != NULL && user_data != NULL) {
-        VideoReceiver* pThis = (VideoReceiver*)user_data;
+        Sink* sink = (Sink*)user_data;
         // We will only act once
-        if(g_atomic_int_compare_and_exchange(&pThis->_sink->removing, FALSE, TRUE)) {
-            pThis->_detachRecordingBranch(info);
+        if(g_atomic_int_compare_and_exchange(&sink->removing, FALSE, TRUE)) {
+            sink->receiver->_detachRecordingBranch(sink);
         }
     }
     return GST_PAD_PROBE_REMOVE;
 }
 #endif
 
+//-----------------------------------------------------------------------------
+// This is only installed on the transient pipelineStopRec of a stopped recording in order to finalize its video file.
+// It is not used for the main _pipeline. An error only ends the recording, the live view is not affected.
+#if defined(QGC_GST_STREAMING)
+gboolean
+VideoReceiver::_onRecordingBusMessage(GstBus* bus, GstMessage* msg, gpointer data)
+{
+    Q_UNUSED(bus)
+    Q_ASSERT(msg != NULL && data != NULL);
+    Sink* sink = (Sink*)data;
+
+    switch(GST_MESSAGE_TYPE(msg)) {
+    case(GST_MESSAGE_ERROR): {
+        gchar* debug;
+        GError* error;
+        gst_message_parse_error(msg, &error, &debug);
+        g_free(debug);
+        qCritical() << "Error finalizing recording:" << error->message;
+        g_error_free(error);
+        g_atomic_int_set(&sink->finalized, 1);
+        sink->receiver->msgRecordingFinalized();
+    }
+        break;
+    case(GST_MESSAGE_EOS):
+        g_atomic_int_set(&sink->finalized, 1);
+        sink->receiver->msgRecordingFinalized();
+        break;
+    default:
+        break;
+    }
+
+    return TRUE;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Called from the streaming thread each time splitmuxsink opens a new segment
+#if defined(QGC_GST_STREAMING)
+gchar*
+VideoReceiver::_segmentLocationCallBack(GstElement* splitmux, guint fragmentId, gpointer user_data)
+{
+    Q_UNUSED(splitmux);
+    Sink* sink = (Sink*)user_data;
+    QString location = QString("%1_%2.%3").arg(sink->segmentBase).arg(fragmentId, 3, 10, QChar('0')).arg(sink->extension);
+    qCDebug(VideoReceiverLog) << "New video segment:" << location;
+    {
+        QMutexLocker locker(&sink->syncMutex);
+        sink->segmentLocation = location;
+    }
+    // Keep the recordings within their disk budget as segments are added
+    sink->receiver->msgSegmentOpened();
+    return g_strdup(qPrintable(location));
+}
+#endif
+
 //-----------------------------------------------------------------------------
 void
 VideoReceiver::_updateTimer()
@@ -798,12 +1227,14 @@ VideoReceiver::_updateTimer()
             }
         }
         if(_videoRunning) {
+            _updateLatency();
             time_t elapsed = 0;
             time_t lastFrame = _videoSurface->lastFrame();
             if(lastFrame != 0) {
                 elapsed = time(0) - _videoSurface->lastFrame();
             }
-            if(elapsed > 2 && _videoSurface) {
+            time_t stallTimeout = decodeMode() == DecodeKeyframes ? kKeyframeStallTimeout : kStallTimeout;
+            if(elapsed > stallTimeout && _videoSurface) {
                 stop();
             }
         } else {
@@ -815,3 +1246,396 @@ VideoReceiver::_updateTimer()
 #endif
 }
 
+//-----------------------------------------------------------------------------
+// Low latency profile:
+//  -The decode queue holds a single encoded frame. It does not leak since dropping encoded frames would corrupt the
+//   picture until the next key frame.
+//  -The decoder uses slice threading, frame threading adds a frame of delay per thread.
+//  -The render queue holds a single decoded frame and drops the older one when a new frame arrives before the sink
+//   took the previous one.
+//  -The sink shows frames as soon as they arrive instead of waiting for their presentation time.
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_configureLowLatency(GstElement* decodeQueue, GstElement* decoder, GstElement* renderQueue)
+{
+    g_object_set(G_OBJECT(decodeQueue), "max-size-buffers", 1, "max-size-bytes", 0, "max-size-time", static_cast<guint64>(0), NULL);
+    g_object_set(G_OBJECT(renderQueue), "max-size-buffers", 1, "max-size-bytes", 0, "max-size-time", static_cast<guint64>(0), NULL);
+    setPropertyIfExists(renderQueue, "leaky", 2 /* downstream */);
+
+    setPropertyIfExists(decoder, "thread-type", 2 /* slice */);
+    setPropertyIfExists(decoder, "max-threads", QThread::idealThreadCount());
+
+    setPropertyIfExists(_videoSink, "sync", FALSE);
+}
+#endif
+
+//-----------------------------------------------------------------------------
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_addLatencyProbe(GstElement* element, const char* padName, LatencyStage_t stage)
+{
+    GstPad* pad = gst_element_get_static_pad(element, padName);
+    if (!pad) {
+        qCDebug(VideoReceiverLog) << "No pad for latency probe" << padName;
+        return;
+    }
+    gulong probeId = gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, _latencyProbeCallBack, &_latencyProbes[stage], NULL);
+    if (stage == LatencyStageSink) {
+        _sinkLatencyProbeId = probeId;
+    }
+    gst_object_unref(pad);
+}
+#endif
+
+//-----------------------------------------------------------------------------
+#if defined(QGC_GST_STREAMING)
+GstPadProbeReturn
+VideoReceiver::_latencyProbeCallBack(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad);
+    if(info != NULL && user_data != NULL) {
+        LatencyProbe_t* probe = (LatencyProbe_t*)user_data;
+        GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+        if (buffer && GST_BUFFER_PTS_IS_VALID(buffer)) {
+            probe->receiver->_recordLatencyStage(probe->stage, GST_BUFFER_PTS(buffer));
+        }
+    }
+    return GST_PAD_PROBE_OK;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// CPU time used by the calling thread, 0 where it can't be measured
+#if defined(QGC_GST_STREAMING)
+static gint64
+_threadCpuUSecs()
+{
+#if defined(Q_OS_WIN)
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if(GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+        quint64 kernel100NSecs = ((quint64)kernelTime.dwHighDateTime << 32) | kernelTime.dwLowDateTime;
+        quint64 user100NSecs = ((quint64)userTime.dwHighDateTime << 32) | userTime.dwLowDateTime;
+        return (kernel100NSecs + user100NSecs) / 10;
+    }
+#else
+    struct timespec time;
+    if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) == 0) {
+        return (gint64)time.tv_sec * 1000000 + time.tv_nsec / 1000;
+    }
+#endif
+    return 0;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Called from the streaming threads
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_recordLatencyStage(int stage, GstClockTime pts)
+{
+    gint64 nowUSecs = g_get_monotonic_time();
+    QMutexLocker lock(&_latencyMutex);
+
+    if (stage == LatencyStageDecoderIn) {
+        // The decode queue thread runs the decoder, all it did since the previous frame went into decoding that frame
+        // and passing it on. Time spent waiting for the next frame uses no CPU.
+        gint64 cpuUSecs = _threadCpuUSecs();
+        GThread* thread = g_thread_self();
+        if (thread == _decodeThread && _decodeThreadCpuUSecs && cpuUSecs > _decodeThreadCpuUSecs) {
+            _decodeCpuUSecs += cpuUSecs - _decodeThreadCpuUSecs;
+        }
+        _decodeThread = thread;
+        _decodeThreadCpuUSecs = cpuUSecs;
+    }
+
+    if (stage == LatencyStageParsed) {
+        // Frames dropped along the way never reach the sink, don't let them pile up
+        if (_latencyFrames.count() >= _maxLatencyFrames) {
+            _latencyFrames.clear();
+        }
+        FrameLatency_t frame;
+        memset(&frame, 0, sizeof(frame));
+        frame.stageUSecs[LatencyStageParsed] = nowUSecs;
+        _latencyFrames[pts] = frame;
+        return;
+    }
+
+    QHash<GstClockTime, FrameLatency_t>::iterator it = _latencyFrames.find(pts);
+    if (it == _latencyFrames.end() || it->stageUSecs[stage - 1] == 0) {
+        return;
+    }
+
+    it->stageUSecs[stage] = nowUSecs;
+    _latencyTotalUSecs[stage] += nowUSecs - it->stageUSecs[stage - 1];
+    _latencyFrameCount[stage]++;
+
+    if (stage == LatencyStageSink) {
+        _latencyTotalUSecs[LatencyStageParsed] += nowUSecs - it->stageUSecs[LatencyStageParsed];
+        _latencyFrameCount[LatencyStageParsed]++;
+        _latencyFrames.erase(it);
+    }
+}
+#endif
+
+//-----------------------------------------------------------------------------
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_updateLatency()
+{
+    {
+        QMutexLocker lock(&_latencyMutex);
+        gint64 nowUSecs = g_get_monotonic_time();
+        gint64 intervalUSecs = nowUSecs - _latencyUpdateUSecs;
+        if (_latencyUpdateUSecs && intervalUSecs > 0) {
+            _frameRate  = _latencyFrameCount[LatencyStageDecoderOut] * 1000000.0 / intervalUSecs;
+            _decodeLoad = _decodeCpuUSecs * 100.0 / intervalUSecs;
+        }
+        _decodeCpuUSecs = 0;
+        _latencyUpdateUSecs = nowUSecs;
+        for (int i=0; i<LatencyStageCount; i++) {
+            if (_latencyFrameCount[i]) {
+                _latencyMSecs[i] = (double)_latencyTotalUSecs[i] / _latencyFrameCount[i] / 1000.0;
+            }
+            _latencyTotalUSecs[i] = 0;
+            _latencyFrameCount[i] = 0;
+        }
+    }
+    emit latencyChanged();
+}
+#endif
+
+//-----------------------------------------------------------------------------
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_resetLatency()
+{
+    {
+        QMutexLocker lock(&_latencyMutex);
+        _latencyFrames.clear();
+        for (int i=0; i<LatencyStageCount; i++) {
+            _latencyTotalUSecs[i] = 0;
+            _latencyFrameCount[i] = 0;
+            _latencyMSecs[i] = 0;
+        }
+        _latencyUpdateUSecs = 0;
+        _frameRate = 0;
+        _decodeLoad = 0;
+        _decodeCpuUSecs = 0;
+        _decodeThread = NULL;
+        _decodeThreadCpuUSecs = 0;
+    }
+    emit latencyChanged();
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Takes the wall clock time and telemetry log position for each frame entering the recording queue. Called from the
+// upstream streaming thread, so nothing is written here.
+#if defined(QGC_GST_STREAMING)
+GstPadProbeReturn
+VideoReceiver::_syncArrivalProbeCallBack(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad);
+    Sink* sink = (Sink*)user_data;
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if(buffer == NULL || !GST_BUFFER_PTS_IS_VALID(buffer)) {
+        return GST_PAD_PROBE_OK;
+    }
+
+    // A frame may arrive in several buffers, only the first one is indexed
+    GstClockTime pts = GST_BUFFER_PTS(buffer);
+    if(pts == sink->lastPts) {
+        return GST_PAD_PROBE_OK;
+    }
+    if(sink->firstPts == GST_CLOCK_TIME_NONE) {
+        sink->firstPts = pts;
+    }
+    sink->lastPts = pts;
+
+    SyncArrival_t arrival;
+    arrival.pts                     = pts;
+    arrival.entry.ptsNSecs          = pts >= sink->firstPts ? pts - sink->firstPts : 0;
+    arrival.entry.wallClockUSecs    = (quint64)QDateTime::currentMSecsSinceEpoch() * 1000;
+    arrival.entry.tlogOffset        = sink->mavlink ? sink->mavlink->logPosition(arrival.tlogFileName) : -1;
+
+    QMutexLocker locker(&sink->syncMutex);
+    sink->syncArrivals.append(arrival);
+
+    return GST_PAD_PROBE_OK;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Adds the sync index entry of each frame leaving the recording queue. Called from the recording queue thread. Frames
+// leave in arrival order, so arrivals ahead of the matching one were dropped by the queue and are not indexed.
+#if defined(QGC_GST_STREAMING)
+GstPadProbeReturn
+VideoReceiver::_syncIndexProbeCallBack(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad);
+    Sink* sink = (Sink*)user_data;
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if(buffer == NULL || !GST_BUFFER_PTS_IS_VALID(buffer)) {
+        return GST_PAD_PROBE_OK;
+    }
+
+    GstClockTime pts = GST_BUFFER_PTS(buffer);
+    SyncArrival_t arrival;
+    {
+        QMutexLocker locker(&sink->syncMutex);
+        int index = 0;
+        while(index < sink->syncArrivals.count() && sink->syncArrivals[index].pts != pts) {
+            index++;
+        }
+        if(index == sink->syncArrivals.count()) {
+            // Further buffer of a frame which has already been indexed
+            return GST_PAD_PROBE_OK;
+        }
+        sink->syncArrivals.erase(sink->syncArrivals.begin(), sink->syncArrivals.begin() + index);
+        arrival = sink->syncArrivals.takeFirst();
+    }
+
+    sink->syncIndex->append(arrival.entry, arrival.tlogFileName);
+
+    return GST_PAD_PROBE_OK;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Drops delta frames leaving the recording queue while waiting for a key frame, then indexes the frames which are
+// kept. Called from the recording queue thread.
+#if defined(QGC_GST_STREAMING)
+GstPadProbeReturn
+VideoReceiver::_recordingQueueProbeCallBack(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Sink* sink = (Sink*)user_data;
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if(buffer == NULL) {
+        return GST_PAD_PROBE_OK;
+    }
+    if(!GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+        g_atomic_int_set(&sink->waitForKeyframe, 0);
+    } else if(g_atomic_int_get(&sink->waitForKeyframe)) {
+        // Left in the arrivals, the index skips it like a frame the queue dropped
+        return GST_PAD_PROBE_DROP;
+    }
+    return sink->syncIndex ? _syncIndexProbeCallBack(pad, info, user_data) : GST_PAD_PROBE_OK;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Called from the streaming thread feeding the recording queue, right before the queue drops its oldest frame
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_recordingQueueOverrun(GstElement* queue, gpointer user_data)
+{
+    Q_UNUSED(queue);
+    Sink* sink = (Sink*)user_data;
+    g_atomic_int_set(&sink->waitForKeyframe, 1);
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Limits the memory held by the pipeline and the threads used by the decoder. The decode queue leaks once it holds
+// its share of the budget, the decoder then skips ahead to the next key frame so dropped frames don't corrupt the
+// picture. The low latency profile already keeps a single frame in each queue.
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_applyBudget(GstElement* decodeQueue, GstElement* decoder, GstElement* renderQueue)
+{
+    if (_decoderThreads > 0) {
+        setPropertyIfExists(decoder, "max-threads", _decoderThreads);
+    }
+
+    VideoSettings* videoSettings = qgcApp()->toolbox()->settingsManager()->videoSettings();
+    if (_memoryBudget > 0 && !videoSettings->lowLatencyMode()->rawValue().toBool()) {
+        // Encoded frames are small, most of the budget goes to decoded frames waiting for the sink
+        guint decodeQueueBytes = _memoryBudget / 4;
+        g_object_set(G_OBJECT(decodeQueue), "max-size-buffers", 0, "max-size-bytes", decodeQueueBytes, "max-size-time", static_cast<guint64>(0), NULL);
+        g_object_set(G_OBJECT(renderQueue), "max-size-buffers", 0, "max-size-bytes", _memoryBudget - decodeQueueBytes, "max-size-time", static_cast<guint64>(0), NULL);
+        setPropertyIfExists(decodeQueue, "leaky", 2 /* downstream */);
+        setPropertyIfExists(renderQueue, "leaky", 2 /* downstream */);
+        g_signal_connect(decodeQueue, "overrun", G_CALLBACK(_decodeQueueOverrun), this);
+    }
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// In key frame mode only key frames leave the decode queue, in reduced mode the frame rate is limited at the decoder
+// output. Both probes check the decode mode for each frame so it can change while the pipeline runs.
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_addDecodeModeProbes(GstElement* decodeQueue, GstElement* decoder)
+{
+    g_atomic_int_set(&_waitForKeyframe, 0);
+    _lastRenderedPts = GST_CLOCK_TIME_NONE;
+
+    GstPad* pad = gst_element_get_static_pad(decodeQueue, "src");
+    if (pad) {
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, _keyframeProbeCallBack, this, NULL);
+        gst_object_unref(pad);
+    }
+    pad = gst_element_get_static_pad(decoder, "src");
+    if (pad) {
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, _frameRateProbeCallBack, this, NULL);
+        gst_object_unref(pad);
+    }
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Called from the decode queue streaming thread
+#if defined(QGC_GST_STREAMING)
+GstPadProbeReturn
+VideoReceiver::_keyframeProbeCallBack(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad);
+    VideoReceiver* pThis = (VideoReceiver*)user_data;
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (buffer == NULL) {
+        return GST_PAD_PROBE_OK;
+    }
+    if (!GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+        g_atomic_int_set(&pThis->_waitForKeyframe, 0);
+        return GST_PAD_PROBE_OK;
+    }
+    if (pThis->_decodeMode.load() == DecodeKeyframes || g_atomic_int_get(&pThis->_waitForKeyframe)) {
+        return GST_PAD_PROBE_DROP;
+    }
+    return GST_PAD_PROBE_OK;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Called from the decoder streaming thread
+#if defined(QGC_GST_STREAMING)
+GstPadProbeReturn
+VideoReceiver::_frameRateProbeCallBack(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad);
+    VideoReceiver* pThis = (VideoReceiver*)user_data;
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (buffer == NULL || !GST_BUFFER_PTS_IS_VALID(buffer) || pThis->_decodeMode.load() != DecodeReduced) {
+        return GST_PAD_PROBE_OK;
+    }
+    GstClockTime pts = GST_BUFFER_PTS(buffer);
+    if (pThis->_lastRenderedPts != GST_CLOCK_TIME_NONE && pts >= pThis->_lastRenderedPts &&
+            pts - pThis->_lastRenderedPts < GST_SECOND / reducedFrameRate) {
+        return GST_PAD_PROBE_DROP;
+    }
+    pThis->_lastRenderedPts = pts;
+    return GST_PAD_PROBE_OK;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Called from the streaming thread feeding the decode queue, right before the queue drops its oldest frame
+#if defined(QGC_GST_STREAMING)
+void
+VideoReceiver::_decodeQueueOverrun(GstElement* queue, gpointer user_data)
+{
+    Q_UNUSED(queue);
+    VideoReceiver* pThis = (VideoReceiver*)user_data;
+    g_atomic_int_set(&pThis->_waitForKeyframe, 1);
+}
+#endif
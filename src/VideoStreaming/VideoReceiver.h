@@ -21,8 +21,13 @@
 #include <QObject>
 #include <QTimer>
 #include <QTcpSocket>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+#include <QAtomicInt>
 
 #include "VideoSurface.h"
+#include "VideoSyncIndex.h"
 
 #if defined(QGC_GST_STREAMING)
 #include <gst/gst.h>
@@ -30,12 +35,33 @@
 
 Q_DECLARE_LOGGING_CATEGORY(VideoReceiverLog)
 
+class MAVLinkProtocol;
+
 class VideoReceiver : public QObject
 {
     Q_OBJECT
 public:
+    /// How much of the stream is decoded. Streams which are not shown in full are decoded with less effort.
+    typedef enum {
+        DecodeFull,         ///< All frames are decoded and rendered
+        DecodeReduced,      ///< All frames are decoded, rendering is limited to reducedFrameRate
+        DecodeKeyframes     ///< Only key frames are decoded and rendered, enough for a thumbnail
+    } DecodeMode_t;
+
+    Q_ENUMS(DecodeMode_t)
+
+    Q_PROPERTY(DecodeMode_t     decodeMode          READ    decodeMode          NOTIFY decodeModeChanged)
 #if defined(QGC_GST_STREAMING)
     Q_PROPERTY(bool             recording           READ    recording           NOTIFY recordingChanged)
+    /// Measured time in msecs frames spend in each part of the pipeline, averaged over the last second
+    Q_PROPERTY(double           latencyDecodeQueue  READ    latencyDecodeQueue  NOTIFY latencyChanged)
+    Q_PROPERTY(double           latencyDecode       READ    latencyDecode       NOTIFY latencyChanged)
+    Q_PROPERTY(double           latencyRender       READ    latencyRender       NOTIFY latencyChanged)
+    Q_PROPERTY(double           latencyTotal        READ    latencyTotal        NOTIFY latencyChanged)
+    /// Decoded frames per second and CPU time of the decoding thread as a percentage of one core, averaged over the last
+    /// second. Work done on threads of the decoder itself, as with hardware or frame threaded decoding, is not included.
+    Q_PROPERTY(double           frameRate           READ    frameRate           NOTIFY latencyChanged)
+    Q_PROPERTY(double           decodeLoad          READ    decodeLoad          NOTIFY latencyChanged)
 #endif
     Q_PROPERTY(VideoSurface*    videoSurface        READ    videoSurface        CONSTANT)
     Q_PROPERTY(bool             videoRunning        READ    videoRunning        NOTIFY videoRunningChanged)
@@ -45,14 +71,38 @@ public:
     explicit VideoReceiver(QObject* parent = 0);
     ~VideoReceiver();
 
+    /// Stops receiving without waiting for the pipeline to drain and deletes the receiver once the pipeline is down and
+    /// its recordings are finalized. The receiver must not be used after this call.
+    void            deleteWhenStopped   ();
+
 #if defined(QGC_GST_STREAMING)
     bool            running         () { return _running;   }
     bool            recording       () { return _recording; }
     bool            streaming       () { return _streaming; }
     bool            starting        () { return _starting;  }
     bool            stopping        () { return _stopping;  }
+
+    double          latencyDecodeQueue  () { return _latencyMSecs[LatencyStageDecoderIn]; }
+    double          latencyDecode       () { return _latencyMSecs[LatencyStageDecoderOut]; }
+    double          latencyRender       () { return _latencyMSecs[LatencyStageSink]; }
+    double          latencyTotal        () { return _latencyMSecs[LatencyStageParsed]; }
+    double          frameRate           () { return _frameRate; }
+    double          decodeLoad          () { return _decodeLoad; }
+
+    /// Streaming tasks of the pipeline are run on this pool instead of dedicated threads. Applied when the pipeline
+    /// is started, the pool must outlive the receiver.
+    void            setTaskPool         (GstTaskPool* taskPool) { _taskPool = taskPool; }
 #endif
 
+    DecodeMode_t    decodeMode          () { return (DecodeMode_t)_decodeMode.load(); }
+    void            setDecodeMode       (DecodeMode_t decodeMode);
+
+    /// Resources the stream may use, applied when the pipeline is started. 0 leaves the GStreamer defaults.
+    void            setDecoderThreads   (int threads)       { _decoderThreads = threads; }
+    void            setMemoryBudget     (quint32 bytes)     { _memoryBudget = bytes; }
+
+    static const int reducedFrameRate = 5;
+
     VideoSurface*   videoSurface    () { return _videoSurface; }
     bool            videoRunning    () { return _videoRunning; }
     QString         imageFile       () { return _imageFile; }
@@ -65,11 +115,15 @@ signals:
     void videoRunningChanged        ();
     void imageFileChanged           ();
     void showFullScreenChanged      ();
+    void decodeModeChanged          ();
 #if defined(QGC_GST_STREAMING)
     void recordingChanged           ();
     void msgErrorReceived           ();
     void msgEOSReceived             ();
     void msgStateChangedReceived    ();
+    void msgRecordingFinalized      ();
+    void msgSegmentOpened           ();
+    void latencyChanged             ();
 #endif
 
 public slots:
@@ -88,21 +142,60 @@ private slots:
     void _handleError               ();
     void _handleEOS                 ();
     void _handleStateChanged        ();
+    void _handleRecordingFinalized  ();
+    void _stopTimeout               ();
 #endif
 
 private:
 #if defined(QGC_GST_STREAMING)
 
+    /// Sync index entry taken when a frame enters the recording queue, written once the frame leaves it
+    typedef struct {
+        GstClockTime            pts;
+        VideoSyncIndex::Entry_t entry;
+        QString                 tlogFileName;
+    } SyncArrival_t;
+
     typedef struct
     {
-        GstPad*         teepad;
-        GstElement*     queue;
-        GstElement*     mux;
-        GstElement*     filesink;
-        GstElement*     parse;
-        gboolean        removing;
+        VideoReceiver*      receiver;
+        GstPad*             teepad;
+        GstElement*         queue;
+        QList<GstElement*>  elements;           ///< Branch elements in link order, starting with queue
+        GstElement*         pipelineStopRec;    ///< Temporary pipeline the branch is finalized in once unlinked from the tee
+        QString             segmentBase;        ///< Path and name prefix of the recorded files
+        QString             extension;
+        QString             segmentLocation;    ///< File being written, set from the streaming thread and protected by syncMutex
+        VideoSyncIndex*     syncIndex;          ///< Written from the recording queue thread, NULL if the index could not be created
+        MAVLinkProtocol*    mavlink;
+        GstClockTime        firstPts;
+        GstClockTime        lastPts;
+        QMutex              syncMutex;
+        QList<SyncArrival_t> syncArrivals;      ///< Frames in the recording queue, oldest first, protected by syncMutex
+        gint                waitForKeyframe;    ///< Set when the queue leaks, delta frames are dropped until the next key frame
+        gboolean            removing;
+        gint                finalized;          ///< Set from the streaming thread once EOS or an error reached pipelineStopRec
     } Sink;
 
+    /// Points in the pipeline where frames are time stamped for latency measurement. Frames are matched between stages by
+    /// their presentation time stamp which is kept from the parser through to the sink.
+    typedef enum {
+        LatencyStageParsed,         ///< Parser output, the frame has been received and depacketized
+        LatencyStageDecoderIn,      ///< Decoder input, after waiting in the decode queue
+        LatencyStageDecoderOut,     ///< Decoder output
+        LatencyStageSink,           ///< Video sink input, after waiting in the render queue
+        LatencyStageCount
+    } LatencyStage_t;
+
+    typedef struct {
+        VideoReceiver*  receiver;
+        int             stage;
+    } LatencyProbe_t;
+
+    typedef struct {
+        gint64          stageUSecs[LatencyStageCount];
+    } FrameLatency_t;
+
     bool                _running;
     bool                _recording;
     bool                _streaming;
@@ -112,16 +205,37 @@ private:
     GstElement*         _tee;
 
     static gboolean             _onBusMessage           (GstBus* bus, GstMessage* message, gpointer user_data);
+    static gboolean             _onRecordingBusMessage  (GstBus* bus, GstMessage* message, gpointer user_data);
     static GstPadProbeReturn    _unlinkCallBack         (GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
-    void                        _detachRecordingBranch  (GstPadProbeInfo* info);
-    void                        _shutdownRecordingBranch();
+    static gchar*               _segmentLocationCallBack(GstElement* splitmux, guint fragmentId, gpointer user_data);
+    static GstPadProbeReturn    _syncArrivalProbeCallBack(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn    _syncIndexProbeCallBack (GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn    _recordingQueueProbeCallBack(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static void                 _recordingQueueOverrun  (GstElement* queue, gpointer user_data);
+    void                        _linkRecordingBranch    (GstBin* bin, Sink* sink);
+    void                        _detachRecordingBranch  (Sink* sink);
+    void                        _shutdownRecordingBranch(Sink* sink);
+    void                        _releaseRecordingBranch (Sink* sink);
     void                        _shutdownPipeline       ();
     void                        _cleanupOldVideos       ();
     void                        _setVideoSink           (GstElement* sink);
+    void                        _configureLowLatency    (GstElement* decodeQueue, GstElement* decoder, GstElement* renderQueue);
+    void                        _addLatencyProbe        (GstElement* element, const char* padName, LatencyStage_t stage);
+    void                        _recordLatencyStage     (int stage, GstClockTime pts);
+    void                        _updateLatency          ();
+    void                        _resetLatency           ();
+    void                        _deleteIfStopped        ();
+    void                        _applyBudget            (GstElement* decodeQueue, GstElement* decoder, GstElement* renderQueue);
+    void                        _addDecodeModeProbes    (GstElement* decodeQueue, GstElement* decoder);
+
+    static GstPadProbeReturn    _latencyProbeCallBack   (GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn    _keyframeProbeCallBack  (GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn    _frameRateProbeCallBack (GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static void                 _decodeQueueOverrun     (GstElement* queue, gpointer user_data);
 
     GstElement*     _pipeline;
-    GstElement*     _pipelineStopRec;
     GstElement*     _videoSink;
+    QList<Sink*>    _finalizingSinks;   ///< Stopped recordings whose files are still being finalized
 
     //-- Wait for Video Server to show up before starting
     QTimer          _frameTimer;
@@ -129,6 +243,27 @@ private:
     QTcpSocket*     _socket;
     bool            _serverPresent;
 
+    LatencyProbe_t                      _latencyProbes[LatencyStageCount];
+    gulong                              _sinkLatencyProbeId;    ///< The video sink outlives the pipeline, so its probe is removed on shutdown
+    QMutex                              _latencyMutex;          ///< Probes are called from the streaming threads
+    QHash<GstClockTime, FrameLatency_t> _latencyFrames;         ///< Frames which have not reached the sink yet
+    gint64                              _latencyTotalUSecs[LatencyStageCount];  ///< Time spent before each stage since the last update, index LatencyStageParsed holds the whole pipeline
+    int                                 _latencyFrameCount[LatencyStageCount];
+    double                              _latencyMSecs[LatencyStageCount];
+    gint64                              _latencyUpdateUSecs;    ///< Start of the current measurement interval
+    double                              _frameRate;
+    double                              _decodeLoad;
+    gint64                              _decodeCpuUSecs;        ///< CPU time of the decoding thread since the last update
+    GThread*                            _decodeThread;          ///< Thread which decoded the last frame
+    gint64                              _decodeThreadCpuUSecs;  ///< CPU time of _decodeThread when it decoded the last frame
+    bool                                _deleteWhenStopped;
+
+    GstTaskPool*    _taskPool;
+    gint            _waitForKeyframe;   ///< Set when frames were dropped, the decoder skips ahead to the next key frame
+    GstClockTime    _lastRenderedPts;   ///< Only used from the decoder streaming thread
+
+    static const int _maxLatencyFrames = 64;
+
 #endif
 
     QString         _uri;
@@ -136,6 +271,9 @@ private:
     VideoSurface*   _videoSurface;
     bool            _videoRunning;
     bool            _showFullScreen;
+    QAtomicInt      _decodeMode;        ///< Read from the streaming threads
+    int             _decoderThreads;
+    quint32         _memoryBudget;
 
 };
 
@@ -0,0 +1,200 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VideoStreamManager.h"
+
+#include <QThread>
+
+QGC_LOGGING_CATEGORY(VideoStreamManagerLog, "VideoStreamManagerLog")
+
+const double VideoStreamManager::_defaultCpuBudget = 50.0;
+
+VideoStreamManager::VideoStreamManager(QObject* parent)
+    : QObject(parent)
+    , _activeStream(NULL)
+    , _thumbnailsOnly(false)
+    , _cpuBudget(_defaultCpuBudget)
+    , _memoryBudget(_defaultMemoryBudget)
+#if defined(QGC_GST_STREAMING)
+    , _taskPool(NULL)
+#endif
+{
+#if defined(QGC_GST_STREAMING)
+    GError* error = NULL;
+    _taskPool = gst_task_pool_new();
+    gst_task_pool_prepare(_taskPool, &error);
+    if (error) {
+        qCWarning(VideoStreamManagerLog) << "Shared task pool not available:" << error->message;
+        g_error_free(error);
+        gst_object_unref(_taskPool);
+        _taskPool = NULL;
+    }
+#endif
+
+    // Decoder load is measured by the receivers over one second
+    _budgetTimer.setInterval(1000);
+    connect(&_budgetTimer, &QTimer::timeout, this, &VideoStreamManager::_checkBudgets);
+}
+
+VideoStreamManager::~VideoStreamManager()
+{
+    _budgetTimer.stop();
+    // Receivers stop their pipelines when deleted, which hands the tasks back to the pool
+    _streams.clearAndDeleteContents();
+#if defined(QGC_GST_STREAMING)
+    if (_taskPool) {
+        gst_task_pool_cleanup(_taskPool);
+        gst_object_unref(_taskPool);
+    }
+#endif
+}
+
+VideoReceiver* VideoStreamManager::addStream(const QString& uri)
+{
+    VideoReceiver* stream = new VideoReceiver(this);
+    stream->setUri(uri);
+#if defined(QGC_GST_STREAMING)
+    stream->setTaskPool(_taskPool);
+#endif
+    _streams.append(stream);
+    qCDebug(VideoStreamManagerLog) << "Stream added" << uri;
+
+    if (!_activeStream) {
+        _activeStream = stream;
+        emit activeStreamChanged();
+    }
+    _updateStreams();
+    _budgetTimer.start();
+
+#if defined(QGC_GST_STREAMING)
+    if (!uri.isEmpty()) {
+        stream->start();
+    }
+#endif
+
+    return stream;
+}
+
+void VideoStreamManager::removeStream(VideoReceiver* stream)
+{
+    if (!_streams.contains(stream)) {
+        return;
+    }
+    _streams.removeOne(stream);
+    _budgetStrikes.remove(stream);
+    if (_streams.count() == 0) {
+        _budgetTimer.stop();
+    }
+
+    bool activeRemoved = stream == _activeStream;
+    if (activeRemoved) {
+        _activeStream = _streams.count() ? _streams.value<VideoReceiver*>(0) : NULL;
+    }
+    _updateStreams();
+    if (activeRemoved) {
+        emit activeStreamChanged();
+    }
+
+    // Waiting for the recording to be finalized would block the GUI, the stream deletes itself once it is stopped
+    stream->deleteWhenStopped();
+}
+
+void VideoStreamManager::setActiveStream(VideoReceiver* stream)
+{
+    if (stream == _activeStream || (stream && !_streams.contains(stream))) {
+        return;
+    }
+    _activeStream = stream;
+    _updateStreams();
+    emit activeStreamChanged();
+}
+
+void VideoStreamManager::setThumbnailsOnly(bool thumbnailsOnly)
+{
+    if (thumbnailsOnly != _thumbnailsOnly) {
+        _thumbnailsOnly = thumbnailsOnly;
+        _updateStreams();
+        emit thumbnailsOnlyChanged();
+    }
+}
+
+void VideoStreamManager::setCpuBudget(double percent)
+{
+    _cpuBudget = percent;
+    // Streams which were over the previous budget get another chance
+    _budgetStrikes.clear();
+    _updateStreams();
+}
+
+void VideoStreamManager::setMemoryBudget(quint32 bytes)
+{
+    _memoryBudget = bytes;
+    _updateStreams();
+}
+
+/// The active stream gets the decoder threads which are not needed for a single thread per background stream
+int VideoStreamManager::decoderThreads(VideoReceiver* stream)
+{
+    if (_streams.count() < 2) {
+        // A single stream keeps the decoder default
+        return 0;
+    }
+    if (stream != _activeStream) {
+        return 1;
+    }
+    return qMax(1, QThread::idealThreadCount() - (_streams.count() - 1));
+}
+
+/// Sets the decode mode and the resources of each stream to match the active stream and the budgets
+void VideoStreamManager::_updateStreams(void)
+{
+    for (int i=0; i<_streams.count(); i++) {
+        VideoReceiver* stream = _streams.value<VideoReceiver*>(i);
+
+        stream->setDecoderThreads(decoderThreads(stream));
+        stream->setMemoryBudget(_memoryBudget);
+
+        VideoReceiver::DecodeMode_t decodeMode;
+        if (stream == _activeStream) {
+            decodeMode = VideoReceiver::DecodeFull;
+            _budgetStrikes.remove(stream);
+        } else if (_thumbnailsOnly || _budgetStrikes.value(stream) >= budgetStrikes) {
+            decodeMode = VideoReceiver::DecodeKeyframes;
+        } else {
+            decodeMode = VideoReceiver::DecodeReduced;
+        }
+        stream->setDecodeMode(decodeMode);
+    }
+}
+
+/// Background streams which stay over the CPU budget drop to key frames only
+void VideoStreamManager::_checkBudgets(void)
+{
+#if defined(QGC_GST_STREAMING)
+    bool changed = false;
+    for (int i=0; i<_streams.count(); i++) {
+        VideoReceiver* stream = _streams.value<VideoReceiver*>(i);
+        if (stream->decodeMode() != VideoReceiver::DecodeReduced) {
+            continue;
+        }
+        if (stream->videoRunning() && stream->decodeLoad() > _cpuBudget) {
+            int strikes = ++_budgetStrikes[stream];
+            if (strikes >= budgetStrikes) {
+                qCDebug(VideoStreamManagerLog) << "Stream over CPU budget, decoding key frames only" << stream->decodeLoad();
+                changed = true;
+            }
+        } else {
+            _budgetStrikes.remove(stream);
+        }
+    }
+    if (changed) {
+        _updateStreams();
+    }
+#endif
+}
@@ -0,0 +1,92 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QHash>
+
+#include "QGCLoggingCategory.h"
+#include "QmlObjectListModel.h"
+#include "VideoReceiver.h"
+
+Q_DECLARE_LOGGING_CATEGORY(VideoStreamManagerLog)
+
+/// Runs the receive pipelines of several video streams side by side, as used with a fleet of vehicles each streaming
+/// video.
+///
+/// The active stream is decoded in full. Background streams are decoded at a reduced frame rate, or key frames only
+/// when thumbnailsOnly is set. A background stream whose decoder uses more than the CPU budget for budgetStrikes
+/// consecutive seconds drops to key frames only until it becomes active. Each stream's queues are held within the
+/// memory budget, and the decoder threads available are shared between the streams with the larger share going to the
+/// active stream. All streaming threads come from a single task pool, so restarting a stream reuses its threads.
+class VideoStreamManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    VideoStreamManager(QObject* parent = NULL);
+    ~VideoStreamManager();
+
+    Q_PROPERTY(QmlObjectListModel*  streams         READ streams                                    CONSTANT)
+    Q_PROPERTY(VideoReceiver*       activeStream    READ activeStream   WRITE setActiveStream       NOTIFY activeStreamChanged)
+    Q_PROPERTY(bool                 thumbnailsOnly  READ thumbnailsOnly WRITE setThumbnailsOnly     NOTIFY thumbnailsOnlyChanged)
+
+    QmlObjectListModel* streams         (void) { return &_streams; }
+    VideoReceiver*      activeStream    (void) { return _activeStream; }
+    bool                thumbnailsOnly  (void) const { return _thumbnailsOnly; }
+    double              cpuBudget       (void) const { return _cpuBudget; }
+    quint32             memoryBudget    (void) const { return _memoryBudget; }
+
+    void setActiveStream    (VideoReceiver* stream);
+    void setThumbnailsOnly  (bool thumbnailsOnly);
+
+    /// Share of one core in percent a background stream may use for decoding
+    void setCpuBudget       (double percent);
+
+    /// Memory in bytes each stream may hold in its queues, 0 for no limit. Applies when a stream is (re)started.
+    void setMemoryBudget    (quint32 bytes);
+
+    /// Adds a stream and starts receiving it. The first stream added becomes the active stream.
+    /// @return The receiver for the stream, owned by the manager
+    VideoReceiver* addStream(const QString& uri);
+
+    /// Removes a stream. It is stopped and deleted in the background once its recording is finalized.
+    void removeStream(VideoReceiver* stream);
+
+    /// @return Decoder threads given to the stream the next time it is started
+    int decoderThreads(VideoReceiver* stream);
+
+    static const int budgetStrikes = 3;
+
+signals:
+    void activeStreamChanged    (void);
+    void thumbnailsOnlyChanged  (void);
+
+private slots:
+    void _checkBudgets(void);
+
+private:
+    void _updateStreams(void);
+
+    QmlObjectListModel          _streams;
+    VideoReceiver*              _activeStream;
+    bool                        _thumbnailsOnly;
+    double                      _cpuBudget;
+    quint32                     _memoryBudget;
+    QHash<VideoReceiver*, int>  _budgetStrikes;     ///< Consecutive seconds each background stream was over budget
+    QTimer                      _budgetTimer;
+#if defined(QGC_GST_STREAMING)
+    GstTaskPool*                _taskPool;
+#endif
+
+    static const double     _defaultCpuBudget;
+    static const quint32    _defaultMemoryBudget = 32 * 1024 * 1024;
+};
@@ -0,0 +1,139 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VideoStreamManagerTest.h"
+#include "VideoStreamManager.h"
+
+#include <QThread>
+#include <QUdpSocket>
+
+void VideoStreamManagerTest::cleanup(void)
+{
+#if defined(QGC_GST_STREAMING)
+    foreach (GstElement* sender, _senders) {
+        gst_element_set_state(sender, GST_STATE_NULL);
+        gst_object_unref(sender);
+    }
+    _senders.clear();
+#endif
+
+    UnitTest::cleanup();
+}
+
+/// Decode modes and resources follow the active stream, without running any pipelines
+void VideoStreamManagerTest::_policy_test(void)
+{
+    VideoStreamManager manager;
+
+    VideoReceiver* first = manager.addStream(QString());
+    QCOMPARE(manager.activeStream(), first);
+    QCOMPARE(first->decodeMode(), VideoReceiver::DecodeFull);
+    QCOMPARE(manager.decoderThreads(first), 0);
+
+    VideoReceiver* second = manager.addStream(QString());
+    VideoReceiver* third = manager.addStream(QString());
+    QCOMPARE(manager.streams()->count(), 3);
+    QCOMPARE(manager.activeStream(), first);
+    QCOMPARE(second->decodeMode(), VideoReceiver::DecodeReduced);
+    QCOMPARE(third->decodeMode(), VideoReceiver::DecodeReduced);
+    QCOMPARE(manager.decoderThreads(second), 1);
+    QCOMPARE(manager.decoderThreads(first), qMax(1, QThread::idealThreadCount() - 2));
+
+    manager.setThumbnailsOnly(true);
+    QCOMPARE(first->decodeMode(), VideoReceiver::DecodeFull);
+    QCOMPARE(second->decodeMode(), VideoReceiver::DecodeKeyframes);
+    QCOMPARE(third->decodeMode(), VideoReceiver::DecodeKeyframes);
+
+    manager.setActiveStream(second);
+    QCOMPARE(first->decodeMode(), VideoReceiver::DecodeKeyframes);
+    QCOMPARE(second->decodeMode(), VideoReceiver::DecodeFull);
+
+    manager.setThumbnailsOnly(false);
+    QCOMPARE(first->decodeMode(), VideoReceiver::DecodeReduced);
+    QCOMPARE(third->decodeMode(), VideoReceiver::DecodeReduced);
+
+    // Removing the active stream makes the first remaining stream active
+    manager.removeStream(second);
+    QCOMPARE(manager.streams()->count(), 2);
+    QCOMPARE(manager.activeStream(), first);
+    QCOMPARE(first->decodeMode(), VideoReceiver::DecodeFull);
+    QCOMPARE(third->decodeMode(), VideoReceiver::DecodeReduced);
+}
+
+#if defined(QGC_GST_STREAMING)
+/// Starts a live H.264 RTP stream to a local UDP port
+bool VideoStreamManagerTest::_startSender(int port)
+{
+    QString description = QStringLiteral("videotestsrc is-live=true ! video/x-raw,width=320,height=240,framerate=30/1 ! "
+                                         "x264enc tune=zerolatency speed-preset=ultrafast key-int-max=30 ! "
+                                         "rtph264pay config-interval=1 ! udpsink host=127.0.0.1 port=%1").arg(port);
+    GError* error = NULL;
+    GstElement* sender = gst_parse_launch(qPrintable(description), &error);
+    if (error) {
+        qWarning() << "Unable to create sender" << error->message;
+        g_error_free(error);
+        if (sender) {
+            gst_object_unref(sender);
+        }
+        return false;
+    }
+    _senders.append(sender);
+    return gst_element_set_state(sender, GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE;
+}
+#endif
+
+/// Receives two local streams and checks the background stream is decoded with less effort
+void VideoStreamManagerTest::_loopback_test(void)
+{
+#if defined(QGC_GST_STREAMING)
+    UT_OPT_IN(optInSlow);
+
+    // Let the system pick two ports which are free, both are held until known so they can't be the same
+    int firstPort, secondPort;
+    {
+        QUdpSocket firstSocket, secondSocket;
+        QVERIFY(firstSocket.bind(QHostAddress::LocalHost, 0));
+        QVERIFY(secondSocket.bind(QHostAddress::LocalHost, 0));
+        firstPort = firstSocket.localPort();
+        secondPort = secondSocket.localPort();
+    }
+    if (!_startSender(firstPort) || !_startSender(secondPort)) {
+        QSKIP("videotestsrc, x264enc or udpsink not available");
+    }
+
+    VideoStreamManager manager;
+    VideoReceiver* first = manager.addStream(QStringLiteral("udp://127.0.0.1:%1").arg(firstPort));
+    VideoReceiver* second = manager.addStream(QStringLiteral("udp://127.0.0.1:%1").arg(secondPort));
+    QTRY_VERIFY_WITH_TIMEOUT(first->videoRunning() && second->videoRunning(), 10000);
+
+    // Frame rates are measured over one second, give the measurement a couple of intervals
+    QTRY_VERIFY_WITH_TIMEOUT(first->frameRate() > 20, 5000);
+    QTRY_VERIFY_WITH_TIMEOUT(second->frameRate() > 20, 5000);
+
+    // Thumbnails decode a single frame per key frame interval
+    manager.setThumbnailsOnly(true);
+    QCOMPARE(second->decodeMode(), VideoReceiver::DecodeKeyframes);
+    QTRY_VERIFY_WITH_TIMEOUT(second->frameRate() > 0 && second->frameRate() < 5, 5000);
+    QVERIFY(first->frameRate() > 20);
+
+    // Switching the active stream restores the full frame rate
+    manager.setActiveStream(second);
+    QTRY_VERIFY_WITH_TIMEOUT(second->frameRate() > 20, 5000);
+    QTRY_VERIFY_WITH_TIMEOUT(first->frameRate() < 5, 5000);
+
+    // A background stream which uses more than its CPU budget drops to key frames
+    manager.setThumbnailsOnly(false);
+    QCOMPARE(first->decodeMode(), VideoReceiver::DecodeReduced);
+    manager.setCpuBudget(0);
+    QTRY_COMPARE_WITH_TIMEOUT(first->decodeMode(), VideoReceiver::DecodeKeyframes, (VideoStreamManager::budgetStrikes + 3) * 1000);
+    QCOMPARE(second->decodeMode(), VideoReceiver::DecodeFull);
+#else
+    QSKIP("Video streaming not available");
+#endif
+}
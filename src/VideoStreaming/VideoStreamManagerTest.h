@@ -0,0 +1,37 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#if defined(QGC_GST_STREAMING)
+#include <gst/gst.h>
+#endif
+
+/// Unit test for VideoStreamManager. The loopback test streams from local videotestsrc senders over UDP and runs with
+/// --unittest-slow only.
+class VideoStreamManagerTest : public UnitTest
+{
+    Q_OBJECT
+
+protected slots:
+    void cleanup(void);
+
+private slots:
+    void _policy_test(void);
+    void _loopback_test(void);
+
+#if defined(QGC_GST_STREAMING)
+private:
+    bool _startSender(int port);
+
+    QList<GstElement*> _senders;
+#endif
+};
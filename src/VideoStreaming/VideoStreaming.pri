@@ -98,6 +98,7 @@ LinuxBuild {
             -lgstrmdemux \
             -lgstisomp4 \
             -lgstmatroska \
+            -lgstmultifile \
 
         # Rest of GStreamer dependencies
         LIBS += -L$$GST_ROOT/lib \
@@ -157,6 +158,7 @@ VideoEnabled {
         $$PWD/gstqtvideosink/utils/bufferformat.h \
         $$PWD/gstqtvideosink/utils/utils.h \
         $$PWD/gstqtvideosink/utils/glutils.h \
+        $$PWD/gstqtvideosink/utils/textureuploader.h \
 
     SOURCES += \
         $$PWD/gstqtvideosink/delegates/basedelegate.cpp \
@@ -176,8 +178,17 @@ VideoEnabled {
         $$PWD/gstqtvideosink/painters/videomaterial.cpp \
         $$PWD/gstqtvideosink/painters/videonode.cpp \
         $$PWD/gstqtvideosink/utils/bufferformat.cpp \
+        $$PWD/gstqtvideosink/utils/textureuploader.cpp \
         $$PWD/gstqtvideosink/utils/utils.cpp \
 
+    contains(DEFINES, UNITTEST_BUILD) {
+        HEADERS += \
+            $$PWD/TextureUploaderTest.h \
+
+        SOURCES += \
+            $$PWD/TextureUploaderTest.cc \
+    }
+
 } else {
     LinuxBuild|MacBuild|iOSBuild|WindowsBuild|AndroidBuild {
         message("Skipping support for video streaming (GStreamer libraries not installed)")
@@ -0,0 +1,206 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VideoSyncIndex.h"
+
+#include <QtEndian>
+
+#include <algorithm>
+
+QGC_LOGGING_CATEGORY(VideoSyncIndexLog, "VideoSyncIndexLog")
+
+const char* VideoSyncIndex::fileExtension = "vsi";
+const char* VideoSyncIndex::_magic =        "QGCVSYNC";
+
+VideoSyncIndex::VideoSyncIndex(void)
+    : _unflushedCount(0)
+{
+
+}
+
+VideoSyncIndex::~VideoSyncIndex()
+{
+    close();
+}
+
+bool VideoSyncIndex::create(const QString& fileName)
+{
+    close();
+    _entries.clear();
+    _sections.clear();
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(VideoSyncIndexLog) << "Unable to create" << fileName << _file.errorString();
+        return false;
+    }
+
+    uchar header[_headerSize];
+    memcpy(header, _magic, _magicSize);
+    qToLittleEndian<quint32>(_version, header + _magicSize);
+    qToLittleEndian<quint32>(entrySize, header + _magicSize + sizeof(quint32));
+    if (_file.write((const char*)header, _headerSize) != _headerSize) {
+        qCWarning(VideoSyncIndexLog) << "Unable to write header" << fileName << _file.errorString();
+        _file.close();
+        return false;
+    }
+
+    return true;
+}
+
+void VideoSyncIndex::append(const Entry_t& entry, const QString& tlogFileName)
+{
+    if (_sections.isEmpty() || _sections.last().tlogFileName != tlogFileName) {
+        Section_t section;
+        section.tlogFileName = tlogFileName;
+        section.firstEntry = _entries.count();
+        _sections.append(section);
+
+        if (_file.isOpen()) {
+            QByteArray name = tlogFileName.toUtf8();
+            QByteArray record(1 + sizeof(quint16), 0);
+            record[0] = _sectionRecord;
+            qToLittleEndian<quint16>(name.size(), (uchar*)record.data() + 1);
+            record += name;
+            _write((const uchar*)record.constData(), record.size());
+        }
+    }
+
+    Entry_t newEntry = entry;
+    newEntry.section = _sections.count() - 1;
+    if (!_entries.isEmpty()) {
+        const Entry_t& lastEntry = _entries.last();
+        newEntry.ptsNSecs =         qMax(newEntry.ptsNSecs, lastEntry.ptsNSecs);
+        newEntry.wallClockUSecs =   qMax(newEntry.wallClockUSecs, lastEntry.wallClockUSecs);
+        if (lastEntry.section == newEntry.section) {
+            newEntry.tlogOffset =   qMax(newEntry.tlogOffset, lastEntry.tlogOffset);
+        }
+    }
+    _entries.append(newEntry);
+
+    if (_file.isOpen()) {
+        uchar record[1 + entrySize];
+        record[0] = _entryRecord;
+        qToLittleEndian<quint64>(newEntry.ptsNSecs, record + 1);
+        qToLittleEndian<quint64>(newEntry.wallClockUSecs, record + 1 + sizeof(quint64));
+        qToLittleEndian<qint64>(newEntry.tlogOffset, record + 1 + 2 * sizeof(quint64));
+        if (_write(record, sizeof(record)) && ++_unflushedCount >= _flushCount) {
+            _file.flush();
+            _unflushedCount = 0;
+        }
+    }
+}
+
+/// Writes a record to the index file, the file is closed on failure
+bool VideoSyncIndex::_write(const uchar* data, int size)
+{
+    if (_file.write((const char*)data, size) != size) {
+        qCWarning(VideoSyncIndexLog) << "Write failed, index closed" << _file.fileName() << _file.errorString();
+        _file.close();
+        return false;
+    }
+    return true;
+}
+
+void VideoSyncIndex::close(void)
+{
+    if (_file.isOpen()) {
+        _file.flush();
+        _file.close();
+    }
+    _unflushedCount = 0;
+}
+
+bool VideoSyncIndex::load(const QString& fileName)
+{
+    close();
+    _entries.clear();
+    _sections.clear();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(VideoSyncIndexLog) << "Unable to open" << fileName << file.errorString();
+        return false;
+    }
+
+    QByteArray bytes = file.readAll();
+    const uchar* data = (const uchar*)bytes.constData();
+    if (bytes.size() < _headerSize || memcmp(data, _magic, _magicSize) != 0) {
+        qCWarning(VideoSyncIndexLog) << "Not a video sync index" << fileName;
+        return false;
+    }
+    quint32 version = qFromLittleEndian<quint32>(data + _magicSize);
+    quint32 fileEntrySize = qFromLittleEndian<quint32>(data + _magicSize + sizeof(quint32));
+    if (version != _version || fileEntrySize != entrySize) {
+        qCWarning(VideoSyncIndexLog) << "Unsupported index version" << version << fileEntrySize << fileName;
+        return false;
+    }
+
+    // A partial last record is left over from an interrupted recording
+    const uchar* end = data + bytes.size();
+    data += _headerSize;
+    while (data < end) {
+        if (*data == _sectionRecord && end - data >= 1 + (int)sizeof(quint16)) {
+            quint16 nameSize = qFromLittleEndian<quint16>(data + 1);
+            if (end - data < 1 + (int)sizeof(quint16) + nameSize) {
+                break;
+            }
+            Section_t section;
+            section.tlogFileName = QString::fromUtf8((const char*)data + 1 + sizeof(quint16), nameSize);
+            section.firstEntry = _entries.count();
+            _sections.append(section);
+            data += 1 + sizeof(quint16) + nameSize;
+        } else if (*data == _entryRecord && end - data >= 1 + entrySize && !_sections.isEmpty()) {
+            Entry_t entry;
+            entry.ptsNSecs =        qFromLittleEndian<quint64>(data + 1);
+            entry.wallClockUSecs =  qFromLittleEndian<quint64>(data + 1 + sizeof(quint64));
+            entry.tlogOffset =      qFromLittleEndian<qint64>(data + 1 + 2 * sizeof(quint64));
+            entry.section =         _sections.count() - 1;
+            _entries.append(entry);
+            data += 1 + entrySize;
+        } else {
+            break;
+        }
+    }
+
+    qCDebug(VideoSyncIndexLog) << "Loaded" << _entries.count() << "entries in" << _sections.count() << "sections from" << fileName;
+    return true;
+}
+
+int VideoSyncIndex::indexForPts(quint64 ptsNSecs) const
+{
+    if (_entries.isEmpty()) {
+        return -1;
+    }
+    QVector<Entry_t>::const_iterator it = std::upper_bound(_entries.constBegin(), _entries.constEnd(), ptsNSecs,
+                                                           [](quint64 value, const Entry_t& entry) { return value < entry.ptsNSecs; });
+    return qMax(0, (int)(it - _entries.constBegin()) - 1);
+}
+
+int VideoSyncIndex::indexForWallClock(quint64 wallClockUSecs) const
+{
+    if (_entries.isEmpty()) {
+        return -1;
+    }
+    QVector<Entry_t>::const_iterator it = std::upper_bound(_entries.constBegin(), _entries.constEnd(), wallClockUSecs,
+                                                           [](quint64 value, const Entry_t& entry) { return value < entry.wallClockUSecs; });
+    return qMax(0, (int)(it - _entries.constBegin()) - 1);
+}
+
+int VideoSyncIndex::indexForTlogOffset(int section, qint64 tlogOffset) const
+{
+    if (section < 0 || section >= _sections.count() || _sections[section].firstEntry == _entries.count()) {
+        return -1;
+    }
+    QVector<Entry_t>::const_iterator first = _entries.constBegin() + _sections[section].firstEntry;
+    QVector<Entry_t>::const_iterator last = section + 1 < _sections.count() ? _entries.constBegin() + _sections[section + 1].firstEntry : _entries.constEnd();
+    QVector<Entry_t>::const_iterator it = std::upper_bound(first, last, tlogOffset,
+                                                           [](qint64 value, const Entry_t& entry) { return value < entry.tlogOffset; });
+    return (int)((it == first ? first : it - 1) - _entries.constBegin());
+}
@@ -0,0 +1,93 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QVector>
+#include <QString>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(VideoSyncIndexLog)
+
+/// Sidecar index written next to a video recording which maps each recorded frame to the GCS wall clock time and the
+/// telemetry log position at which it was received.
+///
+/// Telemetry logging restarts with a new log each time the vehicle is armed, so the entries are grouped in sections.
+/// Each section records the name of the telemetry log its offsets refer to. The file holds a small header followed by
+/// little endian records in recording order: a section record with the log name each time the log changes and a fixed
+/// size record for each entry. Frame and wall clock times only grow over the whole recording and log offsets only
+/// grow within a section, so lookups are binary searches. Records are flushed regularly and a partially written last
+/// record is ignored on load, so an interrupted recording keeps a usable index.
+class VideoSyncIndex
+{
+public:
+    VideoSyncIndex(void);
+    ~VideoSyncIndex();
+
+    typedef struct {
+        quint64 ptsNSecs;       ///< Frame presentation time relative to the first recorded frame
+        quint64 wallClockUSecs; ///< GCS time the frame was received, same time base as the tlog timestamps
+        qint64  tlogOffset;     ///< Position in the section's telemetry log when the frame was received, -1: telemetry was not logged
+        int     section;        ///< Section the entry belongs to, set by append
+    } Entry_t;
+
+    /// Creates a new index file for writing, an existing file is overwritten
+    bool create(const QString& fileName);
+
+    /// Adds an entry to the index being written. A new section is started when the telemetry log differs from the one
+    /// of the previous entry. Values going backwards are clamped to the previous entry to keep the index searchable.
+    ///     @param tlogFileName Name of the telemetry log tlogOffset refers to, empty if telemetry was not logged
+    void append(const Entry_t& entry, const QString& tlogFileName);
+
+    /// Flushes and closes the index being written
+    void close(void);
+
+    /// Loads an index for lookups
+    bool load(const QString& fileName);
+
+    int             count   (void) const { return _entries.count(); }
+    const Entry_t&  entry   (int index) const { return _entries[index]; }
+
+    int             sectionCount        (void) const { return _sections.count(); }
+    const QString&  sectionTlogFileName (int section) const { return _sections[section].tlogFileName; }
+
+    /// Lookups return the index of the last entry at or before the given value. Values before the first entry return
+    /// the first entry. @return -1 if the index is empty
+    int indexForPts         (quint64 ptsNSecs) const;
+    int indexForWallClock   (quint64 wallClockUSecs) const;
+
+    /// Same as above restricted to the entries of one section. @return -1 if the section does not exist
+    int indexForTlogOffset  (int section, qint64 tlogOffset) const;
+
+    static const char*  fileExtension;
+    static const int    entrySize = 3 * sizeof(quint64);    ///< Size of an entry record without its record type
+
+private:
+    typedef struct {
+        QString tlogFileName;
+        int     firstEntry;
+    } Section_t;
+
+    bool _write(const uchar* data, int size);
+
+    QFile               _file;
+    QVector<Entry_t>    _entries;
+    QVector<Section_t>  _sections;
+    int                 _unflushedCount;
+
+    static const char*  _magic;
+    static const int    _magicSize = 8;
+    static const quint32 _version = 2;
+    static const int    _headerSize = _magicSize + 2 * sizeof(quint32);
+    static const int    _flushCount = 30;   ///< Entries written between flushes, about a second of video
+    static const uchar  _sectionRecord = 'S';
+    static const uchar  _entryRecord = 'E';
+};
@@ -0,0 +1,171 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VideoSyncIndexTest.h"
+#include "VideoSyncIndex.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+static const quint64 _frameNSecs =  33333333;
+static const quint64 _startUSecs =  1500000000000000ULL;
+static const int     _entryCount =  100;
+static const char*   _tlogName =    "FlightData1234.tlog";
+
+VideoSyncIndexTest::VideoSyncIndexTest(void)
+    : _tempDir(NULL)
+{
+
+}
+
+void VideoSyncIndexTest::init(void)
+{
+    UnitTest::init();
+
+    _tempDir = new QTemporaryDir();
+    QVERIFY(_tempDir->isValid());
+}
+
+void VideoSyncIndexTest::cleanup(void)
+{
+    delete _tempDir;
+    _tempDir = NULL;
+
+    UnitTest::cleanup();
+}
+
+QString VideoSyncIndexTest::_indexPath(void) const
+{
+    return QDir(_tempDir->path()).filePath(QStringLiteral("recording.") + VideoSyncIndex::fileExtension);
+}
+
+/// Writes a 30 fps recording where telemetry logging starts with the 10th frame
+static void _writeRecording(VideoSyncIndex& index)
+{
+    for (int i=0; i<_entryCount; i++) {
+        VideoSyncIndex::Entry_t entry;
+        entry.ptsNSecs = i * _frameNSecs;
+        entry.wallClockUSecs = _startUSecs + i * (_frameNSecs / 1000);
+        entry.tlogOffset = i < 10 ? -1 : (i - 10) * 500;
+        index.append(entry, i < 10 ? QString() : QString(_tlogName));
+    }
+}
+
+void VideoSyncIndexTest::_writeLoad_test(void)
+{
+    VideoSyncIndex writer;
+    QVERIFY(writer.create(_indexPath()));
+    _writeRecording(writer);
+    writer.close();
+    // Header, a section without telemetry, a section for the log and a record per entry
+    QCOMPARE(QFileInfo(_indexPath()).size(), (qint64)(16 + 3 + (3 + qstrlen(_tlogName)) + _entryCount * (1 + VideoSyncIndex::entrySize)));
+
+    VideoSyncIndex reader;
+    QVERIFY(reader.load(_indexPath()));
+    QCOMPARE(reader.count(), _entryCount);
+    for (int i=0; i<_entryCount; i++) {
+        QCOMPARE(reader.entry(i).ptsNSecs, writer.entry(i).ptsNSecs);
+        QCOMPARE(reader.entry(i).wallClockUSecs, writer.entry(i).wallClockUSecs);
+        QCOMPARE(reader.entry(i).tlogOffset, writer.entry(i).tlogOffset);
+        QCOMPARE(reader.entry(i).section, writer.entry(i).section);
+    }
+    QCOMPARE(reader.sectionCount(), 2);
+    QCOMPARE(reader.sectionTlogFileName(0), QString());
+    QCOMPARE(reader.sectionTlogFileName(1), QString(_tlogName));
+    QCOMPARE(reader.entry(9).section, 0);
+    QCOMPARE(reader.entry(10).section, 1);
+
+    // Not an index
+    QFile other(QDir(_tempDir->path()).filePath("other.vsi"));
+    QVERIFY(other.open(QIODevice::WriteOnly));
+    other.write("not an index file at all");
+    other.close();
+    QVERIFY(!reader.load(other.fileName()));
+    QCOMPARE(reader.count(), 0);
+}
+
+void VideoSyncIndexTest::_lookup_test(void)
+{
+    VideoSyncIndex index;
+    QCOMPARE(index.indexForPts(0), -1);
+    QCOMPARE(index.indexForWallClock(0), -1);
+    QCOMPARE(index.indexForTlogOffset(0, 0), -1);
+
+    _writeRecording(index);
+
+    // Exact matches and values between two frames give the frame at or before the value
+    QCOMPARE(index.indexForPts(50 * _frameNSecs), 50);
+    QCOMPARE(index.indexForPts(50 * _frameNSecs + 1000), 50);
+    QCOMPARE(index.indexForWallClock(_startUSecs + 20 * (_frameNSecs / 1000)), 20);
+    QCOMPARE(index.indexForWallClock(_startUSecs + 20 * (_frameNSecs / 1000) + 10), 20);
+    QCOMPARE(index.indexForTlogOffset(1, 30 * 500), 40);
+    QCOMPARE(index.indexForTlogOffset(1, 30 * 500 + 499), 40);
+
+    // Before the first entry and past the last entry are clamped
+    QCOMPARE(index.indexForWallClock(0), 0);
+    QCOMPARE(index.indexForPts(1000 * _frameNSecs), _entryCount - 1);
+    QCOMPARE(index.indexForTlogOffset(1, 1000000), _entryCount - 1);
+    QCOMPARE(index.indexForTlogOffset(1, -1), 10);
+
+    // Frames without telemetry are in their own section
+    QCOMPARE(index.indexForTlogOffset(0, -1), 9);
+    QCOMPARE(index.indexForTlogOffset(2, 0), -1);
+}
+
+void VideoSyncIndexTest::_monotonic_test(void)
+{
+    VideoSyncIndex index;
+
+    VideoSyncIndex::Entry_t entry;
+    entry.ptsNSecs = 1000;
+    entry.wallClockUSecs = _startUSecs;
+    entry.tlogOffset = 5000;
+    index.append(entry, _tlogName);
+
+    // Wall clock stepped back within the same log
+    entry.ptsNSecs = 2000;
+    entry.wallClockUSecs = _startUSecs - 100;
+    entry.tlogOffset = 4000;
+    index.append(entry, _tlogName);
+
+    QCOMPARE(index.count(), 2);
+    QCOMPARE(index.entry(1).ptsNSecs, (quint64)2000);
+    QCOMPARE(index.entry(1).wallClockUSecs, _startUSecs);
+    QCOMPARE(index.entry(1).tlogOffset, (qint64)5000);
+
+    // Telemetry log restarted, offsets in the new section start over
+    entry.ptsNSecs = 3000;
+    entry.wallClockUSecs = _startUSecs + 100;
+    entry.tlogOffset = 0;
+    index.append(entry, QStringLiteral("FlightData5678.tlog"));
+
+    QCOMPARE(index.sectionCount(), 2);
+    QCOMPARE(index.entry(2).section, 1);
+    QCOMPARE(index.entry(2).tlogOffset, (qint64)0);
+    QCOMPARE(index.indexForTlogOffset(0, 5000), 1);
+    QCOMPARE(index.indexForTlogOffset(1, 0), 2);
+}
+
+void VideoSyncIndexTest::_truncated_test(void)
+{
+    {
+        VideoSyncIndex writer;
+        QVERIFY(writer.create(_indexPath()));
+        _writeRecording(writer);
+    }
+
+    // Cut the last entry in half as an interrupted recording would
+    QFile file(_indexPath());
+    QVERIFY(file.resize(file.size() - (1 + VideoSyncIndex::entrySize) / 2));
+
+    VideoSyncIndex reader;
+    QVERIFY(reader.load(_indexPath()));
+    QCOMPARE(reader.count(), _entryCount - 1);
+    QCOMPARE(reader.entry(_entryCount - 2).ptsNSecs, (_entryCount - 2) * _frameNSecs);
+}
@@ -0,0 +1,38 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QTemporaryDir>
+
+/// Unit test for VideoSyncIndex
+class VideoSyncIndexTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    VideoSyncIndexTest(void);
+
+protected slots:
+    void init(void);
+    void cleanup(void);
+
+private slots:
+    void _writeLoad_test(void);
+    void _lookup_test(void);
+    void _monotonic_test(void);
+    void _truncated_test(void);
+
+private:
+    QString _indexPath(void) const;
+
+    QTemporaryDir* _tempDir;
+};
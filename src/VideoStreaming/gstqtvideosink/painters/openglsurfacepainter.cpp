@@ -210,23 +210,7 @@ void OpenGLSurfacePainter::paint(quint8 *data,
         txRight, txTop
     };
 
-    for (int i = 0; i < m_textureCount; ++i) {
-        funcs->glBindTexture(GL_TEXTURE_2D, m_textureIds[i]);
-        funcs->glTexImage2D(
-                GL_TEXTURE_2D,
-                0,
-                m_textureInternalFormat,
-                m_textureWidths[i],
-                m_textureHeights[i],
-                0,
-                m_textureFormat,
-                m_textureType,
-                data + m_textureOffsets[i]);
-        funcs->glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        funcs->glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        funcs->glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        funcs->glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    }
+    m_textureUploader.upload(data);
 
     paintImpl(painter, vertexCoordArray, textureCoordArray);
 
@@ -261,6 +245,13 @@ void OpenGLSurfacePainter::initRgbTextureInfo(
     m_textureOffsets[0] = 0;
 }
 
+void OpenGLSurfacePainter::initTextureUploader()
+{
+    m_textureUploader.init(m_textureCount, m_textureIds,
+                           m_textureWidths, m_textureHeights, m_textureOffsets,
+                           m_textureInternalFormat, m_textureFormat, m_textureType);
+}
+
 void OpenGLSurfacePainter::initYuv420PTextureInfo(const QSize &size)
 {
     int bytesPerLine = (size.width() + 3) & ~3;
@@ -491,6 +482,7 @@ void ArbFpSurfacePainter::init(const BufferFormat &format)
                 reinterpret_cast<const char *>(errorString);
         } else {
             funcs->glGenTextures(m_textureCount, m_textureIds);
+            initTextureUploader();
         }
     }
 }
@@ -500,6 +492,7 @@ void ArbFpSurfacePainter::cleanup()
     QOpenGLFunctionsDef *funcs = getQOpenGLFunctions();
     if (funcs)
     {
+        m_textureUploader.cleanup();
         funcs->glDeleteTextures(m_textureCount, m_textureIds);
         glDeleteProgramsARB(1, &m_programId);
     }
@@ -731,8 +724,10 @@ void GlslSurfacePainter::init(const BufferFormat &format)
     }
 
     QOpenGLFunctionsDef *funcs = getQOpenGLFunctions();
-    if (funcs)
+    if (funcs) {
         funcs->glGenTextures(m_textureCount, m_textureIds);
+        initTextureUploader();
+    }
 }
 
 void GlslSurfacePainter::cleanup()
@@ -740,6 +735,7 @@ void GlslSurfacePainter::cleanup()
     QOpenGLFunctionsDef *funcs = getQOpenGLFunctions();
     if (funcs)
     {
+        m_textureUploader.cleanup();
         funcs->glDeleteTextures(m_textureCount, m_textureIds);
         m_program.removeAllShaders();
     }
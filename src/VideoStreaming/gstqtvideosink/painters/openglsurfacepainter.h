@@ -27,6 +27,7 @@
 #ifndef GST_QT_VIDEO_SINK_NO_OPENGL
 
 #include "abstractsurfacepainter.h"
+#include "textureuploader.h"
 #include <QGLShaderProgram>
 
 #ifndef Q_WS_MAC
@@ -62,6 +63,7 @@ protected:
     void initRgbTextureInfo(GLenum internalFormat, GLuint format, GLenum type, const QSize &size);
     void initYuv420PTextureInfo(const QSize &size);
     void initYv12TextureInfo(const QSize &size);
+    void initTextureUploader();
 
     virtual void paintImpl(const QPainter *painter,
                            const GLfloat *vertexCoordArray,
@@ -80,6 +82,7 @@ protected:
     int m_textureWidths[3];
     int m_textureHeights[3];
     int m_textureOffsets[3];
+    TextureUploader m_textureUploader;
 
     QMatrix4x4 m_colorMatrix;
     GstVideoColorMatrix m_videoColorMatrix;
@@ -244,6 +244,7 @@ VideoMaterial *VideoMaterial::create(const BufferFormat & format)
 
 VideoMaterial::VideoMaterial()
     : m_frame(0)
+    , m_frameChanged(false)
     , m_textureCount(0)
     , m_textureFormat(0)
     , m_textureInternalFormat(0)
@@ -256,11 +257,12 @@ VideoMaterial::VideoMaterial()
 
 VideoMaterial::~VideoMaterial()
 {
-    if (!m_textureSize.isEmpty())
+    if (m_textureIds[0])
     {
         QOpenGLFunctionsDef *funcs = getQOpenGLFunctions();
         if (funcs)
         {
+            m_textureUploader.cleanup();
             funcs->glDeleteTextures(m_textureCount, m_textureIds);
         }
     }
@@ -334,6 +336,9 @@ void VideoMaterial::init(GstVideoColorMatrix colorMatrixType)
     if (funcs)
     {
         funcs->glGenTextures(m_textureCount, m_textureIds);
+        m_textureUploader.init(m_textureCount, m_textureIds,
+                               m_textureWidths, m_textureHeights, m_textureOffsets,
+                               m_textureInternalFormat, m_textureFormat, m_textureType);
         m_colorMatrixType = colorMatrixType;
         updateColors(0, 0, 0, 0);
     }
@@ -343,6 +348,7 @@ void VideoMaterial::setCurrentFrame(GstBuffer *buffer)
 {
     QMutexLocker lock(&m_frameMutex);
     gst_buffer_replace(&m_frame, buffer);
+    m_frameChanged = true;
 }
 
 void VideoMaterial::updateColors(int brightness, int contrast, int hue, int saturation)
@@ -428,52 +434,26 @@ void VideoMaterial::bind()
 
     GstBuffer *frame = NULL;
 
+    // The scene graph binds the material on every render, only upload frames which have not been uploaded yet
     m_frameMutex.lock();
-    if (m_frame)
-      frame = gst_buffer_ref(m_frame);
+    if (m_frame && m_frameChanged) {
+        frame = gst_buffer_ref(m_frame);
+        m_frameChanged = false;
+    }
     m_frameMutex.unlock();
 
     if (frame) {
         GstMapInfo info;
         gst_buffer_map(frame, &info, GST_MAP_READ);
-        funcs->glActiveTexture(GL_TEXTURE1);
-        bindTexture(1, info.data);
-        funcs->glActiveTexture(GL_TEXTURE2);
-        bindTexture(2, info.data);
-        funcs->glActiveTexture(GL_TEXTURE0); // Finish with 0 as default texture unit
-        bindTexture(0, info.data);
+        m_textureUploader.upload(info.data);
         gst_buffer_unmap(frame, &info);
         gst_buffer_unref(frame);
-    } else {
-        funcs->glActiveTexture(GL_TEXTURE1);
-        funcs->glBindTexture(GL_TEXTURE_2D, m_textureIds[1]);
-        funcs->glActiveTexture(GL_TEXTURE2);
-        funcs->glBindTexture(GL_TEXTURE_2D, m_textureIds[2]);
-        funcs->glActiveTexture(GL_TEXTURE0); // Finish with 0 as default texture unit
-        funcs->glBindTexture(GL_TEXTURE_2D, m_textureIds[0]);
     }
-}
-
-void VideoMaterial::bindTexture(int i, const quint8 *data)
-{
-    QOpenGLFunctionsDef *funcs = getQOpenGLFunctions();
-    if (!funcs)
-        return;
 
-    funcs->glBindTexture(GL_TEXTURE_2D, m_textureIds[i]);
-    funcs->glTexImage2D(
-        GL_TEXTURE_2D,
-        0,
-        m_textureInternalFormat,
-        m_textureWidths[i],
-        m_textureHeights[i],
-        0,
-        m_textureFormat,
-        m_textureType,
-        data + m_textureOffsets[i]);
-    funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    funcs->glActiveTexture(GL_TEXTURE1);
+    funcs->glBindTexture(GL_TEXTURE_2D, m_textureIds[1]);
+    funcs->glActiveTexture(GL_TEXTURE2);
+    funcs->glBindTexture(GL_TEXTURE_2D, m_textureIds[2]);
+    funcs->glActiveTexture(GL_TEXTURE0); // Finish with 0 as default texture unit
+    funcs->glBindTexture(GL_TEXTURE_2D, m_textureIds[0]);
 }
-
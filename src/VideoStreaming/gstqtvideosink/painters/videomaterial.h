@@ -26,6 +26,7 @@
 #define VIDEOMATERIAL_H
 
 #include "../utils/bufferformat.h"
+#include "../utils/textureuploader.h"
 #include <QSize>
 #include <QMutex>
 #include <QMatrix4x4>
@@ -56,10 +57,8 @@ protected:
     void init(GstVideoColorMatrix colorMatrixType);
 
 private:
-    void bindTexture(int i, const quint8 *data);
-
-
     GstBuffer *m_frame;
+    bool m_frameChanged;    ///< m_frame has not been uploaded to the textures yet
     QMutex m_frameMutex;
 
     static const int Num_Texture_IDs = 3;
@@ -68,7 +67,7 @@ private:
     int m_textureWidths[Num_Texture_IDs];
     int m_textureHeights[Num_Texture_IDs];
     int m_textureOffsets[Num_Texture_IDs];
-    QSize m_textureSize;
+    TextureUploader m_textureUploader;
 
     GLenum m_textureFormat;
     GLuint m_textureInternalFormat;
@@ -0,0 +1,196 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief Uploads decoded video frames into the textures used by the video painters
+ */
+
+#include "textureuploader.h"
+
+#include <QSurfaceFormat>
+#include <string.h>
+
+#include "glutils.h"
+
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#  define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+
+#ifndef GL_STREAM_DRAW
+#  define GL_STREAM_DRAW 0x88E0
+#endif
+
+#ifndef GL_UNSIGNED_SHORT_5_6_5
+#  define GL_UNSIGNED_SHORT_5_6_5 33635
+#endif
+
+#ifndef GL_CLAMP_TO_EDGE
+#  define GL_CLAMP_TO_EDGE 0x812F
+#endif
+
+static int bytesPerPixel(GLenum format, GLenum type)
+{
+    if (type == GL_UNSIGNED_SHORT_5_6_5)
+        return 2;
+
+    switch (format) {
+    case GL_RGBA:
+        return 4;
+    case GL_RGB:
+        return 3;
+    default:
+        return 1;
+    }
+}
+
+TextureUploader::TextureUploader()
+    : m_mode(TexImageMode)
+    , m_textureCount(0)
+    , m_textureInternalFormat(0)
+    , m_textureFormat(0)
+    , m_textureType(0)
+    , m_frameBytes(0)
+    , m_storageAllocated(false)
+    , m_nextPixelBuffer(0)
+{
+    memset(m_textureIds, 0, sizeof(m_textureIds));
+    memset(m_pixelBuffers, 0, sizeof(m_pixelBuffers));
+}
+
+//static
+TextureUploader::Mode TextureUploader::supportedMode()
+{
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!context)
+        return TexImageMode;
+
+    // Pixel buffer objects are core since OpenGL 2.1 and OpenGL ES 3.0
+    const QSurfaceFormat format = context->format();
+    bool pixelBuffers;
+    if (context->isOpenGLES()) {
+        pixelBuffers = format.majorVersion() >= 3
+                || context->hasExtension(QByteArrayLiteral("GL_NV_pixel_buffer_object"));
+    } else {
+        pixelBuffers = format.version() >= qMakePair(2, 1)
+                || context->hasExtension(QByteArrayLiteral("GL_ARB_pixel_buffer_object"));
+    }
+
+    return pixelBuffers ? PixelBufferMode : TexSubImageMode;
+}
+
+void TextureUploader::init(int textureCount, const GLuint *textureIds,
+                           const int *widths, const int *heights, const int *offsets,
+                           GLuint internalFormat, GLenum format, GLenum type,
+                           Mode maxMode)
+{
+    cleanup();
+
+    Q_ASSERT(textureCount <= Max_Textures);
+    m_textureCount = qMin(textureCount, static_cast<int>(Max_Textures));
+    m_textureInternalFormat = internalFormat;
+    m_textureFormat = format;
+    m_textureType = type;
+    m_frameBytes = 0;
+
+    const int pixelBytes = bytesPerPixel(format, type);
+    for (int i = 0; i < m_textureCount; ++i) {
+        m_textureIds[i] = textureIds[i];
+        m_textureWidths[i] = widths[i];
+        m_textureHeights[i] = heights[i];
+        m_textureOffsets[i] = offsets[i];
+
+        // Rows are read with the default unpack alignment of 4
+        const int bytesPerLine = (widths[i] * pixelBytes + 3) & ~3;
+        m_frameBytes = qMax(m_frameBytes, offsets[i] + bytesPerLine * heights[i]);
+    }
+
+    m_mode = qMin(maxMode, supportedMode());
+
+    if (m_mode == PixelBufferMode) {
+        QOpenGLFunctionsDef *funcs = getQOpenGLFunctions();
+        if (funcs) {
+            funcs->glGenBuffers(Pixel_Buffer_Count, m_pixelBuffers);
+            for (int i = 0; i < Pixel_Buffer_Count; ++i) {
+                funcs->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBuffers[i]);
+                funcs->glBufferData(GL_PIXEL_UNPACK_BUFFER, m_frameBytes, NULL, GL_STREAM_DRAW);
+            }
+            funcs->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        } else {
+            m_mode = TexSubImageMode;
+        }
+    }
+}
+
+void TextureUploader::cleanup()
+{
+    if (m_pixelBuffers[0]) {
+        QOpenGLFunctionsDef *funcs = getQOpenGLFunctions();
+        if (funcs)
+            funcs->glDeleteBuffers(Pixel_Buffer_Count, m_pixelBuffers);
+        memset(m_pixelBuffers, 0, sizeof(m_pixelBuffers));
+    }
+    m_textureCount = 0;
+    m_storageAllocated = false;
+    m_nextPixelBuffer = 0;
+}
+
+void TextureUploader::upload(const quint8 *data)
+{
+    QOpenGLFunctionsDef *funcs = getQOpenGLFunctions();
+    if (!funcs || !data)
+        return;
+
+    // With a pixel buffer bound the texture calls take offsets into the buffer instead of pointers
+    const quint8 *source = data;
+    if (m_mode == PixelBufferMode) {
+        funcs->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBuffers[m_nextPixelBuffer]);
+        // Orphan the previous storage so the copy does not wait for a transfer still reading from it
+        funcs->glBufferData(GL_PIXEL_UNPACK_BUFFER, m_frameBytes, NULL, GL_STREAM_DRAW);
+        funcs->glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, m_frameBytes, data);
+        m_nextPixelBuffer = (m_nextPixelBuffer + 1) % Pixel_Buffer_Count;
+        source = NULL;
+    }
+
+    for (int i = 0; i < m_textureCount; ++i) {
+        funcs->glBindTexture(GL_TEXTURE_2D, m_textureIds[i]);
+        if (m_mode == TexImageMode || !m_storageAllocated) {
+            funcs->glTexImage2D(
+                    GL_TEXTURE_2D,
+                    0,
+                    m_textureInternalFormat,
+                    m_textureWidths[i],
+                    m_textureHeights[i],
+                    0,
+                    m_textureFormat,
+                    m_textureType,
+                    source + m_textureOffsets[i]);
+            funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            funcs->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        } else {
+            funcs->glTexSubImage2D(
+                    GL_TEXTURE_2D,
+                    0,
+                    0,
+                    0,
+                    m_textureWidths[i],
+                    m_textureHeights[i],
+                    m_textureFormat,
+                    m_textureType,
+                    source + m_textureOffsets[i]);
+        }
+    }
+    m_storageAllocated = true;
+
+    if (m_mode == PixelBufferMode)
+        funcs->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
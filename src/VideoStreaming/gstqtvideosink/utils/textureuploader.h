@@ -0,0 +1,80 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief Uploads decoded video frames into the textures used by the video painters
+ */
+
+#ifndef TEXTUREUPLOADER_H
+#define TEXTUREUPLOADER_H
+
+#include <QtGlobal>
+#include <QOpenGLContext>
+
+/// Uploads the planes of a video frame into one texture per plane.
+///
+/// The texture storage is allocated on the first frame and the following frames only replace its contents with
+/// glTexSubImage2D. When the context supports pixel buffer objects the frame is first copied into one of two buffers
+/// used in turn, so the driver can transfer a frame to the texture while the next one is being written.
+/// All methods must be called with the GL context current.
+class TextureUploader
+{
+public:
+    enum Mode {
+        TexImageMode,       ///< Reallocate the texture storage with glTexImage2D for every frame
+        TexSubImageMode,    ///< Persistent texture storage updated with glTexSubImage2D
+        PixelBufferMode     ///< Persistent texture storage updated from double buffered pixel buffer objects
+    };
+
+    TextureUploader();
+
+    /// @return Fastest mode supported by the current context
+    static Mode supportedMode();
+
+    /// Sets up the upload of frames into the given textures
+    ///     @param maxMode Fastest mode to use, the mode used falls back to what the context supports
+    void init(int textureCount, const GLuint *textureIds,
+              const int *widths, const int *heights, const int *offsets,
+              GLuint internalFormat, GLenum format, GLenum type,
+              Mode maxMode = PixelBufferMode);
+
+    /// Frees the pixel buffer objects, the textures themselves belong to the caller
+    void cleanup();
+
+    /// Uploads all planes of the frame. Leaves the last plane texture bound on the active texture unit.
+    void upload(const quint8 *data);
+
+    Mode mode() const { return m_mode; }
+
+    /// @return Number of bytes read from the frame by upload
+    int frameBytes() const { return m_frameBytes; }
+
+private:
+    static const int Max_Textures = 3;
+    static const int Pixel_Buffer_Count = 2;
+
+    Mode m_mode;
+    int m_textureCount;
+    GLuint m_textureIds[Max_Textures];
+    int m_textureWidths[Max_Textures];
+    int m_textureHeights[Max_Textures];
+    int m_textureOffsets[Max_Textures];
+    GLuint m_textureInternalFormat;
+    GLenum m_textureFormat;
+    GLenum m_textureType;
+    int m_frameBytes;
+    bool m_storageAllocated;
+
+    GLuint m_pixelBuffers[Pixel_Buffer_Count];
+    int m_nextPixelBuffer;
+};
+
+#endif // TEXTUREUPLOADER_H
@@ -11,6 +11,7 @@
 #include "LogReplayLink.h"
 #include "LinkManager.h"
 #include "QGCApplication.h"
+#include "VideoSyncIndex.h"
 
 #include <QFileInfo>
 #include <QtEndian>
@@ -515,6 +516,189 @@ void LogReplayLink::movePlayhead(int percentComplete)
     }
 }
 
+void LogReplayLink::movePlayheadToOffset(qint64 offset)
+{
+    if (isPlaying()) {
+        qWarning() << "Should not move playhead while playing, pause first";
+        return;
+    }
+
+    if (offset < 0 || offset > _logFile.size()) {
+        qWarning() << "Bad log offset" << offset;
+        return;
+    }
+
+    if (_seekToOffset(_recordMessageOffset(offset))) {
+        _emitPlayheadPercent();
+    }
+}
+
+/// A log record is a timestamp followed by the message in a timestamped log. Scanning starts after the timestamp so
+/// its bytes can't be mistaken for the start of a message.
+/// @return Offset of the message in the record which starts at the specified offset
+qint64 LogReplayLink::_recordMessageOffset(qint64 recordOffset)
+{
+    return _logTimestamped ? qMin(recordOffset + cbTimestamp, _logFile.size()) : recordOffset;
+}
+
+void LogReplayLink::movePlayheadToTimestamp(quint64 timestampUSecs)
+{
+    if (isPlaying()) {
+        qWarning() << "Should not move playhead while playing, pause first";
+        return;
+    }
+
+    if (!_logTimestamped) {
+        qWarning() << "Log has no timestamps";
+        return;
+    }
+
+    // Messages are logged in time order, so binary search over the file offsets. Each probe aligns to the next
+    // MAVLink message to read its timestamp. The search stops once the range is down to about one message.
+    mavlink_message_t dummy;
+    qint64 low = 0;
+    qint64 high = _logFile.size();
+    while (high - low > MAVLINK_MAX_PACKET_LEN + cbTimestamp) {
+        qint64 mid = low + (high - low) / 2;
+        if (!_logFile.seek(mid)) {
+            _replayError("Unable to seek to new position");
+            return;
+        }
+        quint64 messageTimeUSecs = _seekToNextMavlinkMessage(&dummy);
+        if (messageTimeUSecs == 0 || messageTimeUSecs >= timestampUSecs) {
+            high = mid;
+        } else {
+            low = mid;
+        }
+    }
+
+    if (!_seekToOffset(low)) {
+        return;
+    }
+
+    // Step over the few messages left before the requested time
+    QByteArray bytes;
+    while (_logCurrentTimeUSecs < timestampUSecs && !_logFile.atEnd()) {
+        quint64 nextTimeUSecs = _readNextMavlinkMessage(bytes);
+        if (nextTimeUSecs == 0) {
+            break;
+        }
+        _logCurrentTimeUSecs = nextTimeUSecs;
+    }
+
+    _emitPlayheadPercent();
+}
+
+void LogReplayLink::movePlayheadToVideoFrame(const VideoSyncIndex& index, int entryIndex)
+{
+    if (isPlaying()) {
+        qWarning() << "Should not move playhead while playing, pause first";
+        return;
+    }
+
+    if (!_logTimestamped) {
+        qWarning() << "Log has no timestamps";
+        return;
+    }
+
+    if (entryIndex < 0 || entryIndex >= index.count()) {
+        qWarning() << "Bad video sync index entry" << entryIndex;
+        return;
+    }
+
+    // The index refers to the temporary log which was saved under a different name, and the log being replayed may
+    // not be that one at all. So the offset is only used if the message found there was logged along with the frame.
+    const VideoSyncIndex::Entry_t& entry = index.entry(entryIndex);
+    if (_videoFrameLogged(entry)) {
+        _emitPlayheadPercent();
+        return;
+    }
+
+    movePlayheadToTimestamp(entry.wallClockUSecs);
+}
+
+/// Checks whether the message at a frame's log offset was logged at the frame time, which means the offset refers to
+/// the log being replayed. If so the playhead is left at that message.
+bool LogReplayLink::_videoFrameLogged(const VideoSyncIndex::Entry_t& entry)
+{
+    if (entry.tlogOffset < 0 || entry.tlogOffset >= _logFile.size() || !_logFile.seek(_recordMessageOffset(entry.tlogOffset))) {
+        return false;
+    }
+    mavlink_message_t dummy;
+    quint64 messageTimeUSecs = _seekToNextMavlinkMessage(&dummy);
+    if (messageTimeUSecs == 0 || qAbs((qint64)(messageTimeUSecs - entry.wallClockUSecs)) > _videoSyncToleranceUSecs) {
+        return false;
+    }
+    _logCurrentTimeUSecs = messageTimeUSecs;
+    return true;
+}
+
+int LogReplayLink::videoFrameForPlayhead(const VideoSyncIndex& index)
+{
+    if (isPlaying() || !_logTimestamped || index.count() == 0) {
+        return -1;
+    }
+
+    // As with movePlayheadToVideoFrame the index may refer to another log, so a frame found through the offset must
+    // have been logged with this log. The playhead is put back afterwards.
+    qint64 offset = _logFile.pos();
+    quint64 currentTimeUSecs = _logCurrentTimeUSecs;
+    int offsetEntryIndex = -1;
+    for (int section=0; section<index.sectionCount() && offsetEntryIndex == -1; section++) {
+        int entryIndex = index.indexForTlogOffset(section, offset);
+        if (entryIndex == -1) {
+            continue;
+        }
+        const VideoSyncIndex::Entry_t& entry = index.entry(entryIndex);
+        if (qAbs((qint64)(entry.wallClockUSecs - currentTimeUSecs)) <= _videoSyncToleranceUSecs && _videoFrameLogged(entry)) {
+            offsetEntryIndex = entryIndex;
+        }
+    }
+    _logCurrentTimeUSecs = currentTimeUSecs;
+    if (!_logFile.seek(offset)) {
+        _replayError("Unable to seek to new position");
+        return -1;
+    }
+    if (offsetEntryIndex != -1) {
+        return offsetEntryIndex;
+    }
+
+    if (_logCurrentTimeUSecs < index.entry(0).wallClockUSecs || _logCurrentTimeUSecs > index.entry(index.count() - 1).wallClockUSecs) {
+        // Outside of the recording
+        return -1;
+    }
+    return index.indexForWallClock(_logCurrentTimeUSecs);
+}
+
+/// Seeks to the first MAVLink message at or after the specified offset and updates the current log time
+/// @return false: seek failed
+bool LogReplayLink::_seekToOffset(qint64 offset)
+{
+    if (!_logFile.seek(offset)) {
+        _replayError("Unable to seek to new position");
+        return false;
+    }
+
+    mavlink_message_t dummy;
+    quint64 messageTimeUSecs = _seekToNextMavlinkMessage(&dummy);
+    if (_logTimestamped && messageTimeUSecs != 0) {
+        _logCurrentTimeUSecs = messageTimeUSecs;
+    }
+
+    return true;
+}
+
+void LogReplayLink::_emitPlayheadPercent(void)
+{
+    int percentComplete;
+    if (_logTimestamped) {
+        percentComplete = ((float)(_logCurrentTimeUSecs - _logStartTimeUSecs) / (float)_logDurationUSecs) * 100;
+    } else {
+        percentComplete = ((float)_logFile.pos() / (float)_logFileSize) * 100;
+    }
+    emit playbackPercentCompleteChanged(percentComplete);
+}
+
 void LogReplayLink::_setAccelerationFactor(int factor)
 {
     // factor: -100: 0.01X, 0: 1.0X, 100: 100.0X
@@ -14,10 +14,12 @@
 #include "LinkInterface.h"
 #include "LinkConfiguration.h"
 #include "MAVLinkProtocol.h"
+#include "VideoSyncIndex.h"
 
 #include <QTimer>
 #include <QFile>
 
+
 class LogReplayLinkConfiguration : public LinkConfiguration
 {
     Q_OBJECT
@@ -68,6 +70,27 @@ public:
     /// Move the playhead to the specified percent complete
     void movePlayhead(int percentComplete);
 
+    /// Move the playhead to the log record starting at the given byte offset, such as a tlog offset from a
+    /// VideoSyncIndex. Offsets within a record move to the next record.
+    void movePlayheadToOffset(qint64 offset);
+
+    /// Move the playhead to the first message logged at or after the given time. Timestamped logs only.
+    ///     @param timestampUSecs UTC time in microseconds, such as the wall clock time from a VideoSyncIndex
+    void movePlayheadToTimestamp(quint64 timestampUSecs);
+
+    /// Move the playhead to the telemetry received along with a recorded video frame. The frame's log offset is used
+    /// when the message there was logged at the frame time, otherwise the frame time is searched for.
+    ///     @param index        Sync index of the recording
+    ///     @param entryIndex   Entry of the frame in the index
+    void movePlayheadToVideoFrame(const VideoSyncIndex& index, int entryIndex);
+
+    /// Finds the recorded video frame which goes along with the telemetry at the playhead. The log offset is looked up
+    /// in each section of the index and used when the frame found there was logged along with this log at the playhead
+    /// time, otherwise the playhead time is searched for. Timestamped logs only, replay must be paused.
+    ///     @param index Sync index of the recording
+    /// @return Entry of the frame in the index, -1 if there is none
+    int videoFrameForPlayhead(const VideoSyncIndex& index);
+
     /// Sets the acceleration factor: -100: 0.01X, 0: 1.0X, 100: 100.0X
     void setAccelerationFactor(int factor) { emit _setAccelerationFactorOnThread(factor); }
 
@@ -119,6 +142,10 @@ private:
     void _finishPlayback(void);
     void _playbackError(void);
     void _resetPlaybackToBeginning(void);
+    bool _seekToOffset(qint64 offset);
+    qint64 _recordMessageOffset(qint64 recordOffset);
+    bool _videoFrameLogged(const VideoSyncIndex::Entry_t& entry);
+    void _emitPlayheadPercent(void);
 
     // Virtuals from LinkInterface
     virtual bool _connect(void);
@@ -152,6 +179,7 @@ private:
     bool                _logTimestamped;    ///< true: Timestamped log format, false: no timestamps
 
     static const int cbTimestamp = sizeof(quint64);
+    static const qint64 _videoSyncToleranceUSecs = 2000000;    ///< Maximum difference between frame and message time for an offset to be trusted
 };
 
 #endif
@@ -61,6 +61,7 @@ MAVLinkProtocol::MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox)
     , _logSuspendReplay(false)
     , _vehicleWasArmed(false)
     , _tempLogFile(QString("%2.%3").arg(_tempLogFileTemplate).arg(_logFileExtension))
+    , _logPosition(-1)
     , _linkMgr(NULL)
     , _multiVehicleManager(NULL)
 {
@@ -254,6 +255,8 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
                     emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
                     _stopLogging();
                     _logSuspendError = true;
+                } else {
+                    _setLogPosition(_tempLogFile.pos());
                 }
 
                 // Check for the vehicle arming going by. This is used to trigger log save.
@@ -391,6 +394,7 @@ void MAVLinkProtocol::_vehicleCountChanged(void)
 /// @brief Closes the log file if it is open
 bool MAVLinkProtocol::_closeLogFile(void)
 {
+    _setLogFile(QString());
     if (_tempLogFile.isOpen()) {
         if (_tempLogFile.size() == 0) {
             // Don't save zero byte files
@@ -430,6 +434,7 @@ void MAVLinkProtocol::_startLogging(void)
             }
 
             qDebug() << "Temp log" << _tempLogFile.fileName();
+            _setLogFile(QFileInfo(_tempLogFile.fileName()).fileName());
             emit checkTelemetrySavePath();
 
             _logSuspendError = false;
@@ -479,6 +484,27 @@ void MAVLinkProtocol::suspendLogForReplay(bool suspend)
     _logSuspendReplay = suspend;
 }
 
+qint64 MAVLinkProtocol::logPosition(QString& logFileName)
+{
+    QMutexLocker locker(&_logPositionMutex);
+    logFileName = _logPositionFileName;
+    return _logPosition;
+}
+
+void MAVLinkProtocol::_setLogPosition(qint64 logPosition)
+{
+    QMutexLocker locker(&_logPositionMutex);
+    _logPosition = logPosition;
+}
+
+/// Sets the log which positions refer to, the position is reset to the start of the log. Empty to stop.
+void MAVLinkProtocol::_setLogFile(const QString& logFileName)
+{
+    QMutexLocker locker(&_logPositionMutex);
+    _logPositionFileName = logFileName;
+    _logPosition = logFileName.isEmpty() ? -1 : 0;
+}
+
 void MAVLinkProtocol::deleteTempLogFiles(void)
 {
     QDir tempDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation));
@@ -94,6 +94,12 @@ public:
     /// Suspend/Restart logging during replay.
     void suspendLogForReplay(bool suspend);
 
+    /// Position at which the next message will be written to the telemetry log, used to synchronize video recordings
+    /// with the log. Can be called from any thread.
+    ///     @param logFileName[out] Name of the temporary log the position refers to, a new log is started on each arm
+    /// @return Byte offset in the log, -1 if not logging
+    qint64 logPosition(QString& logFileName);
+
     /// Set protocol version
     void setVersion(unsigned version);
 
@@ -178,6 +184,8 @@ private:
     bool _closeLogFile(void);
     void _startLogging(void);
     void _stopLogging(void);
+    void _setLogPosition(qint64 logPosition);
+    void _setLogFile(const QString& logFileName);
 
     bool _logSuspendError;      ///< true: Logging suspended due to error
     bool _logSuspendReplay;     ///< true: Logging suspended due to replay
@@ -186,6 +194,9 @@ private:
     QGCTemporaryFile    _tempLogFile;            ///< File to log to
     static const char*  _tempLogFileTemplate;    ///< Template for temporary log file
     static const char*  _logFileExtension;       ///< Extension for log files
+    QMutex              _logPositionMutex;
+    qint64              _logPosition;
+    QString             _logPositionFileName;
 
     LinkManager*            _linkMgr;
     MultiVehicleManager*    _multiVehicleManager;
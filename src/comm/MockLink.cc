@@ -11,6 +11,7 @@
 #include "MockLink.h"
 #include "QGCLoggingCategory.h"
 #include "QGCApplication.h"
+#include "QGC.h"
 
 #ifdef UNITTEST_BUILD
     #include "UnitTest.h"
@@ -19,6 +20,7 @@
 #include <QTimer>
 #include <QDebug>
 #include <QFile>
+#include <QtMath>
 
 #include <string.h>
 
@@ -39,12 +41,19 @@ double      MockLink::_defaultVehicleLatitude =     47.397f;
 double      MockLink::_defaultVehicleLongitude =    8.5455f;
 double      MockLink::_defaultVehicleAltitude =     488.056f;
 int         MockLink::_nextVehicleSystemId =        128;
+int         MockLink::_nextFleetVehicleSystemId =   1;
 const char* MockLink::_failParam =                  "COM_FLTMODE6";
+const char* MockLink::_rangeHashParamPrefix =       "_HR:";
+const char* MockLink::_rangeHashSupportParamName =  "_HR:SUPPORT";
 
 const char* MockConfiguration::_firmwareTypeKey =   "FirmwareType";
 const char* MockConfiguration::_vehicleTypeKey =    "VehicleType";
 const char* MockConfiguration::_sendStatusTextKey = "SendStatusText";
 const char* MockConfiguration::_failureModeKey =    "FailureMode";
+const char* MockConfiguration::_fleetVehicleCountKey = "FleetVehicleCount";
+const char* MockConfiguration::_streamRateKey =     "StreamRate";
+const char* MockConfiguration::_packetLossPercentKey = "PacketLossPercent";
+const char* MockConfiguration::_jitterMSecsKey =    "JitterMSecs";
 
 MockLink::MockLink(SharedLinkConfigurationPointer& config)
     : LinkInterface                         (config)
@@ -71,15 +80,45 @@ MockLink::MockLink(SharedLinkConfigurationPointer& config)
     , _sendGPSPositionDelayCount            (100)   // No gps lock for 5 seconds
     , _currentParamRequestListComponentIndex(-1)
     , _currentParamRequestListParamIndex    (-1)
+    , _paramRequestListSendHash             (false)
+    , _paramValueSentCount                  (0)
+    , _rangeHashSupported                   (true)
+    , _rangeHashRequestCount                (0)
+    , _rangeHashDropCount                   (0)
+    , _logDownloadFileSize                  (_defaultLogDownloadFileSize)
     , _logDownloadCurrentOffset             (0)
     , _logDownloadBytesRemaining            (0)
+    , _logDownloadBytesSent                 (0)
     , _adsbAngle                            (0)
+    , _fleetTick                            (0)
+    , _streamRate                           (0)
+    , _streamRateAccumulator                (0)
+    , _packetLossPercent                    (0)
+    , _jitterMSecs                          (0)
+    , _lastDelayedSendMSecs                 (0)
 {
     MockConfiguration* mockConfig = qobject_cast<MockConfiguration*>(_config.data());
     _firmwareType = mockConfig->firmwareType();
     _vehicleType = mockConfig->vehicleType();
     _sendStatusText = mockConfig->sendStatusText();
     _failureMode = mockConfig->failureMode();
+    _streamRate = mockConfig->streamRate();
+    _packetLossPercent = mockConfig->packetLossPercent();
+    _jitterMSecs = mockConfig->jitterMSecs();
+    _jitterTimer.start();
+
+    // Fleet vehicles use ids 1-127 so they never collide with the main vehicles which start at 128
+    for (int i=0; i<mockConfig->fleetVehicleCount(); i++) {
+        FleetVehicle_t fleetVehicle;
+
+        fleetVehicle.systemId = _nextFleetVehicleSystemId;
+        fleetVehicle.center = QGeoCoordinate(_vehicleLatitude, _vehicleLongitude, _vehicleAltitude).atDistanceAndAzimuth(100 + (i * 10), i * 37);
+        fleetVehicle.angle = 0;
+        fleetVehicle.streamIntervalTicks = _fleetDefaultStreamIntervalTicks();
+        _fleetVehicles.append(fleetVehicle);
+
+        _nextFleetVehicleSystemId = (_nextFleetVehicleSystemId % 127) + 1;
+    }
 
     union px4_custom_mode   px4_cm;
 
@@ -187,6 +226,7 @@ void MockLink::_run10HzTasks(void)
 {
     if (_mavlinkStarted && _connected) {
         _sendHeartBeat();
+        _runFleetVehicles();
         if (_sendGPSPositionDelayCount > 0) {
             // We delay gps position for better testing
             _sendGPSPositionDelayCount--;
@@ -201,6 +241,9 @@ void MockLink::_run500HzTasks(void)
     if (_mavlinkStarted && _connected) {
         _paramRequestListWorker();
         _logDownloadWorker();
+        _sendLoadStreams();
+        _sendDelayedBytes();
+        _fileServer->sendDelayedResponses();
     }
 }
 
@@ -317,11 +360,104 @@ void MockLink::respondWithMavlinkMessage(const mavlink_message_t& msg)
 {
     uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
 
+    if (msg.msgid == MAVLINK_MSG_ID_PARAM_VALUE) {
+        _paramValueSentCount++;
+    }
+
+    if (_packetLossPercent > 0 && (qrand() % 100) < _packetLossPercent) {
+        return;
+    }
+
     int cBuffer = mavlink_msg_to_send_buffer(buffer, &msg);
     QByteArray bytes((char *)buffer, cBuffer);
+
+    if (_jitterMSecs > 0) {
+        QMutexLocker lock(&_delayedBytesMutex);
+
+        DelayedBytes_t delayedBytes;
+        delayedBytes.sendMSecs = qMax(_jitterTimer.elapsed() + (qrand() % (_jitterMSecs + 1)), _lastDelayedSendMSecs);
+        delayedBytes.bytes = bytes;
+        _delayedBytes.append(delayedBytes);
+        _lastDelayedSendMSecs = delayedBytes.sendMSecs;
+        return;
+    }
+
     emit bytesReceived(this, bytes);
 }
 
+/// Sends the messages held back for jitter simulation whose time has come
+void MockLink::_sendDelayedBytes(void)
+{
+    QList<QByteArray> sendList;
+
+    {
+        QMutexLocker lock(&_delayedBytesMutex);
+
+        qint64 nowMSecs = _jitterTimer.elapsed();
+        while (!_delayedBytes.isEmpty() && _delayedBytes.first().sendMSecs <= nowMSecs) {
+            sendList.append(_delayedBytes.takeFirst().bytes);
+        }
+    }
+
+    foreach (const QByteArray& bytes, sendList) {
+        emit bytesReceived(this, bytes);
+    }
+}
+
+/// Sends the high rate telemetry used for load testing at the configured stream rate
+void MockLink::_sendLoadStreams(void)
+{
+    if (_streamRate == 0) {
+        return;
+    }
+
+    _streamRateAccumulator += _streamRate;
+    if (_streamRateAccumulator < 500) {
+        return;
+    }
+    _streamRateAccumulator -= 500;
+
+    mavlink_message_t   msg;
+    uint32_t            timeBootMSecs = (uint32_t)_jitterTimer.elapsed();
+    float               angle = timeBootMSecs / 1000.0f;
+
+    mavlink_msg_attitude_pack_chan(_vehicleSystemId,
+                                   _vehicleComponentId,
+                                   _mavlinkChannel,
+                                   &msg,
+                                   timeBootMSecs,
+                                   qSin(angle) * 0.2f,      // roll
+                                   qCos(angle) * 0.2f,      // pitch
+                                   (float)(fmod(angle, 2 * M_PI) - M_PI),   // yaw
+                                   0, 0, 0);                // rollspeed, pitchspeed, yawspeed
+    respondWithMavlinkMessage(msg);
+
+    mavlink_msg_global_position_int_pack_chan(_vehicleSystemId,
+                                              _vehicleComponentId,
+                                              _mavlinkChannel,
+                                              &msg,
+                                              timeBootMSecs,
+                                              (int32_t)(_vehicleLatitude * 1E7),
+                                              (int32_t)(_vehicleLongitude * 1E7),
+                                              (int32_t)(_vehicleAltitude * 1000),
+                                              0,                                    // relative_alt
+                                              0, 0, 0,                              // vx, vy, vz
+                                              UINT16_MAX);                          // hdg
+    respondWithMavlinkMessage(msg);
+
+    mavlink_msg_vfr_hud_pack_chan(_vehicleSystemId,
+                                  _vehicleComponentId,
+                                  _mavlinkChannel,
+                                  &msg,
+                                  0,                            // airspeed
+                                  0,                            // groundspeed
+                                  0,                            // heading
+                                  0,                            // throttle
+                                  (float)_vehicleAltitude,      // alt
+                                  0);                           // climb
+    respondWithMavlinkMessage(msg);
+}
+
 /// @brief Called when QGC wants to write bytes to the MAV
 void MockLink::_writeBytes(const QByteArray bytes)
 {
@@ -373,6 +509,10 @@ void MockLink::_handleIncomingMavlinkBytes(const uint8_t* bytes, int cBytes)
             continue;
         }
 
+        if (_handleFleetVehicleMessage(msg)) {
+            continue;
+        }
+
         if (_missionItemHandler.handleMessage(msg)) {
             continue;
         }
@@ -592,9 +732,76 @@ void MockLink::_handleParamRequestList(const mavlink_message_t& msg)
     Q_ASSERT(request.target_system == _vehicleSystemId);
     Q_ASSERT(request.target_component == MAV_COMP_ID_ALL);
 
-    // Start the worker routine
+    // Start the worker routine. PX4 leads with the hash of all parameters so QGC can load from its cache.
     _currentParamRequestListComponentIndex = 0;
     _currentParamRequestListParamIndex = 0;
+    _paramRequestListSendHash = _firmwareType == MAV_AUTOPILOT_PX4;
+}
+
+/// Computes the PX4 _HASH_CHECK value over a range of parameter indices: CRC32 of each name followed by the
+/// significant bytes of its value.
+uint32_t MockLink::_paramHash(int componentId, int startIndex, int count)
+{
+    uint32_t crc32Value = 0;
+
+    QStringList paramNames = _mapParamName2Value[componentId].keys();
+    for (int index=startIndex; index<paramNames.count() && index-startIndex<count; index++) {
+        const QString& paramName = paramNames[index];
+
+        mavlink_param_union_t valueUnion;
+        valueUnion.param_float = _floatUnionForParam(componentId, paramName);
+
+        unsigned valueSize;
+        switch (_mapParamName2MavParamType[paramName]) {
+        case MAV_PARAM_TYPE_UINT8:
+        case MAV_PARAM_TYPE_INT8:
+            valueSize = 1;
+            break;
+        case MAV_PARAM_TYPE_UINT16:
+        case MAV_PARAM_TYPE_INT16:
+            valueSize = 2;
+            break;
+        default:
+            valueSize = 4;
+            break;
+        }
+
+        crc32Value = QGC::crc32((const uint8_t*)qPrintable(paramName), paramName.length(), crc32Value);
+        crc32Value = QGC::crc32(valueUnion.bytes, valueSize, crc32Value);
+    }
+
+    return crc32Value;
+}
+
+void MockLink::_sendParamHash(int componentId, const char* paramName, int paramIndex, uint32_t hash)
+{
+    char                    paramId[MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN + 1];
+    mavlink_message_t       responseMsg;
+    mavlink_param_union_t   valueUnion;
+
+    // Param name may not be null terminated if exactly fits
+    paramId[MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN] = 0;
+    strncpy(paramId, paramName, MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN);
+
+    valueUnion.param_uint32 = hash;
+    mavlink_msg_param_value_pack_chan(_vehicleSystemId,
+                                      componentId,
+                                      _mavlinkChannel,
+                                      &responseMsg,
+                                      paramId,
+                                      valueUnion.param_float,
+                                      MAV_PARAM_TYPE_UINT32,
+                                      _mapParamName2Value[componentId].count(),
+                                      paramIndex);
+    respondWithMavlinkMessage(responseMsg);
+}
+
+void MockLink::setParamValue(int componentId, const QString& paramName, const QVariant& value)
+{
+    Q_ASSERT(_mapParamName2Value.contains(componentId));
+    Q_ASSERT(_mapParamName2Value[componentId].contains(paramName));
+
+    _mapParamName2Value[componentId][paramName] = value;
 }
 
 /// Sends the next parameter to the vehicle
@@ -605,6 +812,15 @@ void MockLink::_paramRequestListWorker(void)
         return;
     }
 
+    if (_paramRequestListSendHash) {
+        _paramRequestListSendHash = false;
+        if (_rangeHashSupported) {
+            _sendParamHash(_vehicleComponentId, _rangeHashSupportParamName, -1, 1);
+        }
+        _sendParamHash(_vehicleComponentId, "_HASH_CHECK", -1, _paramHash(_vehicleComponentId, 0, _mapParamName2Value[_vehicleComponentId].count()));
+        return;
+    }
+
     int componentId = _mapParamName2Value.keys()[_currentParamRequestListComponentIndex];
     int cParameters = _mapParamName2Value[componentId].count();
     QString paramName = _mapParamName2Value[componentId].keys()[_currentParamRequestListParamIndex];
@@ -665,6 +881,17 @@ void MockLink::_handleParamSet(const mavlink_message_t& msg)
 
     qCDebug(MockLinkLog) << "_handleParamSet" << componentId << paramId << request.param_type;
 
+    if (strcmp(paramId, "_HASH_CHECK") == 0) {
+        mavlink_param_union_t valueUnion;
+        valueUnion.param_float = request.param_value;
+        if (valueUnion.param_uint32 == _paramHash(componentId, 0, _mapParamName2Value[componentId].count())) {
+            // QGC has all our parameters, stop streaming them
+            qCDebug(MockLinkLog) << "_HASH_CHECK matched, stopping param request list";
+            _currentParamRequestListComponentIndex = -1;
+        }
+        return;
+    }
+
     Q_ASSERT(_mapParamName2Value.contains(componentId));
     Q_ASSERT(_mapParamName2Value[componentId].contains(paramId));
     Q_ASSERT(request.param_type == _mapParamName2MavParamType[paramId]);
@@ -716,6 +943,20 @@ void MockLink::_handleParamRequestRead(const mavlink_message_t& msg)
 
     Q_ASSERT(_mapParamName2Value.contains(componentId));
 
+    if (_firmwareType == MAV_AUTOPILOT_PX4 && _rangeHashSupported && paramName.startsWith(_rangeHashParamPrefix)) {
+        _rangeHashRequestCount++;
+        if (_rangeHashDropCount > 0) {
+            _rangeHashDropCount--;
+            return;
+        }
+        QStringList range = paramName.mid(strlen(_rangeHashParamPrefix)).split(':');
+        if (range.count() == 2) {
+            int startIndex = range[0].toInt();
+            _sendParamHash(componentId, request.param_id, startIndex, _paramHash(componentId, startIndex, range[1].toInt()));
+        }
+        return;
+    }
+
     char paramId[MAVLINK_MSG_PARAM_REQUEST_READ_FIELD_PARAM_ID_LEN + 1];
     paramId[0] = 0;
 
@@ -999,6 +1240,10 @@ MockConfiguration::MockConfiguration(const QString& name)
     , _vehicleType(MAV_TYPE_QUADROTOR)
     , _sendStatusText(false)
     , _failureMode(FailNone)
+    , _fleetVehicleCount(0)
+    , _streamRate(0)
+    , _packetLossPercent(0)
+    , _jitterMSecs(0)
 {
 
 }
@@ -1010,6 +1255,10 @@ MockConfiguration::MockConfiguration(MockConfiguration* source)
     _vehicleType =      source->_vehicleType;
     _sendStatusText =   source->_sendStatusText;
     _failureMode =      source->_failureMode;
+    _fleetVehicleCount = source->_fleetVehicleCount;
+    _streamRate =       source->_streamRate;
+    _packetLossPercent = source->_packetLossPercent;
+    _jitterMSecs =      source->_jitterMSecs;
 }
 
 void MockConfiguration::copyFrom(LinkConfiguration *source)
@@ -1026,6 +1275,10 @@ void MockConfiguration::copyFrom(LinkConfiguration *source)
     _vehicleType =      usource->_vehicleType;
     _sendStatusText =   usource->_sendStatusText;
     _failureMode =      usource->_failureMode;
+    _fleetVehicleCount = usource->_fleetVehicleCount;
+    _streamRate =       usource->_streamRate;
+    _packetLossPercent = usource->_packetLossPercent;
+    _jitterMSecs =      usource->_jitterMSecs;
 }
 
 void MockConfiguration::saveSettings(QSettings& settings, const QString& root)
@@ -1035,6 +1288,10 @@ void MockConfiguration::saveSettings(QSettings& settings, const QString& root)
     settings.setValue(_vehicleTypeKey, (int)_vehicleType);
     settings.setValue(_sendStatusTextKey, _sendStatusText);
     settings.setValue(_failureModeKey, (int)_failureMode);
+    settings.setValue(_fleetVehicleCountKey, _fleetVehicleCount);
+    settings.setValue(_streamRateKey, _streamRate);
+    settings.setValue(_packetLossPercentKey, _packetLossPercent);
+    settings.setValue(_jitterMSecsKey, _jitterMSecs);
     settings.sync();
     settings.endGroup();
 }
@@ -1046,6 +1303,10 @@ void MockConfiguration::loadSettings(QSettings& settings, const QString& root)
     _vehicleType = (MAV_TYPE)settings.value(_vehicleTypeKey, (int)MAV_TYPE_QUADROTOR).toInt();
     _sendStatusText = settings.value(_sendStatusTextKey, false).toBool();
     _failureMode = (FailureMode_t)settings.value(_failureModeKey, (int)FailNone).toInt();
+    _fleetVehicleCount = settings.value(_fleetVehicleCountKey, 0).toInt();
+    _streamRate = settings.value(_streamRateKey, 0).toInt();
+    _packetLossPercent = settings.value(_packetLossPercentKey, 0).toInt();
+    _jitterMSecs = settings.value(_jitterMSecsKey, 0).toInt();
     settings.endGroup();
 }
 
@@ -1083,6 +1344,18 @@ MockLink*  MockLink::startPX4MockLink(bool sendStatusText, MockConfiguration::Fa
     return _startMockLink(mockConfig);
 }
 
+MockLink*  MockLink::startPX4FleetMockLink(int fleetVehicleCount)
+{
+    MockConfiguration* mockConfig = new MockConfiguration("PX4 Fleet MockLink");
+
+    mockConfig->setFirmwareType(MAV_AUTOPILOT_PX4);
+    mockConfig->setVehicleType(MAV_TYPE_QUADROTOR);
+    mockConfig->setSendStatusText(false);
+    mockConfig->setFleetVehicleCount(fleetVehicleCount);
+
+    return _startMockLink(mockConfig);
+}
+
 MockLink*  MockLink::startGenericMockLink(bool sendStatusText, MockConfiguration::FailureMode_t failureMode)
 {
     MockConfiguration* mockConfig = new MockConfiguration("Generic MockLink");
@@ -1251,7 +1524,7 @@ void MockLink::_logDownloadWorker(void)
             Q_ASSERT(file.seek(_logDownloadCurrentOffset));
             Q_ASSERT(file.read((char *)buffer, bytesToRead) == bytesToRead);
 
-            qDebug() << "MockLink::_logDownloadWorker" << _logDownloadCurrentOffset << _logDownloadBytesRemaining;
+            qCDebug(MockLinkVerboseLog) << "MockLink::_logDownloadWorker" << _logDownloadCurrentOffset << _logDownloadBytesRemaining;
 
             mavlink_message_t responseMsg;
             mavlink_msg_log_data_pack_chan(_vehicleSystemId,
@@ -1266,6 +1539,7 @@ void MockLink::_logDownloadWorker(void)
 
             _logDownloadCurrentOffset += bytesToRead;
             _logDownloadBytesRemaining -= bytesToRead;
+            _logDownloadBytesSent += bytesToRead;
 
             file.close();
         } else {
@@ -1300,3 +1574,180 @@ void MockLink::_sendADSBVehicles(void)
 
     respondWithMavlinkMessage(responseMsg);
 }
+
+/// Stream rates a fleet vehicle starts out with, in ticks of the 10Hz task
+const QMap<uint32_t, int>& MockLink::_fleetDefaultStreamIntervalTicks(void)
+{
+    static QMap<uint32_t, int> intervalTicks;
+
+    if (intervalTicks.isEmpty()) {
+        intervalTicks[MAVLINK_MSG_ID_HEARTBEAT] =           _fleetTicksPerSecond;
+        intervalTicks[MAVLINK_MSG_ID_SYS_STATUS] =          _fleetTicksPerSecond;
+        intervalTicks[MAVLINK_MSG_ID_GLOBAL_POSITION_INT] = 2;
+        intervalTicks[MAVLINK_MSG_ID_VFR_HUD] =             2;
+        intervalTicks[MAVLINK_MSG_ID_ATTITUDE] =            1;
+    }
+
+    return intervalTicks;
+}
+
+QList<int> MockLink::fleetVehicleIds(void) const
+{
+    QList<int> ids;
+
+    foreach (const FleetVehicle_t& fleetVehicle, _fleetVehicles) {
+        ids.append(fleetVehicle.systemId);
+    }
+
+    return ids;
+}
+
+int MockLink::fleetVehicleMessageIntervalMSecs(int vehicleId, uint32_t msgid) const
+{
+    foreach (const FleetVehicle_t& fleetVehicle, _fleetVehicles) {
+        if (fleetVehicle.systemId == vehicleId) {
+            return fleetVehicle.streamIntervalTicks.value(msgid, 0) * (1000 / _fleetTicksPerSecond);
+        }
+    }
+
+    return 0;
+}
+
+/// Handles messages targeted at one of the fleet vehicles
+///     @return true: message was for a fleet vehicle
+bool MockLink::_handleFleetVehicleMessage(const mavlink_message_t& msg)
+{
+    if (_fleetVehicles.isEmpty()) {
+        return false;
+    }
+
+    const mavlink_msg_entry_t* msgEntry = mavlink_get_msg_entry(msg.msgid);
+    if (!msgEntry || !(msgEntry->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_SYSTEM)) {
+        return false;
+    }
+    uint8_t targetSystem = _MAV_PAYLOAD(&msg)[msgEntry->target_system_ofs];
+
+    for (int i=0; i<_fleetVehicles.count(); i++) {
+        FleetVehicle_t& fleetVehicle = _fleetVehicles[i];
+
+        if (fleetVehicle.systemId != targetSystem) {
+            continue;
+        }
+
+        if (msg.msgid == MAVLINK_MSG_ID_COMMAND_LONG) {
+            mavlink_command_long_t request;
+            uint8_t commandResult = MAV_RESULT_UNSUPPORTED;
+
+            mavlink_msg_command_long_decode(&msg, &request);
+
+            if (request.command == MAV_CMD_SET_MESSAGE_INTERVAL) {
+                uint32_t msgid = (uint32_t)request.param1;
+                if (fleetVehicle.streamIntervalTicks.contains(msgid)) {
+                    if (request.param2 < 0) {
+                        fleetVehicle.streamIntervalTicks[msgid] = 0;
+                    } else if (request.param2 == 0) {
+                        fleetVehicle.streamIntervalTicks[msgid] = _fleetDefaultStreamIntervalTicks()[msgid];
+                    } else {
+                        fleetVehicle.streamIntervalTicks[msgid] = qMax(1, qRound(request.param2 / (1000000.0 / _fleetTicksPerSecond)));
+                    }
+                    commandResult = MAV_RESULT_ACCEPTED;
+                }
+            }
+
+            mavlink_message_t commandAck;
+            mavlink_msg_command_ack_pack_chan(fleetVehicle.systemId,
+                                              _vehicleComponentId,
+                                              _mavlinkChannel,
+                                              &commandAck,
+                                              request.command,
+                                              commandResult);
+            respondWithMavlinkMessage(commandAck);
+        }
+
+        // Everything else is ignored
+        return true;
+    }
+
+    return false;
+}
+
+/// Sends the telemetry of all fleet vehicles. Each fleet vehicle flies a small circle around its own center.
+void MockLink::_runFleetVehicles(void)
+{
+    _fleetTick++;
+
+    uint32_t timeBootMSecs = _fleetTick * (1000 / _fleetTicksPerSecond);
+
+    for (int i=0; i<_fleetVehicles.count(); i++) {
+        FleetVehicle_t& fleetVehicle = _fleetVehicles[i];
+
+        fleetVehicle.angle += 2.0;
+        if (fleetVehicle.angle >= 360.0) {
+            fleetVehicle.angle -= 360.0;
+        }
+        QGeoCoordinate  coord = fleetVehicle.center.atDistanceAndAzimuth(20, fleetVehicle.angle);
+        double          heading = fmod(fleetVehicle.angle + 90.0, 360.0);
+
+        for (QMap<uint32_t, int>::const_iterator iter=fleetVehicle.streamIntervalTicks.constBegin(); iter!=fleetVehicle.streamIntervalTicks.constEnd(); iter++) {
+            int intervalTicks = iter.value();
+
+            // Offset each vehicle by its index so the fleet doesn't send all of its messages in the same tick
+            if (intervalTicks == 0 || ((_fleetTick + i) % intervalTicks) != 0) {
+                continue;
+            }
+
+            mavlink_message_t msg;
+
+            switch (iter.key()) {
+            case MAVLINK_MSG_ID_HEARTBEAT:
+                mavlink_msg_heartbeat_pack_chan(fleetVehicle.systemId, _vehicleComponentId, _mavlinkChannel, &msg,
+                                                _vehicleType,
+                                                _firmwareType,
+                                                _mavBaseMode,
+                                                _mavCustomMode,
+                                                MAV_STATE_ACTIVE);
+                break;
+            case MAVLINK_MSG_ID_SYS_STATUS:
+                mavlink_msg_sys_status_pack_chan(fleetVehicle.systemId, _vehicleComponentId, _mavlinkChannel, &msg,
+                                                 0, 0, 0,       // sensors present, enabled, health
+                                                 500,           // load
+                                                 15800,         // voltage_battery
+                                                 1200,          // current_battery
+                                                 75,            // battery_remaining
+                                                 0, 0, 0, 0, 0, 0);
+                break;
+            case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+                mavlink_msg_global_position_int_pack_chan(fleetVehicle.systemId, _vehicleComponentId, _mavlinkChannel, &msg,
+                                                          timeBootMSecs,
+                                                          (int32_t)(coord.latitude() * 1E7),
+                                                          (int32_t)(coord.longitude() * 1E7),
+                                                          (int32_t)((_vehicleAltitude + 20) * 1000),
+                                                          20 * 1000,                        // relative_alt
+                                                          0, 0, 0,                          // vx, vy, vz
+                                                          (uint16_t)(heading * 100));
+                break;
+            case MAVLINK_MSG_ID_VFR_HUD:
+                mavlink_msg_vfr_hud_pack_chan(fleetVehicle.systemId, _vehicleComponentId, _mavlinkChannel, &msg,
+                                              5.0f,                 // airspeed
+                                              5.0f,                 // groundspeed
+                                              (int16_t)heading,
+                                              50,                   // throttle
+                                              _vehicleAltitude + 20,
+                                              0.0f);                // climb
+                break;
+            case MAVLINK_MSG_ID_ATTITUDE:
+                mavlink_msg_attitude_pack_chan(fleetVehicle.systemId, _vehicleComponentId, _mavlinkChannel, &msg,
+                                               timeBootMSecs,
+                                               0.1f,                                // roll
+                                               0.0f,                                // pitch
+                                               qDegreesToRadians(heading > 180.0 ? heading - 360.0 : heading),
+                                               0.0f, 0.0f, 0.0f);                   // rates
+                break;
+            default:
+                continue;
+            }
+
+            respondWithMavlinkMessage(msg);
+        }
+    }
+}
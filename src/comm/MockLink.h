@@ -14,6 +14,8 @@
 #include <QMap>
 #include <QLoggingCategory>
 #include <QGeoCoordinate>
+#include <QElapsedTimer>
+#include <QMutex>
 
 #include "MockLinkMissionItemHandler.h"
 #include "MockLinkFileServer.h"
@@ -32,6 +34,10 @@ public:
     Q_PROPERTY(int      firmware    READ firmware           WRITE setFirmware       NOTIFY firmwareChanged)
     Q_PROPERTY(int      vehicle     READ vehicle            WRITE setVehicle        NOTIFY vehicleChanged)
     Q_PROPERTY(bool     sendStatus  READ sendStatusText     WRITE setSendStatusText NOTIFY sendStatusChanged)
+    Q_PROPERTY(int      fleetVehicleCount READ fleetVehicleCount WRITE setFleetVehicleCount NOTIFY fleetVehicleCountChanged)
+    Q_PROPERTY(int      streamRate  READ streamRate         WRITE setStreamRate     NOTIFY streamRateChanged)
+    Q_PROPERTY(int      packetLossPercent READ packetLossPercent WRITE setPacketLossPercent NOTIFY packetLossPercentChanged)
+    Q_PROPERTY(int      jitterMSecs READ jitterMSecs        WRITE setJitterMSecs    NOTIFY jitterMSecsChanged)
 
     // QML Access
     int     firmware        () { return (int)_firmwareType; }
@@ -52,6 +58,22 @@ public:
     bool sendStatusText(void) { return _sendStatusText; }
     void setSendStatusText(bool sendStatusText) { _sendStatusText = sendStatusText; emit sendStatusChanged(); }
 
+    /// @param fleetVehicleCount Number of additional telemetry only vehicles simulated on the same link
+    int fleetVehicleCount(void) { return _fleetVehicleCount; }
+    void setFleetVehicleCount(int fleetVehicleCount) { _fleetVehicleCount = fleetVehicleCount; emit fleetVehicleCountChanged(); }
+
+    /// @param streamRate Rate in Hz at which ATTITUDE, GLOBAL_POSITION_INT and VFR_HUD are sent for load testing, 0 for off, max 500
+    int streamRate(void) { return _streamRate; }
+    void setStreamRate(int streamRate) { _streamRate = qBound(0, streamRate, 500); emit streamRateChanged(); }
+
+    /// @param packetLossPercent Percentage of messages to QGC which are randomly dropped
+    int packetLossPercent(void) { return _packetLossPercent; }
+    void setPacketLossPercent(int packetLossPercent) { _packetLossPercent = qBound(0, packetLossPercent, 100); emit packetLossPercentChanged(); }
+
+    /// @param jitterMSecs Messages to QGC are delayed by a random amount up to this many msecs, message order is kept
+    int jitterMSecs(void) { return _jitterMSecs; }
+    void setJitterMSecs(int jitterMSecs) { _jitterMSecs = qMax(0, jitterMSecs); emit jitterMSecsChanged(); }
+
     typedef enum {
         FailNone,                           // No failures
         FailParamNoReponseToRequestList,    // Do no respond to PARAM_REQUEST_LIST
@@ -73,17 +95,29 @@ signals:
     void firmwareChanged    ();
     void vehicleChanged     ();
     void sendStatusChanged  ();
+    void fleetVehicleCountChanged();
+    void streamRateChanged  ();
+    void packetLossPercentChanged();
+    void jitterMSecsChanged ();
 
 private:
     MAV_AUTOPILOT   _firmwareType;
     MAV_TYPE        _vehicleType;
     bool            _sendStatusText;
     FailureMode_t   _failureMode;
+    int             _fleetVehicleCount;
+    int             _streamRate;
+    int             _packetLossPercent;
+    int             _jitterMSecs;
 
     static const char* _firmwareTypeKey;
     static const char* _vehicleTypeKey;
     static const char* _sendStatusTextKey;
     static const char* _failureModeKey;
+    static const char* _fleetVehicleCountKey;
+    static const char* _streamRateKey;
+    static const char* _packetLossPercentKey;
+    static const char* _jitterMSecsKey;
 };
 
 class MockLink : public LinkInterface
@@ -145,12 +179,50 @@ public:
     /// Returns the filename for the simulated log file. Only available after a download is requested.
     QString logDownloadFile(void) { return _logDownloadFilename; }
 
+    /// Sets the size of the simulated log file. Must be called before a download is requested.
+    void setLogDownloadFileSize(uint32_t size) { _logDownloadFileSize = size; }
+
+    /// @return Number of log data bytes sent to QGC, including data which was dropped by packet loss simulation
+    uint32_t logDownloadBytesSent(void) const { return _logDownloadBytesSent; }
+
+    /// Changes the packet loss simulation of the running link, see MockConfiguration::setPacketLossPercent
+    void setPacketLossPercent(int packetLossPercent) { _packetLossPercent = qBound(0, packetLossPercent, 100); }
+
+    /// Changes the jitter simulation of the running link, see MockConfiguration::setJitterMSecs
+    void setJitterMSecs(int jitterMSecs) { _jitterMSecs = qMax(0, jitterMSecs); }
+
+    /// Changes a parameter value on the simulated vehicle without notifying QGC. Must be called before
+    /// QGC requests the parameter list.
+    void setParamValue(int componentId, const QString& paramName, const QVariant& value);
+
+    /// @return Number of PARAM_VALUE messages sent to QGC
+    int paramValueSentCount(void) const { return _paramValueSentCount; }
+
+    /// Sets whether the vehicle advertises and answers range hash requests, which stock PX4 does not. Must be
+    /// called before QGC requests the parameter list.
+    void setRangeHashSupported(bool rangeHashSupported) { _rangeHashSupported = rangeHashSupported; }
+
+    /// @return Number of range hash requests received from QGC
+    int rangeHashRequestCount(void) const { return _rangeHashRequestCount; }
+
+    /// Sets the number of range hash requests which are dropped without an answer, like lost messages
+    void setRangeHashDropCount(int rangeHashDropCount) { _rangeHashDropCount = rangeHashDropCount; }
+
+    /// @return System ids of the telemetry only fleet vehicles simulated in addition to the main vehicle
+    QList<int> fleetVehicleIds(void) const;
+
+    /// @return Current interval in msecs at which a fleet vehicle sends the specified message, 0 for disabled
+    int fleetVehicleMessageIntervalMSecs(int vehicleId, uint32_t msgid) const;
+
     static MockLink* startPX4MockLink            (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
     static MockLink* startGenericMockLink        (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
     static MockLink* startAPMArduCopterMockLink  (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
     static MockLink* startAPMArduPlaneMockLink   (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
     static MockLink* startAPMArduSubMockLink     (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
 
+    /// Starts a PX4 MockLink which simulates fleetVehicleCount telemetry only vehicles in addition to the main vehicle
+    static MockLink* startPX4FleetMockLink       (int fleetVehicleCount);
+
 private slots:
     virtual void _writeBytes(const QByteArray bytes);
 
@@ -192,9 +264,15 @@ private:
     void _respondWithAutopilotVersion(void);
     void _sendRCChannels(void);
     void _paramRequestListWorker(void);
+    uint32_t _paramHash(int componentId, int startIndex, int count);
+    void _sendParamHash(int componentId, const char* paramName, int paramIndex, uint32_t hash);
     void _logDownloadWorker(void);
     void _sendADSBVehicles(void);
     void _moveADSBVehicle(void);
+    bool _handleFleetVehicleMessage(const mavlink_message_t& msg);
+    void _runFleetVehicles(void);
+    void _sendLoadStreams(void);
+    void _sendDelayedBytes(void);
 
     static MockLink* _startMockLink(MockConfiguration* mockConfig);
 
@@ -234,22 +312,63 @@ private:
 
     int _currentParamRequestListComponentIndex; // Current component index for param request list workflow, -1 for no request in progress
     int _currentParamRequestListParamIndex;     // Current parameter index for param request list workflow
+    bool _paramRequestListSendHash;             // true: send _HASH_CHECK before the first parameter
+    int _paramValueSentCount;                   // Number of PARAM_VALUE messages sent
+    bool _rangeHashSupported;                   // true: advertise and answer range hash requests
+    int _rangeHashRequestCount;                 // Number of range hash requests received
+    int _rangeHashDropCount;                    // Number of range hash requests still to be dropped
 
-    static const uint16_t _logDownloadLogId = 0;        ///< Id of siumulated log file
-    static const uint32_t _logDownloadFileSize = 1000;  ///< Size of simulated log file
+    static const uint16_t _logDownloadLogId = 0;                ///< Id of siumulated log file
+    static const uint32_t _defaultLogDownloadFileSize = 1000;   ///< Default size of simulated log file
 
     QString _logDownloadFilename;           ///< Filename for log download which is in progress
+    uint32_t    _logDownloadFileSize;       ///< Size of simulated log file
     uint32_t    _logDownloadCurrentOffset;  ///< Current offset we are sending from
     uint32_t    _logDownloadBytesRemaining; ///< Number of bytes still to send, 0 = send inactive
+    uint32_t    _logDownloadBytesSent;      ///< Number of bytes sent over all requests
 
     QGeoCoordinate  _adsbVehicleCoordinate;
     double          _adsbAngle;
 
+    /// Telemetry only vehicle which shares the link with the main vehicle. It only sends a fixed set of streams at
+    /// the rates requested through MAV_CMD_SET_MESSAGE_INTERVAL and rejects all other commands.
+    typedef struct {
+        uint8_t             systemId;
+        QGeoCoordinate      center;
+        double              angle;
+        QMap<uint32_t, int> streamIntervalTicks;    ///< Ticks of the 10Hz task between messages, 0 for disabled
+    } FleetVehicle_t;
+
+    QList<FleetVehicle_t>   _fleetVehicles;
+    uint32_t                _fleetTick;
+
+    int             _streamRate;
+    int             _streamRateAccumulator;     ///< Accumulates streamRate each 500Hz tick, a message set is sent each time it reaches 500
+    int             _packetLossPercent;
+    int             _jitterMSecs;
+    QElapsedTimer   _jitterTimer;
+    qint64          _lastDelayedSendMSecs;      ///< Send time of the newest delayed message, later messages never go out before it
+
+    /// Messages held back for jitter simulation. Protected by _delayedBytesMutex since tests may send messages from the main thread.
+    typedef struct {
+        qint64      sendMSecs;
+        QByteArray  bytes;
+    } DelayedBytes_t;
+
+    QList<DelayedBytes_t>   _delayedBytes;
+    QMutex                  _delayedBytesMutex;
+
+    static const int    _fleetTicksPerSecond = 10;
+    static int          _nextFleetVehicleSystemId;
+
     static double       _defaultVehicleLatitude;
     static double       _defaultVehicleLongitude;
     static double       _defaultVehicleAltitude;
     static int          _nextVehicleSystemId;
+    static const QMap<uint32_t, int>& _fleetDefaultStreamIntervalTicks(void);
     static const char*  _failParam;
+    static const char*  _rangeHashParamPrefix;  ///< PARAM_REQUEST_READ of "_HR:<start>:<count>" returns the _HASH_CHECK value of that index range
+    static const char*  _rangeHashSupportParamName; ///< Sent ahead of _HASH_CHECK to advertise range hash support
 };
 
 #endif
@@ -27,6 +27,8 @@ const MockLinkFileServer::FileTestCase MockLinkFileServer::rgFileTestCases[MockL
     { "exact.qgc",      sizeof(((FileManager::Request*)0)->data),         1,    true },
     // File is larger than a single Read Ack packets, requires multiple Reads
     { "multi.qgc",      sizeof(((FileManager::Request*)0)->data) + 1,     2,    false },
+    // File spans many packets, used to measure transfer speed
+    { "large.qgc",      sizeof(((FileManager::Request*)0)->data) * 128,   128,  true },
 };
 
 // We only support a single fixed session
@@ -39,9 +41,12 @@ MockLinkFileServer::MockLinkFileServer(uint8_t systemIdServer, uint8_t component
     _mockLink(mockLink),
     _lastReplyValid(false),
     _lastReplySequence(0),
-    _randomDropsEnabled(false)
+    _randomDropsEnabled(false),
+    _latencyMsecs(0),
+    _lossPercent(0)
 {
     srand(0); // make sure unit tests are deterministic
+    _latencyTimer.start();
 }
 
 void MockLinkFileServer::ensureNullTemination(FileManager::Request* request)
@@ -240,6 +245,7 @@ void MockLinkFileServer::_streamCommand(uint8_t senderSystemId, uint8_t senderCo
         response.hdr.offset = ackOffset;
         response.hdr.opcode = FileManager::kRspAck;
         response.hdr.req_opcode = FileManager::kCmdBurstReadFile;
+        response.hdr.burstComplete = readOffset >= _readFileLength;
         
         _sendResponse(senderSystemId, senderComponentId, &response, outgoingSeqNumber);
         
@@ -250,6 +256,53 @@ void MockLinkFileServer::_streamCommand(uint8_t senderSystemId, uint8_t senderCo
     _sendNak(senderSystemId, senderComponentId, FileManager::kErrEOF, outgoingSeqNumber, FileManager::kCmdBurstReadFile);
 }
 
+/// @brief Handles Create command requests. Any path is accepted, the file is kept in memory.
+void MockLinkFileServer::_createCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber)
+{
+    FileManager::Request    response;
+    uint16_t                outgoingSeqNumber = _nextSeqNumber(seqNumber);
+    
+    Q_UNUSED(request);
+    
+    _uploadedFile.clear();
+    
+    response.hdr.opcode = FileManager::kRspAck;
+    response.hdr.req_opcode = FileManager::kCmdCreateFile;
+    response.hdr.session = _sessionId;
+    response.hdr.size = 0;
+    
+    _sendResponse(senderSystemId, senderComponentId, &response, outgoingSeqNumber);
+}
+
+/// @brief Handles Write command requests. Writes may arrive in any order.
+void MockLinkFileServer::_writeCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber)
+{
+    FileManager::Request    response;
+    uint16_t                outgoingSeqNumber = _nextSeqNumber(seqNumber);
+    
+    if (request->hdr.session != _sessionId) {
+        _sendNak(senderSystemId, senderComponentId, FileManager::kErrFail, outgoingSeqNumber, FileManager::kCmdWriteFile);
+        return;
+    }
+    
+    int writeEnd = request->hdr.offset + request->hdr.size;
+    if (_uploadedFile.size() < writeEnd) {
+        _uploadedFile.resize(writeEnd);
+    }
+    _uploadedFile.replace(request->hdr.offset, request->hdr.size, (const char*)request->data, request->hdr.size);
+    
+    response.hdr.opcode = FileManager::kRspAck;
+    response.hdr.req_opcode = FileManager::kCmdWriteFile;
+    response.hdr.session = _sessionId;
+    response.hdr.offset = request->hdr.offset;
+    
+    // Data contains the number of bytes written
+    response.hdr.size = sizeof(uint32_t);
+    response.writeFileLength = request->hdr.size;
+    
+    _sendResponse(senderSystemId, senderComponentId, &response, outgoingSeqNumber);
+}
+
 void MockLinkFileServer::_terminateCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber)
 {
     uint16_t outgoingSeqNumber = _nextSeqNumber(seqNumber);
@@ -296,12 +349,18 @@ void MockLinkFileServer::handleFTPMessage(const mavlink_message_t& message)
 	        return;
 	    }
 	}
+	
+	if (_simulateLoss(request->hdr.opcode)) {
+	    return;
+	}
 
 	if (_lastReplyValid && request->hdr.seqNumber + 1 == _lastReplySequence) {
 	    // this is the same request as the one we replied to last. It means the (n)ack got lost, and the GCS
 	    // resent the request
 	    qDebug() << "FileServer: resending response";
-	    _mockLink->respondWithMavlinkMessage(_lastReply);
+	    if (!_simulateLoss(request->hdr.opcode)) {
+	        _sendMessage(_lastReply);
+	    }
 	    return;
 	}
 
@@ -348,6 +407,14 @@ void MockLinkFileServer::handleFTPMessage(const mavlink_message_t& message)
             _streamCommand(message.sysid, message.compid, request, incomingSeqNumber);
             break;
 
+        case FileManager::kCmdCreateFile:
+            _createCommand(message.sysid, message.compid, request, incomingSeqNumber);
+            break;
+
+        case FileManager::kCmdWriteFile:
+            _writeCommand(message.sysid, message.compid, request, incomingSeqNumber);
+            break;
+
         case FileManager::kCmdTerminateSession:
             _terminateCommand(message.sysid, message.compid, request, incomingSeqNumber);
             break;
@@ -412,8 +479,45 @@ void MockLinkFileServer::_sendResponse(uint8_t targetSystemId, uint8_t targetCom
 	        return;
 	    }
 	}
+	
+	if (_simulateLoss(request->hdr.req_opcode)) {
+	    return;
+	}
     
-    _mockLink->respondWithMavlinkMessage(_lastReply);
+    _sendMessage(_lastReply);
+}
+
+/// @brief Decides whether a request or response is lost by the simulated link. Reset and Terminate commands are never
+/// lost, so a test can tell when a transfer is over.
+///     @param opcode Opcode of the request, or the request opcode of a response
+bool MockLinkFileServer::_simulateLoss(uint8_t opcode)
+{
+    if (opcode == FileManager::kCmdResetSessions || opcode == FileManager::kCmdTerminateSession) {
+        return false;
+    }
+    return _lossPercent > 0 && rand() % 100 < _lossPercent;
+}
+
+/// @brief Sends a message to QGC, held back by the simulated latency
+void MockLinkFileServer::_sendMessage(const mavlink_message_t& message)
+{
+    if (_latencyMsecs > 0 || !_delayedResponses.isEmpty()) {
+        DelayedResponse_t delayedResponse;
+        delayedResponse.sendMsecs = _latencyTimer.elapsed() + _latencyMsecs;
+        delayedResponse.message = message;
+        _delayedResponses.append(delayedResponse);
+        return;
+    }
+    
+    _mockLink->respondWithMavlinkMessage(message);
+}
+
+void MockLinkFileServer::sendDelayedResponses(void)
+{
+    qint64 nowMsecs = _latencyTimer.elapsed();
+    while (!_delayedResponses.isEmpty() && _delayedResponses.first().sendMsecs <= nowMsecs) {
+        _mockLink->respondWithMavlinkMessage(_delayedResponses.takeFirst().message);
+    }
 }
 
 /// @brief Generates the next sequence number given an incoming sequence number. Handles generating
@@ -17,6 +17,8 @@
 #include "FileManager.h"
 
 #include <QStringList>
+#include <QElapsedTimer>
+#include <QList>
 
 class MockLink;
 
@@ -59,18 +61,29 @@ public:
     /// @brief Used to represent a single test case for download testing.
     struct FileTestCase {
         const char* filename;               ///< Filename to download
-        uint8_t     length;                 ///< Length of file in bytes
+        uint32_t    length;                 ///< Length of file in bytes
 		int			packetCount;			///< Number of packets required for data
         bool        exactFit;				///< true: last packet is exact fit, false: last packet is partially filled
     };
     
     /// @brief The numbers of test cases in the rgFileTestCases array.
-    static const size_t cFileTestCases = 3;
+    static const size_t cFileTestCases = 4;
     
     /// @brief The set of files supported by the mock server for testing purposes. Each one represents a different edge case for testing.
     static const FileTestCase rgFileTestCases[cFileTestCases];
     
     void enableRandromDrops(bool enable) { _randomDropsEnabled = enable; }
+    
+    /// @brief Simulates a slow, lossy link for FTP traffic. Reset commands and their acks are never lost.
+    ///     @param latencyMsecs Responses are held back this many msecs, giving the round trip time
+    ///     @param lossPercent Percentage of requests and of responses which are dropped
+    void setLinkSimulation(int latencyMsecs, int lossPercent) { _latencyMsecs = latencyMsecs; _lossPercent = lossPercent; }
+    
+    /// @brief Sends the responses held back for latency simulation which are due. Called by MockLink from its worker thread.
+    void sendDelayedResponses(void);
+    
+    /// @return Contents of the last file created by an upload
+    const QByteArray& uploadedFile(void) const { return _uploadedFile; }
 
 signals:
     /// You can connect to this signal to be notified when the server receives a Terminate command.
@@ -87,9 +100,13 @@ private:
     void _openCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber);
     void _readCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber);
 	void _streamCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber);
+    void _createCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber);
+    void _writeCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber);
     void _terminateCommand(uint8_t senderSystemId, uint8_t senderComponentId, FileManager::Request* request, uint16_t seqNumber);
     void _resetCommand(uint8_t senderSystemId, uint8_t senderComponentId, uint16_t seqNumber);
     uint16_t _nextSeqNumber(uint16_t seqNumber);
+    bool _simulateLoss(uint8_t opcode);
+    void _sendMessage(const mavlink_message_t& message);
     
     /// if request is a string, this ensures it's null-terminated
     static void ensureNullTemination(FileManager::Request* request);
@@ -97,7 +114,7 @@ private:
     QStringList _fileList;  ///< List of files returned by List command
     
     static const uint8_t    _sessionId;
-    uint8_t                 _readFileLength;    ///< Length of active file being read
+    uint32_t                _readFileLength;    ///< Length of active file being read
     ErrorMode_t             _errMode;           ///< Currently set error mode, as specified by setErrorMode
     const uint8_t           _systemIdServer;    ///< System ID for server
     const uint8_t           _componentIdServer; ///< Component ID for server
@@ -108,6 +125,20 @@ private:
     mavlink_message_t _lastReply;
 
     bool _randomDropsEnabled;
+    
+    int             _latencyMsecs;
+    int             _lossPercent;
+    QElapsedTimer   _latencyTimer;
+    
+    /// Responses held back for latency simulation, in the order they are sent
+    typedef struct {
+        qint64              sendMsecs;
+        mavlink_message_t   message;
+    } DelayedResponse_t;
+    
+    QList<DelayedResponse_t>    _delayedResponses;
+    
+    QByteArray  _uploadedFile;      ///< Data written to the file created by the last Create command
 };
 
 #endif
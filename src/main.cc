@@ -34,6 +34,7 @@
 
 #ifdef UNITTEST_BUILD
     #include "UnitTest.h"
+    #include "MockLinkLoadBenchmark.h"
 #endif
 
 #ifdef QT_DEBUG
@@ -169,18 +170,25 @@ int main(int argc, char *argv[])
     Q_IMPORT_PLUGIN(QGeoServiceProviderFactoryQGC)
 
     bool runUnitTests = false;          // Run unit tests
+    bool runLoadBenchmark = false;      // Run MockLink load benchmark
 
 #ifdef QT_DEBUG
     // We parse a small set of command line options here prior to QGCApplication in order to handle the ones
     // which need to be handled before a QApplication object is started.
 
     bool stressUnitTests = false;       // Stress test unit tests
+    bool benchmarkUnitTests = false;    // Also run the unit test benchmarks
+    bool slowUnitTests = false;         // Also run the slow unit tests
     bool quietWindowsAsserts = false;   // Don't let asserts pop dialog boxes
 
     QString unitTestOptions;
+    QString loadBenchmarkOptions;
     CmdLineOpt_t rgCmdLineOptions[] = {
         { "--unittest",             &runUnitTests,          &unitTestOptions },
         { "--unittest-stress",      &stressUnitTests,       &unitTestOptions },
+        { "--unittest-benchmarks",  &benchmarkUnitTests,    &unitTestOptions },
+        { "--unittest-slow",        &slowUnitTests,         &unitTestOptions },
+        { "--load-benchmark",       &runLoadBenchmark,      &loadBenchmarkOptions },
         { "--no-windows-assert-ui", &quietWindowsAsserts,   NULL },
         // Add additional command line option flags here
     };
@@ -189,6 +197,9 @@ int main(int argc, char *argv[])
     if (stressUnitTests) {
         runUnitTests = true;
     }
+    if (benchmarkUnitTests || slowUnitTests) {
+        runUnitTests = true;
+    }
 
     if (quietWindowsAsserts) {
 #ifdef Q_OS_WIN
@@ -197,7 +208,7 @@ int main(int argc, char *argv[])
     }
 
 #ifdef Q_OS_WIN
-    if (runUnitTests) {
+    if (runUnitTests || runLoadBenchmark) {
         // Don't pop up Windows Error Reporting dialog when app crashes. This prevents TeamCity from
         // hanging.
         DWORD dwMode = SetErrorMode(SEM_NOGPFAULTERRORBOX);
@@ -206,7 +217,8 @@ int main(int argc, char *argv[])
 #endif
 #endif // QT_DEBUG
 
-    QGCApplication* app = new QGCApplication(argc, argv, runUnitTests);
+    // The load benchmark runs headless with clean settings just like the unit tests
+    QGCApplication* app = new QGCApplication(argc, argv, runUnitTests || runLoadBenchmark);
     Q_CHECK_PTR(app);
 
 #ifdef Q_OS_LINUX
@@ -227,7 +239,15 @@ int main(int argc, char *argv[])
     int exitCode = 0;
 
 #ifdef UNITTEST_BUILD
-    if (runUnitTests) {
+    if (runLoadBenchmark) {
+        if (!app->_initForUnitTests()) {
+            return -1;
+        }
+
+        MockLinkLoadBenchmark loadBenchmark(loadBenchmarkOptions);
+        exitCode = loadBenchmark.run();
+    } else if (runUnitTests) {
+        UnitTest::setOptInTests((benchmarkUnitTests ? UnitTest::optInBenchmarks : 0) | (slowUnitTests ? UnitTest::optInSlow : 0));
         for (int i=0; i < (stressUnitTests ? 20 : 1); i++) {
             if (!app->_initForUnitTests()) {
                 return -1;
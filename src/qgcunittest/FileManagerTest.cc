@@ -16,6 +16,8 @@
 #include "UAS.h"
 #include "QGCApplication.h"
 
+#include <QTemporaryDir>
+
 FileManagerTest::FileManagerTest(void)
     : _fileServer(NULL)
     , _fileManager(NULL)
@@ -41,6 +43,7 @@ void FileManagerTest::init(void)
     
     // Reset any internal state back to normal
     _fileServer->setErrorMode(MockLinkFileServer::errModeNone);
+    _fileServer->setLinkSimulation(0, 0);
     _fileListReceived.clear();
 
     connect(_fileManager, &FileManager::listEntry, this, &FileManagerTest::listEntry);
@@ -199,6 +202,125 @@ void FileManagerTest::_listTest(void)
     _fileServer->enableRandromDrops(false);
 }
 
+/// @brief Waits for the Reset which closes a transfer to reach the server and for its ack to come back. The next
+/// command can't be sent before.
+void FileManagerTest::_waitForSessionReset(QSignalSpy& resetSpy)
+{
+    QTRY_VERIFY_WITH_TIMEOUT(resetSpy.count() > 0, _ackTimerTimeoutMsecs);
+    resetSpy.clear();
+    QTest::qWait(_lossyLatencyMsecs + _ackTimerTimeoutMsecs / 4);
+}
+
+void FileManagerTest::_windowDownloadTest(void)
+{
+    Q_ASSERT(_fileManager);
+    Q_ASSERT(_multiSpy);
+    Q_ASSERT(_multiSpy->checkNoSignals() == true);
+
+    QSignalSpy resetSpy(_fileServer, SIGNAL(resetCommandReceived()));
+    QTemporaryDir downloadDir;
+    QVERIFY(downloadDir.isValid());
+
+    // Read and burst downloads of every test file, first over a clean link then over a slow lossy one
+    for (int lossy=0; lossy<2; lossy++) {
+        _fileServer->setLinkSimulation(lossy ? _lossyLatencyMsecs : 0, lossy ? _lossyLossPercent : 0);
+
+        for (int burst=0; burst<2; burst++) {
+            for (size_t i=0; i<MockLinkFileServer::cFileTestCases; i++) {
+                const MockLinkFileServer::FileTestCase* testCase = &MockLinkFileServer::rgFileTestCases[i];
+                if (burst) {
+                    _fileManager->streamPath(testCase->filename, QDir(downloadDir.path()));
+                } else {
+                    _fileManager->downloadPath(testCase->filename, QDir(downloadDir.path()));
+                }
+                QVERIFY(_multiSpy->waitForSignalByIndex(commandCompleteSignalIndex, _transferTimeoutMsecs));
+                QCOMPARE(_multiSpy->checkOnlySignalByMask(commandCompleteSignalMask), true);
+                _multiSpy->clearAllSignals();
+
+                _validateFileContents(QDir(downloadDir.path()).absoluteFilePath(testCase->filename), testCase->length);
+                _waitForSessionReset(resetSpy);
+            }
+        }
+    }
+
+    _fileServer->setLinkSimulation(0, 0);
+}
+
+void FileManagerTest::_windowUploadTest(void)
+{
+    Q_ASSERT(_fileManager);
+    Q_ASSERT(_multiSpy);
+    Q_ASSERT(_multiSpy->checkNoSignals() == true);
+
+    QSignalSpy resetSpy(_fileServer, SIGNAL(resetCommandReceived()));
+    QTemporaryDir uploadDir;
+    QVERIFY(uploadDir.isValid());
+
+    // Spans many write requests and ends with a partial one
+    QByteArray bytes;
+    for (int i=0; i<10000; i++) {
+        bytes.append((char)((i * 7) & 0xFF));
+    }
+    QFile file(QDir(uploadDir.path()).absoluteFilePath("upload.qgc"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(bytes), (qint64)bytes.count());
+    file.close();
+
+    for (int lossy=0; lossy<2; lossy++) {
+        _fileServer->setLinkSimulation(lossy ? _lossyLatencyMsecs : 0, lossy ? _lossyLossPercent : 0);
+
+        _fileManager->uploadPath("/fs/microsd", QFileInfo(file.fileName()));
+        QVERIFY(_multiSpy->waitForSignalByIndex(commandCompleteSignalIndex, _transferTimeoutMsecs));
+        QCOMPARE(_multiSpy->checkOnlySignalByMask(commandCompleteSignalMask), true);
+        _multiSpy->clearAllSignals();
+
+        QVERIFY(_fileServer->uploadedFile() == bytes);
+        _waitForSessionReset(resetSpy);
+    }
+
+    _fileServer->setLinkSimulation(0, 0);
+}
+
+/// @brief Compares one request at a time with the read window over a link with latency
+void FileManagerTest::_windowBenchmark(void)
+{
+    UT_OPT_IN(optInBenchmarks);
+
+    Q_ASSERT(_fileManager);
+    Q_ASSERT(_multiSpy);
+    Q_ASSERT(_multiSpy->checkNoSignals() == true);
+
+    QSignalSpy resetSpy(_fileServer, SIGNAL(resetCommandReceived()));
+    QTemporaryDir downloadDir;
+    QVERIFY(downloadDir.isValid());
+
+    const MockLinkFileServer::FileTestCase* testCase = &MockLinkFileServer::rgFileTestCases[MockLinkFileServer::cFileTestCases - 1];
+    _fileServer->setLinkSimulation(_benchmarkLatencyMsecs, 0);
+
+    qint64 msecs[2];
+    for (int i=0; i<2; i++) {
+        _fileManager->setMaxWindowSize(i == 0 ? 1 : FileManager::windowMaxRequests);
+
+        QElapsedTimer elapsed;
+        elapsed.start();
+        _fileManager->downloadPath(testCase->filename, QDir(downloadDir.path()));
+        QVERIFY(_multiSpy->waitForSignalByIndex(commandCompleteSignalIndex, _transferTimeoutMsecs));
+        msecs[i] = qMax(elapsed.elapsed(), (qint64)1);
+        QCOMPARE(_multiSpy->checkOnlySignalByMask(commandCompleteSignalMask), true);
+        _multiSpy->clearAllSignals();
+
+        _validateFileContents(QDir(downloadDir.path()).absoluteFilePath(testCase->filename), testCase->length);
+        _waitForSessionReset(resetSpy);
+    }
+
+    qDebug() << "FTP download benchmark:" << testCase->length << "bytes, latency" << _benchmarkLatencyMsecs << "msecs";
+    qDebug() << "FTP download benchmark: one request at a time msecs" << msecs[0] << "bytes/sec" << (testCase->length * 1000) / msecs[0];
+    qDebug() << "FTP download benchmark: windowed msecs" << msecs[1] << "bytes/sec" << (testCase->length * 1000) / msecs[1];
+
+    _fileManager->setMaxWindowSize(FileManager::windowMaxRequests);
+    _fileServer->setLinkSimulation(0, 0);
+}
+
 #if 0
 // Trying to write test code for read and burst mode download as well as implement support in MockLineFileServer reached a point
 // of diminishing returns where the test code and mock server were generating more bugs in themselves than finding problems.
@@ -374,7 +496,9 @@ void FileManagerTest::_streamDownloadTest(void)
     }
 }
 
-void FileManagerTest::_validateFileContents(const QString& filePath, uint8_t length)
+#endif
+
+void FileManagerTest::_validateFileContents(const QString& filePath, uint32_t length)
 {
 	QFile file(filePath);
 	
@@ -388,8 +512,7 @@ void FileManagerTest::_validateFileContents(const QString& filePath, uint8_t len
 	
 	// Validate file contents:
 	//      Repeating 0x00, 0x01 .. 0xFF until file is full
-	for (uint8_t i=0; i<bytes.length(); i++) {
+	for (int i=0; i<bytes.length(); i++) {
 		QCOMPARE((uint8_t)bytes[i], (uint8_t)(i & 0xFF));
 	}
 }
-#endif
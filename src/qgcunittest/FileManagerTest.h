@@ -40,12 +40,16 @@ private slots:
     void _ackTest(void);
     void _noAckTest(void);
     void _listTest(void);
+    void _windowDownloadTest(void);
+    void _windowUploadTest(void);
+    void _windowBenchmark(void);
 	
     // Connected to FileManager listEntry signal
     void listEntry(const QString& entry);
     
 private:
-    void _validateFileContents(const QString& filePath, uint8_t length);
+    void _validateFileContents(const QString& filePath, uint32_t length);
+    void _waitForSessionReset(QSignalSpy& resetSpy);
 
     enum {
         listEntrySignalIndex = 0,
@@ -71,8 +75,16 @@ private:
     const char*         _rgSignals[_cSignals];
     
     /// @brief This is the amount of time to wait to allow the FileManager enough time to timeout waiting for an Ack.
-    /// As such it must be larger than the Ack Timeout used by the FileManager.
-    static const int _ackTimerTimeoutMsecs = FileManager::ackTimerMaxRetries * FileManager::ackTimerTimeoutMsecs * 2;
+    /// Each command starts with the ack timeout reset to the round trip estimate, which is the minimum ack timeout
+    /// on MockLink, so the initial request and all its retries must fit with margin.
+    static const int _ackTimerTimeoutMsecs = (FileManager::ackTimerMaxRetries + 1) * FileManager::ackTimerTimeoutMsecs * 2;
+    
+    /// Time allowed for a whole file transfer over the simulated lossy link
+    static const int _transferTimeoutMsecs = 30000;
+
+    static const int _lossyLatencyMsecs = 20;
+    static const int _lossyLossPercent = 10;
+    static const int _benchmarkLatencyMsecs = 20;
     
     QStringList _fileListReceived;
 };
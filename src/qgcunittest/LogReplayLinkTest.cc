@@ -0,0 +1,178 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogReplayLinkTest.h"
+#include "LogReplayLink.h"
+#include "LinkManager.h"
+#include "QGCApplication.h"
+#include "VideoSyncIndex.h"
+
+#include <QDir>
+#include <QSignalSpy>
+#include <QtEndian>
+
+static const int        _messageCount =         101;
+static const quint64    _messageIntervalUSecs = 100000;
+
+LogReplayLinkTest::LogReplayLinkTest(void)
+    : _tempDir(NULL)
+    , _startUSecs(0)
+    , _replayLink(NULL)
+{
+
+}
+
+void LogReplayLinkTest::init(void)
+{
+    UnitTest::init();
+
+    _tempDir = new QTemporaryDir();
+    QVERIFY(_tempDir->isValid());
+    _writeLog();
+    _connectPaused();
+}
+
+void LogReplayLinkTest::cleanup(void)
+{
+    if (_replayLink) {
+        qgcApp()->toolbox()->linkManager()->disconnectLink(_replayLink);
+        _replayLink = NULL;
+    }
+    delete _tempDir;
+    _tempDir = NULL;
+
+    UnitTest::cleanup();
+}
+
+/// Writes a ten second tlog with a message every 100 msecs. Timestamps are an hour in the past since the replay treats
+/// timestamps from the future as byte swapped.
+void LogReplayLinkTest::_writeLog(void)
+{
+    _logFilename = QDir(_tempDir->path()).filePath(QStringLiteral("replay.tlog"));
+    _startUSecs = ((quint64)QDateTime::currentMSecsSinceEpoch() - (60 * 60 * 1000)) * 1000;
+    _messageOffsets.clear();
+
+    QFile logFile(_logFilename);
+    QVERIFY(logFile.open(QIODevice::WriteOnly));
+    for (int i=0; i<_messageCount; i++) {
+        quint64 timestampUSecs = _startUSecs + (i * _messageIntervalUSecs);
+
+        mavlink_message_t message;
+        mavlink_msg_system_time_pack(1, MAV_COMP_ID_AUTOPILOT1, &message, timestampUSecs, i * 100);
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN + sizeof(quint64)];
+        qToBigEndian<quint64>(timestampUSecs, buffer);
+        int cBytes = sizeof(quint64) + mavlink_msg_to_send_buffer(buffer + sizeof(quint64), &message);
+
+        _messageOffsets.append(logFile.pos());
+        QCOMPARE(logFile.write((const char*)buffer, cBytes), (qint64)cBytes);
+    }
+    logFile.close();
+}
+
+/// Connects a replay link to the log and pauses it right away
+void LogReplayLinkTest::_connectPaused(void)
+{
+    LinkManager* linkManager = qgcApp()->toolbox()->linkManager();
+
+    LogReplayLinkConfiguration* linkConfig = new LogReplayLinkConfiguration(QStringLiteral("Log Replay Test"));
+    linkConfig->setLogFilename(_logFilename);
+    SharedLinkConfigurationPointer sharedConfig = linkManager->addConfiguration(linkConfig);
+    _replayLink = qobject_cast<LogReplayLink*>(linkManager->createConnectedLink(sharedConfig));
+    QVERIFY(_replayLink);
+
+    QSignalSpy pausedSpy(_replayLink, &LogReplayLink::playbackPaused);
+    _replayLink->pause();
+    QVERIFY(pausedSpy.wait(5000));
+    QVERIFY(!_replayLink->isPlaying());
+}
+
+void LogReplayLinkTest::_seekTimestamp_test(void)
+{
+    QSignalSpy percentSpy(_replayLink, &LogReplayLink::playbackPercentCompleteChanged);
+
+    // The playhead lands on the first message at or after the requested time
+    _replayLink->movePlayheadToTimestamp(_startUSecs + (50 * _messageIntervalUSecs));
+    QCOMPARE(percentSpy.count(), 1);
+    QCOMPARE(percentSpy.takeFirst()[0].toInt(), 50);
+
+    _replayLink->movePlayheadToTimestamp(_startUSecs + (25 * _messageIntervalUSecs) - 10);
+    QCOMPARE(percentSpy.takeFirst()[0].toInt(), 25);
+
+    _replayLink->movePlayheadToOffset(_messageOffsets[75]);
+    QCOMPARE(percentSpy.takeFirst()[0].toInt(), 75);
+}
+
+/// Index of a recording made while the log was written, with frames matching messages 25, 50 and 75
+void LogReplayLinkTest::_fillVideoIndex(VideoSyncIndex& index)
+{
+    VideoSyncIndex::Entry_t entry;
+
+    // Frame received 1.5 seconds before the message at its log offset was logged. That is within tolerance, so the
+    // offset is used rather than the frame time, which would land on message 10.
+    entry.ptsNSecs = 0;
+    entry.wallClockUSecs = _startUSecs + (25 * _messageIntervalUSecs) - 1500000;
+    entry.tlogOffset = _messageOffsets[25];
+    index.append(entry, QStringLiteral("FlightData1234.mavlink"));
+
+    // Frame without telemetry
+    entry.ptsNSecs = 1000;
+    entry.wallClockUSecs = _startUSecs + (50 * _messageIntervalUSecs);
+    entry.tlogOffset = -1;
+    index.append(entry, QString());
+
+    // Offset from a different log, the message there is far from the frame time so the frame time is used
+    entry.ptsNSecs = 2000;
+    entry.wallClockUSecs = _startUSecs + (75 * _messageIntervalUSecs);
+    entry.tlogOffset = _messageOffsets[10];
+    index.append(entry, QStringLiteral("FlightData5678.mavlink"));
+}
+
+void LogReplayLinkTest::_seekVideoFrame_test(void)
+{
+    QSignalSpy percentSpy(_replayLink, &LogReplayLink::playbackPercentCompleteChanged);
+
+    VideoSyncIndex index;
+    _fillVideoIndex(index);
+    QCOMPARE(index.count(), 3);
+
+    _replayLink->movePlayheadToVideoFrame(index, 0);
+    QCOMPARE(percentSpy.count(), 1);
+    QCOMPARE(percentSpy.takeFirst()[0].toInt(), 25);
+
+    _replayLink->movePlayheadToVideoFrame(index, 1);
+    QCOMPARE(percentSpy.takeFirst()[0].toInt(), 50);
+
+    _replayLink->movePlayheadToVideoFrame(index, 2);
+    QCOMPARE(percentSpy.takeFirst()[0].toInt(), 75);
+}
+
+/// Finding the frame at the playhead is the reverse of moving the playhead to a frame
+void LogReplayLinkTest::_videoFrameForPlayhead_test(void)
+{
+    VideoSyncIndex index;
+    _fillVideoIndex(index);
+
+    // Found through the log offset
+    _replayLink->movePlayheadToOffset(_messageOffsets[25]);
+    QCOMPARE(_replayLink->videoFrameForPlayhead(index), 0);
+
+    // Found through the playhead time
+    _replayLink->movePlayheadToTimestamp(_startUSecs + (50 * _messageIntervalUSecs));
+    QCOMPARE(_replayLink->videoFrameForPlayhead(index), 1);
+    _replayLink->movePlayheadToTimestamp(_startUSecs + (60 * _messageIntervalUSecs));
+    QCOMPARE(_replayLink->videoFrameForPlayhead(index), 1);
+    _replayLink->movePlayheadToTimestamp(_startUSecs + (75 * _messageIntervalUSecs));
+    QCOMPARE(_replayLink->videoFrameForPlayhead(index), 2);
+
+    // Outside of the recording
+    _replayLink->movePlayheadToTimestamp(_startUSecs + (5 * _messageIntervalUSecs));
+    QCOMPARE(_replayLink->videoFrameForPlayhead(index), -1);
+    _replayLink->movePlayheadToTimestamp(_startUSecs + (90 * _messageIntervalUSecs));
+    QCOMPARE(_replayLink->videoFrameForPlayhead(index), -1);
+}
@@ -0,0 +1,46 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QTemporaryDir>
+
+class LogReplayLink;
+class VideoSyncIndex;
+
+/// Unit test for seeking LogReplayLink to a time or a video frame
+class LogReplayLinkTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    LogReplayLinkTest(void);
+
+protected slots:
+    void init(void);
+    void cleanup(void);
+
+private slots:
+    void _seekTimestamp_test(void);
+    void _seekVideoFrame_test(void);
+    void _videoFrameForPlayhead_test(void);
+
+private:
+    void _writeLog(void);
+    void _fillVideoIndex(VideoSyncIndex& index);
+    void _connectPaused(void);
+
+    QTemporaryDir*  _tempDir;
+    QString         _logFilename;
+    QList<qint64>   _messageOffsets;    ///< Log offset of each message record
+    quint64         _startUSecs;
+    LogReplayLink*  _replayLink;
+};
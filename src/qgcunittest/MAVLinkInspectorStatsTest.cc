@@ -0,0 +1,150 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkInspectorStatsTest.h"
+
+MAVLinkInspectorStatsTest::MAVLinkInspectorStatsTest(void)
+{
+
+}
+
+mavlink_message_t MAVLinkInspectorStatsTest::_attitude(int sysid, float roll)
+{
+    mavlink_message_t message;
+    mavlink_msg_attitude_pack(sysid, MAV_COMP_ID_AUTOPILOT1, &message, 0, roll, 0, 0, 0, 0, 0);
+    return message;
+}
+
+mavlink_message_t MAVLinkInspectorStatsTest::_heartbeat(int sysid)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(sysid, MAV_COMP_ID_AUTOPILOT1, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+    return message;
+}
+
+int MAVLinkInspectorStatsTest::_fieldIndex(const mavlink_message_t& message, const char* name)
+{
+    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(&message);
+    for (unsigned int i=0; i<msgInfo->num_fields; i++) {
+        if (strcmp(msgInfo->fields[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void MAVLinkInspectorStatsTest::_aggregate_test(void)
+{
+    MAVLinkInspectorStats stats;
+
+    stats.queueMessage(_attitude(1, -1.0f));
+    stats.queueMessage(_attitude(1, 0.5f));
+    stats.queueMessage(_attitude(1, 2.0f));
+    stats.queueMessage(_heartbeat(1));
+    stats.aggregate();
+
+    QList<MAVLinkInspectorStats::MessageStats_t> changed = stats.takeChanged();
+    QCOMPARE(changed.count(), 2);
+
+    foreach (const MAVLinkInspectorStats::MessageStats_t& messageStats, changed) {
+        if (messageStats.message.msgid == MAVLINK_MSG_ID_ATTITUDE) {
+            QCOMPARE(messageStats.intervalCount, (quint32)3);
+            QCOMPARE(messageStats.generation, (quint32)3);
+            int rollIndex = _fieldIndex(messageStats.message, "roll");
+            QVERIFY(rollIndex >= 0);
+            QCOMPARE(messageStats.fieldMin[rollIndex], -1.0);
+            QCOMPARE(messageStats.fieldMax[rollIndex], 2.0);
+            // The last message received is kept
+            QCOMPARE(mavlink_msg_attitude_get_roll(&messageStats.message), 2.0f);
+        } else {
+            QCOMPARE((quint32)messageStats.message.msgid, (quint32)MAVLINK_MSG_ID_HEARTBEAT);
+            QCOMPARE(messageStats.generation, (quint32)1);
+        }
+    }
+
+    // Nothing changed since the last call
+    stats.aggregate();
+    QCOMPARE(stats.takeChanged().count(), 0);
+
+    stats.queueMessage(_heartbeat(1));
+    stats.aggregate();
+    changed = stats.takeChanged();
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE((quint32)changed[0].message.msgid, (quint32)MAVLINK_MSG_ID_HEARTBEAT);
+    QCOMPARE(changed[0].generation, (quint32)2);
+}
+
+void MAVLinkInspectorStatsTest::_filter_test(void)
+{
+    MAVLinkInspectorStats stats;
+
+    stats.setFilter(2, 0);
+    stats.queueMessage(_heartbeat(1));
+    stats.queueMessage(_heartbeat(2));
+    stats.aggregate();
+
+    QList<MAVLinkInspectorStats::MessageStats_t> changed = stats.takeChanged();
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE((int)changed[0].message.sysid, 2);
+
+    stats.setFilter(0, MAV_COMP_ID_AUTOPILOT1 + 1);
+    stats.queueMessage(_heartbeat(2));
+    stats.aggregate();
+    QCOMPARE(stats.takeChanged().count(), 0);
+}
+
+void MAVLinkInspectorStatsTest::_rate_test(void)
+{
+    MAVLinkInspectorStats stats;
+
+    for (int i=0; i<10; i++) {
+        stats.queueMessage(_heartbeat(1));
+    }
+    stats.aggregate();
+    stats.takeChanged();
+
+    // 10 Hz measured over one second, low pass filtered from 0
+    stats.updateRates(1000);
+    QList<MAVLinkInspectorStats::MessageStats_t> changed = stats.takeChanged();
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(changed[0].hz, MAVLinkInspectorStats::rateLowpass * 10.0f);
+
+    // The rate decays once the message stops
+    stats.updateRates(1000);
+    changed = stats.takeChanged();
+    QCOMPARE(changed.count(), 1);
+    QVERIFY(changed[0].hz < MAVLinkInspectorStats::rateLowpass * 10.0f);
+
+    stats.clear();
+    stats.updateRates(1000);
+    QCOMPARE(stats.takeChanged().count(), 0);
+}
+
+/// Queue and aggregate cost of a burst of high rate messages from several vehicles
+void MAVLinkInspectorStatsTest::_throughput_benchmark(void)
+{
+    UT_OPT_IN(optInBenchmarks);
+
+    MAVLinkInspectorStats stats;
+
+    QVector<mavlink_message_t> messages;
+    for (int i=0; i<1000; i++) {
+        messages.append(i % 2 ? _attitude(1 + i % 10, i) : _heartbeat(1 + i % 10));
+    }
+
+    QBENCHMARK {
+        for (int i=0; i<messages.count(); i++) {
+            stats.queueMessage(messages[i]);
+        }
+        stats.aggregate();
+    }
+
+    // Heartbeats from odd and attitudes from even system ids
+    QCOMPARE(stats.takeChanged().count(), 10);
+}
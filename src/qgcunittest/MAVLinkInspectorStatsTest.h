@@ -0,0 +1,33 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "MAVLinkInspectorStats.h"
+
+/// Unit test for MAVLinkInspectorStats
+class MAVLinkInspectorStatsTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkInspectorStatsTest(void);
+
+private slots:
+    void _aggregate_test(void);
+    void _filter_test(void);
+    void _rate_test(void);
+    void _throughput_benchmark(void);
+
+private:
+    mavlink_message_t _attitude(int sysid, float roll);
+    mavlink_message_t _heartbeat(int sysid);
+    int _fieldIndex(const mavlink_message_t& message, const char* name);
+};
@@ -0,0 +1,231 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MockLinkLoadBenchmark.h"
+#include "MockLink.h"
+#include "MultiVehicleManager.h"
+#include "MAVLinkProtocol.h"
+#include "QGCApplication.h"
+
+#include <QEventLoop>
+#include <QFile>
+
+#include <algorithm>
+
+MockLinkLoadBenchmark::MockLinkLoadBenchmark(const QString& options)
+    : _vehicleCount(4)
+    , _fleetVehicleCount(0)
+    , _streamRate(50)
+    , _packetLossPercent(0)
+    , _jitterMSecs(0)
+    , _durationSecs(10)
+    , _maxLatencyMSecs(0)
+    , _optionsValid(false)
+    , _messageCount(0)
+    , _lastProbeUSecs(0)
+{
+    _optionsValid = _parseOptions(options);
+
+    _latencyProbeTimer.setTimerType(Qt::PreciseTimer);
+    _latencyProbeTimer.setInterval(_latencyProbeIntervalMSecs);
+    connect(&_latencyProbeTimer, &QTimer::timeout, this, &MockLinkLoadBenchmark::_latencyProbe);
+}
+
+bool MockLinkLoadBenchmark::_parseOptions(const QString& options)
+{
+    foreach (const QString& option, options.split(",", QString::SkipEmptyParts)) {
+        QStringList keyValue = option.split("=");
+        bool ok = false;
+        int value = keyValue.count() == 2 ? keyValue[1].toInt(&ok) : 0;
+
+        if (!ok || value < 0) {
+            qWarning() << "Load benchmark: invalid option" << option;
+            return false;
+        }
+
+        QString key = keyValue[0].toLower();
+        if (key == "vehicles") {
+            _vehicleCount = value;
+        } else if (key == "fleet") {
+            _fleetVehicleCount = value;
+        } else if (key == "rate") {
+            _streamRate = value;
+        } else if (key == "loss") {
+            _packetLossPercent = value;
+        } else if (key == "jitter") {
+            _jitterMSecs = value;
+        } else if (key == "duration") {
+            _durationSecs = value;
+        } else if (key == "maxlatency") {
+            _maxLatencyMSecs = value;
+        } else {
+            qWarning() << "Load benchmark: unknown option" << key;
+            return false;
+        }
+    }
+
+    // Each MockLink needs its own mavlink channel, channel 0 is never handed out
+    if (_vehicleCount < 1 || _vehicleCount >= MAVLINK_COMM_NUM_BUFFERS) {
+        qWarning() << "Load benchmark: vehicles must be between 1 and" << MAVLINK_COMM_NUM_BUFFERS - 1 << ", use fleet for more vehicles";
+        return false;
+    }
+
+    return _durationSecs > 0;
+}
+
+int MockLinkLoadBenchmark::run(void)
+{
+    if (!_optionsValid) {
+        return -1;
+    }
+
+    MultiVehicleManager*    vehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+    LinkManager*            linkMgr = qgcApp()->toolbox()->linkManager();
+    int                     totalVehicleCount = _vehicleCount * (_fleetVehicleCount + 1);
+
+    qDebug() << "Load benchmark:" << _vehicleCount << "links," << totalVehicleCount << "vehicles, stream rate" << _streamRate << "Hz, loss" << _packetLossPercent << "%, jitter" << _jitterMSecs << "msecs";
+
+    // Fleet mode keeps the additional vehicles on the telemetry only profile just like a real large fleet
+    vehicleMgr->setFleetMode(_fleetVehicleCount > 0);
+
+    qint64 startMemoryKB = _residentMemoryKB();
+
+    for (int i=0; i<_vehicleCount; i++) {
+        MockConfiguration* mockConfig = new MockConfiguration(QString("Load MockLink %1").arg(i + 1));
+
+        mockConfig->setFirmwareType(MAV_AUTOPILOT_PX4);
+        mockConfig->setVehicleType(MAV_TYPE_QUADROTOR);
+        mockConfig->setFleetVehicleCount(_fleetVehicleCount);
+        mockConfig->setStreamRate(_streamRate);
+        mockConfig->setPacketLossPercent(_packetLossPercent);
+        mockConfig->setJitterMSecs(_jitterMSecs);
+        mockConfig->setDynamic(true);
+
+        SharedLinkConfigurationPointer config = linkMgr->addConfiguration(mockConfig);
+        linkMgr->createConnectedLink(config);
+    }
+
+    int exitCode = 0;
+
+    if (_waitForVehicles(totalVehicleCount, 30000)) {
+        // Let parameter and mission loads of the initial connect finish before measuring steady state
+        _wait(5000);
+
+        connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &MockLinkLoadBenchmark::_messageReceived);
+        _messageCount = 0;
+        _latencySamplesUSecs.clear();
+        _latencySamplesUSecs.reserve((_durationSecs * 1000) / _latencyProbeIntervalMSecs);
+        _latencyProbeElapsed.start();
+        _lastProbeUSecs = 0;
+        _latencyProbeTimer.start();
+
+        QElapsedTimer measureElapsed;
+        measureElapsed.start();
+        _wait(_durationSecs * 1000);
+        double measureSecs = measureElapsed.elapsed() / 1000.0;
+
+        _latencyProbeTimer.stop();
+        disconnect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &MockLinkLoadBenchmark::_messageReceived);
+
+        std::sort(_latencySamplesUSecs.begin(), _latencySamplesUSecs.end());
+
+        qint64 endMemoryKB = _residentMemoryKB();
+        qint64 p99USecs = _percentileUSecs(0.99);
+
+        qDebug() << "Load benchmark: messages/sec" << qRound(_messageCount / measureSecs) << "per vehicle" << qRound(_messageCount / measureSecs / totalVehicleCount);
+        qDebug() << "Load benchmark: gui latency usecs p50" << _percentileUSecs(0.5) << "p95" << _percentileUSecs(0.95) << "p99" << p99USecs << "max" << _percentileUSecs(1.0);
+        if (startMemoryKB >= 0) {
+            qDebug() << "Load benchmark: resident memory KB start" << startMemoryKB << "end" << endMemoryKB << "per vehicle" << (endMemoryKB - startMemoryKB) / totalVehicleCount;
+        } else {
+            qDebug() << "Load benchmark: resident memory not available on this platform";
+        }
+
+        if (_maxLatencyMSecs > 0 && p99USecs > _maxLatencyMSecs * 1000) {
+            qWarning() << "Load benchmark: FAILED, p99 gui latency above" << _maxLatencyMSecs << "msecs";
+            exitCode = -1;
+        }
+    } else {
+        qWarning() << "Load benchmark: FAILED, only" << vehicleMgr->vehicles()->count() << "of" << totalVehicleCount << "vehicles connected";
+        exitCode = -1;
+    }
+
+    linkMgr->disconnectAll();
+    _wait(1000);
+    vehicleMgr->setFleetMode(false);
+
+    return exitCode;
+}
+
+void MockLinkLoadBenchmark::_messageReceived(LinkInterface* link, mavlink_message_t message)
+{
+    Q_UNUSED(link);
+    Q_UNUSED(message);
+
+    _messageCount++;
+}
+
+/// The probe timer fires every _latencyProbeIntervalMSecs. Any time past that is time the main thread was busy and
+/// could not service the GUI.
+void MockLinkLoadBenchmark::_latencyProbe(void)
+{
+    qint64 nowUSecs = _latencyProbeElapsed.nsecsElapsed() / 1000;
+
+    if (_lastProbeUSecs != 0) {
+        _latencySamplesUSecs.append(qMax((qint64)0, nowUSecs - _lastProbeUSecs - (_latencyProbeIntervalMSecs * 1000)));
+    }
+    _lastProbeUSecs = nowUSecs;
+}
+
+/// @return Percentile of the sorted latency samples, 0 if there are no samples
+qint64 MockLinkLoadBenchmark::_percentileUSecs(double percentile) const
+{
+    if (_latencySamplesUSecs.isEmpty()) {
+        return 0;
+    }
+
+    int index = qBound(0, (int)(percentile * _latencySamplesUSecs.count()), _latencySamplesUSecs.count() - 1);
+    return _latencySamplesUSecs[index];
+}
+
+bool MockLinkLoadBenchmark::_waitForVehicles(int vehicleCount, int timeoutMSecs)
+{
+    QmlObjectListModel* vehicles = qgcApp()->toolbox()->multiVehicleManager()->vehicles();
+
+    for (int i=0; i<timeoutMSecs / 100 && vehicles->count() < vehicleCount; i++) {
+        _wait(100);
+    }
+
+    return vehicles->count() == vehicleCount;
+}
+
+/// Runs the main thread event loop for the specified amount of time
+void MockLinkLoadBenchmark::_wait(int msecs)
+{
+    QEventLoop eventLoop;
+
+    QTimer::singleShot(msecs, &eventLoop, &QEventLoop::quit);
+    eventLoop.exec();
+}
+
+/// @return Resident memory of the process in KB, -1 if not available
+qint64 MockLinkLoadBenchmark::_residentMemoryKB(void)
+{
+    QFile statusFile("/proc/self/status");
+
+    if (statusFile.open(QIODevice::ReadOnly)) {
+        while (!statusFile.atEnd()) {
+            QString line = statusFile.readLine();
+            if (line.startsWith("VmRSS:")) {
+                return line.split(" ", QString::SkipEmptyParts).value(1).toLongLong();
+            }
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,72 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+
+#include "QGCMAVLink.h"
+
+class LinkInterface;
+
+/// End to end load benchmark. Connects a number of MockLinks with configurable stream rate, packet loss and jitter
+/// and lets their traffic run through MAVLinkProtocol into the Vehicle objects. Reports received messages per second,
+/// latency of the main (GUI) thread event loop and memory use.
+///
+/// Started from the command line with --load-benchmark[:<options>] where options is a comma separated list of:
+///     vehicles=<count>    Number of MockLinks, each with its own vehicle (default 4)
+///     fleet=<count>       Telemetry only fleet vehicles simulated on each link (default 0)
+///     rate=<hz>           High rate stream rate of each main vehicle (default 50)
+///     loss=<percent>      Packet loss percentage (default 0)
+///     jitter=<msecs>      Maximum random message delay (default 0)
+///     duration=<secs>     Length of the measurement (default 10)
+///     maxlatency=<msecs>  Fail if the 99th percentile GUI latency is above this, 0 for no limit (default 0)
+class MockLinkLoadBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    MockLinkLoadBenchmark(const QString& options);
+
+    /// Runs the benchmark and prints the report
+    ///     @return 0: success, otherwise the benchmark failed
+    int run(void);
+
+private slots:
+    void _messageReceived(LinkInterface* link, mavlink_message_t message);
+    void _latencyProbe(void);
+
+private:
+    bool    _parseOptions       (const QString& options);
+    bool    _waitForVehicles    (int vehicleCount, int timeoutMSecs);
+    void    _wait               (int msecs);
+    qint64  _percentileUSecs    (double percentile) const;
+
+    static qint64 _residentMemoryKB(void);
+
+    int     _vehicleCount;
+    int     _fleetVehicleCount;
+    int     _streamRate;
+    int     _packetLossPercent;
+    int     _jitterMSecs;
+    int     _durationSecs;
+    int     _maxLatencyMSecs;
+    bool    _optionsValid;
+
+    quint64             _messageCount;
+    QTimer              _latencyProbeTimer;
+    QElapsedTimer       _latencyProbeElapsed;
+    qint64              _lastProbeUSecs;
+    QVector<qint64>     _latencySamplesUSecs;   ///< Lateness of each probe timer callback
+
+    static const int _latencyProbeIntervalMSecs = 10;
+};
@@ -0,0 +1,205 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryStoreTest.h"
+#include "TelemetryStore.h"
+
+TelemetryStoreTest::TelemetryStoreTest(void)
+{
+
+}
+
+void TelemetryStoreTest::_intern_test(void)
+{
+    TelemetryStore store;
+    QSignalSpy seriesAddedSpy(&store, &TelemetryStore::seriesAdded);
+
+    quint64 rollKey = TelemetryStore::fieldKey(1, 1, 30, 1, 0);
+    quint64 otherSystemKey = TelemetryStore::fieldKey(2, 1, 30, 1, 0);
+    QVERIFY(rollKey != otherSystemKey);
+    QCOMPARE(store.seriesId(rollKey), -1);
+
+    int rollId = store.addSeries("M1:ATTITUDE.roll", "float", 1, TelemetryStore::ValueFloat, false, rollKey);
+    QCOMPARE(rollId, 0);
+    QCOMPARE(store.seriesId(rollKey), rollId);
+    QCOMPARE(store.seriesId(QStringLiteral("M1:ATTITUDE.roll")), rollId);
+    QCOMPARE(store.seriesId(otherSystemKey), -1);
+
+    // Adding the same name again finds the existing series
+    QCOMPARE(store.addSeries("M1:ATTITUDE.roll", "float", 1, TelemetryStore::ValueFloat, false), rollId);
+
+    int countId = store.addSeries("M2:SYS_STATUS.errors_count1", "uint16_t", 2, TelemetryStore::ValueFloat, true, otherSystemKey);
+    QCOMPARE(countId, 1);
+    QCOMPARE(store.seriesCount(), 2);
+    QCOMPARE(store.seriesSystemId(countId), 2);
+    QCOMPARE(store.seriesUnit(countId), QStringLiteral("uint16_t"));
+    QVERIFY(store.seriesInteger(countId));
+    QVERIFY(!store.seriesInteger(rollId));
+    QCOMPARE(seriesAddedSpy.count(), 2);
+
+    store.clear();
+    QCOMPARE(store.seriesCount(), 0);
+    QCOMPARE(store.seriesId(rollKey), -1);
+}
+
+void TelemetryStoreTest::_ring_test(void)
+{
+    TelemetryStore store;
+    store.setMaxSamples(100);
+    int id = store.addSeries("M1:VFR_HUD.alt", "float", 1, TelemetryStore::ValueFloat, false);
+
+    QVector<double> msecs;
+    QVector<double> values;
+    quint64 cursor = 0;
+
+    for (int i=0; i<50; i++) {
+        store.append(id, 1000 + i * 10, i);
+    }
+    cursor = store.samplesSince(id, cursor, msecs, values);
+    QCOMPARE(cursor, (quint64)50);
+    QCOMPARE(values.count(), 50);
+    QCOMPARE(values.first(), 0.0);
+    QCOMPARE(values.last(), 49.0);
+
+    // Wrap the ring, the reader only gets the samples still held
+    for (int i=50; i<300; i++) {
+        store.append(id, 1000 + i * 10, i);
+    }
+    cursor = store.samplesSince(id, cursor, msecs, values);
+    QCOMPARE(cursor, (quint64)300);
+    QCOMPARE(values.count(), 100);
+    QCOMPARE(values.first(), 200.0);
+    QCOMPARE(msecs.first(), 3000.0);
+
+    cursor = store.samplesSince(id, cursor, msecs, values);
+    QCOMPARE(values.count(), 0);
+
+    quint64 lastMSecs;
+    double lastValue;
+    QVERIFY(store.lastSample(id, lastMSecs, lastValue));
+    QCOMPARE(lastMSecs, (quint64)3990);
+    QCOMPARE(lastValue, 299.0);
+
+    // Time never goes backwards within a series
+    store.append(id, 500, -1);
+    QVERIFY(store.lastSample(id, lastMSecs, lastValue));
+    QCOMPARE(lastMSecs, (quint64)3990);
+}
+
+void TelemetryStoreTest::_window_test(void)
+{
+    TelemetryStore store;
+    int id = store.addSeries("M1:GPS_RAW_INT.lat", "int32_t", 1, TelemetryStore::ValueDouble, true);
+    store.setRetained(id, true);
+
+    // Large integers are held exactly
+    for (int i=0; i<1000; i++) {
+        store.append(id, i * 20, 473977420 + i);
+    }
+
+    QVector<double> msecs;
+    QVector<double> values;
+    QCOMPARE(store.samples(id, 1000, 2000, msecs, values), 51);
+    QCOMPARE(msecs.first(), 1000.0);
+    QCOMPARE(msecs.last(), 2000.0);
+    QCOMPARE(values.first(), 473977420.0 + 50);
+
+    // Edge samples reach one sample beyond the window
+    QCOMPARE(store.samples(id, 1001, 1019, msecs, values, true), 2);
+    QCOMPARE(msecs.first(), 1000.0);
+    QCOMPARE(msecs.last(), 1020.0);
+
+    QCOMPARE(store.samples(id, 1001, 1019, msecs, values), 0);
+    QCOMPARE(store.samples(id, 50000, 60000, msecs, values), 0);
+}
+
+void TelemetryStoreTest::_minMax_test(void)
+{
+    TelemetryStore store;
+    int id = store.addSeries("M1:RAW_IMU.xacc", "int16_t", 1, TelemetryStore::ValueFloat, true);
+    store.setRetained(id, true);
+
+    // Square wave between -1 and 1 with a single spike
+    const int sampleCount = 10000;
+    for (int i=0; i<sampleCount; i++) {
+        double value = (i / 10) % 2 ? 1 : -1;
+        if (i == 5000) {
+            value = 100;
+        }
+        store.append(id, i, value);
+    }
+
+    QVector<TelemetryStore::Bucket_t> buckets;
+
+    // Few samples in the window are returned as they are
+    QCOMPARE(store.minMax(id, 0, 99, 200, buckets), 100);
+    QCOMPARE(buckets[0].min, -1.0);
+    QCOMPARE(buckets[10].max, 1.0);
+    QCOMPARE(store.minMax(id, 1, 99, 200, buckets, true), 101);
+    QCOMPARE(buckets.first().firstMSecs, (quint64)0);
+    QCOMPARE(buckets.last().firstMSecs, (quint64)100);
+
+    // The whole series within a screen width of buckets, the spike survives decimation
+    int count = store.minMax(id, 0, sampleCount - 1, 500, buckets);
+    QVERIFY(count > 0);
+    QVERIFY(count <= 500 + 1);
+    double min = buckets[0].min;
+    double max = buckets[0].max;
+    for (int i=0; i<count; i++) {
+        min = qMin(min, buckets[i].min);
+        max = qMax(max, buckets[i].max);
+        if (i > 0) {
+            QVERIFY(buckets[i].firstMSecs > buckets[i - 1].lastMSecs);
+        }
+    }
+    QCOMPARE(min, -1.0);
+    QCOMPARE(max, 100.0);
+    QVERIFY(buckets.first().firstMSecs == 0);
+    QVERIFY(buckets.last().lastMSecs == sampleCount - 1);
+
+    // Buckets keep their first and last values so they can be drawn in order
+    QCOMPARE(buckets.first().first, -1.0);
+    QCOMPARE(buckets.last().last, 1.0);
+}
+
+void TelemetryStoreTest::_retain_test(void)
+{
+    TelemetryStore store;
+    store.setMaxSamples(1000);
+    int id = store.addSeries("M1:ATTITUDE.pitch", "float", 1, TelemetryStore::ValueFloat, false);
+
+    QVector<double> msecs;
+    QVector<double> values;
+
+    // Series which are not plotted only keep their recent samples
+    for (int i=0; i<2000; i++) {
+        store.append(id, i, i);
+    }
+    int recentCount = store.samples(id, 0, 2000, msecs, values);
+    QVERIFY(recentCount < 1000);
+    QCOMPARE(values.last(), 1999.0);
+
+    // Retaining keeps what is held and grows the history up to the maximum
+    store.setRetained(id, true);
+    store.setRetained(id, true);
+    QCOMPARE(store.samples(id, 0, 2000, msecs, values), recentCount);
+    for (int i=2000; i<4000; i++) {
+        store.append(id, i, i);
+    }
+    QCOMPARE(store.samples(id, 0, 4000, msecs, values), 1000);
+    QCOMPARE(values.first(), 3000.0);
+
+    // History is dropped once the last retention is released, the most recent samples are kept
+    store.setRetained(id, false);
+    QCOMPARE(store.samples(id, 0, 4000, msecs, values), 1000);
+    store.setRetained(id, false);
+    QCOMPARE(store.samples(id, 0, 4000, msecs, values), recentCount);
+    QCOMPARE(values.last(), 3999.0);
+    QCOMPARE(store.appendedCount(id), (quint64)4000);
+}
@@ -0,0 +1,28 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for TelemetryStore
+class TelemetryStoreTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TelemetryStoreTest(void);
+
+private slots:
+    void _intern_test(void);
+    void _ring_test(void);
+    void _window_test(void);
+    void _minMax_test(void);
+    void _retain_test(void);
+};
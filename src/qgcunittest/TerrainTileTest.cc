@@ -0,0 +1,341 @@
+/****************************************************************************
+ *
+ *   (c) 2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTileTest.h"
+#include "TerrainTile.h"
+#include "Terrain.h"
+
+#include <QtEndian>
+
+TerrainTileTest::TerrainTileTest(void)
+    : _tempDir(NULL)
+{
+
+}
+
+void TerrainTileTest::init(void)
+{
+    UnitTest::init();
+
+    _tempDir = new QTemporaryDir();
+    QVERIFY(_tempDir->isValid());
+}
+
+void TerrainTileTest::cleanup(void)
+{
+    delete _tempDir;
+    _tempDir = NULL;
+
+    UnitTest::cleanup();
+}
+
+/// Writes a square SRTM style tile. Samples are north to south, west to east.
+QString TerrainTileTest::_writeHgt(const QString& name, const QVector<qint16>& samples)
+{
+    QString path = QDir(_tempDir->path()).filePath(name);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return QString();
+    }
+    foreach (qint16 sample, samples) {
+        qint16 bigEndian = qToBigEndian(sample);
+        file.write(reinterpret_cast<const char*>(&bigEndian), sizeof(bigEndian));
+    }
+    return path;
+}
+
+/// Writes a 3x3 little endian int16 GeoTIFF with its north west pixel centered on 10N 20E and 0.5 degree pixels
+QString TerrainTileTest::_writeGeoTiff(const QString& name)
+{
+    QString path = QDir(_tempDir->path()).filePath(name);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return QString();
+    }
+
+    const int       entryCount =    11;
+    const quint32   ifdOffset =     8;
+    const quint32   ifdSize =       2 + entryCount * 12 + 4;
+    const quint32   scaleOffset =   ifdOffset + ifdSize;
+    const quint32   tieOffset =     scaleOffset + 3 * 8;
+    const quint32   dataOffset =    tieOffset + 6 * 8;
+
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    stream.writeRawData("II", 2);
+    stream << (quint16)42 << ifdOffset;
+
+    stream << (quint16)entryCount;
+    // tag, type, count, value
+    struct { quint16 tag; quint16 type; quint32 count; quint32 value; } rgEntries[entryCount] = {
+        { 256,      3,  1,  3 },            // ImageWidth
+        { 257,      3,  1,  3 },            // ImageLength
+        { 258,      3,  1,  16 },           // BitsPerSample
+        { 259,      3,  1,  1 },            // Compression
+        { 273,      4,  1,  dataOffset },   // StripOffsets
+        { 277,      3,  1,  1 },            // SamplesPerPixel
+        { 278,      3,  1,  3 },            // RowsPerStrip
+        { 279,      4,  1,  18 },           // StripByteCounts
+        { 339,      3,  1,  2 },            // SampleFormat: signed int
+        { 33550,    12, 3,  scaleOffset },  // ModelPixelScale
+        { 33922,    12, 6,  tieOffset },    // ModelTiepoint
+    };
+    for (int i=0; i<entryCount; i++) {
+        stream << rgEntries[i].tag << rgEntries[i].type << rgEntries[i].count;
+        if (rgEntries[i].type == 3 && rgEntries[i].count == 1) {
+            stream << (quint16)rgEntries[i].value << (quint16)0;
+        } else {
+            stream << rgEntries[i].value;
+        }
+    }
+    stream << (quint32)0;   // No next IFD
+
+    // PixelIsArea (the default) so the tiepoint is the corner of the north west pixel
+    stream << 0.5 << 0.5 << 0.0;
+    stream << 0.0 << 0.0 << 0.0 << 19.75 << 10.25 << 0.0;
+
+    qint16 rgSamples[9] = { 100, 200, 300, 400, 500, 600, 700, 800, 900 };
+    for (int i=0; i<9; i++) {
+        stream << rgSamples[i];
+    }
+
+    file.write(bytes);
+    return path;
+}
+
+void TerrainTileTest::_hgtBilinear_test(void)
+{
+    // 3x3 tile covering 47N-48N 8E-9E with 0.5 degree spacing
+    QVector<qint16> samples;
+    samples << 300 << 400 << 500
+            << 200 << 300 << 400
+            << 100 << 200 << 300;
+    QString path = _writeHgt(QStringLiteral("N47E008.hgt"), samples);
+
+    TerrainTile tile(path);
+    QVERIFY(tile.isValid());
+    QCOMPARE(tile.southLat(), 47.0);
+    QCOMPARE(tile.westLon(), 8.0);
+    QCOMPARE(tile.northLat(), 48.0);
+    QCOMPARE(tile.eastLon(), 9.0);
+
+    // Grid points
+    QCOMPARE(tile.elevation(47.0, 8.0), 100.0f);
+    QCOMPARE(tile.elevation(48.0, 9.0), 500.0f);
+    QCOMPARE(tile.elevation(47.5, 8.5), 300.0f);
+
+    // Plane so bilinear interpolation is exact
+    QCOMPARE(tile.elevation(47.25, 8.25), 200.0f);
+    QCOMPARE(tile.elevation(47.75, 8.75), 400.0f);
+
+    // Outside
+    QVERIFY(qIsNaN(tile.elevation(46.9, 8.5)));
+    QVERIFY(qIsNaN(tile.elevation(47.5, 9.1)));
+
+    // Batch must match single point results
+    double  rgLat[4] = { 47.1, 47.6, 47.9, 49.0 };
+    double  rgLon[4] = { 8.2, 8.3, 8.95, 8.5 };
+    float   rgElevation[4];
+    tile.elevations(rgLat, rgLon, rgElevation, 4);
+    for (int i=0; i<3; i++) {
+        QCOMPARE(rgElevation[i], tile.elevation(rgLat[i], rgLon[i]));
+    }
+    QVERIFY(qIsNaN(rgElevation[3]));
+}
+
+void TerrainTileTest::_hgtVoid_test(void)
+{
+    QVector<qint16> samples;
+    samples << -32768 << 100
+            << 100 << 100;
+    QString path = _writeHgt(QStringLiteral("S01W001.hgt"), samples);
+
+    TerrainTile tile(path);
+    QVERIFY(tile.isValid());
+    QCOMPARE(tile.southLat(), -1.0);
+    QCOMPARE(tile.westLon(), -1.0);
+
+    // A void corner is dropped from the blend instead of producing a bogus value
+    QCOMPARE(tile.elevation(-0.5, -0.5), 100.0f);
+}
+
+void TerrainTileTest::_cacheFile_test(void)
+{
+    float rgData[6] = { 10, 20, 30,
+                        40, 50, 60 };
+    QString path = QDir(_tempDir->path()).filePath(QStringLiteral("test.%1").arg(TerrainTile::cacheFileExtension));
+    QString errorString;
+    QVERIFY(TerrainTile::writeCacheFile(path, 1.0, 2.0, 0.1, 0.1, 2, 3, rgData, errorString));
+
+    TerrainTile tile(path);
+    QVERIFY(tile.isValid());
+    QCOMPARE(tile.elevation(1.1, 2.0), 10.0f);
+    QCOMPARE(tile.elevation(1.0, 2.2), 60.0f);
+    QCOMPARE(tile.elevation(1.05, 2.05), 30.0f);
+}
+
+void TerrainTileTest::_geoTiffImport_test(void)
+{
+    QString tiffPath = _writeGeoTiff(QStringLiteral("dem.tif"));
+    QString cachePath = QDir(_tempDir->path()).filePath(QStringLiteral("dem.%1").arg(TerrainTile::cacheFileExtension));
+    QString errorString;
+    QVERIFY2(TerrainTile::importGeoTiff(tiffPath, cachePath, errorString), qPrintable(errorString));
+
+    TerrainTile tile(cachePath);
+    QVERIFY(tile.isValid());
+    QCOMPARE(tile.northLat(), 10.0);
+    QCOMPARE(tile.westLon(), 20.0);
+    QCOMPARE(tile.southLat(), 9.0);
+    QCOMPARE(tile.eastLon(), 21.0);
+    QCOMPARE(tile.elevation(10.0, 20.0), 100.0f);
+    QCOMPARE(tile.elevation(9.0, 21.0), 900.0f);
+    QCOMPARE(tile.elevation(9.5, 20.5), 500.0f);
+}
+
+void TerrainTileTest::_managerBatch_test(void)
+{
+    QVector<qint16> samples;
+    samples << 300 << 400 << 500
+            << 200 << 300 << 400
+            << 100 << 200 << 300;
+    _writeHgt(QStringLiteral("N47E008.hgt"), samples);
+    _writeGeoTiff(QStringLiteral("dem.tif"));
+
+    QString cacheDir = QDir(_tempDir->path()).filePath(QStringLiteral("cache"));
+    TerrainTileManager manager;
+    manager.setDirectories(_tempDir->path(), cacheDir);
+    QCOMPARE(manager.coveredCellCount(), 4 + 4);
+
+    QList<QGeoCoordinate> coordinates;
+    coordinates << QGeoCoordinate(47.25, 8.25) << QGeoCoordinate(9.5, 20.5) << QGeoCoordinate(47.75, 8.75);
+
+    QList<float> altitudes;
+    QVERIFY(manager.elevations(coordinates, altitudes));
+    QCOMPARE(altitudes.count(), 3);
+    QCOMPARE(altitudes[0], 200.0f);
+    QCOMPARE(altitudes[1], 500.0f);
+    QCOMPARE(altitudes[2], 400.0f);
+
+    // A single uncovered coordinate makes the result incomplete but the covered ones are still filled in
+    coordinates << QGeoCoordinate(0, 0);
+    QVERIFY(!manager.elevations(coordinates, altitudes));
+    QCOMPARE(altitudes.count(), 4);
+    QCOMPARE(altitudes[0], 200.0f);
+    QVERIFY(qIsNaN(altitudes[3]));
+
+    // Converted GeoTIFF is reused from the cache on rescan
+    QCOMPARE(QDir(cacheDir).entryList(QDir::Files).count(), 1);
+    manager.rescan();
+    QVERIFY(manager.elevations(coordinates.mid(0, 3), altitudes));
+    QCOMPARE(QDir(cacheDir).entryList(QDir::Files).count(), 1);
+}
+
+void TerrainTileTest::_queryQueue_test(void)
+{
+    QVector<qint16> samples;
+    samples << 300 << 400 << 500
+            << 200 << 300 << 400
+            << 100 << 200 << 300;
+    _writeHgt(QStringLiteral("N47E008.hgt"), samples);
+
+    TerrainTileManager tileManager;
+    tileManager.setDirectories(_tempDir->path(), QDir(_tempDir->path()).filePath(QStringLiteral("cache")));
+
+    TerrainQueryManager queryManager(&tileManager);
+    queryManager.setOnlineLookupEnabled(false);
+
+    // Two providers asking for overlapping coordinates within one coalescing window share a single lookup
+    ElevationProvider provider1;
+    ElevationProvider provider2;
+    QSignalSpy spy1(&provider1, &ElevationProvider::terrainData);
+    QSignalSpy spy2(&provider2, &ElevationProvider::terrainData);
+
+    QList<QGeoCoordinate> coordinates1;
+    coordinates1 << QGeoCoordinate(47.25, 8.25) << QGeoCoordinate(47.75, 8.75) << QGeoCoordinate(47.25, 8.25);
+    QList<QGeoCoordinate> coordinates2;
+    coordinates2 << QGeoCoordinate(47.75, 8.75) << QGeoCoordinate(47.5, 8.5);
+    queryManager.addQuery(&provider1, coordinates1);
+    queryManager.addQuery(&provider2, coordinates2);
+
+    QVERIFY(spy1.wait(5000));
+    if (spy2.count() == 0) {
+        QVERIFY(spy2.wait(5000));
+    }
+    QCOMPARE(spy1.count(), 1);
+    QCOMPARE(spy2.count(), 1);
+    QCOMPARE(queryManager.lookupCount(), (quint64)1);
+    QCOMPARE(queryManager.cacheCount(), 3);
+
+    QList<QVariant> arguments = spy1.takeFirst();
+    QCOMPARE(arguments[0].toBool(), true);
+    QList<float> altitudes = arguments[1].value<QList<float>>();
+    QCOMPARE(altitudes.count(), 3);
+    QCOMPARE(altitudes[0], 200.0f);
+    QCOMPARE(altitudes[1], 400.0f);
+    QCOMPARE(altitudes[2], 200.0f);
+
+    arguments = spy2.takeFirst();
+    altitudes = arguments[1].value<QList<float>>();
+    QCOMPARE(altitudes.count(), 2);
+    QCOMPARE(altitudes[0], 400.0f);
+    QCOMPARE(altitudes[1], 300.0f);
+
+    // Repeat query is served entirely from cache
+    queryManager.resetStatistics();
+    queryManager.addQuery(&provider1, coordinates2);
+    QVERIFY(spy1.wait(5000));
+    QCOMPARE(queryManager.lookupCount(), (quint64)0);
+    QCOMPARE(queryManager.cacheHitRate(), 1.0);
+
+    // Uncovered coordinates fail when there is no online fallback
+    queryManager.addQuery(&provider2, QList<QGeoCoordinate>() << QGeoCoordinate(47.5, 8.5) << QGeoCoordinate(0, 0));
+    QVERIFY(spy2.wait(5000));
+    QCOMPARE(spy2.takeFirst()[0].toBool(), false);
+}
+
+void TerrainTileTest::_cachePinning_test(void)
+{
+    QVector<qint16> samples;
+    samples << 300 << 400 << 500
+            << 200 << 300 << 400
+            << 100 << 200 << 300;
+    _writeHgt(QStringLiteral("N47E008.hgt"), samples);
+
+    TerrainTileManager tileManager;
+    tileManager.setDirectories(_tempDir->path(), QDir(_tempDir->path()).filePath(QStringLiteral("cache")));
+
+    TerrainQueryManager queryManager(&tileManager);
+    queryManager.setOnlineLookupEnabled(false);
+    queryManager.setMaxCacheEntries(1);
+
+    // A cache smaller than the query must not evict results the query is still waiting to deliver
+    ElevationProvider provider;
+    QSignalSpy spy(&provider, &ElevationProvider::terrainData);
+
+    QList<QGeoCoordinate> coordinates;
+    coordinates << QGeoCoordinate(47.25, 8.25) << QGeoCoordinate(47.75, 8.75) << QGeoCoordinate(47.5, 8.5);
+    queryManager.addQuery(&provider, coordinates);
+
+    QVERIFY(spy.wait(5000));
+    QList<QVariant> arguments = spy.takeFirst();
+    QCOMPARE(arguments[0].toBool(), true);
+    QList<float> altitudes = arguments[1].value<QList<float>>();
+    QCOMPARE(altitudes.count(), 3);
+    QCOMPARE(altitudes[0], 200.0f);
+    QCOMPARE(altitudes[1], 400.0f);
+    QCOMPARE(altitudes[2], 300.0f);
+
+    // Once the query completed the entries are no longer pinned and the cache shrinks back to its limit
+    queryManager.addQuery(&provider, QList<QGeoCoordinate>() << QGeoCoordinate(47.4, 8.4));
+    QVERIFY(spy.wait(5000));
+    QCOMPARE(queryManager.cacheCount(), 1);
+}
@@ -0,0 +1,42 @@
+/****************************************************************************
+ *
+ *   (c) 2017 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QTemporaryDir>
+
+/// Unit test for TerrainTile and TerrainTileManager
+class TerrainTileTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TerrainTileTest(void);
+
+protected:
+    void init(void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _hgtBilinear_test(void);
+    void _hgtVoid_test(void);
+    void _cacheFile_test(void);
+    void _geoTiffImport_test(void);
+    void _managerBatch_test(void);
+    void _queryQueue_test(void);
+    void _cachePinning_test(void);
+
+private:
+    QString _writeHgt(const QString& name, const QVector<qint16>& samples);
+    QString _writeGeoTiff(const QString& name);
+
+    QTemporaryDir* _tempDir;
+};
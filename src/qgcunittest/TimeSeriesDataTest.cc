@@ -0,0 +1,116 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TimeSeriesDataTest.h"
+#include "LinechartPlot.h"
+
+#include <QtMath>
+
+TimeSeriesDataTest::TimeSeriesDataTest(void)
+{
+
+}
+
+void TimeSeriesDataTest::_rawWindow_test(void)
+{
+    TelemetryStore store;
+    int id = store.addSeries("raw", QString(), 1, TelemetryStore::ValueDouble, false);
+    TimeSeriesData data(NULL, "raw", &store, id, 60000);
+    data.setRetained(true);
+
+    for (int i=0; i<100; i++) {
+        store.append(id, i * 10, i);
+        data.append(i * 10, i * 10, i);
+    }
+
+    // Few samples are returned as they are, with one sample beyond each edge of the window
+    QVector<QPointF> points;
+    data.decimate(200, 300, 500, points);
+    QCOMPARE(points.count(), 13);
+    QCOMPARE(points.first().x(), 190.0);
+    QCOMPARE(points.last().x(), 310.0);
+
+    data.decimate(300, 200, 500, points);
+    QCOMPARE(points.count(), 0);
+
+    // Samples plotted at their receive time are shifted by the offset of the last sample
+    TimeSeriesData receiveTime(NULL, "receiveTime", &store, id, 60000);
+    receiveTime.append(990 + 1000, 990, 99);
+    receiveTime.decimate(1200, 1300, 500, points);
+    QCOMPARE(points.count(), 13);
+    QCOMPARE(points.first().x(), 1190.0);
+    QCOMPARE(points.first().y(), 19.0);
+}
+
+void TimeSeriesDataTest::_decimate_test(void)
+{
+    // An hour at 50 Hz with a single spike
+    const int sampleCount = 50 * 60 * 60;
+
+    TelemetryStore store;
+    store.setMaxSamples(sampleCount);
+    int id = store.addSeries("decimate", QString(), 1, TelemetryStore::ValueDouble, false);
+    TimeSeriesData data(NULL, "decimate", &store, id, 60 * 60 * 1000);
+    data.setRetained(true);
+
+    for (int i=0; i<sampleCount; i++) {
+        double value = qSin(i / 100.0);
+        if (i == sampleCount / 3) {
+            value = 10;
+        }
+        store.append(id, i * 20, value);
+        data.append(i * 20, i * 20, value);
+    }
+
+    const int columns = 500;
+    QVector<QPointF> points;
+    data.decimate(0, (sampleCount - 1) * 20, columns, points);
+
+    // Point count depends on the width only, the extremes are kept
+    QVERIFY(points.count() > columns);
+    QVERIFY(points.count() <= (columns + 2) * 4);
+    double min = points[0].y();
+    double max = points[0].y();
+    for (int i=0; i<points.count(); i++) {
+        min = qMin(min, points[i].y());
+        max = qMax(max, points[i].y());
+        if (i > 0) {
+            QVERIFY(points[i].x() >= points[i - 1].x());
+        }
+    }
+    QCOMPARE(max, 10.0);
+    QVERIFY(min < -0.99);
+    QCOMPARE(points.first().x(), 0.0);
+    QCOMPARE(points.last().x(), (sampleCount - 1) * 20.0);
+
+    // A narrow window is drawn from the raw samples
+    data.decimate(sampleCount / 3 * 20 - 1000, sampleCount / 3 * 20 + 1000, columns, points);
+    max = points[0].y();
+    for (int i=0; i<points.count(); i++) {
+        max = qMax(max, points[i].y());
+    }
+    QCOMPARE(max, 10.0);
+}
+
+void TimeSeriesDataTest::_average_test(void)
+{
+    TimeSeriesData data(NULL, "average", NULL, -1, 60000);
+    data.setAverageWindowSize(4);
+
+    // Large offset to check the variance keeps its precision
+    const double offset = 1e9;
+    for (int i=0; i<1001; i++) {
+        data.append(i, i, offset + (i % 4));
+    }
+
+    // Window holds the last four values: 0 + 1 + 2 + 3 in some order
+    QCOMPARE(data.getMean(), offset + 1.5);
+    QVERIFY(qAbs(data.getVariance() - 1.25) < 1e-6);
+    QCOMPARE(data.getCurrentValue(), offset);
+}
@@ -0,0 +1,26 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for the decimation and statistics of the line chart TimeSeriesData
+class TimeSeriesDataTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TimeSeriesDataTest(void);
+
+private slots:
+    void _rawWindow_test(void);
+    void _decimate_test(void);
+    void _average_test(void);
+};
@@ -0,0 +1,106 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "UASMessageHandlerTest.h"
+#include "UASMessageHandler.h"
+#include "QGCApplication.h"
+
+#include <QSignalSpy>
+
+void UASMessageHandlerTest::_ring_test(void)
+{
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+
+    UASMessageHandler* messageHandler = qgcApp()->toolbox()->uasMessageHandler();
+    messageHandler->clearMessages();
+
+    // Overfill the ring by a bit over half, every fourth message is a warning and the rest are info
+    const int cMessages = UASMessageHandler::messageCapacity + (UASMessageHandler::messageCapacity / 2) + 1;
+    for (int i=0; i<cMessages; i++) {
+        messageHandler->handleTextMessage(_vehicle->id(), MAV_COMP_ID_AUTOPILOT1, (i % 4) == 0 ? MAV_SEVERITY_WARNING : MAV_SEVERITY_INFO, QString::number(i));
+    }
+
+    // Only the newest messages are held
+    QCOMPARE(messageHandler->messageCount(), (int)UASMessageHandler::messageCapacity);
+    int firstHeld = cMessages - UASMessageHandler::messageCapacity;
+    QCOMPARE(messageHandler->message(0).getText(), QString::number(firstHeld));
+    QCOMPARE(messageHandler->message(UASMessageHandler::messageCapacity - 1).getText(), QString::number(cMessages - 1));
+
+    // Severity views only hold messages which are still in the ring, oldest first
+    int warningCount = messageHandler->severityMessageCount(MAV_SEVERITY_WARNING);
+    int infoCount = messageHandler->severityMessageCount(MAV_SEVERITY_INFO);
+    QCOMPARE(warningCount + infoCount, (int)UASMessageHandler::messageCapacity);
+    QCOMPARE(messageHandler->severityMessageCount(MAV_SEVERITY_ERROR), 0);
+    int firstWarning = firstHeld + ((4 - (firstHeld % 4)) % 4);
+    QCOMPARE(messageHandler->severityMessage(MAV_SEVERITY_WARNING, 0).getText(), QString::number(firstWarning));
+    for (int i=0; i<warningCount; i++) {
+        const UASMessage& message = messageHandler->severityMessage(MAV_SEVERITY_WARNING, i);
+        QCOMPARE(message.getSeverity(), (int)MAV_SEVERITY_WARNING);
+        QCOMPARE(message.getText(), QString::number(firstWarning + (i * 4)));
+    }
+
+    // Formatting is done on request
+    QString formatedText = messageHandler->message(0).getFormatedText();
+    QVERIFY(formatedText.contains(QStringLiteral(" Info:")) || formatedText.contains(QStringLiteral(" Warning:")));
+    QVERIFY(formatedText.contains(messageHandler->message(0).getText()));
+}
+
+void UASMessageHandlerTest::_clear_test(void)
+{
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+
+    UASMessageHandler* messageHandler = qgcApp()->toolbox()->uasMessageHandler();
+    for (int i=0; i<10; i++) {
+        messageHandler->handleTextMessage(_vehicle->id(), MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_NOTICE, QString::number(i));
+    }
+    QVERIFY(messageHandler->severityMessageCount(MAV_SEVERITY_NOTICE) >= 10);
+
+    messageHandler->clearMessages();
+    QCOMPARE(messageHandler->messageCount(), 0);
+    QCOMPARE(messageHandler->severityMessageCount(MAV_SEVERITY_NOTICE), 0);
+    QCOMPARE(messageHandler->getWarningCount(), 0);
+
+    messageHandler->handleTextMessage(_vehicle->id(), MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_NOTICE, QStringLiteral("after clear"));
+    QCOMPARE(messageHandler->messageCount(), 1);
+    QCOMPARE(messageHandler->severityMessage(MAV_SEVERITY_NOTICE, 0).getText(), QStringLiteral("after clear"));
+}
+
+void UASMessageHandlerTest::_model_test(void)
+{
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+
+    UASMessageHandler* messageHandler = qgcApp()->toolbox()->uasMessageHandler();
+    messageHandler->clearMessages();
+
+    UASMessageModel* model = messageHandler->messageModel();
+    QCOMPARE(model->rowCount(), 0);
+
+    QSignalSpy insertedSpy(model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removedSpy(model, &QAbstractItemModel::rowsRemoved);
+
+    // Rows track the ring, once it is full each new message removes the first row
+    const int cOverflow = 3;
+    for (int i=0; i<UASMessageHandler::messageCapacity + cOverflow; i++) {
+        messageHandler->handleTextMessage(_vehicle->id(), MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_INFO, QString::number(i));
+    }
+    QCOMPARE(model->rowCount(), (int)UASMessageHandler::messageCapacity);
+    QCOMPARE(model->count(), (int)UASMessageHandler::messageCapacity);
+    QCOMPARE(insertedSpy.count(), UASMessageHandler::messageCapacity + cOverflow);
+    QCOMPARE(removedSpy.count(), cOverflow);
+
+    QCOMPARE(model->data(model->index(0), UASMessageModel::TextRole).toString(), QString::number(cOverflow));
+    QCOMPARE(model->data(model->index(UASMessageHandler::messageCapacity - 1), UASMessageModel::TextRole).toString(), QString::number(UASMessageHandler::messageCapacity + cOverflow - 1));
+    QCOMPARE(model->data(model->index(0), UASMessageModel::SeverityRole).toInt(), (int)MAV_SEVERITY_INFO);
+    QCOMPARE(model->data(model->index(0), UASMessageModel::FormatedTextRole).toString(), messageHandler->message(0).getFormatedText());
+
+    QSignalSpy resetSpy(model, &QAbstractItemModel::modelReset);
+    messageHandler->clearMessages();
+    QCOMPARE(resetSpy.count(), 1);
+    QCOMPARE(model->rowCount(), 0);
+}
@@ -18,6 +18,7 @@
 #include "MAVLinkProtocol.h"
 #include "MainWindow.h"
 #include "Vehicle.h"
+#include "ParameterManager.h"
 
 #include <QTemporaryFile>
 #include <QTime>
@@ -33,6 +34,8 @@ QStringList UnitTest::_fileDialogResponse;
 enum UnitTest::FileDialogType UnitTest::_fileDialogExpectedType = getOpenFileName;
 int UnitTest::_missedFileDialogCount = 0;
 
+int UnitTest::_optInTests = 0;
+
 UnitTest::UnitTest(void)
     : _linkManager(NULL)
     , _mockLink(NULL)
@@ -119,6 +122,12 @@ void UnitTest::init(void)
     _expectMissedMessageBox = false;
     
     MAVLinkProtocol::deleteTempLogFiles();
+
+    // Parameter caches from previous tests would otherwise short circuit parameter loading
+    QDir paramCacheDir = ParameterManager::parameterCacheDir();
+    foreach (const QString& cacheFile, paramCacheDir.entryList(QDir::Files)) {
+        paramCacheDir.remove(cacheFile);
+    }
 }
 
 /// @brief Called after each test.
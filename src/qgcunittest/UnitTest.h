@@ -27,6 +27,9 @@
 
 #define UT_REGISTER_TEST(className) static UnitTestWrapper<className> className(#className);
 
+/// Skips the calling test function unless its opt-in category was requested on the command line
+#define UT_OPT_IN(optInTest) if (!UnitTest::optInEnabled(UnitTest::optInTest)) { QSKIP("Opt-in test, not requested"); }
+
 class QGCMessageBox;
 class QGCQFileDialog;
 class LinkManager;
@@ -45,6 +48,19 @@ public:
     /// @brief Called to run all the registered unit tests
     ///     @param singleTest Name of test to just run a single test
     static int run(QString& singleTest);
+
+    /// @brief Categories of tests which are skipped unless requested, see UT_OPT_IN
+    enum OptInTests {
+        optInBenchmarks =   1 << 0, ///< Timing benchmarks, --unittest-benchmarks
+        optInSlow =         1 << 1  ///< Tests which take many seconds or need local network resources, --unittest-slow
+    };
+
+    /// @brief Sets the opt-in test categories to run
+    ///     @param optInTests OptInTests flags
+    static void setOptInTests(int optInTests) { _optInTests = optInTests; }
+
+    /// @return true: tests of the specified category should run
+    static bool optInEnabled(enum OptInTests optInTest) { return _optInTests & optInTest; }
     
     /// @brief Sets up for an expected QGCMessageBox
     ///     @param response Response to take on message box
@@ -188,6 +204,8 @@ private:
     static QStringList  _fileDialogResponse;            ///< Response to next file dialog
     static enum FileDialogType _fileDialogExpectedType; ///< type of file dialog expected to show
     static int          _missedFileDialogCount;         ///< Count of file dialogs not checked with call to UnitTest::fileDialogWasDisplayed
+
+    static int          _optInTests;                    ///< OptInTests which were requested
     
     bool _unitTestRun;              ///< true: Unit Test was run
     bool _initCalled;               ///< true: UnitTest::_init was called
@@ -17,6 +17,8 @@
 #include "FlightGearTest.h"
 #include "GeoTest.h"
 #include "LinkManagerTest.h"
+#include "LogReplayLinkTest.h"
+#include "MAVLinkInspectorStatsTest.h"
 #include "MessageBoxTest.h"
 #include "MissionItemTest.h"
 #include "SimpleMissionItemTest.h"
@@ -28,16 +30,33 @@
 #include "MainWindowTest.h"
 #include "FileManagerTest.h"
 #include "TCPLinkTest.h"
+#include "TelemetryStoreTest.h"
 #include "ParameterManagerTest.h"
+#include "ParameterMetaDataStoreTest.h"
+#include "FactTest.h"
+#include "FactGroupUpdateClockTest.h"
 #include "MissionCommandTreeTest.h"
+#include "ExifParserTest.h"
 #include "LogDownloadTest.h"
+#include "LogParserTest.h"
 #include "SendMavCommandTest.h"
+#include "VehicleMessageDispatchTest.h"
 #include "VisualMissionItemTest.h"
 #include "CameraSectionTest.h"
 #include "SpeedSectionTest.h"
 #include "PlanMasterControllerTest.h"
 #include "MissionSettingsTest.h"
 #include "QGCMapPolygonTest.h"
+#include "TerrainTileTest.h"
+#include "TimeSeriesDataTest.h"
+#include "UASMessageHandlerTest.h"
+#include "TrajectoryStoreTest.h"
+#include "FleetModeTest.h"
+#include "VideoSyncIndexTest.h"
+#include "VideoStreamManagerTest.h"
+#if defined(QGC_GST_STREAMING)
+#include "TextureUploaderTest.h"
+#endif
 
 UT_REGISTER_TEST(FactSystemTestGeneric)
 UT_REGISTER_TEST(FactSystemTestPX4)
@@ -45,6 +64,8 @@ UT_REGISTER_TEST(FileDialogTest)
 UT_REGISTER_TEST(FlightGearUnitTest)
 UT_REGISTER_TEST(GeoTest)
 UT_REGISTER_TEST(LinkManagerTest)
+UT_REGISTER_TEST(LogReplayLinkTest)
+UT_REGISTER_TEST(MAVLinkInspectorStatsTest)
 UT_REGISTER_TEST(MessageBoxTest)
 UT_REGISTER_TEST(MissionItemTest)
 UT_REGISTER_TEST(SimpleMissionItemTest)
@@ -52,17 +73,34 @@ UT_REGISTER_TEST(MissionControllerTest)
 UT_REGISTER_TEST(MissionManagerTest)
 UT_REGISTER_TEST(RadioConfigTest)
 UT_REGISTER_TEST(TCPLinkTest)
+UT_REGISTER_TEST(TelemetryStoreTest)
 UT_REGISTER_TEST(FileManagerTest)
 UT_REGISTER_TEST(ParameterManagerTest)
+UT_REGISTER_TEST(ParameterMetaDataStoreTest)
+UT_REGISTER_TEST(FactTest)
+UT_REGISTER_TEST(FactGroupUpdateClockTest)
 UT_REGISTER_TEST(MissionCommandTreeTest)
+UT_REGISTER_TEST(ExifParserTest)
 UT_REGISTER_TEST(LogDownloadTest)
+UT_REGISTER_TEST(LogParserTest)
 UT_REGISTER_TEST(SendMavCommandTest)
+UT_REGISTER_TEST(VehicleMessageDispatchTest)
 UT_REGISTER_TEST(SurveyMissionItemTest)
 UT_REGISTER_TEST(CameraSectionTest)
 UT_REGISTER_TEST(SpeedSectionTest)
 UT_REGISTER_TEST(PlanMasterControllerTest)
 UT_REGISTER_TEST(MissionSettingsTest)
 UT_REGISTER_TEST(QGCMapPolygonTest)
+UT_REGISTER_TEST(TerrainTileTest)
+UT_REGISTER_TEST(TimeSeriesDataTest)
+UT_REGISTER_TEST(UASMessageHandlerTest)
+UT_REGISTER_TEST(TrajectoryStoreTest)
+UT_REGISTER_TEST(FleetModeTest)
+UT_REGISTER_TEST(VideoSyncIndexTest)
+UT_REGISTER_TEST(VideoStreamManagerTest)
+#if defined(QGC_GST_STREAMING)
+UT_REGISTER_TEST(TextureUploaderTest)
+#endif
 
 // List of unit test which are currently disabled.
 // If disabling a new test, include reason in comment.
@@ -27,12 +27,28 @@ FileManager::FileManager(QObject* parent, Vehicle* vehicle)
     , _vehicle(vehicle)
     , _dedicatedLink(NULL)
     , _activeSession(0)
-    , _missingDownloadedBytes(0)
-    , _downloadingMissingParts(false)
+    , _chunksDone(0)
+    , _nextChunk(0)
+    , _windowSize(0)
+    , _windowThreshold(0)
+    , _windowAcks(0)
+    , _maxWindowSize(windowMaxRequests)
+    , _windowTransmitCount(0)
+    , _windowReducedIndex(0)
+    , _lastRequestSentMsecs(-1)
+    , _rttValid(false)
+    , _rttMsecs(0)
+    , _rttVarMsecs(0)
+    , _rtoMsecs(ackTimerTimeoutMsecs)
     , _systemIdQGC(0)
 {
     connect(&_ackTimer, &QTimer::timeout, this, &FileManager::_ackTimeout);
     
+    _windowTimer.setInterval(_windowTimerIntervalMsecs);
+    connect(&_windowTimer, &QTimer::timeout, this, &FileManager::_windowTimeout);
+    
+    _requestTime.start();
+    
     _lastOutgoingRequest.hdr.seqNumber = 0;
 
     _systemIdServer = _vehicle->id();
@@ -41,85 +57,59 @@ FileManager::FileManager(QObject* parent, Vehicle* vehicle)
     Q_ASSERT(sizeof(RequestHeader) == 12);
 }
 
-/// Respond to the Ack associated with the Open command with the next read command.
+/// Respond to the Ack associated with the Open command by starting the read window or the burst.
 void FileManager::_openAckResponse(Request* openAck)
 {
     qCDebug(FileManagerLog) << QString("_openAckResponse: _currentOperation(%1) _readFileLength(%2)").arg(_currentOperation).arg(openAck->openFileLength);
     
 	Q_ASSERT(_currentOperation == kCOOpenRead || _currentOperation == kCOOpenBurst);
-	_currentOperation = _currentOperation == kCOOpenRead ? kCORead : kCOBurst;
     _activeSession = openAck->hdr.session;
     
     // File length comes back in data
     Q_ASSERT(openAck->hdr.size == sizeof(uint32_t));
     _downloadFileSize = openAck->openFileLength;
     
-    // Start the sequence of read commands
-
-    _downloadOffset = 0;            // Start reading at beginning of file
-    _readFileAccumulator.clear();   // Start with an empty file
-    _missingDownloadedBytes = 0;
-    _downloadingMissingParts = false;
-    _missingData.clear();
-
-    Request request;
-    request.hdr.session = _activeSession;
-	Q_ASSERT(_currentOperation == kCORead || _currentOperation == kCOBurst);
-	request.hdr.opcode = _currentOperation == kCORead ? kCmdReadFile : kCmdBurstReadFile;
-    request.hdr.offset = _downloadOffset;
-    request.hdr.size = sizeof(request.data);
-
-    _sendRequest(&request);
-}
-
-/// request the next missing part of a (partially) downloaded file
-void FileManager::_requestMissingData()
-{
-    if (_missingData.empty()) {
-        _downloadingMissingParts = false;
-        _missingDownloadedBytes = 0;
-        // there might be more data missing at the end
-        if ((uint32_t)_readFileAccumulator.length() != _downloadFileSize) {
-            _downloadOffset = _readFileAccumulator.length();
-            qCDebug(FileManagerLog) << QString("_requestMissingData: missing parts done, downloadOffset(%1) downloadFileSize(%2)")
-                    .arg(_downloadOffset).arg(_downloadFileSize);
-        } else {
-            _closeDownloadSession(true);
-            return;
-        }
+    // Chunks are stored in place as they arrive, so start with a file of the full size
+    _readFileAccumulator.fill(0, _downloadFileSize);
+    _chunkDone.fill(false, _chunkCount(_downloadFileSize));
+    _chunksDone = 0;
+    _downloadOffset = 0;
+    _burstSeqNumberEnd = _lastOutgoingRequest.hdr.seqNumber;
+
+	if (_currentOperation == kCOOpenRead) {
+        _startWindow(kCORead);
     } else {
-        qCDebug(FileManagerLog) << QString("_requestMissingData: offset(%1) size(%2)").arg(_missingData.head().offset).arg(_missingData.head().size);
-
-        _downloadOffset = _missingData.head().offset;
+        _currentOperation = kCOBurst;
+        _sendBurstRequest();
     }
+}
 
+/// Requests a burst of the file from the end of the data received so far.
+void FileManager::_sendBurstRequest(void)
+{
     Request request;
-    _currentOperation = kCORead;
     request.hdr.session = _activeSession;
-    request.hdr.opcode = kCmdReadFile;
+    request.hdr.opcode = kCmdBurstReadFile;
     request.hdr.offset = _downloadOffset;
-    request.hdr.size = sizeof(request.data);
+    request.hdr.size = 0;
 
     _sendRequest(&request);
+
+    // The server answers with one packet per remaining chunk followed by the EOF Nak, each with the next sequence number
+    _burstSeqNumberEnd = request.hdr.seqNumber + _chunkCount(_downloadFileSize - _downloadOffset) + 1;
 }
 
 /// Closes out a download session by writing the file and doing cleanup.
 ///     @param success true: successful download completion, false: error during download
 void FileManager::_closeDownloadSession(bool success)
 {
-    qCDebug(FileManagerLog) << QString("_closeDownloadSession: success(%1) missingBytes(%2)").arg(success).arg(_missingDownloadedBytes);
+    qCDebug(FileManagerLog) << QString("_closeDownloadSession: success(%1) chunks(%2/%3)").arg(success).arg(_chunksDone).arg(_chunkDone.count());
     
     _currentOperation = kCOIdle;
+    _windowTimer.stop();
+    _windowRequests.clear();
     
     if (success) {
-        if (_missingDownloadedBytes > 0 || (uint32_t)_readFileAccumulator.length() < _downloadFileSize) {
-            // we're not done yet: request the missing parts individually (either we had missing parts or
-            // the last (few) packets right before the EOF got dropped)
-            _downloadingMissingParts = true;
-            _requestMissingData();
-            return;
-        }
-
         QString downloadFilePath = _readFileDownloadDir.absoluteFilePath(_readFileDownloadFilename);
 
         QFile file(downloadFilePath);
@@ -140,6 +130,7 @@ void FileManager::_closeDownloadSession(bool success)
     }
     
     _readFileAccumulator.clear();
+    _chunkDone.clear();
     
     // Close the open session
     _sendResetCommand();
@@ -152,8 +143,11 @@ void FileManager::_closeUploadSession(bool success)
     qCDebug(FileManagerLog) << QString("_closeUploadSession: success(%1)").arg(success);
     
     _currentOperation = kCOIdle;
+    _windowTimer.stop();
+    _windowRequests.clear();
     _writeFileAccumulator.clear();
     _writeFileSize = 0;
+    _chunkDone.clear();
     
     if (success) {
         emit commandComplete();
@@ -163,72 +157,82 @@ void FileManager::_closeUploadSession(bool success)
     _sendResetCommand();
 }
 
-/// Respond to the Ack associated with the Read or Stream commands.
-///		@param readFile: true: read file, false: stream file
-void FileManager::_downloadAckResponse(Request* readAck, bool readFile)
+/// Copies the data of a Read or Burst Ack into the file being downloaded.
+/// @return false: the data does not line up with a chunk of the file or does not fit in the packet
+bool FileManager::_storeDownloadData(Request* readAck)
 {
-    if (readAck->hdr.session != _activeSession) {
-        _closeDownloadSession(false /* failure */);
-        _emitErrorMessage(tr("Download: Incorrect session returned"));
-        return;
+    uint32_t offset = readAck->hdr.offset;
+    if (readAck->hdr.size > _chunkSize || offset % _chunkSize != 0 || offset >= _downloadFileSize || readAck->hdr.size > _downloadFileSize - offset) {
+        return false;
     }
 
-    if (readAck->hdr.offset != _downloadOffset) {
-        if (readFile) {
-            _closeDownloadSession(false /* failure */);
-            _emitErrorMessage(tr("Download: Offset returned (%1) differs from offset requested/expected (%2)").arg(readAck->hdr.offset).arg(_downloadOffset));
-            return;
-        } else { // burst
-            if (readAck->hdr.offset < _downloadOffset) { // old data: ignore it
-                _setupAckTimeout();
-                return;
-            }
-            // keep track of missing data chunks
-            MissingData missingData;
-            missingData.offset = _downloadOffset;
-            missingData.size = readAck->hdr.offset - _downloadOffset;
-            _missingData.push_back(missingData);
-            _missingDownloadedBytes += readAck->hdr.offset - _downloadOffset;
-            qCDebug(FileManagerLog) << QString("_downloadAckResponse: missing data: offset(%1) size(%2)").arg(missingData.offset).arg(missingData.size);
-            _downloadOffset = readAck->hdr.offset;
-            _readFileAccumulator.resize(_downloadOffset); // placeholder for the missing data
-        }
+    memcpy(_readFileAccumulator.data() + offset, readAck->data, readAck->hdr.size);
+
+    // A short chunk is left for the read window to request again
+    int chunk = offset / _chunkSize;
+    if (readAck->hdr.size == qMin((uint32_t)_chunkSize, _downloadFileSize - offset) && !_chunkDone.testBit(chunk)) {
+        _chunkDone.setBit(chunk);
+        _chunksDone++;
+        emit commandProgress(100 * _chunksDone / _chunkDone.count());
     }
-    
-    qCDebug(FileManagerLog) << QString("_downloadAckResponse: offset(%1) size(%2) burstComplete(%3)").arg(readAck->hdr.offset).arg(readAck->hdr.size).arg(readAck->hdr.burstComplete);
-
-    if (_downloadingMissingParts) {
-        Q_ASSERT(_missingData.head().offset == _downloadOffset);
-        _missingDownloadedBytes -= readAck->hdr.size;
-        _readFileAccumulator.replace(_downloadOffset, readAck->hdr.size, (const char*)readAck->data, readAck->hdr.size);
-        if (_missingData.head().size <= readAck->hdr.size) {
-            _missingData.pop_front();
+
+    return true;
+}
+
+/// The server reported the end of the file before the length returned by the Open command, the download ends there.
+void FileManager::_truncateDownload(uint32_t fileSize)
+{
+    if (fileSize >= _downloadFileSize) {
+        return;
+    }
+
+    qCDebug(FileManagerLog) << QString("_truncateDownload: fileSize(%1) openFileLength(%2)").arg(fileSize).arg(_downloadFileSize);
+
+    _downloadFileSize = fileSize;
+    _readFileAccumulator.truncate(fileSize);
+    _chunkDone.resize(_chunkCount(fileSize));
+    _chunksDone = _chunkDone.count(true);
+    _nextChunk = qMin(_nextChunk, _chunkDone.count());
+
+    QMap<uint16_t, WindowRequest>::iterator it = _windowRequests.begin();
+    while (it != _windowRequests.end()) {
+        if (it.value().request.hdr.offset >= fileSize) {
+            it = _windowRequests.erase(it);
         } else {
-            _missingData.head().size -= readAck->hdr.size;
-            _missingData.head().offset += readAck->hdr.size;
+            ++it;
         }
-    } else {
-        _downloadOffset += readAck->hdr.size;
-        _readFileAccumulator.append((const char*)readAck->data, readAck->hdr.size);
     }
-    
-    if (_downloadFileSize != 0) {
-        emit commandProgress(100 * ((float)(_readFileAccumulator.length() - _missingDownloadedBytes) / (float)_downloadFileSize));
+}
+
+/// Respond to the Ack associated with the Burst command. Each burst packet carries the next chunk of the file.
+void FileManager::_burstAckResponse(Request* burstAck)
+{
+    if (burstAck->hdr.session != _activeSession) {
+        _closeDownloadSession(false /* failure */);
+        _emitErrorMessage(tr("Download: Incorrect session returned"));
+        return;
     }
 
-    if (_downloadingMissingParts) {
-        _requestMissingData();
-    } else if (readFile || readAck->hdr.burstComplete) {
-        // Possibly still more data to read, send next read request
+    qCDebug(FileManagerLog) << QString("_burstAckResponse: offset(%1) size(%2) burstComplete(%3)").arg(burstAck->hdr.offset).arg(burstAck->hdr.size).arg(burstAck->hdr.burstComplete);
 
-        Request request;
-        request.hdr.session = _activeSession;
-        request.hdr.opcode = readFile ? kCmdReadFile : kCmdBurstReadFile;
-        request.hdr.offset = _downloadOffset;
-        request.hdr.size = 0;
+    // Chunks lost from the burst are left to the read window, so a packet which doesn't fit is only skipped
+    if (_storeDownloadData(burstAck)) {
+        _downloadOffset = qMax(_downloadOffset, burstAck->hdr.offset + burstAck->hdr.size);
+    } else {
+        qCDebug(FileManagerLog) << "_burstAckResponse: skipping packet outside of file";
+    }
 
-        _sendRequest(&request);
-    } else if (!readFile) {
+    if (_chunksDone == _chunkDone.count()) {
+        _closeDownloadSession(true /* success */);
+    } else if (burstAck->hdr.burstComplete) {
+        if (_downloadOffset >= _downloadFileSize) {
+            // The burst reached the end of the file, read the chunks it lost
+            _startDownloadWindow();
+        } else {
+            // The server ended this burst before the end of the file, ask for the next one
+            _sendBurstRequest();
+        }
+    } else {
         // Streaming, so next ack should come automatically
         _setupAckTimeout();
     }
@@ -294,83 +298,280 @@ void FileManager::_listAckResponse(Request* listAck)
     }
 }
 
-/// @brief Respond to the Ack associated with the create command.
+/// @brief Respond to the Ack associated with the create command by starting the write window.
 void FileManager::_createAckResponse(Request* createAck)
 {
     qCDebug(FileManagerLog) << "_createAckResponse";
     
-    _currentOperation = kCOWrite;
     _activeSession = createAck->hdr.session;
 
-    // Start the sequence of write commands from the beginning of the file
+    _chunkDone.fill(false, _chunkCount(_writeFileSize));
+    _chunksDone = 0;
 
-    _writeOffset = 0;
-    _writeSize = 0;
-    
-    _writeFileDatablock();
+    _startWindow(kCOWrite);
+}
+
+/// Moves from a burst, or straight from the Open command, to reading the chunks which are missing through the window.
+void FileManager::_startDownloadWindow(void)
+{
+    // Sequence numbers the burst could still use must not be reused by the window, or a late burst packet could
+    // be taken for the answer to a read
+    if ((int16_t)(_burstSeqNumberEnd - _lastOutgoingRequest.hdr.seqNumber) > 0) {
+        _lastOutgoingRequest.hdr.seqNumber = _burstSeqNumberEnd;
+    }
+
+    _startWindow(kCORead);
+}
+
+/// Starts reading or writing all chunks which are not done yet, keeping several requests in flight.
+///     @param operation kCORead or kCOWrite
+void FileManager::_startWindow(OperationState operation)
+{
+    qCDebug(FileManagerLog) << QString("_startWindow: operation(%1) chunks(%2/%3) rto(%4)").arg(operation).arg(_chunksDone).arg(_chunkDone.count()).arg(_rtoMsecs);
+
+    _currentOperation = operation;
+    _windowRequests.clear();
+    _nextChunk = 0;
+    _windowSize = qMin((int)_windowInitialRequests, _maxWindowSize);
+    _windowThreshold = _maxWindowSize;
+    _windowAcks = 0;
+    _windowReducedIndex = _windowTransmitCount;
+    _windowTimer.start();
+
+    _fillWindow();
 }
 
-/// @brief Respond to the Ack associated with the write command.
-void FileManager::_writeAckResponse(Request* writeAck)
+/// Sends requests for the chunks not requested yet until the window is full. Completes the transfer once all chunks are done.
+void FileManager::_fillWindow(void)
 {
-    if(_writeOffset + _writeSize >= _writeFileSize){
-        _closeUploadSession(true /* success */);
+    bool read = _currentOperation == kCORead;
+
+    if (_chunksDone == _chunkDone.count()) {
+        if (read) {
+            _closeDownloadSession(true /* success */);
+        } else {
+            _closeUploadSession(true /* success */);
+        }
         return;
     }
 
-    if (writeAck->hdr.session != _activeSession) {
-        _closeUploadSession(false /* failure */);
-        _emitErrorMessage(tr("Write: Incorrect session returned"));
+    uint32_t fileSize = read ? _downloadFileSize : _writeFileSize;
+
+    while (_windowRequests.count() < _windowSize && _nextChunk < _chunkDone.count()) {
+        int chunk = _nextChunk++;
+        if (_chunkDone.testBit(chunk)) {
+            continue;
+        }
+
+        WindowRequest windowRequest;
+        Request& request = windowRequest.request;
+        uint32_t offset = chunk * _chunkSize;
+
+        request.hdr.session = _activeSession;
+        request.hdr.opcode = read ? kCmdReadFile : kCmdWriteFile;
+        request.hdr.offset = offset;
+        request.hdr.size = qMin((uint32_t)_chunkSize, fileSize - offset);
+        if (!read) {
+            memcpy(request.data, _writeFileAccumulator.constData() + offset, request.hdr.size);
+        }
+        request.hdr.seqNumber = ++_lastOutgoingRequest.hdr.seqNumber;
+
+        windowRequest.sentMsecs = _requestTime.elapsed();
+        windowRequest.timeoutMsecs = windowRequest.sentMsecs + _rtoMsecs;
+        windowRequest.transmitIndex = ++_windowTransmitCount;
+        windowRequest.tries = 0;
+        windowRequest.laterAcks = 0;
+        _windowRequests[request.hdr.seqNumber] = windowRequest;
+
+        _sendRequestNoAck(&request);
+    }
+}
+
+/// Respond to an Ack or Nak while a windowed read or write is in progress.
+void FileManager::_windowResponse(Request* response)
+{
+    bool read = _currentOperation == kCORead;
+    uint16_t requestSeqNumber = response->hdr.seqNumber - 1;
+
+    if (!_windowRequests.contains(requestSeqNumber)) {
+        // Answer to a request which was already answered, or a late burst packet
+        qCDebug(FileManagerLog) << "_windowResponse: no request in flight for seqNumber:" << response->hdr.seqNumber;
         return;
     }
+    WindowRequest windowRequest = _windowRequests.take(requestSeqNumber);
+    Request& request = windowRequest.request;
 
-    if (writeAck->hdr.offset != _writeOffset) {
-        _closeUploadSession(false /* failure */);
-        _emitErrorMessage(tr("Write: Offset returned (%1) differs from offset requested (%2)").arg(writeAck->hdr.offset).arg(_writeOffset));
+    // The answer to a retransmitted request can't be matched to one transmission, so it is not timed
+    if (windowRequest.tries == 0) {
+        _sampleRoundTrip(_requestTime.elapsed() - windowRequest.sentMsecs);
+    }
+
+    if (response->hdr.opcode == kRspNak) {
+        uint8_t errorCode = response->data[0];
+        if (read && errorCode == kErrEOF) {
+            _truncateDownload(request.hdr.offset);
+            _fillWindow();
+        } else {
+            _failWindow(tr("Nak received, error: %1").arg(errorString(errorCode)));
+        }
         return;
     }
 
-    if (writeAck->hdr.size != sizeof(uint32_t)) {
-        _closeUploadSession(false /* failure */);
-        _emitErrorMessage(tr("Write: Returned invalid size of write size data"));
+    if (response->hdr.opcode != kRspAck || response->hdr.req_opcode != request.hdr.opcode) {
+        _failWindow(tr("Unknown opcode returned from server: %1").arg(response->hdr.opcode));
+        return;
+    }
+    if (response->hdr.session != _activeSession) {
+        _failWindow(read ? tr("Download: Incorrect session returned") : tr("Write: Incorrect session returned"));
+        return;
+    }
+    if (response->hdr.offset != request.hdr.offset) {
+        _failWindow((read ? tr("Download: Offset returned (%1) differs from offset requested (%2)") : tr("Write: Offset returned (%1) differs from offset requested (%2)"))
+                    .arg(response->hdr.offset).arg(request.hdr.offset));
         return;
     }
 
+    if (read) {
+        if (response->hdr.size == 0 || response->hdr.size > request.hdr.size) {
+            _failWindow(tr("Download: Size returned (%1) differs from size requested (%2)").arg(response->hdr.size).arg(request.hdr.size));
+            return;
+        }
+        if (response->hdr.size < request.hdr.size) {
+            // A short read only happens at the end of the file
+            _truncateDownload(request.hdr.offset + response->hdr.size);
+        }
+        _storeDownloadData(response);
+    } else {
+        if (response->hdr.size != sizeof(uint32_t)) {
+            _failWindow(tr("Write: Returned invalid size of write size data"));
+            return;
+        }
+        if (response->writeFileLength != request.hdr.size) {
+            _failWindow(tr("Write: Size returned (%1) differs from size requested (%2)").arg(response->writeFileLength).arg(request.hdr.size));
+            return;
+        }
+        int chunk = request.hdr.offset / _chunkSize;
+        if (!_chunkDone.testBit(chunk)) {
+            _chunkDone.setBit(chunk);
+            _chunksDone++;
+            emit commandProgress(100 * _chunksDone / _chunkDone.count());
+        }
+    }
 
-    if( writeAck->writeFileLength !=_writeSize) {
-        _closeUploadSession(false /* failure */);
-        _emitErrorMessage(tr("Write: Size returned (%1) differs from size requested (%2)").arg(writeAck->writeFileLength).arg(_writeSize));
-        return;
+    // Slow start up to the threshold, then one more request per window of acks
+    if (_windowSize < _windowThreshold) {
+        _windowSize++;
+    } else if (++_windowAcks >= _windowSize) {
+        _windowAcks = 0;
+        _windowSize = qMin(_windowSize + 1, _maxWindowSize);
     }
 
-    _writeFileDatablock();
+    // The server answers in order, requests transmitted before this one which are still unanswered were most likely lost
+    QList<uint16_t> lostSeqNumbers;
+    QMap<uint16_t, WindowRequest>::iterator it;
+    for (it=_windowRequests.begin(); it!=_windowRequests.end(); ++it) {
+        if (it.value().transmitIndex < windowRequest.transmitIndex && ++it.value().laterAcks == _windowFastRetransmitAcks) {
+            lostSeqNumbers.append(it.key());
+        }
+    }
+    foreach (uint16_t seqNumber, lostSeqNumbers) {
+        if (!_resendWindowRequest(seqNumber)) {
+            return;
+        }
+    }
+
+    _fillWindow();
 }
 
-/// @brief Send next write file data block.
-void FileManager::_writeFileDatablock(void)
+/// @brief Called by the window timer to send the requests again whose ack timed out
+void FileManager::_windowTimeout(void)
 {
-    if (_writeOffset + _writeSize >= _writeFileSize){
-        _closeUploadSession(true /* success */);
+    qint64 nowMsecs = _requestTime.elapsed();
+
+    QList<uint16_t> timedOutSeqNumbers;
+    QMap<uint16_t, WindowRequest>::const_iterator it;
+    for (it=_windowRequests.constBegin(); it!=_windowRequests.constEnd(); ++it) {
+        if (it.value().timeoutMsecs <= nowMsecs) {
+            timedOutSeqNumbers.append(it.key());
+        }
+    }
+    if (timedOutSeqNumbers.isEmpty()) {
         return;
     }
 
-    _writeOffset += _writeSize;
+    // Back off until a request gets through without being retransmitted, which gives a new round trip sample
+    _rtoMsecs = qMin(_rtoMsecs * 2, (int)ackTimerMaxTimeoutMsecs);
 
-    Request request;
-    request.hdr.session = _activeSession;
-    request.hdr.opcode = kCmdWriteFile;
-    request.hdr.offset = _writeOffset;
+    foreach (uint16_t seqNumber, timedOutSeqNumbers) {
+        if (!_resendWindowRequest(seqNumber)) {
+            return;
+        }
+    }
+}
 
-    if(_writeFileSize -_writeOffset > sizeof(request.data) )
-        _writeSize = sizeof(request.data);
-    else
-        _writeSize = _writeFileSize - _writeOffset;
+/// Sends a request of the window again, with the same sequence number.
+/// @return false: the request ran out of retries and the transfer failed
+bool FileManager::_resendWindowRequest(uint16_t seqNumber)
+{
+    WindowRequest& windowRequest = _windowRequests[seqNumber];
 
-    request.hdr.size = _writeSize;
+    if (++windowRequest.tries > ackTimerMaxRetries) {
+        _failWindow(_currentOperation == kCORead ? tr("Timeout waiting for ack: Download failed") : tr("Timeout waiting for ack: Upload failed"));
+        return false;
+    }
 
-    memcpy(request.data, &_writeFileAccumulator.data()[_writeOffset], _writeSize);
+    qCDebug(FileManagerLog) << "_resendWindowRequest: offset:" << windowRequest.request.hdr.offset << "tries:" << windowRequest.tries;
 
-    _sendRequest(&request);
+    // Losses of requests transmitted before the last reduction belong to the loss which caused it
+    if (windowRequest.transmitIndex > _windowReducedIndex) {
+        _windowSize = qMax(_windowSize / 2, 1);
+        _windowThreshold = _windowSize;
+        _windowAcks = 0;
+        _windowReducedIndex = _windowTransmitCount;
+    }
+
+    windowRequest.timeoutMsecs = _requestTime.elapsed() + _rtoMsecs;
+    windowRequest.transmitIndex = ++_windowTransmitCount;
+    windowRequest.laterAcks = 0;
+    _sendRequestNoAck(&windowRequest.request);
+
+    return true;
+}
+
+/// Fails the windowed read or write in progress
+void FileManager::_failWindow(const QString& msg)
+{
+    if (_currentOperation == kCORead) {
+        _closeDownloadSession(false /* failure */);
+    } else {
+        _closeUploadSession(false /* failure */);
+    }
+    _emitErrorMessage(msg);
+}
+
+/// Updates the smoothed round trip time and the ack timeout following it, as TCP does (RFC 6298)
+void FileManager::_sampleRoundTrip(qint64 rttMsecs)
+{
+    if (_rttValid) {
+        _rttVarMsecs = 0.75 * _rttVarMsecs + 0.25 * qAbs(_rttMsecs - rttMsecs);
+        _rttMsecs = 0.875 * _rttMsecs + 0.125 * rttMsecs;
+    } else {
+        _rttMsecs = rttMsecs;
+        _rttVarMsecs = rttMsecs / 2.0;
+        _rttValid = true;
+    }
+    _resetAckTimeoutMsecs();
+}
+
+/// Sets the ack timeout from the round trip estimate, dropping any back off. Called at the start of each
+/// operation so a timeout backed off by an earlier operation does not delay reporting a failure of this one.
+void FileManager::_resetAckTimeoutMsecs(void)
+{
+    if (_rttValid) {
+        _rtoMsecs = qBound((int)ackTimerTimeoutMsecs, qRound(_rttMsecs + 4 * _rttVarMsecs), (int)ackTimerMaxTimeoutMsecs);
+    } else {
+        _rtoMsecs = ackTimerTimeoutMsecs;
+    }
 }
 
 void FileManager::receiveMessage(mavlink_message_t message)
@@ -391,6 +592,12 @@ void FileManager::receiveMessage(mavlink_message_t message)
     
     Request* request = (Request*)&data.payload[0];
 
+    if (_currentOperation == kCORead || _currentOperation == kCOWrite) {
+        // Windowed transfers have several requests in flight, responses are matched to them by sequence number
+        _windowResponse(request);
+        return;
+    }
+
     uint16_t incomingSeqNumber = request->hdr.seqNumber;
     
     // Make sure we have a good sequence number
@@ -406,19 +613,20 @@ void FileManager::receiveMessage(mavlink_message_t message)
     
 	qCDebug(FileManagerLog) << "receiveMessage" << request->hdr.opcode;
 	
+    if (incomingSeqNumber == expectedSeqNumber && _lastRequestSentMsecs >= 0) {
+        // The answer to a retried request can't be matched to one transmission, so it is not timed
+        if (_ackNumTries == 0) {
+            _sampleRoundTrip(_requestTime.elapsed() - _lastRequestSentMsecs);
+        }
+        _lastRequestSentMsecs = -1;
+    }
+	
     if (incomingSeqNumber != expectedSeqNumber) {
         bool doAbort = true;
         switch (_currentOperation) {
-            case kCOBurst: // burst download drops are handled in _downloadAckResponse()
+            case kCOBurst: // burst download drops are filled in by the read window
                 doAbort = false;
                 break;
-            case kCORead:
-                _closeDownloadSession(false /* failure */);
-                break;
-            
-            case kCOWrite:
-                _closeUploadSession(false /* failure */);
-                break;
                 
             case kCOOpenRead:
             case kCOOpenBurst:
@@ -454,20 +662,12 @@ void FileManager::receiveMessage(mavlink_message_t message)
 				_openAckResponse(request);
 				break;
 				
-			case kCmdReadFile:
-				_downloadAckResponse(request, true /* read file */);
-				break;
-				
 			case kCmdBurstReadFile:
-				_downloadAckResponse(request, false /* stream file */);
+				_burstAckResponse(request);
 				break;
 				
             case kCmdCreateFile:
                 _createAckResponse(request);
-                break;
-                
-            case kCmdWriteFile:
-                _writeAckResponse(request);
                 break;
                 
 			default:
@@ -487,9 +687,9 @@ void FileManager::receiveMessage(mavlink_message_t message)
             // This is not an error, just the end of the list loop
             emit commandComplete();
             return;
-        } else if ((request->hdr.req_opcode == kCmdReadFile || request->hdr.req_opcode == kCmdBurstReadFile) && errorCode == kErrEOF) {
-            // This is not an error, just the end of the download loop
-            _closeDownloadSession(true /* success */);
+        } else if (request->hdr.req_opcode == kCmdBurstReadFile && errorCode == kErrEOF) {
+            // This is not an error, just the end of the burst. Read the chunks it lost.
+            _startDownloadWindow();
             return;
         } else if (request->hdr.req_opcode == kCmdCreateFile) {
             _emitErrorMessage(tr("Nak received creating file, error: %1").arg(errorString(request->data[0])));
@@ -532,6 +732,7 @@ void FileManager::listDirectory(const QString& dirPath)
     _listPath = dirPath;
     _listOffset = 0;
     _currentOperation = kCOList;
+    _resetAckTimeoutMsecs();
 
     // and send the initial request
     _sendListCommand();
@@ -613,6 +814,7 @@ void FileManager::_downloadWorker(const QString& from, const QDir& downloadDir,
 	_readFileDownloadFilename = from.right(from.size() - i);
 	
 	_currentOperation = readFile ? kCOOpenRead : kCOOpenBurst;
+	_resetAckTimeoutMsecs();
 	
 	Request request;
 	request.hdr.session = 0;
@@ -665,6 +867,7 @@ void FileManager::uploadPath(const QString& toPath, const QFileInfo& uploadFile)
     }
 
     _currentOperation = kCOCreate;
+    _resetAckTimeoutMsecs();
 
     Request request;
     request.hdr.session = 0;
@@ -683,6 +886,7 @@ void FileManager::createDirectory(const QString& directory)
     }
 
     _currentOperation = kCOCreateDir;
+    _resetAckTimeoutMsecs();
 
     Request request;
     request.hdr.session = 0;
@@ -739,6 +943,7 @@ bool FileManager::_sendOpcodeOnlyCmd(uint8_t opcode, OperationState newOpState)
     request.hdr.size = 0;
 
     _currentOperation = newOpState;
+    _resetAckTimeoutMsecs();
 
     _sendRequest(&request);
 
@@ -754,7 +959,7 @@ void FileManager::_setupAckTimeout(void)
 
     _ackNumTries = 0;
     _ackTimer.setSingleShot(false);
-    _ackTimer.start(ackTimerTimeoutMsecs);
+    _ackTimer.start(_rtoMsecs);
 }
 
 /// @brief Clears the ack timeout timer
@@ -769,21 +974,16 @@ void FileManager::_ackTimeout(void)
 {
     qCDebug(FileManagerLog) << "_ackTimeout";
     
+    if (_currentOperation == kCOBurst) {
+        // The burst stalled, read whatever it did not deliver through the read window
+        _clearAckTimeout();
+        _startDownloadWindow();
+        return;
+    }
+    
     if (++_ackNumTries <= ackTimerMaxRetries) {
         qCDebug(FileManagerLog) << "ack timeout - retrying";
-        if (_currentOperation == kCOBurst) {
-            // for burst downloads try to initiate a new burst
-            Request request;
-            request.hdr.session = _activeSession;
-            request.hdr.opcode = kCmdBurstReadFile;
-            request.hdr.offset = _downloadOffset;
-            request.hdr.size = 0;
-            request.hdr.seqNumber = ++_lastOutgoingRequest.hdr.seqNumber;
-
-            _sendRequestNoAck(&request);
-        } else {
-            _sendRequestNoAck(&_lastOutgoingRequest);
-        }
+        _sendRequestNoAck(&_lastOutgoingRequest);
         return;
     }
 
@@ -794,12 +994,6 @@ void FileManager::_ackTimeout(void)
     // to idle. FileView UI works this way with the List command.
 
     switch (_currentOperation) {
-        case kCORead:
-        case kCOBurst:
-            _closeDownloadSession(false /* failure */);
-            _emitErrorMessage(tr("Timeout waiting for ack: Download failed"));
-            break;
-            
         case kCOOpenRead:
         case kCOOpenBurst:
             _currentOperation = kCOIdle;
@@ -813,11 +1007,6 @@ void FileManager::_ackTimeout(void)
             _sendResetCommand();
             break;
             
-        case kCOWrite:
-            _closeUploadSession(false /* failure */);
-            _emitErrorMessage(tr("Timeout waiting for ack: Upload failed"));
-            break;
-			
         default:
         {
             OperationState currentOperation = _currentOperation;
@@ -855,6 +1044,7 @@ void FileManager::_sendRequest(Request* request)
     _setupAckTimeout();
     
     request->hdr.seqNumber = ++_lastOutgoingRequest.hdr.seqNumber;
+    _lastRequestSentMsecs = _requestTime.elapsed();
     // store the current request
     if (request->hdr.size <= sizeof(request->data)) {
         memcpy(&_lastOutgoingRequest, request, sizeof(RequestHeader) + request->hdr.size);
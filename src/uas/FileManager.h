@@ -14,7 +14,9 @@
 #include <QObject>
 #include <QDir>
 #include <QTimer>
-#include <QQueue>
+#include <QMap>
+#include <QBitArray>
+#include <QElapsedTimer>
 
 #include "UASInterface.h"
 #include "QGCLoggingCategory.h"
@@ -41,12 +43,21 @@ public:
     bool _sendCmdTestAck(void) { return _sendOpcodeOnlyCmd(kCmdNone, kCOAck); };
     bool _sendCmdTestNoAck(void) { return _sendOpcodeOnlyCmd(kCmdTestNoAck, kCOAck); };
     
-    /// Timeout in msecs to wait for an Ack time come back. This is public so we can write unit tests which wait long enough
-    /// for the FileManager to timeout.
+    /// Shortest timeout in msecs to wait for an Ack time come back. The timeout follows the measured round trip time
+    /// from there. This is public so we can write unit tests which wait long enough for the FileManager to timeout.
     static const int ackTimerTimeoutMsecs = 50;
 
+    /// Longest timeout in msecs to wait for an Ack, reached on slow links or while backing off after timeouts
+    static const int ackTimerMaxTimeoutMsecs = 2000;
+
     static const int ackTimerMaxRetries = 6;
 
+    /// Largest number of read or write requests a transfer keeps in flight
+    static const int windowMaxRequests = 16;
+
+    /// Limits the number of read or write requests kept in flight, 1 sends one request at a time
+    void setMaxWindowSize(int maxWindowSize) { _maxWindowSize = qBound(1, maxWindowSize, (int)windowMaxRequests); }
+
 	/// Downloads the specified file.
 	///     @param from File to download from UAS, fully qualified path
 	///     @param downloadDir Local directory to download file to
@@ -91,6 +102,7 @@ public slots:
 	
 private slots:
 	void _ackTimeout(void);
+    void _windowTimeout(void);
 
 private:
     /// @brief This is the fixed length portion of the protocol data.
@@ -128,6 +140,13 @@ private:
         };
     }) Request;
 
+    /// Files are transferred in chunks of the largest data size fitting a Request
+    static const uint32_t _chunkSize = sizeof(((Request*)0)->data);
+
+    static const int _windowInitialRequests = 4;        ///< Requests in flight at the start of a transfer
+    static const int _windowFastRetransmitAcks = 3;     ///< A request is sent again once this many later requests were acked
+    static const int _windowTimerIntervalMsecs = 10;    ///< Resolution of the window timeouts
+
     enum Opcode
 	{
 		kCmdNone,				///< ignored, always acked
@@ -192,17 +211,27 @@ private:
     void _sendRequestNoAck(Request* request);
     void _fillRequestWithString(Request* request, const QString& str);
     void _openAckResponse(Request* openAck);
-    void _downloadAckResponse(Request* readAck, bool readFile);
+    void _burstAckResponse(Request* burstAck);
     void _listAckResponse(Request* listAck);
     void _createAckResponse(Request* createAck);
-    void _writeAckResponse(Request* writeAck);
-    void _writeFileDatablock(void);
     void _sendListCommand(void);
     void _sendResetCommand(void);
+    void _sendBurstRequest(void);
     void _closeDownloadSession(bool success);
     void _closeUploadSession(bool success);
     void _downloadWorker(const QString& from, const QDir& downloadDir, bool readFile);
-    void _requestMissingData();
+    bool _storeDownloadData(Request* readAck);
+    void _truncateDownload(uint32_t fileSize);
+    void _startDownloadWindow(void);
+    void _startWindow(OperationState operation);
+    void _fillWindow(void);
+    void _windowResponse(Request* response);
+    bool _resendWindowRequest(uint16_t seqNumber);
+    void _failWindow(const QString& msg);
+    void _sampleRoundTrip(qint64 rttMsecs);
+    void _resetAckTimeoutMsecs(void);
+    
+    static int _chunkCount(uint32_t fileSize) { return (fileSize + _chunkSize - 1) / _chunkSize; }
     
     static QString errorString(uint8_t errorCode);
 
@@ -222,24 +251,45 @@ private:
     
     uint32_t    _readOffset;                ///< current read offset
     
-    uint32_t    _writeOffset;               ///< current write offset
-    uint32_t    _writeSize;                 ///< current write data size
     uint32_t    _writeFileSize;             ///< Size of file being uploaded
     QByteArray  _writeFileAccumulator;      ///< Holds file being uploaded
     
-    struct MissingData {
-        uint32_t offset;
-        uint32_t size;
-    };
-    uint32_t    _downloadOffset;            ///< current download offset
-    uint32_t    _missingDownloadedBytes;    ///< number of missing bytes for burst download
-    QQueue<MissingData> _missingData;       ///< missing chunks of downloaded file (for burst downloads)
-    bool        _downloadingMissingParts;   ///< true if we are currently downloading missing parts
-    QByteArray  _readFileAccumulator;       ///< Holds file being downloaded
+    uint32_t    _downloadOffset;            ///< End of the data received by the current burst
+    uint16_t    _burstSeqNumberEnd;         ///< Last sequence number the server can use for the current burst
+    QByteArray  _readFileAccumulator;       ///< Holds file being downloaded, sized to the file so chunks can arrive in any order
     QDir        _readFileDownloadDir;       ///< Directory to download file to
     QString     _readFileDownloadFilename;  ///< Filename (no path) for download file
     uint32_t    _downloadFileSize;          ///< Size of file being downloaded
 
+    /// A read or write request of the window, waiting for its Ack
+    struct WindowRequest {
+        Request     request;
+        qint64      sentMsecs;          ///< Time of the first transmission
+        qint64      timeoutMsecs;       ///< Time the request is sent again
+        quint32     transmitIndex;      ///< Order of the latest transmission among all window transmissions
+        int         tries;              ///< Number of retransmissions
+        int         laterAcks;          ///< Acks of requests transmitted later, since this one was transmitted
+    };
+
+    QBitArray   _chunkDone;                 ///< One bit per chunk of the file: received for downloads, acked for uploads
+    int         _chunksDone;                ///< Number of bits set in _chunkDone
+    int         _nextChunk;                 ///< Chunks below this were requested by the window already
+    QMap<uint16_t, WindowRequest> _windowRequests;  ///< Requests in flight keyed by sequence number
+    QTimer      _windowTimer;               ///< Checks the requests in flight for timeouts
+    int         _windowSize;                ///< Number of requests currently allowed in flight
+    int         _windowThreshold;           ///< The window doubles each round trip below this size, grows by one above it
+    int         _windowAcks;                ///< Acks since the window last grew, used above _windowThreshold
+    int         _maxWindowSize;
+    quint32     _windowTransmitCount;       ///< Number of window transmissions so far
+    quint32     _windowReducedIndex;        ///< _windowTransmitCount at the last window reduction
+
+    QElapsedTimer   _requestTime;           ///< Clock for round trip times
+    qint64          _lastRequestSentMsecs;  ///< Transmission of _lastOutgoingRequest, -1 once answered
+    bool            _rttValid;              ///< true: a round trip time was measured
+    double          _rttMsecs;              ///< Smoothed round trip time
+    double          _rttVarMsecs;           ///< Round trip time variation
+    int             _rtoMsecs;              ///< Current ack timeout
+
     uint8_t     _systemIdQGC;               ///< System ID for QGC
     uint8_t     _systemIdServer;            ///< System ID for server
     
@@ -19,14 +19,26 @@
 #include "MultiVehicleManager.h"
 #include "UAS.h"
 
-UASMessage::UASMessage(int componentid, int severity, QString text)
+UASMessage::UASMessage(void)
+    : _compId(0)
+    , _severity(MAV_SEVERITY_INFO)
+    , _timestamp(0)
+    , _showComponent(false)
 {
-    _compId   = componentid;
-    _severity = severity;
-    _text     = text;
+
 }
 
-bool UASMessage::severityIsError()
+UASMessage::UASMessage(int componentid, int severity, QString text, qint64 timestamp, bool showComponent)
+    : _compId(componentid)
+    , _severity(severity)
+    , _text(text)
+    , _timestamp(timestamp)
+    , _showComponent(showComponent)
+{
+
+}
+
+bool UASMessage::severityIsError() const
 {
     switch (_severity) {
         case MAV_SEVERITY_EMERGENCY:
@@ -39,18 +51,80 @@ bool UASMessage::severityIsError()
     }
 }
 
+QString UASMessage::_severityText(int severity)
+{
+    switch (severity)
+    {
+    case MAV_SEVERITY_EMERGENCY:
+        return UASMessageHandler::tr(" EMERGENCY:");
+    case MAV_SEVERITY_ALERT:
+        return UASMessageHandler::tr(" ALERT:");
+    case MAV_SEVERITY_CRITICAL:
+        return UASMessageHandler::tr(" Critical:");
+    case MAV_SEVERITY_ERROR:
+        return UASMessageHandler::tr(" Error:");
+    case MAV_SEVERITY_WARNING:
+        return UASMessageHandler::tr(" Warning:");
+    case MAV_SEVERITY_NOTICE:
+        return UASMessageHandler::tr(" Notice:");
+    case MAV_SEVERITY_INFO:
+        return UASMessageHandler::tr(" Info:");
+    case MAV_SEVERITY_DEBUG:
+        return UASMessageHandler::tr(" Debug:");
+    default:
+        return QString();
+    }
+}
+
+QString UASMessage::getFormatedText() const
+{
+    // Color the output depending on the message severity. We have 3 distinct cases:
+    // 1: If we have an ERROR or worse, make it bigger, bolder, and highlight it red.
+    // 2: If we have a warning or notice, just make it bold and color it orange.
+    // 3: Otherwise color it the standard color, white.
+    QString style;
+    switch (_severity)
+    {
+    case MAV_SEVERITY_EMERGENCY:
+    case MAV_SEVERITY_ALERT:
+    case MAV_SEVERITY_CRITICAL:
+    case MAV_SEVERITY_ERROR:
+        style = QStringLiteral("<#E>");
+        break;
+    case MAV_SEVERITY_NOTICE:
+    case MAV_SEVERITY_WARNING:
+        style = QStringLiteral("<#I>");
+        break;
+    default:
+        style = QStringLiteral("<#N>");
+        break;
+    }
+
+    // Prepend the properly-styled text with a timestamp.
+    QString dateString = QDateTime::fromMSecsSinceEpoch(_timestamp).toString("hh:mm:ss.zzz");
+    QString compString;
+    if (_showComponent) {
+        compString = QString(" COMP:%1").arg(_compId);
+    }
+    return QString("<font style=\"%1\">[%2%3]%4 %5</font><br/>").arg(style).arg(dateString).arg(compString).arg(_severityText(_severity)).arg(_text);
+}
+
 UASMessageHandler::UASMessageHandler(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
     , _activeVehicle(NULL)
     , _activeComponent(-1)
     , _multiComp(false)
+    , _ring(messageCapacity)
+    , _messageSequence(0)
     , _errorCount(0)
     , _errorCountTotal(0)
     , _warningCount(0)
     , _normalCount(0)
     , _showErrorsInToolbar(false)
     , _multiVehicleManager(NULL)
+    , _messageModel(NULL)
 {
+    _messageModel = new UASMessageModel(this);
 
 }
 
@@ -72,18 +146,40 @@ void UASMessageHandler::setToolbox(QGCToolbox *toolbox)
 
 void UASMessageHandler::clearMessages()
 {
-    _mutex.lock();
-    while(_messages.count()) {
-        delete _messages.last();
-        _messages.pop_back();
+    // Old ring entries are simply overwritten, only release the text they hold
+    for (int i=0; i<messageCount(); i++) {
+        _ring[(_firstMessageSequence() + i) & _messageRingMask]._text.clear();
+    }
+    _messageSequence = 0;
+    for (int i=0; i<_severityCount; i++) {
+        _severityRings[i].first = 0;
+        _severityRings[i].end = 0;
     }
-    _errorCount   = 0;
-    _warningCount = 0;
-    _normalCount  = 0;
-    _mutex.unlock();
+    _errorCount.store(0);
+    _warningCount.store(0);
+    _normalCount.store(0);
+    _messageModel->_reset();
     emit textMessageCountChanged(0);
 }
 
+/// Messages with severities outside of MAV_SEVERITY are kept with the debug messages
+int UASMessageHandler::_severityIndex(int severity)
+{
+    return severity >= 0 && severity < _severityCount ? severity : MAV_SEVERITY_DEBUG;
+}
+
+int UASMessageHandler::severityMessageCount(int severity) const
+{
+    const SeverityRing& severityRing = _severityRings[_severityIndex(severity)];
+    return (int)(severityRing.end - severityRing.first);
+}
+
+const UASMessage& UASMessageHandler::severityMessage(int severity, int index) const
+{
+    const SeverityRing& severityRing = _severityRings[_severityIndex(severity)];
+    return _ring[severityRing.sequences[(severityRing.first + index) & _messageRingMask] & _messageRingMask];
+}
+
 void UASMessageHandler::_activeVehicleChanged(Vehicle* vehicle)
 {
     // If we were already attached to an autopilot, disconnect it.
@@ -110,13 +206,6 @@ void UASMessageHandler::handleTextMessage(int, int compId, int severity, QString
         return;
     }
 
-    // Color the output depending on the message severity. We have 3 distinct cases:
-    // 1: If we have an ERROR or worse, make it bigger, bolder, and highlight it red.
-    // 2: If we have a warning or notice, just make it bold and color it orange.
-    // 3: Otherwise color it the standard color, white.
-
-    _mutex.lock();
-
     if (_activeComponent < 0) {
         _activeComponent = compId;
     }
@@ -125,115 +214,134 @@ void UASMessageHandler::handleTextMessage(int, int compId, int severity, QString
         _multiComp = true;
     }
 
-    // So first determine the styling based on the severity.
-    QString style;
     switch (severity)
     {
     case MAV_SEVERITY_EMERGENCY:
     case MAV_SEVERITY_ALERT:
     case MAV_SEVERITY_CRITICAL:
     case MAV_SEVERITY_ERROR:
-        style = QString("<#E>");
-        _errorCount++;
-        _errorCountTotal++;
+        _errorCount.ref();
+        _errorCountTotal.ref();
         break;
     case MAV_SEVERITY_NOTICE:
     case MAV_SEVERITY_WARNING:
-        style = QString("<#I>");
-        _warningCount++;
-        break;
-    default:
-        style = QString("<#N>");
-        _normalCount++;
-        break;
-    }
-
-    // And determine the text for the severitie
-    QString severityText("");
-    switch (severity)
-    {
-    case MAV_SEVERITY_EMERGENCY:
-        severityText = QString(tr(" EMERGENCY:"));
-        break;
-    case MAV_SEVERITY_ALERT:
-        severityText = QString(tr(" ALERT:"));
-        break;
-    case MAV_SEVERITY_CRITICAL:
-        severityText = QString(tr(" Critical:"));
-        break;
-    case MAV_SEVERITY_ERROR:
-        severityText = QString(tr(" Error:"));
-        break;
-    case MAV_SEVERITY_WARNING:
-        severityText = QString(tr(" Warning:"));
-        break;
-    case MAV_SEVERITY_NOTICE:
-        severityText = QString(tr(" Notice:"));
-        break;
-    case MAV_SEVERITY_INFO:
-        severityText = QString(tr(" Info:"));
-        break;
-    case MAV_SEVERITY_DEBUG:
-        severityText = QString(tr(" Debug:"));
+        _warningCount.ref();
         break;
     default:
-        severityText = QString(tr(""));
+        _normalCount.ref();
         break;
     }
 
-    // Finally preppend the properly-styled text with a timestamp.
-    QString dateString = QDateTime::currentDateTime().toString("hh:mm:ss.zzz");
-    UASMessage* message = new UASMessage(compId, severity, text);
-    QString compString("");
-    if (_multiComp) {
-        compString = QString(" COMP:%1").arg(compId);
+    // When the ring is full the new message replaces the oldest one, which is also the oldest of its severity
+    UASMessage& message = _ring[_messageSequence & _messageRingMask];
+    if (_messageSequence >= (quint64)messageCapacity) {
+        _messageModel->_removeOldest();
+        _severityRings[_severityIndex(message._severity)].first++;
     }
-    message->_setFormatedText(QString("<font style=\"%1\">[%2%3]%4 %5</font><br/>").arg(style).arg(dateString).arg(compString).arg(severityText).arg(text));
+    message = UASMessage(compId, severity, text, QDateTime::currentMSecsSinceEpoch(), _multiComp);
 
-    if (message->severityIsError()) {
-        _latestError = severityText + " " + text;
+    SeverityRing& severityRing = _severityRings[_severityIndex(severity)];
+    if (severityRing.sequences.isEmpty()) {
+        severityRing.sequences.resize(messageCapacity);
     }
+    severityRing.sequences[severityRing.end & _messageRingMask] = _messageSequence;
+    severityRing.end++;
 
-    _mutex.unlock();
+    _messageSequence++;
+    _messageModel->_appended();
 
-    emit textMessageReceived(message);
+    if (message.severityIsError()) {
+        _latestError = UASMessage::_severityText(severity) + " " + text;
+    }
 
-    _messages.append(message);
-    int count = _messages.count();
-    emit textMessageCountChanged(count);
+    emit textMessageReceived(&message);
+    emit textMessageCountChanged(messageCount());
 
-    if (_showErrorsInToolbar && message->severityIsError()) {
-        _app->showMessage(message->getText());
+    if (_showErrorsInToolbar && message.severityIsError()) {
+        _app->showMessage(message.getText());
     }
 }
 
 int UASMessageHandler::getErrorCountTotal() {
-    _mutex.lock();
-    int c = _errorCountTotal;
-    _mutex.unlock();
-    return c;
+    return _errorCountTotal.load();
 }
 
 int UASMessageHandler::getErrorCount() {
-    _mutex.lock();
-    int c = _errorCount;
-    _errorCount = 0;
-    _mutex.unlock();
-    return c;
+    return _errorCount.fetchAndStoreRelaxed(0);
 }
 
 int UASMessageHandler::getWarningCount() {
-    _mutex.lock();
-    int c = _warningCount;
-    _warningCount = 0;
-    _mutex.unlock();
-    return c;
+    return _warningCount.fetchAndStoreRelaxed(0);
 }
 
 int UASMessageHandler::getNormalCount() {
-    _mutex.lock();
-    int c = _normalCount;
-    _normalCount = 0;
-    _mutex.unlock();
-    return c;
+    return _normalCount.fetchAndStoreRelaxed(0);
+}
+
+UASMessageModel::UASMessageModel(UASMessageHandler* messageHandler)
+    : QAbstractListModel(messageHandler)
+    , _messageHandler(messageHandler)
+    , _count(0)
+{
+
+}
+
+int UASMessageModel::rowCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return _count;
+}
+
+QVariant UASMessageModel::data(const QModelIndex& index, int role) const
+{
+    if (index.row() < 0 || index.row() >= _count) {
+        return QVariant();
+    }
+
+    // While the oldest message is being replaced the handler may hold one message more than the views know about
+    const UASMessage& message = _messageHandler->message(index.row() + _messageHandler->messageCount() - _count);
+    switch (role) {
+    case TextRole:
+        return message.getText();
+    case FormatedTextRole:
+        return message.getFormatedText();
+    case SeverityRole:
+        return message.getSeverity();
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> UASMessageModel::roleNames(void) const
+{
+    QHash<int, QByteArray> roles;
+    roles[TextRole] =           "text";
+    roles[FormatedTextRole] =   "formatedText";
+    roles[SeverityRole] =       "severity";
+    return roles;
+}
+
+/// Called before the oldest message is overwritten by a new one
+void UASMessageModel::_removeOldest(void)
+{
+    beginRemoveRows(QModelIndex(), 0, 0);
+    _count--;
+    endRemoveRows();
+}
+
+/// Called once a new message has been appended to the ring
+void UASMessageModel::_appended(void)
+{
+    beginInsertRows(QModelIndex(), _count, _count);
+    _count++;
+    endInsertRows();
+    emit countChanged(_count);
+}
+
+void UASMessageModel::_reset(void)
+{
+    beginResetModel();
+    _count = _messageHandler->messageCount();
+    endResetModel();
+    emit countChanged(_count);
 }
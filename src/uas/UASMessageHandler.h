@@ -18,8 +18,9 @@
 #define QGCMESSAGEHANDLER_H
 
 #include <QObject>
+#include <QAbstractListModel>
 #include <QVector>
-#include <QMutex>
+#include <QAtomicInt>
 
 #include "Vehicle.h"
 #include "QGCToolbox.h"
@@ -37,36 +38,89 @@ class UASMessage
 {
     friend class UASMessageHandler;
 public:
+    UASMessage(void);
+
     /**
      * @brief Get message source component ID
      */
-    int getComponentID()        { return _compId; }
+    int getComponentID() const  { return _compId; }
     /**
      * @brief Get message severity (from MAV_SEVERITY_XXX enum)
      */
-    int getSeverity()           { return _severity; }
+    int getSeverity() const     { return _severity; }
     /**
      * @brief Get message text (e.g. "[pm] sending list")
      */
-    QString getText()           { return _text; }
+    QString getText() const     { return _text; }
     /**
      * @brief Get (html) formatted text (in the form: "[11:44:21.137 - COMP:50] Info: [pm] sending list")
+     *
+     * The text is formatted on each call, it is not stored with the message.
      */
-    QString getFormatedText()   { return _formatedText; }
+    QString getFormatedText() const;
     /**
      * @return true: This message is a of a severity which is considered an error
      */
-    bool severityIsError();
+    bool severityIsError() const;
 
 private:
-    UASMessage(int componentid, int severity, QString text);
-    void _setFormatedText(const QString formatedText) { _formatedText = formatedText; }
-    int _compId;
-    int _severity;
+    UASMessage(int componentid, int severity, QString text, qint64 timestamp, bool showComponent);
+
+    static QString _severityText(int severity);
+
+    int     _compId;
+    int     _severity;
     QString _text;
-    QString _formatedText;
+    qint64  _timestamp;         ///< Receive time, msecs since epoch
+    bool    _showComponent;     ///< true: multiple components were sending messages when this one arrived
 };
 
+/// List model over the messages held by UASMessageHandler, oldest first. Rows are formatted on request so views only
+/// pay for the rows they show.
+class UASMessageModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum UASMessageModelRoles {
+        TextRole = Qt::UserRole + 1,
+        FormatedTextRole,
+        SeverityRole,
+    };
+
+    UASMessageModel(UASMessageHandler* messageHandler);
+
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+    int count(void) const { return _count; }
+
+    // Overrides from QAbstractListModel
+    int         rowCount    (const QModelIndex& parent = QModelIndex()) const override;
+    QVariant    data        (const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+signals:
+    void countChanged(int count);
+
+protected:
+    QHash<int, QByteArray> roleNames(void) const override;
+
+private:
+    void _removeOldest  (void);
+    void _appended      (void);
+    void _reset         (void);
+
+    UASMessageHandler*  _messageHandler;
+    int                 _count;             ///< Number of rows views know about
+
+    friend class UASMessageHandler;
+};
+
+/// Keeps the most recent text messages of the active vehicle.
+///
+/// Messages are held in a fixed size ring buffer, once it is full the oldest message is dropped for each new one.
+/// Each MAV_SEVERITY has its own ring of message sequence numbers so severity filtered views can be paged in O(1)
+/// as well. Messages arrive and are read on the GUI thread; the new message counters are atomic so they can be read
+/// and reset without a lock.
 class UASMessageHandler : public QGCTool
 {
     Q_OBJECT
@@ -76,17 +130,27 @@ public:
     ~UASMessageHandler();
 
     /**
-     * @brief Locks access to the message list
+     * @brief Number of messages currently held, at most messageCapacity
+     */
+    int messageCount() const { return (int)(_messageSequence - _firstMessageSequence()); }
+    /**
+     * @brief Access a held message
+     * @param index 0 is the oldest held message, messageCount() - 1 the newest
+     */
+    const UASMessage& message(int index) const { return _ring[(_firstMessageSequence() + index) & _messageRingMask]; }
+    /**
+     * @brief Number of held messages with the specified MAV_SEVERITY
      */
-    void lockAccess()   {_mutex.lock(); }
+    int severityMessageCount(int severity) const;
     /**
-     * @brief Unlocks access to the message list
+     * @brief Access a held message with the specified MAV_SEVERITY
+     * @param index 0 is the oldest held message of that severity
      */
-    void unlockAccess() {_mutex.unlock(); }
+    const UASMessage& severityMessage(int severity, int index) const;
     /**
-     * @brief Access to the message list
+     * @brief List model over the held messages, used by the QML message views
      */
-    const QVector<UASMessage*>& messages() { return _messages; }
+    UASMessageModel* messageModel() { return _messageModel; }
     /**
      * @brief Clear messages
      */
@@ -118,6 +182,8 @@ public:
     // Override from QGCTool
     virtual void setToolbox(QGCToolbox *toolbox);
 
+    static const int messageCapacity = 2048;    ///< Maximum number of messages held, must be a power of 2
+
 public slots:
     /**
      * @brief Handle text message from current active UAS
@@ -131,7 +197,7 @@ public slots:
 signals:
     /**
      * @brief Sent out when new message arrives
-     * @param message A pointer to the message. NULL if resetting (new UAS assigned)
+     * @param message A pointer to the message, only valid during the signal. NULL if resetting (new UAS assigned)
      */
     void textMessageReceived(UASMessage* message);
     /**
@@ -144,18 +210,34 @@ private slots:
     void _activeVehicleChanged(Vehicle* vehicle);
 
 private:
+    quint64 _firstMessageSequence() const { return _messageSequence > (quint64)messageCapacity ? _messageSequence - messageCapacity : 0; }
+    static int _severityIndex(int severity);
+
+    static const int _messageRingMask = messageCapacity - 1;
+    static const int _severityCount = MAV_SEVERITY_DEBUG + 1;
+
+    /// Sequence numbers of the held messages of a single severity, oldest first
+    struct SeverityRing {
+        SeverityRing(void) : first(0), end(0) { }
+        QVector<quint64>    sequences;  ///< Allocated on first message of the severity
+        quint64             first;      ///< Sequence index of the oldest held entry
+        quint64             end;        ///< Sequence index one past the newest entry
+    };
+
     Vehicle*                _activeVehicle;
     int                     _activeComponent;
     bool                    _multiComp;
-    QVector<UASMessage*>    _messages;
-    QMutex                  _mutex;
-    int                     _errorCount;
-    int                     _errorCountTotal;
-    int                     _warningCount;
-    int                     _normalCount;
+    QVector<UASMessage>     _ring;
+    quint64                 _messageSequence;   ///< Number of messages appended since the last clear
+    SeverityRing            _severityRings[_severityCount];
+    QAtomicInt              _errorCount;
+    QAtomicInt              _errorCountTotal;
+    QAtomicInt              _warningCount;
+    QAtomicInt              _normalCount;
     QString                 _latestError;
     bool                    _showErrorsInToolbar;
     MultiVehicleManager*    _multiVehicleManager;
+    UASMessageModel*        _messageModel;
 };
 
 #endif // QGCMESSAGEHANDLER_H
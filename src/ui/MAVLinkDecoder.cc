@@ -2,6 +2,83 @@
 #include "MAVLinkDecoder.h"
 
 #include <QDebug>
+#include <QMetaMethod>
+
+/// @return Value of element index of a numeric field
+static double _fieldValue(const uint8_t* m, uint8_t type, int index)
+{
+    switch (type) {
+    case MAVLINK_TYPE_UINT8_T:
+        return m[index];
+    case MAVLINK_TYPE_INT8_T:
+        return ((const int8_t*)m)[index];
+    case MAVLINK_TYPE_UINT16_T:
+        return ((const uint16_t*)m)[index];
+    case MAVLINK_TYPE_INT16_T:
+        return ((const int16_t*)m)[index];
+    case MAVLINK_TYPE_UINT32_T:
+        return ((const uint32_t*)m)[index];
+    case MAVLINK_TYPE_INT32_T:
+        return ((const int32_t*)m)[index];
+    case MAVLINK_TYPE_FLOAT:
+        return ((const float*)m)[index];
+    case MAVLINK_TYPE_DOUBLE:
+        return ((const double*)m)[index];
+    case MAVLINK_TYPE_UINT64_T:
+        return (double)((const uint64_t*)m)[index];
+    case MAVLINK_TYPE_INT64_T:
+        return (double)((const int64_t*)m)[index];
+    default:
+        return 0;
+    }
+}
+
+/// @return Type name used as the unit of a field, as emitted with valueChanged
+static QString _fieldTypeName(const mavlink_field_info_t& field)
+{
+    QString typeName;
+
+    switch (field.type) {
+    case MAVLINK_TYPE_UINT8_T:
+        typeName = "uint8_t";
+        break;
+    case MAVLINK_TYPE_INT8_T:
+        typeName = "int8_t";
+        break;
+    case MAVLINK_TYPE_UINT16_T:
+        typeName = "uint16_t";
+        break;
+    case MAVLINK_TYPE_INT16_T:
+        typeName = "int16_t";
+        break;
+    case MAVLINK_TYPE_UINT32_T:
+        typeName = "uint32_t";
+        break;
+    case MAVLINK_TYPE_INT32_T:
+        typeName = "int32_t";
+        break;
+    case MAVLINK_TYPE_FLOAT:
+        typeName = "float";
+        break;
+    case MAVLINK_TYPE_DOUBLE:
+        typeName = "double";
+        break;
+    case MAVLINK_TYPE_UINT64_T:
+        typeName = "uint64_t";
+        break;
+    case MAVLINK_TYPE_INT64_T:
+        typeName = "int64_t";
+        break;
+    default:
+        break;
+    }
+
+    if (field.array_length > 0) {
+        typeName = QString("%1[%2]").arg(typeName).arg(field.array_length);
+    }
+
+    return typeName;
+}
 
 MAVLinkDecoder::MAVLinkDecoder(MAVLinkProtocol* protocol) :
     QThread(), creationThread(QThread::currentThread())
@@ -101,10 +178,38 @@ void MAVLinkDecoder::receiveMessage(LinkInterface* link,mavlink_message_t messag
     // Align UAS time to global time
     time = getUnixTimeFromMs(message.sysid, time);
 
+    // create new system data if it wasn't dectected yet
+    if (!sysDict.contains(msgid)) {
+        sysDict[msgid] = SystemData();
+    }
+
+    // Store component ID
+    if (sysDict[msgid].componentID == -1)
+    {
+        sysDict[msgid].componentID = message.compid;
+    }
+    else
+    {
+        // Got this message already
+        if (sysDict[msgid].componentID != message.compid)
+        {
+            sysDict[msgid].componentMulti = true;
+        }
+    }
+
+    // Values always go to the telemetry store, the signal per value is only emitted while someone listens to it
+    static const QMetaMethod valueChangedSignal = QMetaMethod::fromSignal(&MAVLinkDecoder::valueChanged);
+    static const QMetaMethod textMessageReceivedSignal = QMetaMethod::fromSignal(&MAVLinkDecoder::textMessageReceived);
+    bool emitValues = isSignalConnected(valueChangedSignal) || isSignalConnected(textMessageReceivedSignal);
+
     // Send out all field values for this message
     for (unsigned int i = 0; i < msgInfo->num_fields; ++i)
     {
-        emitFieldValue(&message, i, time);
+        storeFieldValue(&message, i, time);
+        if (emitValues)
+        {
+            emitFieldValue(&message, i, time);
+        }
     }
 
     // Send out combined math expressions
@@ -189,43 +294,15 @@ quint64 MAVLinkDecoder::getUnixTimeFromMs(int systemID, quint64 time)
     return ret;
 }
 
-void MAVLinkDecoder::emitFieldValue(mavlink_message_t* msg, int fieldid, quint64 time)
+QString MAVLinkDecoder::valueName(mavlink_message_t* msg, int fieldid, quint64& time)
 {
-    bool multiComponentSourceDetected = false;
     const mavlink_message_info_t* msgInfo = mavlink_get_message_info(msg);
 
     uint32_t msgid = msg->msgid;
+    bool multiComponentSourceDetected = sysDict[msgid].componentMulti;
 
-    // create new system data if it wasn't dectected yet
-    if (!(sysDict.keys().contains(msgid))) {
-        sysDict[msgid] = SystemData();
-    }
-
-    // Store component ID
-    if (sysDict[msgid].componentID == -1)
-    {
-        sysDict[msgid].componentID = msg->compid;
-    }
-    else
-    {
-        // Got this message already
-        if (sysDict[msgid].componentID != msg->compid)
-        {
-            sysDict[msgid].componentMulti = true;
-        }
-    }
-
-    if (sysDict[msgid].componentMulti == true) {
-        multiComponentSourceDetected = true;
-    }
-
-    // Add field tree widget item
-    if (messageFilter.contains(msgid)) return;
     QString fieldName(msgInfo->fields[fieldid].name);
-    QString fieldType;
-    uint8_t* m = (uint8_t*)(msgDict[msgid].payload64);
     QString name("%1.%2");
-    QString unit("");
 
     // Debug vector messages
     if (msgid == MAVLINK_MSG_ID_DEBUG_VECT)
@@ -301,6 +378,83 @@ void MAVLinkDecoder::emitFieldValue(mavlink_message_t* msg, int fieldid, quint64
 
     name = name.prepend(QString("M%1:").arg(msg->sysid));
 
+    return name;
+}
+
+void MAVLinkDecoder::storeFieldValue(mavlink_message_t* msg, int fieldid, quint64 time)
+{
+    uint32_t msgid = msg->msgid;
+    if (messageFilter.contains(msgid)) return;
+
+    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(msg);
+    const mavlink_field_info_t& field = msgInfo->fields[fieldid];
+
+    // Text is not a time series
+    if (field.type == MAVLINK_TYPE_CHAR) return;
+
+    const uint8_t* m = (const uint8_t*)(msg->payload64) + field.wire_offset;
+    int valueCount = field.array_length > 0 ? field.array_length : 1;
+
+    // These messages name their values from their payload, so their series are found by name. They are debug and
+    // low rate messages, all other series are found by field without building their name.
+    bool namedByPayload = msgid == MAVLINK_MSG_ID_DEBUG_VECT || msgid == MAVLINK_MSG_ID_DEBUG ||
+            msgid == MAVLINK_MSG_ID_NAMED_VALUE_FLOAT || msgid == MAVLINK_MSG_ID_NAMED_VALUE_INT ||
+            msgid == MAVLINK_MSG_ID_RC_CHANNELS_RAW || msgid == MAVLINK_MSG_ID_RC_CHANNELS_SCALED ||
+            msgid == MAVLINK_MSG_ID_SERVO_OUTPUT_RAW;
+    QString name;
+    if (namedByPayload)
+    {
+        name = valueName(msg, fieldid, time);
+    }
+
+    for (int j = 0; j < valueCount; ++j)
+    {
+        int seriesId;
+        quint64 fieldKey = 0;
+        if (namedByPayload)
+        {
+            seriesId = _telemetryStore.seriesId(field.array_length > 0 ? QString("%1.%2").arg(name).arg(j) : name);
+        }
+        else
+        {
+            fieldKey = TelemetryStore::fieldKey(msg->sysid, msg->compid, msgid, fieldid, j);
+            seriesId = _telemetryStore.seriesId(fieldKey);
+        }
+
+        if (seriesId == -1)
+        {
+            if (name.isEmpty())
+            {
+                name = valueName(msg, fieldid, time);
+            }
+            bool floatValue = field.type == MAVLINK_TYPE_FLOAT || field.type == MAVLINK_TYPE_DOUBLE;
+            bool smallValue = field.type == MAVLINK_TYPE_FLOAT || field.type == MAVLINK_TYPE_UINT8_T || field.type == MAVLINK_TYPE_INT8_T ||
+                    field.type == MAVLINK_TYPE_UINT16_T || field.type == MAVLINK_TYPE_INT16_T;
+            seriesId = _telemetryStore.addSeries(field.array_length > 0 ? QString("%1.%2").arg(name).arg(j) : name,
+                                                 _fieldTypeName(field),
+                                                 msg->sysid,
+                                                 smallValue ? TelemetryStore::ValueFloat : TelemetryStore::ValueDouble,
+                                                 !floatValue,
+                                                 fieldKey);
+        }
+
+        _telemetryStore.append(seriesId, time, _fieldValue(m, field.type, j));
+    }
+}
+
+void MAVLinkDecoder::emitFieldValue(mavlink_message_t* msg, int fieldid, quint64 time)
+{
+    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(msg);
+
+    uint32_t msgid = msg->msgid;
+
+    // Add field tree widget item
+    if (messageFilter.contains(msgid)) return;
+    QString fieldType;
+    uint8_t* m = (uint8_t*)(msgDict[msgid].payload64);
+    QString unit("");
+    QString name = valueName(msg, fieldid, time);
+
     switch (msgInfo->fields[fieldid].type)
     {
     case MAVLINK_TYPE_CHAR:
@@ -5,6 +5,7 @@
 #include <QHash>
 
 #include "MAVLinkProtocol.h"
+#include "TelemetryStore.h"
 
 struct SystemData {
     /**
@@ -32,6 +33,9 @@ public:
 
     void run();
 
+    /// Numeric field values of all received messages, read directly by plots instead of a valueChanged signal per value
+    TelemetryStore* telemetryStore(void) { return &_telemetryStore; }
+
 signals:
     void textMessageReceived(int uasid, int componentid, int severity, const QString& text);
     void valueChanged(const int uasId, const QString& name, const QString& unit, const QVariant& value, const quint64 msec);
@@ -43,6 +47,10 @@ public slots:
 protected:
     /** @brief Emit the value of one message field */
     void emitFieldValue(mavlink_message_t* msg, int fieldid, quint64 time);
+    /** @brief Append the value of one message field to the telemetry store */
+    void storeFieldValue(mavlink_message_t* msg, int fieldid, quint64 time);
+    /** @brief Name of one message field, messages carrying their own timestamp update time */
+    QString valueName(mavlink_message_t* msg, int fieldid, quint64& time);
     /** @brief Shift a timestamp in Unix time if necessary */
     quint64 getUnixTimeFromMs(int systemID, quint64 time);
 
@@ -51,6 +59,7 @@ protected:
     QHash<int, mavlink_message_t> msgDict; ///< dictionary of all mavlink messages
     QHash<int, SystemData> sysDict; ///< dictionary of all systmes
     QThread* creationThread;                                ///< QThread on which the object is created
+    TelemetryStore _telemetryStore;
 };
 
 #endif // MAVLINKDECODER_H
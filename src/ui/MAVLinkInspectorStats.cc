@@ -0,0 +1,222 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkInspectorStats.h"
+#include "QGC.h"
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+#include <limits>
+
+const float MAVLinkInspectorStats::rateLowpass = 0.2f;
+
+/// @return Value of a numeric non array field
+static double _fieldValue(const mavlink_message_t& message, const mavlink_field_info_t& field)
+{
+    const uint8_t* m = (const uint8_t*)&message.payload64[0] + field.wire_offset;
+
+    switch (field.type) {
+    case MAVLINK_TYPE_UINT8_T:
+        return *m;
+    case MAVLINK_TYPE_INT8_T:
+        return *(const int8_t*)m;
+    case MAVLINK_TYPE_UINT16_T:
+        return *(const uint16_t*)m;
+    case MAVLINK_TYPE_INT16_T:
+        return *(const int16_t*)m;
+    case MAVLINK_TYPE_UINT32_T:
+        return *(const uint32_t*)m;
+    case MAVLINK_TYPE_INT32_T:
+        return *(const int32_t*)m;
+    case MAVLINK_TYPE_FLOAT:
+        return *(const float*)m;
+    case MAVLINK_TYPE_DOUBLE:
+        return *(const double*)m;
+    case MAVLINK_TYPE_UINT64_T:
+        return (double)*(const uint64_t*)m;
+    case MAVLINK_TYPE_INT64_T:
+        return (double)*(const int64_t*)m;
+    default:
+        return 0;
+    }
+}
+
+MAVLinkInspectorStats::MAVLinkInspectorStats(QObject* parent)
+    : QThread(parent)
+    , _filterSysid(0)
+    , _filterCompid(0)
+    , _stop(false)
+{
+    _queue.reserve(1024);
+    _aggregating.reserve(1024);
+}
+
+MAVLinkInspectorStats::~MAVLinkInspectorStats()
+{
+    stop();
+}
+
+void MAVLinkInspectorStats::stop(void)
+{
+    if (isRunning()) {
+        {
+            QMutexLocker lock(&_queueMutex);
+            _stop = true;
+            _queueWait.wakeAll();
+        }
+        wait();
+        _stop = false;
+    }
+}
+
+void MAVLinkInspectorStats::queueMessage(const mavlink_message_t& message)
+{
+    QMutexLocker lock(&_queueMutex);
+
+    if ((_filterSysid != 0 && _filterSysid != message.sysid) || (_filterCompid != 0 && _filterCompid != message.compid)) {
+        return;
+    }
+    if (_queue.count() < maxQueuedMessages) {
+        _queue.append(message);
+    }
+}
+
+void MAVLinkInspectorStats::setFilter(int sysid, int compid)
+{
+    QMutexLocker lock(&_queueMutex);
+    _filterSysid = sysid;
+    _filterCompid = compid;
+}
+
+void MAVLinkInspectorStats::clear(void)
+{
+    {
+        QMutexLocker lock(&_queueMutex);
+        _queue.clear();
+    }
+    QMutexLocker lock(&_statsMutex);
+    _stats.clear();
+    _changed.clear();
+}
+
+QList<MAVLinkInspectorStats::MessageStats_t> MAVLinkInspectorStats::takeChanged(void)
+{
+    QList<MessageStats_t> changed;
+
+    QMutexLocker lock(&_statsMutex);
+    foreach (quint64 messageKey, _changed) {
+        changed.append(_stats[messageKey]);
+    }
+    _changed.clear();
+
+    return changed;
+}
+
+void MAVLinkInspectorStats::aggregate(void)
+{
+    {
+        QMutexLocker lock(&_queueMutex);
+        _queue.swap(_aggregating);
+    }
+    if (_aggregating.isEmpty()) {
+        return;
+    }
+
+    quint64 receiveMSecs = QGC::groundTimeMilliseconds();
+    {
+        QMutexLocker lock(&_statsMutex);
+        for (int i=0; i<_aggregating.count(); i++) {
+            _aggregateMessage(_aggregating[i], receiveMSecs);
+        }
+    }
+
+    // clear() keeps the allocation for the next swap
+    _aggregating.clear();
+}
+
+/// Called with _statsMutex held
+void MAVLinkInspectorStats::_aggregateMessage(const mavlink_message_t& message, quint64 receiveMSecs)
+{
+    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(&message);
+    if (!msgInfo) {
+        return;
+    }
+
+    quint64 messageKey = key(message.sysid, message.msgid);
+    QHash<quint64, MessageStats_t>::iterator it = _stats.find(messageKey);
+    if (it == _stats.end()) {
+        MessageStats_t stats;
+        stats.intervalCount = 0;
+        stats.hz = 0;
+        stats.generation = 0;
+        stats.fieldMin.fill(std::numeric_limits<double>::max(), msgInfo->num_fields);
+        stats.fieldMax.fill(-std::numeric_limits<double>::max(), msgInfo->num_fields);
+        it = _stats.insert(messageKey, stats);
+    }
+
+    MessageStats_t& stats = it.value();
+    stats.message = message;
+    stats.intervalCount++;
+    stats.lastReceiveMSecs = receiveMSecs;
+    stats.generation++;
+    for (unsigned int i=0; i<msgInfo->num_fields && (int)i<stats.fieldMin.count(); i++) {
+        const mavlink_field_info_t& field = msgInfo->fields[i];
+        if (field.array_length == 0 && field.type != MAVLINK_TYPE_CHAR) {
+            double value = _fieldValue(message, field);
+            stats.fieldMin[i] = qMin(stats.fieldMin[i], value);
+            stats.fieldMax[i] = qMax(stats.fieldMax[i], value);
+        }
+    }
+    _changed.insert(messageKey);
+}
+
+void MAVLinkInspectorStats::updateRates(int elapsedMSecs)
+{
+    if (elapsedMSecs <= 0) {
+        return;
+    }
+
+    QMutexLocker lock(&_statsMutex);
+    QHash<quint64, MessageStats_t>::iterator it;
+    for (it=_stats.begin(); it!=_stats.end(); ++it) {
+        MessageStats_t& stats = it.value();
+        float previousHz = stats.hz;
+        stats.hz = (1.0f - rateLowpass) * stats.hz + rateLowpass * stats.intervalCount / (elapsedMSecs / 1000.0f);
+        stats.intervalCount = 0;
+        // Rates are shown with one decimal, smaller changes don't need a refresh
+        if (qRound(stats.hz * 10) != qRound(previousHz * 10)) {
+            stats.generation++;
+            _changed.insert(it.key());
+        }
+    }
+}
+
+void MAVLinkInspectorStats::run(void)
+{
+    QElapsedTimer rateTimer;
+    rateTimer.start();
+
+    _queueMutex.lock();
+    while (!_stop) {
+        _queueWait.wait(&_queueMutex, aggregateInterval);
+        if (_stop) {
+            break;
+        }
+        _queueMutex.unlock();
+
+        aggregate();
+        if (rateTimer.elapsed() >= rateInterval) {
+            updateRates(rateTimer.restart());
+        }
+
+        _queueMutex.lock();
+    }
+    _queueMutex.unlock();
+}
@@ -0,0 +1,91 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QList>
+
+#include "QGCMAVLink.h"
+
+/// Per message statistics for the MAVLink inspector.
+///
+/// Received messages are only queued on the GUI thread. A worker thread aggregates them into one entry per system and
+/// message id holding the last message, the rate and the range of each numeric field. The inspector takes the entries
+/// which changed since its last refresh, so its cost depends on the number of message ids and not on the traffic.
+class MAVLinkInspectorStats : public QThread
+{
+    Q_OBJECT
+
+public:
+    MAVLinkInspectorStats(QObject* parent = NULL);
+    ~MAVLinkInspectorStats();
+
+    typedef struct {
+        mavlink_message_t   message;            ///< Last received message
+        quint32             intervalCount;      ///< Messages received since the last rate update
+        float               hz;                 ///< Low pass filtered rate
+        quint64             lastReceiveMSecs;
+        quint32             generation;         ///< Incremented on every change, lets the view skip unchanged rows
+        QVector<double>     fieldMin;           ///< Range of each field, only valid for numeric non array fields
+        QVector<double>     fieldMax;
+    } MessageStats_t;
+
+    static quint64 key(int sysid, quint32 msgid) { return ((quint64)sysid << 32) | msgid; }
+
+    /// Queues a received message for aggregation. Only copies the message, called from the GUI thread.
+    void queueMessage(const mavlink_message_t& message);
+
+    /// @return Stats of the messages which changed since the previous call
+    QList<MessageStats_t> takeChanged(void);
+
+    /// Only messages from this system and component are kept, 0 for all
+    void setFilter(int sysid, int compid);
+
+    /// Drops all stats and queued messages
+    void clear(void);
+
+    /// Aggregates the queued messages, normally called from the worker thread
+    void aggregate(void);
+
+    /// Updates the rate of each message from the messages received over elapsedMSecs
+    void updateRates(int elapsedMSecs);
+
+    /// Stops the worker thread, called by the destructor
+    void stop(void);
+
+    static const int        aggregateInterval = 100;    ///< msecs
+    static const int        rateInterval = 1000;        ///< msecs
+    static const int        maxQueuedMessages = 20000;  ///< Messages beyond this are dropped if the worker falls behind
+    static const float      rateLowpass;
+
+protected:
+    // Override from QThread
+    void run(void);
+
+private:
+    void _aggregateMessage(const mavlink_message_t& message, quint64 receiveMSecs);
+
+    QMutex                      _queueMutex;
+    QWaitCondition              _queueWait;
+    QVector<mavlink_message_t>  _queue;
+    QVector<mavlink_message_t>  _aggregating;       ///< Swapped with _queue so the GUI thread keeps its allocation
+    int                         _filterSysid;
+    int                         _filterCompid;
+    bool                        _stop;
+
+    QMutex                          _statsMutex;
+    QHash<quint64, MessageStats_t>  _stats;
+    QSet<quint64>                   _changed;
+};
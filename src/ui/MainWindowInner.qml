@@ -31,7 +31,6 @@ Item {
     property var    currentPopUp:       null
     property real   currentCenterX:     0
     property var    activeVehicle:      QGroundControl.multiVehicleManager.activeVehicle
-    property string formatedMessage:    activeVehicle ? activeVehicle.formatedMessage : ""
 
     property var _viewList: [ settingsViewLoader, setupViewLoader, planViewLoader, flightView, analyzeViewLoader ]
 
@@ -207,17 +206,11 @@ Item {
         message = message.replace(new RegExp("<#E>", "g"), "color: #f95e5e; font: " + (ScreenTools.defaultFontPointSize.toFixed(0) - 1) + "pt monospace;");
         message = message.replace(new RegExp("<#I>", "g"), "color: #f9b55e; font: " + (ScreenTools.defaultFontPointSize.toFixed(0) - 1) + "pt monospace;");
         message = message.replace(new RegExp("<#N>", "g"), "color: #ffffff; font: " + (ScreenTools.defaultFontPointSize.toFixed(0) - 1) + "pt monospace;");
+        //-- Each message is shown in its own row
+        message = message.replace(new RegExp("<br/>$"), "");
         return message;
     }
 
-    onFormatedMessageChanged: {
-        if(messageArea.visible) {
-            messageText.append(formatMessage(formatedMessage))
-            //-- Hack to scroll down
-            messageFlick.flick(0,-500)
-        }
-    }
-
     function showMessageArea() {
         rootLoader.sourceComponent = null
         var currentlyVisible = messageArea.visible
@@ -226,16 +219,11 @@ Item {
         }
         if(!currentlyVisible) {
             if(QGroundControl.multiVehicleManager.activeVehicleAvailable) {
-                messageText.text = formatMessage(activeVehicle.formatedMessages)
-                //-- Hack to scroll to last message
-                for (var i = 0; i < activeVehicle.messageCount; i++)
-                    messageFlick.flick(0,-5000)
                 activeVehicle.resetMessages()
-            } else {
-                messageText.text = qsTr("No Messages")
             }
             currentPopUp = messageArea
             messageArea.visible = true
+            messageList.positionViewAtEnd()
         }
     }
 
@@ -392,7 +380,6 @@ Item {
         id:                 messageArea
         function close() {
             currentPopUp = null
-            messageText.text    = ""
             messageArea.visible = false
         }
         width:              mainWindow.width  * 0.5
@@ -412,21 +399,35 @@ Item {
             preventStealing:    true
             onWheel:            wheel.accepted = true
         }
-        QGCFlickable {
-            id:                 messageFlick
+        //-- Only the visible rows are formatted
+        QGCListView {
+            id:                 messageList
             anchors.margins:    ScreenTools.defaultFontPixelHeight
             anchors.fill:       parent
-            contentHeight:      messageText.height
-            contentWidth:       messageText.width
             pixelAligned:       true
             clip:               true
-            TextEdit {
-                id:             messageText
-                readOnly:       true
-                textFormat:     TextEdit.RichText
+            model:              activeVehicle ? activeVehicle.messageModel : 0
+            onCountChanged: {
+                if(messageArea.visible) {
+                    positionViewAtEnd()
+                }
+            }
+            delegate: Text {
+                width:          messageList.width
+                wrapMode:       Text.WordWrap
+                textFormat:     Text.RichText
                 color:          "white"
+                text:           formatMessage(formatedText)
             }
         }
+        QGCLabel {
+            anchors.margins:    ScreenTools.defaultFontPixelHeight
+            anchors.top:        parent.top
+            anchors.left:       parent.left
+            visible:            messageList.count === 0
+            color:              "white"
+            text:               qsTr("No Messages")
+        }
         //-- Dismiss System Message
         Image {
             anchors.margins:    ScreenTools.defaultFontPixelHeight * 0.5
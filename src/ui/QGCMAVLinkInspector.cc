@@ -8,8 +8,8 @@
 
 #include <QList>
 #include <QDebug>
+#include <QScrollBar>
 
-const float QGCMAVLinkInspector::updateHzLowpass = 0.2f;
 const unsigned int QGCMAVLinkInspector::updateInterval = 1000U;
 
 QGCMAVLinkInspector::QGCMAVLinkInspector(const QString& title, QAction* action, MAVLinkProtocol* protocol, QWidget *parent) :
@@ -30,8 +30,13 @@ QGCMAVLinkInspector::QGCMAVLinkInspector(const QString& title, QAction* action,
     header << tr("Name");
     header << tr("Value");
     header << tr("Type");
+    header << tr("Range");
     ui->treeWidget->setHeaderLabels(header);
 
+    // Rows coming into view are brought up to date right away
+    connect(ui->treeWidget, &QTreeWidget::itemExpanded, this, &QGCMAVLinkInspector::_updateVisibleRows);
+    connect(ui->treeWidget->verticalScrollBar(), &QScrollBar::valueChanged, this, &QGCMAVLinkInspector::_updateVisibleRows);
+
     // Connect the UI
     connect(ui->systemComboBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
             this, &QGCMAVLinkInspector::selectDropDownMenuSystem);
@@ -40,6 +45,9 @@ QGCMAVLinkInspector::QGCMAVLinkInspector(const QString& title, QAction* action,
 
     connect(ui->clearButton, &QPushButton::clicked, this, &QGCMAVLinkInspector::clearView);
 
+    ui->profileCheckBox->setChecked(Vehicle::messageTimingEnabled());
+    connect(ui->profileCheckBox, &QCheckBox::toggled, this, &QGCMAVLinkInspector::_profileToggled);
+
     // Connect external connections
     connect(qgcApp()->toolbox()->multiVehicleManager(), &MultiVehicleManager::vehicleAdded, this, &QGCMAVLinkInspector::_vehicleAdded);
     connect(protocol, &MAVLinkProtocol::messageReceived, this, &QGCMAVLinkInspector::receiveMessage);
@@ -47,6 +55,7 @@ QGCMAVLinkInspector::QGCMAVLinkInspector(const QString& title, QAction* action,
     // Attach the UI's refresh rate to a timer.
     connect(&updateTimer, &QTimer::timeout, this, &QGCMAVLinkInspector::refreshView);
     updateTimer.start(updateInterval);
+    _stats.start(QThread::LowPriority);
     
     loadSettings();
 }
@@ -59,15 +68,29 @@ void QGCMAVLinkInspector::_vehicleAdded(Vehicle* vehicle)
     addUAStoTree(vehicle->id());
 }
 
+/// Receive path timing is collected by all vehicles while enabled, each new profiling run starts from scratch
+void QGCMAVLinkInspector::_profileToggled(bool checked)
+{
+    if (checked) {
+        QmlObjectListModel* vehicles = qgcApp()->toolbox()->multiVehicleManager()->vehicles();
+        for (int i=0; i<vehicles->count(); i++) {
+            vehicles->value<Vehicle*>(i)->clearMessageTimings();
+        }
+    }
+    Vehicle::setMessageTimingEnabled(checked);
+}
+
 void QGCMAVLinkInspector::selectDropDownMenuSystem(int dropdownid)
 {
     selectedSystemID = ui->systemComboBox->itemData(dropdownid).toInt();
+    _stats.setFilter(selectedSystemID, selectedComponentID);
     rebuildComponentList();
 }
 
 void QGCMAVLinkInspector::selectDropDownMenuComponent(int dropdownid)
 {
     selectedComponentID = ui->componentComboBox->itemData(dropdownid).toInt();
+    _stats.setFilter(selectedSystemID, selectedComponentID);
 }
 
 void QGCMAVLinkInspector::rebuildComponentList()
@@ -107,13 +130,8 @@ void QGCMAVLinkInspector::addComponent(int uas, int component, const QString& na
  */
 void QGCMAVLinkInspector::clearView()
 {
-    QMap<int, mavlink_message_t* >::iterator ite;
-    for(ite=uasMessageStorage.begin(); ite!=uasMessageStorage.end();++ite)
-    {
-        delete ite.value();
-        ite.value() = NULL;
-    }
-    uasMessageStorage.clear();
+    _stats.clear();
+    _messageStats.clear();
 
     QMap<int, QMap<int, QTreeWidgetItem*>* >::iterator iteMsg;
     for (iteMsg=uasMsgTreeItems.begin(); iteMsg!=uasMsgTreeItems.end();++iteMsg)
@@ -136,47 +154,18 @@ void QGCMAVLinkInspector::clearView()
         iteTree.value() = NULL;
     }
     uasTreeWidgetItems.clear();
-    
-    QMap<int, QMap<int, float>* >::iterator iteHz;
-    for (iteHz=uasMessageHz.begin(); iteHz!=uasMessageHz.end();++iteHz)
-    {
-
-        iteHz.value()->clear();
-        delete iteHz.value();
-        iteHz.value() = NULL;
-    }
-    uasMessageHz.clear();
-
-    QMap<int, QMap<int, unsigned int>* >::iterator iteCount;
-    for(iteCount=uasMessageCount.begin(); iteCount!=uasMessageCount.end();++iteCount)
-    {
-        iteCount.value()->clear();
-        delete iteCount.value();
-        iteCount.value() = NULL;
-    }
-    uasMessageCount.clear();
-
-    QMap<int, QMap<int, quint64>* >::iterator iteLast;
-    for(iteLast=uasLastMessageUpdate.begin(); iteLast!=uasLastMessageUpdate.end();++iteLast)
-    {
-        iteLast.value()->clear();
-        delete iteLast.value();
-        iteLast.value() = NULL;
-    }
-    uasLastMessageUpdate.clear();
-
-    onboardMessageInterval.clear();
 
     ui->treeWidget->clear();
 }
 
 void QGCMAVLinkInspector::refreshView()
 {
-    QMap<int, mavlink_message_t* >::const_iterator ite;
+    // Only the messages received since the last refresh, aggregated on the stats thread
+    QList<MAVLinkInspectorStats::MessageStats_t> changedStats = _stats.takeChanged();
 
-    for(ite=uasMessageStorage.constBegin(); ite!=uasMessageStorage.constEnd();++ite)
+    foreach (const MAVLinkInspectorStats::MessageStats_t& stats, changedStats)
     {
-        mavlink_message_t* msg = ite.value();
+        const mavlink_message_t* msg = &stats.message;
         const mavlink_message_info_t* msgInfo = mavlink_get_message_info(msg);
 
         if (!msgInfo) {
@@ -184,51 +173,8 @@ void QGCMAVLinkInspector::refreshView()
             continue;
         }
 
-        // Ignore NULL values
-        if (msg->msgid == 0xFF) continue;
-
-        // Update the message frenquency
-
-        // Get the previous frequency for low-pass filtering
-        float msgHz = 0.0f;
-        QMap<int, QMap<int, float>* >::const_iterator iteHz = uasMessageHz.find(msg->sysid);
-        QMap<int, float>* uasMsgHz = iteHz.value();
-
-        while((iteHz != uasMessageHz.end()) && (iteHz.key() == msg->sysid))
-        {
-            if(iteHz.value()->contains(msg->msgid))
-            {
-                uasMsgHz = iteHz.value();
-                msgHz = iteHz.value()->value(msg->msgid);
-                break;
-            }
-            ++iteHz;
-        }
-
-        // Get the number of message received
-        float msgCount = 0;
-        QMap<int, QMap<int, unsigned int> * >::const_iterator iter = uasMessageCount.find(msg->sysid);
-        QMap<int, unsigned int>* uasMsgCount = iter.value();
-
-        while((iter != uasMessageCount.end()) && (iter.key()==msg->sysid))
-        {
-            if(iter.value()->contains(msg->msgid))
-            {
-                msgCount = (float) iter.value()->value(msg->msgid);
-                uasMsgCount = iter.value();
-                break;
-            }
-            ++iter;
-        }
-
-        // Compute the new low-pass filtered frequency and update the message count
-        msgHz = (1.0f-updateHzLowpass)* msgHz + updateHzLowpass*msgCount/((float)updateInterval/1000.0f);
-        uasMsgHz->insert(msg->msgid,msgHz);
-        uasMsgCount->insert(msg->msgid,(unsigned int) 0);
-
-        // Update the tree view
-        QString messageName("%1 (%2 Hz, #%3)");
-        messageName = messageName.arg(msgInfo->name).arg(msgHz, 3, 'f', 1).arg(msg->msgid);
+        quint64 key = MAVLinkInspectorStats::key(msg->sysid, msg->msgid);
+        _messageStats[key] = stats;
 
         addUAStoTree(msg->sysid);
 
@@ -237,15 +183,16 @@ void QGCMAVLinkInspector::refreshView()
         if (!msgTreeItems)
         {
             // The UAS tree has not been created yet, no update
-            return;
+            continue;
         }
 
-        // Add the message with msgid to the tree if not done yet
+        // Add the message with msgid to the tree if not done yet, rows are filled in once they are visible
         if(!msgTreeItems->contains(msg->msgid))
         {
-            QStringList fields;
-            fields << messageName;
             QTreeWidgetItem* widget = new QTreeWidgetItem();
+            widget->setFirstColumnSpanned(true);
+            widget->setData(0, Qt::DisplayRole, QVariant(QString(msgInfo->name)));
+            widget->setData(0, Qt::UserRole, QVariant(key));
             for (unsigned int i = 0; i < msgInfo->num_fields; ++i)
             {
                 QTreeWidgetItem* field = new QTreeWidgetItem();
@@ -256,19 +203,85 @@ void QGCMAVLinkInspector::refreshView()
             int insertIndex = groupKeys.indexOf(msg->msgid);
             uasTreeWidgetItems.value(msg->sysid)->insertChild(insertIndex,widget);
         }
+    }
+
+    _updateVisibleRows();
+}
 
-        // Update the message
-        QTreeWidgetItem* message = msgTreeItems->value(msg->msgid);
-        if(message)
+/// Updates the rows on screen whose message changed since they were last shown. Rows out of view and fields of
+/// collapsed messages are left alone, so the cost of a refresh is bounded by the size of the view.
+void QGCMAVLinkInspector::_updateVisibleRows(void)
+{
+    QTreeWidget* tree = ui->treeWidget;
+    int viewportHeight = tree->viewport()->height();
+
+    for (QTreeWidgetItem* item = tree->itemAt(0, 0); item && tree->visualItemRect(item).top() < viewportHeight; item = tree->itemBelow(item))
+    {
+        // Message rows hold the message key, field rows are their children and vehicle rows are skipped
+        QTreeWidgetItem* messageItem = item;
+        if (!item->data(0, Qt::UserRole).isValid())
         {
-            message->setFirstColumnSpanned(true);
-            message->setData(0, Qt::DisplayRole, QVariant(messageName));
-            for (unsigned int i = 0; i < msgInfo->num_fields; ++i)
+            messageItem = item->parent();
+            if (!messageItem || !messageItem->data(0, Qt::UserRole).isValid())
             {
-                updateField(msg, msgInfo, i, message->child(i));
+                continue;
             }
         }
+        bool fieldRow = messageItem != item;
+
+        QHash<quint64, MAVLinkInspectorStats::MessageStats_t>::iterator ite = _messageStats.find(messageItem->data(0, Qt::UserRole).toULongLong());
+        if (ite == _messageStats.end())
+        {
+            continue;
+        }
+        MAVLinkInspectorStats::MessageStats_t& stats = ite.value();
+
+        // Receive path timings change without new messages
+        bool profiling = !fieldRow && Vehicle::messageTimingEnabled();
+        if (!profiling && item->data(0, Qt::UserRole + 1).toUInt() == stats.generation)
+        {
+            continue;
+        }
+        item->setData(0, Qt::UserRole + 1, stats.generation);
+
+        const mavlink_message_info_t* msgInfo = mavlink_get_message_info(&stats.message);
+        if (!fieldRow)
+        {
+            updateMessage(stats, msgInfo, item);
+            continue;
+        }
+
+        int fieldid = messageItem->indexOfChild(item);
+        updateField(&stats.message, msgInfo, fieldid, item);
+        const mavlink_field_info_t& field = msgInfo->fields[fieldid];
+        if (field.array_length == 0 && field.type != MAVLINK_TYPE_CHAR && fieldid < stats.fieldMin.count())
+        {
+            item->setData(3, Qt::DisplayRole, QString("%1 .. %2").arg(stats.fieldMin[fieldid]).arg(stats.fieldMax[fieldid]));
+        }
+    }
+}
+
+void QGCMAVLinkInspector::updateMessage(const MAVLinkInspectorStats::MessageStats_t& stats, const mavlink_message_info_t* msgInfo, QTreeWidgetItem* item)
+{
+    const mavlink_message_t* msg = &stats.message;
+
+    QString messageName("%1 (%2 Hz, #%3)");
+    messageName = messageName.arg(msgInfo->name).arg(stats.hz, 3, 'f', 1).arg(msg->msgid);
+
+    // Add receive path timing: mean handler and total time, 95th percentile bucket and worst case
+    if (Vehicle::messageTimingEnabled()) {
+        Vehicle* vehicle = qgcApp()->toolbox()->multiVehicleManager()->getVehicleById(msg->sysid);
+        if (vehicle && vehicle->messageTimings().contains(msg->msgid)) {
+            const Vehicle::MessageTiming& timing = vehicle->messageTimings()[msg->msgid];
+            messageName += QString(" rx handler %1us total %2us p95 <%3us max %4us")
+                    .arg((double)timing.handlerNsecs / timing.count / 1000.0, 0, 'f', 1)
+                    .arg((double)timing.totalNsecs / timing.count / 1000.0, 0, 'f', 1)
+                    .arg(timing.percentileUSecs(0.95))
+                    .arg((double)timing.maxNsecs / 1000.0, 0, 'f', 0);
+        }
     }
+
+    item->setData(0, Qt::DisplayRole, QVariant(messageName));
 }
 
 void QGCMAVLinkInspector::addUAStoTree(int sysId)
@@ -291,127 +304,11 @@ void QGCMAVLinkInspector::addUAStoTree(int sysId)
     }
 }
 
+/// Called for every received message, the message is only queued for the stats thread
 void QGCMAVLinkInspector::receiveMessage(LinkInterface* link,mavlink_message_t message)
 {
     Q_UNUSED(link);
-
-    quint64 receiveTime;
-    
-    if (selectedSystemID != 0 && selectedSystemID != message.sysid) return;
-    if (selectedComponentID != 0 && selectedComponentID != message.compid) return;
-
-    // Create dynamically an array to store the messages for each UAS
-    if (!uasMessageStorage.contains(message.sysid))
-    {
-        mavlink_message_t* msg = new mavlink_message_t;
-        *msg = message;
-        uasMessageStorage.insertMulti(message.sysid,msg);
-    }
-
-    bool msgFound = false;
-    QMap<int, mavlink_message_t* >::const_iterator iteMsg = uasMessageStorage.find(message.sysid);
-    mavlink_message_t* uasMessage = iteMsg.value();
-    while((iteMsg != uasMessageStorage.end()) && (iteMsg.key() == message.sysid))
-    {
-        if (iteMsg.value()->msgid == message.msgid)
-        {
-            msgFound = true;
-            uasMessage = iteMsg.value();
-            break;
-        }
-        ++iteMsg;
-    }
-    if (!msgFound)
-    {
-        mavlink_message_t* msgIdMessage = new mavlink_message_t;
-        *msgIdMessage = message;
-        uasMessageStorage.insertMulti(message.sysid,msgIdMessage);
-    }
-    else
-    {
-        *uasMessage = message;
-    }
-
-    // Looking if this message has already been received once
-    msgFound = false;
-    QMap<int, QMap<int, quint64>* >::const_iterator ite = uasLastMessageUpdate.find(message.sysid);
-    QMap<int, quint64>* lastMsgUpdate = ite.value();
-    while((ite != uasLastMessageUpdate.end()) && (ite.key() == message.sysid))
-    {   
-        if(ite.value()->contains(message.msgid))
-        {
-            msgFound = true;
-
-            // Point to the found message
-            lastMsgUpdate = ite.value();
-            break;
-        }
-        ++ite;
-    }
-
-    receiveTime = QGC::groundTimeMilliseconds();
-
-    // If the message doesn't exist, create a map for the frequency, message count and time of reception
-    if(!msgFound)
-    {
-        // Create a map for the message frequency
-        QMap<int, float>* messageHz = new QMap<int,float>;
-        messageHz->insert(message.msgid,0.0f);
-        uasMessageHz.insertMulti(message.sysid,messageHz);
-
-        // Create a map for the message count
-        QMap<int, unsigned int>* messagesCount = new QMap<int, unsigned int>;
-        messagesCount->insert(message.msgid,0);
-        uasMessageCount.insertMulti(message.sysid,messagesCount);
-
-        // Create a map for the time of reception of the message
-        QMap<int, quint64>* lastMessage = new QMap<int, quint64>;
-        lastMessage->insert(message.msgid,receiveTime);
-        uasLastMessageUpdate.insertMulti(message.sysid,lastMessage);
-
-        // Point to the created message
-        lastMsgUpdate = lastMessage;
-    }
-    else
-    {
-        // The message has been found/created
-        if ((lastMsgUpdate->contains(message.msgid))&&(uasMessageCount.contains(message.sysid)))
-        {
-            // Looking for and updating the message count
-            unsigned int count = 0;
-            QMap<int, QMap<int, unsigned int>* >::const_iterator iter = uasMessageCount.find(message.sysid);
-            QMap<int, unsigned int> * uasMsgCount = iter.value();
-            while((iter != uasMessageCount.end()) && (iter.key() == message.sysid))
-            {
-                if(iter.value()->contains(message.msgid))
-                {
-                    uasMsgCount = iter.value();
-                    count = uasMsgCount->value(message.msgid,0);
-                    uasMsgCount->insert(message.msgid,count+1);
-                    break;
-                }
-                ++iter;
-            }
-        }
-        lastMsgUpdate->insert(message.msgid,receiveTime);
-    }
-
-    if (selectedSystemID == 0 || selectedComponentID == 0)
-    {
-        return;
-    }
-
-    switch (message.msgid)
-    {
-        case MAVLINK_MSG_ID_DATA_STREAM:
-            {
-                mavlink_data_stream_t stream;
-                mavlink_msg_data_stream_decode(&message, &stream);
-                onboardMessageInterval.insert(stream.stream_id, stream.message_rate);
-            }
-            break;
-
-    }
+    _stats.queueMessage(message);
 }
 
 QGCMAVLinkInspector::~QGCMAVLinkInspector()
@@ -424,27 +321,8 @@ void QGCMAVLinkInspector::updateField(mavlink_message_t* msg, const mavlink_mess
 {
     // Add field tree widget item
     item->setData(0, Qt::DisplayRole, QVariant(msgInfo->fields[fieldid].name));
-    
-    bool msgFound = false;
-    QMap<int, mavlink_message_t* >::const_iterator iteMsg = uasMessageStorage.find(msg->sysid);
-    mavlink_message_t* uasMessage = iteMsg.value();
-    while((iteMsg != uasMessageStorage.end()) && (iteMsg.key() == msg->sysid))
-    {
-        if (iteMsg.value()->msgid == msg->msgid)
-        {
-            msgFound = true;
-            uasMessage = iteMsg.value();
-            break;
-        }
-        ++iteMsg;
-    }
-
-    if (!msgFound)
-    {
-        return;
-    }
 
-    uint8_t* m = (uint8_t*)&uasMessage->payload64[0];
+    uint8_t* m = (uint8_t*)&msg->payload64[0];
 
     switch (msgInfo->fields[fieldid].type)
     {
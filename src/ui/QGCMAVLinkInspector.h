@@ -2,10 +2,12 @@
 #define QGCMAVLINKINSPECTOR_H
 
 #include <QMap>
+#include <QHash>
 #include <QTimer>
 
 #include "QGCDockWidget.h"
 #include "MAVLinkProtocol.h"
+#include "MAVLinkInspectorStats.h"
 #include "Vehicle.h"
 
 namespace Ui {
@@ -42,31 +44,29 @@ protected:
     int selectedComponentID;       ///< Currently selected component
     QMap<int, int> systems;     ///< Already observed systems
     QMap<int, int> components; ///< Already observed components
-    QMap<int, float> onboardMessageInterval; ///< Stores the onboard selected data rate
     QTimer updateTimer; ///< Only update at 1 Hz to not overload the GUI
 
     QMap<int, QTreeWidgetItem* > uasTreeWidgetItems; ///< Tree of available uas with their widget
     QMap<int, QMap<int, QTreeWidgetItem*>* > uasMsgTreeItems; ///< Stores the widget of the received message for each UAS
 
-    QMap<int, mavlink_message_t* > uasMessageStorage; ///< Stores the messages for every UAS
-
-    QMap<int, QMap<int, float>* > uasMessageHz; ///< Stores the frequency of each message of each UAS
-    QMap<int, QMap<int, unsigned int>* > uasMessageCount; ///< Stores the message count of each message of each UAS
-
-    QMap<int, QMap<int, quint64>* > uasLastMessageUpdate; ///< Stores the time of the last message for each message of each UAS
+    MAVLinkInspectorStats _stats; ///< Aggregates the received messages on its own thread
+    QHash<quint64, MAVLinkInspectorStats::MessageStats_t> _messageStats; ///< Latest stats of each message shown
 
     /* @brief Update one message field */
     void updateField(mavlink_message_t* msg, const mavlink_message_info_t* msgInfo, int fieldid, QTreeWidgetItem* item);
+    /* @brief Update the name row of a message */
+    void updateMessage(const MAVLinkInspectorStats::MessageStats_t& stats, const mavlink_message_info_t* msgInfo, QTreeWidgetItem* item);
     /** @brief Rebuild the list of components */
     void rebuildComponentList();
     /* @brief Create a new tree for a new UAS */
     void addUAStoTree(int sysId);
 
     static const unsigned int updateInterval; ///< The update interval of the refresh function
-    static const float updateHzLowpass; ///< The low-pass filter value for the frequency of each message
     
 private slots:
     void _vehicleAdded(Vehicle* vehicle);
+    void _profileToggled(bool checked);
+    void _updateVisibleRows(void);
 
 private:
     Ui::QGCMAVLinkInspector *ui;
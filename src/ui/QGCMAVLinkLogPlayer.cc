@@ -1,5 +1,6 @@
 #include <QStandardPaths>
 #include <QtEndian>
+#include <QTime>
 
 #include "MainWindow.h"
 #ifndef NO_SERIAL_LINK
@@ -14,10 +15,12 @@
 #include "LinkManager.h"
 #include "QGCQFileDialog.h"
 #include "QGCMessageBox.h"
+#include "VideoSyncIndex.h"
 
 QGCMAVLinkLogPlayer::QGCMAVLinkLogPlayer(QWidget *parent) :
     QWidget(parent),
     _replayLink(NULL),
+    _videoSyncIndex(NULL),
     _ui(new Ui::QGCMAVLinkLogPlayer)
 {
     _ui->setupUi(this);
@@ -28,6 +31,8 @@ QGCMAVLinkLogPlayer::QGCMAVLinkLogPlayer(QWidget *parent) :
     connect(_ui->playButton,        &QPushButton::clicked,      this, &QGCMAVLinkLogPlayer::_playPauseToggle);
     connect(_ui->positionSlider,    &QSlider::valueChanged,     this, &QGCMAVLinkLogPlayer::_setPlayheadFromSlider);
     connect(_ui->positionSlider,    &QSlider::sliderPressed,    this, &QGCMAVLinkLogPlayer::_pause);
+    connect(_ui->syncVideoButton,   &QPushButton::clicked,      this, &QGCMAVLinkLogPlayer::_syncToVideo);
+    connect(_ui->videoTimeEdit,     &QTimeEdit::editingFinished, this, &QGCMAVLinkLogPlayer::_setPlayheadFromVideoTime);
 
 #if 0
     // Speed slider is removed from 3.0 release. Too broken to fix.
@@ -46,6 +51,7 @@ QGCMAVLinkLogPlayer::QGCMAVLinkLogPlayer(QWidget *parent) :
 
 QGCMAVLinkLogPlayer::~QGCMAVLinkLogPlayer()
 {
+    delete _videoSyncIndex;
     delete _ui;
 }
 
@@ -143,6 +149,8 @@ void QGCMAVLinkLogPlayer::_playbackStarted(void)
     _ui->playButton->setChecked(true);
     _ui->playButton->setIcon(QIcon(":/res/Pause"));
     _ui->positionSlider->setEnabled(false);
+    _ui->syncVideoButton->setEnabled(false);
+    _ui->videoTimeEdit->setEnabled(false);
 }
 
 /// Signalled from LogReplayLink when replay is paused
@@ -151,6 +159,9 @@ void QGCMAVLinkLogPlayer::_playbackPaused(void)
     _ui->playButton->setIcon(QIcon(":/res/Play"));
     _ui->playButton->setChecked(false);
     _ui->positionSlider->setEnabled(true);
+    _ui->syncVideoButton->setEnabled(true);
+    _ui->videoTimeEdit->setEnabled(_videoSyncIndex != NULL);
+    _updateVideoTime();
 }
 
 void QGCMAVLinkLogPlayer::_playbackPercentCompleteChanged(int percentComplete)
@@ -158,6 +169,9 @@ void QGCMAVLinkLogPlayer::_playbackPercentCompleteChanged(int percentComplete)
     _ui->positionSlider->blockSignals(true);
     _ui->positionSlider->setValue(percentComplete);
     _ui->positionSlider->blockSignals(false);
+    if (_replayLink && !_replayLink->isPlaying()) {
+        _updateVideoTime();
+    }
 }
 
 void QGCMAVLinkLogPlayer::_setPlayheadFromSlider(int value)
@@ -167,6 +181,64 @@ void QGCMAVLinkLogPlayer::_setPlayheadFromSlider(int value)
     }
 }
 
+/// Moves replay to the telemetry received with the first frame of a video recording. The recording is kept, so the
+/// video position is shown along with the replay position and replay can be moved to a video position. Only available
+/// while paused.
+void QGCMAVLinkLogPlayer::_syncToVideo(void)
+{
+    if (!_replayLink) {
+        return;
+    }
+
+    QString indexFilename = QGCQFileDialog::getOpenFileName(
+        this,
+        tr("Select Video Recording"),
+        qgcApp()->toolbox()->settingsManager()->appSettings()->videoSavePath(),
+        tr("Video Sync Index Files (*.%1)").arg(VideoSyncIndex::fileExtension));
+
+    if (indexFilename.isEmpty() || !_replayLink) {
+        return;
+    }
+
+    VideoSyncIndex* index = new VideoSyncIndex();
+    if (!index->load(indexFilename) || index->count() == 0) {
+        delete index;
+        QGCMessageBox::warning(tr("Log Replay"), tr("Unable to load the video sync index '%1'.").arg(indexFilename));
+        return;
+    }
+    delete _videoSyncIndex;
+    _videoSyncIndex = index;
+
+    QTime videoEnd = QTime(0, 0).addMSecs(_videoSyncIndex->entry(_videoSyncIndex->count() - 1).ptsNSecs / 1000000);
+    _ui->videoTimeEdit->setTimeRange(QTime(0, 0), videoEnd);
+    _ui->videoTimeEdit->setEnabled(true);
+
+    _replayLink->movePlayheadToVideoFrame(*_videoSyncIndex, 0);
+}
+
+/// Moves replay to the telemetry received with the frame at the entered video position
+void QGCMAVLinkLogPlayer::_setPlayheadFromVideoTime(void)
+{
+    if (!_replayLink || !_videoSyncIndex || _replayLink->isPlaying()) {
+        return;
+    }
+    quint64 ptsNSecs = (quint64)QTime(0, 0).msecsTo(_ui->videoTimeEdit->time()) * 1000000;
+    _replayLink->movePlayheadToVideoFrame(*_videoSyncIndex, _videoSyncIndex->indexForPts(ptsNSecs));
+}
+
+/// Shows the video position of the frame received along with the telemetry at the replay position
+void QGCMAVLinkLogPlayer::_updateVideoTime(void)
+{
+    if (!_replayLink || !_videoSyncIndex) {
+        return;
+    }
+    int entryIndex = _replayLink->videoFrameForPlayhead(*_videoSyncIndex);
+    QTime videoTime = entryIndex == -1 ? QTime(0, 0) : QTime(0, 0).addMSecs(_videoSyncIndex->entry(entryIndex).ptsNSecs / 1000000);
+    _ui->videoTimeEdit->blockSignals(true);
+    _ui->videoTimeEdit->setTime(videoTime);
+    _ui->videoTimeEdit->blockSignals(false);
+}
+
 void QGCMAVLinkLogPlayer::_enablePlaybackControls(bool enabled)
 {
     _ui->playButton->setEnabled(enabled);
@@ -174,6 +246,8 @@ void QGCMAVLinkLogPlayer::_enablePlaybackControls(bool enabled)
     _ui->speedSlider->setEnabled(enabled);
 #endif
     _ui->positionSlider->setEnabled(enabled);
+    _ui->syncVideoButton->setEnabled(enabled);
+    _ui->videoTimeEdit->setEnabled(enabled && _videoSyncIndex);
 }
 
 #if 0
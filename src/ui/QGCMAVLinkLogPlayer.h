@@ -33,6 +33,8 @@ private slots:
     void _playPauseToggle(void);
     void _pause(void);
     void _setPlayheadFromSlider(int value);
+    void _syncToVideo(void);
+    void _setPlayheadFromVideoTime(void);
 #if 0
     void _setAccelerationFromSlider(int value);
 #endif
@@ -47,9 +49,11 @@ private:
     void _finishPlayback(void);
     QString _secondsToHMS(int seconds);
     void _enablePlaybackControls(bool enabled);
+    void _updateVideoTime(void);
 
     LogReplayLink*  _replayLink;
     int             _logDurationSeconds;
+    VideoSyncIndex* _videoSyncIndex;    ///< Recording selected through Sync to Video, NULL if none
     
     Ui::QGCMAVLinkLogPlayer* _ui;
 };
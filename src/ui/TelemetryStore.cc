@@ -0,0 +1,363 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryStore.h"
+
+#include <QMutexLocker>
+
+QGC_LOGGING_CATEGORY(TelemetryStoreLog, "TelemetryStoreLog")
+
+static quint64 _sampleMSecs(const quint64& msecs)       { return msecs; }
+static quint64 _bucketFirstMSecs(const TelemetryStore::Bucket_t& bucket)  { return bucket.firstMSecs; }
+static quint64 _bucketLastMSecs(const TelemetryStore::Bucket_t& bucket)   { return bucket.lastMSecs; }
+
+/// Binary search over a ring whose entries are ordered by time
+/// @return Index of the first entry with a time >= msecs, or > msecs if after is set
+template<typename T>
+static int _search(const TelemetryRing<T>& ring, quint64 msecs, bool after, quint64 (*timeOf)(const T&))
+{
+    int low = 0;
+    int high = ring.count();
+
+    while (low < high) {
+        int mid = (low + high) / 2;
+        quint64 entryMSecs = timeOf(ring.at(mid));
+        if (entryMSecs < msecs || (after && entryMSecs == msecs)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+TelemetryStore::TelemetryStore(QObject* parent)
+    : QObject(parent)
+    , _maxSamples(_defaultMaxSamples)
+{
+
+}
+
+TelemetryStore::~TelemetryStore()
+{
+    clear();
+}
+
+quint64 TelemetryStore::fieldKey(int sysid, int compid, quint32 msgid, int fieldIndex, int arrayIndex)
+{
+    return ((quint64)(sysid & 0xFF) << 56) | ((quint64)(compid & 0xFF) << 48) | ((quint64)(msgid & 0xFFFFFF) << 24) |
+            ((quint64)(fieldIndex & 0xFF) << 16) | (quint64)(arrayIndex & 0xFFFF);
+}
+
+int TelemetryStore::seriesId(quint64 fieldKey) const
+{
+    QMutexLocker lock(&_mutex);
+    return _fieldKeyMap.value(fieldKey, -1);
+}
+
+int TelemetryStore::seriesId(const QString& name) const
+{
+    QMutexLocker lock(&_mutex);
+    return _nameMap.value(name, -1);
+}
+
+int TelemetryStore::addSeries(const QString& name, const QString& unit, int sysid, ValueType_t valueType, bool integer, quint64 fieldKey)
+{
+    int id;
+
+    {
+        QMutexLocker lock(&_mutex);
+
+        id = _nameMap.value(name, -1);
+        if (id != -1) {
+            if (fieldKey != 0) {
+                _fieldKeyMap[fieldKey] = id;
+            }
+            return id;
+        }
+
+        Series_t* series = new Series_t;
+        series->name = name;
+        series->unit = unit;
+        series->sysid = sysid;
+        series->valueType = valueType;
+        series->integer = integer;
+        series->retainCount = 0;
+        series->appendedCount = 0;
+        _applyCapacity(*series);
+
+        id = _series.count();
+        _series.append(series);
+        _nameMap[name] = id;
+        if (fieldKey != 0) {
+            _fieldKeyMap[fieldKey] = id;
+        }
+    }
+
+    qCDebug(TelemetryStoreLog) << "Series added" << id << name << unit;
+    emit seriesAdded(id);
+
+    return id;
+}
+
+void TelemetryStore::append(int seriesId, quint64 msecs, double value)
+{
+    QMutexLocker lock(&_mutex);
+
+    if (seriesId < 0 || seriesId >= _series.count()) {
+        return;
+    }
+    Series_t& series = *_series[seriesId];
+
+    // Window queries rely on time never going backwards within a series
+    if (!series.msecs.isEmpty()) {
+        msecs = qMax(msecs, series.msecs.last());
+    }
+    series.msecs.append(msecs);
+    if (series.valueType == ValueFloat) {
+        series.floatValues.append(value);
+    } else {
+        series.doubleValues.append(value);
+    }
+
+    // Buckets are aligned to the sample count, so each level only touches its last bucket
+    quint64 index = series.appendedCount++;
+    quint64 span = 1;
+    for (int level=0; level<levelCount; level++) {
+        span *= bucketSpan;
+        TelemetryRing<Bucket_t>& buckets = series.levels[level];
+        if (index % span == 0) {
+            Bucket_t bucket = { msecs, msecs, value, value, value, value };
+            buckets.append(bucket);
+        } else {
+            Bucket_t& bucket = buckets.last();
+            bucket.lastMSecs = msecs;
+            bucket.last = value;
+            bucket.min = qMin(bucket.min, value);
+            bucket.max = qMax(bucket.max, value);
+        }
+    }
+}
+
+/// Sizes the rings of a series for its retention. Called with _mutex held.
+void TelemetryStore::_applyCapacity(Series_t& series)
+{
+    int capacity = series.retainCount > 0 ? _maxSamples : qMin(_maxSamples, (int)_unretainedSamples);
+
+    series.msecs.setCapacity(capacity);
+    if (series.valueType == ValueFloat) {
+        series.floatValues.setCapacity(capacity);
+    } else {
+        series.doubleValues.setCapacity(capacity);
+    }
+    int span = 1;
+    for (int level=0; level<levelCount; level++) {
+        span *= bucketSpan;
+        series.levels[level].setCapacity(capacity / span + 1);
+    }
+}
+
+/// Called with _mutex held
+double TelemetryStore::_value(const Series_t& series, int index) const
+{
+    return series.valueType == ValueFloat ? series.floatValues.at(index) : series.doubleValues.at(index);
+}
+
+int TelemetryStore::seriesCount(void) const
+{
+    QMutexLocker lock(&_mutex);
+    return _series.count();
+}
+
+QString TelemetryStore::seriesName(int seriesId) const
+{
+    QMutexLocker lock(&_mutex);
+    return seriesId >= 0 && seriesId < _series.count() ? _series[seriesId]->name : QString();
+}
+
+QString TelemetryStore::seriesUnit(int seriesId) const
+{
+    QMutexLocker lock(&_mutex);
+    return seriesId >= 0 && seriesId < _series.count() ? _series[seriesId]->unit : QString();
+}
+
+int TelemetryStore::seriesSystemId(int seriesId) const
+{
+    QMutexLocker lock(&_mutex);
+    return seriesId >= 0 && seriesId < _series.count() ? _series[seriesId]->sysid : 0;
+}
+
+bool TelemetryStore::seriesInteger(int seriesId) const
+{
+    QMutexLocker lock(&_mutex);
+    return seriesId >= 0 && seriesId < _series.count() ? _series[seriesId]->integer : false;
+}
+
+quint64 TelemetryStore::appendedCount(int seriesId) const
+{
+    QMutexLocker lock(&_mutex);
+    return seriesId >= 0 && seriesId < _series.count() ? _series[seriesId]->appendedCount : 0;
+}
+
+quint64 TelemetryStore::samplesSince(int seriesId, quint64 cursor, QVector<double>& msecs, QVector<double>& values) const
+{
+    msecs.clear();
+    values.clear();
+
+    QMutexLocker lock(&_mutex);
+
+    if (seriesId < 0 || seriesId >= _series.count()) {
+        return cursor;
+    }
+    const Series_t& series = *_series[seriesId];
+
+    quint64 oldest = series.appendedCount - series.msecs.count();
+    quint64 start = qMax(cursor, oldest);
+    msecs.reserve(series.appendedCount - start);
+    values.reserve(series.appendedCount - start);
+    for (quint64 i=start; i<series.appendedCount; i++) {
+        int index = i - oldest;
+        msecs.append(series.msecs.at(index));
+        values.append(_value(series, index));
+    }
+
+    return series.appendedCount;
+}
+
+int TelemetryStore::samples(int seriesId, quint64 startMSecs, quint64 endMSecs, QVector<double>& msecs, QVector<double>& values, bool edgeSamples) const
+{
+    msecs.clear();
+    values.clear();
+
+    QMutexLocker lock(&_mutex);
+
+    if (seriesId < 0 || seriesId >= _series.count()) {
+        return 0;
+    }
+    const Series_t& series = *_series[seriesId];
+
+    int first = _search(series.msecs, startMSecs, false, _sampleMSecs);
+    int last = _search(series.msecs, endMSecs, true, _sampleMSecs);
+    if (edgeSamples) {
+        first = qMax(0, first - 1);
+        last = qMin(series.msecs.count(), last + 1);
+    }
+    msecs.reserve(last - first);
+    values.reserve(last - first);
+    for (int i=first; i<last; i++) {
+        msecs.append(series.msecs.at(i));
+        values.append(_value(series, i));
+    }
+
+    return msecs.count();
+}
+
+int TelemetryStore::minMax(int seriesId, quint64 startMSecs, quint64 endMSecs, int maxBuckets, QVector<Bucket_t>& buckets, bool edgeSamples) const
+{
+    buckets.clear();
+
+    QMutexLocker lock(&_mutex);
+
+    if (seriesId < 0 || seriesId >= _series.count() || maxBuckets <= 0) {
+        return 0;
+    }
+    const Series_t& series = *_series[seriesId];
+
+    int first = _search(series.msecs, startMSecs, false, _sampleMSecs);
+    int last = _search(series.msecs, endMSecs, true, _sampleMSecs);
+    int sampleCount = last - first;
+
+    if (sampleCount <= maxBuckets) {
+        // Few enough samples to return them all, each as its own bucket
+        if (edgeSamples) {
+            first = qMax(0, first - 1);
+            last = qMin(series.msecs.count(), last + 1);
+        }
+        buckets.reserve(last - first);
+        for (int i=first; i<last; i++) {
+            double value = _value(series, i);
+            Bucket_t bucket = { series.msecs.at(i), series.msecs.at(i), value, value, value, value };
+            buckets.append(bucket);
+        }
+        return buckets.count();
+    }
+
+    int level = 0;
+    int span = bucketSpan;
+    while (level < levelCount - 1 && sampleCount / span > maxBuckets) {
+        level++;
+        span *= bucketSpan;
+    }
+
+    // Buckets overlapping the window, the first and last may extend beyond it
+    const TelemetryRing<Bucket_t>& levelBuckets = series.levels[level];
+    int firstBucket = _search(levelBuckets, startMSecs, false, _bucketLastMSecs);
+    int lastBucket = _search(levelBuckets, endMSecs, true, _bucketFirstMSecs);
+    buckets.reserve(qMax(0, lastBucket - firstBucket));
+    for (int i=firstBucket; i<lastBucket; i++) {
+        buckets.append(levelBuckets.at(i));
+    }
+
+    return buckets.count();
+}
+
+bool TelemetryStore::lastSample(int seriesId, quint64& msecs, double& value) const
+{
+    QMutexLocker lock(&_mutex);
+
+    if (seriesId < 0 || seriesId >= _series.count() || _series[seriesId]->msecs.isEmpty()) {
+        return false;
+    }
+    const Series_t& series = *_series[seriesId];
+
+    msecs = series.msecs.last();
+    value = _value(series, series.msecs.count() - 1);
+    return true;
+}
+
+void TelemetryStore::setRetained(int seriesId, bool retained)
+{
+    QMutexLocker lock(&_mutex);
+
+    if (seriesId < 0 || seriesId >= _series.count()) {
+        return;
+    }
+    Series_t& series = *_series[seriesId];
+
+    if (retained) {
+        if (series.retainCount++ == 0) {
+            _applyCapacity(series);
+        }
+    } else if (series.retainCount > 0) {
+        if (--series.retainCount == 0) {
+            _applyCapacity(series);
+        }
+    }
+}
+
+void TelemetryStore::setMaxSamples(int maxSamples)
+{
+    QMutexLocker lock(&_mutex);
+
+    _maxSamples = qMax(maxSamples, bucketSpan);
+    foreach (Series_t* series, _series) {
+        _applyCapacity(*series);
+    }
+}
+
+void TelemetryStore::clear(void)
+{
+    QMutexLocker lock(&_mutex);
+
+    qDeleteAll(_series);
+    _series.clear();
+    _fieldKeyMap.clear();
+    _nameMap.clear();
+}
@@ -0,0 +1,194 @@
+/****************************************************************************
+ *
+ *   (c) 2009-2016 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QMutex>
+#include <QHash>
+#include <QVector>
+#include <QString>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(TelemetryStoreLog)
+
+/// Fixed capacity ring buffer. Storage grows on demand up to the capacity, so rarely updated series stay small.
+template<typename T>
+class TelemetryRing
+{
+public:
+    TelemetryRing(void) : _capacity(0), _first(0) { }
+
+    /// Changes the capacity, the most recent entries which fit are kept
+    void setCapacity(int capacity)
+    {
+        _capacity = qMax(capacity, 0);
+        int keep = qMin(_capacity, _buffer.count());
+        QVector<T> buffer;
+        buffer.reserve(keep);
+        for (int i=_buffer.count()-keep; i<_buffer.count(); i++) {
+            buffer.append(at(i));
+        }
+        _buffer = buffer;
+        _first = 0;
+    }
+    int  capacity   (void) const { return _capacity; }
+    int  count      (void) const { return _buffer.count(); }
+    bool isEmpty    (void) const { return _buffer.isEmpty(); }
+    void clear      (void) { _buffer.clear(); _first = 0; }
+
+    /// @return true if the oldest entry was dropped to make room
+    bool append(const T& value)
+    {
+        if (_capacity <= 0) {
+            return false;
+        }
+        if (_buffer.count() < _capacity) {
+            _buffer.append(value);
+            return false;
+        }
+        _buffer[_first] = value;
+        _first = (_first + 1) % _capacity;
+        return true;
+    }
+
+    /// @param index 0 is the oldest entry
+    const T&    at      (int index) const   { return _buffer[(_first + index) % _buffer.count()]; }
+    T&          last    (void)              { return _buffer[(_first + _buffer.count() - 1) % _buffer.count()]; }
+    const T&    last    (void) const        { return _buffer[(_first + _buffer.count() - 1) % _buffer.count()]; }
+
+private:
+    QVector<T>  _buffer;
+    int         _capacity;
+    int         _first;     ///< Index of the oldest entry once the buffer is full
+};
+
+/// Columnar in memory store for telemetry time series.
+///
+/// Each series is one field (or array element) of one message from one system, interned to an integer id the first
+/// time it is seen. Samples are held in typed ring buffers of timestamps and values, with min/max buckets at several
+/// decimation levels kept up to date as samples are appended. Readers query a time window, either as raw samples or as
+/// min/max buckets no more numerous than the points they can show, or read the samples appended since their last read.
+/// Only series which are retained, because they are plotted, keep their history. All other series only keep their most
+/// recent samples, enough for readers to catch up through samplesSince.
+/// All methods are thread safe, samples are appended from the decoder thread and read from the GUI thread.
+class TelemetryStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    TelemetryStore(QObject* parent = NULL);
+    ~TelemetryStore();
+
+    typedef enum {
+        ValueFloat,     ///< float and integers up to 16 bits, exact in a float
+        ValueDouble,    ///< double and larger integers
+    } ValueType_t;
+
+    typedef struct {
+        quint64 firstMSecs;
+        quint64 lastMSecs;
+        double  min;
+        double  max;
+        double  first;      ///< Value of the first sample in the bucket
+        double  last;       ///< Value of the last sample in the bucket
+    } Bucket_t;
+
+    /// @return Key identifying a field of a message, arrayIndex is 0 for non array fields
+    static quint64 fieldKey(int sysid, int compid, quint32 msgid, int fieldIndex, int arrayIndex);
+
+    /// @return Series id for the field key, -1 if the field was not seen yet
+    int seriesId(quint64 fieldKey) const;
+
+    /// @return Series id for the name, -1 if there is no such series
+    int seriesId(const QString& name) const;
+
+    /// Adds a series, or returns the existing series with the same name
+    ///     @param fieldKey Key to find the series by in addition to its name, 0 for none
+    /// @return Series id
+    int addSeries(const QString& name, const QString& unit, int sysid, ValueType_t valueType, bool integer, quint64 fieldKey = 0);
+
+    void append(int seriesId, quint64 msecs, double value);
+
+    int         seriesCount     (void) const;
+    QString     seriesName      (int seriesId) const;
+    QString     seriesUnit      (int seriesId) const;
+    int         seriesSystemId  (int seriesId) const;
+    bool        seriesInteger   (int seriesId) const;
+
+    /// @return Total number of samples appended to the series, used as a read cursor by samplesSince
+    quint64 appendedCount(int seriesId) const;
+
+    /// Reads the samples appended after cursor. Samples which were already dropped from the ring are skipped.
+    /// @return New cursor
+    quint64 samplesSince(int seriesId, quint64 cursor, QVector<double>& msecs, QVector<double>& values) const;
+
+    /// Reads the samples within [startMSecs, endMSecs]
+    ///     @param edgeSamples true: Also read the sample just before and just after the window, if any
+    /// @return Number of samples read
+    int samples(int seriesId, quint64 startMSecs, quint64 endMSecs, QVector<double>& msecs, QVector<double>& values, bool edgeSamples = false) const;
+
+    /// Reads min/max buckets covering [startMSecs, endMSecs] from the finest level giving at most maxBuckets buckets.
+    /// If the window holds no more than maxBuckets samples each sample is returned as its own bucket.
+    ///     @param edgeSamples true: Also read the sample just before and just after the window when returning samples,
+    ///                             buckets at the ends of the window always extend beyond it
+    /// @return Number of buckets read
+    int minMax(int seriesId, quint64 startMSecs, quint64 endMSecs, int maxBuckets, QVector<Bucket_t>& buckets, bool edgeSamples = false) const;
+
+    /// @return false if the series holds no samples
+    bool lastSample(int seriesId, quint64& msecs, double& value) const;
+
+    /// Keeps the history of a series, up to the maximum number of samples. Retention is counted, each call retaining a
+    /// series has to be matched by one releasing it. Releasing the last retention drops the history.
+    void setRetained(int seriesId, bool retained);
+
+    /// Sets the number of samples held by each retained series
+    void setMaxSamples(int maxSamples);
+
+    /// Drops all series
+    void clear(void);
+
+    /// Samples covered by a bucket grow by this factor from one level to the next
+    static const int bucketSpan = 8;
+
+    /// Decimation levels above the raw samples
+    static const int levelCount = 4;
+
+signals:
+    /// Emitted from the thread which added the series
+    void seriesAdded(int seriesId);
+
+private:
+    typedef struct {
+        QString                 name;
+        QString                 unit;
+        int                     sysid;
+        ValueType_t             valueType;
+        bool                    integer;
+        int                     retainCount;
+        quint64                 appendedCount;
+        TelemetryRing<quint64>  msecs;
+        TelemetryRing<float>    floatValues;
+        TelemetryRing<double>   doubleValues;
+        TelemetryRing<Bucket_t> levels[levelCount];
+    } Series_t;
+
+    double  _value          (const Series_t& series, int index) const;
+    void    _applyCapacity  (Series_t& series);
+
+    mutable QMutex          _mutex;
+    QVector<Series_t*>      _series;
+    QHash<quint64, int>     _fieldKeyMap;
+    QHash<QString, int>     _nameMap;
+    int                     _maxSamples;
+
+    static const int _defaultMaxSamples =   65536;
+    static const int _unretainedSamples =   256;    ///< Covers several reader refresh periods at high message rates
+};
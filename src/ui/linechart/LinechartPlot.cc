@@ -14,6 +14,7 @@
 #include <QTimer>
 #include <qwt_plot.h>
 #include <qwt_plot_canvas.h>
+#include <qwt_plot_glcanvas.h>
 #include <qwt_plot_curve.h>
 #include <qwt_plot_grid.h>
 #include <qwt_plot_layout.h>
@@ -22,8 +23,11 @@
 #include <LinechartPlot.h>
 #include <MG.h>
 #include <QPaintEngine>
+#include <QMutexLocker>
 #include "ChartPlot.h"
 
+#include <cmath>
+
 #include "QGC.h"
 
 /**
@@ -43,6 +47,7 @@ LinechartPlot::LinechartPlot(QWidget *parent, int plotid, quint64 interval):
     automaticScrollActive(false),
     m_active(false),
     m_groundTime(true),
+    _telemetryStore(NULL),
     d_data(NULL),
     d_curve(NULL)
 {
@@ -110,6 +115,9 @@ LinechartPlot::~LinechartPlot()
 //        d = NULL;
 //    }
 //    datalock.unlock();
+
+    // Releases the store series retained by the datasets
+    qDeleteAll(data);
 }
 
 void LinechartPlot::showEvent(QShowEvent* event)
@@ -221,65 +229,75 @@ void LinechartPlot::setZeroValue(QString id, double zeroValue)
 {
     if(data.contains(id)) {
         data.value(id)->setZeroValue(zeroValue);
-    } else {
-        data.insert(id, new TimeSeriesData(this, id, maxInterval, zeroValue));
     }
 }
 
+void LinechartPlot::setTelemetryStore(TelemetryStore* store)
+{
+    _telemetryStore = store;
+}
+
 void LinechartPlot::appendData(QString dataname, quint64 ms, double value)
+{
+    // Values which are not in the telemetry store are kept in a store of the plot
+    int seriesId = _localStore.seriesId(dataname);
+    if (seriesId == -1) {
+        seriesId = _localStore.addSeries(dataname, QString(), 0, TelemetryStore::ValueDouble, false);
+    }
+    _localStore.append(seriesId, ms, value);
+
+    double msecs = ms;
+    _appendSamples(dataname, &_localStore, seriesId, &msecs, &value, 1);
+}
+
+void LinechartPlot::appendSamples(const QString& dataname, int seriesId, const QVector<double>& msecs, const QVector<double>& values)
+{
+    if (_telemetryStore && !msecs.isEmpty()) {
+        _appendSamples(dataname, _telemetryStore, seriesId, msecs.constData(), values.constData(), msecs.count());
+    }
+}
+
+void LinechartPlot::_appendSamples(const QString& dataname, TelemetryStore* store, int seriesId, const double* msecs, const double* values, int count)
 {
     /* Lock resource to ensure data integrity */
     datalock.lock();
 
     /* Check if dataset identifier already exists */
-    if(!data.contains(dataname)) {
-        addCurve(dataname);
+    TimeSeriesData* dataset = data.value(dataname, NULL);
+    if(!dataset) {
+        addCurve(dataname, store, seriesId);
         enforceGroundTime(m_groundTime);
-//        qDebug() << "ADDING CURVE WITH" << dataname << ms << value;
-//        qDebug() << "MINTIME:" << minTime << "MAXTIME:" << maxTime;
-//        qDebug() << "LASTTIME:" << lastTime;
+        dataset = data.value(dataname);
     }
 
-    // Add new value
-    TimeSeriesData* dataset = data.value(dataname);
+    // Samples of a batch are received together, so they share the receive time
+    quint64 groundTime = m_groundTime ? QGC::groundTimeMilliseconds() : 0;
+    quint64 time = 0;
+    for (int i=0; i<count; i++) {
+        quint64 ms = (quint64)msecs[i];
+        double value = values[i];
 
-    quint64 time;
+        // Append data
+        time = m_groundTime ? groundTime : ms;
+        dataset->append(time, ms, value);
 
-    // Append data
-    if (!m_groundTime)
-    {
-        // Use timestamp from dataset
-        time = ms;
-    }
-    else
-    {
-        time = QGC::groundTimeMilliseconds();
-    }
-    dataset->append(time, value);
-
-    lastUpdate.insert(dataname, time);
+        // Scaling values
+        if(ms < minTime) minTime = ms;
+        if(ms > maxTime) maxTime = ms;
 
-    // Scaling values
-    if(ms < minTime) minTime = ms;
-    if(ms > maxTime) maxTime = ms;
+        if (value < minValue) minValue = value;
+        if (value > maxValue) maxValue = value;
+    }
     storageInterval = maxTime - minTime;
+    valueInterval = maxValue - minValue;
 
+    lastUpdate.insert(dataname, time);
     if(time > lastTime)
     {
-        //qDebug() << "UPDATED LAST TIME!" << dataname << time << lastTime;
         lastTime = time;
     }
 
-    //
-    if (value < minValue) minValue = value;
-    if (value > maxValue) maxValue = value;
-    valueInterval = maxValue - minValue;
-
-    // Assign dataset to curve
-    QwtPlotCurve* curve = _curves.value(dataname);
-    curve->setRawSamples(dataset->getPlotX(), dataset->getPlotY(), dataset->getPlotCount());
-
-    //    qDebug() << "mintime" << minTime << "maxtime" << maxTime << "last max time" << "window position" << getWindowPosition();
+    // The curve samples are decimated from the dataset when the plot is painted
 
     datalock.unlock();
 }
@@ -314,7 +332,7 @@ bool LinechartPlot::groundTime()
     return m_groundTime;
 }
 
-void LinechartPlot::addCurve(QString id)
+void LinechartPlot::addCurve(QString id, TelemetryStore* store, int seriesId)
 {
     QColor currentColor = getNextColor();
 
@@ -343,7 +361,7 @@ void LinechartPlot::addCurve(QString id)
         curve->setSymbol(sym);*/
 
     // Create dataset
-    TimeSeriesData* dataset = new TimeSeriesData(this, id, this->plotInterval, maxInterval);
+    TimeSeriesData* dataset = new TimeSeriesData(this, id, store, seriesId, this->plotInterval);
 
     // Add dataset to list
     data.insert(id, dataset);
@@ -365,8 +383,11 @@ void LinechartPlot::setWindowPosition(quint64 end)
         plotPosition = end;
         setAxisScale(QwtPlot::xBottom, (plotPosition - getPlotInterval()), plotPosition, timeScaleStep);
     }
-    //@TODO Update the rest of the plot and update drawing
     windowLock.unlock();
+
+    // The curves only hold the points of the previous window
+    _decimateCurves();
+    replot();
 }
 
 /**
@@ -414,6 +435,12 @@ void LinechartPlot::setScaling(int scaling)
  **/
 void LinechartPlot::setVisibleById(QString id, bool visible)
 {
+    // Only shown curves keep the history of their series
+    TimeSeriesData* dataset = data.value(id, NULL);
+    if (dataset) {
+        dataset->setRetained(visible);
+    }
+
     if(_curves.contains(id)) {
         _curves.value(id)->setVisible(visible);
         if(visible)
@@ -490,7 +517,8 @@ void LinechartPlot::setCurveColor(QString id, QColor color)
  **/
 bool LinechartPlot::isVisible(QString id)
 {
-    return _curves.value(id)->isVisible();
+    QwtPlotCurve* curve = _curves.value(id, NULL);
+    return curve && curve->isVisible();
 }
 
 /**
@@ -630,6 +658,52 @@ void LinechartPlot::setLinearScaling()
     setAxisScaleEngine(QwtPlot::yLeft, yScaleEngine);
 }
 
+/**
+ * @brief Draw the canvas with OpenGL instead of the raster paint engine
+ **/
+void LinechartPlot::setOpenGLCanvas(bool enable)
+{
+    bool glCanvas = qobject_cast<QwtPlotGLCanvas*>(canvas()) != NULL;
+    if (enable == glCanvas) {
+        return;
+    }
+
+    // The previous canvas is deleted by setCanvas, its background has to be carried over
+    QBrush background = canvasBackground();
+    if (enable) {
+        setCanvas(new QwtPlotGLCanvas(this));
+    } else {
+        setCanvas(new QwtPlotCanvas(this));
+    }
+    setCanvasBackground(background);
+    replot();
+}
+
+/**
+ * @brief Set the samples of all visible curves from their datasets, decimated to the canvas width
+ **/
+void LinechartPlot::_decimateCurves()
+{
+    // The scale division set by setAxisScale() is only calculated when the axes are updated
+    updateAxes();
+    const QwtScaleDiv& timeScale = axisScaleDiv(QwtPlot::xBottom);
+    int columns = qMax(1, canvas()->width());
+    QVector<QPointF> points;
+
+    QMutexLocker lock(&datalock);
+    QMap<QString, QwtPlotCurve*>::const_iterator i;
+    for (i = _curves.constBegin(); i != _curves.constEnd(); ++i)
+    {
+        TimeSeriesData* dataset = data.value(i.key(), NULL);
+        if (!dataset || !i.value()->isVisible())
+        {
+            continue;
+        }
+        dataset->decimate(timeScale.lowerBound(), timeScale.upperBound(), columns, points);
+        i.value()->setSamples(points);
+    }
+}
+
 void LinechartPlot::setAverageWindow(int windowSize)
 {
     this->averageWindowSize = windowSize;
@@ -679,6 +753,7 @@ void LinechartPlot::paintRealtime()
 
         windowLock.unlock();
 
+        _decimateCurves();
         replot();
 
         /*
@@ -731,19 +806,25 @@ void LinechartPlot::removeAllData()
 }
 
 
-TimeSeriesData::TimeSeriesData(QwtPlot* plot, QString friendlyName, quint64 plotInterval, quint64 maxInterval, double zeroValue):
+TimeSeriesData::TimeSeriesData(QwtPlot* plot, QString friendlyName, TelemetryStore* store, int seriesId, quint64 plotInterval, double zeroValue):
     minValue(DBL_MAX),
     maxValue(DBL_MIN),
     zeroValue(0),
+    retained(false),
+    timeOffset(0.0),
     count(0),
     mean(0.0),
     median(0.0),
     variance(0.0),
-    averageWindow(50)
+    averageWindow(50),
+    windowShift(0.0),
+    windowSum(0.0),
+    windowSumSquares(0.0)
 {
     this->plot = plot;
     this->friendlyName = friendlyName;
-    this->maxInterval = maxInterval;
+    this->store = store;
+    this->seriesId = seriesId;
     this->zeroValue = zeroValue;
     this->plotInterval = plotInterval;
 
@@ -751,12 +832,12 @@ TimeSeriesData::TimeSeriesData(QwtPlot* plot, QString friendlyName, quint64 plot
     startTime = QUINT64_MAX;
     stopTime = QUINT64_MIN;
 
-    plotCount = 0;
+    windowValues.setCapacity(averageWindow);
 }
 
 TimeSeriesData::~TimeSeriesData()
 {
-
+    setRetained(false);
 }
 
 void TimeSeriesData::setInterval(quint64 ms)
@@ -764,85 +845,165 @@ void TimeSeriesData::setInterval(quint64 ms)
     plotInterval = ms;
 }
 
+void TimeSeriesData::setRetained(bool retained)
+{
+    if (retained != this->retained && store) {
+        store->setRetained(seriesId, retained);
+    }
+    this->retained = retained;
+}
+
 void TimeSeriesData::setAverageWindowSize(int windowSize)
 {
+    QMutexLocker lock(&dataMutex);
     this->averageWindow = windowSize;
+    windowValues.setCapacity(windowSize);
+    _resetAverageWindow();
+}
+
+/**
+ * @brief Recompute the sums of the average window from its values
+ * Called with dataMutex held.
+ **/
+void TimeSeriesData::_resetAverageWindow()
+{
+    windowSum = 0;
+    windowSumSquares = 0;
+    if (windowValues.isEmpty())
+    {
+        return;
+    }
+
+    windowShift = windowValues.last();
+    for (int i = 0; i < windowValues.count(); ++i)
+    {
+        double shifted = windowValues.at(i) - windowShift;
+        windowSum += shifted;
+        windowSumSquares += shifted * shifted;
+    }
+}
+
+/**
+ * @brief Append the first, min, max and last points of a bucket, skipping duplicates
+ **/
+static void _appendM4(const TelemetryStore::Bucket_t& bucket, double offset, QVector<QPointF>& points)
+{
+    points.append(QPointF(bucket.firstMSecs + offset, bucket.first));
+    if (bucket.min < bucket.max)
+    {
+        double middleMs = (bucket.firstMSecs + bucket.lastMSecs) / 2.0 + offset;
+        points.append(QPointF(middleMs, bucket.min));
+        points.append(QPointF(middleMs, bucket.max));
+    }
+    if (bucket.lastMSecs > bucket.firstMSecs)
+    {
+        points.append(QPointF(bucket.lastMSecs + offset, bucket.last));
+    }
+}
+
+void TimeSeriesData::decimate(double startMs, double endMs, int columns, QVector<QPointF>& points)
+{
+    points.clear();
+
+    if (!store || columns <= 0 || endMs <= startMs)
+    {
+        return;
+    }
+
+    dataMutex.lock();
+    double offset = timeOffset;
+    dataMutex.unlock();
+
+    // Buckets no wider than a column, or the samples themselves if there are few of them. One sample beyond each edge
+    // of the window keeps the line going to the border.
+    QVector<TelemetryStore::Bucket_t> buckets;
+    int bucketCount = store->minMax(seriesId, (quint64)qMax(0.0, startMs - offset), (quint64)qMax(0.0, endMs - offset),
+                                    columns * TelemetryStore::bucketSpan, buckets, true);
+
+    if (bucketCount <= columns * 4)
+    {
+        points.reserve(bucketCount * 4);
+        for (int i = 0; i < bucketCount; ++i)
+        {
+            _appendM4(buckets[i], offset, points);
+        }
+        return;
+    }
+
+    // Reduce the buckets falling in each column to first, min, max and last
+    double columnWidth = (endMs - startMs) / columns;
+    TelemetryStore::Bucket_t acc = buckets[0];
+    int column = (int)std::floor((acc.firstMSecs + offset - startMs) / columnWidth);
+
+    points.reserve(columns * 4 + 8);
+    for (int i = 1; i < bucketCount; ++i)
+    {
+        const TelemetryStore::Bucket_t& bucket = buckets[i];
+        int bucketColumn = (int)std::floor((bucket.firstMSecs + offset - startMs) / columnWidth);
+        if (bucketColumn != column)
+        {
+            _appendM4(acc, offset, points);
+            column = bucketColumn;
+            acc = bucket;
+        }
+        else
+        {
+            acc.lastMSecs = bucket.lastMSecs;
+            acc.last = bucket.last;
+            acc.min = qMin(acc.min, bucket.min);
+            acc.max = qMax(acc.max, bucket.max);
+        }
+    }
+    _appendM4(acc, offset, points);
 }
 
 /**
- * @brief Append a data point to this data set
+ * @brief Account for a data point appended to the store series
  *
- * @param ms The time in milliseconds
+ * @param ms The time the data point is plotted at, in milliseconds
+ * @param sampleMs The time of the data point in the store, in milliseconds
  * @param value The data value
  **/
-void TimeSeriesData::append(quint64 ms, double value)
+void TimeSeriesData::append(quint64 ms, quint64 sampleMs, double value)
 {
-    dataMutex.lock();
-    // Qt will automatically use a smart growth strategy: http://doc.qt.io/qt-5/containers.html#growth-strategies
-    this->ms.append(ms);
-    this->value.append(value);
+    QMutexLocker lock(&dataMutex);
+
     this->lastValue = value;
-    this->mean = 0;
-    //QList<double> medianList = QList<double>();
-    for (unsigned int i = 0; (i < averageWindow) && (((int)count - (int)i) >= 0); ++i) {
-        this->mean += this->value[count-i];
-        //medianList.append(this->value[count-i]);
-    }
-    this->mean = mean / static_cast<double>(qMin(averageWindow,static_cast<unsigned int>(count)));
-
-    this->variance = 0;
-    for (unsigned int i = 0; (i < averageWindow) && (((int)count - (int)i) >= 0); ++i) {
-        this->variance += (this->value[count-i] - mean) * (this->value[count-i] - mean);
-    }
-    this->variance = this->variance / static_cast<double>(qMin(averageWindow,static_cast<unsigned int>(count)));
-
-//    qSort(medianList);
-
-//    if (medianList.count() > 2)
-//    {
-//        if (medianList.count() % 2 == 0)
-//        {
-//            median = (medianList.at(medianList.count()/2) + medianList.at(medianList.count()/2+1)) / 2.0;
-//        }
-//        else
-//        {
-//            median = medianList.at(medianList.count()/2+1);
-//        }
-//    }
+    this->timeOffset = (double)ms - (double)sampleMs;
+
+    double droppedValue = 0;
+    bool dropped = windowValues.count() == windowValues.capacity();
+    if (dropped) {
+        droppedValue = windowValues.at(0);
+    }
+    windowValues.append(value);
+
+    // Sliding mean and variance from running sums, recomputed once per window to keep rounding errors from adding up
+    if (count % averageWindow == 0) {
+        _resetAverageWindow();
+    } else {
+        double shifted = value - windowShift;
+        windowSum += shifted;
+        windowSumSquares += shifted * shifted;
+        if (dropped) {
+            double shiftedDropped = droppedValue - windowShift;
+            windowSum -= shiftedDropped;
+            windowSumSquares -= shiftedDropped * shiftedDropped;
+        }
+    }
+    double windowCount = windowValues.count();
+    this->mean = windowShift + windowSum / windowCount;
+    this->variance = qMax(0.0, windowSumSquares / windowCount - (windowSum / windowCount) * (windowSum / windowCount));
 
     // Update statistical values
     if(ms < startTime) startTime = ms;
     if(ms > stopTime) stopTime = ms;
     interval = stopTime - startTime;
 
-    if (interval > plotInterval) {
-        while (this->ms[count - plotCount] < stopTime - plotInterval) {
-            plotCount--;
-        }
-    }
-
     count++;
-    plotCount++;
 
     if(minValue > value) minValue = value;
     if(maxValue < value) maxValue = value;
-
-    // Trim dataset if necessary
-    if(maxInterval > 0) {
-        // maxInterval = 0 means infinite
-
-        if(interval > maxInterval && !this->ms.isEmpty() && !this->value.isEmpty()) {
-            // The time at which this time series should be cut
-            double minTime = stopTime - maxInterval;
-            // Delete elements from the start of the list as long the time
-            // value of this elements is before the cut time
-            while(this->ms.first() < minTime) {
-                this->ms.pop_front();
-                this->value.pop_front();
-            }
-        }
-    }
-    dataMutex.unlock();
 }
 
 /**
@@ -935,56 +1096,3 @@ int TimeSeriesData::getCount() const
 {
     return count;
 }
-
-/**
- * @brief Get the number of points in the plot selection
- *
- * @return The number of points
- **/
-int TimeSeriesData::getPlotCount() const
-{
-    return plotCount;
-}
-
-/**
- * @brief Get the data array size
- * The data array size is \e NOT equal to the number of items in the data set, as
- * array space is pre-allocated. Use getCount() to get the number of data points.
- *
- * @return The data array size
- * @see getCount()
- **/
-int TimeSeriesData::size() const
-{
-    return ms.size();
-}
-
-/**
- * @brief Get the X (time) values
- *
- * @return The x values
- **/
-const double* TimeSeriesData::getX() const
-{
-    return ms.data();
-}
-
-const double* TimeSeriesData::getPlotX() const
-{
-    return ms.data() + (count - plotCount);
-}
-
-/**
- * @brief Get the Y (data) values
- *
- * @return The y values
- **/
-const double* TimeSeriesData::getY() const
-{
-    return value.data();
-}
-
-const double* TimeSeriesData::getPlotY() const
-{
-    return value.data() + (count - plotCount);
-}
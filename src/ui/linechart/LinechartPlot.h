@@ -25,6 +25,9 @@
 #include <QMap>
 #include <QList>
 #include <QMutex>
+#include <QPointer>
+#include <QPointF>
+#include <QVector>
 #include <QTime>
 #include <QTimer>
 #include <qwt_plot_panner.h>
@@ -35,6 +38,7 @@
 #include <qwt_plot.h>
 #include "ChartPlot.h"
 #include "MG.h"
+#include "TelemetryStore.h"
 
 class TimeScaleDraw: public QwtScaleDraw
 {
@@ -58,26 +62,47 @@ class QwtPlotCurve;
 /**
  * @brief Container class for the time series data
  *
+ * The samples of the curve are held by a TelemetryStore series, this class only keeps the statistics shown in the
+ * curve list and reads the store to draw the curve.
  **/
 class TimeSeriesData
 {
 public:
 
-    TimeSeriesData(QwtPlot* plot, QString friendlyName = "data", quint64 plotInterval = 10000, quint64 maxInterval = 0, double zeroValue = 0);
+    /**
+     * @param store Store holding the samples of the curve
+     * @param seriesId Series of the store drawn by the curve
+     */
+    TimeSeriesData(QwtPlot* plot, QString friendlyName, TelemetryStore* store, int seriesId, quint64 plotInterval = 10000, double zeroValue = 0);
     ~TimeSeriesData();
 
-    void append(quint64 ms, double value);
+    /**
+     * @brief Account for a sample appended to the store series
+     *
+     * @param ms Time the sample is plotted at
+     * @param sampleMs Time of the sample in the store, differs from ms when the receive time is enforced
+     * @param value Value of the sample
+     */
+    void append(quint64 ms, quint64 sampleMs, double value);
 
     QwtScaleMap* getScaleMap();
 
     int getCount() const;
-    int size() const;
-    const double* getX() const;
-    const double* getY() const;
 
-    const double* getPlotX() const;
-    const double* getPlotY() const;
-    int getPlotCount() const;
+    /** @brief Keep the history of the store series, while the curve is shown */
+    void setRetained(bool retained);
+
+    /**
+     * @brief Get the samples within [startMs, endMs] decimated for drawing
+     *
+     * Each pixel column gets at most four points: its first, minimum, maximum and last value (M4 decimation), so
+     * the drawn line matches the full data while the number of points depends only on the plot width. Wide windows
+     * are decimated from the min/max buckets of the store, so the cost does not grow with the sample count.
+     *
+     * @param columns Number of pixel columns the window is drawn into
+     * @param points Decimated points, ordered by time
+     */
+    void decimate(double startMs, double endMs, int columns, QVector<QPointF>& points);
 
     int getID();
     QString getFriendlyName();
@@ -102,9 +127,7 @@ protected:
     quint64 stopTime;
     quint64 interval;
     quint64 plotInterval;
-    quint64 maxInterval;
     int id;
-    quint64 plotCount;
     QString friendlyName;
 
     double lastValue; ///< The last inserted value
@@ -119,15 +142,23 @@ protected:
     void updateScaleMap();
 
 private:
+    void _resetAverageWindow(void);
+
+    QPointer<TelemetryStore> store;
+    int seriesId;
+    bool retained;
+    double timeOffset;                      ///< Plotted time minus store time of the last sample
+
     quint64 count;
-    QVector<double> ms;
-    QVector<double> value;
     double mean;
     double median;
     double variance;
     unsigned int averageWindow;
-    QVector<double> outputMs;
-    QVector<double> outputValue;
+
+    TelemetryRing<double> windowValues;     ///< Values in the average window
+    double windowShift;                     ///< Sums are taken relative to this value to keep the variance precise
+    double windowSum;                       ///< Sum of the values in the average window
+    double windowSumSquares;                ///< Sum of the squared values in the average window
 };
 
 
@@ -147,6 +178,9 @@ public:
     void setZeroValue(QString id, double zeroValue);
     void removeAllData();
 
+    /** @brief Set the store the samples appended through appendSamples() are read from */
+    void setTelemetryStore(TelemetryStore* store);
+
     QList<QwtPlotCurve*> getCurves();
     bool isVisible(QString id);
     /** @brief Check if any curve is visible */
@@ -193,6 +227,18 @@ public slots:
      * @param value value of the data point
      */
     void appendData(QString dataname, quint64 ms, double value);
+    /**
+     * @brief Account for a sample appended to a series of the telemetry store
+     *
+     * The curve is drawn from the store series, the plot does not keep another copy of the samples. All samples
+     * read from the store since the last call are passed at once.
+     *
+     * @param dataname unique string (also used to label the data)
+     * @param seriesId series of the telemetry store holding the samples
+     * @param msecs times of the samples in the store, in milliseconds
+     * @param values values of the samples
+     */
+    void appendSamples(const QString& dataname, int seriesId, const QVector<double>& msecs, const QVector<double>& values);
     void hideCurve(QString id);
     void showCurve(QString id);
     /** @brief Enable auto-refreshing of plot */
@@ -226,6 +272,9 @@ public slots:
     /** @brief Set linear plot y-axis scaling */
     void setLinearScaling();
 
+    /** @brief Draw the plot canvas with OpenGL */
+    void setOpenGLCanvas(bool enable);
+
     /** @brief Set the number of values to average over */
     void setAverageWindow(int windowSize);
     void removeTimedOutCurves();
@@ -266,11 +315,17 @@ protected:
     QTimer timeoutTimer;
 
     // Methods
-    void addCurve(QString id);
+    void addCurve(QString id, TelemetryStore* store, int seriesId);
     void showEvent(QShowEvent* event);
     void hideEvent(QHideEvent* event);
 
 private:
+    void _decimateCurves(void);
+    void _appendSamples(const QString& dataname, TelemetryStore* store, int seriesId, const double* msecs, const double* values, int count);
+
+    TelemetryStore* _telemetryStore;
+    TelemetryStore  _localStore;        ///< Holds the samples appended through appendData()
+
     TimeSeriesData* d_data;
     QwtPlotCurve* d_curve;
 
@@ -32,6 +32,8 @@
 #include <QStandardPaths>
 #include <QShortcut>
 
+#include <limits>
+
 #include "LinechartWidget.h"
 #include "LinechartPlot.h"
 #include "LogCompressor.h"
@@ -59,7 +61,9 @@ LinechartWidget::LinechartWidget(int systemid, QWidget *parent) : QWidget(parent
     logStartTime(0),
     updateTimer(new QTimer()),
     selectedMAV(-1),
-    lastTimestamp(0)
+    lastTimestamp(0),
+    _telemetryStore(NULL),
+    _openGLCheckBox(NULL)
 {
     // Add elements defined in Qt Designer
     ui.setupUi(this);
@@ -129,6 +133,88 @@ LinechartWidget::LinechartWidget(int systemid, QWidget *parent) : QWidget(parent
 
     _filterTimer.setInterval(500);
     connect(&_filterTimer, &QTimer::timeout, this, &LinechartWidget::_filterTimeout);
+
+    _telemetryTimer.setInterval(LinechartPlot::DEFAULT_REFRESH_RATE);
+    connect(&_telemetryTimer, &QTimer::timeout, this, &LinechartWidget::_readTelemetryStore);
+}
+
+void LinechartWidget::setTelemetryStore(TelemetryStore* store)
+{
+    _telemetryStore = store;
+    _telemetrySeries.clear();
+    activePlot->setTelemetryStore(store);
+    if (_telemetryStore && updateTimer->isActive()) {
+        _telemetryTimer.start();
+    }
+}
+
+/// Accounts for the samples received since the last read. The plot draws the curves from the store, only the curve
+/// list values and the log file are updated here. Plotted curves get all their samples in one batch, the log only
+/// holds plotted curves. Curves which are not plotted only get their last sample, enough for the curve list value.
+void LinechartWidget::_readTelemetryStore(void)
+{
+    if (!_telemetryStore) {
+        return;
+    }
+
+    int seriesCount = _telemetryStore->seriesCount();
+    for (int id=_telemetrySeries.count(); id<seriesCount; id++) {
+        TelemetrySeries_t series;
+        series.uasId = _telemetryStore->seriesSystemId(id);
+        series.curve = _telemetryStore->seriesName(id);
+        series.curveID = series.curve + _telemetryStore->seriesUnit(id);
+        series.isDouble = !_telemetryStore->seriesInteger(id);
+        series.cursor = 0;
+        _telemetrySeries.append(series);
+    }
+
+    QVector<double> msecs;
+    QVector<double> values;
+    for (int id=0; id<seriesCount; id++) {
+        TelemetrySeries_t& series = _telemetrySeries[id];
+
+        // Values are dropped while hidden or when they are from another system
+        if (!isVisible() || (selectedMAV != -1 && selectedMAV != series.uasId)) {
+            series.cursor = _telemetryStore->appendedCount(id);
+            continue;
+        }
+
+        bool plotted = activePlot->isVisible(series.curveID);
+        if (plotted) {
+            series.cursor = _telemetryStore->samplesSince(id, series.cursor, msecs, values);
+            if (msecs.isEmpty()) {
+                continue;
+            }
+        } else {
+            quint64 appendedCount = _telemetryStore->appendedCount(id);
+            quint64 lastMsecs;
+            double lastValue;
+            if (appendedCount == series.cursor || !_telemetryStore->lastSample(id, lastMsecs, lastValue)) {
+                continue;
+            }
+            series.cursor = appendedCount;
+            msecs.fill(lastMsecs, 1);
+            values.fill(lastValue, 1);
+        }
+
+        // Order matters here, first append to plot, then update curve list
+        activePlot->appendSamples(series.curveID, id, msecs, values);
+        bool newCurve = !curveLabels->contains(series.curveID);
+        if (!series.isDouble) {
+            intData.insert(series.curveID, static_cast<int>(qBound((double)std::numeric_limits<int>::min(), values.last(), (double)std::numeric_limits<int>::max())));
+        }
+        if (newCurve) {
+            addCurve(series.curve, _telemetryStore->seriesUnit(id));
+        }
+
+        _checkGroundTime((quint64)msecs.last());
+
+        if (logging && plotted) {
+            for (int i=0; i<msecs.count(); i++) {
+                _logValue(series.uasId, series.curve, values[i], (quint64)msecs[i]);
+            }
+        }
+    }
 }
 
 LinechartWidget::~LinechartWidget()
@@ -166,6 +252,7 @@ void LinechartWidget::writeSettings()
     if (timeButton) settings.setValue("ENFORCE_GROUNDTIME", enforceGT);
     if (ui.showUnitsCheckBox) settings.setValue("SHOW_UNITS", ui.showUnitsCheckBox->isChecked());
     if (ui.shortNameCheckBox) settings.setValue("SHORT_NAMES", ui.shortNameCheckBox->isChecked());
+    if (_openGLCheckBox) settings.setValue("OPENGL_CANVAS", _openGLCheckBox->isChecked());
     settings.endGroup();
 }
 
@@ -178,6 +265,8 @@ void LinechartWidget::readSettings()
         activePlot->enforceGroundTime(settings.value("ENFORCE_GROUNDTIME", timeButton->isChecked()).toBool());
         timeButton->setChecked(settings.value("ENFORCE_GROUNDTIME", timeButton->isChecked()).toBool());
         //userGroundTimeSet = settings.value("USER_GROUNDTIME", timeButton->isChecked()).toBool();
+        _openGLCheckBox->setChecked(settings.value("OPENGL_CANVAS", false).toBool());
+        activePlot->setOpenGLCanvas(_openGLCheckBox->isChecked());
     }
     if (ui.showUnitsCheckBox) ui.showUnitsCheckBox->setChecked(settings.value("SHOW_UNITS", ui.showUnitsCheckBox->isChecked()).toBool());
     if (ui.shortNameCheckBox) ui.shortNameCheckBox->setChecked(settings.value("SHORT_NAMES", ui.shortNameCheckBox->isChecked()).toBool());
@@ -244,6 +333,15 @@ void LinechartWidget::createLayout()
     connect(timeButton.data(), &QCheckBox::clicked, activePlot, &LinechartPlot::enforceGroundTime);
     connect(timeButton.data(), &QCheckBox::clicked, this, &LinechartWidget::writeSettings);
 
+    // OpenGL canvas button
+    _openGLCheckBox = new QCheckBox(this);
+    _openGLCheckBox->setText(tr("OpenGL"));
+    _openGLCheckBox->setToolTip(tr("Draw the plot with OpenGL. Lowers the CPU load of plots with many curves."));
+    _openGLCheckBox->setWhatsThis(tr("Draw the plot with OpenGL. Lowers the CPU load of plots with many curves."));
+    hlayout->addWidget(_openGLCheckBox);
+    connect(_openGLCheckBox, &QCheckBox::clicked, activePlot, &LinechartPlot::setOpenGLCanvas);
+    connect(_openGLCheckBox, &QCheckBox::clicked, this, &LinechartWidget::writeSettings);
+
     hlayout->addStretch();
 
     QLabel *timeScaleLabel = new QLabel("Time axis:");
@@ -312,6 +410,11 @@ void LinechartWidget::appendData(int uasId, const QString& curve, const QString&
     if(!ok || type == QMetaType::QByteArray || type == QMetaType::QString)
         return;
     bool isDouble = type == QMetaType::Float || type == QMetaType::Double;
+    _appendValue(uasId, curve, unit, value, isDouble, isDouble ? 0 : variant.toInt(), usec);
+}
+
+void LinechartWidget::_appendValue(int uasId, const QString& curve, const QString& unit, double value, bool isDouble, int intValue, quint64 usec)
+{
     QString curveID = curve + unit;
 
     if ((selectedMAV == -1 && isVisible()) || (selectedMAV == uasId && isVisible()))
@@ -330,9 +433,21 @@ void LinechartWidget::appendData(int uasId, const QString& curve, const QString&
 
         // Add int data
         if(!isDouble)
-            intData.insert(curveID, variant.toInt());
+            intData.insert(curveID, intValue);
+    }
+
+    _checkGroundTime(usec);
+
+    // Log data
+    if (logging && activePlot->isVisible(curveID))
+    {
+        _logValue(uasId, curve, value, usec);
     }
+}
 
+/// Switches to ground time once sample times jump, as with data from different clocks
+void LinechartWidget::_checkGroundTime(quint64 usec)
+{
     if (lastTimestamp == 0 && usec != 0)
     {
         lastTimestamp = usec;
@@ -349,21 +464,17 @@ void LinechartWidget::appendData(int uasId, const QString& curve, const QString&
         }
         lastTimestamp = usec;
     }
+}
 
-    // Log data
-    if (logging)
-    {
-        if (activePlot->isVisible(curveID))
-        {
-            if (usec == 0) usec = QGC::groundTimeMilliseconds();
-            if (logStartTime == 0) logStartTime = usec;
-            qint64 time = usec - logStartTime;
-            if (time < 0) time = 0;
+void LinechartWidget::_logValue(int uasId, const QString& curve, double value, quint64 usec)
+{
+    if (usec == 0) usec = QGC::groundTimeMilliseconds();
+    if (logStartTime == 0) logStartTime = usec;
+    qint64 time = usec - logStartTime;
+    if (time < 0) time = 0;
 
-            QString line = QString("%1\t%2\t%3\t%4\n").arg(time).arg(uasId).arg(curve).arg(value, 0, 'e', 15);
-            logFile->write(line.toLatin1());
-        }
-    }
+    QString line = QString("%1\t%2\t%3\t%4\n").arg(time).arg(uasId).arg(curve).arg(value, 0, 'e', 15);
+    logFile->write(line.toLatin1());
 }
 
 void LinechartWidget::refresh()
@@ -800,8 +911,12 @@ void LinechartWidget::setActive(bool active)
     }
     if (active) {
         updateTimer->start(updateInterval);
+        if (_telemetryStore) {
+            _telemetryTimer.start();
+        }
     } else {
         updateTimer->stop();
+        _telemetryTimer.stop();
     }
 }
 
@@ -37,6 +37,7 @@
 #include <qwt_plot_curve.h>
 
 #include "LinechartPlot.h"
+#include "TelemetryStore.h"
 #include "UASInterface.h"
 #include "ui_Linechart.h"
 
@@ -57,6 +58,9 @@ public:
     static const int MIN_TIME_SCROLLBAR_VALUE = 0; ///< The minimum scrollbar value
     static const int MAX_TIME_SCROLLBAR_VALUE = 16383; ///< The maximum scrollbar value
 
+    /** @brief Read decoded telemetry from the store instead of a valueChanged signal per value */
+    void setTelemetryStore(TelemetryStore* store);
+
 public slots:
     void addCurve(const QString& curve, const QString& unit);
     void removeCurve(QString curve);
@@ -197,9 +201,27 @@ signals:
 private slots:
     void _filterTimeout(void);
     void _restartFilterTimeout(void);
+    void _readTelemetryStore(void);
 
 private:
+    void _appendValue(int uasId, const QString& curve, const QString& unit, double value, bool isDouble, int intValue, quint64 usec);
+    void _checkGroundTime(quint64 usec);
+    void _logValue(int uasId, const QString& curve, double value, quint64 usec);
+
+    /// Curve of a telemetry store series, resolved once when the series is first read
+    typedef struct {
+        int     uasId;
+        QString curve;
+        QString curveID;    ///< Curve name and unit
+        bool    isDouble;
+        quint64 cursor;     ///< Samples read so far
+    } TelemetrySeries_t;
+
     QTimer _filterTimer;
+    TelemetryStore*             _telemetryStore;
+    QVector<TelemetrySeries_t>  _telemetrySeries;   ///< Indexed by store series id
+    QTimer                      _telemetryTimer;
+    QCheckBox*          _openGLCheckBox;
 };
 
 #endif // LINECHARTWIDGET_H
@@ -599,6 +599,85 @@ QGCView {
                                 anchors.verticalCenter: parent.verticalCenter
                             }
                         }
+                        FactCheckBox {
+                            text:       qsTr("Low latency mode")
+                            fact:       _lowLatencyMode
+                            visible:    QGroundControl.videoManager.isGStreamer && videoSource.currentIndex && videoSource.currentIndex < 4 && _lowLatencyMode.visible
+                            property Fact _lowLatencyMode: QGroundControl.settingsManager.videoSettings.lowLatencyMode
+                        }
+                        Row {
+                            spacing:    ScreenTools.defaultFontPixelWidth
+                            visible:    QGroundControl.videoManager.isGStreamer && videoSource.currentIndex && videoSource.currentIndex < 3 && QGroundControl.settingsManager.videoSettings.jitterBuffer.visible
+                            QGCLabel {
+                                text:               qsTr("Jitter Buffer:")
+                                width:              _labelWidth
+                                anchors.verticalCenter: parent.verticalCenter
+                            }
+                            FactTextField {
+                                width:              _editFieldWidth
+                                fact:               QGroundControl.settingsManager.videoSettings.jitterBuffer
+                                anchors.verticalCenter: parent.verticalCenter
+                            }
+                        }
+                        Row {
+                            spacing:    ScreenTools.defaultFontPixelWidth
+                            visible:    QGroundControl.videoManager.isGStreamer && videoSource.currentIndex && videoSource.currentIndex < 4 && QGroundControl.settingsManager.videoSettings.fleetStreams.visible
+                            QGCLabel {
+                                text:               qsTr("Additional Streams:")
+                                width:              _labelWidth
+                                anchors.verticalCenter: parent.verticalCenter
+                            }
+                            FactTextField {
+                                width:              _editFieldWidth
+                                fact:               QGroundControl.settingsManager.videoSettings.fleetStreams
+                                anchors.verticalCenter: parent.verticalCenter
+                            }
+                        }
+                        Row {
+                            spacing:    ScreenTools.defaultFontPixelWidth
+                            visible:    QGroundControl.videoManager.isGStreamer && videoSource.currentIndex && videoSource.currentIndex < 4 && QGroundControl.settingsManager.videoSettings.streamMemoryBudget.visible
+                            QGCLabel {
+                                text:               qsTr("Stream Memory Budget:")
+                                width:              _labelWidth
+                                anchors.verticalCenter: parent.verticalCenter
+                            }
+                            FactTextField {
+                                width:              _editFieldWidth
+                                fact:               QGroundControl.settingsManager.videoSettings.streamMemoryBudget
+                                anchors.verticalCenter: parent.verticalCenter
+                            }
+                        }
+                        Row {
+                            spacing:    ScreenTools.defaultFontPixelWidth
+                            visible:    QGroundControl.videoManager.isGStreamer && videoSource.currentIndex && videoSource.currentIndex < 4 && QGroundControl.settingsManager.videoSettings.streamCpuBudget.visible
+                            QGCLabel {
+                                text:               qsTr("Background CPU Budget:")
+                                width:              _labelWidth
+                                anchors.verticalCenter: parent.verticalCenter
+                            }
+                            FactTextField {
+                                width:              _editFieldWidth
+                                fact:               QGroundControl.settingsManager.videoSettings.streamCpuBudget
+                                anchors.verticalCenter: parent.verticalCenter
+                            }
+                        }
+                        Row {
+                            spacing:    ScreenTools.defaultFontPixelWidth
+                            visible:    _videoReceiver && _videoReceiver.videoRunning
+                            property var _videoReceiver: QGroundControl.videoManager.videoReceiver
+                            QGCLabel {
+                                text:               qsTr("Measured Latency:")
+                                width:              _labelWidth
+                                anchors.verticalCenter: parent.verticalCenter
+                            }
+                            QGCLabel {
+                                width:              _editFieldWidth
+                                text:               parent._videoReceiver ?
+                                                        qsTr("%1 ms (queue %2, decode %3, render %4)").arg(parent._videoReceiver.latencyTotal.toFixed(0)).arg(parent._videoReceiver.latencyDecodeQueue.toFixed(0)).arg(parent._videoReceiver.latencyDecode.toFixed(0)).arg(parent._videoReceiver.latencyRender.toFixed(0)) :
+                                                        ""
+                                anchors.verticalCenter: parent.verticalCenter
+                            }
+                        }
                     }
                 } // Video Source - Rectangle
                 //-----------------------------------------------------------------
@@ -641,6 +720,20 @@ QGCView {
                                 anchors.verticalCenter: parent.verticalCenter
                             }
                         }
+                        Row {
+                            spacing:    ScreenTools.defaultFontPixelWidth
+                            visible:    QGroundControl.videoManager.isGStreamer && videoSource.currentIndex && videoSource.currentIndex < 4 && QGroundControl.settingsManager.videoSettings.segmentDuration.visible
+                            QGCLabel {
+                                text:               qsTr("Segment Length:")
+                                width:              _labelWidth
+                                anchors.verticalCenter: parent.verticalCenter
+                            }
+                            FactTextField {
+                                width:              _editFieldWidth
+                                fact:               QGroundControl.settingsManager.videoSettings.segmentDuration
+                                anchors.verticalCenter: parent.verticalCenter
+                            }
+                        }
                         Row {
                             spacing:    ScreenTools.defaultFontPixelWidth
                             visible:    QGroundControl.videoManager.isGStreamer && videoSource.currentIndex && videoSource.currentIndex < 4 && QGroundControl.settingsManager.videoSettings.recordingFormat.visible
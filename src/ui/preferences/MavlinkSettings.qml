@@ -141,6 +141,15 @@ Rectangle {
                         }
                     }
                     //-----------------------------------------------------------------
+                    //-- Fleet Mode
+                    QGCCheckBox {
+                        text:       qsTr("Fleet mode (telemetry only for vehicles which are not selected)")
+                        checked:    QGroundControl.multiVehicleManager.fleetMode
+                        onClicked: {
+                            QGroundControl.multiVehicleManager.fleetMode = checked
+                        }
+                    }
+                    //-----------------------------------------------------------------
                     //-- Mavlink Version Check
                     QGCCheckBox {
                         text:       qsTr("Only accept MAVs with same protocol version")